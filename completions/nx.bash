@@ -10,7 +10,7 @@ _nx_completions() {
     # Main commands
     local commands=(
         "new" "edit" "view" "ls" "rm" "mv"
-        "grep" "open" "backlinks" "tags"
+        "grep" "open" "backlinks" "graph" "tags"
         "export" "ask" "summarize" "tag-suggest" "title" "rewrite"
         "tasks" "suggest-links" "outline" "ui"
         "notebook" "attach" "import" "tpl" "meta"
@@ -139,6 +139,23 @@ _nx_completions() {
                 return 0
             fi
             ;;
+        graph)
+            if [[ $cword -eq 2 ]]; then
+                COMPREPLY=($(compgen -W "stats neighbors path components central" -- "$cur"))
+                return 0
+            fi
+            case "$prev" in
+                --direction)
+                    COMPREPLY=($(compgen -W "out in both" -- "$cur"))
+                    return 0
+                    ;;
+            esac
+            if [[ $cur == -* ]]; then
+                COMPREPLY=($(compgen -W "--depth --direction --min-size --limit" -- "$cur"))
+            else
+                _nx_complete_note_ids
+            fi
+            ;;
         export)
             if [[ $cword -eq 2 || ($cword -eq 3 && ${words[2]} == -*) ]]; then
                 COMPREPLY=($(compgen -W "md json pdf html" -- "$cur"))
@@ -393,45 +410,30 @@ _nx_completions() {
 }
 
 # Helper functions to complete nx-specific items
-_nx_complete_note_ids() {
-    # Try to get note IDs from nx ls command (if available)
+# Candidates come from `nx __complete <kind> <prefix>`, which reads a prebuilt
+# cache instead of listing notes; output is "value<TAB>description" per line
+_nx_complete_from_cache() {
+    local kind=$1
     if command -v nx >/dev/null 2>&1; then
-        local note_ids
-        note_ids=$(nx ls --json 2>/dev/null | jq -r '.[].id' 2>/dev/null || nx ls 2>/dev/null | awk '{print $1}' | head -20)
-        if [[ -n $note_ids ]]; then
-            COMPREPLY=($(compgen -W "$note_ids" -- "$cur"))
-        fi
+        local IFS=$'\n'
+        COMPREPLY=($(nx __complete "$kind" "$cur" 2>/dev/null | cut -f1))
     fi
 }
 
+_nx_complete_note_ids() {
+    _nx_complete_from_cache notes
+}
+
 _nx_complete_note_titles() {
-    if command -v nx >/dev/null 2>&1; then
-        local titles
-        titles=$(nx ls --json 2>/dev/null | jq -r '.[].title' 2>/dev/null || nx ls 2>/dev/null | cut -d' ' -f2- | head -20)
-        if [[ -n $titles ]]; then
-            COMPREPLY=($(compgen -W "$titles" -- "$cur"))
-        fi
-    fi
+    _nx_complete_from_cache titles
 }
 
 _nx_complete_notebooks() {
-    if command -v nx >/dev/null 2>&1; then
-        local notebooks
-        notebooks=$(nx notebook list --json 2>/dev/null | jq -r '.[].name' 2>/dev/null || nx notebook list 2>/dev/null | awk '{print $1}')
-        if [[ -n $notebooks ]]; then
-            COMPREPLY=($(compgen -W "$notebooks" -- "$cur"))
-        fi
-    fi
+    _nx_complete_from_cache notebooks
 }
 
 _nx_complete_tags() {
-    if command -v nx >/dev/null 2>&1; then
-        local tags
-        tags=$(nx tags --json 2>/dev/null | jq -r '.[]' 2>/dev/null || nx tags 2>/dev/null | awk '{print $1}')
-        if [[ -n $tags ]]; then
-            COMPREPLY=($(compgen -W "$tags" -- "$cur"))
-        fi
-    fi
+    _nx_complete_from_cache tags
 }
 
 _nx_complete_templates() {
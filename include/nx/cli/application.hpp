@@ -1,5 +1,8 @@
 #pragma once
 
+#include <chrono>
+#include <cstdint>
+#include <initializer_list>
 #include <memory>
 #include <string>
 #include <vector>
@@ -28,6 +31,44 @@ struct GlobalOptions {
   std::string notes_dir;       // --notes-dir: Override notes directory
   bool no_color = false;       // --no-color: Disable colored output
   bool force = false;          // --force: Force dangerous operations
+  bool timings = false;        // --timings: Per-phase latency breakdown on stderr
+};
+
+/**
+ * @brief Services reachable through Application's accessors
+ *
+ * Every service is constructed on its first resolve, so a command that never
+ * touches the search index never opens it. Config is available to every command.
+ */
+enum class Service : uint8_t {
+  kNoteStore = 1 << 0,
+  kNotebookManager = 1 << 1,
+  kAttachmentStore = 1 << 2,
+  kSearchIndex = 1 << 3,
+  kTemplateManager = 1 << 4,
+};
+
+/**
+ * @brief Set of services a command declares it resolves
+ */
+class ServiceSet {
+public:
+  constexpr ServiceSet() = default;
+  constexpr ServiceSet(std::initializer_list<Service> services) {
+    for (Service service : services) {
+      bits_ |= static_cast<uint8_t>(service);
+    }
+  }
+  
+  static constexpr ServiceSet all() {
+    return {Service::kNoteStore, Service::kNotebookManager, Service::kAttachmentStore,
+            Service::kSearchIndex, Service::kTemplateManager};
+  }
+  
+  constexpr bool contains(Service service) const { return (bits_ & static_cast<uint8_t>(service)) != 0; }
+
+private:
+  uint8_t bits_ = 0;
 };
 
 /**
@@ -58,6 +99,14 @@ public:
    * @brief Setup command-specific CLI options (optional override)
    */
   virtual void setupCommand(CLI::App* cmd) { (void)cmd; }
+  
+  /**
+   * @brief Services this command resolves
+   *
+   * Debug builds assert when a command reaches an undeclared service through
+   * Application's accessors; `-vv` flags undeclared ones in any build.
+   */
+  virtual ServiceSet requiredServices() const { return ServiceSet::all(); }
 };
 
 /**
@@ -106,6 +155,11 @@ private:
   
   // Initialization
   Result<void> initializeServices();
+  void checkDeclared(Service service) const;  // Debug builds: assert the running command declared it
+  void printServiceTimings(const Command& command) const;  // `-vv`: per-service startup cost
+  void printTimings(const Command& command, std::chrono::nanoseconds elapsed) const;  // `--timings`
+  void recordMetrics(const Command& command, std::chrono::system_clock::time_point started,
+                     std::chrono::nanoseconds elapsed, bool with_phases);
   
   // CLI framework
   CLI::App app_;
@@ -117,6 +171,7 @@ private:
   
   // Registered commands
   std::vector<std::unique_ptr<Command>> commands_;
+  const Command* active_command_ = nullptr;  // While its execute() runs
 };
 
 } // namespace nx::cli
\ No newline at end of file
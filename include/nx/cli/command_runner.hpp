@@ -0,0 +1,39 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "nx/di/service_container.hpp"
+
+namespace nx::cli {
+
+/**
+ * @brief Runs nx command lines in this process against an existing service container
+ *
+ * Each run parses into a fresh Application, so no option state carries over
+ * between runs, while the container's services (config, store, index and
+ * their caches) stay constructed. Standard output and error are captured
+ * and standard input reads from a supplied string instead of the terminal.
+ * Used by `nx daemon` and `nx batch`.
+ */
+class CommandRunner {
+public:
+  struct Output {
+    int exit_code = 1;
+    std::string out;
+    std::string err;
+  };
+
+  explicit CommandRunner(std::shared_ptr<nx::di::IServiceContainer> container);
+
+  /**
+   * @brief Run one command line; args[0] is the program name
+   */
+  Output run(std::vector<std::string> args, const std::string& input = "") const;
+
+private:
+  std::shared_ptr<nx::di::IServiceContainer> container_;
+};
+
+} // namespace nx::cli
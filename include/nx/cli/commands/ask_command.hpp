@@ -22,6 +22,7 @@ public:
   std::string description() const override { return "Ask questions over your notes using AI"; }
   
   void setupCommand(CLI::App* cmd) override;
+  ServiceSet requiredServices() const override { return {Service::kNoteStore, Service::kSearchIndex}; }
 
 private:
   Application& app_;
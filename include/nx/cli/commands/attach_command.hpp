@@ -14,6 +14,7 @@ public:
   std::string name() const override { return "attach"; }
   std::string description() const override { return "Attach file to note\n\nEXAMPLES:\n  nx attach abc123 document.pdf\n  nx attach abc123 image.jpg --description \"Project diagram\"\n  nx ls --tag project | head -1 | nx attach {} file.txt"; }
   void setupCommand(CLI::App* cmd) override;
+  ServiceSet requiredServices() const override { return {Service::kNoteStore, Service::kAttachmentStore}; }
 
 private:
   Application& app_;
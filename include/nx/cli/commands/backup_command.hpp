@@ -14,6 +14,7 @@ public:
 
   Result<int> execute(const GlobalOptions& options) override;
   void setupCommand(CLI::App* cmd) override;
+  ServiceSet requiredServices() const override { return {}; }
 
 private:
   Application& app_;
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <CLI/CLI.hpp>
+#include <nlohmann/json.hpp>
+#include "nx/cli/application.hpp"
+
+namespace nx::cli {
+
+/**
+ * @brief Run many nx operations from newline-delimited JSON in one process
+ *
+ * Each input line is an argument vector (`["new", "Title", "--tags", "a,b"]`)
+ * or an object `{"args": [...], "stdin": "...", "id": ...}`. Operations share
+ * one service container and are committed to the index in transactions of
+ * --commit-every operations; a failed operation's index writes are rolled
+ * back to a savepoint. One JSON result line is written per operation as
+ * soon as it finishes.
+ */
+class BatchCommand : public Command {
+public:
+  struct Operation {
+    std::vector<std::string> args;  // Without the program name
+    std::string input;              // Fed to the command as stdin
+    nlohmann::json id;              // Echoed back in the result line
+  };
+
+  explicit BatchCommand(Application& app);
+
+  /**
+   * @brief Parse one input line, refusing commands and options that cannot run inside a batch
+   */
+  static Result<Operation> parseOperation(const std::string& line);
+
+  Result<int> execute(const GlobalOptions& options) override;
+  std::string name() const override { return "batch"; }
+  std::string description() const override {
+    return "Run newline-delimited JSON commands in one process\n\n"
+           "EXAMPLES:\n"
+           "  printf '%s\\n' '[\"new\", \"First\", \"--tags\", \"import\"]' | nx batch\n"
+           "  nx batch ops.jsonl --continue-on-error\n"
+           "  {\"args\": [\"new\", \"Report\"], \"stdin\": \"Body text\", \"id\": 7}   # object form";
+  }
+  void setupCommand(CLI::App* cmd) override;
+
+private:
+  Application& app_;
+
+  // Command options
+  std::string input_file_ = "-";
+  bool continue_on_error_ = false;
+  size_t commit_every_ = 100;
+};
+
+} // namespace nx::cli
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <string>
+#include <CLI/CLI.hpp>
+#include "nx/cli/application.hpp"
+
+namespace nx::cli {
+
+/**
+ * @brief Completion candidates for shell scripts: `nx __complete <kind> [prefix]`
+ *
+ * Prints one `value<TAB>description` line per candidate from the prebuilt
+ * completion cache, building it from the store on first use. Hidden from help.
+ */
+class CompleteCommand : public Command {
+public:
+  explicit CompleteCommand(Application& app);
+
+  Result<int> execute(const GlobalOptions& options) override;
+  std::string name() const override { return "__complete"; }
+  std::string description() const override { return "Completion candidates for shell scripts"; }
+  void setupCommand(CLI::App* cmd) override;
+  ServiceSet requiredServices() const override { return {Service::kNoteStore}; }
+
+private:
+  Application& app_;
+  std::string kind_;
+  std::string prefix_;
+  size_t limit_ = 200;
+};
+
+} // namespace nx::cli
@@ -21,6 +21,7 @@ public:
   explicit ConfigCommand(Application& app);
   
   void setupCommand(CLI::App* cmd) override;
+  ServiceSet requiredServices() const override { return {}; }
   Result<int> execute(const GlobalOptions& options) override;
   
   std::string name() const override { return name_; }
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <string>
+#include <CLI/CLI.hpp>
+#include "nx/cli/application.hpp"
+
+namespace nx::cli {
+
+/**
+ * @brief Start, stop or query the background daemon that keeps services warm
+ */
+class DaemonCommand : public Command {
+public:
+  explicit DaemonCommand(Application& app);
+
+  Result<int> execute(const GlobalOptions& options) override;
+  std::string name() const override { return "daemon"; }
+  std::string description() const override { return "Serve fast repeat commands from a warm background process"; }
+  void setupCommand(CLI::App* cmd) override;
+
+private:
+  Application& app_;
+  std::string subcommand_ = "status";
+
+  // Subcommand options
+  int idle_minutes_ = 0;
+
+  Result<int> executeStart(const GlobalOptions& options);
+  Result<int> executeStop(const GlobalOptions& options);
+  Result<int> executeStatus(const GlobalOptions& options);
+};
+
+} // namespace nx::cli
@@ -14,7 +14,9 @@ namespace nx::cli {
  * - Git repository status (if enabled)
  * - External tool availability
  * - Performance benchmarks
+ * - Recorded command latency (P50/P95/P99 from performance.metrics_file)
  * - Storage usage analysis
+ * - Near-duplicate notes
  */
 class DoctorCommand : public Command {
 public:
@@ -22,6 +24,7 @@ public:
   
   Result<int> execute(const GlobalOptions& options) override;
   void setupCommand(CLI::App* cmd) override;
+  ServiceSet requiredServices() const override { return {Service::kNoteStore, Service::kSearchIndex}; }
   
   std::string name() const override { return "doctor"; }
   std::string description() const override { 
@@ -67,6 +70,14 @@ private:
   Result<HealthCheck> checkPerformance();
   Result<HealthCheck> checkDatabase();
   Result<HealthCheck> checkNotesIntegrity();
+  Result<HealthCheck> checkDuplicates();
+  Result<HealthCheck> checkCommandLatency();
+  
+  // Estimated word overlap above which two notes count as copies
+  static constexpr double kDuplicateThreshold = 0.9;
+  
+  // Recorded runs older than this are left out of the latency percentiles
+  static constexpr int kLatencyWindowDays = 30;
   
   // Utility functions
   Result<void> runAllChecks(HealthReport& report);
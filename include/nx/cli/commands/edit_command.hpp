@@ -14,6 +14,7 @@ public:
   std::string name() const override { return "edit"; }
   std::string description() const override { return "Edit a note in $EDITOR"; }
   void setupCommand(CLI::App* cmd) override;
+  ServiceSet requiredServices() const override { return {Service::kNoteStore, Service::kSearchIndex}; }
 
 private:
   Application& app_;
@@ -22,6 +22,7 @@ public:
   
   Result<int> execute(const GlobalOptions& options) override;
   void setupCommand(CLI::App* cmd) override;
+  ServiceSet requiredServices() const override { return {Service::kNoteStore, Service::kSearchIndex}; }
 
 private:
   struct GcStats {
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <CLI/CLI.hpp>
+#include "nx/cli/application.hpp"
+#include "nx/index/link_graph.hpp"
+
+namespace nx::cli {
+
+/**
+ * @brief Queries over the link graph: stats, neighbours, paths, clusters and hubs
+ */
+class GraphCommand : public Command {
+public:
+  explicit GraphCommand(Application& app);
+
+  Result<int> execute(const GlobalOptions& options) override;
+  std::string name() const override { return "graph"; }
+  std::string description() const override { return "Explore the graph of links between notes"; }
+  void setupCommand(CLI::App* cmd) override;
+  ServiceSet requiredServices() const override { return {Service::kNoteStore}; }
+
+private:
+  Application& app_;
+  std::string subcommand_ = "stats";
+
+  // Subcommand options
+  std::string note_id_;
+  std::string target_id_;
+  size_t depth_ = 1;
+  std::string direction_ = "both";
+  size_t limit_ = 10;
+  size_t min_size_ = 2;
+
+  Result<int> executeStats(const nx::index::LinkGraph& graph, const GlobalOptions& options);
+  Result<int> executeNeighbors(const nx::index::LinkGraph& graph, const GlobalOptions& options);
+  Result<int> executePath(const nx::index::LinkGraph& graph, const GlobalOptions& options);
+  Result<int> executeComponents(const nx::index::LinkGraph& graph, const GlobalOptions& options);
+  Result<int> executeCentral(const nx::index::LinkGraph& graph, const GlobalOptions& options);
+
+  std::string titleOf(const nx::core::NoteId& id);
+};
+
+} // namespace nx::cli
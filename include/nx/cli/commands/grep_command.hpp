@@ -3,6 +3,7 @@
 #include <string>
 #include <CLI/CLI.hpp>
 #include "nx/cli/application.hpp"
+#include "nx/index/index.hpp"
 
 namespace nx::cli {
 
@@ -22,19 +23,36 @@ public:
            "  nx grep \"machine learning\"               # Find phrase in any note\n"
            "  nx grep \"TODO|FIXME\" --regex             # Find todos or fixmes\n"
            "  nx grep \"^# \" --regex                    # Find all headers\n"
-           "  nx grep error --ignore-case               # Case-insensitive search\n\n"
+           "  nx grep error --ignore-case               # Case-insensitive search\n"
+           "  nx grep meeting -l 20 --offset 20         # Second page of 20\n"
+           "  nx grep todo --jsonl -l 10000 | jq .title # Stream results as they are found\n"
+           "  nx grep meeting --explain                 # Query plan and time per phase\n\n"
            "SEARCH TIPS:\n"
            "  Boolean:     Use regex for AND/OR: \"(term1|term2)\"\n"
            "  Fuzzy:       Use partial words: \"machin learn\"\n"
            "  Structure:   Search headers: \"^## .*project\"";
   }
   void setupCommand(CLI::App* cmd) override;
+  ServiceSet requiredServices() const override { return {Service::kNoteStore, Service::kSearchIndex}; }
 
 private:
+  // With emit set, page results go to it as they are found instead of into the page,
+  // and scanning stops once the page is full (the total is then a lower bound). With
+  // explain set, the time spent in each phase is added to it.
+  Result<nx::index::SearchPage> regexSearch(size_t limit, size_t offset,
+                                            const nx::index::Index::SearchVisitor& emit = nullptr,
+                                            nx::index::SearchExplain* explain = nullptr);
+  Result<int> executeJsonLines(const nx::index::SearchQuery& search_query);
+  Result<int> executeExplain(const nx::index::SearchQuery& search_query, const GlobalOptions& options);
+  
   Application& app_;
   std::string query_;
   bool use_regex_ = false;
   bool ignore_case_ = false;
+  size_t limit_ = 50;
+  size_t offset_ = 0;
+  bool jsonl_ = false;
+  bool explain_ = false;
 };
 
 } // namespace nx::cli
\ No newline at end of file
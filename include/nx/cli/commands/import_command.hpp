@@ -31,6 +31,7 @@ public:
            "  From folders:   nx import dir /path/to/docs --recursive";
   }
   void setupCommand(CLI::App* cmd) override;
+  ServiceSet requiredServices() const override { return {Service::kNoteStore}; }
 
 private:
   Application& app_;
@@ -15,6 +15,7 @@ public:
   std::string name() const override { return "ls"; }
   std::string description() const override { return "List notes"; }
   void setupCommand(CLI::App* cmd) override;
+  ServiceSet requiredServices() const override { return {Service::kNoteStore}; }
 
 private:
   Application& app_;
@@ -23,6 +24,7 @@ private:
   std::string since_;
   std::string before_;
   bool long_format_ = false;
+  bool jsonl_ = false;
   
   std::chrono::system_clock::time_point parseISODate(const std::string& date_str);
 };
@@ -16,6 +16,7 @@ public:
   std::string name() const override { return "meta"; }
   std::string description() const override { return "Metadata management"; }
   void setupCommand(CLI::App* cmd) override;
+  ServiceSet requiredServices() const override { return {Service::kNoteStore}; }
 
 private:
   Application& app_;
@@ -14,6 +14,7 @@ public:
   std::string name() const override { return "mv"; }
   std::string description() const override { return "Move a note between notebooks"; }
   void setupCommand(CLI::App* cmd) override;
+  ServiceSet requiredServices() const override { return {Service::kNoteStore, Service::kSearchIndex}; }
 
 private:
   Application& app_;
@@ -32,6 +32,7 @@ public:
   }
   
   void setupCommand(CLI::App* cmd) override;
+  ServiceSet requiredServices() const override { return {Service::kNoteStore, Service::kSearchIndex}; }
 
 private:
   Application& app_;
@@ -24,6 +24,7 @@ public:
   std::string name() const override;
   std::string description() const override;
   void setupCommand(CLI::App* cmd) override;
+  ServiceSet requiredServices() const override { return {Service::kNoteStore, Service::kNotebookManager, Service::kSearchIndex}; }
 
 private:
   Application& app_;
@@ -14,6 +14,7 @@ public:
   std::string name() const override { return "open"; }
   std::string description() const override { return "Fuzzy find and open a note"; }
   void setupCommand(CLI::App* cmd) override;
+  ServiceSet requiredServices() const override { return {Service::kNoteStore, Service::kSearchIndex}; }
 
 private:
   Application& app_;
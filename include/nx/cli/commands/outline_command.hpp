@@ -22,6 +22,7 @@ public:
   std::string description() const override { return "Generate hierarchical outlines for topics using AI"; }
   
   void setupCommand(CLI::App* cmd) override;
+  ServiceSet requiredServices() const override { return {Service::kNoteStore, Service::kSearchIndex}; }
 
 private:
   // Outline node structure
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "nx/cli/application.hpp"
+#include "nx/index/caching_index.hpp"
+#include "nx/index/sqlite_index.hpp"
 
 namespace nx::cli {
 
@@ -13,6 +15,7 @@ public:
 
   Result<int> execute(const GlobalOptions& options) override;
   void setupCommand(CLI::App* cmd) override;
+  ServiceSet requiredServices() const override { return {Service::kNoteStore, Service::kSearchIndex}; }
 
 private:
   Application& app_;
@@ -26,6 +29,7 @@ private:
   
   // Subcommand implementations
   Result<int> executeRebuild();
+  Result<int> executeShadowRebuild(nx::index::SqliteIndex& search_index);
   Result<int> executeOptimize();
   Result<int> executeValidate();
   Result<int> executeStats();
@@ -14,6 +14,7 @@ public:
   std::string name() const override { return "rm"; }
   std::string description() const override { return "Remove a note"; }
   void setupCommand(CLI::App* cmd) override;
+  ServiceSet requiredServices() const override { return {Service::kNoteStore, Service::kSearchIndex}; }
 
 private:
   Application& app_;
@@ -20,6 +20,7 @@ public:
   std::string description() const override { return "Rewrite note content with different tone using AI"; }
   
   void setupCommand(CLI::App* cmd) override;
+  ServiceSet requiredServices() const override { return {Service::kNoteStore, Service::kSearchIndex}; }
 
 private:
   Application& app_;
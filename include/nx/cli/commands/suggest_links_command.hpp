@@ -21,6 +21,7 @@ public:
   std::string description() const override { return "Suggest links to related notes using AI"; }
   
   void setupCommand(CLI::App* cmd) override;
+  ServiceSet requiredServices() const override { return {Service::kNoteStore, Service::kSearchIndex}; }
 
 private:
   // Link suggestion structure
@@ -33,6 +34,9 @@ private:
     int insertion_point;         // Suggested line number to insert
   };
   
+  // Most similar notes offered to the AI
+  static constexpr size_t kMaxCandidates = 10;
+  
   Application& app_;
   
   // Command options
@@ -45,7 +49,7 @@ private:
   // Helper methods
   Result<void> validateAiConfig();
   Result<nx::core::Note> loadNote();
-  Result<std::vector<nx::core::Note>> getAllOtherNotes();
+  Result<std::vector<nx::core::Note>> getCandidateNotes(const nx::core::Note& note);
   Result<std::vector<LinkSuggestion>> suggestLinks(const nx::core::Note& note, const std::vector<nx::core::Note>& other_notes);
   Result<void> applyLinks(const std::vector<LinkSuggestion>& suggestions);
   void outputResult(const std::vector<LinkSuggestion>& suggestions, const GlobalOptions& options);
@@ -13,6 +13,7 @@ public:
   explicit SyncCommand(Application& app);
   
   void setupCommand(CLI::App* cmd) override;
+  ServiceSet requiredServices() const override { return {}; }
   Result<int> execute(const GlobalOptions& options) override;
   
   std::string name() const override { return "sync"; }
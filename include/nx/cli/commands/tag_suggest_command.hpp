@@ -21,6 +21,7 @@ public:
   std::string description() const override { return "Suggest tags for a note using AI"; }
   
   void setupCommand(CLI::App* cmd) override;
+  ServiceSet requiredServices() const override { return {Service::kNoteStore, Service::kSearchIndex}; }
 
 private:
   Application& app_;
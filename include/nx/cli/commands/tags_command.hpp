@@ -16,12 +16,14 @@ public:
   std::string name() const override { return "tags"; }
   std::string description() const override { return "Manage note tags"; }
   void setupCommand(CLI::App* cmd) override;
+  ServiceSet requiredServices() const override { return {Service::kNoteStore, Service::kSearchIndex}; }
 
 private:
   Application& app_;
   
   // List subcommand options
   bool show_count_ = false;
+  bool jsonl_ = false;
   
   // Add subcommand options
   std::string note_id_str_;
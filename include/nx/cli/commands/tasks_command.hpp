@@ -21,6 +21,7 @@ public:
   std::string description() const override { return "Extract action items and tasks from note content using AI"; }
   
   void setupCommand(CLI::App* cmd) override;
+  ServiceSet requiredServices() const override { return {Service::kNoteStore}; }
 
 private:
   // Task structure for JSON output
@@ -16,6 +16,7 @@ public:
   std::string name() const override { return "tpl"; }
   std::string description() const override { return "Template management"; }
   void setupCommand(CLI::App* cmd) override;
+  ServiceSet requiredServices() const override { return {Service::kNoteStore, Service::kTemplateManager}; }
 
 private:
   Application& app_;
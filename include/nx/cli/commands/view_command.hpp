@@ -14,6 +14,7 @@ public:
   std::string name() const override { return "view"; }
   std::string description() const override { return "View a note"; }
   void setupCommand(CLI::App* cmd) override;
+  ServiceSet requiredServices() const override { return {Service::kNoteStore}; }
 
 private:
   Application& app_;
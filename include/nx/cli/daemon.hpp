@@ -0,0 +1,109 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "nx/common.hpp"
+#include "nx/di/service_container.hpp"
+
+namespace nx::cli {
+
+/**
+ * @brief Long-lived process that runs nx commands against warm services
+ *
+ * `nx daemon start` keeps the config, note store, search index and their
+ * caches in memory and listens on a Unix domain socket. An `nx` invocation
+ * whose command is safe to run remotely (read-only, non-interactive, no
+ * editor, no stdin) hands its arguments to the daemon through forward() and prints
+ * what comes back, skipping config parsing, DI setup and index opening.
+ * Without a daemon, forward() fails fast and the command runs in-process
+ * as before.
+ *
+ * The socket's directory must belong to the user with mode 0700, and each
+ * end checks that the other runs as the same user; otherwise the daemon
+ * refuses to start and clients run in-process.
+ *
+ * Requests run one at a time; a client that stalls while sending its
+ * request or reading the reply is dropped after a short timeout. Notes
+ * changed by other processes are picked up before each request: on Linux an
+ * inotify watch on the notes directory names the changed notes, which are
+ * re-read and re-indexed; elsewhere the store cache is dropped on every
+ * request.
+ *
+ * Protocol: one JSON object per connection in each direction, newline
+ * terminated. A request carries `argv`, `cwd` and the `notes_dir` and
+ * `config` path the caller resolved; the reply carries `exit_code`, `stdout`
+ * and `stderr`, or `mismatch` when the daemon serves a different notes
+ * directory or config, in which case the caller runs the command itself.
+ * `{"ping": true}` and `{"shutdown": true}` serve `nx daemon status` and
+ * `nx daemon stop`.
+ */
+class Daemon {
+public:
+  struct Config {
+    std::filesystem::path socket_path;      // Empty uses defaultSocketPath()
+    std::filesystem::path notes_dir;        // Watched for changes made by other processes
+    std::chrono::minutes idle_timeout{0};   // Exit after this long without a request (0: never)
+    std::filesystem::path config_path;      // Config file the services were built from
+  };
+
+  Daemon(std::shared_ptr<nx::di::IServiceContainer> container, Config config);
+  ~Daemon();
+
+  Daemon(const Daemon&) = delete;
+  Daemon& operator=(const Daemon&) = delete;
+
+  /**
+   * @brief Listen and serve until stopped by `nx daemon stop`, SIGINT/SIGTERM or the idle timeout
+   */
+  Result<void> run();
+
+  /**
+   * @brief Answer one request in this process (output captured into the reply)
+   */
+  nlohmann::json handle(const nlohmann::json& request);
+
+  static std::filesystem::path defaultSocketPath();
+
+  /**
+   * @brief Whether an argument vector may run in the daemon
+   *
+   * Only listed read-only, non-interactive commands qualify (for tags, meta
+   * and notebook, only their read subcommands), and never with --config or
+   * --notes-dir, which would change the daemon's shared services.
+   */
+  static bool isForwardable(const std::vector<std::string>& args);
+
+  /**
+   * @brief Run a command through a running daemon, printing its output
+   * @return Exit code, or nullopt when the command should run in-process
+   *         (no daemon, NX_NO_DAEMON set, a command that cannot be forwarded, or a
+   *         daemon serving another notes directory or config)
+   */
+  static std::optional<int> forward(int argc, char* argv[]);
+
+  /**
+   * @brief Send one request to the daemon at socket_path and wait for the reply
+   */
+  static Result<nlohmann::json> request(const std::filesystem::path& socket_path, const nlohmann::json& message);
+
+private:
+  void syncChanges();
+
+  std::shared_ptr<nx::di::IServiceContainer> container_;
+  Config config_;
+  int listen_fd_ = -1;
+  int watch_fd_ = -1;
+  bool stopping_ = false;
+  uint64_t requests_ = 0;
+  std::chrono::steady_clock::time_point started_;
+};
+
+} // namespace nx::cli
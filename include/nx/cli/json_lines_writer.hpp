@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <ostream>
+
+#include <nlohmann/json.hpp>
+
+namespace nx::cli {
+
+/**
+ * @brief Writes one compact JSON object per line, flushed as it goes
+ *
+ * Backs the `--jsonl` output of listing commands: each record reaches the
+ * reader (`jq`, `head`, a pipe into another program) as soon as it is
+ * produced, and the command never holds more than the record in hand.
+ * Once the stream fails, typically because the reader went away, write()
+ * returns false so the producer can stop early.
+ */
+class JsonLinesWriter {
+public:
+  explicit JsonLinesWriter(std::ostream& out);
+
+  /**
+   * @brief Write a record; false when the stream can take no more output
+   */
+  bool write(const nlohmann::json& record);
+
+  size_t written() const { return written_; }
+
+private:
+  std::ostream& out_;
+  size_t written_ = 0;
+};
+
+} // namespace nx::cli
@@ -33,7 +33,9 @@ class Config {
   // Indexing configuration
   enum class IndexerType {
     kFts,      // SQLite FTS5
-    kRipgrep   // Fallback to ripgrep
+    kRipgrep,  // Fallback to ripgrep
+    kNative,   // Built-in grep engine, no external tool
+    kMemory    // In-memory BM25 index, snapshotted next to the SQLite index
   };
   IndexerType indexer = IndexerType::kFts;
   
@@ -119,7 +121,7 @@ class Config {
       int max_tokens = 500;                     // Maximum tokens for search analysis
       double temperature = 0.1;                // Low temperature for consistent results
       int timeout_ms = 5000;                   // Timeout for search requests
-      size_t max_notes_per_query = 50;         // Maximum notes to include in search prompt
+      size_t max_notes_per_query = 50;         // Local candidates sent to the AI for re-ranking
     };
     SemanticSearchConfig semantic_search;
     
@@ -496,6 +498,12 @@ class Config {
     std::string sqlite_journal_mode = "WAL";
     std::string sqlite_synchronous = "NORMAL";
     std::string sqlite_temp_store = "MEMORY";
+    std::string sqlite_fts_content = "full";  // "full" or "contentless" (postings only, smaller index)
+    std::vector<int> sqlite_fts_prefix = {2, 3};  // FTS5 prefix index lengths for search-as-you-type
+    size_t sqlite_write_batch = 0;      // Daemon index writes per write-behind commit (0: commit each write)
+    int sqlite_write_batch_ms = 200;    // Longest a daemon write-behind batch stays uncommitted
+    size_t search_cache_entries = 256;  // Repeat searches answered from memory (0: no result cache)
+    std::filesystem::path metrics_file;  // Per-run latency histograms appended here for `nx doctor` (empty: off)
   };
   PerformanceConfig performance;
   
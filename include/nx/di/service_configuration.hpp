@@ -47,6 +47,9 @@ private:
     static Result<void> configureIndexing(
         std::shared_ptr<IServiceContainer> container);
     
+    static std::shared_ptr<nx::index::Index> createIndexBackend(
+        std::shared_ptr<IServiceContainer> container);
+    
     static Result<void> configureTemplates(
         std::shared_ptr<IServiceContainer> container);
 };
@@ -1,11 +1,13 @@
 #pragma once
 
+#include <chrono>
 #include <functional>
 #include <memory>
 #include <string>
 #include <typeindex>
 #include <unordered_map>
 #include <type_traits>
+#include <vector>
 
 namespace nx::di {
 
@@ -34,6 +36,14 @@ private:
     std::string message_;
 };
 
+/**
+ * @brief Time spent constructing one service on its first resolve
+ */
+struct ServiceTiming {
+    std::type_index type;
+    std::chrono::nanoseconds elapsed;  // Excludes services its factory resolved for the first time
+};
+
 /**
  * @brief Interface for service registration and resolution
  */
@@ -103,6 +113,11 @@ public:
     bool isRegistered() const {
         return isRegisteredImpl(std::type_index(typeid(T)));
     }
+    
+    /**
+     * @brief Services constructed so far, in order of construction
+     */
+    virtual std::vector<ServiceTiming> constructionTimings() const { return {}; }
 
 protected:
     virtual void registerServiceImpl(std::type_index type,
@@ -140,6 +155,8 @@ public:
     // Movable
     ServiceContainer(ServiceContainer&&) = default;
     ServiceContainer& operator=(ServiceContainer&&) = default;
+    
+    std::vector<ServiceTiming> constructionTimings() const override;
 
 protected:
     void registerServiceImpl(std::type_index type,
@@ -161,6 +178,11 @@ private:
     };
     
     std::unordered_map<std::type_index, ServiceDescriptor> services_;
+    
+    // Factories run lazily and may resolve their own dependencies; each open
+    // construction accumulates the time of the ones nested inside it
+    std::vector<std::chrono::nanoseconds> nested_time_;
+    std::vector<ServiceTiming> timings_;
 };
 
 /**
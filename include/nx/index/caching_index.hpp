@@ -0,0 +1,130 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+#include "nx/common.hpp"
+#include "nx/index/index.hpp"
+
+namespace nx::index {
+
+/**
+ * @brief Result cache in front of another Index
+ *
+ * Searches, counts, pages and suggestions are remembered under a normalized
+ * form of the query. Every write made through this wrapper bumps a
+ * generation counter, and each entry also records the inner index's
+ * changeCounter(); an entry only answers while both are current. A repeat
+ * query costs one hash lookup plus the counter check, and never sees results
+ * from before a write, whether made through the wrapper, around it or by
+ * another process.
+ *
+ * Least recently used entries are evicted past Config::capacity. Hits and
+ * misses are reported through getStats().
+ */
+class CachingIndex : public Index {
+public:
+  struct Config {
+    size_t capacity = 256;  // Cached answers kept
+    // Tokenizing backends ignore spacing, so "a  b" and "a b" share an entry; literal
+    // matchers (ripgrep, native grep) need the text as typed
+    bool collapse_whitespace = true;
+  };
+
+  explicit CachingIndex(std::shared_ptr<Index> inner);
+  CachingIndex(std::shared_ptr<Index> inner, Config config);
+
+  // Index management
+  Result<void> initialize() override;
+  Result<void> addNote(const nx::core::Note& note) override;
+  Result<void> updateNote(const nx::core::Note& note) override;
+  Result<void> removeNote(const nx::core::NoteId& id) override;
+  Result<void> rebuild() override;
+  Result<void> optimize() override;
+  Result<void> vacuum() override;
+
+  // Search operations
+  Result<std::vector<SearchResult>> search(const SearchQuery& query) override;
+  Result<std::vector<nx::core::NoteId>> searchIds(const SearchQuery& query) override;
+  Result<size_t> searchCount(const SearchQuery& query) override;
+  Result<SearchPage> searchPage(const SearchQuery& query) override;
+  Result<size_t> searchEach(const SearchQuery& query, const SearchVisitor& visit) override;
+  Result<std::vector<nx::core::NoteId>> scanCandidates(const std::string& pattern,
+                                                       bool is_regex = false) override;
+
+  // Suggestions and autocompletion
+  Result<std::vector<std::string>> suggestTags(const std::string& prefix, size_t limit = 10) override;
+  Result<std::vector<std::string>> suggestNotebooks(const std::string& prefix, size_t limit = 10) override;
+  Result<std::vector<TagCount>> getTagCounts() override;
+  Result<IndexAggregates> aggregate(const AggregateQuery& query) override;
+  Result<SearchExplain> explainSearch(const SearchQuery& query) override;
+
+  uint64_t changeCounter() override;
+
+  // Statistics and health
+  Result<IndexStats> getStats() override;
+  Result<bool> isHealthy() override;
+  Result<void> validateIndex() override;
+
+  // Batch operations for performance
+  Result<void> beginTransaction() override;
+  Result<void> commitTransaction() override;
+  Result<void> rollbackTransaction() override;
+  Result<void> savepoint() override;
+  Result<void> releaseSavepoint() override;
+  Result<void> rollbackToSavepoint() override;
+
+  /**
+   * @brief The wrapped index, for backend-specific operations
+   */
+  Index& inner() { return *inner_; }
+
+  /**
+   * @brief Drop every cached answer (bumps the generation)
+   */
+  void invalidate();
+
+  uint64_t generation() const;
+
+  /**
+   * @brief Cache key for a query: the text (whitespace-collapsed if asked), sorted tags and
+   *        every other field
+   */
+  static std::string normalize(const SearchQuery& query, bool collapse_whitespace = true);
+
+private:
+  using Value = std::variant<std::vector<SearchResult>, std::vector<nx::core::NoteId>, size_t, SearchPage,
+                             std::vector<std::string>, std::vector<TagCount>, IndexAggregates>;
+
+  struct Entry {
+    std::string key;
+    uint64_t generation;
+    uint64_t change_counter;  // Inner changeCounter() when computed
+    Value value;
+  };
+
+  template <typename T, typename Compute>
+  Result<T> cached(std::string key, Compute&& compute);
+
+  // Callers hold mutex_
+  void store(std::string key, uint64_t generation, uint64_t change_counter, Value value);
+  std::string queryKey(const char* kind, const SearchQuery& query) const;
+
+  std::shared_ptr<Index> inner_;
+  Config config_;
+
+  mutable std::mutex mutex_;
+  uint64_t generation_ = 0;
+  std::list<Entry> entries_;  // Most recently used first
+  std::unordered_map<std::string, std::list<Entry>::iterator> lookup_;
+  size_t hits_ = 0;
+  size_t misses_ = 0;
+};
+
+}  // namespace nx::index
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "nx/common.hpp"
+
+namespace nx::index {
+
+/**
+ * @brief Turns text into a fixed-length vector for similarity search
+ *
+ * Vectors are compared by cosine similarity, so implementations should
+ * return unit-length vectors (an all-zero vector means "no signal").
+ */
+class Embedder {
+public:
+  virtual ~Embedder() = default;
+
+  virtual size_t dimensions() const = 0;
+
+  // Identifies the model; vectors from embedders with different names never mix
+  virtual std::string name() const = 0;
+
+  virtual Result<std::vector<float>> embed(const std::string& text) = 0;
+};
+
+/**
+ * @brief Offline embedder using signed feature hashing
+ *
+ * Each word and word bigram is hashed to a dimension and a sign, weighted by
+ * 1 + log(tf), and the result is L2-normalized. This is a sparse random
+ * projection of the TF vector: notes sharing vocabulary land close together
+ * without a model, a network, or any per-vault training.
+ */
+class HashingEmbedder : public Embedder {
+public:
+  struct Config {
+    size_t dimensions = 256;
+    bool bigrams = true;
+  };
+
+  HashingEmbedder();
+  explicit HashingEmbedder(Config config);
+
+  size_t dimensions() const override { return config_.dimensions; }
+  std::string name() const override;
+  Result<std::vector<float>> embed(const std::string& text) override;
+
+private:
+  Config config_;
+};
+
+/**
+ * @brief Caches another embedder's vectors by content hash
+ *
+ * Meant for provider embeddings, where every call costs a request: unchanged
+ * text is never sent twice, and the cache survives restarts when given a file.
+ * A cache file written for a different model is ignored.
+ */
+class CachingEmbedder : public Embedder {
+public:
+  struct Config {
+    std::filesystem::path cache_file;  // Empty keeps the cache in memory only
+  };
+
+  CachingEmbedder(std::shared_ptr<Embedder> inner, Config config);
+  ~CachingEmbedder() override;
+
+  size_t dimensions() const override { return inner_->dimensions(); }
+  std::string name() const override { return inner_->name(); }
+  Result<std::vector<float>> embed(const std::string& text) override;
+
+  // Writes new entries to the cache file
+  Result<void> flush();
+
+  size_t cachedCount() const;
+
+private:
+  Result<void> load();
+
+  std::shared_ptr<Embedder> inner_;
+  Config config_;
+  mutable std::mutex mutex_;
+  std::unordered_map<uint64_t, std::vector<float>> cache_;
+  bool dirty_ = false;
+};
+
+}  // namespace nx::index
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <span>
+#include <vector>
+
+#include "nx/common.hpp"
+
+namespace nx::index {
+
+/**
+ * @brief Hierarchical navigable small world graph for approximate k-NN
+ *
+ * Stores unit vectors and answers nearest-neighbour queries by cosine
+ * distance (1 - dot product) in roughly logarithmic time. Nodes are numbered
+ * in insertion order; callers map them to their own keys.
+ *
+ * Removal only marks a node deleted: it keeps routing searches but is never
+ * returned. Rebuild from the live vectors once too many accumulate.
+ */
+class HnswIndex {
+public:
+  struct Config {
+    size_t dimensions = 256;
+    size_t m = 16;                 // Links per node on upper layers (2 * m on layer 0)
+    size_t ef_construction = 100;  // Beam width while inserting
+    size_t ef_search = 64;         // Default beam width while searching
+    uint64_t seed = 42;            // Level assignment, for reproducible graphs
+  };
+
+  struct Neighbor {
+    uint32_t node;
+    float distance;
+  };
+
+  HnswIndex();
+  explicit HnswIndex(Config config);
+
+  const Config& config() const { return config_; }
+
+  /**
+   * @brief Add a vector (of config().dimensions values) and return its node number
+   */
+  uint32_t insert(std::span<const float> vector);
+
+  void markDeleted(uint32_t node);
+  bool isDeleted(uint32_t node) const { return deleted_[node] != 0; }
+
+  /**
+   * @brief The k live nodes nearest to query, closest first
+   * @param ef Beam width; 0 uses config().ef_search (never less than k)
+   */
+  std::vector<Neighbor> search(std::span<const float> query, size_t k, size_t ef = 0) const;
+
+  std::span<const float> vector(uint32_t node) const;
+
+  size_t size() const { return levels_.size(); }
+  size_t deletedCount() const { return deleted_count_; }
+
+  void save(std::ostream& out) const;
+  static Result<HnswIndex> load(std::istream& in);
+
+private:
+  using Candidates = std::vector<Neighbor>;
+
+  float distance(std::span<const float> query, uint32_t node) const;
+  float distance(uint32_t a, uint32_t b) const;
+  size_t randomLevel();
+  size_t maxLinks(size_t level) const { return level == 0 ? 2 * config_.m : config_.m; }
+
+  uint32_t greedyClosest(std::span<const float> query, uint32_t entry, size_t level) const;
+  Candidates searchLayer(std::span<const float> query, const std::vector<uint32_t>& entries,
+                         size_t ef, size_t level) const;
+  std::vector<uint32_t> selectNeighbors(Candidates candidates, size_t limit) const;
+  void connect(uint32_t node, uint32_t neighbor, size_t level);
+
+  Config config_;
+  std::vector<float> vectors_;                            // size() * dimensions
+  std::vector<uint8_t> levels_;                           // Top layer of each node
+  std::vector<std::vector<std::vector<uint32_t>>> links_;  // [node][level] -> neighbours
+  std::vector<uint8_t> deleted_;
+  size_t deleted_count_ = 0;
+  uint32_t entry_point_ = 0;
+  size_t max_level_ = 0;
+  uint64_t rng_state_;
+};
+
+}  // namespace nx::index
@@ -5,10 +5,12 @@
 #include <optional>
 #include <chrono>
 #include <filesystem>
+#include <functional>
 
 #include "nx/common.hpp"
 #include "nx/core/note_id.hpp"
 #include "nx/core/note.hpp"
+#include "nx/index/query_expr.hpp"
 
 namespace nx::index {
 
@@ -23,6 +25,12 @@ struct SearchResult {
   std::optional<std::string> notebook;
 };
 
+// One page of ranked results plus the number of matches across all pages
+struct SearchPage {
+  std::vector<SearchResult> results;
+  size_t total = 0;
+};
+
 // Search query configuration
 struct SearchQuery {
   std::string text;                    // FTS query text
@@ -33,6 +41,58 @@ struct SearchQuery {
   size_t limit = 50;                   // Max results
   size_t offset = 0;                   // Pagination offset
   bool highlight = true;               // Include snippet highlighting
+  bool prefix_last_term = false;       // Search-as-you-type: plain words, last one a prefix
+  std::optional<QueryExpr> expr;       // Boolean filter from QueryParser, ANDed with the fields above
+};
+
+// One step of an explained search
+struct ExplainPhase {
+  std::string name;                 // parse, execute, snippet, result construction, store loads
+  std::chrono::nanoseconds elapsed{0};
+  std::optional<size_t> rows;       // Rows this step produced, where it has a count
+};
+
+// How a search ran: what was compiled, the engine's plan and where the time went
+struct SearchExplain {
+  std::string backend;
+  std::string compiled_query;           // FTS MATCH text, or the rg command line
+  std::string sql;                      // Statement run; empty for backends without SQL
+  std::vector<std::string> query_plan;  // EXPLAIN QUERY PLAN rows, indented by depth
+  std::vector<ExplainPhase> phases;     // In the order they ran
+  SearchPage page;                      // What searchPage() returns for the same query
+};
+
+// Tag with the number of notes carrying it
+struct TagCount {
+  std::string tag;
+  size_t count = 0;
+};
+
+// What aggregate() groups over
+struct AggregateQuery {
+  std::chrono::system_clock::time_point recent_since;  // Notes modified at or after count as recent
+  std::string skip_title_prefix;                       // Notes titled with this prefix are only counted as skipped
+};
+
+// Totals for the notes of one notebook
+struct NotebookAggregate {
+  std::optional<std::string> notebook;  // nullopt for notes outside any notebook
+  size_t note_count = 0;
+  size_t skipped_count = 0;             // Notes matching AggregateQuery::skip_title_prefix
+  size_t total_size = 0;                // Content bytes
+  size_t recent_notes = 0;
+  std::chrono::system_clock::time_point first_created;
+  std::chrono::system_clock::time_point last_modified;
+  std::vector<TagCount> tags;           // By tag name
+};
+
+// Counts over every indexed note, computed without loading any note
+struct IndexAggregates {
+  std::vector<TagCount> tags;                // By tag name
+  std::vector<NotebookAggregate> notebooks;  // By notebook name, notes outside any notebook first
+  size_t total_notes = 0;
+  size_t total_size = 0;
+  size_t recent_notes = 0;
 };
 
 // Index statistics
@@ -42,6 +102,8 @@ struct IndexStats {
   size_t index_size_bytes = 0;
   std::chrono::system_clock::time_point last_updated;
   std::chrono::system_clock::time_point last_optimized;
+  size_t cache_hits = 0;    // Answers served by CachingIndex (zero without one)
+  size_t cache_misses = 0;
 };
 
 // Abstract index interface
@@ -62,10 +124,36 @@ public:
   virtual Result<std::vector<SearchResult>> search(const SearchQuery& query) = 0;
   virtual Result<std::vector<nx::core::NoteId>> searchIds(const SearchQuery& query) = 0;
   virtual Result<size_t> searchCount(const SearchQuery& query) = 0;
+  virtual Result<SearchPage> searchPage(const SearchQuery& query) = 0;  // Page + total in one pass
+  
+  // search() results handed to visit as they are produced, until it returns false; returns
+  // how many were visited. visit must not call back into the index. The default runs search()
+  // first; backends with a row cursor stream straight from it.
+  using SearchVisitor = std::function<bool(const SearchResult&)>;
+  virtual Result<size_t> searchEach(const SearchQuery& query, const SearchVisitor& visit);
+  
+  // Candidate notes for a substring (or ECMAScript regex) scan: a superset of the notes
+  // whose content can match, so callers run the exact matcher on fewer notes
+  virtual Result<std::vector<nx::core::NoteId>> scanCandidates(const std::string& pattern,
+                                                               bool is_regex = false) = 0;
 
   // Suggestions and autocompletion
   virtual Result<std::vector<std::string>> suggestTags(const std::string& prefix, size_t limit = 10) = 0;
   virtual Result<std::vector<std::string>> suggestNotebooks(const std::string& prefix, size_t limit = 10) = 0;
+  virtual Result<std::vector<TagCount>> getTagCounts() = 0;
+  
+  // Tag, notebook and notebook+tag counts with size and activity totals. The default
+  // reports kNotImplemented; callers then fall back to reading notes from the store.
+  virtual Result<IndexAggregates> aggregate(const AggregateQuery& query);
+  
+  // Runs query as searchPage() would, timing each phase, for `nx grep --explain`. Never
+  // answered from a cache. The default reports kNotImplemented.
+  virtual Result<SearchExplain> explainSearch(const SearchQuery& query);
+  
+  // Opaque value that changes whenever the indexed data may have changed, including through
+  // another process or a swapped-in file; caches compare it on every lookup. The default
+  // never changes, for backends only this object writes to.
+  virtual uint64_t changeCounter();
   
   // Statistics and health
   virtual Result<IndexStats> getStats() = 0;
@@ -76,6 +164,13 @@ public:
   virtual Result<void> beginTransaction() = 0;
   virtual Result<void> commitTransaction() = 0;
   virtual Result<void> rollbackTransaction() = 0;
+
+  // Rollback point inside a transaction, so one failed step can be undone without
+  // discarding the rest. Savepoints nest; release and rollback act on the innermost.
+  // The default reports kNotImplemented.
+  virtual Result<void> savepoint();
+  virtual Result<void> releaseSavepoint();
+  virtual Result<void> rollbackToSavepoint();
 };
 
 // Index factory
@@ -83,6 +178,7 @@ class IndexFactory {
 public:
   static std::unique_ptr<Index> createSqliteIndex(const std::filesystem::path& db_path);
   static std::unique_ptr<Index> createRipgrepIndex(const std::filesystem::path& notes_dir);
+  static std::unique_ptr<Index> createMemoryIndex(const std::filesystem::path& snapshot_file);
 };
 
 }  // namespace nx::index
\ No newline at end of file
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "nx/common.hpp"
+#include "nx/core/note.hpp"
+#include "nx/core/note_id.hpp"
+#include "nx/index/note_manifest.hpp"
+
+namespace nx::index {
+
+/**
+ * @brief Graph of explicit links between notes in compressed sparse row form
+ *
+ * Links are ULID links in content or front matter ([text](01ABC...)) and
+ * wiki-links ([[Title]], [[01ABC...|alias]]). Each note's link targets are kept
+ * as written, so a note is only re-parsed when it changes; wiki-links resolve
+ * against current titles when the adjacency arrays are rebuilt.
+ *
+ * Outgoing and incoming edges are stored as offset/target arrays, so
+ * backlinks and neighbours cost O(degree) and traversals touch contiguous
+ * memory. The arrays are rebuilt in O(notes + links) on the first query
+ * after a change and persisted with the snapshot.
+ */
+class LinkGraph {
+public:
+  struct Config {
+    std::filesystem::path snapshot_file;  // Empty keeps the graph in memory only
+  };
+
+  enum class Direction { kOutgoing, kIncoming, kBoth };
+
+  struct Neighbor {
+    nx::core::NoteId id;
+    size_t distance;  // Hops from the starting note
+  };
+
+  struct Ranked {
+    nx::core::NoteId id;
+    double score;  // PageRank; scores over all notes sum to 1
+  };
+
+  struct Stats {
+    size_t notes = 0;
+    size_t links = 0;
+    size_t unresolved_links = 0;  // Targets that name no known note
+    size_t components = 0;
+    size_t isolated = 0;          // Notes with no links either way
+  };
+
+  // Loads the given notes (missing ones are skipped)
+  using NoteLoader = std::function<Result<std::vector<nx::core::Note>>(const std::vector<nx::core::NoteId>&)>;
+
+  LinkGraph();
+  explicit LinkGraph(Config config);
+  ~LinkGraph();
+
+  /**
+   * @brief Open the persisted graph under cache_dir and catch up with notes_dir
+   *
+   * Only notes whose file changed since the last run are loaded and re-parsed.
+   */
+  static Result<std::unique_ptr<LinkGraph>> openForNotes(const std::filesystem::path& notes_dir,
+                                                         const std::filesystem::path& cache_dir,
+                                                         const NoteLoader& loader);
+
+  /**
+   * @brief Read the snapshot; a missing file starts empty
+   */
+  Result<void> load();
+  Result<void> save();
+
+  /**
+   * @brief Bring the graph in line with a manifest, loading only changed notes
+   * @return Number of notes (re)parsed
+   */
+  Result<size_t> refresh(const NoteManifest& manifest, const NoteLoader& loader);
+
+  /**
+   * @brief Bring the graph in line with notes already in memory
+   * @return Number of notes (re)parsed
+   */
+  size_t sync(const std::vector<nx::core::Note>& notes);
+
+  void upsert(const nx::core::Note& note);
+  void remove(const nx::core::NoteId& id);
+
+  // Deduplicated and sorted; self-links are dropped
+  std::vector<nx::core::NoteId> outgoing(const nx::core::NoteId& id) const;
+  std::vector<nx::core::NoteId> backlinks(const nx::core::NoteId& id) const;
+
+  /**
+   * @brief Notes within `hops` links of a note, nearest first (the note itself excluded)
+   */
+  std::vector<Neighbor> neighborhood(const nx::core::NoteId& id, size_t hops,
+                                     Direction direction = Direction::kBoth) const;
+
+  /**
+   * @brief Fewest-hop path between two notes, both ends included; empty if unreachable
+   */
+  std::vector<nx::core::NoteId> shortestPath(const nx::core::NoteId& from, const nx::core::NoteId& to,
+                                             Direction direction = Direction::kOutgoing) const;
+
+  /**
+   * @brief Weakly connected components of at least min_size notes, largest first
+   */
+  std::vector<std::vector<nx::core::NoteId>> components(size_t min_size = 1) const;
+
+  /**
+   * @brief The k most central notes by PageRank over outgoing links
+   */
+  std::vector<Ranked> centrality(size_t k, size_t iterations = 50, double damping = 0.85) const;
+
+  Stats stats() const;
+  bool contains(const nx::core::NoteId& id) const;
+  size_t size() const;
+
+private:
+  struct NoteLinks {
+    std::string title_key;             // Lowercased title, for wiki-link resolution
+    uint64_t version = 0;
+    std::vector<std::string> targets;  // ULIDs, or "[[" + lowercased title for wiki-links
+  };
+
+  // Callers hold mutex_
+  void putLocked(const nx::core::Note& note, uint64_t version);
+  void ensureBuiltLocked() const;
+  bool nodeOf(const nx::core::NoteId& id, uint32_t& node) const;
+  std::vector<nx::core::NoteId> idsOf(const uint32_t* begin, const uint32_t* end) const;
+  template <typename Visit>
+  void forEachNeighbor(uint32_t node, Direction direction, Visit&& visit) const;
+  size_t countComponentsLocked() const;
+
+  Config config_;
+
+  mutable std::mutex mutex_;
+  std::map<std::string, NoteLinks> notes_;  // Note ID -> links; ordered so node numbers are stable
+  bool dirty_ = false;
+
+  // Adjacency, rebuilt from notes_ when stale
+  mutable bool stale_ = true;
+  mutable std::vector<std::string> node_ids_;                        // Node -> note ID
+  mutable std::unordered_map<std::string, uint32_t> node_numbers_;   // Note ID -> node
+  mutable std::vector<uint32_t> out_offsets_;                        // Node -> first entry in out_targets_
+  mutable std::vector<uint32_t> out_targets_;
+  mutable std::vector<uint32_t> in_offsets_;
+  mutable std::vector<uint32_t> in_sources_;
+  mutable size_t unresolved_ = 0;
+};
+
+}  // namespace nx::index
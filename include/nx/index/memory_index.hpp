@@ -0,0 +1,163 @@
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "nx/common.hpp"
+#include "nx/core/note.hpp"
+#include "nx/index/index.hpp"
+#include "nx/index/posting_list.hpp"
+
+namespace nx::index {
+
+/**
+ * @brief In-memory BM25 inverted index
+ *
+ * Keeps compressed postings (see PostingList) for every term in RAM, so
+ * queries never touch disk. Multi-term AND queries intersect block by block,
+ * driven by the rarest term; OR queries use block-max WAND to skip documents
+ * that cannot reach the current top-k. The whole index can be snapshotted to
+ * a single file and loaded back on start.
+ *
+ * Query text understands FTS5's everyday syntax: implicit AND, OR, NOT or
+ * -term, "quoted phrases" and term* prefixes (AND binds tighter than OR;
+ * parentheses and column filters are ignored). Boolean filters from
+ * QueryParser (SearchQuery::expr) are resolved to a document bitmap before
+ * ranking, and every match is checked against it.
+ *
+ * Removing a note only marks it deleted; postings are compacted by optimize()
+ * and rebuild().
+ */
+class MemoryIndex : public Index {
+public:
+  // Supplies the current body of a note for snippets and phrase checks
+  using ContentProvider = std::function<std::optional<std::string>(const nx::core::NoteId&)>;
+  // Every note, for rebuild() and for building when no snapshot exists
+  using NoteSource = std::function<Result<std::vector<nx::core::Note>>()>;
+
+  struct Config {
+    std::filesystem::path snapshot_file;  // Empty keeps the index in memory only
+    ContentProvider content_provider;     // Unset keeps note bodies in memory
+    NoteSource note_source;
+  };
+
+  MemoryIndex();
+  explicit MemoryIndex(Config config);
+  ~MemoryIndex() override;
+
+  // Index management
+  Result<void> initialize() override;
+  Result<void> addNote(const nx::core::Note& note) override;
+  Result<void> updateNote(const nx::core::Note& note) override;
+  Result<void> removeNote(const nx::core::NoteId& id) override;
+  Result<void> rebuild() override;
+  Result<void> optimize() override;
+  Result<void> vacuum() override;
+
+  // Search operations
+  Result<std::vector<SearchResult>> search(const SearchQuery& query) override;
+  Result<std::vector<nx::core::NoteId>> searchIds(const SearchQuery& query) override;
+  Result<size_t> searchCount(const SearchQuery& query) override;
+  Result<SearchPage> searchPage(const SearchQuery& query) override;
+  Result<std::vector<nx::core::NoteId>> scanCandidates(const std::string& pattern,
+                                                       bool is_regex = false) override;
+
+  // Suggestions and autocompletion
+  Result<std::vector<std::string>> suggestTags(const std::string& prefix, size_t limit = 10) override;
+  Result<std::vector<std::string>> suggestNotebooks(const std::string& prefix, size_t limit = 10) override;
+  Result<std::vector<TagCount>> getTagCounts() override;
+
+  // Statistics and health
+  Result<IndexStats> getStats() override;
+  Result<bool> isHealthy() override;
+  Result<void> validateIndex() override;
+
+  // Snapshot writes are deferred until commit; rollback reloads the last snapshot
+  Result<void> beginTransaction() override;
+  Result<void> commitTransaction() override;
+  Result<void> rollbackTransaction() override;
+
+  /**
+   * @brief Write the index to the snapshot file (no-op without one)
+   */
+  Result<void> saveSnapshot();
+
+private:
+  struct Document {
+    nx::core::NoteId id;
+    std::string title;
+    std::chrono::system_clock::time_point created;
+    std::chrono::system_clock::time_point modified;
+    std::vector<std::string> tags;
+    std::optional<std::string> notebook;
+    uint32_t length = 0;      // Indexed tokens, title included
+    bool live = true;
+    std::string content;      // Only kept without a content provider
+  };
+
+  struct Match {
+    uint32_t doc;
+    double score;
+  };
+
+  struct Clause;  // AND of query terms (see memory_index.cpp)
+
+  // Callers hold mutex_
+  void indexNote(const nx::core::Note& note);
+  void markDeleted(const nx::core::NoteId& id);
+  void compact();
+  void clearAll();
+
+  // Evaluation (callers hold mutex_). top_k == 0 means every match, in doc order.
+  std::vector<Match> evaluate(const SearchQuery& query, size_t top_k,
+                              std::vector<std::string>* highlight_terms = nullptr) const;
+  std::vector<Match> rank(const SearchQuery& query, size_t top_k,
+                          std::vector<std::string>* highlight_terms) const;
+  std::vector<Match> matchClause(const Clause& clause, const SearchQuery& query) const;
+  std::vector<Match> topKDisjunction(const std::vector<const PostingList*>& lists,
+                                     const SearchQuery& query, size_t top_k) const;
+  std::vector<Match> metadataMatches(const SearchQuery& query) const;
+  bool passesFilters(uint32_t doc, const SearchQuery& query) const;
+  std::vector<bool> exprDocs(const QueryExpr& expr) const;  // By document number
+  std::vector<Match> textMatches(const QueryExpr& leaf) const;
+  bool containsPhrase(uint32_t doc, const std::vector<std::string>& tokens) const;
+  std::optional<std::string> contentOf(uint32_t doc) const;
+
+  double idf(const PostingList& list) const;
+  double termScore(double idf, uint32_t tf, uint32_t doc_length) const;
+
+  // Candidate documents for a literal substring; nullopt when nothing rules notes out
+  std::optional<std::vector<uint32_t>> literalCandidates(const std::string& literal) const;
+  const PostingList* prefixList(const std::string& prefix, PostingList& storage) const;
+
+  // Terms to mark in snippets; a trailing '*' marks a prefix
+  SearchResult toResult(const Match& match, const std::vector<std::string>& highlight_terms,
+                        bool highlight) const;
+
+  Result<void> loadSnapshot();
+  Result<void> writeSnapshot();
+
+  Config config_;
+  mutable std::mutex mutex_;
+
+  std::vector<Document> docs_;                          // By document number
+  std::unordered_map<std::string, uint32_t> doc_numbers_;  // Note ID -> live document number
+  std::map<std::string, PostingList> terms_;            // Ordered for prefix expansion
+  size_t live_docs_ = 0;
+  uint64_t live_length_ = 0;
+  mutable const std::vector<bool>* allowed_ = nullptr;  // exprDocs() of the query being evaluated
+
+  bool dirty_ = false;
+  bool in_transaction_ = false;
+  std::chrono::system_clock::time_point last_updated_;
+  std::chrono::system_clock::time_point last_optimized_;
+};
+
+}  // namespace nx::index
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "nx/common.hpp"
+#include "nx/core/note.hpp"
+#include "nx/core/note_id.hpp"
+#include "nx/index/note_manifest.hpp"
+
+namespace nx::index {
+
+/**
+ * @brief Related-note lookup with MinHash signatures and banded LSH
+ *
+ * Each note is reduced to the set of its word shingles and summarized by a
+ * MinHash signature, whose per-position agreement estimates the Jaccard
+ * similarity of two notes. Signatures are cut into bands and every band is
+ * hashed into a bucket, so only notes sharing a bucket are ever compared and
+ * a lookup costs a few bucket scans instead of a pass over the vault.
+ *
+ * With the default 64 bands of 2 rows, pairs with similarity 0.2 share a
+ * bucket about 93% of the time and pairs above 0.5 practically always do.
+ */
+class MinHashIndex {
+public:
+  struct Config {
+    std::filesystem::path snapshot_file;  // Empty keeps the index in memory only
+    size_t num_hashes = 128;              // Signature length; must be a multiple of bands
+    size_t bands = 64;
+    size_t shingle_size = 1;              // Words per shingle: 1 for topics, 3+ for copies
+    uint64_t seed = 0x6e78;
+  };
+
+  struct Match {
+    nx::core::NoteId id;
+    double similarity;  // Estimated Jaccard similarity of the shingle sets
+  };
+
+  struct DuplicatePair {
+    nx::core::NoteId first;
+    nx::core::NoteId second;
+    double similarity;
+  };
+
+  // Loads the given notes (missing ones are skipped)
+  using NoteLoader = std::function<Result<std::vector<nx::core::Note>>(const std::vector<nx::core::NoteId>&)>;
+
+  MinHashIndex();
+  explicit MinHashIndex(Config config);
+  ~MinHashIndex();
+
+  /**
+   * @brief Open the persisted index under cache_dir and catch up with notes_dir
+   *
+   * Files are compared by mtime and size through a NoteManifest, so only
+   * notes whose file changed since the last run are loaded and re-hashed.
+   */
+  static Result<std::unique_ptr<MinHashIndex>> openForNotes(const std::filesystem::path& notes_dir,
+                                                            const std::filesystem::path& cache_dir,
+                                                            const NoteLoader& loader);
+
+  /**
+   * @brief Read the snapshot; a missing file or different settings start empty
+   */
+  Result<void> load();
+  Result<void> save();
+
+  /**
+   * @brief Bring the index in line with a manifest, loading only changed notes
+   * @return Number of notes (re)hashed
+   */
+  Result<size_t> refresh(const NoteManifest& manifest, const NoteLoader& loader);
+
+  /**
+   * @brief Bring the index in line with notes already in memory
+   * @return Number of notes (re)hashed
+   */
+  size_t sync(const std::vector<nx::core::Note>& notes);
+
+  // version identifies the content (a hash or file stamp); unchanged versions are skipped
+  void upsert(const nx::core::Note& note);
+  void upsert(const nx::core::NoteId& id, const std::string& text, uint64_t version);
+  void remove(const nx::core::NoteId& id);
+
+  /**
+   * @brief The k notes most similar to an indexed note, best first
+   */
+  std::vector<Match> similar(const nx::core::NoteId& id, size_t k, double min_similarity = 0.0) const;
+
+  /**
+   * @brief The k notes most similar to arbitrary text, best first
+   */
+  std::vector<Match> similarToText(const std::string& text, size_t k, double min_similarity = 0.0) const;
+
+  /**
+   * @brief Every pair of notes at or above the similarity threshold, most similar first
+   */
+  std::vector<DuplicatePair> duplicates(double threshold) const;
+
+  bool contains(const nx::core::NoteId& id) const;
+  size_t size() const;
+
+  // The text that is shingled for a note: tags, then the content
+  static std::string indexedText(const nx::core::Note& note);
+
+private:
+  using Signature = std::vector<uint32_t>;
+
+  struct Document {
+    std::string id;
+    uint64_t version = 0;
+    Signature signature;
+    bool live = false;
+  };
+
+  // Callers hold mutex_
+  Signature signatureOf(const std::string& text) const;
+  uint64_t bandKey(const Signature& signature, size_t band) const;
+  double estimate(const Signature& a, const Signature& b) const;
+  void insertLocked(const std::string& key, uint64_t version, Signature signature);
+  void removeLocked(const std::string& key);
+  std::vector<Match> rank(const Signature& signature, uint32_t self, size_t k, double min_similarity) const;
+  void clearLocked();
+
+  Config config_;
+  size_t rows_;
+  std::vector<uint64_t> multipliers_;  // One hash function per signature position
+  std::vector<uint64_t> offsets_;
+
+  mutable std::mutex mutex_;
+  std::vector<Document> docs_;                                    // By document number
+  std::vector<uint32_t> free_docs_;                               // Reusable document numbers
+  std::unordered_map<std::string, uint32_t> doc_numbers_;         // Note ID -> document number
+  std::unordered_map<uint64_t, std::vector<uint32_t>> buckets_;   // Band key -> documents
+  bool dirty_ = false;
+};
+
+}  // namespace nx::index
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "nx/common.hpp"
+#include "nx/core/note.hpp"
+#include "nx/index/index.hpp"
+#include "nx/index/note_manifest.hpp"
+
+namespace nx::index {
+
+/**
+ * @brief In-process grep engine over the notes directory
+ *
+ * A scanning backend like RipgrepIndex, but with no external tool: files are
+ * read and searched on worker threads inside the process, so short queries
+ * don't pay for fork/exec and hosts without ripgrep still get search.
+ *
+ * Query text is matched as a case-insensitive literal. The matcher anchors on
+ * the needle's rarest byte and scans for it (both cases) a vector at a time,
+ * verifying the full needle only at candidate positions. Regex candidate scans
+ * first require the literals every match must contain (see TrigramQuery), then
+ * confirm survivors with std::regex.
+ */
+class NativeGrepIndex : public Index {
+public:
+  struct Config {
+    // Worker threads for a scan; 0 uses the hardware concurrency (capped at 8)
+    size_t threads = 0;
+    // Below this many files a scan runs on the calling thread
+    size_t parallel_threshold = 64;
+    // Persisted metadata manifest (see NoteManifest); empty keeps it in memory only
+    std::filesystem::path cache_file;
+  };
+
+  explicit NativeGrepIndex(std::filesystem::path notes_dir);
+  NativeGrepIndex(std::filesystem::path notes_dir, Config config);
+  ~NativeGrepIndex() override = default;
+
+  // Index lifecycle
+  Result<void> initialize() override;
+
+  // Note operations
+  Result<void> addNote(const nx::core::Note& note) override;
+  Result<void> updateNote(const nx::core::Note& note) override;
+  Result<void> removeNote(const nx::core::NoteId& id) override;
+
+  // Search operations
+  Result<std::vector<SearchResult>> search(const SearchQuery& query) override;
+  Result<std::vector<nx::core::NoteId>> searchIds(const SearchQuery& query) override;
+  Result<size_t> searchCount(const SearchQuery& query) override;
+  Result<SearchPage> searchPage(const SearchQuery& query) override;
+  Result<std::vector<nx::core::NoteId>> scanCandidates(const std::string& pattern,
+                                                       bool is_regex = false) override;
+
+  // Suggestions
+  Result<std::vector<std::string>> suggestTags(const std::string& prefix, size_t limit) override;
+  Result<std::vector<std::string>> suggestNotebooks(const std::string& prefix, size_t limit) override;
+  Result<std::vector<TagCount>> getTagCounts() override;
+
+  // Version of the note files (mtime and size of each): the files are the index
+  uint64_t changeCounter() override;
+  
+  // Statistics and maintenance
+  Result<IndexStats> getStats() override;
+  Result<bool> isHealthy() override;
+  Result<void> validateIndex() override;
+  Result<void> rebuild() override;
+  Result<void> optimize() override;
+  Result<void> vacuum() override;
+
+  // Transaction support (no-ops: there is nothing to commit)
+  Result<void> beginTransaction() override;
+  Result<void> commitTransaction() override;
+  Result<void> rollbackTransaction() override;
+
+private:
+  // Per-file outcome of a scan; only files with matches are reported
+  struct FileHit {
+    const NoteManifest::Entry* entry = nullptr;
+    size_t match_count = 0;
+    double score = 0.0;  // Ranking when the scan keeps only the best hits
+    std::string snippet;
+  };
+
+  using FileVisitor =
+      std::function<std::optional<FileHit>(const NoteManifest::Entry&, std::string_view content)>;
+
+  // Reads each entry's file on the worker threads and passes its content to visit,
+  // which returns a hit for files that match. Every file is visited; only the
+  // keep_top best-scoring hits are held (0 = all). Callers hold mutex_.
+  std::vector<FileHit> scanFiles(const std::vector<const NoteManifest::Entry*>& entries,
+                                 const FileVisitor& visit, size_t keep_top) const;
+
+  // Text search over every note passing the metadata filters; callers hold mutex_
+  std::vector<SearchResult> textMatches(const SearchQuery& query, size_t keep_top) const;
+  std::vector<SearchResult> metadataMatches(const SearchQuery& query) const;
+  size_t workerCount(size_t file_count) const;
+
+  std::filesystem::path notes_dir_;
+  Config config_;
+  mutable std::mutex mutex_;
+  NoteManifest manifest_;
+  std::chrono::system_clock::time_point last_refresh_;
+};
+
+}  // namespace nx::index
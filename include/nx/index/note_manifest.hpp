@@ -0,0 +1,116 @@
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "nx/common.hpp"
+#include "nx/core/note.hpp"
+#include "nx/index/index.hpp"
+
+namespace nx::index {
+
+/**
+ * @brief Front-matter metadata for every note file under a directory
+ *
+ * Backs the scanning index backends (ripgrep and the native grep engine),
+ * which have no database to hold titles, tags and notebooks. The manifest can
+ * be persisted to a JSON file so later runs only re-parse files whose mtime or
+ * size changed.
+ */
+class NoteManifest {
+public:
+  struct Entry {
+    nx::core::NoteId id;
+    std::string title;
+    std::filesystem::path file_path;
+    std::chrono::system_clock::time_point created;
+    std::chrono::system_clock::time_point modified;
+    std::vector<std::string> tags;
+    std::optional<std::string> notebook;
+    size_t word_count = 0;
+    // File state when parsed, to validate persisted entries
+    int64_t file_mtime = 0;
+    uintmax_t file_size = 0;
+
+    // Changes whenever the file is rewritten
+    uint64_t fileVersion() const {
+      return static_cast<uint64_t>(file_mtime) * 0x9e3779b97f4a7c15ULL ^ static_cast<uint64_t>(file_size);
+    }
+  };
+
+  /**
+   * @param notes_dir Directory scanned for *.md notes
+   * @param cache_file Where the manifest is persisted; empty keeps it in memory only
+   */
+  NoteManifest(std::filesystem::path notes_dir, std::filesystem::path cache_file = {});
+
+  /**
+   * @brief Rescan the notes directory, reusing persisted entries for unchanged files
+   */
+  Result<void> refresh();
+
+  // Entries for notes written through nx (file state unknown until the next refresh)
+  void put(const nx::core::Note& note);
+  void erase(const nx::core::NoteId& id);
+  void clear();
+
+  const std::unordered_map<std::string, Entry>& entries() const { return entries_; }
+  size_t size() const { return entries_.size(); }
+  const std::filesystem::path& notesDir() const { return notes_dir_; }
+  
+  // Changes whenever a note file is added, removed or rewritten, from the mtime and size
+  // of every file as refresh() tracks them; costs one stat per note
+  uint64_t filesVersion() const;
+
+  /**
+   * @brief Entry for a note file, parsing and adding it if the manifest hasn't seen it
+   * @return nullptr if the file can't be read
+   */
+  const Entry* forFile(const std::filesystem::path& file_path);
+
+  // Aggregates over all entries, with the same ordering as the SQLite backend
+  std::vector<std::string> suggestTags(const std::string& prefix, size_t limit) const;
+  std::vector<TagCount> tagCounts() const;
+  std::vector<std::string> suggestNotebooks(const std::string& prefix, size_t limit) const;
+  IndexStats stats() const;  // last_optimized left for the caller
+
+  /**
+   * @brief Whether an entry passes the tag, notebook, date and boolean (expr) filters of a query
+   */
+  static bool matches(const Entry& entry, const SearchQuery& query);
+
+  /**
+   * @brief Relevance of a text hit: match density plus title, tag and recency boosts
+   */
+  static double score(const Entry& entry, const SearchQuery& query, size_t match_count);
+
+  /**
+   * @brief Search result carrying an entry's metadata (snippet and score left empty)
+   */
+  static SearchResult toResult(const Entry& entry);
+
+  static Result<Entry> parseNoteFile(const std::filesystem::path& file_path);
+
+private:
+  std::unordered_map<std::string, Entry> loadPersisted() const;
+  void savePersisted() const;
+
+  std::filesystem::path notes_dir_;
+  std::filesystem::path cache_file_;
+  std::unordered_map<std::string, Entry> entries_;  // ID -> metadata
+};
+
+/**
+ * @brief Snippet from one matched line: spans (byte ranges) wrapped in <mark>,
+ * cut to about 200 bytes around the first span
+ */
+std::string markedLineSnippet(std::string_view line,
+                              const std::vector<std::pair<size_t, size_t>>& spans);
+
+}  // namespace nx::index
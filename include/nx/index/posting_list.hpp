@@ -0,0 +1,123 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace nx::index {
+
+/**
+ * @brief Compressed postings for one term: ascending document numbers with term frequencies
+ *
+ * Postings are grouped into blocks of kBlockSize. Within a block, document
+ * numbers are stored as varint deltas interleaved with varint frequencies.
+ * Each block has a skip entry (last document, byte offset) so cursors can
+ * jump over blocks without decoding them, plus the largest frequency and
+ * shortest document length it holds, which bound the BM25 score of any
+ * posting in the block (block-max pruning).
+ *
+ * Lists are append-only: documents must arrive in increasing order.
+ */
+class PostingList {
+public:
+  static constexpr size_t kBlockSize = 128;
+
+  struct Block {
+    uint32_t last_doc = 0;
+    uint32_t offset = 0;       // Into bytes()
+    uint32_t max_tf = 0;
+    uint32_t min_length = UINT32_MAX;
+  };
+
+  void append(uint32_t doc, uint32_t tf, uint32_t doc_length);
+
+  size_t size() const { return count_; }
+  bool empty() const { return count_ == 0; }
+  const std::vector<Block>& blocks() const { return blocks_; }
+  const std::vector<uint8_t>& bytes() const { return bytes_; }
+  uint32_t maxTf() const { return max_tf_; }
+  uint32_t minLength() const { return min_length_; }
+
+  /**
+   * @brief Decode one block into docs/tfs (each at least kBlockSize long)
+   * @return Number of postings in the block
+   */
+  size_t decodeBlock(size_t block, uint32_t* docs, uint32_t* tfs) const;
+
+  // Raw state, for snapshots
+  void assign(std::vector<Block> blocks, std::vector<uint8_t> bytes, size_t count);
+
+private:
+  std::vector<Block> blocks_;
+  std::vector<uint8_t> bytes_;
+  size_t count_ = 0;
+  uint32_t last_doc_ = 0;
+  uint32_t max_tf_ = 0;
+  uint32_t min_length_ = UINT32_MAX;
+};
+
+/**
+ * @brief Forward-only iterator over a PostingList, one decoded block at a time
+ */
+class PostingCursor {
+public:
+  static constexpr uint32_t kEnd = UINT32_MAX;
+
+  explicit PostingCursor(const PostingList& list);
+
+  uint32_t doc() const { return doc_; }
+  uint32_t tf() const { return tfs_[pos_]; }
+  bool atEnd() const { return doc_ == kEnd; }
+
+  void next();
+
+  // First posting with doc >= target; skips whole blocks via their skip entries
+  void seek(uint32_t target);
+
+  /**
+   * @brief Move to the block that could hold target without decoding it
+   *
+   * Used for block-max checks; doc() is not valid again until seek() is called.
+   */
+  void shallowSeek(uint32_t target);
+
+  // Current block (after shallowSeek, the block it stopped at)
+  const PostingList::Block* block() const;
+  uint32_t blockLast() const;
+
+  // Decoded postings of the current block
+  const uint32_t* blockDocs() const { return docs_.data(); }
+  const uint32_t* blockTfs() const { return tfs_.data(); }
+  size_t blockSize() const { return block_size_; }
+  void nextBlock();
+
+  const PostingList& list() const { return *list_; }
+
+private:
+  void load(size_t block);
+
+  const PostingList* list_;
+  size_t block_ = 0;          // Decoded block
+  size_t shallow_block_ = 0;  // Block found by shallowSeek
+  size_t block_size_ = 0;
+  size_t pos_ = 0;
+  uint32_t doc_ = kEnd;
+  std::array<uint32_t, PostingList::kBlockSize> docs_{};
+  std::array<uint32_t, PostingList::kBlockSize> tfs_{};
+};
+
+/**
+ * @brief Intersect two ascending arrays, reporting the index pairs of shared values
+ *
+ * Meant for a short list a probing a longer list b: each a[i] skips through b
+ * sixteen values at a time with SSE2 compares (scalar elsewhere). Values must
+ * be below 2^31.
+ *
+ * @return Number of matches written to a_index/b_index (each sized min(na, nb))
+ */
+size_t intersectSorted(const uint32_t* a, size_t na, const uint32_t* b, size_t nb,
+                       uint32_t* a_index, uint32_t* b_index);
+
+}  // namespace nx::index
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace nx::index {
+
+/**
+ * @brief Boolean search expression, as produced by QueryParser
+ *
+ * Leaves test one property of a note; kAnd, kOr and kNot combine them. Each
+ * backend compiles the tree into its own form: one parameterized statement
+ * for SQLite, document bitsets for the in-memory index and a per-note check
+ * for the scanning backends.
+ */
+struct QueryExpr {
+  enum class Kind {
+    kAnd,
+    kOr,
+    kNot,       // Exactly one child
+    kText,      // Word or "phrase" in the title or body
+    kTitle,     // Word or phrase in the title
+    kTag,       // Carries this tag
+    kNotebook,  // Filed in this notebook
+    kCreated,   // Created within [from, to)
+    kModified   // Modified within [from, to)
+  };
+  using TimePoint = std::chrono::system_clock::time_point;
+
+  Kind kind = Kind::kAnd;
+  std::string value;                // Text, title, tag or notebook
+  std::optional<TimePoint> from;    // Date ranges; unset is unbounded
+  std::optional<TimePoint> to;
+  std::vector<QueryExpr> children;
+
+  static QueryExpr text(std::string value);
+  static QueryExpr title(std::string value);
+  static QueryExpr tag(std::string value);
+  static QueryExpr notebook(std::string value);
+  static QueryExpr created(std::optional<TimePoint> from, std::optional<TimePoint> to);
+  static QueryExpr modified(std::optional<TimePoint> from, std::optional<TimePoint> to);
+
+  // Nested groups of the same kind are flattened and a single child stands alone
+  static QueryExpr allOf(std::vector<QueryExpr> children);
+  static QueryExpr anyOf(std::vector<QueryExpr> children);
+  static QueryExpr negate(QueryExpr child);  // NOT NOT x is x
+
+  bool isBoolean() const { return kind == Kind::kAnd || kind == Kind::kOr || kind == Kind::kNot; }
+  bool hasText() const;  // Any kText leaf in the tree
+
+  // Properties of one note, for evaluating leaves outside a database
+  struct Facts {
+    std::string_view title;
+    const std::vector<std::string>& tags;
+    const std::optional<std::string>& notebook;
+    TimePoint created;
+    TimePoint modified;
+  };
+  // Decides kText leaves, which need the note body; never called for other leaves
+  using TextTest = std::function<bool(const QueryExpr& leaf)>;
+
+  bool matches(const Facts& facts, const TextTest& text_test) const;
+
+  // The one title rule every backend applies, as FTS5 matches its title column: the
+  // value's words appear in order as whole words, case-insensitively; a trailing * makes
+  // the last one a prefix
+  static bool titleMatches(std::string_view title, std::string_view value);
+
+  /**
+   * @brief Canonical query syntax, e.g. `tag:work -(draft OR "to do") created:2024-01-01..2024-02-01`
+   */
+  std::string toString() const;
+
+  bool operator==(const QueryExpr& other) const = default;
+};
+
+}  // namespace nx::index
@@ -18,15 +18,29 @@ namespace nx::index {
  * - "tag:programming content:algorithms" -> tag and content filters
  * - "notebook:work created:2024-01-01..2024-12-31" -> notebook and date range
  * - "title:\"My Note\" -tag:draft" -> title search excluding draft tag
+ * - "(rust OR go) -tag:archived modified:2024-06-01.." -> grouping, OR and open ranges
+ *
+ * Terms are ANDed; OR binds looser than AND, NOT or a leading '-' negates a
+ * term or a parenthesized group. Date ranges include both named days.
  */
 class QueryParser {
 public:
   /**
    * @brief Parse a query string into a structured SearchQuery
+   *
+   * Plain words, tags, a notebook and modified bounds that every match needs
+   * are hoisted into the SearchQuery fields; whatever else the query says
+   * (negations, OR groups, titles, created ranges) stays in SearchQuery::expr.
+   *
    * @param query_str The query string to parse
    * @return SearchQuery on success, Error on parse failure
    */
   static Result<SearchQuery> parse(const std::string& query_str);
+  
+  /**
+   * @brief Parse a query string into a boolean expression (an empty kAnd matches everything)
+   */
+  static Result<QueryExpr> parseExpr(const std::string& query_str);
 
 private:
   struct Token {
@@ -35,6 +49,10 @@ private:
       kField,     // field:value
       kQuoted,    // "quoted text"
       kRange,     // field:start..end
+      kOpen,      // ( or -(
+      kClose,     // )
+      kOr,        // OR
+      kNot,       // NOT
     };
     
     Type type;
@@ -45,7 +63,11 @@ private:
   };
   
   static std::vector<Token> tokenize(const std::string& query_str);
-  static SearchQuery buildQuery(const std::vector<Token>& tokens);
+  static QueryExpr parseOr(const std::vector<Token>& tokens, size_t& pos);
+  static QueryExpr parseAnd(const std::vector<Token>& tokens, size_t& pos);
+  static QueryExpr parseUnary(const std::vector<Token>& tokens, size_t& pos);
+  static QueryExpr toLeaf(const Token& token);
+  static SearchQuery buildQuery(const QueryExpr& expr);
   static std::string unquote(const std::string& str);
   static bool isDateString(const std::string& str);
   static std::chrono::system_clock::time_point parseDate(const std::string& str);
@@ -75,7 +97,7 @@ public:
   
 private:
   SearchQuery query_;
-  std::vector<std::string> exclude_tags_;
+  std::vector<QueryExpr> filters_;  // ANDed into SearchQuery::expr
 };
 
 } // namespace nx::index
\ No newline at end of file
@@ -9,6 +9,7 @@
 #include <chrono>
 
 #include "nx/index/index.hpp"
+#include "nx/index/note_manifest.hpp"
 #include "nx/core/note.hpp"
 #include "nx/common.hpp"
 
@@ -20,10 +21,21 @@ namespace nx::index {
  * This implementation uses ripgrep (rg) for full-text search and maintains
  * a simple metadata cache for tag/notebook filtering and statistics.
  * It's designed as a fallback when SQLite FTS5 is not available.
+ *
+ * Searches run a single `rg --json` process and consume its match events as
+ * they stream in; snippets and scores come from those events, and rg is
+ * stopped as soon as enough hits for the requested page are collected.
  */
 class RipgrepIndex : public Index {
 public:
+  struct Config {
+    // Metadata cache persisted between runs; files whose mtime and size are
+    // unchanged are not re-parsed. Empty keeps the cache in memory only.
+    std::filesystem::path cache_file;
+  };
+  
   explicit RipgrepIndex(std::filesystem::path notes_dir);
+  RipgrepIndex(std::filesystem::path notes_dir, Config config);
   ~RipgrepIndex() override = default;
 
   // Index lifecycle
@@ -38,10 +50,20 @@ public:
   Result<std::vector<SearchResult>> search(const SearchQuery& query) override;
   Result<std::vector<nx::core::NoteId>> searchIds(const SearchQuery& query) override;
   Result<size_t> searchCount(const SearchQuery& query) override;
+  Result<SearchPage> searchPage(const SearchQuery& query) override;
+  Result<std::vector<nx::core::NoteId>> scanCandidates(const std::string& pattern,
+                                                       bool is_regex = false) override;
   
   // Suggestions
   Result<std::vector<std::string>> suggestTags(const std::string& prefix, size_t limit) override;
   Result<std::vector<std::string>> suggestNotebooks(const std::string& prefix, size_t limit) override;
+  Result<std::vector<TagCount>> getTagCounts() override;
+  
+  // Explain: the rg command line and time spent running rg, building snippets and results
+  Result<SearchExplain> explainSearch(const SearchQuery& query) override;
+  
+  // Version of the note files (mtime and size of each): the files are the index
+  uint64_t changeCounter() override;
   
   // Statistics and maintenance
   Result<IndexStats> getStats() override;
@@ -57,43 +79,31 @@ public:
   Result<void> rollbackTransaction() override;
 
 private:
-  struct NoteMeta {
-    nx::core::NoteId id;
-    std::string title;
-    std::filesystem::path file_path;
-    std::chrono::system_clock::time_point created;
-    std::chrono::system_clock::time_point modified;
-    std::vector<std::string> tags;
-    std::optional<std::string> notebook;
-    size_t word_count = 0;
+  // Time spent handling rg events, gathered for explainSearch()
+  struct StreamStats {
+    std::chrono::nanoseconds snippet{0};
+    std::chrono::nanoseconds results{0};
+    size_t files_matched = 0;
+    size_t snippets = 0;
   };
   
-  // Core functionality
-  Result<void> buildMetadataCache();
-  Result<void> updateNoteMetadata(const nx::core::Note& note);
-  Result<void> removeNoteMetadata(const nx::core::NoteId& id);
-  
-  // Search implementation
-  Result<std::vector<std::filesystem::path>> ripgrepSearch(const std::string& query_text, 
-                                                           size_t limit = 1000) const;
-  Result<SearchResult> createSearchResult(const std::filesystem::path& file_path,
-                                          const SearchQuery& query) const;
-  std::vector<NoteMeta> filterByMetadata(const std::vector<NoteMeta>& candidates,
-                                         const SearchQuery& query) const;
+  // Search implementation (callers hold cache_mutex_). Runs rg over the notes and
+  // returns matching notes that pass the metadata filters. rg always runs to the end;
+  // keep_top bounds how many of the best-ranked hits are held (0 = keep all).
+  std::vector<std::string> searchArgs(const SearchQuery& query) const;
+  Result<std::vector<SearchResult>> streamMatches(const SearchQuery& query, size_t keep_top,
+                                                  StreamStats* stats = nullptr);
+  std::vector<SearchResult> metadataMatches(const SearchQuery& query) const;
+  static SearchPage pageOf(std::vector<SearchResult> results, const SearchQuery& query);
   
   // Utilities
-  Result<NoteMeta> parseNoteFile(const std::filesystem::path& file_path) const;
-  Result<std::string> extractSnippet(const std::filesystem::path& file_path,
-                                     const std::string& query_text,
-                                     bool highlight) const;
   bool isRipgrepAvailable() const;
-  std::string escapeRipgrepQuery(const std::string& query) const;
-  double calculateSimpleScore(const NoteMeta& meta, const SearchQuery& query) const;
   
   // Data members
   std::filesystem::path notes_dir_;
+  Config config_;
   mutable std::mutex cache_mutex_;
-  std::unordered_map<std::string, NoteMeta> metadata_cache_; // ID -> metadata
+  NoteManifest manifest_;
   std::chrono::system_clock::time_point last_cache_update_;
   bool cache_dirty_ = true;
 };
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace nx::index {
+
+/**
+ * @brief Binary snapshot encoding shared by the in-memory indexes
+ *
+ * Fixed-width values in host byte order and length-prefixed strings and
+ * vectors. Snapshots are caches, so they are never moved between machines.
+ */
+class SnapshotWriter {
+public:
+  explicit SnapshotWriter(std::ostream& out) : out_(out) {}
+
+  template <typename T>
+  void put(T value) {
+    out_.write(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+
+  void putString(const std::string& text) {
+    put<uint32_t>(static_cast<uint32_t>(text.size()));
+    out_.write(text.data(), static_cast<std::streamsize>(text.size()));
+  }
+
+  template <typename T>
+  void putVector(const std::vector<T>& values) {
+    put<uint64_t>(values.size());
+    out_.write(reinterpret_cast<const char*>(values.data()),
+               static_cast<std::streamsize>(values.size() * sizeof(T)));
+  }
+
+private:
+  std::ostream& out_;
+};
+
+/**
+ * @brief Reads what SnapshotWriter wrote; check ok() after a sequence of reads
+ */
+class SnapshotReader {
+public:
+  explicit SnapshotReader(std::istream& in) : in_(in) {}
+
+  template <typename T>
+  T get() {
+    T value{};
+    in_.read(reinterpret_cast<char*>(&value), sizeof(T));
+    return value;
+  }
+
+  std::string getString() {
+    auto size = get<uint32_t>();
+    std::string text;
+    if (ok() && size <= kMaxLength) {
+      text.resize(size);
+      in_.read(text.data(), size);
+    } else {
+      in_.setstate(std::ios::failbit);
+    }
+    return text;
+  }
+
+  template <typename T>
+  std::vector<T> getVector() {
+    auto size = get<uint64_t>();
+    std::vector<T> values;
+    if (ok() && size <= kMaxLength / sizeof(T)) {
+      values.resize(size);
+      in_.read(reinterpret_cast<char*>(values.data()), static_cast<std::streamsize>(size * sizeof(T)));
+    } else {
+      in_.setstate(std::ios::failbit);
+    }
+    return values;
+  }
+
+  bool ok() const { return static_cast<bool>(in_); }
+
+private:
+  // Guards allocations against corrupt length fields
+  static constexpr uint64_t kMaxLength = uint64_t{1} << 32;
+
+  std::istream& in_;
+};
+
+}  // namespace nx::index
@@ -1,9 +1,18 @@
 #pragma once
 
 #include <sqlite3.h>
+#include <chrono>
+#include <condition_variable>
 #include <memory>
 #include <mutex>
 #include <filesystem>
+#include <functional>
+#include <optional>
+#include <set>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <variant>
 
 #include "nx/index/index.hpp"
 
@@ -12,7 +21,30 @@ namespace nx::index {
 // SQLite FTS5-based search index implementation
 class SqliteIndex : public Index {
 public:
+  // How notes_fts stores document text
+  enum class ContentMode {
+    kFull,         // FTS table keeps its own copy of every note (snippets via snippet())
+    kContentless   // Postings only (contentless_delete, SQLite >= 3.43); text comes from content_provider
+  };
+  
+  // Supplies the current body of a note; used for snippets and for rebuilding contentless tables
+  using ContentProvider = std::function<std::optional<std::string>(const nx::core::NoteId&)>;
+  
+  struct Config {
+    ContentMode content_mode = ContentMode::kFull;
+    ContentProvider content_provider;
+    bool trigram_index = true;  // notes_trigram table for substring/regex candidates
+    std::vector<int> prefix_lengths = {2, 3};  // FTS5 prefix= indexes for "term*" queries
+    
+    // Write-behind: writes made outside beginTransaction() share one transaction that is
+    // committed after write_batch_size writes or write_batch_delay, whichever comes first.
+    // Only for owners that flush before exiting; an uncommitted batch dies with the process
+    size_t write_batch_size = 0;  // 0 commits every write on its own
+    std::chrono::milliseconds write_batch_delay{200};
+  };
+  
   explicit SqliteIndex(std::filesystem::path db_path);
+  SqliteIndex(std::filesystem::path db_path, Config config);
   ~SqliteIndex() override;
 
   // Index management
@@ -28,10 +60,18 @@ public:
   Result<std::vector<SearchResult>> search(const SearchQuery& query) override;
   Result<std::vector<nx::core::NoteId>> searchIds(const SearchQuery& query) override;
   Result<size_t> searchCount(const SearchQuery& query) override;
+  Result<SearchPage> searchPage(const SearchQuery& query) override;
+  Result<size_t> searchEach(const SearchQuery& query, const SearchVisitor& visit) override;
+  Result<std::vector<nx::core::NoteId>> scanCandidates(const std::string& pattern,
+                                                       bool is_regex = false) override;
 
   // Suggestions and autocompletion
   Result<std::vector<std::string>> suggestTags(const std::string& prefix, size_t limit = 10) override;
   Result<std::vector<std::string>> suggestNotebooks(const std::string& prefix, size_t limit = 10) override;
+  Result<std::vector<TagCount>> getTagCounts() override;
+  Result<IndexAggregates> aggregate(const AggregateQuery& query) override;
+  Result<SearchExplain> explainSearch(const SearchQuery& query) override;
+  uint64_t changeCounter() override;  // PRAGMA data_version mixed with this connection's rebuilds
   
   // Statistics and health
   Result<IndexStats> getStats() override;
@@ -42,21 +82,124 @@ public:
   Result<void> beginTransaction() override;
   Result<void> commitTransaction() override;
   Result<void> rollbackTransaction() override;
+  Result<void> savepoint() override;
+  Result<void> releaseSavepoint() override;
+  Result<void> rollbackToSavepoint() override;
+  
+  /**
+   * @brief Commit the pending write-behind batch now
+   *
+   * Searches on this index already see pending writes; other connections
+   * only see them once they are flushed.
+   */
+  Result<void> flush();
+  
+  // Notes added, updated or removed since the last write-behind commit
+  std::vector<nx::core::NoteId> pendingWrites();
+  
+  /**
+   * @brief Change write-behind batching at runtime (size 0 turns it off)
+   *
+   * Commits the pending batch first. The caller owns flushing: a batch still
+   * open when the process exits without destroying the index is lost.
+   */
+  Result<void> setWriteBatching(size_t size, std::chrono::milliseconds delay);
+  
+  struct RebuildReport {
+    size_t notes_indexed = 0;
+    size_t files_skipped = 0;  // Note files that could not be read or parsed
+  };
+  
+  /**
+   * @brief Rebuild from the note files into a shadow database, then swap it in
+   *
+   * Notes are parsed on `threads` workers (0: one per core) and bulk-loaded
+   * into <db>.shadow with journaling off. The result is validated and copied
+   * into the live database in a single transaction, so searches keep running
+   * against the old index until the swap, and other connections (a daemon or
+   * the TUI) see the new one on their next read without reopening. A writer
+   * that holds the index past the busy timeout fails the swap (kInvalidState).
+   */
+  Result<RebuildReport> rebuildInShadow(const std::filesystem::path& notes_dir, size_t threads = 0);
+  
+  // Content mode actually in use (contentless falls back to full on older SQLite)
+  ContentMode contentMode() const { return content_mode_; }
+  static bool contentlessSupported();
+  static bool trigramSupported();
 
 private:
   // Database management
+  Result<void> openDatabase();
   Result<void> createTables();
   Result<void> configureDatabase();
+  void resolveSchemaOptions();  // Effective content mode and trigram use for this SQLite
+  int32_t schemaStamp() const;  // PRAGMA user_version for the current schema options
+  int32_t storedSchemaStamp();
   Result<void> ensureCompatibility();
+  bool tableExists(const std::string& table_name);
+  bool usesDocids() const { return content_mode_ == ContentMode::kContentless || trigram_enabled_; }
+  std::optional<std::string> tableSql(const std::string& table_name);
+  std::string prefixOption() const;
+  Result<void> migrateFtsTable(ContentMode from);
+  Result<void> repopulateFts();
+  
+  // Note writes (callers hold db_mutex_)
+  Result<void> addNoteLocked(const nx::core::Note& note);
+  Result<void> updateNoteLocked(const nx::core::Note& note);
+  Result<void> removeNoteLocked(const nx::core::NoteId& id);
   
-  // SQL statement preparation
-  Result<void> prepareStatements();
+  // Write-behind batching (callers hold db_mutex_)
+  Result<void> beginWriteLocked();
+  Result<void> endWriteLocked(const std::string& note_id, Result<void> result);
+  Result<void> flushLocked();
+  void flusherLoop();
+  
+  // SQL statement preparation (lazy: prepared() compiles a registered statement on first use)
+  void registerStatements();
+  sqlite3_stmt* prepared(sqlite3_stmt*& slot);
   void finalizeStatements();
   
   // Query building
   std::string buildFtsQuery(const SearchQuery& query);
+  
+  // Boolean queries (SearchQuery::expr, date bounds, filters without text) compile to one
+  // statement per query: FTS-expressible parts go into MATCH, the rest into SQL predicates
+  struct CompiledQuery {
+    std::string sql;
+    std::vector<std::variant<std::string, int64_t>> params;
+    std::string match;  // FTS MATCH text; empty when nothing is ranked
+  };
+  using OwnedStatement = std::unique_ptr<sqlite3_stmt, decltype(&sqlite3_finalize)>;
+  enum class PlanOutput { kResults, kPage, kIds, kCount };  // kPage: kResults plus the total in column 8
+  static bool needsQueryPlan(const SearchQuery& query);
+  CompiledQuery compileQuery(const SearchQuery& query, PlanOutput output);
+  std::string sqlPredicate(const QueryExpr& expr, std::vector<std::variant<std::string, int64_t>>& params) const;
+  std::string ftsIdsSubquery() const;
+  // Callers hold db_mutex_; stepping stops early when on_row returns false
+  Result<OwnedStatement> prepareCompiled(const std::string& sql, const CompiledQuery& compiled);
+  Result<void> runPlan(const SearchQuery& query, PlanOutput output,
+                       const std::function<bool(sqlite3_stmt*)>& on_row);
+  Result<std::vector<SearchResult>> runPlanSearch(const SearchQuery& query);
+  void addProviderSnippets(std::vector<SearchResult>& results, const SearchQuery& query);
+  void addProviderSnippet(SearchResult& result, const SearchQuery& query);
+  std::string buildPrefixQuery(const std::string& text);
   std::string buildWhereClause(const SearchQuery& query, std::vector<std::string>& params);
   
+  // FTS row maintenance
+  Result<void> insertFtsRow(const std::string& note_id, const std::string& title,
+                            const std::string& content, const std::string& tags_json,
+                            const std::optional<std::string>& notebook);
+  
+  // Tag maintenance (note_tags rows; tag_stats follows via triggers)
+  Result<void> replaceNoteTags(const std::string& note_id, const std::vector<std::string>& tags);
+  
+  // Search execution (callers hold db_mutex_); total receives the window count if non-null
+  Result<std::vector<SearchResult>> runSearch(sqlite3_stmt* stmt, const SearchQuery& query,
+                                              size_t* total);
+  Result<void> stepSearch(sqlite3_stmt* stmt, const SearchQuery& query,
+                          const std::function<bool(sqlite3_stmt*)>& on_row);
+  Result<size_t> countMatches(const std::string& fts_query);
+  
   // Result processing
   Result<SearchResult> extractSearchResult(sqlite3_stmt* stmt, bool highlight);
   std::string generateSnippet(const std::string& content, const std::string& query, size_t max_length = 200);
@@ -68,7 +211,12 @@ private:
   // Database path and connection
   std::filesystem::path db_path_;
   sqlite3* db_ = nullptr;
+  uint64_t rebuilds_ = 0;  // Shadow rebuilds swapped in through this connection
   std::mutex db_mutex_;
+  Config config_;
+  ContentMode content_mode_ = ContentMode::kFull;
+  bool trigram_enabled_ = false;
+  bool needs_fts_repopulate_ = false;
   
   // Prepared statements for common operations
   sqlite3_stmt* stmt_add_note_ = nullptr;
@@ -76,13 +224,38 @@ private:
   sqlite3_stmt* stmt_remove_note_ = nullptr;
   sqlite3_stmt* stmt_remove_fts_note_ = nullptr;
   sqlite3_stmt* stmt_search_ = nullptr;
+  sqlite3_stmt* stmt_search_page_ = nullptr;
+  sqlite3_stmt* stmt_search_ids_ = nullptr;
   sqlite3_stmt* stmt_search_count_ = nullptr;
   sqlite3_stmt* stmt_suggest_tags_ = nullptr;
+  sqlite3_stmt* stmt_top_tags_ = nullptr;
   sqlite3_stmt* stmt_suggest_notebooks_ = nullptr;
   sqlite3_stmt* stmt_stats_ = nullptr;
+  sqlite3_stmt* stmt_tag_counts_ = nullptr;
+  sqlite3_stmt* stmt_notebook_aggregates_ = nullptr;
+  sqlite3_stmt* stmt_notebook_tag_counts_ = nullptr;
+  sqlite3_stmt* stmt_remove_note_tags_ = nullptr;
+  sqlite3_stmt* stmt_add_note_tag_ = nullptr;
+  sqlite3_stmt* stmt_assign_docid_ = nullptr;
+  sqlite3_stmt* stmt_remove_docid_ = nullptr;
+  sqlite3_stmt* stmt_add_trigram_ = nullptr;
+  sqlite3_stmt* stmt_remove_trigram_ = nullptr;
+  sqlite3_stmt* stmt_trigram_candidates_ = nullptr;
+  sqlite3_stmt* stmt_all_ids_ = nullptr;
+  sqlite3_stmt* stmt_data_version_ = nullptr;
+  std::unordered_map<sqlite3_stmt**, const char*> statement_sql_;
   
   // Transaction state
   bool in_transaction_ = false;
+  
+  // Write-behind state
+  bool batch_open_ = false;
+  std::chrono::steady_clock::time_point batch_started_;
+  size_t batch_writes_ = 0;
+  std::set<std::string> pending_ids_;
+  std::thread flusher_;  // Commits a batch once write_batch_delay passes
+  std::condition_variable flush_cv_;
+  bool stopping_ = false;
 };
 
 }  // namespace nx::index
\ No newline at end of file
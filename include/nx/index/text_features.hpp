@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace nx::index {
+
+/**
+ * @brief Words that carry meaning: ASCII lower-cased, plurals folded,
+ * stopwords and single characters dropped
+ *
+ * Shared by the similarity indexes (embeddings and MinHash) so they agree on
+ * what a word is.
+ */
+std::vector<std::string> contentWords(std::string_view text);
+
+/**
+ * @brief 64-bit FNV-1a hash, used to detect changed content
+ */
+uint64_t contentHash(std::string_view text);
+
+/**
+ * @brief FNV-1a with a final avalanche, so every output bit is usable
+ */
+uint64_t featureHash(std::string_view text);
+
+}  // namespace nx::index
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <optional>
+
+namespace nx::index {
+
+/**
+ * @brief Boolean trigram constraint used to narrow substring and regex scans
+ *
+ * The query is an OR over groups, each group an AND of literals: a note can
+ * only match if, for at least one group, its text contains every literal of
+ * that group. Literals are at least three characters long so each one maps to
+ * one or more trigrams. The result is only a pre-filter; callers still run the
+ * real matcher on the candidates it selects.
+ *
+ * Examples:
+ * - "deadline"           -> {{"deadline"}}
+ * - "todo.*urgent"       -> {{"todo", "urgent"}}
+ * - "(error|warn)ing"    -> {{"error", "ing"}, {"warn", "ing"}}
+ * - "a.c" / "\\d+"        -> nullopt (nothing to narrow on)
+ */
+struct TrigramQuery {
+  std::vector<std::vector<std::string>> groups;
+
+  /**
+   * @brief Constraint for a plain substring search
+   * @return nullopt when the needle is shorter than three characters
+   */
+  static std::optional<TrigramQuery> forSubstring(const std::string& needle);
+
+  /**
+   * @brief Constraint from the literals an ECMAScript regex requires
+   * @return nullopt when some match path requires no literal of three or more characters
+   */
+  static std::optional<TrigramQuery> forRegex(const std::string& pattern);
+
+  /**
+   * @brief FTS5 MATCH expression over a trigram-tokenized table
+   *
+   * Each literal is split into its trigrams and every trigram is matched on its
+   * own, so the expression also works on detail=none tables (no positions).
+   */
+  std::string toFtsMatch() const;
+};
+
+/**
+ * @brief Overlapping three-codepoint windows of UTF-8 text
+ */
+std::vector<std::string> utf8Trigrams(const std::string& text);
+
+}  // namespace nx::index
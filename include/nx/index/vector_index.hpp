@@ -0,0 +1,96 @@
+#pragma once
+
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "nx/common.hpp"
+#include "nx/core/note.hpp"
+#include "nx/core/note_id.hpp"
+#include "nx/index/embedder.hpp"
+#include "nx/index/hnsw_index.hpp"
+
+namespace nx::index {
+
+/**
+ * @brief Semantic search over note embeddings, answered locally
+ *
+ * Embeds each note with the given Embedder and keeps the vectors in an HNSW
+ * graph persisted to a single file. sync() brings the index up to date with
+ * the store incrementally: only notes whose text changed are re-embedded.
+ */
+class VectorIndex {
+public:
+  struct Config {
+    std::filesystem::path index_file;  // Empty keeps vectors in memory only
+    HnswIndex::Config graph;           // dimensions is taken from the embedder
+    double max_deleted_ratio = 0.3;    // Rebuild the graph past this share of stale nodes
+  };
+
+  struct Hit {
+    nx::core::NoteId id;
+    float score;  // Cosine similarity, higher is closer
+  };
+
+  explicit VectorIndex(std::shared_ptr<Embedder> embedder);
+  VectorIndex(std::shared_ptr<Embedder> embedder, Config config);
+  ~VectorIndex();
+
+  /**
+   * @brief Read the index file; a missing file or another embedder's file starts empty
+   */
+  Result<void> load();
+  Result<void> save();
+
+  /**
+   * @brief Embed new and changed notes and drop notes that are gone
+   * @return Number of notes embedded
+   */
+  Result<size_t> sync(const std::vector<nx::core::Note>& notes);
+
+  Result<void> upsert(const nx::core::Note& note);
+  void remove(const nx::core::NoteId& id);
+
+  /**
+   * @brief The k notes closest in meaning to text (only positive similarity)
+   */
+  Result<std::vector<Hit>> search(const std::string& text, size_t k);
+
+  /**
+   * @brief The k notes closest to an indexed note, excluding itself
+   */
+  Result<std::vector<Hit>> similar(const nx::core::NoteId& id, size_t k);
+
+  size_t size() const;
+
+  // The text that is embedded for a note: tags, then the content
+  static std::string embeddingText(const nx::core::Note& note);
+
+private:
+  struct Entry {
+    uint64_t content_hash;
+    uint32_t node;
+  };
+
+  // Callers hold mutex_; upsertLocked returns whether the note was embedded
+  Result<bool> upsertLocked(const nx::core::Note& note);
+  void removeLocked(const std::string& key);
+  void compactIfNeeded();
+  std::vector<Hit> nearest(std::span<const float> query, size_t k, const std::string& exclude) const;
+  void reset();
+
+  std::shared_ptr<Embedder> embedder_;
+  Config config_;
+  mutable std::mutex mutex_;
+
+  HnswIndex graph_;
+  std::unordered_map<std::string, Entry> entries_;  // Note ID -> live node
+  std::vector<std::string> node_ids_;               // Node -> note ID
+  bool dirty_ = false;
+};
+
+}  // namespace nx::index
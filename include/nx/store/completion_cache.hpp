@@ -0,0 +1,119 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "nx/common.hpp"
+#include "nx/core/note.hpp"
+#include "nx/core/note_id.hpp"
+
+namespace nx::store {
+
+/**
+ * @brief Prebuilt completion data for shell TAB completion
+ *
+ * Note ids, titles, tags and notebooks are kept as sorted text records in
+ * one file, which a lookup maps into memory and binary-searches for the
+ * prefix, so completing against a large vault reads a few pages instead of
+ * the notes. Store mutations append to a small journal beside the file;
+ * lookups apply it on top of the sorted records, and it is folded back in
+ * once it passes Config::max_journal_bytes.
+ *
+ * Changes made behind the store's back (an editor, git, sync) are caught
+ * through the notes directory's modification time: the cache records the
+ * version it is current with, each store change moves that record along
+ * when the cache was current just before it, and a lookup against any
+ * other version reports kNotFound.
+ *
+ * The file is a cache: a failed update deletes it, and the next lookup
+ * reports kNotFound so the caller rebuilds it from the store.
+ */
+class CompletionCache {
+public:
+  struct Config {
+    std::filesystem::path file;              // Sorted records; the journal is file + ".journal"
+    size_t max_journal_bytes = 64 * 1024;    // Fold the journal into the sorted file past this
+    std::filesystem::path notes_dir;         // Whose changes invalidate the cache; empty: not checked
+  };
+
+  enum class Kind {
+    kIds,        // Id prefix -> id, described by title
+    kTitles,     // Case-insensitive title prefix -> title, described by id
+    kNotes,      // Id or title prefix -> id, described by title
+    kTags,       // Tag prefix -> tag, described by note count
+    kNotebooks   // Notebook prefix -> notebook, described by note count
+  };
+
+  // What completion needs to know about one note
+  struct Entry {
+    nx::core::NoteId id;
+    std::string title;
+    std::optional<std::string> notebook;
+    std::vector<std::string> tags;
+
+    static Entry fromNote(const nx::core::Note& note);
+  };
+
+  struct Candidate {
+    std::string value;
+    std::string description;
+  };
+
+  explicit CompletionCache(Config config);
+
+  /**
+   * @brief Whether the sorted file exists (lookups fail with kNotFound otherwise)
+   */
+  bool exists() const;
+
+  /**
+   * @brief Current version of Config::notes_dir (0 when unset or missing)
+   */
+  uint64_t notesVersion() const;
+
+  /**
+   * @brief Replace the whole cache with these notes
+   * @param notes_version notesVersion() from before the notes were read (default: now)
+   */
+  Result<void> rebuild(const std::vector<Entry>& entries, std::optional<uint64_t> notes_version = std::nullopt);
+
+  /**
+   * @brief Record a stored note; no-op while the cache does not exist
+   * @param notes_version notesVersion() from before the note was written; without it
+   *        the change still lands but the next lookup reports the cache out of date
+   */
+  Result<void> upsert(const Entry& entry, std::optional<uint64_t> notes_version = std::nullopt);
+
+  /**
+   * @brief Record a removed note; no-op while the cache does not exist
+   */
+  Result<void> remove(const nx::core::NoteId& id, std::optional<uint64_t> notes_version = std::nullopt);
+
+  /**
+   * @brief Up to limit candidates for a prefix, in sorted order
+   */
+  Result<std::vector<Candidate>> complete(Kind kind, const std::string& prefix, size_t limit) const;
+
+  static std::optional<Kind> parseKind(const std::string& name);
+
+  /**
+   * @brief Where the store and `nx __complete` keep a vault's cache (under the XDG cache directory)
+   */
+  static std::filesystem::path defaultFile(const std::filesystem::path& notes_dir);
+
+  const Config& config() const { return config_; }
+
+private:
+  std::filesystem::path journalPath() const;
+  Result<void> append(const std::string& record, std::optional<uint64_t> notes_version);
+  Result<void> compact(int journal_fd);
+  void discard();
+
+  Config config_;
+};
+
+}  // namespace nx::store
@@ -1,9 +1,11 @@
 #pragma once
 
 #include <filesystem>
+#include <memory>
 #include <unordered_map>
 #include <mutex>
 
+#include "nx/store/completion_cache.hpp"
 #include "nx/store/note_store.hpp"
 #include "nx/util/xdg.hpp"
 
@@ -18,6 +20,7 @@ class FilesystemStore : public NoteStore {
     std::filesystem::path trash_dir;
     bool auto_create_dirs = true;
     bool validate_paths = true;
+    std::filesystem::path completion_file;  // Kept current on every mutation; empty: none
   };
 
   FilesystemStore();
@@ -36,6 +39,7 @@ class FilesystemStore : public NoteStore {
   Result<std::vector<nx::core::NoteId>> list(const NoteQuery& query = {}) override;
   Result<std::vector<nx::core::Note>> search(const NoteQuery& query = {}) override;
   Result<size_t> count(const NoteQuery& query = {}) override;
+  Result<size_t> forEach(const NoteQuery& query, const NoteVisitor& visit) override;
 
   Result<std::vector<FuzzyMatch>> fuzzyResolve(const std::string& partial_id, 
                                                size_t max_results = 10) override;
@@ -77,6 +81,7 @@ class FilesystemStore : public NoteStore {
  private:
   Config config_;
   ChangeCallback change_callback_;
+  std::unique_ptr<CompletionCache> completions_;
   
   // Cache for metadata (thread-safe)
   mutable std::mutex cache_mutex_;
@@ -107,6 +112,8 @@ class FilesystemStore : public NoteStore {
   
   // Notification helpers
   void notifyChange(const nx::core::NoteId& id, const std::string& operation);
+  uint64_t completionsVersion() const;  // Read before a write, passed to updateCompletions
+  void updateCompletions(const nx::core::NoteId& id, const nx::core::Note* note, uint64_t notes_version);
   
   // Validation helpers
   Result<void> validateNoteFile(const std::filesystem::path& path) const;
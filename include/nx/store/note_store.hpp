@@ -62,6 +62,12 @@ class NoteStore {
   virtual Result<std::vector<nx::core::NoteId>> list(const NoteQuery& query = {}) = 0;
   virtual Result<std::vector<nx::core::Note>> search(const NoteQuery& query = {}) = 0;
   virtual Result<size_t> count(const NoteQuery& query = {}) = 0;
+  
+  // Matching notes handed to visit one at a time in id order (creation time, newest first
+  // unless sort_order is kAscending), until it returns false; returns how many were visited.
+  // Only the current note is held in memory.
+  using NoteVisitor = std::function<bool(const nx::core::Note&)>;
+  virtual Result<size_t> forEach(const NoteQuery& query, const NoteVisitor& visit) = 0;
 
   // Fuzzy resolution
   virtual Result<std::vector<FuzzyMatch>> fuzzyResolve(const std::string& partial_id, 
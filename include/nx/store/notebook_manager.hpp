@@ -4,15 +4,27 @@
 #include <vector>
 #include <map>
 #include <chrono>
+#include <functional>
+#include <optional>
 
 #include "nx/common.hpp"
 #include "nx/core/note_id.hpp"
 
 // Forward declarations
+namespace nx::core {
+class Note;
+}
+
 namespace nx::store {
 class NoteStore;
 }
 
+namespace nx::index {
+class Index;
+struct IndexAggregates;
+struct NotebookAggregate;
+}
+
 namespace nx::store {
 
 /**
@@ -51,14 +63,29 @@ struct NotebookStats {
  * 
  * Provides high-level operations for managing notebooks, including
  * creation, deletion, renaming, and statistical analysis.
+ *
+ * Given a search index, listings and statistics come from the index's
+ * aggregate counts and no note is read; without one, or when the index
+ * backend cannot aggregate, notes are loaded from the store. Notebook
+ * changes made here write both the store and the index.
  */
 class NotebookManager {
 public:
+  // Resolves the search index on first use; may return nullptr
+  using IndexProvider = std::function<nx::index::Index*()>;
+
   /**
    * @brief Constructor
    * @param note_store Reference to the note store
    */
   explicit NotebookManager(NoteStore& note_store);
+  
+  /**
+   * @brief Constructor with an index for listings and statistics
+   * @param note_store Reference to the note store
+   * @param index_provider Called when counts are first needed, so the index is only opened then
+   */
+  NotebookManager(NoteStore& note_store, IndexProvider index_provider);
 
   // Notebook CRUD operations
   
@@ -150,15 +177,26 @@ public:
   static constexpr std::string_view DEFAULT_NOTEBOOK = "default";
   static constexpr size_t MAX_NOTEBOOK_NAME_LENGTH = 100;
   static constexpr size_t TOP_TAGS_LIMIT = 10;  // Number of top tags to include in NotebookInfo
+  static constexpr std::string_view PLACEHOLDER_PREFIX = ".notebook_";  // Title prefix of placeholder notes
 
 private:
   NoteStore& note_store_;
+  IndexProvider index_provider_;
   
   // Helper methods
   Result<void> validateNotebookName(const std::string& name);
   Result<NotebookInfo> calculateNotebookStats(const std::string& name);
   Result<std::map<std::string, size_t>> getTagCountsForNotebook(const std::string& name);
   std::vector<std::string> getTopTags(const std::map<std::string, size_t>& tag_counts, size_t limit = TOP_TAGS_LIMIT);
+  
+  // Store writes that also keep the index (when there is one) in step
+  nx::index::Index* index();
+  Result<void> storeNote(const nx::core::Note& note);
+  Result<void> removeNote(const nx::core::NoteId& id);
+  
+  // Index aggregates; nullopt when there is no index or it cannot aggregate
+  std::optional<nx::index::IndexAggregates> indexAggregates();
+  NotebookInfo infoFromAggregate(const nx::index::NotebookAggregate& aggregate, bool include_stats);
 };
 
 }  // namespace nx::store
\ No newline at end of file
@@ -16,6 +16,9 @@
 #include "nx/store/note_store.hpp"
 #include "nx/store/notebook_manager.hpp"
 #include "nx/index/index.hpp"
+#include "nx/index/link_graph.hpp"
+#include "nx/index/minhash_index.hpp"
+#include "nx/index/vector_index.hpp"
 #include "nx/core/note.hpp"
 #include "nx/core/note_id.hpp"
 #include "nx/core/metadata.hpp"
@@ -321,6 +324,9 @@ private:
   
   // AI services
   std::unique_ptr<AiExplanationService> ai_explanation_service_;
+  std::unique_ptr<nx::index::VectorIndex> vector_index_;  // Opened by the first semantic search
+  std::unique_ptr<nx::index::MinHashIndex> related_index_;  // Synced with all_notes on demand
+  nx::index::LinkGraph link_graph_;  // Synced with all_notes in loadNotes()
   
   // Application state
   AppState state_;
@@ -355,6 +361,7 @@ private:
   void performSearch(const std::string& query);
   void performSimpleFilter(const std::string& query);
   void performFullTextSearch(const std::string& query);
+  bool performPrefixSearch(const std::string& query);
   void invalidateSearchCache();
   
   // Event handlers
@@ -493,6 +500,10 @@ private:
   void handleSemanticSearch();
   Result<std::vector<nx::core::NoteId>> performSemanticSearch(const std::string& query,
                                                               const nx::config::Config::AiConfig& ai_config);
+  Result<void> syncVectorIndex(const nx::config::Config::AiConfig& ai_config);
+  Result<std::vector<nx::core::NoteId>> rerankSemanticCandidates(const std::string& query,
+                                                                 const std::vector<nx::core::NoteId>& candidates,
+                                                                 const nx::config::Config::AiConfig& ai_config);
                                                               
   // AI Grammar & Style Check handlers
   void handleGrammarStyleCheck();
@@ -4,6 +4,8 @@
 #include <vector>
 #include <optional>
 #include <memory>
+#include <functional>
+#include <string_view>
 
 #include "nx/common.hpp"
 
@@ -53,6 +55,20 @@ public:
     const std::optional<std::string>& working_dir = std::nullopt
   );
 
+  /**
+   * @brief Execute a command and hand each line of stdout to a callback as it arrives
+   * @param command The command to execute
+   * @param args Command arguments
+   * @param on_line Called per line (without the newline); return false to stop early,
+   *        which terminates the process instead of waiting for it to finish
+   * @return Exit code (0 when stopped early) or error; stderr is discarded
+   */
+  static Result<int> executeStreaming(
+    const std::string& command,
+    const std::vector<std::string>& args,
+    const std::function<bool(std::string_view)>& on_line
+  );
+
   /**
    * @brief Check if a command exists in PATH
    * @param command Command name to check
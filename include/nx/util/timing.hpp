@@ -0,0 +1,156 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "nx/common.hpp"
+#include "nx/util/trace.hpp"
+
+namespace nx::util {
+
+/**
+ * @brief Latency histogram with bounded relative error (HDR-style)
+ *
+ * Values are microseconds. Each power of two is split into kSubBuckets linear
+ * steps, so a percentile is reported within about 3% of the true value from
+ * 1 µs up to hours, in a fixed array and with O(1) recording.
+ */
+class LatencyHistogram {
+public:
+  static constexpr unsigned kSubBucketBits = 5;
+  static constexpr uint64_t kSubBuckets = uint64_t{1} << kSubBucketBits;
+  static constexpr uint64_t kMaxMicros = (uint64_t{1} << 36) - 1;  // ~19 hours; larger values clamp
+  static constexpr size_t kBuckets = (36 - kSubBucketBits + 1) * kSubBuckets;
+
+  void record(std::chrono::nanoseconds elapsed);
+  void recordMicros(uint64_t micros);
+  void merge(const LatencyHistogram& other);
+
+  uint64_t count() const { return count_; }
+  uint64_t totalMicros() const { return total_micros_; }
+  uint64_t maxMicros() const { return max_micros_; }
+
+  /**
+   * @brief Value that percentile% of samples are at or below (the upper edge of its bucket)
+   */
+  uint64_t percentileMicros(double percentile) const;
+
+  /**
+   * @brief Compact text form: "total;max;" then "bucket:count" for each non-empty bucket, comma-separated
+   */
+  std::string encode() const;
+  static Result<LatencyHistogram> decode(std::string_view text);
+
+  static size_t bucketFor(uint64_t micros);
+  static uint64_t bucketUpperBound(size_t bucket);
+
+private:
+  std::array<uint64_t, kBuckets> counts_{};
+  uint64_t count_ = 0;
+  uint64_t total_micros_ = 0;
+  uint64_t max_micros_ = 0;
+};
+
+/**
+ * @brief Process-wide latency histograms, one per named phase
+ *
+ * Off by default: until setEnabled(true) a ScopedTimer costs one relaxed
+ * atomic load and never reads the clock.
+ */
+class Timings {
+public:
+  struct Phase {
+    std::string name;
+    LatencyHistogram histogram;
+  };
+
+  static Timings& global();
+
+  void setEnabled(bool enabled) { enabled_.store(enabled, std::memory_order_relaxed); }
+  bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+  /**
+   * @brief Add one sample to a phase; ignored while disabled
+   */
+  void record(std::string_view phase, std::chrono::nanoseconds elapsed);
+
+  /**
+   * @brief Every phase recorded so far, in the order each was first seen
+   */
+  std::vector<Phase> phases() const;
+
+  void reset();
+
+private:
+  std::atomic<bool> enabled_{false};
+  mutable std::mutex mutex_;
+  std::vector<Phase> phases_;
+};
+
+/**
+ * @brief Records the lifetime of a scope into Timings::global()
+ *
+ * The same scope is a span of the same name in the trace when NX_TRACE is
+ * set. The phase name must outlive the timer (a string literal).
+ */
+class ScopedTimer {
+public:
+  explicit ScopedTimer(const char* phase);
+  ~ScopedTimer();
+
+  ScopedTimer(const ScopedTimer&) = delete;
+  ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+  /**
+   * @brief Attach a key/value to the trace span (ignored while tracing is off)
+   */
+  template <typename T>
+  ScopedTimer& arg(std::string_view key, const T& value) {
+    span_.arg(key, value);
+    return *this;
+  }
+
+private:
+  TraceSpan span_;
+  const char* phase_;  // nullptr when timings were off at construction
+  std::chrono::steady_clock::time_point start_;
+};
+
+/**
+ * @brief Per-run latency records appended to a local file, one JSON object per line
+ *
+ * Each line holds the command, when it ran, its wall time and the encoded
+ * histogram of every phase, so runs can be merged per command later.
+ */
+class MetricsFile {
+public:
+  struct Run {
+    std::string command;
+    std::chrono::system_clock::time_point started;
+    std::chrono::nanoseconds elapsed{0};
+    std::vector<Timings::Phase> phases;
+  };
+
+  explicit MetricsFile(std::filesystem::path path) : path_(std::move(path)) {}
+
+  Result<void> append(const Run& run) const;
+
+  /**
+   * @brief Every run recorded since since; unreadable lines are skipped
+   */
+  Result<std::vector<Run>> read(std::chrono::system_clock::time_point since = {}) const;
+
+  const std::filesystem::path& path() const { return path_; }
+
+private:
+  std::filesystem::path path_;
+};
+
+}  // namespace nx::util
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "nx/common.hpp"
+
+// Builds configured with -DNX_TRACING=OFF compile every span down to nothing
+#ifndef NX_TRACING
+#define NX_TRACING 1
+#endif
+
+namespace nx::util {
+
+/**
+ * @brief Chrome trace-event recorder, for chrome://tracing or ui.perfetto.dev
+ *
+ * Off unless NX_TRACE names an output file. Spans are buffered in memory
+ * and written as one JSON document when the process finishes, so a full
+ * `nx ui` session or a single command shows up as nested slices per thread.
+ */
+class Tracer {
+public:
+  static constexpr const char* kEnvironmentVariable = "NX_TRACE";
+  static constexpr size_t kMaxEvents = 1'000'000;  // Later events are counted, not kept
+
+  static Tracer& global();
+
+  /**
+   * @brief Start recording if NX_TRACE is set; the file is written at exit and by flush()
+   */
+  void startFromEnvironment();
+  void start(std::filesystem::path path);
+
+  /**
+   * @brief Stop recording and drop what was recorded (nothing is written at exit)
+   */
+  void stop();
+
+  bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+  /**
+   * @brief Write every event so far (the file is rewritten, so flushing again is harmless)
+   */
+  Result<void> flush();
+
+  /**
+   * @brief Label the calling thread in the trace
+   */
+  void nameThread(std::string name);
+
+  // For TraceSpan: a finished slice on the calling thread. name must be a string literal;
+  // its text up to the first '.' becomes the category.
+  void complete(const char* name, std::chrono::steady_clock::time_point start,
+                std::chrono::steady_clock::time_point end, std::string args);
+
+private:
+  struct Event {
+    const char* name;
+    int64_t start_us;
+    int64_t duration_us;
+    uint32_t thread;
+    std::string args;  // JSON object members, already encoded
+  };
+
+  static uint32_t threadId();
+
+  std::atomic<bool> enabled_{false};
+  mutable std::mutex mutex_;
+  std::filesystem::path path_;
+  std::chrono::steady_clock::time_point epoch_;
+  std::vector<Event> events_;
+  std::vector<std::pair<uint32_t, std::string>> thread_names_;
+  size_t dropped_ = 0;
+};
+
+#if NX_TRACING
+
+/**
+ * @brief One slice in the trace, from construction to destruction
+ *
+ * While tracing is off this costs one relaxed atomic load, and arg() returns
+ * at once; keep argument expressions cheap (existing strings, sizes).
+ */
+class TraceSpan {
+public:
+  explicit TraceSpan(const char* name)
+      : name_(Tracer::global().enabled() ? name : nullptr) {
+    if (name_ != nullptr) {
+      start_ = std::chrono::steady_clock::now();
+    }
+  }
+
+  ~TraceSpan() {
+    if (name_ != nullptr) {
+      Tracer::global().complete(name_, start_, std::chrono::steady_clock::now(), std::move(args_));
+    }
+  }
+
+  TraceSpan(const TraceSpan&) = delete;
+  TraceSpan& operator=(const TraceSpan&) = delete;
+
+  bool active() const { return name_ != nullptr; }
+
+  TraceSpan& arg(std::string_view key, std::string_view value);
+  TraceSpan& arg(std::string_view key, int64_t value);
+  TraceSpan& arg(std::string_view key, size_t value) { return arg(key, static_cast<int64_t>(value)); }
+  TraceSpan& arg(std::string_view key, int value) { return arg(key, static_cast<int64_t>(value)); }
+
+private:
+  const char* name_;  // nullptr when tracing was off at construction
+  std::chrono::steady_clock::time_point start_;
+  std::string args_;
+};
+
+#else
+
+class TraceSpan {
+public:
+  explicit TraceSpan(const char*) {}
+  bool active() const { return false; }
+  template <typename T>
+  TraceSpan& arg(std::string_view, const T&) { return *this; }
+};
+
+#endif
+
+}  // namespace nx::util
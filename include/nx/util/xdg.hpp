@@ -17,7 +17,7 @@ class Xdg {
   // Get XDG cache home directory (~/.cache/nx)
   static std::filesystem::path cacheHome();
 
-  // Get XDG runtime directory (for temporary files)
+  // Get XDG runtime directory (for temporary files; per-user under /tmp without XDG_RUNTIME_DIR)
   static std::filesystem::path runtimeDir();
 
   // Ensure directory exists with proper permissions
@@ -3,10 +3,16 @@
 
 #include "nx/cli/application.hpp"
 #include "nx/cli/application_factory.hpp"
+#include "nx/cli/daemon.hpp"
 #include "nx/tui/tui_app.hpp"
 
 int main(int argc, char* argv[]) {
   try {
+    // A running `nx daemon` answers scriptable commands without loading anything here
+    if (auto forwarded = nx::cli::Daemon::forward(argc, argv)) {
+      return *forwarded;
+    }
+    
     // Check if we should launch TUI instead of CLI
     if (nx::tui::TUIApp::shouldLaunchTUI(argc, argv)) {
       // Create CLI application using factory for proper DI setup
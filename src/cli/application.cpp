@@ -1,11 +1,16 @@
 #include "nx/cli/application.hpp"
 
+#include <cassert>
+#include <iomanip>
 #include <iostream>
 #include <filesystem>
+#include <typeindex>
 
 #include "nx/store/filesystem_store.hpp"
 #include "nx/store/filesystem_attachment_store.hpp"
 #include "nx/index/index.hpp"
+#include "nx/util/timing.hpp"
+#include "nx/util/trace.hpp"
 #include "nx/util/xdg.hpp"
 #include "nx/di/service_configuration.hpp"
 
@@ -19,6 +24,7 @@
 #include "nx/cli/commands/grep_command.hpp"
 #include "nx/cli/commands/open_command.hpp"
 #include "nx/cli/commands/backlinks_command.hpp"
+#include "nx/cli/commands/graph_command.hpp"
 #include "nx/cli/commands/tags_command.hpp"
 #include "nx/cli/commands/export_command.hpp"
 
@@ -58,11 +64,28 @@
 // Configuration management
 #include "nx/cli/commands/config_command.hpp"
 
+// Automation
+#include "nx/cli/commands/batch_command.hpp"
+#include "nx/cli/commands/daemon_command.hpp"
+#include "nx/cli/commands/complete_command.hpp"
+
 // Sync management
 #include "nx/cli/commands/sync_command.hpp"
 
 namespace nx::cli {
 
+namespace {
+
+// Commands currently executing on this thread; more than one inside nx batch and the daemon
+thread_local int g_command_depth = 0;
+
+struct CommandDepth {
+  CommandDepth() { ++g_command_depth; }
+  ~CommandDepth() { --g_command_depth; }
+};
+
+}  // namespace
+
 Application::Application() 
     : app_("nx", "High-performance CLI notes application")
     , services_initialized_(false) {
@@ -93,17 +116,29 @@ Application::Application(std::shared_ptr<nx::di::IServiceContainer> container)
 }
 
 int Application::run(int argc, char* argv[]) {
+  // NX_TRACE=<file>: Chrome trace of this run (nx batch and the daemon share the outer one)
+  auto& tracer = nx::util::Tracer::global();
+  tracer.startFromEnvironment();
+  bool outermost = g_command_depth == 0;
+  
+  int exit_code = 0;
   try {
     app_.parse(argc, argv);
   } catch (const CLI::ParseError& e) {
-    return app_.exit(e);
+    exit_code = app_.exit(e);
   } catch (const std::exception& e) {
     std::cerr << "Error: " << e.what() << std::endl;
-    return 1;
+    exit_code = 1;
   }
   
   // The command has already been executed by CLI11's callback system
-  return 0;
+  if (outermost) {
+    auto flushed = tracer.flush();
+    if (!flushed.has_value()) {
+      std::cerr << "Warning: " << flushed.error().message() << std::endl;
+    }
+  }
+  return exit_code;
 }
 
 Result<void> Application::initialize() {
@@ -120,6 +155,7 @@ void Application::setupGlobalOptions() {
   app_.add_option("--config", global_options_.config_file, "Path to config file");
   app_.add_option("--notes-dir", global_options_.notes_dir, "Override notes directory");
   app_.add_flag("--no-color", global_options_.no_color, "Disable colored output");
+  app_.add_flag("--timings", global_options_.timings, "Print a per-phase timing breakdown to stderr");
 }
 
 void Application::setupCommands() {
@@ -135,6 +171,7 @@ void Application::setupCommands() {
   registerCommand(std::make_unique<GrepCommand>(*this));
   registerCommand(std::make_unique<OpenCommand>(*this));
   registerCommand(std::make_unique<BacklinksCommand>(*this));
+  registerCommand(std::make_unique<GraphCommand>(*this));
   registerCommand(std::make_unique<TagsCommand>(*this));
   
   // Import/Export commands
@@ -178,6 +215,13 @@ void Application::setupCommands() {
   
   // Synchronization commands
   registerCommand(std::make_unique<SyncCommand>(*this));
+  
+  // Scripted use: many operations per process, or a warm background process
+  registerCommand(std::make_unique<BatchCommand>(*this));
+  registerCommand(std::make_unique<DaemonCommand>(*this));
+  
+  // Shell completion backend (hidden)
+  registerCommand(std::make_unique<CompleteCommand>(*this));
 }
 
 void Application::setupHelp() {
@@ -188,6 +232,7 @@ void Application::setupHelp() {
   nx new --tags work,important  # Title automatically derived from first line
   nx ls --tag work --since 2024-01-01
   nx grep "algorithm" --regex
+  nx graph neighbors abc123 --depth 2
   nx edit abc123
   nx view 01234567 --json
   
@@ -215,6 +260,19 @@ void Application::registerCommand(std::unique_ptr<Command> command) {
   
   // Set callback to execute the command
   sub->callback([this, cmd_ptr]() {
+    auto started = std::chrono::steady_clock::now();
+    auto started_at = std::chrono::system_clock::now();
+    
+    // nx batch and the daemon run commands inside a command: the outermost one owns the phase totals
+    bool outermost = g_command_depth == 0;
+    auto& timings = nx::util::Timings::global();
+    if (outermost) {
+      timings.reset();
+      timings.setEnabled(global_options_.timings);
+    } else if (global_options_.timings) {
+      timings.setEnabled(true);
+    }
+    
     // Initialize services before running command
     auto init_result = initializeServices();
     if (!init_result.has_value()) {
@@ -227,7 +285,31 @@ void Application::registerCommand(std::unique_ptr<Command> command) {
       throw CLI::RuntimeError(1);
     }
     
-    auto result = cmd_ptr->execute(global_options_);
+    bool record_metrics = !config().performance.metrics_file.empty();
+    if (record_metrics) {
+      timings.setEnabled(true);
+    }
+    timings.record("services.init", std::chrono::steady_clock::now() - started);
+    
+    Result<int> result = 0;
+    {
+      CommandDepth depth;
+      nx::util::TraceSpan span("command.execute");
+      span.arg("command", cmd_ptr->name());
+      active_command_ = cmd_ptr;
+      result = cmd_ptr->execute(global_options_);
+      active_command_ = nullptr;
+    }
+    auto elapsed = std::chrono::steady_clock::now() - started;
+    if (global_options_.verbose >= 2) {
+      printServiceTimings(*cmd_ptr);
+    }
+    if (global_options_.timings && outermost) {
+      printTimings(*cmd_ptr, elapsed);
+    }
+    if (record_metrics) {
+      recordMetrics(*cmd_ptr, started_at, elapsed, outermost);
+    }
     if (!result.has_value()) {
       if (global_options_.json) {
         std::cout << R"({"error": ")" << result.error().message() << R"(", "code": )" 
@@ -275,6 +357,78 @@ Result<void> Application::initializeServices() {
   return {};
 }
 
+void Application::printServiceTimings(const Command& command) const {
+  struct Known {
+    std::type_index type;
+    std::optional<Service> service;  // Config is open to every command
+    const char* name;
+  };
+  static const Known kKnown[] = {
+    {typeid(nx::config::Config), std::nullopt, "config"},
+    {typeid(nx::store::NoteStore), Service::kNoteStore, "note store"},
+    {typeid(nx::store::NotebookManager), Service::kNotebookManager, "notebook manager"},
+    {typeid(nx::store::AttachmentStore), Service::kAttachmentStore, "attachment store"},
+    {typeid(nx::index::Index), Service::kSearchIndex, "search index"},
+    {typeid(nx::template_system::TemplateManager), Service::kTemplateManager, "template manager"},
+  };
+  
+  if (!service_container_) {
+    return;
+  }
+  auto declared = command.requiredServices();
+  
+  // Self time only: a factory that resolved another service does not count it twice
+  std::cerr << "Services constructed for '" << command.name() << "':\n";
+  for (const auto& timing : service_container_->constructionTimings()) {
+    std::string name = timing.type.name();
+    bool undeclared = false;
+    for (const auto& known : kKnown) {
+      if (known.type == timing.type) {
+        name = known.name;
+        undeclared = known.service.has_value() && !declared.contains(*known.service);
+      }
+    }
+    double ms = std::chrono::duration<double, std::milli>(timing.elapsed).count();
+    std::cerr << "  " << std::left << std::setw(18) << name << std::right << std::fixed
+              << std::setprecision(2) << std::setw(9) << ms << " ms"
+              << (undeclared ? "  (not declared)" : "") << "\n";
+  }
+}
+
+void Application::printTimings(const Command& command, std::chrono::nanoseconds elapsed) const {
+  auto ms = [](uint64_t micros) { return static_cast<double>(micros) / 1000.0; };
+  
+  std::cerr << "Timings for '" << command.name() << "': " << std::fixed << std::setprecision(2)
+            << std::chrono::duration<double, std::milli>(elapsed).count() << " ms total\n";
+  std::cerr << "  " << std::left << std::setw(20) << "phase" << std::right << std::setw(7) << "calls"
+            << std::setw(11) << "total ms" << std::setw(9) << "p50" << std::setw(9) << "p95"
+            << std::setw(9) << "p99" << std::setw(9) << "max" << "\n";
+  // Phases nest (a listing includes the loads it makes), so they need not sum to the total
+  for (const auto& phase : nx::util::Timings::global().phases()) {
+    const auto& h = phase.histogram;
+    std::cerr << "  " << std::left << std::setw(20) << phase.name << std::right << std::setw(7) << h.count()
+              << std::setw(11) << ms(h.totalMicros()) << std::setw(9) << ms(h.percentileMicros(50))
+              << std::setw(9) << ms(h.percentileMicros(95)) << std::setw(9) << ms(h.percentileMicros(99))
+              << std::setw(9) << ms(h.maxMicros()) << "\n";
+  }
+}
+
+void Application::recordMetrics(const Command& command, std::chrono::system_clock::time_point started,
+                                 std::chrono::nanoseconds elapsed, bool with_phases) {
+  nx::util::MetricsFile::Run run;
+  run.command = command.name();
+  run.started = started;
+  run.elapsed = elapsed;
+  if (with_phases) {
+    run.phases = nx::util::Timings::global().phases();
+  }
+  
+  // Metrics must never fail the command they measure
+  auto appended = nx::util::MetricsFile(config().performance.metrics_file).append(run);
+  if (!appended.has_value() && global_options_.verbose > 0) {
+    std::cerr << "Warning: " << appended.error().message() << "\n";
+  }
+}
 
 // Getters for services (to be used by commands)
 const GlobalOptions& Application::globalOptions() const {
@@ -292,6 +446,7 @@ nx::store::NoteStore& Application::noteStore() {
   if (!services_initialized_) {
     throw std::runtime_error("Services not initialized");
   }
+  checkDeclared(Service::kNoteStore);
   return *service_container_->resolve<nx::store::NoteStore>();
 }
 
@@ -299,6 +454,7 @@ nx::store::NotebookManager& Application::notebookManager() {
   if (!services_initialized_) {
     throw std::runtime_error("Services not initialized");
   }
+  checkDeclared(Service::kNotebookManager);
   return *service_container_->resolve<nx::store::NotebookManager>();
 }
 
@@ -306,6 +462,7 @@ nx::store::AttachmentStore& Application::attachmentStore() {
   if (!services_initialized_) {
     throw std::runtime_error("Services not initialized");
   }
+  checkDeclared(Service::kAttachmentStore);
   return *service_container_->resolve<nx::store::AttachmentStore>();
 }
 
@@ -313,6 +470,7 @@ nx::index::Index& Application::searchIndex() {
   if (!services_initialized_) {
     throw std::runtime_error("Services not initialized");
   }
+  checkDeclared(Service::kSearchIndex);
   return *service_container_->resolve<nx::index::Index>();
 }
 
@@ -320,9 +478,17 @@ nx::template_system::TemplateManager& Application::templateManager() {
   if (!services_initialized_) {
     throw std::runtime_error("Services not initialized");
   }
+  checkDeclared(Service::kTemplateManager);
   return *service_container_->resolve<nx::template_system::TemplateManager>();
 }
 
+void Application::checkDeclared(Service service) const {
+  // A command that resolves a service it does not declare is a bug in its declaration
+  assert((active_command_ == nullptr || active_command_->requiredServices().contains(service)) &&
+         "command resolved a service missing from its requiredServices()");
+  (void)service;
+}
+
 std::shared_ptr<nx::di::IServiceContainer> Application::serviceContainer() const {
   return service_container_;
 }
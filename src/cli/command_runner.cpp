@@ -0,0 +1,45 @@
+#include "nx/cli/command_runner.hpp"
+
+#include <iostream>
+#include <sstream>
+
+#include "nx/cli/application_factory.hpp"
+
+namespace nx::cli {
+
+CommandRunner::CommandRunner(std::shared_ptr<nx::di::IServiceContainer> container)
+    : container_(std::move(container)) {
+}
+
+CommandRunner::Output CommandRunner::run(std::vector<std::string> args, const std::string& input) const {
+  std::ostringstream out;
+  std::ostringstream err;
+  std::istringstream in(input);
+  auto* saved_out = std::cout.rdbuf(out.rdbuf());
+  auto* saved_err = std::cerr.rdbuf(err.rdbuf());
+  auto* saved_in = std::cin.rdbuf(in.rdbuf());
+
+  Output output;
+  try {
+    auto app = ApplicationFactory::createWithContainer(container_);
+    std::vector<char*> argv;
+    for (auto& arg : args) {
+      argv.push_back(arg.data());
+    }
+    argv.push_back(nullptr);
+    output.exit_code = app->run(static_cast<int>(args.size()), argv.data());
+  } catch (const std::exception& e) {
+    err << "Error: " << e.what() << std::endl;
+  }
+
+  std::cout.flush();
+  std::cout.rdbuf(saved_out);
+  std::cerr.rdbuf(saved_err);
+  std::cin.rdbuf(saved_in);
+
+  output.out = out.str();
+  output.err = err.str();
+  return output;
+}
+
+} // namespace nx::cli
@@ -3,6 +3,9 @@
 #include <iostream>
 #include <nlohmann/json.hpp>
 
+#include "nx/index/link_graph.hpp"
+#include "nx/util/xdg.hpp"
+
 namespace nx::cli {
 
 BacklinksCommand::BacklinksCommand(Application& app) : app_(app) {
@@ -32,8 +35,13 @@ Result<int> BacklinksCommand::execute(const GlobalOptions& options) {
       return 1;
     }
 
-    // Get backlinks
-    auto backlinks_result = app_.noteStore().getBacklinks(*resolved_id);
+    // Get backlinks from the link graph, which only re-reads changed notes
+    auto link_graph = nx::index::LinkGraph::openForNotes(
+        app_.config().notes_dir, nx::util::Xdg::cacheHome(),
+        [this](const std::vector<nx::core::NoteId>& ids) { return app_.noteStore().loadBatch(ids); });
+    auto backlinks_result = link_graph.has_value()
+        ? Result<std::vector<nx::core::NoteId>>((*link_graph)->backlinks(*resolved_id))
+        : app_.noteStore().getBacklinks(*resolved_id);
     if (!backlinks_result.has_value()) {
       if (options.json) {
         std::cout << R"({"error": ")" << backlinks_result.error().message() << R"(", "note_id": ")" << resolved_id->toString() << R"("})" << std::endl;
@@ -0,0 +1,192 @@
+#include "nx/cli/commands/batch_command.hpp"
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <nlohmann/json.hpp>
+
+#include "nx/cli/command_runner.hpp"
+
+namespace nx::cli {
+
+namespace {
+
+// Interactive, recursive or long-running commands, which would read the batch input as
+// keystrokes or never return, and reindex and gc, which open their own index
+// transaction and cannot run inside the batch's
+const std::set<std::string> kRefusedCommands = {"batch", "daemon", "edit", "gc", "open", "reindex", "ui"};
+
+}  // namespace
+
+Result<BatchCommand::Operation> BatchCommand::parseOperation(const std::string& line) {
+  auto parsed = nlohmann::json::parse(line, nullptr, false);
+  if (parsed.is_discarded()) {
+    return std::unexpected(makeError(ErrorCode::kParseError, "Line is not valid JSON"));
+  }
+
+  Operation op;
+  const nlohmann::json* args = &parsed;
+  if (parsed.is_object()) {
+    if (!parsed.contains("args")) {
+      return std::unexpected(makeError(ErrorCode::kInvalidArgument, "Object form needs an \"args\" array"));
+    }
+    args = &parsed["args"];
+    if (parsed.contains("stdin") && parsed["stdin"].is_string()) {
+      op.input = parsed["stdin"].get<std::string>();
+    }
+    if (parsed.contains("id")) {
+      op.id = parsed["id"];
+    }
+  }
+  if (!args->is_array() || args->empty()) {
+    return std::unexpected(makeError(ErrorCode::kInvalidArgument, "Expected a non-empty array of arguments"));
+  }
+  for (const auto& arg : *args) {
+    if (!arg.is_string()) {
+      return std::unexpected(makeError(ErrorCode::kInvalidArgument, "Arguments must be strings"));
+    }
+    op.args.push_back(arg.get<std::string>());
+  }
+
+  // Global options would reconfigure the services every later operation shares
+  for (const auto& arg : op.args) {
+    if (arg == "--config" || arg == "--notes-dir" || arg.starts_with("--config=") ||
+        arg.starts_with("--notes-dir=")) {
+      return std::unexpected(makeError(ErrorCode::kInvalidArgument, arg + " is not allowed inside a batch"));
+    }
+    if (!arg.starts_with("-")) {
+      if (kRefusedCommands.contains(arg)) {
+        return std::unexpected(makeError(ErrorCode::kInvalidArgument, "'" + arg + "' cannot run inside a batch"));
+      }
+      break;
+    }
+  }
+  return op;
+}
+
+BatchCommand::BatchCommand(Application& app) : app_(app) {
+}
+
+void BatchCommand::setupCommand(CLI::App* cmd) {
+  cmd->add_option("file", input_file_, "File of JSON lines to run (default: stdin)");
+  cmd->add_flag("--continue-on-error", continue_on_error_, "Keep going after an operation fails");
+  cmd->add_option("--commit-every", commit_every_, "Operations per index transaction (default: 100)")
+      ->check(CLI::Range(1, 100000));
+}
+
+Result<int> BatchCommand::execute(const GlobalOptions& options) {
+  std::ifstream file;
+  std::istream* input = &std::cin;
+  if (input_file_ != "-") {
+    file.open(input_file_);
+    if (!file) {
+      return std::unexpected(makeError(ErrorCode::kFileNotFound, "Cannot open batch file: " + input_file_));
+    }
+    input = &file;
+  }
+
+  CommandRunner runner(app_.serviceContainer());
+  auto& index = app_.searchIndex();
+
+  // Index writes from a run of operations land in one transaction. Each operation runs
+  // under its own savepoint, so a failed one leaves no partial index writes behind
+  // without rolling the others back: their note files are already written.
+  bool transaction_open = false;
+  size_t in_transaction = 0;
+  auto commit = [&]() {
+    if (transaction_open) {
+      auto result = index.commitTransaction();
+      if (!result.has_value() && !options.quiet) {
+        std::cerr << "Warning: Failed to commit index transaction: " << result.error().message() << std::endl;
+      }
+      transaction_open = false;
+      in_transaction = 0;
+    }
+  };
+
+  auto batch_started = std::chrono::steady_clock::now();
+  size_t line_number = 0;
+  size_t succeeded = 0;
+  size_t failed = 0;
+  std::string line;
+  while (std::getline(*input, line)) {
+    ++line_number;
+    if (line.find_first_not_of(" \t\r") == std::string::npos) {
+      continue;
+    }
+
+    auto started = std::chrono::steady_clock::now();
+    nlohmann::json record;
+    record["line"] = line_number;
+
+    auto op = parseOperation(line);
+    if (!op.has_value()) {
+      record["ok"] = false;
+      record["exit_code"] = 1;
+      record["error"] = op.error().message();
+    } else {
+      if (!op->id.is_null()) {
+        record["id"] = op->id;
+      }
+      if (!transaction_open) {
+        // Backends without transactions still run every operation, one write at a time
+        transaction_open = index.beginTransaction().has_value();
+      }
+
+      bool savepoint_open = transaction_open && index.savepoint().has_value();
+
+      std::vector<std::string> args = {"nx", "--json"};
+      args.insert(args.end(), op->args.begin(), op->args.end());
+      auto output = runner.run(std::move(args), op->input);
+
+      if (savepoint_open) {
+        auto result = output.exit_code == 0 ? index.releaseSavepoint() : index.rollbackToSavepoint();
+        if (!result.has_value() && !options.quiet) {
+          std::cerr << "Warning: Failed to close index savepoint: " << result.error().message() << std::endl;
+        }
+      }
+
+      record["ok"] = output.exit_code == 0;
+      record["exit_code"] = output.exit_code;
+      auto result = nlohmann::json::parse(output.out, nullptr, false);
+      if (result.is_discarded()) {
+        result = output.out.empty() ? nlohmann::json() : nlohmann::json(output.out);
+      }
+      record["result"] = result;
+      if (output.exit_code != 0) {
+        if (result.is_object() && result.contains("error")) {
+          record["error"] = result["error"];
+        } else {
+          record["error"] = output.err;
+        }
+      }
+
+      if (transaction_open && ++in_transaction >= commit_every_) {
+        commit();
+      }
+    }
+    record["ms"] = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+
+    std::cout << record.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace) << std::endl;
+
+    if (record["ok"].get<bool>()) {
+      ++succeeded;
+    } else {
+      ++failed;
+      if (!continue_on_error_) {
+        break;
+      }
+    }
+  }
+  commit();
+
+  if (!options.quiet) {
+    auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - batch_started);
+    std::cerr << "Batch: " << succeeded << " succeeded, " << failed << " failed in "
+              << static_cast<int64_t>(elapsed.count()) << " ms" << std::endl;
+  }
+  return failed == 0 ? 0 : 1;
+}
+
+} // namespace nx::cli
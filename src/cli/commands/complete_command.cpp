@@ -0,0 +1,74 @@
+#include "nx/cli/commands/complete_command.hpp"
+
+#include <iostream>
+
+#include "nx/store/completion_cache.hpp"
+#include "nx/store/filesystem_store.hpp"
+#include "nx/store/note_store.hpp"
+
+namespace nx::cli {
+
+CompleteCommand::CompleteCommand(Application& app) : app_(app) {
+}
+
+Result<int> CompleteCommand::execute(const GlobalOptions& /*options*/) {
+  auto kind = nx::store::CompletionCache::parseKind(kind_);
+  if (!kind.has_value()) {
+    std::cerr << "Unknown completion kind: " << kind_ << " (ids, titles, notes, tags, notebooks)" << std::endl;
+    return 2;
+  }
+
+  // Share the store's cache file, so its writes keep this cache current
+  nx::store::CompletionCache::Config config;
+  config.notes_dir = app_.config().notes_dir;
+  if (auto* store = dynamic_cast<nx::store::FilesystemStore*>(&app_.noteStore())) {
+    config.notes_dir = store->config().notes_dir;
+    config.file = store->config().completion_file;
+  }
+  if (config.file.empty()) {
+    config.file = nx::store::CompletionCache::defaultFile(config.notes_dir);
+  }
+  nx::store::CompletionCache cache(config);
+
+  auto candidates = cache.complete(*kind, prefix_, limit_);
+  if (!candidates.has_value() && candidates.error().code() == ErrorCode::kNotFound) {
+    // First use, or notes changed outside nx: one pass over the store, then the store
+    // keeps the cache current
+    auto notes_version = cache.notesVersion();
+    std::vector<nx::store::CompletionCache::Entry> entries;
+    auto visited = app_.noteStore().forEach({}, [&entries](const nx::core::Note& note) {
+      entries.push_back(nx::store::CompletionCache::Entry::fromNote(note));
+      return true;
+    });
+    if (!visited.has_value()) {
+      return std::unexpected(visited.error());
+    }
+    auto built = cache.rebuild(entries, notes_version);
+    if (!built.has_value()) {
+      return std::unexpected(built.error());
+    }
+    candidates = cache.complete(*kind, prefix_, limit_);
+  }
+  if (!candidates.has_value()) {
+    return std::unexpected(candidates.error());
+  }
+
+  std::string out;
+  for (const auto& candidate : *candidates) {
+    out += candidate.value;
+    out += '\t';
+    out += candidate.description;
+    out += '\n';
+  }
+  std::cout << out << std::flush;
+  return 0;
+}
+
+void CompleteCommand::setupCommand(CLI::App* cmd) {
+  cmd->group("");  // Hidden: called by the completion scripts, not by people
+  cmd->add_option("kind", kind_, "ids, titles, notes, tags or notebooks")->required();
+  cmd->add_option("prefix", prefix_, "Text typed so far");
+  cmd->add_option("--limit", limit_, "Maximum number of candidates")->check(CLI::Range(1, 100000));
+}
+
+} // namespace nx::cli
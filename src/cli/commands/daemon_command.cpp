@@ -0,0 +1,106 @@
+#include "nx/cli/commands/daemon_command.hpp"
+
+#include <iostream>
+#include <nlohmann/json.hpp>
+
+#include "nx/cli/daemon.hpp"
+#include "nx/index/caching_index.hpp"
+#include "nx/index/sqlite_index.hpp"
+
+namespace nx::cli {
+
+DaemonCommand::DaemonCommand(Application& app) : app_(app) {
+}
+
+Result<int> DaemonCommand::execute(const GlobalOptions& options) {
+  if (subcommand_ == "start") {
+    return executeStart(options);
+  } else if (subcommand_ == "stop") {
+    return executeStop(options);
+  }
+  return executeStatus(options);
+}
+
+void DaemonCommand::setupCommand(CLI::App* cmd) {
+  cmd->require_subcommand(0, 1);
+
+  auto start_cmd = cmd->add_subcommand("start", "Run the daemon in the foreground (background it with &)");
+  start_cmd->add_option("--idle-exit", idle_minutes_, "Exit after this many minutes without a request (default: never)");
+  start_cmd->callback([this]() { subcommand_ = "start"; });
+
+  auto stop_cmd = cmd->add_subcommand("stop", "Ask a running daemon to exit");
+  stop_cmd->callback([this]() { subcommand_ = "stop"; });
+
+  auto status_cmd = cmd->add_subcommand("status", "Show whether a daemon is running (default)");
+  status_cmd->callback([this]() { subcommand_ = "status"; });
+}
+
+Result<int> DaemonCommand::executeStart(const GlobalOptions& options) {
+  Daemon::Config config;
+  config.notes_dir = app_.config().notes_dir;
+  config.idle_timeout = std::chrono::minutes(std::max(idle_minutes_, 0));
+  config.config_path = options.config_file.empty() ? nx::config::Config::defaultConfigPath()
+                                                   : std::filesystem::path(options.config_file);
+
+  // The daemon outlives many writes and commits its own batch on exit, so it is the one
+  // place write-behind batching is safe to turn on
+  nx::index::Index* backend = &app_.searchIndex();
+  if (auto* caching_index = dynamic_cast<nx::index::CachingIndex*>(backend)) {
+    backend = &caching_index->inner();
+  }
+  auto* sqlite_index = dynamic_cast<nx::index::SqliteIndex*>(backend);
+  const auto& performance = app_.config().performance;
+  if (sqlite_index != nullptr && performance.sqlite_write_batch > 0) {
+    (void)sqlite_index->setWriteBatching(performance.sqlite_write_batch,
+                                         std::chrono::milliseconds(performance.sqlite_write_batch_ms));
+  }
+
+  Daemon daemon(app_.serviceContainer(), config);
+  if (!options.quiet && !options.json) {
+    std::cout << "nx daemon listening on " << Daemon::defaultSocketPath().string() << std::endl;
+  }
+  auto result = daemon.run();
+  if (sqlite_index != nullptr) {
+    (void)sqlite_index->setWriteBatching(0, std::chrono::milliseconds(performance.sqlite_write_batch_ms));
+  }
+  if (!result.has_value()) {
+    return std::unexpected(result.error());
+  }
+  return 0;
+}
+
+Result<int> DaemonCommand::executeStop(const GlobalOptions& options) {
+  auto reply = Daemon::request(Daemon::defaultSocketPath(), {{"shutdown", true}});
+  bool stopped = reply.has_value();
+
+  if (options.json) {
+    nlohmann::json output;
+    output["stopped"] = stopped;
+    std::cout << output.dump() << std::endl;
+  } else if (!options.quiet) {
+    std::cout << (stopped ? "Daemon stopped." : "No daemon running.") << std::endl;
+  }
+  return stopped ? 0 : 1;
+}
+
+Result<int> DaemonCommand::executeStatus(const GlobalOptions& options) {
+  auto reply = Daemon::request(Daemon::defaultSocketPath(), {{"ping", true}});
+
+  if (options.json) {
+    nlohmann::json output = reply.has_value() ? *reply : nlohmann::json::object();
+    output["running"] = reply.has_value();
+    std::cout << output.dump() << std::endl;
+  } else if (!reply.has_value()) {
+    std::cout << "No daemon running. Start one with: nx daemon start &" << std::endl;
+  } else {
+    std::cout << "Daemon running (pid " << reply->value("pid", 0) << ")" << std::endl;
+    std::cout << "  Socket:   " << reply->value("socket", "") << std::endl;
+    std::cout << "  Uptime:   " << reply->value("uptime_seconds", int64_t{0}) << "s" << std::endl;
+    std::cout << "  Requests: " << reply->value("requests", uint64_t{0}) << std::endl;
+    std::cout << "  Watching notes for outside changes: " << (reply->value("watching", false) ? "yes" : "no")
+              << std::endl;
+  }
+  return reply.has_value() ? 0 : 1;
+}
+
+} // namespace nx::cli
@@ -5,6 +5,8 @@
 #include <chrono>
 #include <sstream>
 #include <algorithm>
+#include <map>
+#include <set>
 #include <sys/stat.h>
 #ifndef _WIN32
 #include <sys/statvfs.h>
@@ -12,7 +14,9 @@
 #endif
 #include <nlohmann/json.hpp>
 
+#include "nx/index/minhash_index.hpp"
 #include "nx/util/safe_process.hpp"
+#include "nx/util/timing.hpp"
 #include "nx/util/xdg.hpp"
 #include "nx/sync/git_sync.hpp"
 
@@ -88,7 +92,7 @@ void DoctorCommand::setupCommand(CLI::App* cmd) {
   cmd->add_flag("--verbose,-v", verbose_output_, "Show detailed output for all checks");
   cmd->add_flag("--quick,-q", quick_check_, "Run only essential checks (faster)");
   cmd->add_option("--category,-c", check_category_, 
-                  "Run checks for specific category (config,storage,git,tools,performance)");
+                  "Run checks for specific category (config,storage,git,tools,performance,duplicates)");
 }
 
 Result<void> DoctorCommand::runAllChecks(HealthReport& report) {
@@ -137,11 +141,17 @@ Result<void> DoctorCommand::runAllChecks(HealthReport& report) {
     report.checks.push_back(check.value());
   }
   
-  // Performance checks (skip in quick mode)
+  // Performance and duplicate checks (skip in quick mode)
   if (!quick_check_) {
     if (auto check = checkPerformance(); check.has_value()) {
       report.checks.push_back(check.value());
     }
+    if (auto check = checkDuplicates(); check.has_value()) {
+      report.checks.push_back(check.value());
+    }
+    if (auto check = checkCommandLatency(); check.has_value()) {
+      report.checks.push_back(check.value());
+    }
   }
   
   // Calculate summary statistics
@@ -197,6 +207,13 @@ Result<void> DoctorCommand::runCategoryChecks(const std::string& category, Healt
     if (auto check = checkPerformance(); check.has_value()) {
       report.checks.push_back(check.value());
     }
+    if (auto check = checkCommandLatency(); check.has_value()) {
+      report.checks.push_back(check.value());
+    }
+  } else if (category == "duplicates") {
+    if (auto check = checkDuplicates(); check.has_value()) {
+      report.checks.push_back(check.value());
+    }
   } else {
     return std::unexpected(makeError(ErrorCode::kInvalidArgument,
                                      "Unknown category: " + category));
@@ -581,6 +598,89 @@ Result<DoctorCommand::HealthCheck> DoctorCommand::checkPerformance() {
   return check;
 }
 
+Result<DoctorCommand::HealthCheck> DoctorCommand::checkCommandLatency() {
+  auto start = startTimer();
+  HealthCheck check;
+  check.name = "Command latency";
+  check.category = "performance";
+  check.passed = true;
+  
+  auto metrics_file = app_.config().performance.metrics_file;
+  if (metrics_file.empty()) {
+    check.message = "Not recorded (set performance.metrics_file to track P50/P95/P99 per command)";
+    check.duration_ms = endTimer(start);
+    return check;
+  }
+  
+  auto now = std::chrono::system_clock::now();
+  auto window_start = now - std::chrono::hours(24 * kLatencyWindowDays);
+  auto week_start = now - std::chrono::hours(24 * 7);
+  auto runs = nx::util::MetricsFile(metrics_file).read(window_start);
+  if (!runs.has_value() || runs->empty()) {
+    check.message = "No runs recorded in " + metrics_file.string() + " yet";
+    check.duration_ms = endTimer(start);
+    return check;
+  }
+  
+  struct Latency {
+    nx::util::LatencyHistogram window;
+    nx::util::LatencyHistogram week;
+  };
+  std::map<std::string, Latency> by_command;
+  for (const auto& run : *runs) {
+    auto& latency = by_command[run.command];
+    latency.window.record(run.elapsed);
+    if (run.started >= week_start) {
+      latency.week.record(run.elapsed);
+    }
+  }
+  
+  // P95 targets: everyday note operations, and full-text search
+  auto targetMs = [](const std::string& command) -> std::optional<double> {
+    static const std::set<std::string> kNoteOps = {"new", "view", "ls", "rm", "mv", "tags", "meta", "notebook"};
+    if (command == "grep") {
+      return 200.0;
+    }
+    if (kNoteOps.contains(command)) {
+      return 50.0;
+    }
+    return std::nullopt;
+  };
+  auto ms = [](uint64_t micros) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(1) << static_cast<double>(micros) / 1000.0;
+    return out.str();
+  };
+  
+  std::ostringstream message;
+  std::string slow;
+  message << by_command.size() << " commands over the last " << kLatencyWindowDays << " days "
+          << "(P50 / P95 / P99 ms, P95 over 7 days)";
+  for (const auto& [command, latency] : by_command) {
+    uint64_t p95 = latency.window.percentileMicros(95);
+    message << "\n    " << std::left << std::setw(14) << command << std::right << std::setw(6)
+            << latency.window.count() << " runs  " << ms(latency.window.percentileMicros(50)) << " / "
+            << ms(p95) << " / " << ms(latency.window.percentileMicros(99));
+    if (latency.week.count() > 0) {
+      message << "  (7d " << ms(latency.week.percentileMicros(95)) << ")";
+    }
+    if (auto target = targetMs(command); target && static_cast<double>(p95) / 1000.0 > *target) {
+      message << "  over " << static_cast<int>(*target) << " ms target";
+      slow += (slow.empty() ? "" : ", ") + command;
+    }
+  }
+  
+  check.message = message.str();
+  if (!slow.empty()) {
+    check.passed = false;
+    check.fix_suggestion = "P95 over target for " + slow +
+                           "; run with --timings to see which phase is slow, or try 'nx reindex optimize'";
+  }
+  
+  check.duration_ms = endTimer(start);
+  return check;
+}
+
 Result<DoctorCommand::HealthCheck> DoctorCommand::checkDatabase() {
   auto start = startTimer();
   HealthCheck check;
@@ -666,6 +766,51 @@ Result<DoctorCommand::HealthCheck> DoctorCommand::checkNotesIntegrity() {
   return check;
 }
 
+Result<DoctorCommand::HealthCheck> DoctorCommand::checkDuplicates() {
+  auto start = startTimer();
+  HealthCheck check;
+  check.name = "Duplicate Notes";
+  check.category = "duplicates";
+  
+  try {
+    auto& note_store = app_.noteStore();
+    auto related = nx::index::MinHashIndex::openForNotes(
+        app_.config().notes_dir, nx::util::Xdg::cacheHome(),
+        [&note_store](const std::vector<nx::core::NoteId>& ids) { return note_store.loadBatch(ids); });
+    
+    if (!related.has_value()) {
+      check.passed = false;
+      check.message = "Cannot build related-notes index: " + related.error().message();
+      check.fix_suggestion = "Check notes and cache directory permissions";
+    } else {
+      auto pairs = (*related)->duplicates(kDuplicateThreshold);
+      if (pairs.empty()) {
+        check.passed = true;
+        check.message = "No near-duplicate notes (" + std::to_string((*related)->size()) + " notes)";
+      } else {
+        check.passed = false;
+        check.message = "Found " + std::to_string(pairs.size()) + " near-duplicate pair(s):";
+        constexpr size_t kMaxListed = 5;
+        for (size_t i = 0; i < pairs.size() && i < kMaxListed; ++i) {
+          check.message += " " + pairs[i].first.toString() + " ~ " + pairs[i].second.toString() +
+                           " (" + std::to_string(static_cast<int>(pairs[i].similarity * 100)) + "%)";
+        }
+        if (pairs.size() > kMaxListed) {
+          check.message += " ...";
+        }
+        check.fix_suggestion = "Merge or delete the copies with 'nx edit' / 'nx rm'";
+      }
+    }
+  } catch (const std::exception& e) {
+    check.passed = false;
+    check.message = "Duplicate check failed: " + std::string(e.what());
+    check.fix_suggestion = "Check notes directory and cache permissions";
+  }
+  
+  check.duration_ms = endTimer(start);
+  return check;
+}
+
 void DoctorCommand::printReport(const HealthReport& report, const GlobalOptions& options) {
   if (options.json) {
     nlohmann::json json_report;
@@ -0,0 +1,239 @@
+#include "nx/cli/commands/graph_command.hpp"
+
+#include <iomanip>
+#include <iostream>
+#include <nlohmann/json.hpp>
+
+#include "nx/util/xdg.hpp"
+
+namespace nx::cli {
+
+GraphCommand::GraphCommand(Application& app) : app_(app) {
+}
+
+Result<int> GraphCommand::execute(const GlobalOptions& options) {
+  auto graph = nx::index::LinkGraph::openForNotes(
+      app_.config().notes_dir, nx::util::Xdg::cacheHome(),
+      [this](const std::vector<nx::core::NoteId>& ids) { return app_.noteStore().loadBatch(ids); });
+  if (!graph.has_value()) {
+    return std::unexpected(graph.error());
+  }
+
+  if (subcommand_ == "neighbors") {
+    return executeNeighbors(**graph, options);
+  } else if (subcommand_ == "path") {
+    return executePath(**graph, options);
+  } else if (subcommand_ == "components") {
+    return executeComponents(**graph, options);
+  } else if (subcommand_ == "central") {
+    return executeCentral(**graph, options);
+  }
+  return executeStats(**graph, options);
+}
+
+void GraphCommand::setupCommand(CLI::App* cmd) {
+  cmd->require_subcommand(0, 1);
+
+  auto stats_cmd = cmd->add_subcommand("stats", "Count notes, links, clusters and broken links (default)");
+  stats_cmd->callback([this]() { subcommand_ = "stats"; });
+
+  auto neighbors_cmd = cmd->add_subcommand("neighbors", "Notes within N links of a note");
+  neighbors_cmd->add_option("note_id", note_id_, "Note ID (can be partial)")->required();
+  neighbors_cmd->add_option("--depth,-d", depth_, "Number of hops to follow (default: 1)");
+  neighbors_cmd->add_option("--direction", direction_, "Follow links: out, in or both (default: both)")
+      ->check(CLI::IsMember({"out", "in", "both"}));
+  neighbors_cmd->callback([this]() { subcommand_ = "neighbors"; });
+
+  auto path_cmd = cmd->add_subcommand("path", "Shortest chain of links between two notes");
+  path_cmd->add_option("from", note_id_, "Starting note ID (can be partial)")->required();
+  path_cmd->add_option("to", target_id_, "Destination note ID (can be partial)")->required();
+  path_cmd->add_option("--direction", direction_, "Follow links: out, in or both (default: both)")
+      ->check(CLI::IsMember({"out", "in", "both"}));
+  path_cmd->callback([this]() { subcommand_ = "path"; });
+
+  auto components_cmd = cmd->add_subcommand("components", "Clusters of notes connected by links");
+  components_cmd->add_option("--min-size", min_size_, "Smallest cluster to show (default: 2)");
+  components_cmd->add_option("--limit,-n", limit_, "Number of clusters to show (default: 10)");
+  components_cmd->callback([this]() { subcommand_ = "components"; });
+
+  auto central_cmd = cmd->add_subcommand("central", "Most central notes by PageRank");
+  central_cmd->add_option("--limit,-n", limit_, "Number of notes to show (default: 10)");
+  central_cmd->callback([this]() { subcommand_ = "central"; });
+}
+
+std::string GraphCommand::titleOf(const nx::core::NoteId& id) {
+  auto note = app_.noteStore().load(id);
+  return note.has_value() ? note->title() : "(unable to load)";
+}
+
+namespace {
+
+nx::index::LinkGraph::Direction parseDirection(const std::string& direction) {
+  if (direction == "out") {
+    return nx::index::LinkGraph::Direction::kOutgoing;
+  }
+  if (direction == "in") {
+    return nx::index::LinkGraph::Direction::kIncoming;
+  }
+  return nx::index::LinkGraph::Direction::kBoth;
+}
+
+}  // namespace
+
+Result<int> GraphCommand::executeStats(const nx::index::LinkGraph& graph, const GlobalOptions& options) {
+  auto stats = graph.stats();
+
+  if (options.json) {
+    nlohmann::json output;
+    output["notes"] = stats.notes;
+    output["links"] = stats.links;
+    output["unresolved_links"] = stats.unresolved_links;
+    output["components"] = stats.components;
+    output["isolated"] = stats.isolated;
+    std::cout << output.dump() << std::endl;
+  } else {
+    std::cout << "Notes:            " << stats.notes << std::endl;
+    std::cout << "Links:            " << stats.links << std::endl;
+    std::cout << "Unresolved links: " << stats.unresolved_links << std::endl;
+    std::cout << "Components:       " << stats.components << std::endl;
+    std::cout << "Isolated notes:   " << stats.isolated << std::endl;
+  }
+  return 0;
+}
+
+Result<int> GraphCommand::executeNeighbors(const nx::index::LinkGraph& graph, const GlobalOptions& options) {
+  auto resolved_id = app_.noteStore().resolveSingle(note_id_);
+  if (!resolved_id.has_value()) {
+    return std::unexpected(resolved_id.error());
+  }
+
+  auto neighbors = graph.neighborhood(*resolved_id, depth_, parseDirection(direction_));
+
+  if (options.json) {
+    nlohmann::json json_neighbors = nlohmann::json::array();
+    for (const auto& neighbor : neighbors) {
+      nlohmann::json entry;
+      entry["id"] = neighbor.id.toString();
+      entry["title"] = titleOf(neighbor.id);
+      entry["distance"] = neighbor.distance;
+      json_neighbors.push_back(entry);
+    }
+
+    nlohmann::json output;
+    output["note_id"] = resolved_id->toString();
+    output["depth"] = depth_;
+    output["direction"] = direction_;
+    output["neighbors"] = json_neighbors;
+    std::cout << output.dump() << std::endl;
+  } else {
+    if (neighbors.empty()) {
+      if (!options.quiet) {
+        std::cout << "No linked notes within " << depth_ << " hop(s) of: " << resolved_id->toString() << std::endl;
+      }
+      return 0;
+    }
+    for (const auto& neighbor : neighbors) {
+      std::cout << std::string(2 * (neighbor.distance - 1), ' ') << neighbor.id.toString() << " | "
+                << titleOf(neighbor.id) << std::endl;
+    }
+  }
+  return 0;
+}
+
+Result<int> GraphCommand::executePath(const nx::index::LinkGraph& graph, const GlobalOptions& options) {
+  auto from_id = app_.noteStore().resolveSingle(note_id_);
+  if (!from_id.has_value()) {
+    return std::unexpected(from_id.error());
+  }
+  auto to_id = app_.noteStore().resolveSingle(target_id_);
+  if (!to_id.has_value()) {
+    return std::unexpected(to_id.error());
+  }
+
+  auto path = graph.shortestPath(*from_id, *to_id, parseDirection(direction_));
+
+  if (options.json) {
+    nlohmann::json json_path = nlohmann::json::array();
+    for (const auto& id : path) {
+      json_path.push_back({{"id", id.toString()}, {"title", titleOf(id)}});
+    }
+
+    nlohmann::json output;
+    output["from"] = from_id->toString();
+    output["to"] = to_id->toString();
+    output["found"] = !path.empty();
+    output["hops"] = path.empty() ? 0 : path.size() - 1;
+    output["path"] = json_path;
+    std::cout << output.dump() << std::endl;
+  } else {
+    if (path.empty()) {
+      std::cout << "No path between " << from_id->toString() << " and " << to_id->toString() << std::endl;
+      return 1;
+    }
+    for (size_t i = 0; i < path.size(); ++i) {
+      std::cout << (i == 0 ? "   " : "-> ") << path[i].toString() << " | " << titleOf(path[i]) << std::endl;
+    }
+  }
+  return 0;
+}
+
+Result<int> GraphCommand::executeComponents(const nx::index::LinkGraph& graph, const GlobalOptions& options) {
+  auto groups = graph.components(min_size_);
+
+  if (options.json) {
+    nlohmann::json json_groups = nlohmann::json::array();
+    for (size_t i = 0; i < groups.size() && i < limit_; ++i) {
+      nlohmann::json members = nlohmann::json::array();
+      for (const auto& id : groups[i]) {
+        members.push_back(id.toString());
+      }
+      json_groups.push_back({{"size", groups[i].size()}, {"notes", members}});
+    }
+
+    nlohmann::json output;
+    output["total_components"] = groups.size();
+    output["components"] = json_groups;
+    std::cout << output.dump() << std::endl;
+  } else {
+    if (groups.empty()) {
+      if (!options.quiet) {
+        std::cout << "No clusters of " << min_size_ << " or more linked notes." << std::endl;
+      }
+      return 0;
+    }
+    for (size_t i = 0; i < groups.size() && i < limit_; ++i) {
+      std::cout << "Cluster " << (i + 1) << " (" << groups[i].size() << " notes)" << std::endl;
+      constexpr size_t kMaxShown = 5;
+      for (size_t j = 0; j < groups[i].size() && j < kMaxShown; ++j) {
+        std::cout << "  " << groups[i][j].toString() << " | " << titleOf(groups[i][j]) << std::endl;
+      }
+      if (groups[i].size() > kMaxShown) {
+        std::cout << "  ... " << (groups[i].size() - kMaxShown) << " more" << std::endl;
+      }
+    }
+  }
+  return 0;
+}
+
+Result<int> GraphCommand::executeCentral(const nx::index::LinkGraph& graph, const GlobalOptions& options) {
+  auto ranked = graph.centrality(limit_);
+
+  if (options.json) {
+    nlohmann::json json_ranked = nlohmann::json::array();
+    for (const auto& entry : ranked) {
+      json_ranked.push_back({{"id", entry.id.toString()}, {"title", titleOf(entry.id)}, {"score", entry.score}});
+    }
+
+    nlohmann::json output;
+    output["notes"] = json_ranked;
+    std::cout << output.dump() << std::endl;
+  } else {
+    for (const auto& entry : ranked) {
+      std::cout << std::fixed << std::setprecision(4) << entry.score << "  " << entry.id.toString() << " | "
+                << titleOf(entry.id) << std::endl;
+    }
+  }
+  return 0;
+}
+
+} // namespace nx::cli
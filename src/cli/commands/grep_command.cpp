@@ -1,28 +1,117 @@
 #include "nx/cli/commands/grep_command.hpp"
 
+#include <chrono>
 #include <iostream>
 #include <iomanip>
+#include <regex>
 #include <nlohmann/json.hpp>
+#include "nx/cli/json_lines_writer.hpp"
 #include "nx/index/index.hpp"
+#include "nx/index/query_parser.hpp"
+#include "nx/store/note_store.hpp"
+#include "nx/util/timing.hpp"
 
 namespace nx::cli {
 
+namespace {
+
+nlohmann::json resultJson(const nx::index::SearchResult& result) {
+  nlohmann::json json_result;
+  json_result["id"] = result.id.toString();
+  json_result["title"] = result.title;
+  json_result["snippet"] = result.snippet;
+  json_result["score"] = result.score;
+  json_result["modified"] = std::chrono::duration_cast<std::chrono::seconds>(
+    result.modified.time_since_epoch()).count();
+  json_result["tags"] = result.tags;
+  if (result.notebook.has_value()) {
+    json_result["notebook"] = *result.notebook;
+  } else {
+    json_result["notebook"] = nullptr;
+  }
+  return json_result;
+}
+
+// Calls and total microseconds of the store.load timer so far
+std::pair<uint64_t, uint64_t> storeLoadTotals() {
+  for (const auto& phase : nx::util::Timings::global().phases()) {
+    if (phase.name == "store.load") {
+      return {phase.histogram.count(), phase.histogram.totalMicros()};
+    }
+  }
+  return {0, 0};
+}
+
+double millis(std::chrono::nanoseconds elapsed) {
+  return std::chrono::duration<double, std::milli>(elapsed).count();
+}
+
+// Statement text with the indentation common to its continuation lines removed
+std::vector<std::string> sqlLines(const std::string& sql) {
+  std::vector<std::string> lines;
+  size_t start = 0;
+  while (start <= sql.size()) {
+    size_t end = sql.find('\n', start);
+    lines.push_back(sql.substr(start, end == std::string::npos ? std::string::npos : end - start));
+    if (end == std::string::npos) {
+      break;
+    }
+    start = end + 1;
+  }
+  
+  size_t indent = std::string::npos;
+  for (size_t i = 1; i < lines.size(); ++i) {
+    size_t first = lines[i].find_first_not_of(' ');
+    if (first != std::string::npos) {
+      indent = std::min(indent, first);
+    }
+  }
+  for (size_t i = 1; i < lines.size() && indent != std::string::npos; ++i) {
+    lines[i].erase(0, std::min(indent, lines[i].size()));
+  }
+  return lines;
+}
+
+}  // namespace
+
 GrepCommand::GrepCommand(Application& app) : app_(app) {
 }
 
 Result<int> GrepCommand::execute(const GlobalOptions& options) {
   try {
-    // Create search query
+    // Field filters (tag:, notebook:, created:..), OR groups and negations read the same
+    // as in every other query; regex patterns are matched as written
     nx::index::SearchQuery search_query;
-    search_query.text = query_;
-    search_query.limit = 50;  // Default limit
+    if (use_regex_) {
+      search_query.text = query_;
+    } else {
+      auto parsed = nx::index::QueryParser::parse(query_);
+      if (!parsed.has_value()) {
+        if (options.json) {
+          std::cout << R"({"error": ")" << parsed.error().message() << R"(", "query": ")" << query_ << R"("})" << std::endl;
+        } else {
+          std::cout << "Error: " << parsed.error().message() << std::endl;
+        }
+        return 1;
+      }
+      search_query = std::move(*parsed);
+    }
+    search_query.limit = limit_;
+    search_query.offset = offset_;
     search_query.highlight = true;
 
-    // Note: Basic text search is performed. Case sensitivity and regex support
-    // are handled by the underlying search index implementation
+    if (explain_) {
+      return executeExplain(search_query, options);
+    }
+    if (jsonl_) {
+      return executeJsonLines(search_query);
+    }
 
-    // Perform the search
-    auto search_result = app_.searchIndex().search(search_query);
+    // Regex queries are matched directly against note content; the index only
+    // narrows the notes worth scanning. Plain queries go through FTS, fetching
+    // the page and the total match count in one query.
+    auto search_result = use_regex_ ? regexSearch(search_query.limit, search_query.offset)
+                                    : app_.searchIndex().searchPage(search_query);
     if (!search_result.has_value()) {
       if (options.json) {
         std::cout << R"({"error": ")" << search_result.error().message() << R"(", "query": ")" << query_ << R"("})" << std::endl;
@@ -32,31 +121,21 @@ Result<int> GrepCommand::execute(const GlobalOptions& options) {
       return 1;
     }
 
-    const auto& results = *search_result;
+    const auto& results = search_result->results;
+    const size_t total = search_result->total;
 
     if (options.json) {
       nlohmann::json json_results = nlohmann::json::array();
       
       for (const auto& result : results) {
-        nlohmann::json json_result;
-        json_result["id"] = result.id.toString();
-        json_result["title"] = result.title;
-        json_result["snippet"] = result.snippet;
-        json_result["score"] = result.score;
-        json_result["modified"] = std::chrono::duration_cast<std::chrono::seconds>(
-          result.modified.time_since_epoch()).count();
-        json_result["tags"] = result.tags;
-        if (result.notebook.has_value()) {
-          json_result["notebook"] = *result.notebook;
-        } else {
-          json_result["notebook"] = nullptr;
-        }
-        json_results.push_back(json_result);
+        json_results.push_back(resultJson(result));
       }
       
       nlohmann::json output;
       output["query"] = query_;
-      output["total_results"] = results.size();
+      output["total_results"] = total;
+      output["offset"] = offset_;
+      output["limit"] = limit_;
       output["results"] = json_results;
       output["use_regex"] = use_regex_;
       output["ignore_case"] = ignore_case_;
@@ -64,12 +143,21 @@ Result<int> GrepCommand::execute(const GlobalOptions& options) {
       std::cout << output.dump() << std::endl;
     } else {
       if (results.empty()) {
-        std::cout << "No results found for query: " << query_ << std::endl;
+        if (total > 0) {
+          std::cout << "No results past offset " << offset_ << " (" << total
+                    << " total) for query: " << query_ << std::endl;
+        } else {
+          std::cout << "No results found for query: " << query_ << std::endl;
+        }
         return 0;
       }
 
       if (!options.quiet) {
-        std::cout << "Found " << results.size() << " result(s) for query: " << query_ << std::endl;
+        std::cout << "Found " << total << " result(s) for query: " << query_;
+        if (results.size() < total) {
+          std::cout << " (showing " << offset_ + 1 << "-" << offset_ + results.size() << ")";
+        }
+        std::cout << std::endl;
         std::cout << std::string(50, '-') << std::endl;
       }
 
@@ -100,7 +188,7 @@ Result<int> GrepCommand::execute(const GlobalOptions& options) {
     return 0;
 
   } catch (const std::exception& e) {
-    if (options.json) {
+    if (options.json || jsonl_) {
       std::cout << R"({"error": ")" << e.what() << R"(", "query": ")" << query_ << R"("})" << std::endl;
     } else {
       std::cout << "Error: " << e.what() << std::endl;
@@ -109,10 +197,247 @@ Result<int> GrepCommand::execute(const GlobalOptions& options) {
   }
 }
 
+Result<int> GrepCommand::executeJsonLines(const nx::index::SearchQuery& search_query) {
+  // No envelope and no total: each match is written as soon as it is found
+  JsonLinesWriter writer(std::cout);
+  auto emit = [&writer](const nx::index::SearchResult& result) {
+    return writer.write(resultJson(result));
+  };
+  
+  Result<void> run_result;
+  if (use_regex_) {
+    auto page = regexSearch(search_query.limit, search_query.offset, emit);
+    if (!page.has_value()) {
+      run_result = std::unexpected(page.error());
+    }
+  } else {
+    auto visited = app_.searchIndex().searchEach(search_query, emit);
+    if (!visited.has_value()) {
+      run_result = std::unexpected(visited.error());
+    }
+  }
+  
+  if (!run_result.has_value()) {
+    writer.write({{"error", run_result.error().message()}, {"query", query_}});
+    return 1;
+  }
+  return 0;
+}
+
+Result<int> GrepCommand::executeExplain(const nx::index::SearchQuery& search_query,
+                                        const GlobalOptions& options) {
+  // Loads made anywhere below (snippet content, regex scans) show up on the store.load timer
+  auto& timings = nx::util::Timings::global();
+  bool timings_were_enabled = timings.enabled();
+  timings.setEnabled(true);
+  auto loads_before = storeLoadTotals();
+  auto started = std::chrono::steady_clock::now();
+  
+  Result<nx::index::SearchExplain> explain;
+  if (use_regex_) {
+    nx::index::SearchExplain regex_explain;
+    regex_explain.backend = "regex scan";
+    regex_explain.compiled_query = query_;
+    auto page = regexSearch(search_query.limit, search_query.offset, nullptr, &regex_explain);
+    if (page.has_value()) {
+      regex_explain.page = std::move(*page);
+      explain = std::move(regex_explain);
+    } else {
+      explain = std::unexpected(page.error());
+    }
+  } else {
+    explain = app_.searchIndex().explainSearch(search_query);
+  }
+  
+  auto elapsed = std::chrono::steady_clock::now() - started;
+  auto loads_after = storeLoadTotals();
+  timings.setEnabled(timings_were_enabled);
+  
+  if (!explain.has_value()) {
+    if (options.json) {
+      std::cout << R"({"error": ")" << explain.error().message() << R"(", "query": ")" << query_ << R"("})" << std::endl;
+    } else {
+      std::cout << "Error: " << explain.error().message() << std::endl;
+    }
+    return 1;
+  }
+  
+  // regexSearch() times its own loads
+  if (!use_regex_) {
+    explain->phases.push_back({"store loads",
+                               std::chrono::microseconds(loads_after.second - loads_before.second),
+                               loads_after.first - loads_before.first});
+  }
+  
+  if (options.json) {
+    nlohmann::json output;
+    output["query"] = query_;
+    output["backend"] = explain->backend;
+    output["compiled_query"] = explain->compiled_query;
+    output["sql"] = explain->sql;
+    output["query_plan"] = explain->query_plan;
+    output["phases"] = nlohmann::json::array();
+    for (const auto& phase : explain->phases) {
+      nlohmann::json json_phase;
+      json_phase["name"] = phase.name;
+      json_phase["ms"] = millis(phase.elapsed);
+      json_phase["rows"] = phase.rows.has_value() ? nlohmann::json(*phase.rows) : nlohmann::json(nullptr);
+      output["phases"].push_back(json_phase);
+    }
+    output["total_ms"] = millis(elapsed);
+    output["total_results"] = explain->page.total;
+    output["returned"] = explain->page.results.size();
+    std::cout << output.dump() << std::endl;
+    return 0;
+  }
+  
+  std::cout << "Backend: " << explain->backend << std::endl;
+  if (!explain->compiled_query.empty()) {
+    std::cout << "Query:   " << explain->compiled_query << std::endl;
+  }
+  if (!explain->sql.empty()) {
+    std::cout << "\nSQL:" << std::endl;
+    for (const auto& line : sqlLines(explain->sql)) {
+      std::cout << "  " << line << std::endl;
+    }
+  }
+  if (!explain->query_plan.empty()) {
+    std::cout << "\nQuery plan:" << std::endl;
+    for (const auto& step : explain->query_plan) {
+      std::cout << "  " << step << std::endl;
+    }
+  }
+  
+  // Phases are measured separately, so they need not add up to the total
+  std::cout << "\n  " << std::left << std::setw(22) << "phase" << std::right << std::setw(10) << "ms"
+            << std::setw(9) << "rows" << std::endl;
+  std::cout << std::fixed << std::setprecision(3);
+  for (const auto& phase : explain->phases) {
+    std::cout << "  " << std::left << std::setw(22) << phase.name << std::right << std::setw(10)
+              << millis(phase.elapsed) << std::setw(9)
+              << (phase.rows.has_value() ? std::to_string(*phase.rows) : "-") << std::endl;
+  }
+  std::cout << "  " << std::left << std::setw(22) << "total" << std::right << std::setw(10)
+            << millis(elapsed) << std::endl;
+  
+  std::cout << "\n" << explain->page.results.size() << " of " << explain->page.total
+            << " result(s) returned" << std::endl;
+  return 0;
+}
+
+Result<nx::index::SearchPage> GrepCommand::regexSearch(size_t limit, size_t offset,
+                                                       const nx::index::Index::SearchVisitor& emit,
+                                                       nx::index::SearchExplain* explain) {
+  using Clock = std::chrono::steady_clock;
+  // The clock is only read when the search is being explained
+  auto now = [explain]() { return explain ? Clock::now() : Clock::time_point{}; };
+  auto started = now();
+  
+  auto flags = std::regex::ECMAScript | std::regex::multiline | std::regex::optimize;
+  if (ignore_case_) {
+    flags |= std::regex::icase;
+  }
+  
+  std::regex pattern;
+  try {
+    pattern = std::regex(query_, flags);
+  } catch (const std::regex_error& e) {
+    return std::unexpected(makeError(ErrorCode::kInvalidArgument,
+                                     "Invalid regex '" + query_ + "': " + e.what()));
+  }
+  
+  // Trigram candidates: a superset of the notes that can match
+  auto parsed = now();
+  auto candidates = app_.searchIndex().scanCandidates(query_, true);
+  if (!candidates.has_value()) {
+    return std::unexpected(candidates.error());
+  }
+  if (explain) {
+    explain->phases.push_back({"parse", parsed - started, std::nullopt});
+    explain->phases.push_back({"candidates", now() - parsed, candidates->size()});
+  }
+  
+  // Every candidate is checked so the total is exact; only the page is materialized
+  nx::index::SearchPage page;
+  Clock::duration load_time{0};
+  Clock::duration match_time{0};
+  Clock::duration snippet_time{0};
+  Clock::duration build_time{0};
+  size_t loads = 0;
+  for (const auto& id : *candidates) {
+    auto step = now();
+    auto note = app_.noteStore().load(id);
+    load_time += now() - step;
+    if (!note.has_value()) {
+      continue;
+    }
+    ++loads;
+    
+    const std::string& content = note->content();
+    std::smatch match;
+    step = now();
+    bool matched = std::regex_search(content, match, pattern);
+    match_time += now() - step;
+    if (!matched) {
+      continue;
+    }
+    
+    size_t match_index = page.total++;
+    if (match_index < offset || match_index - offset >= limit) {
+      continue;
+    }
+    
+    step = now();
+    nx::index::SearchResult result;
+    result.id = note->id();
+    result.title = note->title();
+    result.score = 1.0;
+    result.modified = note->metadata().updated();
+    result.tags = note->metadata().tags();
+    result.notebook = note->notebook();
+    
+    // Snippet: the line holding the first match, with the match marked
+    auto match_start = static_cast<size_t>(match.position(0));
+    auto match_length = static_cast<size_t>(match.length(0));
+    size_t line_start = content.rfind('\n', match_start);
+    line_start = line_start == std::string::npos ? 0 : line_start + 1;
+    size_t line_end = content.find('\n', match_start + match_length);
+    if (line_end == std::string::npos) {
+      line_end = content.size();
+    }
+    auto snippet_start = now();
+    build_time += snippet_start - step;
+    result.snippet = content.substr(line_start, match_start - line_start) + "<mark>" +
+                     match.str(0) + "</mark>" +
+                     content.substr(match_start + match_length,
+                                    line_end - std::min(line_end, match_start + match_length));
+    snippet_time += now() - snippet_start;
+    
+    if (!emit) {
+      page.results.push_back(std::move(result));
+    } else if (!emit(result) || match_index + 1 - offset >= limit) {
+      break;
+    }
+  }
+  
+  if (explain) {
+    explain->phases.push_back({"execute", match_time, page.total});
+    explain->phases.push_back({"snippet", snippet_time, page.results.size()});
+    explain->phases.push_back({"result construction", build_time, page.results.size()});
+    explain->phases.push_back({"store loads", load_time, loads});
+  }
+  return page;
+}
+
 void GrepCommand::setupCommand(CLI::App* cmd) {
-  cmd->add_option("query", query_, "Search query/pattern")->required();
+  cmd->add_option("query", query_, "Search query (words, \"phrases\", tag:, notebook:, OR, -term) or regex pattern")->required();
   cmd->add_flag("--regex,-r", use_regex_, "Treat query as regex pattern");
   cmd->add_flag("--ignore-case,-i", ignore_case_, "Case insensitive search");
+  cmd->add_option("--limit,-l", limit_, "Maximum number of results")
+     ->check(CLI::Range(1, 10000));
+  cmd->add_option("--offset", offset_, "Skip this many results (pagination)");
+  cmd->add_flag("--jsonl", jsonl_, "Stream one JSON object per result as it is found");
+  cmd->add_flag("--explain", explain_, "Show the compiled query, its plan and time per phase");
 }
 
 } // namespace nx::cli
\ No newline at end of file
@@ -5,10 +5,30 @@
 #include <sstream>
 #include <algorithm>
 #include <nlohmann/json.hpp>
+#include "nx/cli/json_lines_writer.hpp"
 #include "nx/store/note_store.hpp"
 
 namespace nx::cli {
 
+namespace {
+
+nlohmann::json noteJson(const nx::core::Note& note) {
+  nlohmann::json note_json;
+  note_json["id"] = note.id().toString();
+  note_json["title"] = note.title();
+  note_json["created"] = std::chrono::duration_cast<std::chrono::milliseconds>(
+      note.metadata().created().time_since_epoch()).count();
+  note_json["modified"] = std::chrono::duration_cast<std::chrono::milliseconds>(
+      note.metadata().updated().time_since_epoch()).count();
+  note_json["tags"] = note.metadata().tags();
+  if (note.metadata().notebook().has_value()) {
+    note_json["notebook"] = *note.metadata().notebook();
+  }
+  return note_json;
+}
+
+}  // namespace
+
 ListCommand::ListCommand(Application& app) : app_(app) {
 }
 
@@ -30,6 +50,20 @@ Result<int> ListCommand::execute(const GlobalOptions& options) {
       query.until = parseISODate(before_);
     }
     
+    // Streamed: one note in memory at a time, in id (creation) order since
+    // sorting by modification time would need every note first
+    if (jsonl_) {
+      JsonLinesWriter writer(std::cout);
+      auto visited = app_.noteStore().forEach(query, [&writer](const nx::core::Note& note) {
+        return writer.write(noteJson(note));
+      });
+      if (!visited.has_value()) {
+        writer.write({{"error", visited.error().message()}});
+        return 1;
+      }
+      return 0;
+    }
+    
     // Get matching notes
     auto notes_result = app_.noteStore().search(query);
     if (!notes_result.has_value()) {
@@ -52,18 +86,7 @@ Result<int> ListCommand::execute(const GlobalOptions& options) {
     if (options.json) {
       nlohmann::json result = nlohmann::json::array();
       for (const auto& note : notes) {
-        nlohmann::json note_json;
-        note_json["id"] = note.id().toString();
-        note_json["title"] = note.title();
-        note_json["created"] = std::chrono::duration_cast<std::chrono::milliseconds>(
-            note.metadata().created().time_since_epoch()).count();
-        note_json["modified"] = std::chrono::duration_cast<std::chrono::milliseconds>(
-            note.metadata().updated().time_since_epoch()).count();
-        note_json["tags"] = note.metadata().tags();
-        if (note.metadata().notebook().has_value()) {
-          note_json["notebook"] = *note.metadata().notebook();
-        }
-        result.push_back(note_json);
+        result.push_back(noteJson(note));
       }
       std::cout << result.dump(2) << std::endl;
       return 0;
@@ -117,7 +140,7 @@ Result<int> ListCommand::execute(const GlobalOptions& options) {
     return 0;
 
   } catch (const std::exception& e) {
-    if (options.json) {
+    if (options.json || jsonl_) {
       std::cout << R"({"error": ")" << e.what() << R"("})" << std::endl;
     } else {
       std::cout << "Error: " << e.what() << std::endl;
@@ -132,6 +155,7 @@ void ListCommand::setupCommand(CLI::App* cmd) {
   cmd->add_option("--since", since_, "Show notes created/modified since date (ISO-8601)");
   cmd->add_option("--before", before_, "Show notes created/modified before date (ISO-8601)");
   cmd->add_flag("-l,--long", long_format_, "Use long format output");
+  cmd->add_flag("--jsonl", jsonl_, "Stream one JSON object per note, newest created first");
 }
 
 std::chrono::system_clock::time_point ListCommand::parseISODate(const std::string& date_str) {
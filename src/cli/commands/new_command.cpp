@@ -196,7 +196,8 @@ Result<int> NewCommand::execute(const GlobalOptions& options) {
 }
 
 bool NewCommand::hasStdinInput() const {
-  return !isatty(STDIN_FILENO);
+  // Content already buffered counts too: `nx batch` hands each operation its input that way
+  return !isatty(STDIN_FILENO) || std::cin.rdbuf()->in_avail() > 0;
 }
 
 std::string NewCommand::readStdinContent() const {
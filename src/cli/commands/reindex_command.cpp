@@ -65,6 +65,17 @@ Result<int> ReindexCommand::executeRebuild() {
     outputProgress("Index health check failed, proceeding with rebuild...", options);
   }
   
+  // SQLite builds a fresh database beside the live one, so searches keep running meanwhile.
+  // The swap happens behind the result cache, so cached answers are dropped first.
+  nx::index::Index* backend = &search_index;
+  if (auto* caching_index = dynamic_cast<nx::index::CachingIndex*>(backend)) {
+    caching_index->invalidate();
+    backend = &caching_index->inner();
+  }
+  if (auto* sqlite_index = dynamic_cast<nx::index::SqliteIndex*>(backend)) {
+    return executeShadowRebuild(*sqlite_index);
+  }
+  
   // Begin transaction for atomic rebuild
   auto tx_result = search_index.beginTransaction();
   if (!tx_result.has_value()) {
@@ -158,6 +169,67 @@ Result<int> ReindexCommand::executeRebuild() {
   return 0;
 }
 
+Result<int> ReindexCommand::executeShadowRebuild(nx::index::SqliteIndex& search_index) {
+  const auto& options = app_.globalOptions();
+  
+  auto stats_before = search_index.getStats();
+  auto start_time = std::chrono::steady_clock::now();
+  
+  outputProgress("Building new index from note files...", options);
+  
+  auto report = search_index.rebuildInShadow(app_.config().notes_dir);
+  if (!report.has_value()) {
+    if (options.json) {
+      std::cout << R"({"error": ")" << report.error().message() << R"(", "operation": "rebuild"})" << std::endl;
+    } else {
+      std::cout << "Error rebuilding index: " << report.error().message() << std::endl;
+      std::cout << "The existing index was left in place." << std::endl;
+    }
+    return 1;
+  }
+  
+  auto end_time = std::chrono::steady_clock::now();
+  auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
+  auto stats_after = search_index.getStats();
+  
+  if (options.json) {
+    nlohmann::json output;
+    output["success"] = true;
+    output["operation"] = "rebuild";
+    output["mode"] = "shadow";
+    output["duration_ms"] = duration.count();
+    output["notes_indexed"] = report->notes_indexed;
+    output["files_skipped"] = report->files_skipped;
+    
+    if (stats_before.has_value() && stats_after.has_value()) {
+      output["before"]["total_notes"] = stats_before->total_notes;
+      output["before"]["total_words"] = stats_before->total_words;
+      output["before"]["index_size_bytes"] = stats_before->index_size_bytes;
+      
+      output["after"]["total_notes"] = stats_after->total_notes;
+      output["after"]["total_words"] = stats_after->total_words;
+      output["after"]["index_size_bytes"] = stats_after->index_size_bytes;
+    }
+    
+    std::cout << output.dump(2) << std::endl;
+  } else {
+    std::cout << "Index rebuild completed successfully!" << std::endl;
+    std::cout << "Duration: " << duration.count() << "ms" << std::endl;
+    std::cout << "Indexed " << report->notes_indexed << " note(s)";
+    if (report->files_skipped > 0) {
+      std::cout << ", skipped " << report->files_skipped << " unreadable file(s)";
+    }
+    std::cout << std::endl;
+    
+    if (stats_after.has_value()) {
+      std::cout << "\nIndex Statistics:" << std::endl;
+      outputIndexStats(*stats_after, options);
+    }
+  }
+  
+  return 0;
+}
+
 Result<int> ReindexCommand::executeOptimize() {
   auto& search_index = app_.searchIndex();
   const auto& options = app_.globalOptions();
@@ -310,6 +382,8 @@ Result<int> ReindexCommand::executeStats() {
     
     output["last_updated"] = last_updated;
     output["last_optimized"] = last_optimized;
+    output["cache_hits"] = stats.cache_hits;
+    output["cache_misses"] = stats.cache_misses;
     
     std::cout << output.dump(2) << std::endl;
   } else {
@@ -346,6 +420,10 @@ void ReindexCommand::outputIndexStats(const nx::index::IndexStats& stats, const
     double bytes_per_note = static_cast<double>(stats.index_size_bytes) / static_cast<double>(stats.total_notes);
     std::cout << "  Index overhead: " << std::fixed << std::setprecision(1) << bytes_per_note << " bytes/note" << std::endl;
   }
+  
+  if (stats.cache_hits + stats.cache_misses > 0) {
+    std::cout << "  Result cache: " << stats.cache_hits << " hits, " << stats.cache_misses << " misses" << std::endl;
+  }
 }
 
 void ReindexCommand::outputProgress(const std::string& message, const GlobalOptions& options) {
@@ -7,7 +7,9 @@
 #include <nlohmann/json.hpp>
 
 #include "nx/core/note_id.hpp"
+#include "nx/index/minhash_index.hpp"
 #include "nx/util/http_client.hpp"
+#include "nx/util/xdg.hpp"
 
 namespace nx::cli {
 
@@ -54,8 +56,8 @@ Result<int> SuggestLinksCommand::execute(const GlobalOptions& options) {
       return 0;
     }
     
-    // Get all other notes for comparison
-    auto other_notes_result = getAllOtherNotes();
+    // Get the most similar notes as candidates
+    auto other_notes_result = getCandidateNotes(note);
     if (!other_notes_result.has_value()) {
       return std::unexpected(other_notes_result.error());
     }
@@ -67,11 +69,11 @@ Result<int> SuggestLinksCommand::execute(const GlobalOptions& options) {
         nlohmann::json result;
         result["note_id"] = note_id_;
         result["suggestions"] = nlohmann::json::array();
-        result["message"] = "No other notes found in collection";
+        result["message"] = "No related notes found in collection";
         result["success"] = true;
         std::cout << result.dump(2) << std::endl;
       } else {
-        std::cout << "No other notes found in your collection to link to." << std::endl;
+        std::cout << "No related notes found in your collection to link to." << std::endl;
       }
       return 0;
     }
@@ -217,35 +219,28 @@ Result<nx::core::Note> SuggestLinksCommand::loadNote() {
   return note_result.value();
 }
 
-Result<std::vector<nx::core::Note>> SuggestLinksCommand::getAllOtherNotes() {
-  // Use the efficient note store interface to get all notes
-  nx::store::NoteQuery query;
-  query.limit = 0;  // No limit - get all notes
-  
-  // Get all note IDs efficiently
-  auto note_ids_result = app_.noteStore().list(query);
-  if (!note_ids_result.has_value()) {
-    return std::unexpected(note_ids_result.error());
+Result<std::vector<nx::core::Note>> SuggestLinksCommand::getCandidateNotes(const nx::core::Note& note) {
+  // The related-notes index is cached between runs and only re-reads changed files
+  auto related = nx::index::MinHashIndex::openForNotes(
+      app_.config().notes_dir, nx::util::Xdg::cacheHome(),
+      [this](const std::vector<nx::core::NoteId>& ids) { return app_.noteStore().loadBatch(ids); });
+  if (!related.has_value()) {
+    return std::unexpected(related.error());
   }
   
-  std::vector<nx::core::Note> notes;
-  auto target_id = nx::core::NoteId::fromString(note_id_).value();
+  auto matches = (*related)->contains(note.id())
+      ? (*related)->similar(note.id(), kMaxCandidates)
+      : (*related)->similarToText(nx::index::MinHashIndex::indexedText(note), kMaxCandidates);
   
-  // Filter out the target note and collect IDs for batch loading
+  // Load only the candidates, most similar first
   std::vector<nx::core::NoteId> ids_to_load;
-  for (const auto& note_id : note_ids_result.value()) {
-    if (note_id != target_id) {
-      ids_to_load.push_back(note_id);
+  for (const auto& match : matches) {
+    if (match.id != note.id()) {
+      ids_to_load.push_back(match.id);
     }
   }
   
-  // Use batch loading for better performance
-  auto notes_result = app_.noteStore().loadBatch(ids_to_load);
-  if (!notes_result.has_value()) {
-    return std::unexpected(notes_result.error());
-  }
-  
-  return notes_result.value();
+  return app_.noteStore().loadBatch(ids_to_load);
 }
 
 Result<std::vector<SuggestLinksCommand::LinkSuggestion>> SuggestLinksCommand::suggestLinks(
@@ -260,7 +255,7 @@ Result<std::vector<SuggestLinksCommand::LinkSuggestion>> SuggestLinksCommand::su
   
   // Prepare context of other notes for AI analysis
   std::string other_notes_context = "Available notes to link to:\n\n";
-  for (size_t i = 0; i < other_notes.size() && i < 10; ++i) {  // Limit for API call size
+  for (size_t i = 0; i < other_notes.size(); ++i) {  // Already capped at kMaxCandidates
     const auto& other_note = other_notes[i];
     other_notes_context += std::to_string(i + 1) + ". \"" + other_note.title() + "\" (" + 
                           other_note.id().toString() + ")\n";
@@ -1,10 +1,10 @@
 #include "nx/cli/commands/tags_command.hpp"
 
 #include <iostream>
-#include <unordered_map>
 #include <algorithm>
 #include <iomanip>
 #include <nlohmann/json.hpp>
+#include "nx/cli/json_lines_writer.hpp"
 #include "nx/store/note_store.hpp"
 #include "nx/core/note_id.hpp"
 
@@ -28,34 +28,24 @@ Result<int> TagsCommand::execute(const GlobalOptions& options) {
 
 Result<int> TagsCommand::executeList(const GlobalOptions& options) {
   try {
-    if (show_count_) {
-      // When showing counts, we need to iterate through all notes
-      // to count tag occurrences since getAllTags() only returns unique tags
-      std::unordered_map<std::string, size_t> tag_counts;
-      
-      // Get all notes to count tag usage
-      nx::store::NoteQuery query;
-      auto notes_result = app_.noteStore().search(query);
-      if (!notes_result.has_value()) {
-        if (options.json) {
-          std::cout << R"({"error": ")" << notes_result.error().message() << R"("})" << std::endl;
+    if (show_count_ || jsonl_) {
+      // Tag counts are maintained by the search index, so no note needs to be loaded
+      auto counts_result = app_.searchIndex().getTagCounts();
+      if (!counts_result.has_value()) {
+        if (options.json || jsonl_) {
+          std::cout << R"({"error": ")" << counts_result.error().message() << R"("})" << std::endl;
         } else {
-          std::cout << "Error: " << notes_result.error().message() << std::endl;
+          std::cout << "Error: " << counts_result.error().message() << std::endl;
         }
         return 1;
       }
 
-      const auto& notes = *notes_result;
-      
-      // Count tag occurrences
-      for (const auto& note : notes) {
-        for (const auto& tag : note.metadata().tags()) {
-          tag_counts[tag]++;
-        }
-      }
-
       // Convert to vector for sorting
-      std::vector<std::pair<std::string, size_t>> sorted_tags(tag_counts.begin(), tag_counts.end());
+      std::vector<std::pair<std::string, size_t>> sorted_tags;
+      sorted_tags.reserve(counts_result->size());
+      for (const auto& tag_count : *counts_result) {
+        sorted_tags.emplace_back(tag_count.tag, tag_count.count);
+      }
       
       // Sort by tag name alphabetically
       std::sort(sorted_tags.begin(), sorted_tags.end(), 
@@ -63,7 +53,15 @@ Result<int> TagsCommand::executeList(const GlobalOptions& options) {
                   return a.first < b.first;
                 });
 
-      if (options.json) {
+      if (jsonl_) {
+        // Counts come with every record: the index has them for free
+        JsonLinesWriter writer(std::cout);
+        for (const auto& [tag, count] : sorted_tags) {
+          if (!writer.write({{"name", tag}, {"count", count}})) {
+            break;
+          }
+        }
+      } else if (options.json) {
         nlohmann::json json_tags = nlohmann::json::array();
         
         for (const auto& [tag, count] : sorted_tags) {
@@ -97,21 +95,25 @@ Result<int> TagsCommand::executeList(const GlobalOptions& options) {
         }
       }
     } else {
-      // Simple tag listing without counts
-      auto tags_result = app_.noteStore().getAllTags();
-      if (!tags_result.has_value()) {
+      // Simple tag listing without counts; names come from the index's tag counts too,
+      // which is cheaper than reading every note's metadata
+      auto counts_result = app_.searchIndex().getTagCounts();
+      if (!counts_result.has_value()) {
         if (options.json) {
-          std::cout << R"({"error": ")" << tags_result.error().message() << R"("})" << std::endl;
+          std::cout << R"({"error": ")" << counts_result.error().message() << R"("})" << std::endl;
         } else {
-          std::cout << "Error: " << tags_result.error().message() << std::endl;
+          std::cout << "Error: " << counts_result.error().message() << std::endl;
         }
         return 1;
       }
 
-      const auto& tags = *tags_result;
+      std::vector<std::string> sorted_tags;
+      sorted_tags.reserve(counts_result->size());
+      for (const auto& tag_count : *counts_result) {
+        sorted_tags.push_back(tag_count.tag);
+      }
       
       // Sort tags alphabetically
-      auto sorted_tags = tags;
       std::sort(sorted_tags.begin(), sorted_tags.end());
 
       if (options.json) {
@@ -424,6 +426,7 @@ Result<int> TagsCommand::executeSet(const GlobalOptions& options) {
 void TagsCommand::setupCommand(CLI::App* cmd) {
   // Default behavior is list
   cmd->add_flag("--count,-c", show_count_, "Show note count for each tag");
+  cmd->add_flag("--jsonl", jsonl_, "Stream one JSON object per tag, with its note count");
   
   // Add subcommand - nx tags add <note_id> <tag1> <tag2> ...
   auto add_cmd = cmd->add_subcommand("add", "Add tags to a note");
@@ -0,0 +1,475 @@
+#include "nx/cli/daemon.hpp"
+
+#include <algorithm>
+#include <array>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <set>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif
+
+#include "nx/cli/command_runner.hpp"
+#include "nx/config/config.hpp"
+#include "nx/index/index.hpp"
+#include "nx/store/filesystem_store.hpp"
+#include "nx/util/xdg.hpp"
+
+namespace nx::cli {
+
+namespace {
+
+// Commands that neither prompt, read stdin, start an editor or UI nor write, so their
+// whole effect is their output and exit code
+const std::set<std::string> kForwardedCommands = {"ls", "view", "grep", "backlinks", "graph"};
+
+// Commands that also have write subcommands: only these read ones are forwarded ("" is
+// the bare command)
+const std::map<std::string, std::set<std::string>> kReadSubcommands = {
+    {"tags", {""}},
+    {"meta", {"get", "list", "ls"}},
+    {"notebook", {"list", "info"}},
+};
+
+// Upper bound on a request line; argument vectors are far smaller
+constexpr size_t kMaxRequestBytes = 1 << 20;
+
+// Requests are served one at a time, so a client that connects and then stalls may only
+// hold the others up this long
+constexpr time_t kClientTimeoutSeconds = 2;
+
+volatile std::sig_atomic_t g_stop_requested = 0;
+
+void requestStop(int) {
+  g_stop_requested = 1;
+}
+
+Result<sockaddr_un> socketAddress(const std::filesystem::path& path) {
+  sockaddr_un address{};
+  address.sun_family = AF_UNIX;
+  const std::string native = path.string();
+  if (native.size() >= sizeof(address.sun_path)) {
+    return std::unexpected(makeError(ErrorCode::kInvalidArgument, "Socket path too long: " + native));
+  }
+  std::memcpy(address.sun_path, native.c_str(), native.size() + 1);
+  return address;
+}
+
+// The socket runs commands as the daemon's user, so its directory must belong to us and be
+// closed to everyone else; otherwise another user could stand in for either end
+Result<void> checkPrivateDirectory(const std::filesystem::path& dir) {
+  struct stat info{};
+  if (::lstat(dir.c_str(), &info) != 0 || !S_ISDIR(info.st_mode)) {
+    return std::unexpected(makeError(ErrorCode::kDirectoryNotFound, "No socket directory at " + dir.string()));
+  }
+  if (info.st_uid != ::geteuid() || (info.st_mode & 0777) != 0700) {
+    return std::unexpected(makeError(ErrorCode::kSecurityError,
+                                     dir.string() + " must be owned by this user with mode 0700"));
+  }
+  return {};
+}
+
+// Whether the process at the other end of a connected socket runs as this user
+bool peerIsSameUser(int fd) {
+#ifdef __linux__
+  ucred credentials{};
+  socklen_t length = sizeof(credentials);
+  return ::getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &credentials, &length) == 0 &&
+         credentials.uid == ::geteuid();
+#else
+  uid_t uid = 0;
+  gid_t gid = 0;
+  return ::getpeereid(fd, &uid, &gid) == 0 && uid == ::geteuid();
+#endif
+}
+
+int connectTo(const std::filesystem::path& path) {
+  auto address = socketAddress(path);
+  if (!address.has_value()) {
+    return -1;
+  }
+  int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd < 0) {
+    return -1;
+  }
+  if (::connect(fd, reinterpret_cast<const sockaddr*>(&*address), sizeof(*address)) != 0) {
+    ::close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+bool writeAll(int fd, std::string_view data) {
+  while (!data.empty()) {
+    ssize_t written = ::send(fd, data.data(), data.size(), MSG_NOSIGNAL);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    data.remove_prefix(static_cast<size_t>(written));
+  }
+  return true;
+}
+
+// Reads up to the first newline (or EOF); false on error or an oversized message
+bool readLine(int fd, std::string& line) {
+  std::array<char, 16384> buffer{};
+  while (true) {
+    ssize_t got = ::recv(fd, buffer.data(), buffer.size(), 0);
+    if (got < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    if (got == 0) {
+      return true;
+    }
+    std::string_view chunk(buffer.data(), static_cast<size_t>(got));
+    size_t newline = chunk.find('\n');
+    line.append(chunk.substr(0, newline));
+    if (newline != std::string_view::npos) {
+      return true;
+    }
+    if (line.size() > kMaxRequestBytes) {
+      return false;
+    }
+  }
+}
+
+std::string dumpLine(const nlohmann::json& message) {
+  // Note text is not guaranteed to be valid UTF-8
+  return message.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace) + "\n";
+}
+
+}  // namespace
+
+Daemon::Daemon(std::shared_ptr<nx::di::IServiceContainer> container, Config config)
+    : container_(std::move(container)), config_(std::move(config)) {
+  if (config_.socket_path.empty()) {
+    config_.socket_path = defaultSocketPath();
+  }
+}
+
+Daemon::~Daemon() {
+  if (listen_fd_ >= 0) {
+    ::close(listen_fd_);
+    std::error_code ec;
+    std::filesystem::remove(config_.socket_path, ec);
+  }
+  if (watch_fd_ >= 0) {
+    ::close(watch_fd_);
+  }
+}
+
+std::filesystem::path Daemon::defaultSocketPath() {
+  return nx::util::Xdg::runtimeDir() / "daemon.sock";
+}
+
+bool Daemon::isForwardable(const std::vector<std::string>& args) {
+  for (size_t i = 1; i < args.size(); ++i) {
+    const auto& arg = args[i];
+    if (arg == "--config" || arg == "--notes-dir" || arg.starts_with("--config=") ||
+        arg.starts_with("--notes-dir=")) {
+      return false;
+    }
+    if (arg.starts_with("-")) {
+      continue;
+    }
+    if (kForwardedCommands.contains(arg)) {
+      return true;
+    }
+    auto read = kReadSubcommands.find(arg);
+    if (read == kReadSubcommands.end()) {
+      return false;
+    }
+    // These commands take no positional arguments of their own, so the next one names
+    // the subcommand
+    std::string subcommand;
+    for (size_t j = i + 1; j < args.size(); ++j) {
+      if (!args[j].starts_with("-")) {
+        subcommand = args[j];
+        break;
+      }
+    }
+    return read->second.contains(subcommand);
+  }
+  return false;
+}
+
+std::optional<int> Daemon::forward(int argc, char* argv[]) {
+  if (const char* disabled = std::getenv("NX_NO_DAEMON"); disabled != nullptr && *disabled != '\0') {
+    return std::nullopt;
+  }
+  std::vector<std::string> args(argv, argv + argc);
+  if (!isForwardable(args)) {
+    return std::nullopt;
+  }
+
+  std::error_code ec;
+  auto cwd = std::filesystem::current_path(ec);
+  // NX_NOTES_DIR, XDG_DATA_HOME, XDG_CONFIG_HOME and the config file all decide which
+  // notes this invocation means; the daemon only answers when it resolved the same ones
+  nx::config::Config config;
+  auto reply = request(defaultSocketPath(), {{"argv", args},
+                                             {"cwd", ec ? "" : cwd.string()},
+                                             {"notes_dir", config.notes_dir.string()},
+                                             {"config", nx::config::Config::defaultConfigPath().string()}});
+  if (!reply.has_value() || reply->value("mismatch", false)) {
+    // No daemon, one serving other notes, or it went away before answering: nothing
+    // ran, so run here
+    return std::nullopt;
+  }
+
+  std::cout << reply->value("stdout", "");
+  std::cerr << reply->value("stderr", "");
+  std::cout.flush();
+  return reply->value("exit_code", 1);
+}
+
+Result<nlohmann::json> Daemon::request(const std::filesystem::path& socket_path, const nlohmann::json& message) {
+  if (auto private_dir = checkPrivateDirectory(socket_path.parent_path()); !private_dir.has_value()) {
+    return std::unexpected(private_dir.error());
+  }
+  int fd = connectTo(socket_path);
+  if (fd < 0) {
+    return std::unexpected(makeError(ErrorCode::kNotFound, "No daemon listening on " + socket_path.string()));
+  }
+  if (!peerIsSameUser(fd)) {
+    ::close(fd);
+    return std::unexpected(makeError(ErrorCode::kSecurityError,
+                                     "Daemon on " + socket_path.string() + " runs as another user"));
+  }
+
+  std::string line;
+  bool ok = writeAll(fd, dumpLine(message)) && readLine(fd, line);
+  ::close(fd);
+  if (!ok || line.empty()) {
+    return std::unexpected(makeError(ErrorCode::kNetworkError, "Daemon closed the connection"));
+  }
+
+  auto reply = nlohmann::json::parse(line, nullptr, false);
+  if (reply.is_discarded() || !reply.is_object()) {
+    return std::unexpected(makeError(ErrorCode::kParseError, "Malformed reply from daemon"));
+  }
+  return reply;
+}
+
+Result<void> Daemon::run() {
+  auto address = socketAddress(config_.socket_path);
+  if (!address.has_value()) {
+    return std::unexpected(address.error());
+  }
+
+  // Private to this user: the socket runs commands with the daemon's permissions. An
+  // existing directory is used as found, so it is checked rather than trusted
+  if (!nx::util::Xdg::ensureDirectory(config_.socket_path.parent_path(), std::filesystem::perms::owner_all)) {
+    return std::unexpected(makeError(ErrorCode::kDirectoryCreateError,
+                                     "Cannot create " + config_.socket_path.parent_path().string()));
+  }
+  if (auto private_dir = checkPrivateDirectory(config_.socket_path.parent_path()); !private_dir.has_value()) {
+    return std::unexpected(private_dir.error());
+  }
+  if (int existing = connectTo(config_.socket_path); existing >= 0) {
+    ::close(existing);
+    return std::unexpected(makeError(ErrorCode::kInvalidState,
+                                     "A daemon is already listening on " + config_.socket_path.string()));
+  }
+  // Left behind by a daemon that did not shut down cleanly
+  std::error_code ec;
+  std::filesystem::remove(config_.socket_path, ec);
+
+  listen_fd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (listen_fd_ < 0) {
+    return std::unexpected(makeError(ErrorCode::kSystemError, std::string("socket: ") + std::strerror(errno)));
+  }
+  mode_t old_mask = ::umask(0077);
+  int bound = ::bind(listen_fd_, reinterpret_cast<const sockaddr*>(&*address), sizeof(*address));
+  ::umask(old_mask);
+  if (bound != 0 || ::listen(listen_fd_, 16) != 0) {
+    return std::unexpected(makeError(ErrorCode::kSystemError,
+                                     "Cannot listen on " + config_.socket_path.string() + ": " + std::strerror(errno)));
+  }
+
+#ifdef __linux__
+  if (!config_.notes_dir.empty()) {
+    watch_fd_ = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (watch_fd_ >= 0 &&
+        ::inotify_add_watch(watch_fd_, config_.notes_dir.c_str(),
+                            IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO) < 0) {
+      ::close(watch_fd_);
+      watch_fd_ = -1;
+    }
+  }
+#endif
+
+  struct sigaction action{};
+  action.sa_handler = requestStop;
+  ::sigemptyset(&action.sa_mask);
+  ::sigaction(SIGINT, &action, nullptr);
+  ::sigaction(SIGTERM, &action, nullptr);
+
+  started_ = std::chrono::steady_clock::now();
+  auto last_request = started_;
+  while (!stopping_ && g_stop_requested == 0) {
+    pollfd listener{listen_fd_, POLLIN, 0};
+    int ready = ::poll(&listener, 1, 1000);
+    if (ready < 0 && errno != EINTR) {
+      return std::unexpected(makeError(ErrorCode::kSystemError, std::string("poll: ") + std::strerror(errno)));
+    }
+    if (ready <= 0) {
+      if (config_.idle_timeout.count() > 0 &&
+          std::chrono::steady_clock::now() - last_request >= config_.idle_timeout) {
+        break;
+      }
+      continue;
+    }
+
+    int client = ::accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+    if (client < 0) {
+      continue;
+    }
+    if (!peerIsSameUser(client)) {
+      ::close(client);
+      continue;
+    }
+    timeval timeout{};
+    timeout.tv_sec = kClientTimeoutSeconds;
+    ::setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    ::setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+    std::string line;
+    if (readLine(client, line)) {
+      auto message = nlohmann::json::parse(line, nullptr, false);
+      auto reply = message.is_object()
+                       ? handle(message)
+                       : nlohmann::json{{"exit_code", 1}, {"stdout", ""}, {"stderr", "nx daemon: malformed request\n"}};
+      writeAll(client, dumpLine(reply));
+    }
+    ::close(client);
+    last_request = std::chrono::steady_clock::now();
+  }
+  return {};
+}
+
+nlohmann::json Daemon::handle(const nlohmann::json& request) {
+  if (request.value("shutdown", false)) {
+    stopping_ = true;
+    return {{"ok", true}};
+  }
+  if (request.value("ping", false)) {
+    auto uptime = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - started_);
+    return {{"pid", ::getpid()},
+            {"uptime_seconds", uptime.count()},
+            {"requests", requests_},
+            {"socket", config_.socket_path.string()},
+            {"watching", watch_fd_ >= 0}};
+  }
+
+  std::vector<std::string> args;
+  if (request.contains("argv") && request["argv"].is_array()) {
+    for (const auto& arg : request["argv"]) {
+      args.push_back(arg.is_string() ? arg.get<std::string>() : "");
+    }
+  }
+  if (!isForwardable(args)) {
+    return {{"exit_code", 1}, {"stdout", ""}, {"stderr", "nx daemon: this command runs in the calling process\n"}};
+  }
+  if (request.value("notes_dir", "") != config_.notes_dir.string() ||
+      request.value("config", "") != config_.config_path.string()) {
+    return {{"exit_code", 1},
+            {"stdout", ""},
+            {"stderr", "nx daemon: serving a different notes directory or config\n"},
+            {"mismatch", true}};
+  }
+
+  ++requests_;
+  syncChanges();
+
+  // Relative paths in arguments resolve against the caller's directory
+  std::error_code ec;
+  auto previous_dir = std::filesystem::current_path(ec);
+  if (auto cwd = request.value("cwd", ""); !cwd.empty()) {
+    std::filesystem::current_path(cwd, ec);
+  }
+
+  auto output = CommandRunner(container_).run(std::move(args));
+
+  if (!previous_dir.empty()) {
+    std::filesystem::current_path(previous_dir, ec);
+  }
+
+  return {{"exit_code", output.exit_code}, {"stdout", output.out}, {"stderr", output.err}};
+}
+
+void Daemon::syncChanges() {
+  auto note_store = container_->resolve<nx::store::NoteStore>();
+  auto* filesystem_store = dynamic_cast<nx::store::FilesystemStore*>(note_store.get());
+
+  if (watch_fd_ < 0) {
+    // No change feed: rescan metadata rather than risk answering from a stale cache
+    if (filesystem_store != nullptr) {
+      filesystem_store->clearCache();
+    }
+    return;
+  }
+
+#ifdef __linux__
+  std::set<std::string> changed;
+  alignas(inotify_event) std::array<char, 16384> buffer{};
+  while (true) {
+    ssize_t got = ::read(watch_fd_, buffer.data(), buffer.size());
+    if (got <= 0) {
+      break;
+    }
+    for (ssize_t offset = 0; offset < got;) {
+      const auto* event = reinterpret_cast<const inotify_event*>(buffer.data() + offset);
+      if (event->len > 0) {
+        std::string name(event->name);
+        if (name.ends_with(".md") && name.size() >= 26) {
+          changed.insert(name.substr(0, 26));
+        }
+      }
+      if (event->mask & IN_Q_OVERFLOW) {
+        changed.insert("");  // Lost events: at least drop the caches
+      }
+      offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+    }
+  }
+  if (changed.empty()) {
+    return;
+  }
+
+  if (filesystem_store != nullptr) {
+    filesystem_store->clearCache();
+  }
+  // Bring the index up to date with notes written by other processes (our own writes
+  // come back here too; re-indexing them is redundant but harmless)
+  auto index = container_->resolve<nx::index::Index>();
+  for (const auto& name : changed) {
+    auto id = nx::core::NoteId::fromString(name);
+    if (!id.has_value()) {
+      continue;
+    }
+    auto note = note_store->load(*id);
+    if (note.has_value()) {
+      index->updateNote(*note);
+    } else {
+      index->removeNote(*id);
+    }
+  }
+#endif
+}
+
+} // namespace nx::cli
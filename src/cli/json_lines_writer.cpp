@@ -0,0 +1,22 @@
+#include "nx/cli/json_lines_writer.hpp"
+
+namespace nx::cli {
+
+JsonLinesWriter::JsonLinesWriter(std::ostream& out) : out_(out) {
+}
+
+bool JsonLinesWriter::write(const nlohmann::json& record) {
+  if (!out_) {
+    return false;
+  }
+  // Invalid UTF-8 in a note must not end the stream halfway through
+  out_ << record.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace) << '\n';
+  out_.flush();
+  if (!out_) {
+    return false;
+  }
+  ++written_;
+  return true;
+}
+
+} // namespace nx::cli
@@ -9,6 +9,7 @@
 
 #include "nx/util/xdg.hpp"
 #include "nx/util/filesystem.hpp"
+#include "nx/util/timing.hpp"
 
 namespace nx::config {
 
@@ -65,6 +66,7 @@ Config::Config(const std::filesystem::path& config_path) {
 }
 
 Result<void> Config::load(const std::filesystem::path& config_path) {
+  nx::util::ScopedTimer timer("config.load");
   config_path_ = config_path;
   
   if (!std::filesystem::exists(config_path)) {
@@ -1047,6 +1049,29 @@ Result<void> Config::load(const std::filesystem::path& config_path) {
       if (auto value = (*perf_table)["sqlite_temp_store"].value<std::string>()) {
         performance.sqlite_temp_store = *value;
       }
+      if (auto value = (*perf_table)["sqlite_fts_content"].value<std::string>()) {
+        performance.sqlite_fts_content = *value;
+      }
+      if (auto value = (*perf_table)["sqlite_write_batch"].value<int>(); value && *value >= 0) {
+        performance.sqlite_write_batch = static_cast<size_t>(*value);
+      }
+      if (auto value = (*perf_table)["sqlite_write_batch_ms"].value<int>(); value && *value > 0) {
+        performance.sqlite_write_batch_ms = *value;
+      }
+      if (auto value = (*perf_table)["search_cache_entries"].value<int>(); value && *value >= 0) {
+        performance.search_cache_entries = static_cast<size_t>(*value);
+      }
+      if (auto value = (*perf_table)["metrics_file"].value<std::string>()) {
+        performance.metrics_file = *value;
+      }
+      if (auto prefix_array = (*perf_table)["sqlite_fts_prefix"].as_array()) {
+        performance.sqlite_fts_prefix.clear();
+        for (const auto& length : *prefix_array) {
+          if (auto length_value = length.value<int64_t>(); length_value && *length_value > 0) {
+            performance.sqlite_fts_prefix.push_back(static_cast<int>(*length_value));
+          }
+        }
+      }
     }
     
     return {};
@@ -1505,6 +1530,18 @@ Result<void> Config::save(const std::filesystem::path& config_path) const {
     perf_table.insert_or_assign("sqlite_journal_mode", performance.sqlite_journal_mode);
     perf_table.insert_or_assign("sqlite_synchronous", performance.sqlite_synchronous);
     perf_table.insert_or_assign("sqlite_temp_store", performance.sqlite_temp_store);
+    perf_table.insert_or_assign("sqlite_fts_content", performance.sqlite_fts_content);
+    auto prefix_array = toml::array{};
+    for (int length : performance.sqlite_fts_prefix) {
+      prefix_array.push_back(length);
+    }
+    perf_table.insert_or_assign("sqlite_fts_prefix", prefix_array);
+    perf_table.insert_or_assign("sqlite_write_batch", static_cast<int>(performance.sqlite_write_batch));
+    perf_table.insert_or_assign("sqlite_write_batch_ms", performance.sqlite_write_batch_ms);
+    perf_table.insert_or_assign("search_cache_entries", static_cast<int>(performance.search_cache_entries));
+    if (!performance.metrics_file.empty()) {
+      perf_table.insert_or_assign("metrics_file", performance.metrics_file.string());
+    }
     config_data.insert_or_assign("performance", perf_table);
     
     // Ensure parent directory exists
@@ -1608,12 +1645,16 @@ std::string Config::indexerTypeToString(IndexerType type) {
   switch (type) {
     case IndexerType::kFts: return "fts";
     case IndexerType::kRipgrep: return "ripgrep";
+    case IndexerType::kNative: return "native";
+    case IndexerType::kMemory: return "memory";
   }
   return "fts";
 }
 
 Config::IndexerType Config::stringToIndexerType(const std::string& str) {
   if (str == "ripgrep") return IndexerType::kRipgrep;
+  if (str == "native") return IndexerType::kNative;
+  if (str == "memory") return IndexerType::kMemory;
   return IndexerType::kFts;
 }
 
@@ -1669,6 +1710,10 @@ Result<std::string> Config::getValueByPath(const std::vector<std::string>& path)
     if (path[0] == "defaults") {
       if (path[1] == "notebook") return default_notebook;
     }
+    if (path[0] == "performance") {
+      if (path[1] == "sqlite_fts_content") return performance.sqlite_fts_content;
+      if (path[1] == "metrics_file") return performance.metrics_file.string();
+    }
   }
   
   return std::unexpected(makeError(ErrorCode::kConfigError, 
@@ -1701,6 +1746,17 @@ Result<void> Config::setValueByPath(const std::vector<std::string>& path, const
     if (path[0] == "defaults") {
       if (path[1] == "notebook") { default_notebook = value; return {}; }
     }
+    if (path[0] == "performance") {
+      if (path[1] == "sqlite_fts_content") {
+        if (value != "full" && value != "contentless") {
+          return std::unexpected(makeError(ErrorCode::kConfigError,
+                                           "sqlite_fts_content must be 'full' or 'contentless'"));
+        }
+        performance.sqlite_fts_content = value;
+        return {};
+      }
+      if (path[1] == "metrics_file") { performance.metrics_file = value; return {}; }
+    }
   }
   
   return std::unexpected(makeError(ErrorCode::kConfigError, 
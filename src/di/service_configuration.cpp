@@ -4,7 +4,10 @@
 #include "nx/store/filesystem_store.hpp"
 #include "nx/store/filesystem_attachment_store.hpp"
 #include "nx/store/notebook_manager.hpp"
+#include "nx/index/caching_index.hpp"
 #include "nx/index/sqlite_index.hpp"
+#include "nx/index/memory_index.hpp"
+#include "nx/index/native_grep_index.hpp"
 #include "nx/index/ripgrep_index.hpp"
 #include "nx/template/template_manager.hpp"
 #include "nx/util/xdg.hpp"
@@ -175,6 +178,7 @@ Result<void> ServiceConfiguration::configureStorage(
             store_config.trash_dir = nx::util::Xdg::trashDir();
             store_config.auto_create_dirs = true;
             store_config.validate_paths = true;
+            store_config.completion_file = nx::store::CompletionCache::defaultFile(store_config.notes_dir);
             
             return std::make_shared<nx::store::FilesystemStore>(store_config);
         },
@@ -196,12 +200,26 @@ Result<void> ServiceConfiguration::configureStorage(
         ServiceLifetime::Singleton
     );
     
-    // Register NotebookManager
+    // Register NotebookManager; listings come from index aggregates, resolved only when asked for
     container->registerFactory<nx::store::NotebookManager>(
         [container]() -> std::shared_ptr<nx::store::NotebookManager> {
             auto note_store = container->resolve<nx::store::NoteStore>();
             
-            return std::make_shared<nx::store::NotebookManager>(*note_store);
+            std::weak_ptr<IServiceContainer> weak_container = container;
+            auto index_provider = [weak_container]() -> nx::index::Index* {
+                auto owner = weak_container.lock();
+                if (!owner || !owner->isRegistered<nx::index::Index>()) {
+                    return nullptr;
+                }
+                // Singleton: the container keeps it alive. An index that fails to
+                // open leaves listings to the note store.
+                try {
+                    return owner->resolve<nx::index::Index>().get();
+                } catch (const std::exception&) {
+                    return nullptr;
+                }
+            };
+            return std::make_shared<nx::store::NotebookManager>(*note_store, std::move(index_provider));
         },
         ServiceLifetime::Singleton
     );
@@ -212,39 +230,112 @@ Result<void> ServiceConfiguration::configureStorage(
 Result<void> ServiceConfiguration::configureIndexing(
     std::shared_ptr<IServiceContainer> container) {
     
-    // Register Index (choose SQLite as primary, with ripgrep fallback)
+    // Register Index, fronted by a result cache unless it is turned off
     container->registerFactory<nx::index::Index>(
         [container]() -> std::shared_ptr<nx::index::Index> {
             auto config = container->resolve<nx::config::Config>();
+            auto index = createIndexBackend(container);
+            if (config->performance.search_cache_entries == 0) {
+                return index;
+            }
             
-            // Try SQLite index first
-            try {
-                auto db_path = nx::util::Xdg::indexFile();
-                auto sqlite_index = std::make_shared<nx::index::SqliteIndex>(db_path);
-                
-                auto init_result = sqlite_index->initialize();
-                if (init_result.has_value()) {
-                    return sqlite_index;
+            nx::index::CachingIndex::Config cache_config;
+            cache_config.capacity = config->performance.search_cache_entries;
+            // FTS and the memory index tokenize the query; the scanning backends match it literally
+            cache_config.collapse_whitespace =
+                dynamic_cast<nx::index::RipgrepIndex*>(index.get()) == nullptr &&
+                dynamic_cast<nx::index::NativeGrepIndex*>(index.get()) == nullptr;
+            return std::make_shared<nx::index::CachingIndex>(std::move(index), cache_config);
+        },
+        ServiceLifetime::Singleton
+    );
+    
+    return {};
+}
+
+std::shared_ptr<nx::index::Index> ServiceConfiguration::createIndexBackend(
+    std::shared_ptr<IServiceContainer> container) {
+    
+    // SQLite unless configured otherwise; scanning backends as fallback
+    auto config = container->resolve<nx::config::Config>();
+    auto notes_dir = nx::util::Xdg::notesDir();
+    
+    if (config->indexer == nx::config::Config::IndexerType::kMemory) {
+        auto note_store = container->resolve<nx::store::NoteStore>();
+        
+        nx::index::MemoryIndex::Config memory_config;
+        memory_config.snapshot_file = nx::util::Xdg::indexFile().parent_path() / "bm25.snapshot";
+        memory_config.note_source = [note_store]() {
+            return note_store->search(nx::store::NoteQuery{});
+        };
+        memory_config.content_provider =
+            [note_store](const nx::core::NoteId& id) -> std::optional<std::string> {
+                auto note = note_store->load(id);
+                if (!note.has_value()) {
+                    return std::nullopt;
                 }
-            } catch (...) {
-                // Fall through to ripgrep
+                return note->content();
+            };
+        
+        auto memory_index = std::make_shared<nx::index::MemoryIndex>(memory_config);
+        if (memory_index->initialize().has_value()) {
+            return memory_index;
+        }
+        // Fall through to the scanning backends
+    }
+    
+    if (config->indexer == nx::config::Config::IndexerType::kFts) {
+        try {
+            auto db_path = nx::util::Xdg::indexFile();
+            
+            nx::index::SqliteIndex::Config index_config;
+            if (config->performance.sqlite_fts_content == "contentless") {
+                index_config.content_mode = nx::index::SqliteIndex::ContentMode::kContentless;
             }
+            index_config.prefix_lengths = config->performance.sqlite_fts_prefix;
+            // Note bodies for snippets/rebuilds come from the store, not the index
+            auto note_store = container->resolve<nx::store::NoteStore>();
+            index_config.content_provider =
+                [note_store](const nx::core::NoteId& id) -> std::optional<std::string> {
+                    auto note = note_store->load(id);
+                    if (!note.has_value()) {
+                        return std::nullopt;
+                    }
+                    return note->content();
+                };
             
-            // Fallback to ripgrep index
-            auto notes_dir = nx::util::Xdg::notesDir();
-            auto ripgrep_index = std::make_shared<nx::index::RipgrepIndex>(notes_dir);
+            auto sqlite_index = std::make_shared<nx::index::SqliteIndex>(db_path, index_config);
             
-            auto init_result = ripgrep_index->initialize();
-            if (!init_result.has_value()) {
-                throw ServiceResolutionException("Failed to initialize any search index");
+            auto init_result = sqlite_index->initialize();
+            if (init_result.has_value()) {
+                return sqlite_index;
             }
-            
+        } catch (...) {
+            // Fall through to the scanning backends
+        }
+    }
+    
+    if (config->indexer != nx::config::Config::IndexerType::kNative) {
+        nx::index::RipgrepIndex::Config ripgrep_config;
+        ripgrep_config.cache_file = nx::util::Xdg::cacheHome() / "ripgrep_metadata.json";
+        auto ripgrep_index = std::make_shared<nx::index::RipgrepIndex>(notes_dir, ripgrep_config);
+        
+        if (ripgrep_index->initialize().has_value()) {
             return ripgrep_index;
-        },
-        ServiceLifetime::Singleton
-    );
+        }
+        // No rg on this host; the built-in engine needs no external tool
+    }
     
-    return {};
+    nx::index::NativeGrepIndex::Config native_config;
+    native_config.cache_file = nx::util::Xdg::cacheHome() / "native_grep_metadata.json";
+    auto native_index = std::make_shared<nx::index::NativeGrepIndex>(notes_dir, native_config);
+    
+    auto init_result = native_index->initialize();
+    if (!init_result.has_value()) {
+        throw ServiceResolutionException("Failed to initialize any search index");
+    }
+    
+    return native_index;
 }
 
 Result<void> ServiceConfiguration::configureTemplates(
@@ -1,5 +1,7 @@
 #include "nx/di/service_container.hpp"
 
+#include "nx/util/timing.hpp"
+
 namespace nx::di {
 
 // Static member definition
@@ -44,7 +46,24 @@ std::shared_ptr<void> ServiceContainer::resolveImpl(std::type_index type) {
             "No factory available for service: " + std::string(type.name()));
     }
     
-    auto instance = descriptor.factory();
+    auto started = std::chrono::steady_clock::now();
+    nested_time_.push_back(std::chrono::nanoseconds{0});
+    std::shared_ptr<void> instance;
+    try {
+        instance = descriptor.factory();
+    } catch (...) {
+        nested_time_.pop_back();
+        throw;
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - started);
+    auto nested = nested_time_.back();
+    nested_time_.pop_back();
+    if (!nested_time_.empty()) {
+        nested_time_.back() += elapsed;
+    }
+    timings_.push_back(ServiceTiming{type, elapsed - nested});
+    nx::util::Timings::global().record("services.construct", elapsed - nested);
     
     // Cache singleton instances
     if (descriptor.lifetime == ServiceLifetime::Singleton) {
@@ -58,4 +77,8 @@ bool ServiceContainer::isRegisteredImpl(std::type_index type) const {
     return services_.find(type) != services_.end();
 }
 
+std::vector<ServiceTiming> ServiceContainer::constructionTimings() const {
+    return timings_;
+}
+
 } // namespace nx::di
\ No newline at end of file
@@ -0,0 +1,309 @@
+#include "nx/index/caching_index.hpp"
+
+#include <algorithm>
+#include <cctype>
+
+namespace nx::index {
+
+namespace {
+
+// Separates fields in a cache key; never appears in query text typed by a user
+constexpr char kSeparator = '\x1f';
+
+// Exact, unlike a rounded date: two instants share a key only if they are equal
+std::string ticks(std::chrono::system_clock::time_point time) {
+  return std::to_string(time.time_since_epoch().count());
+}
+
+// Trimmed, with each run of whitespace collapsed to one space
+std::string collapseWhitespace(const std::string& text) {
+  std::string out;
+  bool space = false;
+  for (char c : text) {
+    if (std::isspace(static_cast<unsigned char>(c))) {
+      space = !out.empty();
+      continue;
+    }
+    if (space) {
+      out += ' ';
+      space = false;
+    }
+    out += c;
+  }
+  return out;
+}
+
+// Exact form of an expression for cache keys. toString() is for people: it rounds date
+// bounds to the day and only quotes values it needs to, so distinct queries can print
+// alike. Here bounds are clock ticks and values are length-prefixed.
+void appendExprKey(const QueryExpr& expr, std::string& key) {
+  key += std::to_string(static_cast<int>(expr.kind));
+  key += ':' + std::to_string(expr.value.size()) + ':' + expr.value;
+  for (const auto& bound : {expr.from, expr.to}) {
+    key += bound.has_value() ? ticks(*bound) : "";
+    key += ';';
+  }
+  key += '(';
+  for (const auto& child : expr.children) {
+    appendExprKey(child, key);
+  }
+  key += ')';
+}
+
+}  // namespace
+
+CachingIndex::CachingIndex(std::shared_ptr<Index> inner) : CachingIndex(std::move(inner), Config{}) {
+}
+
+CachingIndex::CachingIndex(std::shared_ptr<Index> inner, Config config)
+    : inner_(std::move(inner)), config_(config) {
+}
+
+std::string CachingIndex::normalize(const SearchQuery& query, bool collapse_whitespace) {
+  std::vector<std::string> tags = query.tags;
+  std::sort(tags.begin(), tags.end());
+  tags.erase(std::unique(tags.begin(), tags.end()), tags.end());
+
+  std::string key = collapse_whitespace ? collapseWhitespace(query.text) : query.text;
+  key += kSeparator;
+  for (const auto& tag : tags) {
+    key += tag + ',';
+  }
+  key += kSeparator;
+  key += query.notebook.has_value() ? "=" + *query.notebook : "";
+  key += kSeparator;
+  key += query.since.has_value() ? ticks(*query.since) : "";
+  key += kSeparator;
+  key += query.until.has_value() ? ticks(*query.until) : "";
+  key += kSeparator;
+  key += std::to_string(query.limit) + ':' + std::to_string(query.offset);
+  key += query.highlight ? 'h' : '-';
+  key += query.prefix_last_term ? 'p' : '-';
+  key += kSeparator;
+  // The parser builds one tree for equivalent spellings, so they still share an entry
+  if (query.expr.has_value()) {
+    appendExprKey(*query.expr, key);
+  }
+  return key;
+}
+
+std::string CachingIndex::queryKey(const char* kind, const SearchQuery& query) const {
+  return kind + std::string(1, kSeparator) + normalize(query, config_.collapse_whitespace);
+}
+
+template <typename T, typename Compute>
+Result<T> CachingIndex::cached(std::string key, Compute&& compute) {
+  // Read before computing: a change landing meanwhile makes the stored entry miss next time
+  const uint64_t change_counter = inner_->changeCounter();
+  uint64_t generation;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = lookup_.find(key);
+    if (it != lookup_.end() && it->second->generation == generation_ &&
+        it->second->change_counter == change_counter) {
+      entries_.splice(entries_.begin(), entries_, it->second);
+      ++hits_;
+      return std::get<T>(it->second->value);
+    }
+    ++misses_;
+    generation = generation_;
+  }
+
+  // The inner index does its own locking; a write meanwhile leaves this answer stale,
+  // which the generation recorded above catches
+  auto result = compute();
+  if (result.has_value()) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (generation == generation_) {
+      store(std::move(key), generation, change_counter, *result);
+    }
+  }
+  return result;
+}
+
+void CachingIndex::store(std::string key, uint64_t generation, uint64_t change_counter, Value value) {
+  if (config_.capacity == 0) {
+    return;
+  }
+  if (auto it = lookup_.find(key); it != lookup_.end()) {
+    entries_.erase(it->second);
+    lookup_.erase(it);
+  }
+  entries_.push_front(Entry{key, generation, change_counter, std::move(value)});
+  lookup_[std::move(key)] = entries_.begin();
+
+  while (entries_.size() > config_.capacity) {
+    lookup_.erase(entries_.back().key);
+    entries_.pop_back();
+  }
+}
+
+void CachingIndex::invalidate() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  ++generation_;
+  // Entries of older generations can never answer again
+  entries_.clear();
+  lookup_.clear();
+}
+
+uint64_t CachingIndex::generation() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return generation_;
+}
+
+Result<void> CachingIndex::initialize() {
+  invalidate();
+  return inner_->initialize();
+}
+
+// Writes bump the generation even when they fail: a partial write may still be visible
+
+Result<void> CachingIndex::addNote(const nx::core::Note& note) {
+  auto result = inner_->addNote(note);
+  invalidate();
+  return result;
+}
+
+Result<void> CachingIndex::updateNote(const nx::core::Note& note) {
+  auto result = inner_->updateNote(note);
+  invalidate();
+  return result;
+}
+
+Result<void> CachingIndex::removeNote(const nx::core::NoteId& id) {
+  auto result = inner_->removeNote(id);
+  invalidate();
+  return result;
+}
+
+Result<void> CachingIndex::rebuild() {
+  auto result = inner_->rebuild();
+  invalidate();
+  return result;
+}
+
+Result<void> CachingIndex::optimize() {
+  // Same answers afterwards, only faster
+  return inner_->optimize();
+}
+
+Result<void> CachingIndex::vacuum() {
+  return inner_->vacuum();
+}
+
+Result<std::vector<SearchResult>> CachingIndex::search(const SearchQuery& query) {
+  return cached<std::vector<SearchResult>>(queryKey("search", query),
+                                           [&]() { return inner_->search(query); });
+}
+
+Result<std::vector<nx::core::NoteId>> CachingIndex::searchIds(const SearchQuery& query) {
+  return cached<std::vector<nx::core::NoteId>>(queryKey("ids", query),
+                                               [&]() { return inner_->searchIds(query); });
+}
+
+Result<size_t> CachingIndex::searchCount(const SearchQuery& query) {
+  // Paging and snippets do not change a count
+  SearchQuery counted = query;
+  counted.limit = 0;
+  counted.offset = 0;
+  counted.highlight = false;
+  return cached<size_t>(queryKey("count", counted),
+                        [&]() { return inner_->searchCount(query); });
+}
+
+Result<SearchPage> CachingIndex::searchPage(const SearchQuery& query) {
+  return cached<SearchPage>(queryKey("page", query),
+                            [&]() { return inner_->searchPage(query); });
+}
+
+Result<size_t> CachingIndex::searchEach(const SearchQuery& query, const SearchVisitor& visit) {
+  // Streams are for output larger than is worth keeping; they go straight through
+  return inner_->searchEach(query, visit);
+}
+
+Result<std::vector<nx::core::NoteId>> CachingIndex::scanCandidates(const std::string& pattern,
+                                                                   bool is_regex) {
+  return inner_->scanCandidates(pattern, is_regex);
+}
+
+Result<std::vector<std::string>> CachingIndex::suggestTags(const std::string& prefix, size_t limit) {
+  return cached<std::vector<std::string>>(
+      "tags" + std::string(1, kSeparator) + prefix + kSeparator + std::to_string(limit),
+      [&]() { return inner_->suggestTags(prefix, limit); });
+}
+
+Result<std::vector<std::string>> CachingIndex::suggestNotebooks(const std::string& prefix, size_t limit) {
+  return cached<std::vector<std::string>>(
+      "notebooks" + std::string(1, kSeparator) + prefix + kSeparator + std::to_string(limit),
+      [&]() { return inner_->suggestNotebooks(prefix, limit); });
+}
+
+Result<std::vector<TagCount>> CachingIndex::getTagCounts() {
+  return cached<std::vector<TagCount>>("tag_counts", [&]() { return inner_->getTagCounts(); });
+}
+
+Result<IndexAggregates> CachingIndex::aggregate(const AggregateQuery& query) {
+  // Recent counts move with the clock, so only the same cutoff shares an entry
+  return cached<IndexAggregates>("aggregate" + std::string(1, kSeparator) +
+                                     ticks(query.recent_since) + kSeparator +
+                                     query.skip_title_prefix,
+                                 [&]() { return inner_->aggregate(query); });
+}
+
+Result<SearchExplain> CachingIndex::explainSearch(const SearchQuery& query) {
+  // Timing a cache hit would explain nothing
+  return inner_->explainSearch(query);
+}
+
+uint64_t CachingIndex::changeCounter() {
+  return inner_->changeCounter();
+}
+
+Result<IndexStats> CachingIndex::getStats() {
+  auto stats = inner_->getStats();
+  if (stats.has_value()) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats->cache_hits = hits_;
+    stats->cache_misses = misses_;
+  }
+  return stats;
+}
+
+Result<bool> CachingIndex::isHealthy() {
+  return inner_->isHealthy();
+}
+
+Result<void> CachingIndex::validateIndex() {
+  return inner_->validateIndex();
+}
+
+Result<void> CachingIndex::beginTransaction() {
+  return inner_->beginTransaction();
+}
+
+Result<void> CachingIndex::commitTransaction() {
+  return inner_->commitTransaction();
+}
+
+Result<void> CachingIndex::rollbackTransaction() {
+  // Answers cached inside the transaction saw writes that are now undone
+  auto result = inner_->rollbackTransaction();
+  invalidate();
+  return result;
+}
+
+Result<void> CachingIndex::savepoint() {
+  return inner_->savepoint();
+}
+
+Result<void> CachingIndex::releaseSavepoint() {
+  return inner_->releaseSavepoint();
+}
+
+Result<void> CachingIndex::rollbackToSavepoint() {
+  auto result = inner_->rollbackToSavepoint();
+  invalidate();
+  return result;
+}
+
+}  // namespace nx::index
@@ -0,0 +1,199 @@
+#include "nx/index/embedder.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+#include "nx/index/snapshot_io.hpp"
+#include "nx/index/text_features.hpp"
+
+namespace nx::index {
+
+namespace {
+
+constexpr char kCacheMagic[8] = {'N', 'X', 'E', 'M', 'B', 'C', '\0', '\0'};
+constexpr uint32_t kCacheVersion = 1;
+
+// Bigrams carry less weight than the words they are made of
+constexpr float kBigramWeight = 0.5f;
+
+void normalize(std::vector<float>& vector) {
+  double norm = 0.0;
+  for (float value : vector) {
+    norm += static_cast<double>(value) * static_cast<double>(value);
+  }
+  if (norm > 0.0) {
+    auto scale = static_cast<float>(1.0 / std::sqrt(norm));
+    for (float& value : vector) {
+      value *= scale;
+    }
+  }
+}
+
+}  // namespace
+
+// HashingEmbedder
+
+HashingEmbedder::HashingEmbedder() : HashingEmbedder(Config{}) {}
+
+HashingEmbedder::HashingEmbedder(Config config) : config_(config) {
+  config_.dimensions = std::max<size_t>(config_.dimensions, 1);
+}
+
+std::string HashingEmbedder::name() const {
+  return "hashing-v1-" + std::to_string(config_.dimensions) + (config_.bigrams ? "" : "-unigram");
+}
+
+Result<std::vector<float>> HashingEmbedder::embed(const std::string& text) {
+  auto words = contentWords(text);
+
+  std::unordered_map<std::string, float> counts;
+  for (size_t i = 0; i < words.size(); ++i) {
+    counts[words[i]] += 1.0f;
+    if (config_.bigrams && i + 1 < words.size()) {
+      counts[words[i] + ' ' + words[i + 1]] += kBigramWeight;
+    }
+  }
+
+  std::vector<float> vector(config_.dimensions, 0.0f);
+  for (const auto& [feature, count] : counts) {
+    uint64_t hash = featureHash(feature);
+    // Sublinear TF; a lone bigram keeps its reduced weight
+    float weight = count < 1.0f ? count : 1.0f + std::log(count);
+    vector[hash % config_.dimensions] += (hash >> 63) ? -weight : weight;
+  }
+
+  normalize(vector);
+  return vector;
+}
+
+// CachingEmbedder
+
+CachingEmbedder::CachingEmbedder(std::shared_ptr<Embedder> inner, Config config)
+    : inner_(std::move(inner)), config_(std::move(config)) {
+  if (!config_.cache_file.empty() && std::filesystem::exists(config_.cache_file)) {
+    // An unreadable cache only costs re-embedding
+    if (!load().has_value()) {
+      cache_.clear();
+    }
+  }
+}
+
+CachingEmbedder::~CachingEmbedder() {
+  (void)flush();
+}
+
+Result<std::vector<float>> CachingEmbedder::embed(const std::string& text) {
+  uint64_t key = contentHash(text);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = cache_.find(key);
+    if (it != cache_.end()) {
+      return it->second;
+    }
+  }
+
+  // Not under the lock: provider calls can take a while
+  auto vector = inner_->embed(text);
+  if (!vector.has_value()) {
+    return vector;
+  }
+  if (vector->size() != inner_->dimensions()) {
+    return std::unexpected(makeError(ErrorCode::kIndexError,
+                                     "Embedder " + inner_->name() + " returned " +
+                                         std::to_string(vector->size()) + " dimensions, expected " +
+                                         std::to_string(inner_->dimensions())));
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  cache_[key] = *vector;
+  dirty_ = true;
+  return vector;
+}
+
+size_t CachingEmbedder::cachedCount() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return cache_.size();
+}
+
+Result<void> CachingEmbedder::load() {
+  std::ifstream in(config_.cache_file, std::ios::binary);
+  if (!in) {
+    return std::unexpected(makeError(ErrorCode::kFileReadError,
+                                     "Cannot open embedding cache: " + config_.cache_file.string()));
+  }
+
+  SnapshotReader reader(in);
+  char magic[sizeof(kCacheMagic)];
+  in.read(magic, sizeof(magic));
+  if (!in || !std::equal(std::begin(magic), std::end(magic), std::begin(kCacheMagic)) ||
+      reader.get<uint32_t>() != kCacheVersion) {
+    return std::unexpected(makeError(ErrorCode::kIndexError, "Unrecognized embedding cache format"));
+  }
+
+  // Another model's vectors are useless here
+  if (reader.getString() != inner_->name() || reader.get<uint32_t>() != inner_->dimensions()) {
+    return {};
+  }
+
+  auto count = reader.get<uint64_t>();
+  for (uint64_t i = 0; i < count && reader.ok(); ++i) {
+    auto key = reader.get<uint64_t>();
+    auto vector = reader.getVector<float>();
+    if (vector.size() != inner_->dimensions()) {
+      return std::unexpected(makeError(ErrorCode::kIndexError, "Corrupt embedding cache"));
+    }
+    cache_[key] = std::move(vector);
+  }
+  if (!reader.ok()) {
+    return std::unexpected(makeError(ErrorCode::kIndexError, "Corrupt embedding cache"));
+  }
+  return {};
+}
+
+Result<void> CachingEmbedder::flush() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!dirty_ || config_.cache_file.empty()) {
+    return {};
+  }
+
+  std::error_code ec;
+  std::filesystem::create_directories(config_.cache_file.parent_path(), ec);
+
+  auto temp_path = config_.cache_file;
+  temp_path += ".tmp";
+  {
+    std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+      return std::unexpected(makeError(ErrorCode::kFileWriteError,
+                                       "Cannot write embedding cache: " + temp_path.string()));
+    }
+
+    SnapshotWriter writer(out);
+    out.write(kCacheMagic, sizeof(kCacheMagic));
+    writer.put<uint32_t>(kCacheVersion);
+    writer.putString(inner_->name());
+    writer.put<uint32_t>(static_cast<uint32_t>(inner_->dimensions()));
+    writer.put<uint64_t>(cache_.size());
+    for (const auto& [key, vector] : cache_) {
+      writer.put<uint64_t>(key);
+      writer.putVector(vector);
+    }
+
+    if (!out.flush()) {
+      return std::unexpected(makeError(ErrorCode::kFileWriteError,
+                                       "Failed writing embedding cache: " + temp_path.string()));
+    }
+  }
+
+  std::filesystem::rename(temp_path, config_.cache_file, ec);
+  if (ec) {
+    return std::unexpected(makeError(ErrorCode::kFileWriteError,
+                                     "Failed to replace embedding cache: " + ec.message()));
+  }
+
+  dirty_ = false;
+  return {};
+}
+
+}  // namespace nx::index
@@ -0,0 +1,344 @@
+#include "nx/index/hnsw_index.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <queue>
+
+#include "nx/index/snapshot_io.hpp"
+
+namespace nx::index {
+
+namespace {
+
+constexpr uint32_t kFormatVersion = 1;
+
+// Level assignment is geometric; anything above this is astronomically unlikely
+constexpr size_t kMaxLevel = 16;
+
+struct Closer {
+  bool operator()(const HnswIndex::Neighbor& a, const HnswIndex::Neighbor& b) const {
+    return a.distance > b.distance;
+  }
+};
+
+struct Farther {
+  bool operator()(const HnswIndex::Neighbor& a, const HnswIndex::Neighbor& b) const {
+    return a.distance < b.distance;
+  }
+};
+
+float dot(const float* a, const float* b, size_t n) {
+  // Independent accumulators so the loop vectorizes without -ffast-math
+  float sum[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    sum[0] += a[i] * b[i];
+    sum[1] += a[i + 1] * b[i + 1];
+    sum[2] += a[i + 2] * b[i + 2];
+    sum[3] += a[i + 3] * b[i + 3];
+  }
+  for (; i < n; ++i) {
+    sum[0] += a[i] * b[i];
+  }
+  return (sum[0] + sum[1]) + (sum[2] + sum[3]);
+}
+
+uint64_t splitmix64(uint64_t& state) {
+  uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+}  // namespace
+
+HnswIndex::HnswIndex() : HnswIndex(Config{}) {}
+
+HnswIndex::HnswIndex(Config config) : config_(config), rng_state_(config.seed) {
+  config_.dimensions = std::max<size_t>(config_.dimensions, 1);
+  config_.m = std::max<size_t>(config_.m, 2);
+  config_.ef_construction = std::max(config_.ef_construction, config_.m);
+}
+
+std::span<const float> HnswIndex::vector(uint32_t node) const {
+  return {vectors_.data() + static_cast<size_t>(node) * config_.dimensions, config_.dimensions};
+}
+
+float HnswIndex::distance(std::span<const float> query, uint32_t node) const {
+  return 1.0f - dot(query.data(), vector(node).data(), config_.dimensions);
+}
+
+float HnswIndex::distance(uint32_t a, uint32_t b) const {
+  return distance(vector(a), b);
+}
+
+size_t HnswIndex::randomLevel() {
+  // Uniform in (0, 1], then the paper's geometric level with mL = 1 / ln(m)
+  double uniform = static_cast<double>((splitmix64(rng_state_) >> 11) + 1) * 0x1.0p-53;
+  double level = -std::log(uniform) / std::log(static_cast<double>(config_.m));
+  return std::min(static_cast<size_t>(level), kMaxLevel);
+}
+
+uint32_t HnswIndex::insert(std::span<const float> values) {
+  auto node = static_cast<uint32_t>(size());
+  size_t level = randomLevel();
+
+  vectors_.insert(vectors_.end(), values.begin(), values.end());
+  vectors_.resize(size_t{node + 1} * config_.dimensions, 0.0f);
+  levels_.push_back(static_cast<uint8_t>(level));
+  links_.emplace_back(level + 1);
+  deleted_.push_back(0);
+
+  if (node == 0) {
+    entry_point_ = node;
+    max_level_ = level;
+    return node;
+  }
+
+  auto query = vector(node);
+  uint32_t current = entry_point_;
+  for (size_t l = max_level_; l > level; --l) {
+    current = greedyClosest(query, current, l);
+  }
+
+  std::vector<uint32_t> entries = {current};
+  for (size_t l = std::min(level, max_level_) + 1; l-- > 0;) {
+    auto candidates = searchLayer(query, entries, config_.ef_construction, l);
+    links_[node][l] = selectNeighbors(candidates, config_.m);
+    for (uint32_t neighbor : links_[node][l]) {
+      connect(neighbor, node, l);
+    }
+
+    entries.clear();
+    for (const auto& candidate : candidates) {
+      entries.push_back(candidate.node);
+    }
+  }
+
+  if (level > max_level_) {
+    entry_point_ = node;
+    max_level_ = level;
+  }
+  return node;
+}
+
+void HnswIndex::markDeleted(uint32_t node) {
+  if (node < size() && !deleted_[node]) {
+    deleted_[node] = 1;
+    ++deleted_count_;
+  }
+}
+
+uint32_t HnswIndex::greedyClosest(std::span<const float> query, uint32_t entry, size_t level) const {
+  uint32_t current = entry;
+  float best = distance(query, current);
+  for (bool improved = true; improved;) {
+    improved = false;
+    for (uint32_t neighbor : links_[current][level]) {
+      float d = distance(query, neighbor);
+      if (d < best) {
+        best = d;
+        current = neighbor;
+        improved = true;
+      }
+    }
+  }
+  return current;
+}
+
+HnswIndex::Candidates HnswIndex::searchLayer(std::span<const float> query,
+                                             const std::vector<uint32_t>& entries, size_t ef,
+                                             size_t level) const {
+  std::vector<uint8_t> visited(size(), 0);
+  std::priority_queue<Neighbor, std::vector<Neighbor>, Closer> frontier;
+  std::priority_queue<Neighbor, std::vector<Neighbor>, Farther> nearest;
+
+  for (uint32_t entry : entries) {
+    if (!visited[entry]) {
+      visited[entry] = 1;
+      Neighbor start{entry, distance(query, entry)};
+      frontier.push(start);
+      nearest.push(start);
+    }
+  }
+  while (nearest.size() > ef) {
+    nearest.pop();
+  }
+
+  while (!frontier.empty()) {
+    Neighbor closest = frontier.top();
+    if (closest.distance > nearest.top().distance && nearest.size() >= ef) {
+      break;
+    }
+    frontier.pop();
+
+    for (uint32_t neighbor : links_[closest.node][level]) {
+      if (visited[neighbor]) {
+        continue;
+      }
+      visited[neighbor] = 1;
+
+      float d = distance(query, neighbor);
+      if (nearest.size() < ef || d < nearest.top().distance) {
+        frontier.push({neighbor, d});
+        nearest.push({neighbor, d});
+        if (nearest.size() > ef) {
+          nearest.pop();
+        }
+      }
+    }
+  }
+
+  Candidates result(nearest.size());
+  for (size_t i = result.size(); i-- > 0;) {
+    result[i] = nearest.top();
+    nearest.pop();
+  }
+  return result;
+}
+
+std::vector<uint32_t> HnswIndex::selectNeighbors(Candidates candidates, size_t limit) const {
+  std::sort(candidates.begin(), candidates.end(), Farther{});
+
+  // Keep a candidate only if it is closer to the base than to any neighbour
+  // already chosen, so links spread in different directions
+  std::vector<uint32_t> selected;
+  std::vector<uint32_t> pruned;
+  for (const auto& candidate : candidates) {
+    if (selected.size() >= limit) {
+      break;
+    }
+    bool diverse = std::all_of(selected.begin(), selected.end(), [&](uint32_t chosen) {
+      return candidate.distance < distance(candidate.node, chosen);
+    });
+    (diverse ? selected : pruned).push_back(candidate.node);
+  }
+
+  // Fill up with the nearest pruned candidates so clustered data stays connected
+  for (size_t i = 0; i < pruned.size() && selected.size() < limit; ++i) {
+    selected.push_back(pruned[i]);
+  }
+  return selected;
+}
+
+void HnswIndex::connect(uint32_t node, uint32_t neighbor, size_t level) {
+  auto& links = links_[node][level];
+  links.push_back(neighbor);
+  if (links.size() <= maxLinks(level)) {
+    return;
+  }
+
+  Candidates candidates;
+  candidates.reserve(links.size());
+  for (uint32_t link : links) {
+    candidates.push_back({link, distance(node, link)});
+  }
+  links = selectNeighbors(std::move(candidates), maxLinks(level));
+}
+
+std::vector<HnswIndex::Neighbor> HnswIndex::search(std::span<const float> query, size_t k,
+                                                   size_t ef) const {
+  std::vector<Neighbor> results;
+  if (k == 0 || size() == deleted_count_ || query.size() != config_.dimensions) {
+    return results;
+  }
+
+  uint32_t current = entry_point_;
+  for (size_t l = max_level_; l > 0; --l) {
+    current = greedyClosest(query, current, l);
+  }
+
+  // Deleted nodes take up beam slots, so widen the beam until k live ones turn up
+  for (ef = std::max(ef > 0 ? ef : config_.ef_search, k);; ef *= 2) {
+    results.clear();
+    for (const auto& candidate : searchLayer(query, {current}, ef, 0)) {
+      if (!deleted_[candidate.node]) {
+        results.push_back(candidate);
+        if (results.size() == k) {
+          break;
+        }
+      }
+    }
+    if (results.size() == k || ef >= size()) {
+      break;
+    }
+  }
+  return results;
+}
+
+void HnswIndex::save(std::ostream& out) const {
+  SnapshotWriter writer(out);
+  writer.put<uint32_t>(kFormatVersion);
+  writer.put<uint64_t>(config_.dimensions);
+  writer.put<uint64_t>(config_.m);
+  writer.put<uint64_t>(config_.ef_construction);
+  writer.put<uint64_t>(config_.ef_search);
+  writer.put<uint64_t>(rng_state_);
+  writer.put<uint32_t>(entry_point_);
+  writer.put<uint32_t>(static_cast<uint32_t>(max_level_));
+
+  writer.putVector(levels_);
+  writer.putVector(deleted_);
+  writer.putVector(vectors_);
+  for (const auto& node_links : links_) {
+    for (const auto& links : node_links) {
+      writer.putVector(links);
+    }
+  }
+}
+
+Result<HnswIndex> HnswIndex::load(std::istream& in) {
+  SnapshotReader reader(in);
+  if (reader.get<uint32_t>() != kFormatVersion) {
+    return std::unexpected(makeError(ErrorCode::kIndexError, "Unrecognized vector index format"));
+  }
+
+  Config config;
+  config.dimensions = reader.get<uint64_t>();
+  config.m = reader.get<uint64_t>();
+  config.ef_construction = reader.get<uint64_t>();
+  config.ef_search = reader.get<uint64_t>();
+  HnswIndex index(config);
+  index.rng_state_ = reader.get<uint64_t>();
+  index.entry_point_ = reader.get<uint32_t>();
+  index.max_level_ = reader.get<uint32_t>();
+
+  auto corrupt = []() {
+    return std::unexpected(makeError(ErrorCode::kIndexError, "Corrupt vector index"));
+  };
+
+  index.levels_ = reader.getVector<uint8_t>();
+  index.deleted_ = reader.getVector<uint8_t>();
+  index.vectors_ = reader.getVector<float>();
+  const size_t count = index.levels_.size();
+  if (!reader.ok() || config.dimensions == 0 || index.deleted_.size() != count ||
+      index.vectors_.size() != count * config.dimensions || index.max_level_ > kMaxLevel ||
+      (count > 0 && (index.entry_point_ >= count || index.levels_[index.entry_point_] != index.max_level_))) {
+    return corrupt();
+  }
+
+  index.links_.resize(count);
+  for (size_t node = 0; node < count && reader.ok(); ++node) {
+    if (index.levels_[node] > index.max_level_) {
+      return corrupt();
+    }
+    index.links_[node].resize(index.levels_[node] + size_t{1});
+    for (size_t level = 0; level < index.links_[node].size(); ++level) {
+      auto& links = index.links_[node][level];
+      links = reader.getVector<uint32_t>();
+      // A link must point at a node that exists on the same layer
+      if (std::any_of(links.begin(), links.end(), [&](uint32_t link) {
+            return link >= count || index.levels_[link] < level;
+          })) {
+        return corrupt();
+      }
+    }
+    index.deleted_count_ += index.deleted_[node] != 0;
+  }
+  if (!reader.ok()) {
+    return corrupt();
+  }
+  return index;
+}
+
+}  // namespace nx::index
@@ -1,9 +1,54 @@
 #include "nx/index/index.hpp"
 #include "nx/index/sqlite_index.hpp"
 #include "nx/index/ripgrep_index.hpp"
+#include "nx/index/memory_index.hpp"
 
 namespace nx::index {
 
+Result<size_t> Index::searchEach(const SearchQuery& query, const SearchVisitor& visit) {
+  auto results = search(query);
+  if (!results.has_value()) {
+    return std::unexpected(results.error());
+  }
+  size_t visited = 0;
+  for (const auto& result : *results) {
+    ++visited;
+    if (!visit(result)) {
+      break;
+    }
+  }
+  return visited;
+}
+
+Result<IndexAggregates> Index::aggregate(const AggregateQuery& /*query*/) {
+  return std::unexpected(makeError(ErrorCode::kNotImplemented,
+                                   "Aggregation is not supported by this index backend"));
+}
+
+Result<SearchExplain> Index::explainSearch(const SearchQuery& /*query*/) {
+  return std::unexpected(makeError(ErrorCode::kNotImplemented,
+                                   "Query explain is not supported by this index backend"));
+}
+
+uint64_t Index::changeCounter() {
+  return 0;
+}
+
+Result<void> Index::savepoint() {
+  return std::unexpected(makeError(ErrorCode::kNotImplemented,
+                                   "Savepoints are not supported by this index backend"));
+}
+
+Result<void> Index::releaseSavepoint() {
+  return std::unexpected(makeError(ErrorCode::kNotImplemented,
+                                   "Savepoints are not supported by this index backend"));
+}
+
+Result<void> Index::rollbackToSavepoint() {
+  return std::unexpected(makeError(ErrorCode::kNotImplemented,
+                                   "Savepoints are not supported by this index backend"));
+}
+
 std::unique_ptr<Index> IndexFactory::createSqliteIndex(const std::filesystem::path& db_path) {
   return std::make_unique<SqliteIndex>(db_path);
 }
@@ -12,4 +57,10 @@ std::unique_ptr<Index> IndexFactory::createRipgrepIndex(const std::filesystem::p
   return std::make_unique<RipgrepIndex>(notes_dir);
 }
 
+std::unique_ptr<Index> IndexFactory::createMemoryIndex(const std::filesystem::path& snapshot_file) {
+  MemoryIndex::Config config;
+  config.snapshot_file = snapshot_file;
+  return std::make_unique<MemoryIndex>(std::move(config));
+}
+
 }  // namespace nx::index
\ No newline at end of file
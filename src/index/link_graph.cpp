@@ -0,0 +1,703 @@
+#include "nx/index/link_graph.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <deque>
+#include <fstream>
+#include <limits>
+#include <optional>
+#include <unordered_set>
+
+#include "nx/index/snapshot_io.hpp"
+#include "nx/index/text_features.hpp"
+
+namespace nx::index {
+
+namespace {
+
+constexpr char kSnapshotMagic[8] = {'N', 'X', 'L', 'N', 'K', 'G', '\0', '\0'};
+constexpr uint32_t kSnapshotVersion = 1;
+
+constexpr uint32_t kNoNode = std::numeric_limits<uint32_t>::max();
+constexpr size_t kUlidLength = 26;
+constexpr std::string_view kWikiPrefix = "[[";
+
+std::string trimmedLower(std::string_view text) {
+  size_t begin = 0;
+  size_t end = text.size();
+  while (begin < end && std::isspace(static_cast<unsigned char>(text[begin]))) {
+    ++begin;
+  }
+  while (end > begin && std::isspace(static_cast<unsigned char>(text[end - 1]))) {
+    --end;
+  }
+  std::string result(text.substr(begin, end - begin));
+  std::transform(result.begin(), result.end(), result.begin(),
+                 [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+  return result;
+}
+
+// Canonical ID if text starts with a ULID that ends there or at a '-' / '.' (slug or extension)
+std::optional<std::string> leadingUlid(std::string_view text) {
+  if (text.size() < kUlidLength) {
+    return std::nullopt;
+  }
+  if (text.size() > kUlidLength && text[kUlidLength] != '-' && text[kUlidLength] != '.') {
+    return std::nullopt;
+  }
+  auto id = nx::core::NoteId::fromString(text.substr(0, kUlidLength));
+  if (!id.has_value()) {
+    return std::nullopt;
+  }
+  return id->toString();
+}
+
+// Link targets as written: ULIDs from [text](ULID...) and front matter, "[[title" for wiki-links
+std::vector<std::string> linkTargets(const nx::core::Note& note) {
+  std::vector<std::string> targets;
+  for (const auto& link : note.metadata().links()) {
+    targets.push_back(link.toString());
+  }
+
+  std::string_view content = note.content();
+  for (size_t pos = content.find("]("); pos != std::string_view::npos; pos = content.find("](", pos + 2)) {
+    size_t close = content.find(')', pos + 2);
+    if (close == std::string_view::npos) {
+      break;
+    }
+    if (auto id = leadingUlid(content.substr(pos + 2, close - pos - 2))) {
+      targets.push_back(std::move(*id));
+    }
+  }
+
+  for (size_t pos = content.find(kWikiPrefix); pos != std::string_view::npos;
+       pos = content.find(kWikiPrefix, pos + 2)) {
+    size_t close = content.find("]]", pos + 2);
+    if (close == std::string_view::npos) {
+      break;
+    }
+    auto inner = content.substr(pos + 2, close - pos - 2);
+    // [[target|alias]] and [[target#heading]] both link to target
+    inner = inner.substr(0, inner.find_first_of("|#"));
+    if (inner.empty() || inner.find('\n') != std::string_view::npos) {
+      continue;
+    }
+    if (auto id = leadingUlid(inner)) {
+      targets.push_back(std::move(*id));
+    } else {
+      targets.push_back(std::string(kWikiPrefix) + trimmedLower(inner));
+    }
+    pos = close;
+  }
+
+  std::sort(targets.begin(), targets.end());
+  targets.erase(std::unique(targets.begin(), targets.end()), targets.end());
+  return targets;
+}
+
+uint64_t noteVersion(const nx::core::Note& note) {
+  std::string stamp = note.content();
+  for (const auto& link : note.metadata().links()) {
+    stamp += '\n';
+    stamp += link.toString();
+  }
+  return contentHash(stamp);
+}
+
+}  // namespace
+
+LinkGraph::LinkGraph() : LinkGraph(Config{}) {}
+
+LinkGraph::LinkGraph(Config config) : config_(std::move(config)) {}
+
+LinkGraph::~LinkGraph() {
+  if (dirty_) {
+    (void)save();
+  }
+}
+
+void LinkGraph::putLocked(const nx::core::Note& note, uint64_t version) {
+  auto& entry = notes_[note.id().toString()];
+  entry.title_key = trimmedLower(note.title());
+  entry.version = version;
+  entry.targets = linkTargets(note);
+  dirty_ = true;
+  stale_ = true;
+}
+
+size_t LinkGraph::sync(const std::vector<nx::core::Note>& notes) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  std::unordered_set<std::string> present;
+  size_t parsed = 0;
+  for (const auto& note : notes) {
+    auto key = note.id().toString();
+    present.insert(key);
+
+    uint64_t version = noteVersion(note);
+    auto it = notes_.find(key);
+    if (it != notes_.end() && it->second.version == version) {
+      continue;
+    }
+    putLocked(note, version);
+    ++parsed;
+  }
+
+  for (auto it = notes_.begin(); it != notes_.end();) {
+    if (present.contains(it->first)) {
+      ++it;
+    } else {
+      it = notes_.erase(it);
+      dirty_ = true;
+      stale_ = true;
+    }
+  }
+  return parsed;
+}
+
+Result<size_t> LinkGraph::refresh(const NoteManifest& manifest, const NoteLoader& loader) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  std::unordered_map<std::string, uint64_t> versions;
+  std::vector<nx::core::NoteId> stale;
+  for (const auto& [path_key, entry] : manifest.entries()) {
+    auto key = entry.id.toString();
+    uint64_t version = entry.fileVersion();
+    versions[key] = version;
+
+    auto it = notes_.find(key);
+    if (it == notes_.end() || it->second.version != version) {
+      stale.push_back(entry.id);
+    }
+  }
+
+  for (auto it = notes_.begin(); it != notes_.end();) {
+    if (versions.contains(it->first)) {
+      ++it;
+    } else {
+      it = notes_.erase(it);
+      dirty_ = true;
+      stale_ = true;
+    }
+  }
+
+  if (stale.empty()) {
+    return size_t{0};
+  }
+  auto notes = loader(stale);
+  if (!notes.has_value()) {
+    return std::unexpected(notes.error());
+  }
+  for (const auto& note : *notes) {
+    auto version = versions.find(note.id().toString());
+    if (version != versions.end()) {
+      putLocked(note, version->second);
+    }
+  }
+  return notes->size();
+}
+
+void LinkGraph::upsert(const nx::core::Note& note) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  putLocked(note, noteVersion(note));
+}
+
+void LinkGraph::remove(const nx::core::NoteId& id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (notes_.erase(id.toString()) > 0) {
+    dirty_ = true;
+    stale_ = true;
+  }
+}
+
+void LinkGraph::ensureBuiltLocked() const {
+  if (!stale_) {
+    return;
+  }
+
+  node_ids_.clear();
+  node_numbers_.clear();
+  node_ids_.reserve(notes_.size());
+  std::unordered_map<std::string, uint32_t> by_title;
+  for (const auto& [key, entry] : notes_) {
+    auto node = static_cast<uint32_t>(node_ids_.size());
+    node_ids_.push_back(key);
+    node_numbers_.emplace(key, node);
+    // On a title clash the oldest note (lowest ULID) wins
+    by_title.emplace(entry.title_key, node);
+  }
+
+  size_t node_count = node_ids_.size();
+  out_offsets_.assign(node_count + 1, 0);
+  out_targets_.clear();
+  unresolved_ = 0;
+
+  uint32_t source = 0;
+  std::vector<uint32_t> row;
+  for (const auto& [key, entry] : notes_) {
+    row.clear();
+    for (const auto& target : entry.targets) {
+      uint32_t node = kNoNode;
+      if (target.starts_with(kWikiPrefix)) {
+        auto it = by_title.find(target.substr(kWikiPrefix.size()));
+        node = it == by_title.end() ? kNoNode : it->second;
+      } else {
+        auto it = node_numbers_.find(target);
+        node = it == node_numbers_.end() ? kNoNode : it->second;
+      }
+      if (node == kNoNode) {
+        ++unresolved_;
+      } else if (node != source) {
+        row.push_back(node);
+      }
+    }
+    // A ULID link and a wiki-link to the same note are one edge
+    std::sort(row.begin(), row.end());
+    row.erase(std::unique(row.begin(), row.end()), row.end());
+    out_targets_.insert(out_targets_.end(), row.begin(), row.end());
+    out_offsets_[++source] = static_cast<uint32_t>(out_targets_.size());
+  }
+
+  // Transpose by counting sort; sources come out in node order
+  in_offsets_.assign(node_count + 1, 0);
+  for (uint32_t target : out_targets_) {
+    ++in_offsets_[target + 1];
+  }
+  for (size_t node = 0; node < node_count; ++node) {
+    in_offsets_[node + 1] += in_offsets_[node];
+  }
+  in_sources_.assign(out_targets_.size(), 0);
+  std::vector<uint32_t> cursor(in_offsets_.begin(), in_offsets_.end() - 1);
+  for (uint32_t node = 0; node < node_count; ++node) {
+    for (uint32_t i = out_offsets_[node]; i < out_offsets_[node + 1]; ++i) {
+      in_sources_[cursor[out_targets_[i]]++] = node;
+    }
+  }
+
+  stale_ = false;
+}
+
+bool LinkGraph::nodeOf(const nx::core::NoteId& id, uint32_t& node) const {
+  ensureBuiltLocked();
+  auto it = node_numbers_.find(id.toString());
+  if (it == node_numbers_.end()) {
+    return false;
+  }
+  node = it->second;
+  return true;
+}
+
+std::vector<nx::core::NoteId> LinkGraph::idsOf(const uint32_t* begin, const uint32_t* end) const {
+  std::vector<nx::core::NoteId> ids;
+  ids.reserve(static_cast<size_t>(end - begin));
+  for (const uint32_t* node = begin; node != end; ++node) {
+    auto id = nx::core::NoteId::fromString(node_ids_[*node]);
+    if (id.has_value()) {
+      ids.push_back(*id);
+    }
+  }
+  return ids;
+}
+
+template <typename Visit>
+void LinkGraph::forEachNeighbor(uint32_t node, Direction direction, Visit&& visit) const {
+  if (direction != Direction::kIncoming) {
+    for (uint32_t i = out_offsets_[node]; i < out_offsets_[node + 1]; ++i) {
+      visit(out_targets_[i]);
+    }
+  }
+  if (direction != Direction::kOutgoing) {
+    for (uint32_t i = in_offsets_[node]; i < in_offsets_[node + 1]; ++i) {
+      visit(in_sources_[i]);
+    }
+  }
+}
+
+std::vector<nx::core::NoteId> LinkGraph::outgoing(const nx::core::NoteId& id) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  uint32_t node;
+  if (!nodeOf(id, node)) {
+    return {};
+  }
+  return idsOf(out_targets_.data() + out_offsets_[node], out_targets_.data() + out_offsets_[node + 1]);
+}
+
+std::vector<nx::core::NoteId> LinkGraph::backlinks(const nx::core::NoteId& id) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  uint32_t node;
+  if (!nodeOf(id, node)) {
+    return {};
+  }
+  return idsOf(in_sources_.data() + in_offsets_[node], in_sources_.data() + in_offsets_[node + 1]);
+}
+
+std::vector<LinkGraph::Neighbor> LinkGraph::neighborhood(const nx::core::NoteId& id, size_t hops,
+                                                         Direction direction) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<Neighbor> neighbors;
+  uint32_t start;
+  if (!nodeOf(id, start) || hops == 0) {
+    return neighbors;
+  }
+
+  // Breadth-first, one frontier per hop so results come out nearest first
+  std::vector<uint8_t> seen(node_ids_.size(), 0);
+  seen[start] = 1;
+  std::vector<uint32_t> frontier = {start};
+  std::vector<uint32_t> next;
+  for (size_t distance = 1; distance <= hops && !frontier.empty(); ++distance) {
+    next.clear();
+    for (uint32_t node : frontier) {
+      forEachNeighbor(node, direction, [&](uint32_t neighbor) {
+        if (!seen[neighbor]) {
+          seen[neighbor] = 1;
+          next.push_back(neighbor);
+        }
+      });
+    }
+    std::sort(next.begin(), next.end());
+    for (auto& id_at : idsOf(next.data(), next.data() + next.size())) {
+      neighbors.push_back(Neighbor{std::move(id_at), distance});
+    }
+    frontier.swap(next);
+  }
+  return neighbors;
+}
+
+std::vector<nx::core::NoteId> LinkGraph::shortestPath(const nx::core::NoteId& from, const nx::core::NoteId& to,
+                                                      Direction direction) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  uint32_t source;
+  uint32_t target;
+  if (!nodeOf(from, source) || !nodeOf(to, target)) {
+    return {};
+  }
+
+  std::vector<uint32_t> parent(node_ids_.size(), kNoNode);
+  parent[source] = source;
+  std::deque<uint32_t> queue = {source};
+  while (!queue.empty() && parent[target] == kNoNode) {
+    uint32_t node = queue.front();
+    queue.pop_front();
+    forEachNeighbor(node, direction, [&](uint32_t neighbor) {
+      if (parent[neighbor] == kNoNode) {
+        parent[neighbor] = node;
+        queue.push_back(neighbor);
+      }
+    });
+  }
+  if (parent[target] == kNoNode) {
+    return {};
+  }
+
+  std::vector<uint32_t> path = {target};
+  while (path.back() != source) {
+    path.push_back(parent[path.back()]);
+  }
+  std::reverse(path.begin(), path.end());
+  return idsOf(path.data(), path.data() + path.size());
+}
+
+std::vector<std::vector<nx::core::NoteId>> LinkGraph::components(size_t min_size) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  ensureBuiltLocked();
+
+  std::vector<std::vector<uint32_t>> groups;
+  std::vector<uint8_t> seen(node_ids_.size(), 0);
+  std::vector<uint32_t> stack;
+  for (uint32_t start = 0; start < node_ids_.size(); ++start) {
+    if (seen[start]) {
+      continue;
+    }
+    std::vector<uint32_t> members;
+    seen[start] = 1;
+    stack.push_back(start);
+    while (!stack.empty()) {
+      uint32_t node = stack.back();
+      stack.pop_back();
+      members.push_back(node);
+      forEachNeighbor(node, Direction::kBoth, [&](uint32_t neighbor) {
+        if (!seen[neighbor]) {
+          seen[neighbor] = 1;
+          stack.push_back(neighbor);
+        }
+      });
+    }
+    if (members.size() >= min_size) {
+      std::sort(members.begin(), members.end());
+      groups.push_back(std::move(members));
+    }
+  }
+
+  std::stable_sort(groups.begin(), groups.end(),
+                   [](const auto& a, const auto& b) { return a.size() > b.size(); });
+  std::vector<std::vector<nx::core::NoteId>> result;
+  result.reserve(groups.size());
+  for (const auto& members : groups) {
+    result.push_back(idsOf(members.data(), members.data() + members.size()));
+  }
+  return result;
+}
+
+std::vector<LinkGraph::Ranked> LinkGraph::centrality(size_t k, size_t iterations, double damping) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  ensureBuiltLocked();
+
+  size_t node_count = node_ids_.size();
+  std::vector<Ranked> ranked;
+  if (node_count == 0 || k == 0) {
+    return ranked;
+  }
+
+  auto n = static_cast<double>(node_count);
+  std::vector<double> rank(node_count, 1.0 / n);
+  std::vector<double> next(node_count);
+  for (size_t iteration = 0; iteration < iterations; ++iteration) {
+    // Notes without outgoing links spread their rank over every note
+    double dangling = 0.0;
+    for (uint32_t node = 0; node < node_count; ++node) {
+      if (out_offsets_[node] == out_offsets_[node + 1]) {
+        dangling += rank[node];
+      }
+    }
+
+    double base = (1.0 - damping) / n + damping * dangling / n;
+    double delta = 0.0;
+    for (uint32_t node = 0; node < node_count; ++node) {
+      double incoming = 0.0;
+      for (uint32_t i = in_offsets_[node]; i < in_offsets_[node + 1]; ++i) {
+        uint32_t source = in_sources_[i];
+        incoming += rank[source] / static_cast<double>(out_offsets_[source + 1] - out_offsets_[source]);
+      }
+      next[node] = base + damping * incoming;
+      delta += std::abs(next[node] - rank[node]);
+    }
+    rank.swap(next);
+    if (delta < 1e-9) {
+      break;
+    }
+  }
+
+  std::vector<uint32_t> order(node_count);
+  for (uint32_t node = 0; node < node_count; ++node) {
+    order[node] = node;
+  }
+  size_t top = std::min(k, node_count);
+  std::partial_sort(order.begin(), order.begin() + static_cast<std::ptrdiff_t>(top), order.end(),
+                    [&rank](uint32_t a, uint32_t b) { return rank[a] != rank[b] ? rank[a] > rank[b] : a < b; });
+  for (size_t i = 0; i < top; ++i) {
+    auto id = nx::core::NoteId::fromString(node_ids_[order[i]]);
+    if (id.has_value()) {
+      ranked.push_back(Ranked{*id, rank[order[i]]});
+    }
+  }
+  return ranked;
+}
+
+size_t LinkGraph::countComponentsLocked() const {
+  // Union-find over the edge list
+  std::vector<uint32_t> parent(node_ids_.size());
+  for (uint32_t node = 0; node < parent.size(); ++node) {
+    parent[node] = node;
+  }
+  auto find = [&parent](uint32_t node) {
+    while (parent[node] != node) {
+      parent[node] = parent[parent[node]];
+      node = parent[node];
+    }
+    return node;
+  };
+
+  size_t count = node_ids_.size();
+  for (uint32_t source = 0; source < node_ids_.size(); ++source) {
+    for (uint32_t i = out_offsets_[source]; i < out_offsets_[source + 1]; ++i) {
+      uint32_t a = find(source);
+      uint32_t b = find(out_targets_[i]);
+      if (a != b) {
+        parent[std::max(a, b)] = std::min(a, b);
+        --count;
+      }
+    }
+  }
+  return count;
+}
+
+LinkGraph::Stats LinkGraph::stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  ensureBuiltLocked();
+
+  Stats stats;
+  stats.notes = node_ids_.size();
+  stats.links = out_targets_.size();
+  stats.unresolved_links = unresolved_;
+  stats.components = countComponentsLocked();
+  for (uint32_t node = 0; node < node_ids_.size(); ++node) {
+    if (out_offsets_[node] == out_offsets_[node + 1] && in_offsets_[node] == in_offsets_[node + 1]) {
+      ++stats.isolated;
+    }
+  }
+  return stats;
+}
+
+bool LinkGraph::contains(const nx::core::NoteId& id) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return notes_.contains(id.toString());
+}
+
+size_t LinkGraph::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return notes_.size();
+}
+
+Result<std::unique_ptr<LinkGraph>> LinkGraph::openForNotes(const std::filesystem::path& notes_dir,
+                                                           const std::filesystem::path& cache_dir,
+                                                           const NoteLoader& loader) {
+  NoteManifest manifest(notes_dir, cache_dir / "graph_manifest.json");
+  auto refreshed = manifest.refresh();
+  if (!refreshed.has_value()) {
+    return std::unexpected(refreshed.error());
+  }
+
+  Config config;
+  config.snapshot_file = cache_dir / "links.graph";
+  auto graph = std::make_unique<LinkGraph>(config);
+  (void)graph->load();  // A missing or damaged snapshot only means parsing again
+
+  auto updated = graph->refresh(manifest, loader);
+  if (!updated.has_value()) {
+    return std::unexpected(updated.error());
+  }
+  auto saved = graph->save();
+  if (!saved.has_value()) {
+    return std::unexpected(saved.error());
+  }
+  return graph;
+}
+
+Result<void> LinkGraph::load() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  notes_.clear();
+  stale_ = true;
+  dirty_ = false;
+  if (config_.snapshot_file.empty() || !std::filesystem::exists(config_.snapshot_file)) {
+    return {};
+  }
+
+  std::ifstream in(config_.snapshot_file, std::ios::binary);
+  if (!in) {
+    return std::unexpected(makeError(ErrorCode::kFileReadError,
+                                     "Cannot open link graph: " + config_.snapshot_file.string()));
+  }
+
+  SnapshotReader reader(in);
+  char magic[sizeof(kSnapshotMagic)];
+  in.read(magic, sizeof(magic));
+  if (!in || !std::equal(std::begin(magic), std::end(magic), std::begin(kSnapshotMagic)) ||
+      reader.get<uint32_t>() != kSnapshotVersion) {
+    return std::unexpected(makeError(ErrorCode::kIndexError, "Unrecognized link graph format"));
+  }
+
+  auto corrupt = [this]() -> Result<void> {
+    notes_.clear();
+    stale_ = true;
+    return std::unexpected(makeError(ErrorCode::kIndexError, "Corrupt link graph"));
+  };
+
+  auto count = reader.get<uint64_t>();
+  for (uint64_t i = 0; i < count && reader.ok(); ++i) {
+    auto key = reader.getString();
+    auto& entry = notes_[key];
+    entry.title_key = reader.getString();
+    entry.version = reader.get<uint64_t>();
+    auto targets = reader.get<uint64_t>();
+    for (uint64_t t = 0; t < targets && reader.ok(); ++t) {
+      entry.targets.push_back(reader.getString());
+    }
+  }
+
+  // The adjacency arrays were saved alongside, so queries need no rebuild
+  out_offsets_ = reader.getVector<uint32_t>();
+  out_targets_ = reader.getVector<uint32_t>();
+  in_offsets_ = reader.getVector<uint32_t>();
+  in_sources_ = reader.getVector<uint32_t>();
+  unresolved_ = reader.get<uint64_t>();
+  if (!reader.ok() || out_offsets_.size() != notes_.size() + 1 || in_offsets_.size() != notes_.size() + 1 ||
+      out_offsets_.back() != out_targets_.size() || in_offsets_.back() != in_sources_.size() ||
+      out_targets_.size() != in_sources_.size()) {
+    return corrupt();
+  }
+  for (uint32_t node : out_targets_) {
+    if (node >= notes_.size()) {
+      return corrupt();
+    }
+  }
+
+  node_ids_.clear();
+  node_numbers_.clear();
+  for (const auto& [key, entry] : notes_) {
+    node_numbers_.emplace(key, static_cast<uint32_t>(node_ids_.size()));
+    node_ids_.push_back(key);
+  }
+  stale_ = false;
+  return {};
+}
+
+Result<void> LinkGraph::save() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!dirty_ || config_.snapshot_file.empty()) {
+    dirty_ = false;
+    return {};
+  }
+  ensureBuiltLocked();
+
+  std::error_code ec;
+  std::filesystem::create_directories(config_.snapshot_file.parent_path(), ec);
+
+  // Write beside the target and rename, so readers never see a partial file
+  auto temp_path = config_.snapshot_file;
+  temp_path += ".tmp";
+  {
+    std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+      return std::unexpected(makeError(ErrorCode::kFileWriteError,
+                                       "Cannot write link graph: " + temp_path.string()));
+    }
+
+    SnapshotWriter writer(out);
+    out.write(kSnapshotMagic, sizeof(kSnapshotMagic));
+    writer.put<uint32_t>(kSnapshotVersion);
+
+    writer.put<uint64_t>(notes_.size());
+    for (const auto& [key, entry] : notes_) {
+      writer.putString(key);
+      writer.putString(entry.title_key);
+      writer.put<uint64_t>(entry.version);
+      writer.put<uint64_t>(entry.targets.size());
+      for (const auto& target : entry.targets) {
+        writer.putString(target);
+      }
+    }
+    writer.putVector(out_offsets_);
+    writer.putVector(out_targets_);
+    writer.putVector(in_offsets_);
+    writer.putVector(in_sources_);
+    writer.put<uint64_t>(unresolved_);
+
+    if (!out.flush()) {
+      return std::unexpected(makeError(ErrorCode::kFileWriteError,
+                                       "Failed writing link graph: " + temp_path.string()));
+    }
+  }
+
+  std::filesystem::rename(temp_path, config_.snapshot_file, ec);
+  if (ec) {
+    return std::unexpected(makeError(ErrorCode::kFileWriteError,
+                                     "Failed to replace link graph: " + ec.message()));
+  }
+
+  dirty_ = false;
+  return {};
+}
+
+}  // namespace nx::index
@@ -0,0 +1,1455 @@
+#include "nx/index/memory_index.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <queue>
+#include <set>
+#include <type_traits>
+
+#include "nx/index/snapshot_io.hpp"
+#include "nx/index/trigram_query.hpp"
+#include "nx/util/timing.hpp"
+
+namespace nx::index {
+
+namespace {
+
+// BM25 parameters (same defaults as FTS5's bm25())
+constexpr double kK1 = 1.2;
+constexpr double kB = 0.75;
+
+// A title occurrence counts as this many body occurrences
+constexpr uint32_t kTitleWeight = 2;
+
+constexpr size_t kSnippetLength = 200;
+constexpr size_t kSnippetLeadIn = 60;
+
+constexpr char kSnapshotMagic[8] = {'N', 'X', 'B', 'M', '2', '5', '\0', '\0'};
+constexpr uint32_t kSnapshotVersion = 2;
+
+static_assert(std::is_trivially_copyable_v<PostingList::Block> && sizeof(PostingList::Block) == 16,
+              "snapshots store posting blocks verbatim");
+
+bool isWordChar(char c) {
+  auto uc = static_cast<unsigned char>(c);
+  return std::isalnum(uc) || c == '_' || uc >= 0x80;
+}
+
+char asciiLower(char c) {
+  return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+// Calls visit(token, begin, end) for each word; tokens are ASCII lower-cased
+template <typename Visitor>
+void forEachToken(std::string_view text, Visitor&& visit) {
+  size_t i = 0;
+  std::string token;
+  while (i < text.size()) {
+    while (i < text.size() && !isWordChar(text[i])) {
+      ++i;
+    }
+    size_t begin = i;
+    token.clear();
+    while (i < text.size() && isWordChar(text[i])) {
+      token += asciiLower(text[i]);
+      ++i;
+    }
+    if (!token.empty()) {
+      visit(token, begin, i);
+    }
+  }
+}
+
+std::vector<std::string> tokenize(std::string_view text) {
+  std::vector<std::string> tokens;
+  forEachToken(text, [&](const std::string& token, size_t, size_t) { tokens.push_back(token); });
+  return tokens;
+}
+
+struct QueryTerm {
+  std::vector<std::string> tokens;  // More than one is a phrase
+  bool prefix = false;              // Last token matches as a prefix
+};
+
+int64_t toMillis(std::chrono::system_clock::time_point time) {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(time.time_since_epoch()).count();
+}
+
+std::chrono::system_clock::time_point fromMillis(int64_t millis) {
+  return std::chrono::system_clock::time_point(std::chrono::milliseconds(millis));
+}
+
+// Word leaves that count towards a match (not under a NOT), for ranking and highlights
+void collectPositiveText(const QueryExpr& expr, std::vector<const QueryExpr*>& leaves) {
+  if (expr.kind == QueryExpr::Kind::kText) {
+    leaves.push_back(&expr);
+  } else if (expr.kind != QueryExpr::Kind::kNot) {
+    for (const auto& child : expr.children) {
+      collectPositiveText(child, leaves);
+    }
+  }
+}
+
+}  // namespace
+
+struct MemoryIndex::Clause {
+  std::vector<QueryTerm> required;
+  std::vector<QueryTerm> excluded;
+};
+
+namespace {
+
+// Splits FTS5-style query text into OR'ed clauses of AND'ed terms
+std::vector<std::vector<QueryTerm>> parseTerms(const std::string& text, bool prefix_last_term,
+                                               std::vector<std::vector<QueryTerm>>& excluded) {
+  std::vector<std::vector<QueryTerm>> clauses(1);
+  excluded.assign(1, {});
+
+  if (prefix_last_term) {
+    // Search-as-you-type: plain words only, the last one still being typed
+    for (auto& token : tokenize(text)) {
+      clauses[0].push_back({{std::move(token)}, false});
+    }
+    if (!clauses[0].empty() && !text.empty() && isWordChar(text.back())) {
+      clauses[0].back().prefix = true;
+    }
+    return clauses;
+  }
+
+  bool negate = false;
+  size_t i = 0;
+  while (i < text.size()) {
+    char c = text[i];
+    if (std::isspace(static_cast<unsigned char>(c)) || c == '(' || c == ')' || c == '+') {
+      ++i;
+      continue;
+    }
+    if (c == '-') {
+      negate = true;
+      ++i;
+      continue;
+    }
+
+    QueryTerm term;
+    if (c == '"') {
+      size_t close = text.find('"', i + 1);
+      size_t end = close == std::string::npos ? text.size() : close;
+      term.tokens = tokenize(std::string_view(text).substr(i + 1, end - i - 1));
+      i = close == std::string::npos ? text.size() : close + 1;
+      if (i < text.size() && text[i] == '*') {
+        term.prefix = true;
+        ++i;
+      }
+    } else {
+      size_t end = i;
+      while (end < text.size() && !std::isspace(static_cast<unsigned char>(text[end])) &&
+             text[end] != '"' && text[end] != '(' && text[end] != ')') {
+        ++end;
+      }
+      std::string word = text.substr(i, end - i);
+      i = end;
+
+      if (word == "OR") {
+        if (!clauses.back().empty() || !excluded.back().empty()) {
+          clauses.emplace_back();
+          excluded.emplace_back();
+        }
+        negate = false;
+        continue;
+      }
+      if (word == "AND" || word == "NEAR") {
+        continue;
+      }
+      if (word == "NOT") {
+        negate = true;
+        continue;
+      }
+
+      // Column filters ("title:word") search every column here
+      if (auto colon = word.find(':'); colon != std::string::npos) {
+        word = word.substr(colon + 1);
+      }
+      if (!word.empty() && word.back() == '*') {
+        term.prefix = true;
+        word.pop_back();
+      }
+      term.tokens = tokenize(word);
+    }
+
+    if (!term.tokens.empty()) {
+      (negate ? excluded.back() : clauses.back()).push_back(std::move(term));
+    }
+    negate = false;
+  }
+
+  return clauses;
+}
+
+}  // namespace
+
+MemoryIndex::MemoryIndex() : MemoryIndex(Config{}) {
+}
+
+MemoryIndex::MemoryIndex(Config config) : config_(std::move(config)) {
+}
+
+MemoryIndex::~MemoryIndex() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (dirty_) {
+    writeSnapshot();
+  }
+}
+
+Result<void> MemoryIndex::initialize() {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  if (!config_.snapshot_file.empty() && std::filesystem::exists(config_.snapshot_file)) {
+    if (loadSnapshot().has_value()) {
+      return {};
+    }
+    // Unreadable or from another version: rebuild from the notes instead
+    clearAll();
+  }
+
+  if (config_.note_source) {
+    auto notes = config_.note_source();
+    if (!notes.has_value()) {
+      return std::unexpected(notes.error());
+    }
+    for (const auto& note : *notes) {
+      indexNote(note);
+    }
+    dirty_ = true;
+    last_optimized_ = std::chrono::system_clock::now();
+    return writeSnapshot();
+  }
+
+  return {};
+}
+
+Result<void> MemoryIndex::addNote(const nx::core::Note& note) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  // Re-adding replaces, matching INSERT OR REPLACE in the SQLite backend
+  markDeleted(note.id());
+  indexNote(note);
+  return {};
+}
+
+Result<void> MemoryIndex::updateNote(const nx::core::Note& note) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  markDeleted(note.id());
+  indexNote(note);
+  return {};
+}
+
+Result<void> MemoryIndex::removeNote(const nx::core::NoteId& id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  markDeleted(id);
+  return {};
+}
+
+Result<void> MemoryIndex::rebuild() {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  if (config_.note_source) {
+    auto notes = config_.note_source();
+    if (!notes.has_value()) {
+      return std::unexpected(notes.error());
+    }
+    clearAll();
+    for (const auto& note : *notes) {
+      indexNote(note);
+    }
+  } else {
+    compact();
+  }
+
+  dirty_ = true;
+  last_optimized_ = std::chrono::system_clock::now();
+  return in_transaction_ ? Result<void>{} : writeSnapshot();
+}
+
+Result<void> MemoryIndex::optimize() {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  compact();
+  last_optimized_ = std::chrono::system_clock::now();
+  return in_transaction_ ? Result<void>{} : writeSnapshot();
+}
+
+Result<void> MemoryIndex::vacuum() {
+  return optimize();
+}
+
+Result<std::vector<SearchResult>> MemoryIndex::search(const SearchQuery& query) {
+  nx::util::ScopedTimer timer("index.search");
+  timer.arg("query", query.text);
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  if (query.limit == 0) {
+    return std::vector<SearchResult>{};
+  }
+
+  std::vector<std::string> highlight_terms;
+  auto matches = evaluate(query, query.limit + query.offset, &highlight_terms);
+
+  std::vector<SearchResult> results;
+  for (size_t i = query.offset; i < matches.size(); ++i) {
+    results.push_back(toResult(matches[i], highlight_terms, query.highlight));
+  }
+  return results;
+}
+
+Result<std::vector<nx::core::NoteId>> MemoryIndex::searchIds(const SearchQuery& query) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  if (query.limit == 0) {
+    return std::vector<nx::core::NoteId>{};
+  }
+
+  auto matches = evaluate(query, query.limit + query.offset);
+
+  std::vector<nx::core::NoteId> ids;
+  for (size_t i = query.offset; i < matches.size(); ++i) {
+    ids.push_back(docs_[matches[i].doc].id);
+  }
+  return ids;
+}
+
+Result<size_t> MemoryIndex::searchCount(const SearchQuery& query) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return evaluate(query, 0).size();
+}
+
+Result<SearchPage> MemoryIndex::searchPage(const SearchQuery& query) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  // Counting needs every match anyway, so rank them all rather than run WAND
+  std::vector<std::string> highlight_terms;
+  auto matches = evaluate(query, 0, &highlight_terms);
+
+  SearchPage page;
+  page.total = matches.size();
+
+  size_t end = std::min(matches.size(), query.offset + query.limit);
+  if (query.offset < end) {
+    auto order = [&](const Match& a, const Match& b) {
+      return a.score != b.score ? a.score > b.score : a.doc < b.doc;
+    };
+    auto first = matches.begin() + static_cast<std::ptrdiff_t>(query.offset);
+    auto last = matches.begin() + static_cast<std::ptrdiff_t>(end);
+    if (!query.text.empty()) {
+      std::partial_sort(matches.begin(), last, matches.end(), order);
+    }
+    for (auto it = first; it != last; ++it) {
+      page.results.push_back(toResult(*it, highlight_terms, query.highlight));
+    }
+  }
+  return page;
+}
+
+Result<std::vector<nx::core::NoteId>> MemoryIndex::scanCandidates(const std::string& pattern,
+                                                                  bool is_regex) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  std::optional<std::vector<uint32_t>> candidates;
+  if (!pattern.empty()) {
+    if (!is_regex) {
+      candidates = literalCandidates(pattern);
+    } else if (auto literals = TrigramQuery::forRegex(pattern); literals.has_value()) {
+      // Union over alternatives of the notes holding all of an alternative's literals
+      std::vector<uint32_t> any_group;
+      bool unconstrained = false;
+      for (const auto& group : literals->groups) {
+        std::optional<std::vector<uint32_t>> in_group;
+        for (const auto& literal : group) {
+          auto docs = literalCandidates(literal);
+          if (!docs.has_value()) {
+            continue;
+          }
+          if (!in_group.has_value()) {
+            in_group = std::move(docs);
+          } else {
+            std::vector<uint32_t> both;
+            std::set_intersection(in_group->begin(), in_group->end(), docs->begin(), docs->end(),
+                                  std::back_inserter(both));
+            in_group = std::move(both);
+          }
+        }
+        if (!in_group.has_value()) {
+          unconstrained = true;
+          break;
+        }
+        std::vector<uint32_t> merged;
+        std::set_union(any_group.begin(), any_group.end(), in_group->begin(), in_group->end(),
+                       std::back_inserter(merged));
+        any_group = std::move(merged);
+      }
+      if (!unconstrained) {
+        candidates = std::move(any_group);
+      }
+    }
+  }
+
+  std::vector<nx::core::NoteId> ids;
+  if (candidates.has_value()) {
+    for (uint32_t doc : *candidates) {
+      ids.push_back(docs_[doc].id);
+    }
+  } else {
+    for (const auto& doc : docs_) {
+      if (doc.live) {
+        ids.push_back(doc.id);
+      }
+    }
+  }
+  return ids;
+}
+
+Result<std::vector<std::string>> MemoryIndex::suggestTags(const std::string& prefix, size_t limit) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  std::unordered_map<std::string, size_t> tag_counts;
+  for (const auto& doc : docs_) {
+    if (!doc.live) {
+      continue;
+    }
+    for (const auto& tag : doc.tags) {
+      if (tag.starts_with(prefix)) {
+        tag_counts[tag]++;
+      }
+    }
+  }
+
+  // Most frequently used tags first, matching the SQLite backend
+  std::vector<std::pair<std::string, size_t>> ranked(tag_counts.begin(), tag_counts.end());
+  std::sort(ranked.begin(), ranked.end(), [](const auto& a, const auto& b) {
+    return a.second != b.second ? a.second > b.second : a.first < b.first;
+  });
+
+  std::vector<std::string> suggestions;
+  for (const auto& [tag, count] : ranked) {
+    if (suggestions.size() >= limit) {
+      break;
+    }
+    suggestions.push_back(tag);
+  }
+  return suggestions;
+}
+
+Result<std::vector<std::string>> MemoryIndex::suggestNotebooks(const std::string& prefix, size_t limit) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  std::set<std::string> notebooks;
+  for (const auto& doc : docs_) {
+    if (doc.live && doc.notebook.has_value() && doc.notebook->starts_with(prefix)) {
+      notebooks.insert(*doc.notebook);
+    }
+  }
+
+  std::vector<std::string> suggestions(notebooks.begin(), notebooks.end());
+  if (suggestions.size() > limit) {
+    suggestions.resize(limit);
+  }
+  return suggestions;
+}
+
+Result<std::vector<TagCount>> MemoryIndex::getTagCounts() {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  std::map<std::string, size_t> tag_counts;
+  for (const auto& doc : docs_) {
+    if (!doc.live) {
+      continue;
+    }
+    for (const auto& tag : doc.tags) {
+      tag_counts[tag]++;
+    }
+  }
+
+  std::vector<TagCount> counts;
+  counts.reserve(tag_counts.size());
+  for (const auto& [tag, count] : tag_counts) {
+    counts.push_back({tag, count});
+  }
+  return counts;
+}
+
+Result<IndexStats> MemoryIndex::getStats() {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  IndexStats stats;
+  stats.total_notes = live_docs_;
+  stats.total_words = live_length_;
+  for (const auto& [term, list] : terms_) {
+    stats.index_size_bytes += term.size() + list.bytes().size() +
+                              list.blocks().size() * sizeof(PostingList::Block);
+  }
+  stats.last_updated = last_updated_;
+  stats.last_optimized = last_optimized_;
+  return stats;
+}
+
+Result<bool> MemoryIndex::isHealthy() {
+  return true;
+}
+
+Result<void> MemoryIndex::validateIndex() {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  if (doc_numbers_.size() != live_docs_) {
+    return std::unexpected(makeError(ErrorCode::kIndexError,
+                                     "Live note count does not match the document table"));
+  }
+  for (const auto& [id, doc] : doc_numbers_) {
+    if (doc >= docs_.size() || !docs_[doc].live || docs_[doc].id.toString() != id) {
+      return std::unexpected(makeError(ErrorCode::kIndexError,
+                                       "Document table entry for " + id + " is stale"));
+    }
+  }
+  return {};
+}
+
+Result<void> MemoryIndex::beginTransaction() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  in_transaction_ = true;
+  return {};
+}
+
+Result<void> MemoryIndex::commitTransaction() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  in_transaction_ = false;
+  return dirty_ ? writeSnapshot() : Result<void>{};
+}
+
+Result<void> MemoryIndex::rollbackTransaction() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  in_transaction_ = false;
+
+  // Without a snapshot there is nothing to return to; changes stay applied
+  if (config_.snapshot_file.empty() || !std::filesystem::exists(config_.snapshot_file)) {
+    return {};
+  }
+  clearAll();
+  return loadSnapshot();
+}
+
+Result<void> MemoryIndex::saveSnapshot() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return writeSnapshot();
+}
+
+// Private methods
+
+void MemoryIndex::indexNote(const nx::core::Note& note) {
+  std::unordered_map<std::string, uint32_t> frequencies;
+  uint32_t length = 0;
+
+  forEachToken(note.title(), [&](const std::string& token, size_t, size_t) {
+    frequencies[token] += kTitleWeight;
+    length += kTitleWeight;
+  });
+  forEachToken(note.content(), [&](const std::string& token, size_t, size_t) {
+    frequencies[token]++;
+    length++;
+  });
+  for (const auto& tag : note.tags()) {
+    forEachToken(tag, [&](const std::string& token, size_t, size_t) {
+      frequencies[token]++;
+      length++;
+    });
+  }
+
+  auto doc = static_cast<uint32_t>(docs_.size());
+  for (const auto& [token, tf] : frequencies) {
+    terms_[token].append(doc, tf, length);
+  }
+
+  Document document;
+  document.id = note.id();
+  document.title = note.title();
+  document.created = note.metadata().created();
+  document.modified = note.metadata().updated();
+  document.tags = note.tags();
+  document.notebook = note.notebook();
+  document.length = length;
+  if (!config_.content_provider) {
+    document.content = note.content();
+  }
+  docs_.push_back(std::move(document));
+
+  doc_numbers_[note.id().toString()] = doc;
+  live_docs_++;
+  live_length_ += length;
+  dirty_ = true;
+  last_updated_ = std::chrono::system_clock::now();
+}
+
+void MemoryIndex::markDeleted(const nx::core::NoteId& id) {
+  auto it = doc_numbers_.find(id.toString());
+  if (it == doc_numbers_.end()) {
+    return;
+  }
+
+  Document& document = docs_[it->second];
+  document.live = false;
+  document.content.clear();
+  document.content.shrink_to_fit();
+  live_docs_--;
+  live_length_ -= document.length;
+  doc_numbers_.erase(it);
+  dirty_ = true;
+  last_updated_ = std::chrono::system_clock::now();
+}
+
+void MemoryIndex::compact() {
+  if (live_docs_ == docs_.size()) {
+    return;
+  }
+
+  // Renumbering keeps relative order, so postings stay sorted when re-appended
+  std::vector<uint32_t> renumber(docs_.size(), PostingCursor::kEnd);
+  std::vector<Document> live;
+  live.reserve(live_docs_);
+  for (size_t doc = 0; doc < docs_.size(); ++doc) {
+    if (docs_[doc].live) {
+      renumber[doc] = static_cast<uint32_t>(live.size());
+      live.push_back(std::move(docs_[doc]));
+    }
+  }
+
+  std::array<uint32_t, PostingList::kBlockSize> block_docs{};
+  std::array<uint32_t, PostingList::kBlockSize> block_tfs{};
+  for (auto it = terms_.begin(); it != terms_.end();) {
+    PostingList compacted;
+    const auto& list = it->second;
+    for (size_t block = 0; block < list.blocks().size(); ++block) {
+      size_t n = list.decodeBlock(block, block_docs.data(), block_tfs.data());
+      for (size_t i = 0; i < n; ++i) {
+        uint32_t doc = renumber[block_docs[i]];
+        if (doc != PostingCursor::kEnd) {
+          compacted.append(doc, block_tfs[i], live[doc].length);
+        }
+      }
+    }
+    if (compacted.empty()) {
+      it = terms_.erase(it);
+    } else {
+      it->second = std::move(compacted);
+      ++it;
+    }
+  }
+
+  docs_ = std::move(live);
+  doc_numbers_.clear();
+  for (size_t doc = 0; doc < docs_.size(); ++doc) {
+    doc_numbers_[docs_[doc].id.toString()] = static_cast<uint32_t>(doc);
+  }
+  dirty_ = true;
+}
+
+void MemoryIndex::clearAll() {
+  docs_.clear();
+  doc_numbers_.clear();
+  terms_.clear();
+  live_docs_ = 0;
+  live_length_ = 0;
+  dirty_ = true;
+}
+
+std::vector<MemoryIndex::Match> MemoryIndex::evaluate(const SearchQuery& query, size_t top_k,
+                                                      std::vector<std::string>* highlight_terms) const {
+  if (!query.expr.has_value()) {
+    return rank(query, top_k, highlight_terms);
+  }
+
+  // The boolean filter becomes one bitmap up front; ranking then skips documents outside it
+  auto allowed = exprDocs(*query.expr);
+  allowed_ = &allowed;
+  auto matches = rank(query, top_k, highlight_terms);
+  allowed_ = nullptr;
+
+  if (highlight_terms != nullptr) {
+    std::vector<const QueryExpr*> leaves;
+    collectPositiveText(*query.expr, leaves);
+    for (const auto* leaf : leaves) {
+      for (auto& token : tokenize(leaf->value)) {
+        highlight_terms->push_back(std::move(token));
+      }
+    }
+  }
+  return matches;
+}
+
+std::vector<MemoryIndex::Match> MemoryIndex::rank(const SearchQuery& query, size_t top_k,
+                                                  std::vector<std::string>* highlight_terms) const {
+  auto by_rank = [](const Match& a, const Match& b) {
+    return a.score != b.score ? a.score > b.score : a.doc < b.doc;
+  };
+
+  if (query.text.find_first_not_of(" \t\r\n") == std::string::npos) {
+    auto matches = metadataMatches(query);
+    if (top_k > 0 && matches.size() > top_k) {
+      matches.resize(top_k);
+    }
+    return matches;
+  }
+
+  std::vector<std::vector<QueryTerm>> excluded;
+  auto required = parseTerms(query.text, query.prefix_last_term, excluded);
+
+  std::vector<Clause> clauses;
+  for (size_t i = 0; i < required.size(); ++i) {
+    // A clause with nothing required matches nothing (FTS5 rejects it outright)
+    if (!required[i].empty()) {
+      clauses.push_back({std::move(required[i]), std::move(excluded[i])});
+    }
+  }
+
+  if (highlight_terms != nullptr) {
+    for (const auto& clause : clauses) {
+      for (const auto& term : clause.required) {
+        for (size_t i = 0; i < term.tokens.size(); ++i) {
+          bool prefix = term.prefix && i + 1 == term.tokens.size();
+          highlight_terms->push_back(term.tokens[i] + (prefix ? "*" : ""));
+        }
+      }
+    }
+  }
+
+  if (clauses.empty()) {
+    return {};
+  }
+
+  // Pure disjunction of single words: top-k by block-max WAND
+  bool single_terms = clauses.size() > 1 && std::all_of(clauses.begin(), clauses.end(), [](const Clause& c) {
+    return c.required.size() == 1 && c.required[0].tokens.size() == 1 && c.excluded.empty();
+  });
+  if (top_k > 0 && single_terms) {
+    std::deque<PostingList> storage;
+    std::vector<const PostingList*> lists;
+    for (const auto& clause : clauses) {
+      const auto& term = clause.required[0];
+      const PostingList* list = nullptr;
+      if (term.prefix) {
+        list = prefixList(term.tokens[0], storage.emplace_back());
+      } else if (auto it = terms_.find(term.tokens[0]); it != terms_.end()) {
+        list = &it->second;
+      }
+      if (list != nullptr && std::find(lists.begin(), lists.end(), list) == lists.end()) {
+        lists.push_back(list);
+      }
+    }
+    return topKDisjunction(lists, query, top_k);
+  }
+
+  // Otherwise evaluate each clause exhaustively and sum the scores of notes in several
+  std::vector<Match> matches = matchClause(clauses[0], query);
+  for (size_t i = 1; i < clauses.size(); ++i) {
+    auto more = matchClause(clauses[i], query);
+    std::vector<Match> merged;
+    merged.reserve(matches.size() + more.size());
+    size_t a = 0;
+    size_t b = 0;
+    while (a < matches.size() || b < more.size()) {
+      if (b == more.size() || (a < matches.size() && matches[a].doc < more[b].doc)) {
+        merged.push_back(matches[a++]);
+      } else if (a == matches.size() || more[b].doc < matches[a].doc) {
+        merged.push_back(more[b++]);
+      } else {
+        merged.push_back({matches[a].doc, matches[a].score + more[b].score});
+        ++a;
+        ++b;
+      }
+    }
+    matches = std::move(merged);
+  }
+
+  if (top_k > 0) {
+    size_t keep = std::min(top_k, matches.size());
+    std::partial_sort(matches.begin(), matches.begin() + static_cast<std::ptrdiff_t>(keep),
+                      matches.end(), by_rank);
+    matches.resize(keep);
+  }
+  return matches;
+}
+
+std::vector<MemoryIndex::Match> MemoryIndex::matchClause(const Clause& clause,
+                                                         const SearchQuery& query) const {
+  std::deque<PostingList> storage;
+  std::vector<const PostingList*> lists;
+  std::vector<const QueryTerm*> phrases;
+
+  for (const auto& term : clause.required) {
+    for (size_t i = 0; i < term.tokens.size(); ++i) {
+      const PostingList* list = nullptr;
+      if (term.prefix && i + 1 == term.tokens.size()) {
+        list = prefixList(term.tokens[i], storage.emplace_back());
+      } else if (auto it = terms_.find(term.tokens[i]); it != terms_.end()) {
+        list = &it->second;
+      }
+      if (list == nullptr) {
+        return {};
+      }
+      if (std::find(lists.begin(), lists.end(), list) == lists.end()) {
+        lists.push_back(list);
+      }
+    }
+    if (term.tokens.size() > 1) {
+      phrases.push_back(&term);
+    }
+  }
+
+  // The rarest term drives; each other term only decodes blocks overlapping its candidates
+  std::sort(lists.begin(), lists.end(), [](const PostingList* a, const PostingList* b) {
+    return a->size() < b->size();
+  });
+
+  std::vector<double> idfs;
+  std::vector<PostingCursor> cursors;
+  for (const auto* list : lists) {
+    idfs.push_back(idf(*list));
+    cursors.emplace_back(*list);
+  }
+
+  std::vector<Match> matches;
+  std::vector<uint32_t> docs;
+  std::vector<double> scores;
+  std::vector<uint32_t> next_docs;
+  std::vector<double> next_scores;
+  std::array<uint32_t, PostingList::kBlockSize> a_index{};
+  std::array<uint32_t, PostingList::kBlockSize> b_index{};
+
+  PostingCursor& driver = cursors[0];
+  while (!driver.atEnd()) {
+    docs.clear();
+    scores.clear();
+    for (size_t i = 0; i < driver.blockSize(); ++i) {
+      uint32_t doc = driver.blockDocs()[i];
+      if (passesFilters(doc, query)) {
+        docs.push_back(doc);
+        scores.push_back(termScore(idfs[0], driver.blockTfs()[i], docs_[doc].length));
+      }
+    }
+
+    for (size_t k = 1; k < cursors.size() && !docs.empty(); ++k) {
+      PostingCursor& cursor = cursors[k];
+      next_docs.clear();
+      next_scores.clear();
+
+      size_t from = 0;
+      cursor.seek(docs[0]);
+      while (!cursor.atEnd() && from < docs.size()) {
+        const uint32_t* block_docs = cursor.blockDocs();
+        size_t block_size = cursor.blockSize();
+        size_t found = intersectSorted(docs.data() + from, docs.size() - from, block_docs, block_size,
+                                       a_index.data(), b_index.data());
+        for (size_t m = 0; m < found; ++m) {
+          size_t at = from + a_index[m];
+          next_docs.push_back(docs[at]);
+          next_scores.push_back(scores[at] + termScore(idfs[k], cursor.blockTfs()[b_index[m]],
+                                                       docs_[docs[at]].length));
+        }
+
+        // Stay on this block if later candidates (or the next driver block) may still need it
+        uint32_t block_last = block_docs[block_size - 1];
+        from = static_cast<size_t>(std::upper_bound(docs.begin() + static_cast<std::ptrdiff_t>(from),
+                                                    docs.end(), block_last) - docs.begin());
+        if (from < docs.size()) {
+          cursor.seek(docs[from]);
+        }
+      }
+
+      docs.swap(next_docs);
+      scores.swap(next_scores);
+    }
+
+    for (size_t i = 0; i < docs.size(); ++i) {
+      matches.push_back({docs[i], scores[i]});
+    }
+    driver.nextBlock();
+  }
+
+  // Phrases: every word is present; now check they are adjacent
+  if (!phrases.empty()) {
+    std::erase_if(matches, [&](const Match& match) {
+      return std::any_of(phrases.begin(), phrases.end(), [&](const QueryTerm* phrase) {
+        return !containsPhrase(match.doc, phrase->tokens);
+      });
+    });
+  }
+
+  for (const auto& term : clause.excluded) {
+    auto excluded = matchClause(Clause{{term}, {}}, SearchQuery{});
+    std::vector<Match> kept;
+    std::set_difference(matches.begin(), matches.end(), excluded.begin(), excluded.end(),
+                        std::back_inserter(kept),
+                        [](const Match& a, const Match& b) { return a.doc < b.doc; });
+    matches = std::move(kept);
+  }
+
+  return matches;
+}
+
+std::vector<MemoryIndex::Match> MemoryIndex::topKDisjunction(const std::vector<const PostingList*>& lists,
+                                                             const SearchQuery& query,
+                                                             size_t top_k) const {
+  struct Term {
+    PostingCursor cursor;
+    double idf;
+    double max_score;
+  };
+
+  std::vector<Term> terms;
+  terms.reserve(lists.size());
+  for (const auto* list : lists) {
+    double term_idf = idf(*list);
+    terms.push_back({PostingCursor(*list), term_idf,
+                     termScore(term_idf, list->maxTf(), list->minLength())});
+  }
+
+  auto worse = [](const Match& a, const Match& b) {
+    return a.score != b.score ? a.score > b.score : a.doc < b.doc;
+  };
+  std::priority_queue<Match, std::vector<Match>, decltype(worse)> heap(worse);
+
+  std::vector<Term*> order;
+  for (auto& term : terms) {
+    order.push_back(&term);
+  }
+
+  while (true) {
+    std::sort(order.begin(), order.end(), [](const Term* a, const Term* b) {
+      return a->cursor.doc() < b->cursor.doc();
+    });
+
+    const bool full = heap.size() >= top_k;
+    const double threshold = full ? heap.top().score : 0.0;
+
+    // Pivot: first term where the summed upper bounds could beat the threshold
+    double upper = 0.0;
+    size_t pivot = order.size();
+    for (size_t i = 0; i < order.size() && !order[i]->cursor.atEnd(); ++i) {
+      upper += order[i]->max_score;
+      if (!full || upper > threshold) {
+        pivot = i;
+        break;
+      }
+    }
+    if (pivot == order.size()) {
+      break;
+    }
+
+    const uint32_t pivot_doc = order[pivot]->cursor.doc();
+    while (pivot + 1 < order.size() && order[pivot + 1]->cursor.doc() == pivot_doc) {
+      ++pivot;
+    }
+
+    // Block-max check: the blocks holding pivot_doc may bound it below the threshold
+    double block_upper = 0.0;
+    for (size_t i = 0; i <= pivot; ++i) {
+      auto& cursor = order[i]->cursor;
+      cursor.shallowSeek(pivot_doc);
+      if (const auto* block = cursor.block()) {
+        block_upper += termScore(order[i]->idf, block->max_tf, block->min_length);
+      }
+    }
+
+    if (full && block_upper <= threshold) {
+      // Nothing before the end of the nearest block can qualify
+      uint32_t next = PostingCursor::kEnd;
+      for (size_t i = 0; i <= pivot; ++i) {
+        uint32_t last = order[i]->cursor.blockLast();
+        if (last != PostingCursor::kEnd) {
+          next = std::min(next, last + 1);
+        }
+      }
+      if (pivot + 1 < order.size()) {
+        next = std::min(next, order[pivot + 1]->cursor.doc());
+      }
+      for (size_t i = 0; i <= pivot; ++i) {
+        order[i]->cursor.seek(next);
+      }
+      continue;
+    }
+
+    if (order[0]->cursor.doc() == pivot_doc) {
+      if (passesFilters(pivot_doc, query)) {
+        double score = 0.0;
+        for (size_t i = 0; i <= pivot; ++i) {
+          score += termScore(order[i]->idf, order[i]->cursor.tf(), docs_[pivot_doc].length);
+        }
+        if (!full || score > threshold) {
+          heap.push({pivot_doc, score});
+          if (heap.size() > top_k) {
+            heap.pop();
+          }
+        }
+      }
+      for (size_t i = 0; i <= pivot; ++i) {
+        order[i]->cursor.next();
+      }
+    } else {
+      for (size_t i = 0; i < pivot; ++i) {
+        order[i]->cursor.seek(pivot_doc);
+      }
+    }
+  }
+
+  std::vector<Match> matches;
+  matches.reserve(heap.size());
+  while (!heap.empty()) {
+    matches.push_back(heap.top());
+    heap.pop();
+  }
+  std::reverse(matches.begin(), matches.end());
+  return matches;
+}
+
+std::vector<MemoryIndex::Match> MemoryIndex::metadataMatches(const SearchQuery& query) const {
+  // Words nested in a boolean filter (e.g. "rust OR tag:go") still score the notes they match
+  std::vector<double> scores(docs_.size(), 0.0);
+  if (query.expr.has_value()) {
+    std::vector<const QueryExpr*> leaves;
+    collectPositiveText(*query.expr, leaves);
+    for (const auto* leaf : leaves) {
+      for (const auto& match : textMatches(*leaf)) {
+        scores[match.doc] += match.score;
+      }
+    }
+  }
+
+  std::vector<Match> matches;
+  for (size_t doc = 0; doc < docs_.size(); ++doc) {
+    if (passesFilters(static_cast<uint32_t>(doc), query)) {
+      matches.push_back({static_cast<uint32_t>(doc), scores[doc]});
+    }
+  }
+  // Otherwise no relevance without text: newest first, as the other backends list
+  std::stable_sort(matches.begin(), matches.end(), [this](const Match& a, const Match& b) {
+    if (a.score != b.score) {
+      return a.score > b.score;
+    }
+    return docs_[a.doc].modified > docs_[b.doc].modified;
+  });
+  return matches;
+}
+
+bool MemoryIndex::passesFilters(uint32_t doc, const SearchQuery& query) const {
+  const Document& document = docs_[doc];
+  if (!document.live) {
+    return false;
+  }
+  if (allowed_ != nullptr && !(*allowed_)[doc]) {
+    return false;
+  }
+  for (const auto& tag : query.tags) {
+    if (std::find(document.tags.begin(), document.tags.end(), tag) == document.tags.end()) {
+      return false;
+    }
+  }
+  if (query.notebook.has_value() && document.notebook != query.notebook) {
+    return false;
+  }
+  if (query.since.has_value() && document.modified < *query.since) {
+    return false;
+  }
+  if (query.until.has_value() && document.modified > *query.until) {
+    return false;
+  }
+  return true;
+}
+
+std::vector<bool> MemoryIndex::exprDocs(const QueryExpr& expr) const {
+  using Kind = QueryExpr::Kind;
+  std::vector<bool> docs(docs_.size(), false);
+
+  switch (expr.kind) {
+    case Kind::kAnd:
+    case Kind::kOr: {
+      bool all = expr.kind == Kind::kAnd;
+      docs.assign(docs_.size(), all);
+      for (const auto& child : expr.children) {
+        auto part = exprDocs(child);
+        for (size_t doc = 0; doc < docs.size(); ++doc) {
+          docs[doc] = all ? docs[doc] && part[doc] : docs[doc] || part[doc];
+        }
+      }
+      break;
+    }
+    case Kind::kNot:
+      // Deleted documents come back set here; passesFilters() drops them
+      docs = exprDocs(expr.children[0]);
+      docs.flip();
+      break;
+    case Kind::kText:
+      for (const auto& match : textMatches(expr)) {
+        docs[match.doc] = true;
+      }
+      break;
+    default:
+      for (size_t doc = 0; doc < docs_.size(); ++doc) {
+        const Document& document = docs_[doc];
+        QueryExpr::Facts facts{document.title, document.tags, document.notebook, document.created,
+                               document.modified};
+        docs[doc] = expr.matches(facts, nullptr);
+      }
+      break;
+  }
+  return docs;
+}
+
+std::vector<MemoryIndex::Match> MemoryIndex::textMatches(const QueryExpr& leaf) const {
+  QueryTerm term;
+  term.prefix = !leaf.value.empty() && leaf.value.back() == '*';
+  term.tokens = tokenize(leaf.value);
+  if (term.tokens.empty()) {
+    return {};
+  }
+  return matchClause(Clause{{std::move(term)}, {}}, SearchQuery{});
+}
+
+bool MemoryIndex::containsPhrase(uint32_t doc, const std::vector<std::string>& tokens) const {
+  auto contains = [&tokens](std::string_view text) {
+    auto words = tokenize(text);
+    return std::search(words.begin(), words.end(), tokens.begin(), tokens.end()) != words.end();
+  };
+
+  if (contains(docs_[doc].title)) {
+    return true;
+  }
+  auto content = contentOf(doc);
+  // Without the text the words' presence is all that can be checked
+  return !content.has_value() || contains(*content);
+}
+
+std::optional<std::string> MemoryIndex::contentOf(uint32_t doc) const {
+  if (config_.content_provider) {
+    return config_.content_provider(docs_[doc].id);
+  }
+  return docs_[doc].content;
+}
+
+double MemoryIndex::idf(const PostingList& list) const {
+  // Postings of deleted notes linger until compaction; clamp so idf stays positive
+  double n = static_cast<double>(live_docs_);
+  double df = std::min(static_cast<double>(list.size()), n);
+  return std::log(1.0 + (n - df + 0.5) / (df + 0.5));
+}
+
+double MemoryIndex::termScore(double term_idf, uint32_t tf, uint32_t doc_length) const {
+  double average = live_docs_ > 0 ? static_cast<double>(live_length_) / static_cast<double>(live_docs_)
+                                  : 1.0;
+  double frequency = static_cast<double>(tf);
+  double norm = kK1 * (1.0 - kB + kB * static_cast<double>(doc_length) / std::max(average, 1.0));
+  return term_idf * frequency * (kK1 + 1.0) / (frequency + norm);
+}
+
+std::optional<std::vector<uint32_t>> MemoryIndex::literalCandidates(const std::string& literal) const {
+  // Only whole words (bounded on both sides inside the literal) and word starts
+  // (bounded on the left) are known to be indexed terms; edge fragments may sit
+  // inside longer words and can't narrow anything.
+  std::optional<std::vector<uint32_t>> candidates;
+  std::deque<PostingList> storage;
+  std::array<uint32_t, PostingList::kBlockSize> block_docs{};
+  std::array<uint32_t, PostingList::kBlockSize> block_tfs{};
+
+  forEachToken(literal, [&](const std::string& token, size_t begin, size_t end) {
+    if (begin == 0) {
+      return;
+    }
+    const PostingList* list = nullptr;
+    PostingList empty;
+    if (end < literal.size()) {
+      auto it = terms_.find(token);
+      list = it != terms_.end() ? &it->second : &empty;
+    } else {
+      list = prefixList(token, storage.emplace_back());
+      if (list == nullptr) {
+        list = &empty;
+      }
+    }
+
+    std::vector<uint32_t> docs;
+    for (size_t block = 0; block < list->blocks().size(); ++block) {
+      size_t n = list->decodeBlock(block, block_docs.data(), block_tfs.data());
+      for (size_t i = 0; i < n; ++i) {
+        if (docs_[block_docs[i]].live) {
+          docs.push_back(block_docs[i]);
+        }
+      }
+    }
+
+    if (!candidates.has_value()) {
+      candidates = std::move(docs);
+    } else {
+      std::vector<uint32_t> both;
+      std::set_intersection(candidates->begin(), candidates->end(), docs.begin(), docs.end(),
+                            std::back_inserter(both));
+      candidates = std::move(both);
+    }
+  });
+
+  return candidates;
+}
+
+const PostingList* MemoryIndex::prefixList(const std::string& prefix, PostingList& storage) const {
+  auto first = terms_.lower_bound(prefix);
+  auto last = first;
+  size_t expansions = 0;
+  while (last != terms_.end() && last->first.starts_with(prefix)) {
+    ++last;
+    ++expansions;
+  }
+  if (expansions == 0) {
+    return nullptr;
+  }
+  if (expansions == 1) {
+    return &first->second;
+  }
+
+  // Merge the expansions into one list, summing frequencies per note
+  std::vector<std::pair<uint32_t, uint32_t>> postings;
+  std::array<uint32_t, PostingList::kBlockSize> block_docs{};
+  std::array<uint32_t, PostingList::kBlockSize> block_tfs{};
+  for (auto it = first; it != last; ++it) {
+    const auto& list = it->second;
+    for (size_t block = 0; block < list.blocks().size(); ++block) {
+      size_t n = list.decodeBlock(block, block_docs.data(), block_tfs.data());
+      for (size_t i = 0; i < n; ++i) {
+        postings.emplace_back(block_docs[i], block_tfs[i]);
+      }
+    }
+  }
+  std::sort(postings.begin(), postings.end());
+
+  for (size_t i = 0; i < postings.size();) {
+    uint32_t doc = postings[i].first;
+    uint32_t tf = 0;
+    for (; i < postings.size() && postings[i].first == doc; ++i) {
+      tf += postings[i].second;
+    }
+    storage.append(doc, tf, docs_[doc].length);
+  }
+  return &storage;
+}
+
+SearchResult MemoryIndex::toResult(const Match& match, const std::vector<std::string>& highlight_terms,
+                                   bool highlight) const {
+  const Document& document = docs_[match.doc];
+
+  SearchResult result;
+  result.id = document.id;
+  result.title = document.title;
+  result.modified = document.modified;
+  result.tags = document.tags;
+  result.notebook = document.notebook;
+  // Same scale as the SQLite backend's normalized bm25()
+  result.score = highlight_terms.empty() ? 1.0 : std::min(1.0, match.score / 10.0);
+
+  if (!highlight) {
+    return result;
+  }
+  auto content = contentOf(match.doc);
+  if (!content.has_value()) {
+    return result;
+  }
+
+  auto is_hit = [&highlight_terms](const std::string& token) {
+    return std::any_of(highlight_terms.begin(), highlight_terms.end(), [&](const std::string& term) {
+      return term.ends_with('*') ? token.starts_with(std::string_view(term).substr(0, term.size() - 1))
+                                 : token == term;
+    });
+  };
+
+  // Window around the first hit, every hit inside it marked
+  std::vector<std::pair<size_t, size_t>> hits;
+  forEachToken(*content, [&](const std::string& token, size_t begin, size_t end) {
+    if (is_hit(token)) {
+      hits.emplace_back(begin, end);
+    }
+  });
+
+  size_t start = hits.empty() || hits[0].first < kSnippetLeadIn ? 0 : hits[0].first - kSnippetLeadIn;
+  while (start > 0 && (static_cast<unsigned char>((*content)[start]) & 0xC0) == 0x80) {
+    --start;
+  }
+  size_t stop = std::min(content->size(), start + kSnippetLength);
+  while (stop < content->size() && (static_cast<unsigned char>((*content)[stop]) & 0xC0) == 0x80) {
+    ++stop;
+  }
+
+  std::string snippet = start > 0 ? "..." : "";
+  size_t at = start;
+  for (const auto& [begin, end] : hits) {
+    if (begin < start) {
+      continue;
+    }
+    if (end > stop) {
+      break;
+    }
+    snippet.append(*content, at, begin - at);
+    snippet += "<mark>";
+    snippet.append(*content, begin, end - begin);
+    snippet += "</mark>";
+    at = end;
+  }
+  snippet.append(*content, at, stop - at);
+  if (stop < content->size()) {
+    snippet += "...";
+  }
+  result.snippet = std::move(snippet);
+  return result;
+}
+
+Result<void> MemoryIndex::loadSnapshot() {
+  std::ifstream in(config_.snapshot_file, std::ios::binary);
+  if (!in) {
+    return std::unexpected(makeError(ErrorCode::kFileReadError,
+                                     "Cannot open index snapshot: " + config_.snapshot_file.string()));
+  }
+
+  SnapshotReader reader(in);
+  char magic[sizeof(kSnapshotMagic)];
+  in.read(magic, sizeof(magic));
+  if (!in || !std::equal(std::begin(magic), std::end(magic), std::begin(kSnapshotMagic)) ||
+      reader.get<uint32_t>() != kSnapshotVersion) {
+    return std::unexpected(makeError(ErrorCode::kIndexError, "Unrecognized index snapshot format"));
+  }
+
+  auto corrupt = [this]() {
+    clearAll();
+    return std::unexpected(makeError(ErrorCode::kIndexError, "Corrupt index snapshot"));
+  };
+
+  auto doc_count = reader.get<uint64_t>();
+  if (!reader.ok() || doc_count >= PostingCursor::kEnd / 2) {
+    return corrupt();
+  }
+  for (uint64_t i = 0; i < doc_count && reader.ok(); ++i) {
+    Document document;
+    auto id = nx::core::NoteId::fromString(reader.getString());
+    if (!id.has_value()) {
+      return corrupt();
+    }
+    document.id = *id;
+    document.title = reader.getString();
+    document.created = fromMillis(reader.get<int64_t>());
+    document.modified = fromMillis(reader.get<int64_t>());
+    auto tag_count = reader.get<uint32_t>();
+    for (uint32_t t = 0; t < tag_count && reader.ok(); ++t) {
+      document.tags.push_back(reader.getString());
+    }
+    if (reader.get<uint8_t>() != 0) {
+      document.notebook = reader.getString();
+    }
+    document.length = reader.get<uint32_t>();
+    document.live = reader.get<uint8_t>() != 0;
+    document.content = reader.getString();
+
+    if (document.live) {
+      doc_numbers_[document.id.toString()] = static_cast<uint32_t>(docs_.size());
+      live_docs_++;
+      live_length_ += document.length;
+    }
+    docs_.push_back(std::move(document));
+  }
+
+  auto term_count = reader.get<uint64_t>();
+  for (uint64_t i = 0; i < term_count && reader.ok(); ++i) {
+    std::string term = reader.getString();
+    auto count = reader.get<uint64_t>();
+    auto blocks = reader.getVector<PostingList::Block>();
+    auto bytes = reader.getVector<uint8_t>();
+    if (!reader.ok() || blocks.size() != (count + PostingList::kBlockSize - 1) / PostingList::kBlockSize ||
+        (!blocks.empty() && (blocks.back().last_doc >= docs_.size() || blocks.back().offset >= bytes.size()))) {
+      return corrupt();
+    }
+    terms_[std::move(term)].assign(std::move(blocks), std::move(bytes), count);
+  }
+
+  last_updated_ = fromMillis(reader.get<int64_t>());
+  last_optimized_ = fromMillis(reader.get<int64_t>());
+  if (!reader.ok()) {
+    return corrupt();
+  }
+
+  dirty_ = false;
+  return {};
+}
+
+Result<void> MemoryIndex::writeSnapshot() {
+  if (config_.snapshot_file.empty()) {
+    dirty_ = false;
+    return {};
+  }
+
+  std::error_code ec;
+  std::filesystem::create_directories(config_.snapshot_file.parent_path(), ec);
+
+  // Write beside the target and rename, so readers never see a partial file
+  auto temp_path = config_.snapshot_file;
+  temp_path += ".tmp";
+  {
+    std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+      return std::unexpected(makeError(ErrorCode::kFileWriteError,
+                                       "Cannot write index snapshot: " + temp_path.string()));
+    }
+
+    SnapshotWriter writer(out);
+    out.write(kSnapshotMagic, sizeof(kSnapshotMagic));
+    writer.put<uint32_t>(kSnapshotVersion);
+
+    writer.put<uint64_t>(docs_.size());
+    for (const auto& document : docs_) {
+      writer.putString(document.id.toString());
+      writer.putString(document.title);
+      writer.put<int64_t>(toMillis(document.created));
+      writer.put<int64_t>(toMillis(document.modified));
+      writer.put<uint32_t>(static_cast<uint32_t>(document.tags.size()));
+      for (const auto& tag : document.tags) {
+        writer.putString(tag);
+      }
+      writer.put<uint8_t>(document.notebook.has_value() ? 1 : 0);
+      if (document.notebook.has_value()) {
+        writer.putString(*document.notebook);
+      }
+      writer.put<uint32_t>(document.length);
+      writer.put<uint8_t>(document.live ? 1 : 0);
+      writer.putString(document.content);
+    }
+
+    writer.put<uint64_t>(terms_.size());
+    for (const auto& [term, list] : terms_) {
+      writer.putString(term);
+      writer.put<uint64_t>(list.size());
+      writer.putVector(list.blocks());
+      writer.putVector(list.bytes());
+    }
+
+    writer.put<int64_t>(toMillis(last_updated_));
+    writer.put<int64_t>(toMillis(last_optimized_));
+
+    if (!out.flush()) {
+      return std::unexpected(makeError(ErrorCode::kFileWriteError,
+                                       "Failed writing index snapshot: " + temp_path.string()));
+    }
+  }
+
+  std::filesystem::rename(temp_path, config_.snapshot_file, ec);
+  if (ec) {
+    return std::unexpected(makeError(ErrorCode::kFileWriteError,
+                                     "Failed to replace index snapshot: " + ec.message()));
+  }
+
+  dirty_ = false;
+  return {};
+}
+
+}  // namespace nx::index
@@ -0,0 +1,503 @@
+#include "nx/index/minhash_index.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <limits>
+#include <unordered_set>
+
+#include "nx/index/snapshot_io.hpp"
+#include "nx/index/text_features.hpp"
+
+namespace nx::index {
+
+namespace {
+
+constexpr char kSnapshotMagic[8] = {'N', 'X', 'M', 'I', 'N', 'H', '\0', '\0'};
+constexpr uint32_t kSnapshotVersion = 1;
+
+constexpr uint32_t kNoDocument = std::numeric_limits<uint32_t>::max();
+
+uint64_t splitmix64(uint64_t& state) {
+  uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+}  // namespace
+
+MinHashIndex::MinHashIndex() : MinHashIndex(Config{}) {}
+
+MinHashIndex::MinHashIndex(Config config) : config_(std::move(config)) {
+  config_.bands = std::max<size_t>(config_.bands, 1);
+  config_.shingle_size = std::max<size_t>(config_.shingle_size, 1);
+  rows_ = std::max<size_t>(config_.num_hashes / config_.bands, 1);
+  config_.num_hashes = rows_ * config_.bands;
+
+  // Multiply-shift hashing: odd multipliers, top 32 bits of the product
+  uint64_t state = config_.seed;
+  for (size_t i = 0; i < config_.num_hashes; ++i) {
+    multipliers_.push_back(splitmix64(state) | 1);
+    offsets_.push_back(splitmix64(state));
+  }
+}
+
+MinHashIndex::~MinHashIndex() {
+  if (dirty_) {
+    (void)save();
+  }
+}
+
+std::string MinHashIndex::indexedText(const nx::core::Note& note) {
+  std::string text;
+  for (const auto& tag : note.tags()) {
+    text += tag;
+    text += ' ';
+  }
+  if (!text.empty()) {
+    text.back() = '\n';
+  }
+  text += note.content();
+  return text;
+}
+
+MinHashIndex::Signature MinHashIndex::signatureOf(const std::string& text) const {
+  auto words = contentWords(text);
+  if (words.empty()) {
+    return {};
+  }
+
+  std::vector<uint64_t> shingles;
+  size_t width = std::min(config_.shingle_size, words.size());
+  std::string shingle;
+  for (size_t i = 0; i + width <= words.size(); ++i) {
+    shingle = words[i];
+    for (size_t w = 1; w < width; ++w) {
+      shingle += ' ';
+      shingle += words[i + w];
+    }
+    shingles.push_back(featureHash(shingle));
+  }
+  std::sort(shingles.begin(), shingles.end());
+  shingles.erase(std::unique(shingles.begin(), shingles.end()), shingles.end());
+
+  Signature signature(config_.num_hashes, std::numeric_limits<uint32_t>::max());
+  for (uint64_t shingle_hash : shingles) {
+    for (size_t i = 0; i < signature.size(); ++i) {
+      auto value = static_cast<uint32_t>((shingle_hash * multipliers_[i] + offsets_[i]) >> 32);
+      signature[i] = std::min(signature[i], value);
+    }
+  }
+  return signature;
+}
+
+uint64_t MinHashIndex::bandKey(const Signature& signature, size_t band) const {
+  uint64_t key = contentHash(std::string_view(reinterpret_cast<const char*>(signature.data() + band * rows_),
+                                              rows_ * sizeof(uint32_t)));
+  return key ^ (band * 0x9e3779b97f4a7c15ULL);
+}
+
+double MinHashIndex::estimate(const Signature& a, const Signature& b) const {
+  if (a.empty() || b.empty()) {
+    return 0.0;
+  }
+  size_t agree = 0;
+  for (size_t i = 0; i < a.size(); ++i) {
+    agree += a[i] == b[i] ? size_t{1} : size_t{0};
+  }
+  return static_cast<double>(agree) / static_cast<double>(a.size());
+}
+
+void MinHashIndex::insertLocked(const std::string& key, uint64_t version, Signature signature) {
+  removeLocked(key);
+
+  uint32_t doc;
+  if (!free_docs_.empty()) {
+    doc = free_docs_.back();
+    free_docs_.pop_back();
+  } else {
+    doc = static_cast<uint32_t>(docs_.size());
+    docs_.emplace_back();
+  }
+
+  // Notes without words are kept (so they aren't re-read) but never bucketed
+  if (!signature.empty()) {
+    for (size_t band = 0; band < config_.bands; ++band) {
+      buckets_[bandKey(signature, band)].push_back(doc);
+    }
+  }
+  docs_[doc] = Document{key, version, std::move(signature), true};
+  doc_numbers_[key] = doc;
+  dirty_ = true;
+}
+
+void MinHashIndex::removeLocked(const std::string& key) {
+  auto it = doc_numbers_.find(key);
+  if (it == doc_numbers_.end()) {
+    return;
+  }
+
+  uint32_t doc = it->second;
+  const auto& signature = docs_[doc].signature;
+  if (!signature.empty()) {
+    for (size_t band = 0; band < config_.bands; ++band) {
+      auto bucket = buckets_.find(bandKey(signature, band));
+      if (bucket == buckets_.end()) {
+        continue;
+      }
+      auto& members = bucket->second;
+      auto member = std::find(members.begin(), members.end(), doc);
+      if (member != members.end()) {
+        *member = members.back();
+        members.pop_back();
+      }
+      if (members.empty()) {
+        buckets_.erase(bucket);
+      }
+    }
+  }
+
+  docs_[doc] = Document{};
+  free_docs_.push_back(doc);
+  doc_numbers_.erase(it);
+  dirty_ = true;
+}
+
+void MinHashIndex::clearLocked() {
+  docs_.clear();
+  free_docs_.clear();
+  doc_numbers_.clear();
+  buckets_.clear();
+}
+
+size_t MinHashIndex::sync(const std::vector<nx::core::Note>& notes) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  std::unordered_set<std::string> present;
+  size_t hashed = 0;
+  for (const auto& note : notes) {
+    auto key = note.id().toString();
+    present.insert(key);
+
+    auto text = indexedText(note);
+    uint64_t version = contentHash(text);
+    auto it = doc_numbers_.find(key);
+    if (it != doc_numbers_.end() && docs_[it->second].version == version) {
+      continue;
+    }
+    insertLocked(key, version, signatureOf(text));
+    ++hashed;
+  }
+
+  std::vector<std::string> gone;
+  for (const auto& [key, doc] : doc_numbers_) {
+    if (!present.contains(key)) {
+      gone.push_back(key);
+    }
+  }
+  for (const auto& key : gone) {
+    removeLocked(key);
+  }
+  return hashed;
+}
+
+Result<size_t> MinHashIndex::refresh(const NoteManifest& manifest, const NoteLoader& loader) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  std::unordered_map<std::string, uint64_t> versions;
+  std::vector<nx::core::NoteId> stale;
+  for (const auto& [path_key, entry] : manifest.entries()) {
+    auto key = entry.id.toString();
+    uint64_t version = entry.fileVersion();
+    versions[key] = version;
+
+    auto it = doc_numbers_.find(key);
+    if (it == doc_numbers_.end() || docs_[it->second].version != version) {
+      stale.push_back(entry.id);
+    }
+  }
+
+  std::vector<std::string> gone;
+  for (const auto& [key, doc] : doc_numbers_) {
+    if (!versions.contains(key)) {
+      gone.push_back(key);
+    }
+  }
+  for (const auto& key : gone) {
+    removeLocked(key);
+  }
+
+  if (stale.empty()) {
+    return size_t{0};
+  }
+  auto notes = loader(stale);
+  if (!notes.has_value()) {
+    return std::unexpected(notes.error());
+  }
+  for (const auto& note : *notes) {
+    auto key = note.id().toString();
+    auto version = versions.find(key);
+    if (version != versions.end()) {
+      insertLocked(key, version->second, signatureOf(indexedText(note)));
+    }
+  }
+  return notes->size();
+}
+
+void MinHashIndex::upsert(const nx::core::Note& note) {
+  auto text = indexedText(note);
+  upsert(note.id(), text, contentHash(text));
+}
+
+void MinHashIndex::upsert(const nx::core::NoteId& id, const std::string& text, uint64_t version) {
+  auto signature = signatureOf(text);
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto key = id.toString();
+  auto it = doc_numbers_.find(key);
+  if (it != doc_numbers_.end() && docs_[it->second].version == version) {
+    return;
+  }
+  insertLocked(key, version, std::move(signature));
+}
+
+void MinHashIndex::remove(const nx::core::NoteId& id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  removeLocked(id.toString());
+}
+
+bool MinHashIndex::contains(const nx::core::NoteId& id) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return doc_numbers_.contains(id.toString());
+}
+
+size_t MinHashIndex::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return doc_numbers_.size();
+}
+
+std::vector<MinHashIndex::Match> MinHashIndex::rank(const Signature& signature, uint32_t self, size_t k,
+                                                    double min_similarity) const {
+  std::vector<Match> matches;
+  if (signature.empty() || k == 0) {
+    return matches;
+  }
+
+  // Only notes sharing at least one bucket are compared
+  std::vector<uint8_t> seen(docs_.size(), 0);
+  std::vector<std::pair<double, uint32_t>> scored;
+  for (size_t band = 0; band < config_.bands; ++band) {
+    auto bucket = buckets_.find(bandKey(signature, band));
+    if (bucket == buckets_.end()) {
+      continue;
+    }
+    for (uint32_t doc : bucket->second) {
+      if (doc == self || seen[doc]) {
+        continue;
+      }
+      seen[doc] = 1;
+      double similarity = estimate(signature, docs_[doc].signature);
+      if (similarity > 0.0 && similarity >= min_similarity) {
+        scored.emplace_back(similarity, doc);
+      }
+    }
+  }
+
+  size_t top = std::min(k, scored.size());
+  std::partial_sort(scored.begin(), scored.begin() + static_cast<std::ptrdiff_t>(top), scored.end(),
+                    [this](const auto& a, const auto& b) {
+                      return a.first != b.first ? a.first > b.first : docs_[a.second].id < docs_[b.second].id;
+                    });
+  for (size_t i = 0; i < top; ++i) {
+    auto id = nx::core::NoteId::fromString(docs_[scored[i].second].id);
+    if (id.has_value()) {
+      matches.push_back(Match{*id, scored[i].first});
+    }
+  }
+  return matches;
+}
+
+std::vector<MinHashIndex::Match> MinHashIndex::similar(const nx::core::NoteId& id, size_t k,
+                                                       double min_similarity) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = doc_numbers_.find(id.toString());
+  if (it == doc_numbers_.end()) {
+    return {};
+  }
+  return rank(docs_[it->second].signature, it->second, k, min_similarity);
+}
+
+std::vector<MinHashIndex::Match> MinHashIndex::similarToText(const std::string& text, size_t k,
+                                                             double min_similarity) const {
+  auto signature = signatureOf(text);
+  std::lock_guard<std::mutex> lock(mutex_);
+  return rank(signature, kNoDocument, k, min_similarity);
+}
+
+std::vector<MinHashIndex::DuplicatePair> MinHashIndex::duplicates(double threshold) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  std::vector<DuplicatePair> pairs;
+  std::vector<uint32_t> compared_with(docs_.size(), kNoDocument);
+  for (uint32_t a = 0; a < docs_.size(); ++a) {
+    const auto& signature = docs_[a].signature;
+    if (!docs_[a].live || signature.empty()) {
+      continue;
+    }
+    for (size_t band = 0; band < config_.bands; ++band) {
+      auto bucket = buckets_.find(bandKey(signature, band));
+      if (bucket == buckets_.end()) {
+        continue;
+      }
+      // Each pair once, from its lower document number
+      for (uint32_t b : bucket->second) {
+        if (b <= a || compared_with[b] == a) {
+          continue;
+        }
+        compared_with[b] = a;
+        double similarity = estimate(signature, docs_[b].signature);
+        if (similarity < threshold) {
+          continue;
+        }
+        auto first = nx::core::NoteId::fromString(docs_[a].id);
+        auto second = nx::core::NoteId::fromString(docs_[b].id);
+        if (first.has_value() && second.has_value()) {
+          pairs.push_back(DuplicatePair{*first, *second, similarity});
+        }
+      }
+    }
+  }
+
+  std::sort(pairs.begin(), pairs.end(), [](const DuplicatePair& x, const DuplicatePair& y) {
+    return x.similarity > y.similarity;
+  });
+  return pairs;
+}
+
+Result<std::unique_ptr<MinHashIndex>> MinHashIndex::openForNotes(const std::filesystem::path& notes_dir,
+                                                                 const std::filesystem::path& cache_dir,
+                                                                 const NoteLoader& loader) {
+  NoteManifest manifest(notes_dir, cache_dir / "related_manifest.json");
+  auto refreshed = manifest.refresh();
+  if (!refreshed.has_value()) {
+    return std::unexpected(refreshed.error());
+  }
+
+  Config config;
+  config.snapshot_file = cache_dir / "related.minhash";
+  auto index = std::make_unique<MinHashIndex>(config);
+  (void)index->load();  // A missing or damaged snapshot only means hashing again
+
+  auto updated = index->refresh(manifest, loader);
+  if (!updated.has_value()) {
+    return std::unexpected(updated.error());
+  }
+  auto saved = index->save();
+  if (!saved.has_value()) {
+    return std::unexpected(saved.error());
+  }
+  return index;
+}
+
+Result<void> MinHashIndex::load() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  clearLocked();
+  dirty_ = false;
+  if (config_.snapshot_file.empty() || !std::filesystem::exists(config_.snapshot_file)) {
+    return {};
+  }
+
+  std::ifstream in(config_.snapshot_file, std::ios::binary);
+  if (!in) {
+    return std::unexpected(makeError(ErrorCode::kFileReadError,
+                                     "Cannot open related-notes index: " + config_.snapshot_file.string()));
+  }
+
+  SnapshotReader reader(in);
+  char magic[sizeof(kSnapshotMagic)];
+  in.read(magic, sizeof(magic));
+  if (!in || !std::equal(std::begin(magic), std::end(magic), std::begin(kSnapshotMagic)) ||
+      reader.get<uint32_t>() != kSnapshotVersion) {
+    return std::unexpected(makeError(ErrorCode::kIndexError, "Unrecognized related-notes index format"));
+  }
+
+  // Signatures from other settings are not comparable; start over
+  if (reader.get<uint64_t>() != config_.num_hashes || reader.get<uint64_t>() != config_.bands ||
+      reader.get<uint64_t>() != config_.shingle_size || reader.get<uint64_t>() != config_.seed) {
+    dirty_ = true;
+    return {};
+  }
+
+  auto count = reader.get<uint64_t>();
+  for (uint64_t i = 0; i < count && reader.ok(); ++i) {
+    auto key = reader.getString();
+    auto version = reader.get<uint64_t>();
+    auto signature = reader.getVector<uint32_t>();
+    if (!reader.ok() || (!signature.empty() && signature.size() != config_.num_hashes)) {
+      clearLocked();
+      return std::unexpected(makeError(ErrorCode::kIndexError, "Corrupt related-notes index"));
+    }
+    insertLocked(key, version, std::move(signature));
+  }
+  if (!reader.ok()) {
+    clearLocked();
+    return std::unexpected(makeError(ErrorCode::kIndexError, "Corrupt related-notes index"));
+  }
+
+  dirty_ = false;
+  return {};
+}
+
+Result<void> MinHashIndex::save() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!dirty_ || config_.snapshot_file.empty()) {
+    dirty_ = false;
+    return {};
+  }
+
+  std::error_code ec;
+  std::filesystem::create_directories(config_.snapshot_file.parent_path(), ec);
+
+  // Write beside the target and rename, so readers never see a partial file
+  auto temp_path = config_.snapshot_file;
+  temp_path += ".tmp";
+  {
+    std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+      return std::unexpected(makeError(ErrorCode::kFileWriteError,
+                                       "Cannot write related-notes index: " + temp_path.string()));
+    }
+
+    SnapshotWriter writer(out);
+    out.write(kSnapshotMagic, sizeof(kSnapshotMagic));
+    writer.put<uint32_t>(kSnapshotVersion);
+    writer.put<uint64_t>(config_.num_hashes);
+    writer.put<uint64_t>(config_.bands);
+    writer.put<uint64_t>(config_.shingle_size);
+    writer.put<uint64_t>(config_.seed);
+
+    writer.put<uint64_t>(doc_numbers_.size());
+    for (const auto& document : docs_) {
+      if (document.live) {
+        writer.putString(document.id);
+        writer.put<uint64_t>(document.version);
+        writer.putVector(document.signature);
+      }
+    }
+
+    if (!out.flush()) {
+      return std::unexpected(makeError(ErrorCode::kFileWriteError,
+                                       "Failed writing related-notes index: " + temp_path.string()));
+    }
+  }
+
+  std::filesystem::rename(temp_path, config_.snapshot_file, ec);
+  if (ec) {
+    return std::unexpected(makeError(ErrorCode::kFileWriteError,
+                                     "Failed to replace related-notes index: " + ec.message()));
+  }
+
+  dirty_ = false;
+  return {};
+}
+
+}  // namespace nx::index
@@ -0,0 +1,571 @@
+#include "nx/index/native_grep_index.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <regex>
+#include <thread>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "nx/index/trigram_query.hpp"
+#include "nx/util/timing.hpp"
+
+namespace nx::index {
+
+namespace {
+
+// Matches counted per file; enough to rank by match density (same cap as the rg backend)
+constexpr size_t kMaxMatchesPerFile = 20;
+
+constexpr size_t kMaxWorkers = 8;
+
+char asciiLower(char c) {
+  return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+char asciiUpper(char c) {
+  return (c >= 'a' && c <= 'z') ? static_cast<char>(c - 'a' + 'A') : c;
+}
+
+// Rough frequency of a (lower-cased) byte in note text; lower is rarer
+int byteFrequency(char c) {
+  // English letters by descending frequency, space first
+  constexpr std::string_view kByFrequency = " etaoinshrdlcumwfgypbvkjxqz";
+  size_t rank = kByFrequency.find(c);
+  if (rank != std::string_view::npos) {
+    return 100 - static_cast<int>(rank);
+  }
+  if (c >= '0' && c <= '9') {
+    return 30;
+  }
+  if (c == '\n' || c == '.' || c == ',') {
+    return 80;
+  }
+  // Punctuation and UTF-8 bytes
+  return 20;
+}
+
+// First position in [p, end) holding a or b, or end
+const char* findEitherByte(const char* p, const char* end, char a, char b) {
+  if (a == b) {
+    const void* hit = std::memchr(p, a, static_cast<size_t>(end - p));
+    return hit ? static_cast<const char*>(hit) : end;
+  }
+#if defined(__SSE2__)
+  const __m128i va = _mm_set1_epi8(a);
+  const __m128i vb = _mm_set1_epi8(b);
+  while (end - p >= 16) {
+    __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, va),
+                                              _mm_cmpeq_epi8(chunk, vb)));
+    if (mask != 0) {
+      return p + __builtin_ctz(static_cast<unsigned>(mask));
+    }
+    p += 16;
+  }
+#endif
+  for (; p < end; ++p) {
+    if (*p == a || *p == b) {
+      return p;
+    }
+  }
+  return end;
+}
+
+// ASCII case-insensitive literal search. Scans for the needle's rarest byte
+// (in either case) and verifies the whole needle around each hit, so most of
+// the haystack is only touched by the vectorized byte scan.
+class LiteralMatcher {
+public:
+  explicit LiteralMatcher(std::string_view needle) {
+    needle_.reserve(needle.size());
+    for (char c : needle) {
+      needle_ += asciiLower(c);
+    }
+    for (size_t i = 1; i < needle_.size(); ++i) {
+      if (byteFrequency(needle_[i]) < byteFrequency(needle_[anchor_])) {
+        anchor_ = i;
+      }
+    }
+  }
+
+  bool empty() const { return needle_.empty(); }
+  size_t size() const { return needle_.size(); }
+
+  size_t find(std::string_view haystack, size_t from = 0) const {
+    if (needle_.empty()) {
+      return from <= haystack.size() ? from : std::string_view::npos;
+    }
+    if (haystack.size() < needle_.size() || from > haystack.size() - needle_.size()) {
+      return std::string_view::npos;
+    }
+
+    const char lower = needle_[anchor_];
+    const char upper = asciiUpper(lower);
+    const char* begin = haystack.data();
+    const char* last_start = begin + (haystack.size() - needle_.size());
+    const char* scan = begin + from + anchor_;
+    const char* scan_end = last_start + anchor_ + 1;
+
+    while (scan < scan_end) {
+      scan = findEitherByte(scan, scan_end, lower, upper);
+      if (scan == scan_end) {
+        break;
+      }
+      const char* start = scan - anchor_;
+      if (matchesAt(start)) {
+        return static_cast<size_t>(start - begin);
+      }
+      ++scan;
+    }
+    return std::string_view::npos;
+  }
+
+private:
+  bool matchesAt(const char* start) const {
+    for (size_t i = 0; i < needle_.size(); ++i) {
+      if (asciiLower(start[i]) != needle_[i]) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  std::string needle_;
+  size_t anchor_ = 0;
+};
+
+bool readFile(const std::filesystem::path& path, std::string& buffer) {
+  std::ifstream file(path, std::ios::binary | std::ios::ate);
+  if (!file) {
+    return false;
+  }
+  auto size = file.tellg();
+  if (size < 0) {
+    return false;
+  }
+  buffer.resize(static_cast<size_t>(size));
+  file.seekg(0);
+  return static_cast<bool>(file.read(buffer.data(), size));
+}
+
+std::vector<SearchResult>& sortByScore(std::vector<SearchResult>& results) {
+  // Completion order depends on thread timing; break ties so output is stable
+  std::sort(results.begin(), results.end(), [](const SearchResult& a, const SearchResult& b) {
+    if (a.score != b.score) {
+      return a.score > b.score;
+    }
+    if (a.modified != b.modified) {
+      return a.modified > b.modified;
+    }
+    return a.id.toString() < b.id.toString();
+  });
+  return results;
+}
+
+std::vector<SearchResult> page(std::vector<SearchResult> results, size_t offset, size_t limit) {
+  if (offset >= results.size()) {
+    return {};
+  }
+  auto begin = results.begin() + static_cast<std::ptrdiff_t>(offset);
+  auto end = results.begin() + static_cast<std::ptrdiff_t>(std::min(offset + limit, results.size()));
+  return std::vector<SearchResult>(std::make_move_iterator(begin), std::make_move_iterator(end));
+}
+
+}  // namespace
+
+NativeGrepIndex::NativeGrepIndex(std::filesystem::path notes_dir)
+    : NativeGrepIndex(std::move(notes_dir), Config{}) {
+}
+
+NativeGrepIndex::NativeGrepIndex(std::filesystem::path notes_dir, Config config)
+    : notes_dir_(std::move(notes_dir)), config_(std::move(config)),
+      manifest_(notes_dir_, config_.cache_file) {
+}
+
+Result<void> NativeGrepIndex::initialize() {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  if (!std::filesystem::exists(notes_dir_)) {
+    return std::unexpected(makeError(ErrorCode::kDirectoryNotFound,
+                                     "Notes directory not found: " + notes_dir_.string()));
+  }
+
+  auto refresh_result = manifest_.refresh();
+  if (!refresh_result.has_value()) {
+    return refresh_result;
+  }
+  last_refresh_ = std::chrono::system_clock::now();
+
+  return {};
+}
+
+Result<void> NativeGrepIndex::addNote(const nx::core::Note& note) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  manifest_.put(note);
+  return {};
+}
+
+Result<void> NativeGrepIndex::updateNote(const nx::core::Note& note) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  manifest_.put(note);
+  return {};
+}
+
+Result<void> NativeGrepIndex::removeNote(const nx::core::NoteId& id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  manifest_.erase(id);
+  return {};
+}
+
+Result<std::vector<SearchResult>> NativeGrepIndex::search(const SearchQuery& query) {
+  nx::util::ScopedTimer timer("index.search");
+  timer.arg("query", query.text);
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  // Every file is scanned so the page holds the top-ranked hits; only the best
+  // limit + offset are kept along the way
+  auto results = query.text.empty() ? metadataMatches(query)
+                                    : textMatches(query, query.limit + query.offset);
+  return page(std::move(sortByScore(results)), query.offset, query.limit);
+}
+
+Result<std::vector<nx::core::NoteId>> NativeGrepIndex::searchIds(const SearchQuery& query) {
+  SearchQuery ids_query = query;
+  ids_query.highlight = false;
+
+  auto results = search(ids_query);
+  if (!results.has_value()) {
+    return std::unexpected(results.error());
+  }
+
+  std::vector<nx::core::NoteId> ids;
+  ids.reserve(results->size());
+  for (const auto& result : *results) {
+    ids.push_back(result.id);
+  }
+  return ids;
+}
+
+Result<size_t> NativeGrepIndex::searchCount(const SearchQuery& query) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  SearchQuery count_query = query;
+  count_query.highlight = false;
+  return query.text.empty() ? metadataMatches(count_query).size()
+                            : textMatches(count_query, 0).size();
+}
+
+Result<SearchPage> NativeGrepIndex::searchPage(const SearchQuery& query) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  auto results = query.text.empty() ? metadataMatches(query) : textMatches(query, 0);
+
+  SearchPage search_page;
+  search_page.total = results.size();
+  search_page.results = page(std::move(sortByScore(results)), query.offset, query.limit);
+  return search_page;
+}
+
+Result<std::vector<nx::core::NoteId>> NativeGrepIndex::scanCandidates(const std::string& pattern,
+                                                                       bool is_regex) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  std::vector<const NoteManifest::Entry*> entries;
+  entries.reserve(manifest_.size());
+  for (const auto& [id, entry] : manifest_.entries()) {
+    entries.push_back(&entry);
+  }
+
+  auto all_ids = [&entries]() {
+    std::vector<nx::core::NoteId> ids;
+    ids.reserve(entries.size());
+    for (const auto* entry : entries) {
+      ids.push_back(entry->id);
+    }
+    return ids;
+  };
+
+  if (pattern.empty()) {
+    return all_ids();
+  }
+
+  // Regex: a file must contain every literal of some alternative before the
+  // (much slower) regex runs on it. Case-insensitive on both counts, so the
+  // result stays a superset whatever case mode the caller matches with.
+  std::vector<std::vector<LiteralMatcher>> groups;
+  std::optional<std::regex> regex;
+  if (is_regex) {
+    try {
+      regex.emplace(pattern, std::regex::ECMAScript | std::regex::multiline |
+                                 std::regex::icase | std::regex::optimize);
+    } catch (const std::regex_error&) {
+      // The caller reports the bad pattern; nothing can be ruled out here
+      return all_ids();
+    }
+    if (auto literals = TrigramQuery::forRegex(pattern); literals.has_value()) {
+      for (const auto& group : literals->groups) {
+        std::vector<LiteralMatcher> matchers;
+        for (const auto& literal : group) {
+          matchers.emplace_back(literal);
+        }
+        groups.push_back(std::move(matchers));
+      }
+    }
+  } else {
+    groups.push_back({LiteralMatcher(pattern)});
+  }
+
+  auto hits = scanFiles(entries, [&](const NoteManifest::Entry&, std::string_view content)
+                                      -> std::optional<FileHit> {
+    bool literals_found = groups.empty() ||
+        std::any_of(groups.begin(), groups.end(), [&](const auto& group) {
+          return std::all_of(group.begin(), group.end(), [&](const LiteralMatcher& matcher) {
+            return matcher.find(content) != std::string_view::npos;
+          });
+        });
+    if (!literals_found) {
+      return std::nullopt;
+    }
+    if (regex.has_value() && !std::regex_search(content.begin(), content.end(), *regex)) {
+      return std::nullopt;
+    }
+    return FileHit{};
+  }, 0);
+
+  std::vector<nx::core::NoteId> candidates;
+  candidates.reserve(hits.size());
+  for (const auto& hit : hits) {
+    candidates.push_back(hit.entry->id);
+  }
+  return candidates;
+}
+
+Result<std::vector<std::string>> NativeGrepIndex::suggestTags(const std::string& prefix, size_t limit) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return manifest_.suggestTags(prefix, limit);
+}
+
+Result<std::vector<std::string>> NativeGrepIndex::suggestNotebooks(const std::string& prefix, size_t limit) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return manifest_.suggestNotebooks(prefix, limit);
+}
+
+Result<std::vector<TagCount>> NativeGrepIndex::getTagCounts() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return manifest_.tagCounts();
+}
+
+uint64_t NativeGrepIndex::changeCounter() {
+  return manifest_.filesVersion();
+}
+
+Result<IndexStats> NativeGrepIndex::getStats() {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  IndexStats stats = manifest_.stats();
+  stats.last_optimized = last_refresh_;
+  return stats;
+}
+
+Result<bool> NativeGrepIndex::isHealthy() {
+  return std::filesystem::exists(notes_dir_);
+}
+
+Result<void> NativeGrepIndex::validateIndex() {
+  if (!std::filesystem::exists(notes_dir_)) {
+    return std::unexpected(makeError(ErrorCode::kDirectoryNotFound,
+                                     "Notes directory not found"));
+  }
+  return {};
+}
+
+Result<void> NativeGrepIndex::rebuild() {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  auto result = manifest_.refresh();
+  if (result.has_value()) {
+    last_refresh_ = std::chrono::system_clock::now();
+  }
+  return result;
+}
+
+Result<void> NativeGrepIndex::optimize() {
+  // Nothing is stored beyond the manifest; refreshing it is the only upkeep
+  return rebuild();
+}
+
+Result<void> NativeGrepIndex::vacuum() {
+  return {};
+}
+
+Result<void> NativeGrepIndex::beginTransaction() {
+  return {};
+}
+
+Result<void> NativeGrepIndex::commitTransaction() {
+  return {};
+}
+
+Result<void> NativeGrepIndex::rollbackTransaction() {
+  return {};
+}
+
+// Private methods
+
+std::vector<NativeGrepIndex::FileHit> NativeGrepIndex::scanFiles(
+    const std::vector<const NoteManifest::Entry*>& entries,
+    const FileVisitor& visit, size_t keep_top) const {
+  std::vector<FileHit> hits;
+  std::mutex hits_mutex;
+  std::atomic<size_t> next{0};
+
+  // Same order as sortByScore, so the kept hits are exactly the page's candidates
+  auto ranks_before = [](const FileHit& a, const FileHit& b) {
+    if (a.score != b.score) {
+      return a.score > b.score;
+    }
+    if (a.entry->modified != b.entry->modified) {
+      return a.entry->modified > b.entry->modified;
+    }
+    return a.entry->id.toString() < b.entry->id.toString();
+  };
+
+  auto worker = [&]() {
+    std::string buffer;  // Reused across files to avoid reallocating per note
+    while (true) {
+      size_t index = next.fetch_add(1, std::memory_order_relaxed);
+      if (index >= entries.size()) {
+        break;
+      }
+
+      const auto& entry = *entries[index];
+      if (!readFile(entry.file_path, buffer)) {
+        continue;
+      }
+
+      auto hit = visit(entry, buffer);
+      if (!hit.has_value()) {
+        continue;
+      }
+      hit->entry = &entry;
+
+      std::lock_guard<std::mutex> lock(hits_mutex);
+      hits.push_back(std::move(*hit));
+      // Heap with the worst kept hit on top, evicted once more than keep_top are held
+      if (keep_top > 0) {
+        std::push_heap(hits.begin(), hits.end(), ranks_before);
+        if (hits.size() > keep_top) {
+          std::pop_heap(hits.begin(), hits.end(), ranks_before);
+          hits.pop_back();
+        }
+      }
+    }
+  };
+
+  size_t workers = workerCount(entries.size());
+  if (workers <= 1) {
+    worker();
+    return hits;
+  }
+
+  std::vector<std::thread> threads;
+  threads.reserve(workers);
+  for (size_t i = 0; i < workers; ++i) {
+    threads.emplace_back(worker);
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  return hits;
+}
+
+std::vector<SearchResult> NativeGrepIndex::textMatches(const SearchQuery& query,
+                                                       size_t keep_top) const {
+  // Metadata filters first: files they rule out are never read
+  std::vector<const NoteManifest::Entry*> entries;
+  for (const auto& [id, entry] : manifest_.entries()) {
+    if (NoteManifest::matches(entry, query)) {
+      entries.push_back(&entry);
+    }
+  }
+  // Path order keeps single-threaded scans deterministic
+  std::sort(entries.begin(), entries.end(), [](const auto* a, const auto* b) {
+    return a->file_path < b->file_path;
+  });
+
+  LiteralMatcher matcher(query.text);
+  const bool highlight = query.highlight;
+
+  auto hits = scanFiles(entries, [&](const NoteManifest::Entry& entry, std::string_view content)
+                                      -> std::optional<FileHit> {
+    size_t first = matcher.find(content);
+    if (first == std::string_view::npos) {
+      return std::nullopt;
+    }
+
+    FileHit hit;
+    size_t pos = first;
+    while (pos != std::string_view::npos && hit.match_count < kMaxMatchesPerFile) {
+      ++hit.match_count;
+      pos = matcher.find(content, pos + std::max<size_t>(matcher.size(), 1));
+    }
+    hit.score = NoteManifest::score(entry, query, hit.match_count);
+
+    if (highlight) {
+      // Snippet from the line holding the first match, every match on it marked
+      size_t line_start = content.rfind('\n', first);
+      line_start = line_start == std::string_view::npos ? 0 : line_start + 1;
+      size_t line_end = content.find('\n', first);
+      if (line_end == std::string_view::npos) {
+        line_end = content.size();
+      }
+      std::string_view line = content.substr(line_start, line_end - line_start);
+
+      std::vector<std::pair<size_t, size_t>> spans;
+      for (size_t at = matcher.find(line); at != std::string_view::npos;
+           at = matcher.find(line, at + matcher.size())) {
+        spans.emplace_back(at, at + matcher.size());
+      }
+      hit.snippet = markedLineSnippet(line, spans);
+    }
+    return hit;
+  }, keep_top);
+
+  std::vector<SearchResult> results;
+  results.reserve(hits.size());
+  for (auto& hit : hits) {
+    SearchResult result = NoteManifest::toResult(*hit.entry);
+    result.score = hit.score;
+    result.snippet = std::move(hit.snippet);
+    results.push_back(std::move(result));
+  }
+  return results;
+}
+
+std::vector<SearchResult> NativeGrepIndex::metadataMatches(const SearchQuery& query) const {
+  std::vector<SearchResult> results;
+  for (const auto& [id, entry] : manifest_.entries()) {
+    if (NoteManifest::matches(entry, query)) {
+      results.push_back(NoteManifest::toResult(entry));
+    }
+  }
+  return results;
+}
+
+size_t NativeGrepIndex::workerCount(size_t file_count) const {
+  if (file_count < config_.parallel_threshold) {
+    return 1;
+  }
+  size_t workers = config_.threads;
+  if (workers == 0) {
+    workers = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), kMaxWorkers);
+  }
+  return std::min(workers, file_count);
+}
+
+}  // namespace nx::index
@@ -0,0 +1,575 @@
+#include "nx/index/note_manifest.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <set>
+#include <regex>
+#include <sstream>
+
+#include <nlohmann/json.hpp>
+
+namespace nx::index {
+
+namespace {
+
+// Bump when Entry's persisted shape changes; older cache files are ignored
+constexpr int kManifestVersion = 1;
+
+// Snippet length around the first match, in bytes
+constexpr size_t kSnippetLength = 200;
+
+int64_t fileMtime(const std::filesystem::path& path, std::error_code& ec) {
+  return static_cast<int64_t>(std::filesystem::last_write_time(path, ec).time_since_epoch().count());
+}
+
+std::string toLower(std::string text) {
+  std::transform(text.begin(), text.end(), text.begin(), ::tolower);
+  return text;
+}
+
+}  // namespace
+
+NoteManifest::NoteManifest(std::filesystem::path notes_dir, std::filesystem::path cache_file)
+    : notes_dir_(std::move(notes_dir)), cache_file_(std::move(cache_file)) {
+}
+
+Result<void> NoteManifest::refresh() {
+  entries_.clear();
+  
+  // Reuse persisted entries for files that haven't changed since they were parsed
+  auto persisted = loadPersisted();
+  bool changed = false;
+  
+  std::error_code ec;
+  for (const auto& entry : std::filesystem::recursive_directory_iterator(notes_dir_, ec)) {
+    if (ec) continue;
+    
+    if (entry.is_regular_file() && entry.path().extension() == ".md") {
+      std::error_code stat_ec;
+      int64_t mtime = fileMtime(entry.path(), stat_ec);
+      uintmax_t size = entry.file_size(stat_ec);
+      
+      auto it = persisted.find(entry.path().string());
+      if (!stat_ec && it != persisted.end() &&
+          it->second.file_mtime == mtime && it->second.file_size == size) {
+        entries_[it->second.id.toString()] = std::move(it->second);
+        persisted.erase(it);
+        continue;
+      }
+      
+      auto meta_result = parseNoteFile(entry.path());
+      if (meta_result.has_value()) {
+        meta_result->file_mtime = mtime;
+        meta_result->file_size = size;
+        entries_[meta_result->id.toString()] = *meta_result;
+        changed = true;
+      }
+    }
+  }
+  
+  // Entries left over belong to files that no longer exist
+  if (changed || !persisted.empty()) {
+    savePersisted();
+  }
+  
+  return {};
+}
+
+void NoteManifest::put(const nx::core::Note& note) {
+  Entry meta;
+  meta.id = note.id();
+  meta.title = note.title();
+  meta.created = note.metadata().created();
+  meta.modified = note.metadata().updated();
+  meta.tags = note.metadata().tags();
+  meta.notebook = note.notebook();
+  
+  // Calculate word count
+  std::istringstream iss(note.content());
+  meta.word_count = static_cast<size_t>(std::distance(std::istream_iterator<std::string>(iss),
+                                                      std::istream_iterator<std::string>()));
+  
+  // The store names files <id>.md
+  meta.file_path = notes_dir_ / (note.id().toString() + ".md");
+  
+  entries_[note.id().toString()] = meta;
+}
+
+void NoteManifest::erase(const nx::core::NoteId& id) {
+  entries_.erase(id.toString());
+}
+
+void NoteManifest::clear() {
+  entries_.clear();
+}
+
+uint64_t NoteManifest::filesVersion() const {
+  // Same walk and file state as refresh(); summed so directory order doesn't matter
+  uint64_t version = 0;
+  std::error_code ec;
+  for (const auto& entry : std::filesystem::recursive_directory_iterator(notes_dir_, ec)) {
+    if (ec) continue;
+    
+    if (entry.is_regular_file() && entry.path().extension() == ".md") {
+      std::error_code stat_ec;
+      Entry state;
+      state.file_mtime = fileMtime(entry.path(), stat_ec);
+      state.file_size = entry.file_size(stat_ec);
+      uint64_t path_hash = std::hash<std::string>{}(entry.path().string());
+      version += (path_hash ^ state.fileVersion()) * 0xff51afd7ed558ccdULL;
+    }
+  }
+  return version;
+}
+
+const NoteManifest::Entry* NoteManifest::forFile(const std::filesystem::path& file_path) {
+  auto id = nx::core::NoteId::fromString(file_path.stem().string());
+  if (id.has_value()) {
+    auto it = entries_.find(id->toString());
+    if (it != entries_.end()) {
+      return &it->second;
+    }
+  }
+  
+  // Filenames that aren't note ids are matched by path
+  for (const auto& [key, meta] : entries_) {
+    if (meta.file_path == file_path) {
+      return &meta;
+    }
+  }
+  
+  // Not seen yet (written outside nx since the last scan): parse it once
+  auto meta_result = parseNoteFile(file_path);
+  if (!meta_result.has_value()) {
+    return nullptr;
+  }
+  auto [it, inserted] = entries_.insert_or_assign(meta_result->id.toString(),
+                                                          std::move(*meta_result));
+  return &it->second;
+}
+
+bool NoteManifest::matches(const Entry& meta, const SearchQuery& query) {
+  // Filter by tags
+  for (const auto& required_tag : query.tags) {
+    if (std::find(meta.tags.begin(), meta.tags.end(), required_tag) == meta.tags.end()) {
+      return false;
+    }
+  }
+  
+  // Filter by notebook
+  if (query.notebook.has_value()) {
+    if (!meta.notebook.has_value() || *meta.notebook != *query.notebook) {
+      return false;
+    }
+  }
+  
+  // Filter by date ranges
+  if (query.since.has_value() && meta.modified < *query.since) {
+    return false;
+  }
+  
+  if (query.until.has_value() && meta.modified > *query.until) {
+    return false;
+  }
+  
+  // Boolean filter: metadata leaves answer from the entry; word leaves read the file,
+  // at most once and only if the metadata alone does not settle the expression
+  if (query.expr.has_value()) {
+    std::optional<std::string> lower_content;
+    auto text_test = [&](const QueryExpr& leaf) {
+      if (!lower_content.has_value()) {
+        std::ifstream file(meta.file_path, std::ios::binary);
+        lower_content = toLower(std::string(std::istreambuf_iterator<char>(file), {}));
+      }
+      std::string needle = leaf.value;
+      if (!needle.empty() && needle.back() == '*') {
+        needle.pop_back();
+      }
+      return lower_content->find(toLower(needle)) != std::string::npos;
+    };
+    QueryExpr::Facts facts{meta.title, meta.tags, meta.notebook, meta.created, meta.modified};
+    if (!query.expr->matches(facts, text_test)) {
+      return false;
+    }
+  }
+  
+  return true;
+}
+
+double NoteManifest::score(const Entry& meta, const SearchQuery& query, size_t match_count) {
+  // Match density carries most of the weight; rg caps matches per file
+  double score = 0.5 * static_cast<double>(std::min<size_t>(match_count, 10)) / 10.0;
+  
+  // Boost score for title matches
+  if (!query.text.empty()) {
+    std::string lower_title = meta.title;
+    std::string lower_query = query.text;
+    std::transform(lower_title.begin(), lower_title.end(), lower_title.begin(), ::tolower);
+    std::transform(lower_query.begin(), lower_query.end(), lower_query.begin(), ::tolower);
+    
+    if (lower_title.find(lower_query) != std::string::npos) {
+      score += 0.3;
+    }
+  }
+  
+  // Boost score for tag matches
+  for (const auto& tag : query.tags) {
+    if (std::find(meta.tags.begin(), meta.tags.end(), tag) != meta.tags.end()) {
+      score += 0.1;
+    }
+  }
+  
+  // Boost score for recent notes
+  auto now = std::chrono::system_clock::now();
+  auto days_old = std::chrono::duration_cast<std::chrono::hours>(now - meta.modified).count() / 24;
+  if (days_old < 30) {
+    score += 0.1 * (30 - days_old) / 30.0;
+  }
+  
+  return std::min(score, 1.0);
+}
+
+std::vector<std::string> NoteManifest::suggestTags(const std::string& prefix, size_t limit) const {
+  std::unordered_map<std::string, size_t> tag_counts;
+  
+  for (const auto& [id, meta] : entries_) {
+    for (const auto& tag : meta.tags) {
+      if (tag.starts_with(prefix)) {
+        tag_counts[tag]++;
+      }
+    }
+  }
+  
+  // Most frequently used tags first, matching the SQLite backend
+  std::vector<std::pair<std::string, size_t>> ranked(tag_counts.begin(), tag_counts.end());
+  std::sort(ranked.begin(), ranked.end(), [](const auto& a, const auto& b) {
+    return a.second != b.second ? a.second > b.second : a.first < b.first;
+  });
+  
+  std::vector<std::string> suggestions;
+  for (const auto& [tag, count] : ranked) {
+    if (suggestions.size() >= limit) {
+      break;
+    }
+    suggestions.push_back(tag);
+  }
+  
+  return suggestions;
+}
+
+std::vector<TagCount> NoteManifest::tagCounts() const {
+  std::map<std::string, size_t> tag_counts;
+  
+  for (const auto& [id, meta] : entries_) {
+    for (const auto& tag : meta.tags) {
+      tag_counts[tag]++;
+    }
+  }
+  
+  std::vector<TagCount> counts;
+  counts.reserve(tag_counts.size());
+  for (const auto& [tag, count] : tag_counts) {
+    counts.push_back({tag, count});
+  }
+  
+  return counts;
+}
+
+std::vector<std::string> NoteManifest::suggestNotebooks(const std::string& prefix, size_t limit) const {
+  std::set<std::string> unique_notebooks;
+  
+  for (const auto& [id, meta] : entries_) {
+    if (meta.notebook.has_value() && meta.notebook->starts_with(prefix)) {
+      unique_notebooks.insert(*meta.notebook);
+    }
+  }
+  
+  std::vector<std::string> suggestions(unique_notebooks.begin(), unique_notebooks.end());
+  
+  if (suggestions.size() > limit) {
+    suggestions.resize(limit);
+  }
+  
+  return suggestions;
+}
+
+IndexStats NoteManifest::stats() const {
+  IndexStats stats;
+  stats.total_notes = entries_.size();
+  stats.total_words = 0;
+  stats.last_updated = std::chrono::system_clock::time_point{};
+  
+  for (const auto& [id, meta] : entries_) {
+    stats.total_words += meta.word_count;
+    if (meta.modified > stats.last_updated) {
+      stats.last_updated = meta.modified;
+    }
+  }
+  
+  // Calculate approximate size of notes directory
+  std::error_code ec;
+  stats.index_size_bytes = 0;
+  for (const auto& entry : std::filesystem::recursive_directory_iterator(notes_dir_, ec)) {
+    if (!ec && entry.is_regular_file()) {
+      auto size = std::filesystem::file_size(entry.path(), ec);
+      if (!ec) {
+        stats.index_size_bytes += size;
+      }
+    }
+  }
+  
+  return stats;
+}
+
+SearchResult NoteManifest::toResult(const Entry& entry) {
+  SearchResult result;
+  result.id = entry.id;
+  result.title = entry.title;
+  result.modified = entry.modified;
+  result.tags = entry.tags;
+  result.notebook = entry.notebook;
+  result.score = 1.0;
+  return result;
+}
+
+Result<NoteManifest::Entry> NoteManifest::parseNoteFile(const std::filesystem::path& file_path) {
+  std::ifstream file(file_path);
+  if (!file) {
+    return std::unexpected(makeError(ErrorCode::kFileError,
+                                     "Cannot read file: " + file_path.string()));
+  }
+  
+  Entry meta;
+  meta.file_path = file_path;
+  
+  // Notes are stored as <ULID>-<slug>.md; otherwise the front matter id is used
+  std::string filename = file_path.stem().string();
+  auto id_result = nx::core::NoteId::fromString(filename.substr(0, 26));
+  if (id_result.has_value()) {
+    meta.id = *id_result;
+  }
+  bool has_id = id_result.has_value();
+  
+  // Parse front matter and content
+  std::string line;
+  bool in_frontmatter = false;
+  bool found_frontmatter = false;
+  std::ostringstream content_stream;
+  
+  while (std::getline(file, line)) {
+    if (line == "---") {
+      if (!found_frontmatter) {
+        in_frontmatter = true;
+        found_frontmatter = true;
+        continue;
+      } else if (in_frontmatter) {
+        in_frontmatter = false;
+        continue;
+      }
+    }
+    
+    if (in_frontmatter) {
+      // Parse YAML front matter
+      if (line.starts_with("id:") && !has_id) {
+        auto front_matter_id = nx::core::NoteId::fromString(
+            std::regex_replace(line.substr(3), std::regex("^\\s*[\"']?|[\"']?\\s*$"), ""));
+        if (front_matter_id.has_value()) {
+          meta.id = *front_matter_id;
+          has_id = true;
+        }
+      } else if (line.starts_with("title:")) {
+        meta.title = line.substr(6);
+        // Trim whitespace and quotes
+        meta.title = std::regex_replace(meta.title, std::regex("^\\s*[\"']?|[\"']?\\s*$"), "");
+      } else if (line.starts_with("tags:")) {
+        // Parse tags array - simplified parsing
+        std::string tags_str = line.substr(5);
+        std::regex tag_regex(R"([a-zA-Z_][a-zA-Z0-9_-]*)");
+        std::sregex_iterator iter(tags_str.begin(), tags_str.end(), tag_regex);
+        std::sregex_iterator end;
+        
+        for (; iter != end; ++iter) {
+          meta.tags.push_back(iter->str());
+        }
+      } else if (line.starts_with("notebook:")) {
+        std::string notebook = line.substr(9);
+        notebook = std::regex_replace(notebook, std::regex("^\\s*[\"']?|[\"']?\\s*$"), "");
+        if (!notebook.empty()) {
+          meta.notebook = notebook;
+        }
+      }
+    } else {
+      content_stream << line << "\n";
+    }
+  }
+  
+  if (!has_id) {
+    // Generate a new ID if neither the filename nor the front matter has one
+    meta.id = nx::core::NoteId::generate();
+  }
+  
+  // If no title found, use first line of content or filename
+  if (meta.title.empty()) {
+    std::string content = content_stream.str();
+    std::istringstream content_iss(content);
+    if (std::getline(content_iss, line)) {
+      // Remove markdown formatting from first line
+      meta.title = std::regex_replace(line, std::regex("^#+\\s*"), "");
+      if (meta.title.empty()) {
+        meta.title = file_path.stem().string();
+      }
+    }
+  }
+  
+  // Calculate word count
+  std::string content = content_stream.str();
+  std::istringstream iss(content);
+  meta.word_count = std::distance(std::istream_iterator<std::string>(iss),
+                                  std::istream_iterator<std::string>());
+  
+  // Get file timestamps
+  std::error_code ec;
+  auto file_time = std::filesystem::last_write_time(file_path, ec);
+  if (!ec) {
+    auto sctp = std::chrono::time_point_cast<std::chrono::system_clock::duration>(
+        file_time - std::filesystem::file_time_type::clock::now() + std::chrono::system_clock::now());
+    meta.modified = sctp;
+    meta.created = sctp; // We don't have creation time, use modification time
+  } else {
+    meta.created = meta.modified = std::chrono::system_clock::now();
+  }
+  
+  return meta;
+}
+
+std::unordered_map<std::string, NoteManifest::Entry> NoteManifest::loadPersisted() const {
+  std::unordered_map<std::string, Entry> entries;
+  if (cache_file_.empty()) {
+    return entries;
+  }
+  
+  std::ifstream file(cache_file_);
+  if (!file) {
+    return entries;
+  }
+  
+  auto json = nlohmann::json::parse(file, nullptr, false);
+  if (json.is_discarded() || json.value("version", 0) != kManifestVersion ||
+      json.value("notes_dir", "") != notes_dir_.string()) {
+    return entries;
+  }
+  
+  for (const auto& item : json.value("notes", nlohmann::json::array())) {
+    auto id = nx::core::NoteId::fromString(item.value("id", ""));
+    if (!id.has_value()) {
+      continue;
+    }
+    
+    Entry meta;
+    meta.id = *id;
+    meta.title = item.value("title", "");
+    meta.file_path = item.value("path", "");
+    meta.created = std::chrono::system_clock::time_point(
+        std::chrono::system_clock::duration(item.value("created", int64_t{0})));
+    meta.modified = std::chrono::system_clock::time_point(
+        std::chrono::system_clock::duration(item.value("modified", int64_t{0})));
+    meta.tags = item.value("tags", std::vector<std::string>{});
+    if (item.contains("notebook") && item["notebook"].is_string()) {
+      meta.notebook = item["notebook"].get<std::string>();
+    }
+    meta.word_count = item.value("word_count", size_t{0});
+    meta.file_mtime = item.value("mtime", int64_t{0});
+    meta.file_size = item.value("size", uintmax_t{0});
+    
+    entries[meta.file_path.string()] = std::move(meta);
+  }
+  
+  return entries;
+}
+
+void NoteManifest::savePersisted() const {
+  if (cache_file_.empty()) {
+    return;
+  }
+  
+  nlohmann::json notes = nlohmann::json::array();
+  for (const auto& [id, meta] : entries_) {
+    // Notes added through the API have no file state yet; the next scan parses them
+    if (meta.file_mtime == 0) {
+      continue;
+    }
+    
+    nlohmann::json item;
+    item["id"] = id;
+    item["title"] = meta.title;
+    item["path"] = meta.file_path.string();
+    item["created"] = static_cast<int64_t>(meta.created.time_since_epoch().count());
+    item["modified"] = static_cast<int64_t>(meta.modified.time_since_epoch().count());
+    item["tags"] = meta.tags;
+    item["notebook"] = meta.notebook.has_value() ? nlohmann::json(*meta.notebook) : nlohmann::json();
+    item["word_count"] = meta.word_count;
+    item["mtime"] = meta.file_mtime;
+    item["size"] = meta.file_size;
+    notes.push_back(std::move(item));
+  }
+  
+  nlohmann::json json;
+  json["version"] = kManifestVersion;
+  json["notes_dir"] = notes_dir_.string();
+  json["notes"] = std::move(notes);
+  
+  // Write-then-rename so a crash never leaves a truncated cache behind
+  std::error_code ec;
+  std::filesystem::create_directories(cache_file_.parent_path(), ec);
+  auto temp_path = cache_file_;
+  temp_path += ".tmp";
+  {
+    std::ofstream file(temp_path, std::ios::trunc);
+    if (!file) {
+      return;
+    }
+    file << json.dump();
+    if (!file) {
+      return;
+    }
+  }
+  std::filesystem::rename(temp_path, cache_file_, ec);
+}
+
+std::string markedLineSnippet(std::string_view line,
+                              const std::vector<std::pair<size_t, size_t>>& spans) {
+  std::string_view body = line;
+  while (!body.empty() && (body.back() == '\n' || body.back() == '\r')) {
+    body.remove_suffix(1);
+  }
+  
+  size_t window_start = 0;
+  size_t window_end = body.size();
+  if (body.size() > kSnippetLength) {
+    size_t anchor = spans.empty() ? 0 : spans.front().first;
+    window_start = anchor > kSnippetLength / 2 ? anchor - kSnippetLength / 2 : 0;
+    window_end = std::min(body.size(), window_start + kSnippetLength);
+  }
+  
+  std::string snippet = window_start > 0 ? "..." : "";
+  size_t pos = window_start;
+  for (const auto& [start, end] : spans) {
+    if (start < pos || start >= end || end > window_end) {
+      continue;
+    }
+    snippet += body.substr(pos, start - pos);
+    snippet += "<mark>";
+    snippet += body.substr(start, end - start);
+    snippet += "</mark>";
+    pos = end;
+  }
+  snippet += body.substr(pos, window_end - pos);
+  if (window_end < body.size()) {
+    snippet += "...";
+  }
+  return snippet;
+}
+
+}  // namespace nx::index
@@ -0,0 +1,203 @@
+#include "nx/index/posting_list.hpp"
+
+#include <algorithm>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace nx::index {
+
+namespace {
+
+void putVarint(std::vector<uint8_t>& out, uint32_t value) {
+  while (value >= 0x80) {
+    out.push_back(static_cast<uint8_t>(value | 0x80));
+    value >>= 7;
+  }
+  out.push_back(static_cast<uint8_t>(value));
+}
+
+uint32_t getVarint(const uint8_t*& p) {
+  uint32_t value = 0;
+  int shift = 0;
+  while (*p & 0x80) {
+    value |= static_cast<uint32_t>(*p++ & 0x7F) << shift;
+    shift += 7;
+  }
+  value |= static_cast<uint32_t>(*p++) << shift;
+  return value;
+}
+
+}  // namespace
+
+// PostingList
+
+void PostingList::append(uint32_t doc, uint32_t tf, uint32_t doc_length) {
+  if (count_ % kBlockSize == 0) {
+    Block block;
+    block.offset = static_cast<uint32_t>(bytes_.size());
+    blocks_.push_back(block);
+  }
+
+  // The first delta of a block is relative to the previous block's last document
+  putVarint(bytes_, doc - last_doc_);
+  putVarint(bytes_, tf);
+
+  Block& block = blocks_.back();
+  block.last_doc = doc;
+  block.max_tf = std::max(block.max_tf, tf);
+  block.min_length = std::min(block.min_length, doc_length);
+
+  last_doc_ = doc;
+  max_tf_ = std::max(max_tf_, tf);
+  min_length_ = std::min(min_length_, doc_length);
+  ++count_;
+}
+
+size_t PostingList::decodeBlock(size_t block, uint32_t* docs, uint32_t* tfs) const {
+  if (block >= blocks_.size()) {
+    return 0;
+  }
+
+  size_t n = block + 1 < blocks_.size() ? kBlockSize : count_ - block * kBlockSize;
+  const uint8_t* p = bytes_.data() + blocks_[block].offset;
+  uint32_t doc = block > 0 ? blocks_[block - 1].last_doc : 0;
+  for (size_t i = 0; i < n; ++i) {
+    doc += getVarint(p);
+    docs[i] = doc;
+    tfs[i] = getVarint(p);
+  }
+  return n;
+}
+
+void PostingList::assign(std::vector<Block> blocks, std::vector<uint8_t> bytes, size_t count) {
+  blocks_ = std::move(blocks);
+  bytes_ = std::move(bytes);
+  count_ = count;
+  last_doc_ = blocks_.empty() ? 0 : blocks_.back().last_doc;
+  max_tf_ = 0;
+  min_length_ = UINT32_MAX;
+  for (const auto& block : blocks_) {
+    max_tf_ = std::max(max_tf_, block.max_tf);
+    min_length_ = std::min(min_length_, block.min_length);
+  }
+}
+
+// PostingCursor
+
+PostingCursor::PostingCursor(const PostingList& list) : list_(&list) {
+  load(0);
+}
+
+void PostingCursor::load(size_t block) {
+  block_ = block;
+  shallow_block_ = block;
+  pos_ = 0;
+  block_size_ = list_->decodeBlock(block, docs_.data(), tfs_.data());
+  doc_ = block_size_ > 0 ? docs_[0] : kEnd;
+}
+
+void PostingCursor::next() {
+  if (++pos_ < block_size_) {
+    doc_ = docs_[pos_];
+  } else {
+    load(block_ + 1);
+  }
+}
+
+void PostingCursor::seek(uint32_t target) {
+  if (atEnd() || doc_ >= target) {
+    return;
+  }
+
+  const auto& blocks = list_->blocks();
+  if (blocks[block_].last_doc < target) {
+    auto it = std::lower_bound(blocks.begin() + static_cast<std::ptrdiff_t>(block_ + 1), blocks.end(),
+                               target, [](const PostingList::Block& block, uint32_t value) {
+                                 return block.last_doc < value;
+                               });
+    load(static_cast<size_t>(it - blocks.begin()));
+    if (atEnd()) {
+      return;
+    }
+  }
+
+  const uint32_t* found = std::lower_bound(docs_.data() + pos_, docs_.data() + block_size_, target);
+  pos_ = static_cast<size_t>(found - docs_.data());
+  doc_ = docs_[pos_];
+}
+
+void PostingCursor::shallowSeek(uint32_t target) {
+  const auto& blocks = list_->blocks();
+  size_t from = std::max(block_, shallow_block_);
+  if (from >= blocks.size() || blocks[from].last_doc >= target) {
+    shallow_block_ = from;
+    return;
+  }
+  auto it = std::lower_bound(blocks.begin() + static_cast<std::ptrdiff_t>(from), blocks.end(),
+                             target, [](const PostingList::Block& block, uint32_t value) {
+                               return block.last_doc < value;
+                             });
+  shallow_block_ = static_cast<size_t>(it - blocks.begin());
+}
+
+const PostingList::Block* PostingCursor::block() const {
+  const auto& blocks = list_->blocks();
+  return shallow_block_ < blocks.size() ? &blocks[shallow_block_] : nullptr;
+}
+
+uint32_t PostingCursor::blockLast() const {
+  const auto* current = block();
+  return current ? current->last_doc : kEnd;
+}
+
+void PostingCursor::nextBlock() {
+  load(block_ + 1);
+}
+
+// Intersection
+
+size_t intersectSorted(const uint32_t* a, size_t na, const uint32_t* b, size_t nb,
+                       uint32_t* a_index, uint32_t* b_index) {
+  size_t matches = 0;
+  size_t j = 0;
+
+  for (size_t i = 0; i < na && j < nb; ++i) {
+    const uint32_t value = a[i];
+
+    while (j + 16 <= nb && b[j + 15] < value) {
+      j += 16;
+    }
+
+#if defined(__SSE2__)
+    if (j + 16 <= nb) {
+      // b[j + 15] >= value: the lanes below value form a prefix; count them
+      const __m128i needle = _mm_set1_epi32(static_cast<int>(value));
+      const auto* lanes = reinterpret_cast<const __m128i*>(b + j);
+      int below = 0;
+      for (int k = 0; k < 4; ++k) {
+        __m128i lt = _mm_cmplt_epi32(_mm_loadu_si128(lanes + k), needle);
+        below += __builtin_popcount(static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(lt))));
+      }
+      j += static_cast<size_t>(below);
+    } else
+#endif
+    {
+      while (j < nb && b[j] < value) {
+        ++j;
+      }
+    }
+
+    if (j < nb && b[j] == value) {
+      a_index[matches] = static_cast<uint32_t>(i);
+      b_index[matches] = static_cast<uint32_t>(j);
+      ++matches;
+      ++j;
+    }
+  }
+
+  return matches;
+}
+
+}  // namespace nx::index
@@ -0,0 +1,239 @@
+#include "nx/index/query_expr.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <ctime>
+#include <iomanip>
+#include <sstream>
+
+namespace nx::index {
+
+namespace {
+
+QueryExpr leaf(QueryExpr::Kind kind, std::string value) {
+  QueryExpr expr;
+  expr.kind = kind;
+  expr.value = std::move(value);
+  return expr;
+}
+
+QueryExpr range(QueryExpr::Kind kind, std::optional<QueryExpr::TimePoint> from,
+                std::optional<QueryExpr::TimePoint> to) {
+  QueryExpr expr;
+  expr.kind = kind;
+  expr.from = from;
+  expr.to = to;
+  return expr;
+}
+
+QueryExpr group(QueryExpr::Kind kind, std::vector<QueryExpr> children) {
+  QueryExpr expr;
+  expr.kind = kind;
+  for (auto& child : children) {
+    if (child.kind == kind) {
+      for (auto& grandchild : child.children) {
+        expr.children.push_back(std::move(grandchild));
+      }
+    } else {
+      expr.children.push_back(std::move(child));
+    }
+  }
+  if (expr.children.size() == 1) {
+    return std::move(expr.children[0]);
+  }
+  return expr;
+}
+
+// Word characters as the indexes tokenize them; bytes of multi-byte UTF-8 count as letters
+bool isWordChar(char c) {
+  auto uc = static_cast<unsigned char>(c);
+  return std::isalnum(uc) || c == '_' || uc >= 0x80;
+}
+
+std::vector<std::string> words(std::string_view text) {
+  std::vector<std::string> out;
+  for (size_t i = 0; i < text.size();) {
+    if (!isWordChar(text[i])) {
+      ++i;
+      continue;
+    }
+    std::string word;
+    for (; i < text.size() && isWordChar(text[i]); ++i) {
+      word += static_cast<char>(std::tolower(static_cast<unsigned char>(text[i])));
+    }
+    out.push_back(std::move(word));
+  }
+  return out;
+}
+
+bool inRange(const QueryExpr& expr, QueryExpr::TimePoint time) {
+  return (!expr.from || time >= *expr.from) && (!expr.to || time < *expr.to);
+}
+
+std::string quoted(const std::string& value) {
+  bool plain = !value.empty() && std::none_of(value.begin(), value.end(), [](char c) {
+    return std::isspace(static_cast<unsigned char>(c)) || c == '"' || c == '(' || c == ')' || c == ':';
+  });
+  if (plain && value != "OR" && value != "AND" && value != "NOT" && value.front() != '-') {
+    return value;
+  }
+  std::string out = "\"";
+  for (char c : value) {
+    if (c != '"') {
+      out += c;
+    }
+  }
+  return out + "\"";
+}
+
+// Local calendar date; an exclusive bound at midnight prints as the day before
+std::string formatDay(QueryExpr::TimePoint time, bool exclusive_end) {
+  if (exclusive_end) {
+    time -= std::chrono::milliseconds(1);
+  }
+  std::time_t seconds = std::chrono::system_clock::to_time_t(time);
+  std::tm tm{};
+  localtime_r(&seconds, &tm);
+  std::ostringstream out;
+  out << std::put_time(&tm, "%Y-%m-%d");
+  return out.str();
+}
+
+}  // namespace
+
+QueryExpr QueryExpr::text(std::string value) {
+  return leaf(Kind::kText, std::move(value));
+}
+
+QueryExpr QueryExpr::title(std::string value) {
+  return leaf(Kind::kTitle, std::move(value));
+}
+
+QueryExpr QueryExpr::tag(std::string value) {
+  return leaf(Kind::kTag, std::move(value));
+}
+
+QueryExpr QueryExpr::notebook(std::string value) {
+  return leaf(Kind::kNotebook, std::move(value));
+}
+
+QueryExpr QueryExpr::created(std::optional<TimePoint> from, std::optional<TimePoint> to) {
+  return range(Kind::kCreated, from, to);
+}
+
+QueryExpr QueryExpr::modified(std::optional<TimePoint> from, std::optional<TimePoint> to) {
+  return range(Kind::kModified, from, to);
+}
+
+QueryExpr QueryExpr::allOf(std::vector<QueryExpr> children) {
+  return group(Kind::kAnd, std::move(children));
+}
+
+QueryExpr QueryExpr::anyOf(std::vector<QueryExpr> children) {
+  return group(Kind::kOr, std::move(children));
+}
+
+QueryExpr QueryExpr::negate(QueryExpr child) {
+  if (child.kind == Kind::kNot) {
+    return std::move(child.children[0]);
+  }
+  QueryExpr expr;
+  expr.kind = Kind::kNot;
+  expr.children.push_back(std::move(child));
+  return expr;
+}
+
+bool QueryExpr::hasText() const {
+  if (kind == Kind::kText) {
+    return true;
+  }
+  return std::any_of(children.begin(), children.end(), [](const QueryExpr& child) {
+    return child.hasText();
+  });
+}
+
+bool QueryExpr::matches(const Facts& facts, const TextTest& text_test) const {
+  switch (kind) {
+    case Kind::kAnd:
+      return std::all_of(children.begin(), children.end(), [&](const QueryExpr& child) {
+        return child.matches(facts, text_test);
+      });
+    case Kind::kOr:
+      return std::any_of(children.begin(), children.end(), [&](const QueryExpr& child) {
+        return child.matches(facts, text_test);
+      });
+    case Kind::kNot:
+      return !children[0].matches(facts, text_test);
+    case Kind::kText:
+      return text_test && text_test(*this);
+    case Kind::kTitle:
+      return titleMatches(facts.title, value);
+    case Kind::kTag:
+      return std::find(facts.tags.begin(), facts.tags.end(), value) != facts.tags.end();
+    case Kind::kNotebook:
+      return facts.notebook.has_value() && *facts.notebook == value;
+    case Kind::kCreated:
+      return inRange(*this, facts.created);
+    case Kind::kModified:
+      return inRange(*this, facts.modified);
+  }
+  return false;
+}
+
+bool QueryExpr::titleMatches(std::string_view title, std::string_view value) {
+  bool prefix = value.ends_with('*');
+  auto wanted = words(value);
+  if (wanted.empty()) {
+    return false;
+  }
+  auto have = words(title);
+  auto same = [&](const std::string& word, const std::string& target) {
+    return prefix && &target == &wanted.back() ? word.starts_with(target) : word == target;
+  };
+  return std::search(have.begin(), have.end(), wanted.begin(), wanted.end(), same) != have.end();
+}
+
+std::string QueryExpr::toString() const {
+  switch (kind) {
+    case Kind::kAnd:
+    case Kind::kOr: {
+      std::string out;
+      for (const auto& child : children) {
+        if (!out.empty()) {
+          out += kind == Kind::kAnd ? " " : " OR ";
+        }
+        // OR binds looser than AND, so an OR inside an AND needs its parentheses
+        bool wrap = kind == Kind::kAnd && child.kind == Kind::kOr;
+        out += wrap ? "(" + child.toString() + ")" : child.toString();
+      }
+      return out;
+    }
+    case Kind::kNot: {
+      const auto& child = children[0];
+      return child.isBoolean() ? "-(" + child.toString() + ")" : "-" + child.toString();
+    }
+    case Kind::kText:
+      return quoted(value);
+    case Kind::kTitle:
+      return "title:" + quoted(value);
+    case Kind::kTag:
+      return "tag:" + quoted(value);
+    case Kind::kNotebook:
+      return "notebook:" + quoted(value);
+    case Kind::kCreated:
+    case Kind::kModified: {
+      std::string out = kind == Kind::kCreated ? "created:" : "modified:";
+      if (from) {
+        out += formatDay(*from, false);
+      }
+      out += "..";
+      if (to) {
+        out += formatDay(*to, true);
+      }
+      return out;
+    }
+  }
+  return "";
+}
+
+}  // namespace nx::index
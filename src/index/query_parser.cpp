@@ -4,6 +4,7 @@
 #include <sstream>
 #include <algorithm>
 #include <iomanip>
+#include <stdexcept>
 
 namespace nx::index {
 
@@ -12,9 +13,27 @@ Result<SearchQuery> QueryParser::parse(const std::string& query_str) {
     return SearchQuery{}; // Empty query
   }
   
+  auto expr = parseExpr(query_str);
+  if (!expr.has_value()) {
+    return std::unexpected(expr.error());
+  }
+  return buildQuery(*expr);
+}
+
+Result<QueryExpr> QueryParser::parseExpr(const std::string& query_str) {
   try {
     auto tokens = tokenize(query_str);
-    return buildQuery(tokens);
+    
+    // A stray ')' closes nothing; keep parsing after it
+    std::vector<QueryExpr> parts;
+    size_t pos = 0;
+    while (pos < tokens.size()) {
+      parts.push_back(parseOr(tokens, pos));
+      if (pos < tokens.size()) {
+        ++pos;
+      }
+    }
+    return QueryExpr::allOf(std::move(parts));
   } catch (const std::exception& e) {
     return std::unexpected(makeError(ErrorCode::kParseError, 
                                      "Query parse error: " + std::string(e.what())));
@@ -25,10 +44,10 @@ std::vector<QueryParser::Token> QueryParser::tokenize(const std::string& query_s
   std::vector<Token> tokens;
   
   // Regex patterns for different token types
-  std::regex field_regex("(-?)(\\w+):([^:\\s]+(?:\\.\\.[^:\\s]+)?)");
+  std::regex field_regex("(-?)(\\w+):([^:\\s()]+)");
   std::regex quoted_regex("(-?)(\\w+):\"([^\"]*)\"");
-  std::regex simple_quoted_regex("\"([^\"]*)\"");
-  std::regex word_regex("\\S+");
+  std::regex simple_quoted_regex("(-?)\"([^\"]*)\"");
+  std::regex word_regex("(-?)([^\\s()]+)");
   
   std::string remaining = query_str;
   std::smatch match;
@@ -41,6 +60,17 @@ std::vector<QueryParser::Token> QueryParser::tokenize(const std::string& query_s
     
     bool matched = false;
     
+    // Grouping: ( -( )
+    if (remaining[0] == '(' || remaining[0] == ')' || remaining.rfind("-(", 0) == 0) {
+      Token token;
+      token.type = remaining[0] == ')' ? Token::kClose : Token::kOpen;
+      token.negated = remaining[0] == '-';
+      tokens.push_back(token);
+      
+      remaining = remaining.substr(token.negated ? 2 : 1);
+      continue;
+    }
+    
     // Try quoted field pattern: [(-)]field:"value"
     if (std::regex_search(remaining, match, quoted_regex)) {
       if (match.position() == 0) {
@@ -51,7 +81,7 @@ std::vector<QueryParser::Token> QueryParser::tokenize(const std::string& query_s
         token.value = match[3].str();
         tokens.push_back(token);
         
-        remaining = remaining.substr(match.length());
+        remaining = remaining.substr(static_cast<size_t>(match.length()));
         matched = true;
       }
     }
@@ -64,7 +94,7 @@ std::vector<QueryParser::Token> QueryParser::tokenize(const std::string& query_s
         token.field = match[2].str();
         std::string value = match[3].str();
         
-        // Check for range syntax (value..value2)
+        // Check for range syntax (value..value2, either end may be open)
         size_t range_pos = value.find("..");
         if (range_pos != std::string::npos) {
           token.type = Token::kRange;
@@ -76,33 +106,43 @@ std::vector<QueryParser::Token> QueryParser::tokenize(const std::string& query_s
         }
         
         tokens.push_back(token);
-        remaining = remaining.substr(match.length());
+        remaining = remaining.substr(static_cast<size_t>(match.length()));
         matched = true;
       }
     }
     
-    // Try simple quoted text: "value"
+    // Try simple quoted text: [(-)]"value"
     if (!matched && std::regex_search(remaining, match, simple_quoted_regex)) {
       if (match.position() == 0) {
         Token token;
         token.type = Token::kQuoted;
-        token.value = match[1].str();
+        token.negated = !match[1].str().empty();
+        token.value = match[2].str();
         tokens.push_back(token);
         
-        remaining = remaining.substr(match.length());
+        remaining = remaining.substr(static_cast<size_t>(match.length()));
         matched = true;
       }
     }
     
-    // Try regular word
+    // Try regular word, or an operator keyword
     if (!matched && std::regex_search(remaining, match, word_regex)) {
       if (match.position() == 0) {
         Token token;
         token.type = Token::kText;
-        token.value = match[0].str();
-        tokens.push_back(token);
+        token.negated = !match[1].str().empty();
+        token.value = match[2].str();
+        if (!token.negated && token.value == "OR") {
+          token.type = Token::kOr;
+        } else if (!token.negated && token.value == "NOT") {
+          token.type = Token::kNot;
+        }
+        // AND is implied between terms
+        if (token.negated || token.value != "AND") {
+          tokens.push_back(token);
+        }
         
-        remaining = remaining.substr(match.length());
+        remaining = remaining.substr(static_cast<size_t>(match.length()));
         matched = true;
       }
     }
@@ -116,63 +156,157 @@ std::vector<QueryParser::Token> QueryParser::tokenize(const std::string& query_s
   return tokens;
 }
 
-SearchQuery QueryParser::buildQuery(const std::vector<Token>& tokens) {
+QueryExpr QueryParser::parseOr(const std::vector<Token>& tokens, size_t& pos) {
+  std::vector<QueryExpr> alternatives;
+  while (true) {
+    auto branch = parseAnd(tokens, pos);
+    // "a OR" or "OR b": an empty side would match everything
+    if (!(branch.kind == QueryExpr::Kind::kAnd && branch.children.empty())) {
+      alternatives.push_back(std::move(branch));
+    }
+    if (pos < tokens.size() && tokens[pos].type == Token::kOr) {
+      ++pos;
+      continue;
+    }
+    break;
+  }
+  return alternatives.empty() ? QueryExpr{} : QueryExpr::anyOf(std::move(alternatives));
+}
+
+QueryExpr QueryParser::parseAnd(const std::vector<Token>& tokens, size_t& pos) {
+  std::vector<QueryExpr> terms;
+  while (pos < tokens.size() && tokens[pos].type != Token::kClose && tokens[pos].type != Token::kOr) {
+    if (tokens[pos].type == Token::kNot) {
+      ++pos;
+      if (pos < tokens.size() && tokens[pos].type != Token::kClose && tokens[pos].type != Token::kOr) {
+        terms.push_back(QueryExpr::negate(parseUnary(tokens, pos)));
+      }
+      continue;
+    }
+    terms.push_back(parseUnary(tokens, pos));
+  }
+  return QueryExpr::allOf(std::move(terms));
+}
+
+QueryExpr QueryParser::parseUnary(const std::vector<Token>& tokens, size_t& pos) {
+  const Token& token = tokens[pos++];
+  if (token.type != Token::kOpen) {
+    auto leaf = toLeaf(token);
+    return token.negated ? QueryExpr::negate(std::move(leaf)) : leaf;
+  }
+  
+  auto group = parseOr(tokens, pos);
+  if (pos < tokens.size() && tokens[pos].type == Token::kClose) {
+    ++pos;
+  }
+  bool empty = group.kind == QueryExpr::Kind::kAnd && group.children.empty();
+  return token.negated && !empty ? QueryExpr::negate(std::move(group)) : group;
+}
+
+QueryExpr QueryParser::toLeaf(const Token& token) {
+  using Clock = std::chrono::system_clock;
+  constexpr auto kDay = std::chrono::hours(24);
+  
+  // Open ends stay unbounded; the end day is included
+  auto dateBound = [kDay](const std::string& value, bool end) -> std::optional<Clock::time_point> {
+    if (value.empty()) {
+      return std::nullopt;
+    }
+    if (!isDateString(value)) {
+      throw std::invalid_argument("invalid date '" + value + "' (expected YYYY-MM-DD)");
+    }
+    auto date = parseDate(value);
+    return end ? date + kDay : date;
+  };
+  
+  if (token.type == Token::kText || token.type == Token::kQuoted) {
+    return QueryExpr::text(token.value);
+  }
+  
+  const std::string& field = token.field;
+  bool created = field == "created";
+  bool modified = field == "modified" || field == "date";
+  
+  if (token.type == Token::kRange) {
+    if (created || modified) {
+      auto from = dateBound(token.value, false);
+      auto to = dateBound(token.value2, true);
+      return created ? QueryExpr::created(from, to) : QueryExpr::modified(from, to);
+    }
+    return QueryExpr::text(field + ":" + token.value + ".." + token.value2);
+  }
+  
+  if (field == "tag") {
+    return QueryExpr::tag(token.value);
+  } else if (field == "notebook") {
+    return QueryExpr::notebook(token.value);
+  } else if (field == "title") {
+    return QueryExpr::title(token.value);
+  } else if (field == "content") {
+    return QueryExpr::text(token.value);
+  } else if (field == "since" || field == "after") {
+    return QueryExpr::modified(dateBound(token.value, false), std::nullopt);
+  } else if (field == "until" || field == "before") {
+    return QueryExpr::modified(std::nullopt, dateBound(token.value, false));
+  } else if (created || modified) {
+    auto day = dateBound(token.value, false);
+    return created ? QueryExpr::created(day, *day + kDay) : QueryExpr::modified(day, *day + kDay);
+  }
+  
+  // Not a field we know (a URL, a time): search for it as written
+  return QueryExpr::text(field + ":" + token.value);
+}
+
+SearchQuery QueryParser::buildQuery(const QueryExpr& expr) {
   SearchQuery query;
   std::vector<std::string> text_parts;
-  std::vector<std::string> exclude_tags;
+  std::vector<QueryExpr> rest;
   
-  for (const auto& token : tokens) {
-    switch (token.type) {
-      case Token::kText:
-      case Token::kQuoted:
-        text_parts.push_back(token.value);
+  // Only conditions every match must meet can move into the plain fields
+  std::vector<QueryExpr> conjuncts;
+  if (expr.kind == QueryExpr::Kind::kAnd) {
+    conjuncts = expr.children;
+  } else {
+    conjuncts.push_back(expr);
+  }
+  
+  for (auto& term : conjuncts) {
+    switch (term.kind) {
+      case QueryExpr::Kind::kText:
+        if (term.value.find_first_of(" \t") != std::string::npos) {
+          text_parts.push_back("\"" + term.value + "\"");
+        } else {
+          text_parts.push_back(term.value);
+        }
+        continue;
+        
+      case QueryExpr::Kind::kTag:
+        query.tags.push_back(term.value);
+        continue;
+        
+      case QueryExpr::Kind::kNotebook:
+        if (!query.notebook.has_value()) {
+          query.notebook = term.value;
+          continue;
+        }
         break;
         
-      case Token::kField:
-        if (token.field == "tag") {
-          if (token.negated) {
-            exclude_tags.push_back(token.value);
-          } else {
-            query.tags.push_back(token.value);
-          }
-        } else if (token.field == "notebook") {
-          if (!token.negated) {
-            query.notebook = token.value;
+      case QueryExpr::Kind::kModified:
+        if ((!term.from || !query.since) && (!term.to || !query.until)) {
+          if (term.from) {
+            query.since = term.from;
           }
-        } else if (token.field == "title") {
-          if (!token.negated) {
-            text_parts.push_back("title:\"" + token.value + "\"");
-          }
-        } else if (token.field == "content") {
-          if (!token.negated) {
-            text_parts.push_back(token.value);
-          }
-        } else if (token.field == "since" || token.field == "after") {
-          if (isDateString(token.value)) {
-            auto date = parseDate(token.value);
-            if (!token.negated) {
-              query.since = date;
-            }
-          }
-        } else if (token.field == "until" || token.field == "before") {
-          if (isDateString(token.value)) {
-            auto date = parseDate(token.value);
-            if (!token.negated) {
-              query.until = date;
-            }
+          if (term.to) {
+            query.until = term.to;
           }
+          continue;
         }
         break;
         
-      case Token::kRange:
-        if (token.field == "date" || token.field == "created" || token.field == "modified") {
-          if (isDateString(token.value) && isDateString(token.value2)) {
-            query.since = parseDate(token.value);
-            query.until = parseDate(token.value2);
-          }
-        }
+      default:
         break;
     }
+    rest.push_back(std::move(term));
   }
   
   // Combine text parts
@@ -185,12 +319,8 @@ SearchQuery QueryParser::buildQuery(const std::vector<Token>& tokens) {
     query.text = oss.str();
   }
   
-  // Handle excluded tags by adding them as negative filters to the query text
-  for (const auto& exclude_tag : exclude_tags) {
-    if (!query.text.empty()) {
-      query.text += " ";
-    }
-    query.text += "-tags:\"" + exclude_tag + "\"";
+  if (!rest.empty()) {
+    query.expr = QueryExpr::allOf(std::move(rest));
   }
   
   return query;
@@ -243,7 +373,7 @@ QueryBuilder& QueryBuilder::tag(const std::string& tag) {
 }
 
 QueryBuilder& QueryBuilder::excludeTag(const std::string& tag) {
-  exclude_tags_.push_back(tag);
+  filters_.push_back(QueryExpr::negate(QueryExpr::tag(tag)));
   return *this;
 }
 
@@ -261,12 +391,12 @@ QueryBuilder& QueryBuilder::title(const std::string& title) {
 }
 
 QueryBuilder& QueryBuilder::createdAfter(std::chrono::system_clock::time_point date) {
-  query_.since = date;
+  filters_.push_back(QueryExpr::created(date, std::nullopt));
   return *this;
 }
 
 QueryBuilder& QueryBuilder::createdBefore(std::chrono::system_clock::time_point date) {
-  query_.until = date;
+  filters_.push_back(QueryExpr::created(std::nullopt, date));
   return *this;
 }
 
@@ -297,15 +427,9 @@ QueryBuilder& QueryBuilder::highlight(bool enable) {
 
 SearchQuery QueryBuilder::build() const {
   SearchQuery result = query_;
-  
-  // Add excluded tags to the text query
-  for (const auto& exclude_tag : exclude_tags_) {
-    if (!result.text.empty()) {
-      result.text += " ";
-    }
-    result.text += "-tags:\"" + exclude_tag + "\"";
+  if (!filters_.empty()) {
+    result.expr = QueryExpr::allOf(filters_);
   }
-  
   return result;
 }
 
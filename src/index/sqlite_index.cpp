@@ -2,17 +2,30 @@
 
 #include <sstream>
 #include <algorithm>
-#include <regex>
+#include <atomic>
+#include <fstream>
 #include <iterator>
 #include <numeric>
+#include <cctype>
+#include <string_view>
+#include <thread>
+#include <sys/stat.h>
 
+#include <nlohmann/json.hpp>
+
+#include "nx/index/trigram_query.hpp"
 #include "nx/util/time.hpp"
+#include "nx/util/timing.hpp"
 
 namespace nx::index {
 
 // SQL schemas and queries
 namespace sql {
 
+// Stamped into PRAGMA user_version together with the schema options; bump when any
+// CREATE statement, migration or backfill below changes
+constexpr int kSchemaVersion = 1;
+
 // Main notes table for metadata
 constexpr const char* kCreateNotesTable = R"(
 CREATE TABLE IF NOT EXISTS notes (
@@ -27,17 +40,90 @@ CREATE TABLE IF NOT EXISTS notes (
 )
 )";
 
-// FTS5 table for full-text search
-constexpr const char* kCreateFtsTable = R"(
-CREATE VIRTUAL TABLE IF NOT EXISTS notes_fts USING fts5(
+// FTS5 table for full-text search. Contentless tables keep only the postings;
+// their rowids come from note_docids and note text is read back through the
+// content provider when a snippet is needed.
+std::string createFtsTable(const std::string& name, SqliteIndex::ContentMode mode,
+                           const std::string& prefix_option) {
+  std::string schema = "CREATE VIRTUAL TABLE IF NOT EXISTS " + name + R"( USING fts5(
   id UNINDEXED,
   title,
   content,
   tags,
-  notebook
+  notebook)";
+  if (mode == SqliteIndex::ContentMode::kContentless) {
+    schema += ",\n  content='',\n  contentless_delete=1";
+  }
+  // Extra prefix indexes so "term*" queries avoid a term-range scan
+  if (!prefix_option.empty()) {
+    schema += ",\n  prefix='" + prefix_option + "'";
+  }
+  return schema + "\n)";
+}
+
+// Value of the prefix='...' option in a stored notes_fts schema ("" if absent)
+std::string prefixOptionOf(const std::string& schema) {
+  constexpr std::string_view kOption = "prefix='";
+  size_t start = schema.find(kOption);
+  if (start == std::string::npos) {
+    return "";
+  }
+  start += kOption.size();
+  size_t end = schema.find('\'', start);
+  return end == std::string::npos ? "" : schema.substr(start, end - start);
+}
+
+// Stable integer keys for contentless FTS rows (INTEGER PRIMARY KEY survives VACUUM)
+constexpr const char* kCreateDocidsTable = R"(
+CREATE TABLE IF NOT EXISTS note_docids (
+  docid INTEGER PRIMARY KEY,
+  note_id TEXT NOT NULL UNIQUE
 )
 )";
 
+// Trigram-tokenized copy of note bodies for substring/regex candidate lookup.
+// detail=none keeps only per-trigram posting lists (no positions), which is all
+// candidate narrowing needs.
+std::string createTrigramTable(bool contentless) {
+  std::string schema = R"(CREATE VIRTUAL TABLE IF NOT EXISTS notes_trigram USING fts5(
+  body,
+  tokenize='trigram',
+  detail='none')";
+  if (contentless) {
+    schema += ",\n  content='',\n  contentless_delete=1";
+  }
+  return schema + "\n)";
+}
+
+// Fill a new notes_trigram from the text already held by a full-content notes_fts
+constexpr const char* kBackfillTrigrams = R"(
+INSERT OR IGNORE INTO note_docids (note_id) SELECT id FROM notes_fts;
+INSERT INTO notes_trigram (rowid, body)
+SELECT d.docid, f.content
+FROM notes_fts f JOIN note_docids d ON d.note_id = f.id
+GROUP BY d.docid;
+)";
+
+// Copy a full-content notes_fts into a rebuilt full-content table (e.g. new prefix
+// lengths) and swap it in
+constexpr const char* kCopyFtsToFull = R"(
+INSERT INTO notes_fts_migrate (id, title, content, tags, notebook)
+SELECT id, title, content, tags, notebook FROM notes_fts;
+DROP TABLE notes_fts;
+ALTER TABLE notes_fts_migrate RENAME TO notes_fts;
+)";
+
+// Move postings from a full-content notes_fts into a contentless one (run between
+// creating notes_fts_migrate and swapping it in)
+constexpr const char* kCopyFtsToContentless = R"(
+INSERT OR IGNORE INTO note_docids (note_id) SELECT id FROM notes_fts;
+INSERT OR REPLACE INTO notes_fts_migrate (rowid, id, title, content, tags, notebook)
+SELECT d.docid, f.id, f.title, f.content, f.tags, f.notebook
+FROM notes_fts f JOIN note_docids d ON d.note_id = f.id;
+DROP TABLE notes_fts;
+ALTER TABLE notes_fts_migrate RENAME TO notes_fts;
+)";
+
 
 // Index for common queries
 constexpr const char* kCreateIndexes = R"(
@@ -46,6 +132,42 @@ CREATE INDEX IF NOT EXISTS idx_notes_modified ON notes(modified);
 CREATE INDEX IF NOT EXISTS idx_notes_notebook ON notes(notebook);
 )";
 
+// Normalized note -> tag relation, one row per tag
+constexpr const char* kCreateNoteTagsTable = R"(
+CREATE TABLE IF NOT EXISTS note_tags (
+  note_id TEXT NOT NULL,
+  tag TEXT NOT NULL,
+  PRIMARY KEY (note_id, tag)
+) WITHOUT ROWID;
+CREATE INDEX IF NOT EXISTS idx_note_tags_tag ON note_tags(tag);
+)";
+
+// Per-tag usage counts, kept in sync with note_tags by triggers
+constexpr const char* kCreateTagStatsTable = R"(
+CREATE TABLE IF NOT EXISTS tag_stats (
+  tag TEXT PRIMARY KEY,
+  count INTEGER NOT NULL DEFAULT 0
+) WITHOUT ROWID;
+CREATE INDEX IF NOT EXISTS idx_tag_stats_nocase ON tag_stats(tag COLLATE NOCASE);
+CREATE INDEX IF NOT EXISTS idx_tag_stats_count ON tag_stats(count DESC, tag);
+CREATE TRIGGER IF NOT EXISTS note_tags_after_insert AFTER INSERT ON note_tags BEGIN
+  INSERT INTO tag_stats(tag, count) VALUES (new.tag, 1)
+    ON CONFLICT(tag) DO UPDATE SET count = count + 1;
+END;
+CREATE TRIGGER IF NOT EXISTS note_tags_after_delete AFTER DELETE ON note_tags BEGIN
+  UPDATE tag_stats SET count = count - 1 WHERE tag = old.tag;
+  DELETE FROM tag_stats WHERE tag = old.tag AND count <= 0;
+END;
+)";
+
+// Populate note_tags from the legacy JSON column (databases created before note_tags existed)
+constexpr const char* kBackfillNoteTags = R"(
+INSERT OR IGNORE INTO note_tags (note_id, tag)
+SELECT notes.id, json_each.value
+FROM notes, json_each(notes.tags)
+WHERE json_valid(notes.tags) AND json_each.value <> ''
+)";
+
 // Performance pragmas
 constexpr const char* kPerformancePragmas = R"(
 PRAGMA journal_mode = WAL;
@@ -55,13 +177,79 @@ PRAGMA temp_store = MEMORY;
 PRAGMA mmap_size = 268435456;  -- 256MB mmap
 )";
 
+// For a shadow database nobody else can see yet: no journal, no fsync, one lock for the whole build
+constexpr const char* kBulkLoadPragmas = R"(
+PRAGMA journal_mode = OFF;
+PRAGMA synchronous = OFF;
+PRAGMA locking_mode = EXCLUSIVE;
+PRAGMA cache_size = -262144;  -- 256MB cache
+)";
+
 } // namespace sql
 
+namespace {
+
+constexpr size_t kMaxRebuildThreads = 8;
+constexpr size_t kFilesPerRebuildThread = 64;
+constexpr int kBusyTimeoutMs = 5000;
+
+// 31-bit FNV-1a, never 0 (the user_version of a database nobody has stamped)
+int32_t stampOf(const std::string& text) {
+  uint32_t hash = 2166136261u;
+  for (char c : text) {
+    hash = (hash ^ static_cast<unsigned char>(c)) * 16777619u;
+  }
+  return static_cast<int32_t>((hash & 0x7fffffffu) | 1u);
+}
+
+// Tags as the JSON array kept in notes.tags and the FTS tags column; json_each() reads it
+// back, so quotes and backslashes in a tag must be escaped
+std::string tagsJson(const std::vector<std::string>& tags) {
+  return nlohmann::json(tags).dump(-1, ' ', false, nlohmann::json::error_handler_t::replace);
+}
+
+// Device and inode, to notice when the database file was replaced underneath a connection
+// The database plus the journal, WAL and shared-memory files SQLite keeps beside it
+void removeDatabaseFiles(const std::filesystem::path& db_path) {
+  std::error_code ec;
+  for (const char* suffix : {"", "-journal", "-wal", "-shm"}) {
+    auto path = db_path;
+    path += suffix;
+    std::filesystem::remove(path, ec);
+  }
+}
+
+}  // namespace
+
 SqliteIndex::SqliteIndex(std::filesystem::path db_path) 
     : db_path_(std::move(db_path)) {
 }
 
+SqliteIndex::SqliteIndex(std::filesystem::path db_path, Config config)
+    : db_path_(std::move(db_path)), config_(std::move(config)) {
+}
+
+bool SqliteIndex::contentlessSupported() {
+  // contentless_delete=1 landed in SQLite 3.43.0
+  return sqlite3_libversion_number() >= 3043000;
+}
+
+bool SqliteIndex::trigramSupported() {
+  // The trigram tokenizer landed in SQLite 3.34.0
+  return sqlite3_libversion_number() >= 3034000;
+}
+
 SqliteIndex::~SqliteIndex() {
+  {
+    std::lock_guard<std::mutex> lock(db_mutex_);
+    (void)flushLocked();
+    stopping_ = true;
+  }
+  flush_cv_.notify_all();
+  if (flusher_.joinable()) {
+    flusher_.join();
+  }
+  
   finalizeStatements();
   if (db_) {
     sqlite3_close(db_);
@@ -82,6 +270,10 @@ Result<void> SqliteIndex::initialize() {
     }
   }
   
+  return openDatabase();
+}
+
+Result<void> SqliteIndex::openDatabase() {
   // Open database
   int result = sqlite3_open(db_path_.string().c_str(), &db_);
   if (result != SQLITE_OK) {
@@ -94,21 +286,70 @@ Result<void> SqliteIndex::initialize() {
     return config_result;
   }
   
-  // Create tables and indexes
-  auto tables_result = createTables();
-  if (!tables_result.has_value()) {
-    return tables_result;
+  // A database this build already set up with the same options needs no FTS5
+  // probe and no DDL, which keeps read-only launches free of write transactions
+  resolveSchemaOptions();
+  bool schema_current = storedSchemaStamp() == schemaStamp();
+  if (!schema_current) {
+    auto tables_result = createTables();
+    if (!tables_result.has_value()) {
+      return tables_result;
+    }
+  }
+  
+  // Statements are prepared on first use
+  registerStatements();
+  
+  // A schema switch that dropped the note text needs the FTS rows rebuilt
+  if (needs_fts_repopulate_) {
+    auto repopulate_result = repopulateFts();
+    if (!repopulate_result.has_value()) {
+      return repopulate_result;
+    }
   }
   
-  // Prepare statements
-  auto prepare_result = prepareStatements();
-  if (!prepare_result.has_value()) {
-    return prepare_result;
+  // Stamp last, so an interrupted migration or repopulate is retried on the next open
+  if (!schema_current) {
+    auto stamp_result = checkSqliteResult(
+        sqlite3_exec(db_, ("PRAGMA user_version = " + std::to_string(schemaStamp())).c_str(),
+                     nullptr, nullptr, nullptr),
+        "Stamp schema version");
+    if (!stamp_result.has_value()) {
+      return stamp_result;
+    }
   }
   
   return {};
 }
 
+void SqliteIndex::resolveSchemaOptions() {
+  content_mode_ = config_.content_mode;
+  if (content_mode_ == ContentMode::kContentless && !contentlessSupported()) {
+    content_mode_ = ContentMode::kFull;
+  }
+  trigram_enabled_ = config_.trigram_index && trigramSupported();
+}
+
+int32_t SqliteIndex::schemaStamp() const {
+  // Everything that decides which tables exist and how they were created
+  std::string options = std::to_string(sql::kSchemaVersion);
+  options += content_mode_ == ContentMode::kContentless ? ";contentless" : ";full";
+  options += ";prefix=" + prefixOption();
+  options += trigram_enabled_ ? ";trigram" : ";no-trigram";
+  options += contentlessSupported() ? ";contentless-delete" : "";
+  return stampOf(options);
+}
+
+int32_t SqliteIndex::storedSchemaStamp() {
+  sqlite3_stmt* stmt = nullptr;
+  if (sqlite3_prepare_v2(db_, "PRAGMA user_version", -1, &stmt, nullptr) != SQLITE_OK) {
+    return 0;
+  }
+  int32_t stamp = sqlite3_step(stmt) == SQLITE_ROW ? sqlite3_column_int(stmt, 0) : 0;
+  sqlite3_finalize(stmt);
+  return stamp;
+}
+
 Result<void> SqliteIndex::configureDatabase() {
   // Execute performance pragmas
   auto result = checkSqliteResult(
@@ -118,6 +359,13 @@ Result<void> SqliteIndex::configureDatabase() {
     return result;
   }
   
+  // Another process may hold a write-behind batch open for up to its batch delay
+  sqlite3_busy_timeout(db_, kBusyTimeoutMs);
+  
+  return {};
+}
+
+Result<void> SqliteIndex::createTables() {
   // Check FTS5 availability by testing virtual table creation
   sqlite3_stmt* stmt;
   int prepare_result = sqlite3_prepare_v2(db_, 
@@ -131,15 +379,40 @@ Result<void> SqliteIndex::configureDatabase() {
   // Clean up test table
   sqlite3_exec(db_, "DROP TABLE IF EXISTS fts5_test", nullptr, nullptr, nullptr);
   
-  return {};
-}
-
-Result<void> SqliteIndex::createTables() {
-  const char* schemas[] = {
+  // Existing databases predating the normalized tag tables need a one-time backfill
+  bool needs_tag_backfill = !tableExists("note_tags");
+  bool needs_trigram_backfill = trigram_enabled_ && !tableExists("notes_trigram");
+  
+  // Content mode and prefix lengths are fixed at CREATE time; rebuild on mismatch
+  auto existing_schema = tableSql("notes_fts");
+  if (existing_schema.has_value()) {
+    ContentMode existing_mode = existing_schema->find("content=''") != std::string::npos
+        ? ContentMode::kContentless : ContentMode::kFull;
+    if (existing_mode != content_mode_ ||
+        sql::prefixOptionOf(*existing_schema) != prefixOption()) {
+      auto migrate_result = migrateFtsTable(existing_mode);
+      if (!migrate_result.has_value()) {
+        return migrate_result;
+      }
+    }
+  }
+  
+  std::string fts_schema = sql::createFtsTable("notes_fts", content_mode_, prefixOption());
+  std::vector<const char*> schemas = {
     sql::kCreateNotesTable,
-    sql::kCreateFtsTable,
-    sql::kCreateIndexes
+    fts_schema.c_str(),
+    sql::kCreateIndexes,
+    sql::kCreateNoteTagsTable,
+    sql::kCreateTagStatsTable
   };
+  if (usesDocids()) {
+    schemas.push_back(sql::kCreateDocidsTable);
+  }
+  // Without contentless_delete the trigram table has to keep its text to support DELETE
+  std::string trigram_schema = sql::createTrigramTable(contentlessSupported());
+  if (trigram_enabled_) {
+    schemas.push_back(trigram_schema.c_str());
+  }
   
   for (const char* schema : schemas) {
     auto result = checkSqliteResult(
@@ -150,16 +423,120 @@ Result<void> SqliteIndex::createTables() {
     }
   }
   
+  if (needs_tag_backfill) {
+    auto result = checkSqliteResult(
+        sqlite3_exec(db_, sql::kBackfillNoteTags, nullptr, nullptr, nullptr),
+        "Backfill note tags");
+    if (!result.has_value()) {
+      return result;
+    }
+  }
+  
+  if (needs_trigram_backfill) {
+    if (content_mode_ == ContentMode::kFull && !needs_fts_repopulate_) {
+      auto result = checkSqliteResult(
+          sqlite3_exec(db_, sql::kBackfillTrigrams, nullptr, nullptr, nullptr),
+          "Backfill trigram index");
+      if (!result.has_value()) {
+        return result;
+      }
+    } else {
+      // No stored text to copy from; the repopulate pass reads it via the provider
+      needs_fts_repopulate_ = true;
+    }
+  }
+  
+  return {};
+}
+
+bool SqliteIndex::tableExists(const std::string& table_name) {
+  return tableSql(table_name).has_value();
+}
+
+std::optional<std::string> SqliteIndex::tableSql(const std::string& table_name) {
+  sqlite3_stmt* stmt = nullptr;
+  int result = sqlite3_prepare_v2(db_,
+      "SELECT sql FROM sqlite_master WHERE type = 'table' AND name = ?", -1, &stmt, nullptr);
+  if (result != SQLITE_OK) {
+    return std::nullopt;
+  }
+  
+  sqlite3_bind_text(stmt, 1, table_name.c_str(), -1, SQLITE_TRANSIENT);
+  std::optional<std::string> schema;
+  if (sqlite3_step(stmt) == SQLITE_ROW) {
+    const unsigned char* text = sqlite3_column_text(stmt, 0);
+    schema = text ? reinterpret_cast<const char*>(text) : "";
+  }
+  sqlite3_finalize(stmt);
+  
+  return schema;
+}
+
+std::string SqliteIndex::prefixOption() const {
+  std::string option;
+  for (int length : config_.prefix_lengths) {
+    // FTS5 accepts prefix lengths 1..999
+    if (length < 1 || length > 999) {
+      continue;
+    }
+    if (!option.empty()) {
+      option += ' ';
+    }
+    option += std::to_string(length);
+  }
+  return option;
+}
+
+Result<void> SqliteIndex::migrateFtsTable(ContentMode from) {
+  std::string migration = "BEGIN IMMEDIATE;\n";
+  if (from == ContentMode::kFull) {
+    // Postings and text are both still here, so copy straight across
+    migration += sql::createFtsTable("notes_fts_migrate", content_mode_, prefixOption()) + ";\n";
+    if (content_mode_ == ContentMode::kContentless) {
+      migration += sql::kCreateDocidsTable;
+      migration += ";\n";
+      migration += sql::kCopyFtsToContentless;
+    } else {
+      migration += sql::kCopyFtsToFull;
+    }
+  } else {
+    // Contentless postings cannot be turned back into text; rebuild from the notes
+    migration += "DROP TABLE notes_fts;\n";
+    migration += sql::createFtsTable("notes_fts", content_mode_, prefixOption()) + ";\n";
+    needs_fts_repopulate_ = true;
+  }
+  migration += "COMMIT;";
+  
+  char* error_message = nullptr;
+  int result = sqlite3_exec(db_, migration.c_str(), nullptr, nullptr, &error_message);
+  if (result != SQLITE_OK) {
+    std::string message = error_message ? error_message : "unknown error";
+    sqlite3_free(error_message);
+    sqlite3_exec(db_, "ROLLBACK", nullptr, nullptr, nullptr);
+    needs_fts_repopulate_ = false;
+    return std::unexpected(makeError(ErrorCode::kDatabaseError,
+                                     "Failed to migrate FTS table: " + message));
+  }
+  
+  // Give the space held by the dropped copy back to the filesystem
+  if (from == ContentMode::kFull) {
+    sqlite3_exec(db_, "VACUUM", nullptr, nullptr, nullptr);
+  }
+  
   return {};
 }
 
-Result<void> SqliteIndex::prepareStatements() {
+void SqliteIndex::registerStatements() {
   struct Statement {
     const char* sql;
     sqlite3_stmt** stmt;
   };
   
-  Statement statements[] = {
+  // Contentless FTS rows are keyed by note_docids.docid and return NULL for every
+  // column, so note fields are joined in from the notes table instead
+  const bool contentless = content_mode_ == ContentMode::kContentless;
+  
+  std::vector<Statement> statements = {
     {
       R"(INSERT OR REPLACE INTO notes 
          (id, title, created, modified, tags, notebook, content_length, word_count) 
@@ -167,9 +544,13 @@ Result<void> SqliteIndex::prepareStatements() {
       &stmt_add_note_
     },
     {
-      R"(INSERT OR REPLACE INTO notes_fts 
-         (id, title, content, tags, notebook) 
-         VALUES (?, ?, ?, ?, ?))",
+      contentless
+        ? R"(INSERT OR REPLACE INTO notes_fts
+             (rowid, id, title, content, tags, notebook)
+             VALUES ((SELECT docid FROM note_docids WHERE note_id = ?1), ?1, ?2, ?3, ?4, ?5))"
+        : R"(INSERT OR REPLACE INTO notes_fts 
+             (id, title, content, tags, notebook) 
+             VALUES (?, ?, ?, ?, ?))",
       &stmt_update_note_
     },
     {
@@ -177,32 +558,138 @@ Result<void> SqliteIndex::prepareStatements() {
       &stmt_remove_note_
     },
     {
-      R"(DELETE FROM notes_fts WHERE id = ?)",
+      contentless
+        ? R"(DELETE FROM notes_fts
+             WHERE rowid = (SELECT docid FROM note_docids WHERE note_id = ?))"
+        : R"(DELETE FROM notes_fts WHERE id = ?)",
       &stmt_remove_fts_note_
     },
     {
-      R"(SELECT id, title, '', '', tags, notebook,
-               snippet(notes_fts, 2, '<mark>', '</mark>', '...', 32) as snippet,
-               bm25(notes_fts) as score
-         FROM notes_fts
-         WHERE notes_fts MATCH ?
-         ORDER BY bm25(notes_fts)
-         LIMIT ? OFFSET ?)",
+      contentless
+        ? R"(SELECT n.id, n.title, '', '', n.tags, n.notebook,
+                   '' as snippet,
+                   bm25(notes_fts) as score
+             FROM notes_fts
+             JOIN note_docids d ON d.docid = notes_fts.rowid
+             JOIN notes n ON n.id = d.note_id
+             WHERE notes_fts MATCH ?
+             ORDER BY bm25(notes_fts)
+             LIMIT ? OFFSET ?)"
+        : R"(SELECT id, title, '', '', tags, notebook,
+                   snippet(notes_fts, 2, '<mark>', '</mark>', '...', 32) as snippet,
+                   bm25(notes_fts) as score
+             FROM notes_fts
+             WHERE notes_fts MATCH ?
+             ORDER BY bm25(notes_fts)
+             LIMIT ? OFFSET ?)",
       &stmt_search_
     },
+    {
+      // Same page plus the total match count. COUNT(*) OVER() runs before LIMIT, so
+      // the page CTE reports every match; auxiliary functions (snippet, bm25) can't
+      // be evaluated under a window, so they run in the outer query on page rows only.
+      contentless
+        ? R"(WITH page AS (
+               SELECT rowid AS docid, rank AS score, COUNT(*) OVER() AS total
+               FROM notes_fts
+               WHERE notes_fts MATCH ?1
+               ORDER BY rank
+               LIMIT ?2 OFFSET ?3)
+             SELECT n.id, n.title, '', '', n.tags, n.notebook,
+                    '' as snippet, page.score, page.total
+             FROM page
+             JOIN note_docids d ON d.docid = page.docid
+             JOIN notes n ON n.id = d.note_id
+             ORDER BY page.score)"
+        : R"(WITH page AS (
+               SELECT rowid AS fts_rowid, rank AS score, COUNT(*) OVER() AS total
+               FROM notes_fts
+               WHERE notes_fts MATCH ?1
+               ORDER BY rank
+               LIMIT ?2 OFFSET ?3)
+             SELECT id, title, '', '', tags, notebook,
+                    snippet(notes_fts, 2, '<mark>', '</mark>', '...', 32) as snippet,
+                    page.score, page.total
+             FROM page
+             JOIN notes_fts ON notes_fts.rowid = page.fts_rowid
+             WHERE notes_fts MATCH ?1
+             ORDER BY page.score)",
+      &stmt_search_page_
+    },
+    {
+      // Ids only: no snippet() and no note columns to decode. ORDER BY rank is the
+      // same bm25 ordering search() uses, evaluated inside FTS5.
+      contentless
+        ? R"(SELECT d.note_id FROM notes_fts
+             JOIN note_docids d ON d.docid = notes_fts.rowid
+             WHERE notes_fts MATCH ?
+             ORDER BY rank
+             LIMIT ? OFFSET ?)"
+        : R"(SELECT id FROM notes_fts
+             WHERE notes_fts MATCH ?
+             ORDER BY rank
+             LIMIT ? OFFSET ?)",
+      &stmt_search_ids_
+    },
     {
       R"(SELECT COUNT(*) FROM notes_fts
          WHERE notes_fts MATCH ?)",
       &stmt_search_count_
     },
     {
-      R"(SELECT DISTINCT value as tag 
-         FROM notes, json_each(notes.tags)
-         WHERE value LIKE ? || '%'
-         ORDER BY tag
-         LIMIT ?)",
+      // The prefix range is an index scan; ordering by count then sorts the tags in that
+      // range, so the cost grows with how many tags share the prefix
+      R"(SELECT tag, count FROM tag_stats
+         WHERE tag >= ?1 COLLATE NOCASE AND tag < ?2 COLLATE NOCASE
+         ORDER BY count DESC, tag
+         LIMIT ?3)",
       &stmt_suggest_tags_
     },
+    {
+      // Without a prefix the count index is already in suggestion order: LIMIT stops the
+      // walk after the first rows, with no sort
+      R"(SELECT tag, count FROM tag_stats
+         ORDER BY count DESC, tag
+         LIMIT ?1)",
+      &stmt_top_tags_
+    },
+    {
+      R"(SELECT tag, count FROM tag_stats ORDER BY tag)",
+      &stmt_tag_counts_
+    },
+    {
+      // One pass over notes (no note bodies involved). ?1 is the recent cutoff in
+      // milliseconds; titles starting with ?2 (when non-empty) are only counted.
+      R"(SELECT notebook,
+                SUM(NOT skip), SUM(skip),
+                MIN(CASE WHEN skip THEN NULL ELSE created END),
+                MAX(CASE WHEN skip THEN NULL ELSE modified END),
+                SUM(CASE WHEN skip THEN 0 ELSE content_length END),
+                SUM(NOT skip AND modified >= ?1)
+         FROM (SELECT notebook, created, modified, content_length,
+                      length(?2) > 0 AND substr(title, 1, length(?2)) = ?2 AS skip
+               FROM notes)
+         GROUP BY notebook
+         ORDER BY notebook)",
+      &stmt_notebook_aggregates_
+    },
+    {
+      R"(SELECT n.notebook, t.tag, COUNT(*)
+         FROM note_tags t
+         JOIN notes n ON n.id = t.note_id
+         WHERE NOT (length(?1) > 0 AND substr(n.title, 1, length(?1)) = ?1)
+         GROUP BY n.notebook, t.tag
+         ORDER BY n.notebook, t.tag)",
+      &stmt_notebook_tag_counts_
+    },
+    {
+      R"(DELETE FROM note_tags WHERE note_id = ?)",
+      &stmt_remove_note_tags_
+    },
+    {
+      R"(INSERT OR IGNORE INTO note_tags (note_id, tag) VALUES (?, ?))",
+      &stmt_add_note_tag_
+    },
     {
       R"(SELECT DISTINCT notebook 
          FROM notes 
@@ -211,6 +698,15 @@ Result<void> SqliteIndex::prepareStatements() {
          LIMIT ?)",
       &stmt_suggest_notebooks_
     },
+    {
+      R"(SELECT id FROM notes)",
+      &stmt_all_ids_
+    },
+    {
+      // Moves when another connection commits; this connection's own writes do not move it
+      R"(PRAGMA data_version)",
+      &stmt_data_version_
+    },
     {
       R"(SELECT COUNT(*) as total_notes,
                SUM(word_count) as total_words,
@@ -220,26 +716,74 @@ Result<void> SqliteIndex::prepareStatements() {
     }
   };
   
-  for (const auto& stmt_def : statements) {
-    int result = sqlite3_prepare_v2(db_, stmt_def.sql, -1, stmt_def.stmt, nullptr);
-    if (result != SQLITE_OK) {
-      return std::unexpected(makeSqliteError("Failed to prepare statement"));
-    }
+  if (usesDocids()) {
+    statements.push_back({
+      R"(INSERT OR IGNORE INTO note_docids (note_id) VALUES (?))",
+      &stmt_assign_docid_
+    });
+    statements.push_back({
+      R"(DELETE FROM note_docids WHERE note_id = ?)",
+      &stmt_remove_docid_
+    });
+  }
+  if (trigram_enabled_) {
+    statements.push_back({
+      R"(INSERT OR REPLACE INTO notes_trigram (rowid, body)
+         VALUES ((SELECT docid FROM note_docids WHERE note_id = ?1), ?2))",
+      &stmt_add_trigram_
+    });
+    statements.push_back({
+      R"(DELETE FROM notes_trigram
+         WHERE rowid = (SELECT docid FROM note_docids WHERE note_id = ?))",
+      &stmt_remove_trigram_
+    });
+    statements.push_back({
+      R"(SELECT d.note_id FROM notes_trigram
+         JOIN note_docids d ON d.docid = notes_trigram.rowid
+         WHERE notes_trigram MATCH ?)",
+      &stmt_trigram_candidates_
+    });
   }
   
-  return {};
+  // Only the SQL is kept here; `nx view` or `nx new` never compile the search statements
+  statement_sql_.clear();
+  for (const auto& stmt_def : statements) {
+    statement_sql_[stmt_def.stmt] = stmt_def.sql;
+  }
+}
+
+sqlite3_stmt* SqliteIndex::prepared(sqlite3_stmt*& slot) {
+  if (slot) {
+    return slot;
+  }
+  // Statements this schema does not use (docids, trigrams) were never registered
+  auto it = statement_sql_.find(&slot);
+  if (it == statement_sql_.end() || !db_) {
+    return nullptr;
+  }
+  if (sqlite3_prepare_v2(db_, it->second, -1, &slot, nullptr) != SQLITE_OK) {
+    slot = nullptr;
+  }
+  return slot;
 }
 
 void SqliteIndex::finalizeStatements() {
-  sqlite3_stmt* statements[] = {
-    stmt_add_note_, stmt_update_note_, stmt_remove_note_, stmt_remove_fts_note_,
-    stmt_search_, stmt_search_count_, stmt_suggest_tags_,
-    stmt_suggest_notebooks_, stmt_stats_
+  sqlite3_stmt** statements[] = {
+    &stmt_add_note_, &stmt_update_note_, &stmt_remove_note_, &stmt_remove_fts_note_,
+    &stmt_search_, &stmt_search_page_, &stmt_search_ids_, &stmt_search_count_, &stmt_suggest_tags_,
+    &stmt_top_tags_,
+    &stmt_suggest_notebooks_, &stmt_stats_, &stmt_tag_counts_,
+    &stmt_notebook_aggregates_, &stmt_notebook_tag_counts_,
+    &stmt_remove_note_tags_, &stmt_add_note_tag_, &stmt_assign_docid_,
+    &stmt_remove_docid_, &stmt_add_trigram_, &stmt_remove_trigram_,
+    &stmt_trigram_candidates_, &stmt_all_ids_, &stmt_data_version_
   };
   
+  // Cleared so a reopened connection prepares against its own schema
   for (auto stmt : statements) {
-    if (stmt) {
-      sqlite3_finalize(stmt);
+    if (*stmt) {
+      sqlite3_finalize(*stmt);
+      *stmt = nullptr;
     }
   }
 }
@@ -247,7 +791,16 @@ void SqliteIndex::finalizeStatements() {
 Result<void> SqliteIndex::addNote(const nx::core::Note& note) {
   std::lock_guard<std::mutex> lock(db_mutex_);
   
-  if (!stmt_add_note_) {
+  const std::string note_id = note.id().toString();
+  auto batch_result = beginWriteLocked();
+  if (!batch_result.has_value()) {
+    return batch_result;
+  }
+  return endWriteLocked(note_id, addNoteLocked(note));
+}
+
+Result<void> SqliteIndex::addNoteLocked(const nx::core::Note& note) {
+  if (!prepared(stmt_add_note_)) {
     return std::unexpected(makeError(ErrorCode::kDatabaseError, "Statement not prepared"));
   }
   
@@ -263,18 +816,8 @@ Result<void> SqliteIndex::addNote(const nx::core::Note& note) {
       std::chrono::duration_cast<std::chrono::milliseconds>(
           note.metadata().updated().time_since_epoch()).count());
   
-  // Serialize tags as JSON
-  std::ostringstream tags_json;
-  tags_json << "[";
-  bool first = true;
-  for (const auto& tag : note.metadata().tags()) {
-    if (!first) tags_json << ",";
-    tags_json << "\"" << tag << "\"";
-    first = false;
-  }
-  tags_json << "]";
-  
-  sqlite3_bind_text(stmt_add_note_, 5, tags_json.str().c_str(), -1, SQLITE_TRANSIENT);
+  std::string tags_json = tagsJson(note.metadata().tags());
+  sqlite3_bind_text(stmt_add_note_, 5, tags_json.c_str(), -1, SQLITE_TRANSIENT);
   sqlite3_bind_text(stmt_add_note_, 6, 
       note.notebook().has_value() ? note.notebook()->c_str() : nullptr, -1, SQLITE_STATIC);
   sqlite3_bind_int(stmt_add_note_, 7, static_cast<int>(note.content().length()));
@@ -292,26 +835,29 @@ Result<void> SqliteIndex::addNote(const nx::core::Note& note) {
   }
   
   // Update FTS content
-  sqlite3_reset(stmt_update_note_);
-  sqlite3_bind_text(stmt_update_note_, 1, note_id_str.c_str(), -1, SQLITE_TRANSIENT);
-  sqlite3_bind_text(stmt_update_note_, 2, note.title().c_str(), -1, SQLITE_STATIC);
-  sqlite3_bind_text(stmt_update_note_, 3, note.content().c_str(), -1, SQLITE_STATIC);
-  sqlite3_bind_text(stmt_update_note_, 4, tags_json.str().c_str(), -1, SQLITE_TRANSIENT);
-  sqlite3_bind_text(stmt_update_note_, 5, 
-      note.notebook().has_value() ? note.notebook()->c_str() : nullptr, -1, SQLITE_STATIC);
-  
-  result = sqlite3_step(stmt_update_note_);
-  if (result != SQLITE_DONE) {
-    return std::unexpected(makeSqliteError("Failed to update FTS content"));
+  auto fts_result = insertFtsRow(note_id_str, note.title(), note.content(), tags_json,
+                                 note.notebook());
+  if (!fts_result.has_value()) {
+    return fts_result;
   }
   
-  return {};
+  return replaceNoteTags(note_id_str, note.metadata().tags());
 }
 
 Result<void> SqliteIndex::updateNote(const nx::core::Note& note) {
   std::lock_guard<std::mutex> lock(db_mutex_);
   
-  if (!stmt_remove_note_ || !stmt_remove_fts_note_ || !stmt_add_note_ || !stmt_update_note_) {
+  const std::string note_id = note.id().toString();
+  auto batch_result = beginWriteLocked();
+  if (!batch_result.has_value()) {
+    return batch_result;
+  }
+  return endWriteLocked(note_id, updateNoteLocked(note));
+}
+
+Result<void> SqliteIndex::updateNoteLocked(const nx::core::Note& note) {
+  if (!prepared(stmt_remove_note_) || !prepared(stmt_remove_fts_note_) ||
+      !prepared(stmt_add_note_) || !prepared(stmt_update_note_)) {
     return std::unexpected(makeError(ErrorCode::kDatabaseError, "Statement not prepared"));
   }
   
@@ -334,18 +880,8 @@ Result<void> SqliteIndex::updateNote(const nx::core::Note& note) {
       std::chrono::duration_cast<std::chrono::milliseconds>(
           note.metadata().updated().time_since_epoch()).count());
   
-  // Serialize tags as JSON
-  std::ostringstream tags_json;
-  tags_json << "[";
-  bool first = true;
-  for (const auto& tag : note.metadata().tags()) {
-    if (!first) tags_json << ",";
-    tags_json << "\"" << tag << "\"";
-    first = false;
-  }
-  tags_json << "]";
-  
-  sqlite3_bind_text(stmt_add_note_, 5, tags_json.str().c_str(), -1, SQLITE_TRANSIENT);
+  std::string tags_json = tagsJson(note.metadata().tags());
+  sqlite3_bind_text(stmt_add_note_, 5, tags_json.c_str(), -1, SQLITE_TRANSIENT);
   sqlite3_bind_text(stmt_add_note_, 6, 
       note.notebook().has_value() ? note.notebook()->c_str() : nullptr, -1, SQLITE_STATIC);
   sqlite3_bind_int(stmt_add_note_, 7, static_cast<int>(note.content().length()));
@@ -363,26 +899,164 @@ Result<void> SqliteIndex::updateNote(const nx::core::Note& note) {
   }
   
   // Insert new FTS content
+  auto fts_result = insertFtsRow(note_id_str, note.title(), note.content(), tags_json,
+                                 note.notebook());
+  if (!fts_result.has_value()) {
+    return fts_result;
+  }
+  
+  return replaceNoteTags(note_id_str, note.metadata().tags());
+}
+
+Result<void> SqliteIndex::insertFtsRow(const std::string& note_id, const std::string& title,
+                                       const std::string& content, const std::string& tags_json,
+                                       const std::optional<std::string>& notebook) {
+  if (!prepared(stmt_update_note_)) {
+    return std::unexpected(makeError(ErrorCode::kDatabaseError, "Statement not prepared"));
+  }
+  
+  if (prepared(stmt_assign_docid_)) {
+    sqlite3_reset(stmt_assign_docid_);
+    sqlite3_bind_text(stmt_assign_docid_, 1, note_id.c_str(), -1, SQLITE_TRANSIENT);
+    if (sqlite3_step(stmt_assign_docid_) != SQLITE_DONE) {
+      return std::unexpected(makeSqliteError("Failed to assign FTS docid"));
+    }
+  }
+  
   sqlite3_reset(stmt_update_note_);
-  sqlite3_bind_text(stmt_update_note_, 1, note_id_str.c_str(), -1, SQLITE_TRANSIENT);
-  sqlite3_bind_text(stmt_update_note_, 2, note.title().c_str(), -1, SQLITE_STATIC);
-  sqlite3_bind_text(stmt_update_note_, 3, note.content().c_str(), -1, SQLITE_STATIC);
-  sqlite3_bind_text(stmt_update_note_, 4, tags_json.str().c_str(), -1, SQLITE_TRANSIENT);
+  sqlite3_bind_text(stmt_update_note_, 1, note_id.c_str(), -1, SQLITE_TRANSIENT);
+  sqlite3_bind_text(stmt_update_note_, 2, title.c_str(), -1, SQLITE_TRANSIENT);
+  sqlite3_bind_text(stmt_update_note_, 3, content.c_str(), -1, SQLITE_TRANSIENT);
+  sqlite3_bind_text(stmt_update_note_, 4, tags_json.c_str(), -1, SQLITE_TRANSIENT);
   sqlite3_bind_text(stmt_update_note_, 5, 
-      note.notebook().has_value() ? note.notebook()->c_str() : nullptr, -1, SQLITE_STATIC);
+      notebook.has_value() ? notebook->c_str() : nullptr, -1, SQLITE_TRANSIENT);
   
-  result = sqlite3_step(stmt_update_note_);
-  if (result != SQLITE_DONE) {
+  if (sqlite3_step(stmt_update_note_) != SQLITE_DONE) {
     return std::unexpected(makeSqliteError("Failed to update FTS content"));
   }
   
+  if (prepared(stmt_add_trigram_)) {
+    sqlite3_reset(stmt_add_trigram_);
+    sqlite3_bind_text(stmt_add_trigram_, 1, note_id.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt_add_trigram_, 2, content.c_str(), -1, SQLITE_TRANSIENT);
+    if (sqlite3_step(stmt_add_trigram_) != SQLITE_DONE) {
+      return std::unexpected(makeSqliteError("Failed to update trigram index"));
+    }
+  }
+  
+  return {};
+}
+
+Result<void> SqliteIndex::repopulateFts() {
+  // Gather first; inserting while stepping a cursor over notes is best avoided
+  struct Row {
+    std::string id;
+    std::string title;
+    std::string tags_json;
+    std::optional<std::string> notebook;
+  };
+  std::vector<Row> rows;
+  
+  sqlite3_stmt* stmt = nullptr;
+  int result = sqlite3_prepare_v2(db_, "SELECT id, title, tags, notebook FROM notes",
+                                  -1, &stmt, nullptr);
+  if (result != SQLITE_OK) {
+    return std::unexpected(makeSqliteError("Failed to read notes for FTS rebuild"));
+  }
+  while (sqlite3_step(stmt) == SQLITE_ROW) {
+    Row row;
+    row.id = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+    const unsigned char* title = sqlite3_column_text(stmt, 1);
+    row.title = title ? reinterpret_cast<const char*>(title) : "";
+    const unsigned char* tags = sqlite3_column_text(stmt, 2);
+    row.tags_json = tags ? reinterpret_cast<const char*>(tags) : "[]";
+    if (const unsigned char* notebook = sqlite3_column_text(stmt, 3)) {
+      row.notebook = reinterpret_cast<const char*>(notebook);
+    }
+    rows.push_back(std::move(row));
+  }
+  sqlite3_finalize(stmt);
+  
+  bool own_transaction = !in_transaction_;
+  if (own_transaction) {
+    auto begin_result = checkSqliteResult(
+        sqlite3_exec(db_, "BEGIN IMMEDIATE", nullptr, nullptr, nullptr),
+        "Begin FTS rebuild");
+    if (!begin_result.has_value()) {
+      return begin_result;
+    }
+  }
+  
+  auto fail = [&](Result<void> error) {
+    if (own_transaction) {
+      sqlite3_exec(db_, "ROLLBACK", nullptr, nullptr, nullptr);
+    }
+    return error;
+  };
+  
+  const char* clear_sql = content_mode_ == ContentMode::kContentless
+      ? "INSERT INTO notes_fts(notes_fts) VALUES('delete-all')"
+      : "DELETE FROM notes_fts";
+  auto clear_result = checkSqliteResult(
+      sqlite3_exec(db_, clear_sql, nullptr, nullptr, nullptr),
+      "Clear FTS index");
+  if (!clear_result.has_value()) {
+    return fail(clear_result);
+  }
+  
+  if (trigram_enabled_) {
+    const char* clear_trigram_sql = contentlessSupported()
+        ? "INSERT INTO notes_trigram(notes_trigram) VALUES('delete-all')"
+        : "DELETE FROM notes_trigram";
+    auto clear_trigram_result = checkSqliteResult(
+        sqlite3_exec(db_, clear_trigram_sql, nullptr, nullptr, nullptr),
+        "Clear trigram index");
+    if (!clear_trigram_result.has_value()) {
+      return fail(clear_trigram_result);
+    }
+  }
+  
+  for (const auto& row : rows) {
+    std::string content;
+    if (config_.content_provider) {
+      auto note_id = nx::core::NoteId::fromString(row.id);
+      if (note_id.has_value()) {
+        content = config_.content_provider(*note_id).value_or("");
+      }
+    }
+    
+    auto insert_result = insertFtsRow(row.id, row.title, content, row.tags_json, row.notebook);
+    if (!insert_result.has_value()) {
+      return fail(insert_result);
+    }
+  }
+  
+  if (own_transaction) {
+    auto commit_result = checkSqliteResult(
+        sqlite3_exec(db_, "COMMIT", nullptr, nullptr, nullptr),
+        "Commit FTS rebuild");
+    if (!commit_result.has_value()) {
+      return fail(commit_result);
+    }
+  }
+  
+  needs_fts_repopulate_ = false;
   return {};
 }
 
 Result<void> SqliteIndex::removeNote(const nx::core::NoteId& id) {
   std::lock_guard<std::mutex> lock(db_mutex_);
   
-  if (!stmt_remove_note_ || !stmt_remove_fts_note_) {
+  const std::string note_id = id.toString();
+  auto batch_result = beginWriteLocked();
+  if (!batch_result.has_value()) {
+    return batch_result;
+  }
+  return endWriteLocked(note_id, removeNoteLocked(id));
+}
+
+Result<void> SqliteIndex::removeNoteLocked(const nx::core::NoteId& id) {
+  if (!prepared(stmt_remove_note_) || !prepared(stmt_remove_fts_note_)) {
     return std::unexpected(makeError(ErrorCode::kDatabaseError, "Statement not prepared"));
   }
   
@@ -406,70 +1080,816 @@ Result<void> SqliteIndex::removeNote(const nx::core::NoteId& id) {
     return std::unexpected(makeSqliteError("Failed to remove FTS note"));
   }
   
-  return {};
-}
-
-Result<std::vector<SearchResult>> SqliteIndex::search(const SearchQuery& query) {
-  std::lock_guard<std::mutex> lock(db_mutex_);
-  
-  if (!stmt_search_) {
-    return std::unexpected(makeError(ErrorCode::kDatabaseError, "Statement not prepared"));
-  }
-  
-  // Build FTS query
-  std::string fts_query = buildFtsQuery(query);
-  if (fts_query.empty()) {
-    return std::vector<SearchResult>{}; // Empty query returns no results
+  if (prepared(stmt_remove_trigram_)) {
+    sqlite3_reset(stmt_remove_trigram_);
+    sqlite3_bind_text(stmt_remove_trigram_, 1, id_str.c_str(), -1, SQLITE_TRANSIENT);
+    if (sqlite3_step(stmt_remove_trigram_) != SQLITE_DONE) {
+      return std::unexpected(makeSqliteError("Failed to remove trigram entry"));
+    }
   }
   
-  sqlite3_reset(stmt_search_);
-  sqlite3_bind_text(stmt_search_, 1, fts_query.c_str(), -1, SQLITE_TRANSIENT);
-  sqlite3_bind_int(stmt_search_, 2, static_cast<int>(query.limit));
-  sqlite3_bind_int(stmt_search_, 3, static_cast<int>(query.offset));
-  
-  std::vector<SearchResult> results;
-  
-  while (true) {
-    int result = sqlite3_step(stmt_search_);
-    if (result == SQLITE_DONE) {
-      break;
-    } else if (result != SQLITE_ROW) {
-      return std::unexpected(makeSqliteError("Search query failed"));
-    }
-    
-    auto search_result = extractSearchResult(stmt_search_, query.highlight);
-    if (search_result.has_value()) {
-      results.push_back(*search_result);
+  if (prepared(stmt_remove_docid_)) {
+    sqlite3_reset(stmt_remove_docid_);
+    sqlite3_bind_text(stmt_remove_docid_, 1, id_str.c_str(), -1, SQLITE_TRANSIENT);
+    if (sqlite3_step(stmt_remove_docid_) != SQLITE_DONE) {
+      return std::unexpected(makeSqliteError("Failed to remove FTS docid"));
     }
   }
   
-  return results;
+  // Remove tag rows (triggers keep tag_stats in sync)
+  return replaceNoteTags(id_str, {});
 }
 
-Result<std::vector<nx::core::NoteId>> SqliteIndex::searchIds(const SearchQuery& query) {
-  auto results = search(query);
-  if (!results.has_value()) {
-    return std::unexpected(results.error());
+Result<void> SqliteIndex::replaceNoteTags(const std::string& note_id,
+                                          const std::vector<std::string>& tags) {
+  if (!prepared(stmt_remove_note_tags_) || !prepared(stmt_add_note_tag_)) {
+    return std::unexpected(makeError(ErrorCode::kDatabaseError, "Statement not prepared"));
   }
   
-  std::vector<nx::core::NoteId> ids;
-  ids.reserve(results->size());
+  sqlite3_reset(stmt_remove_note_tags_);
+  sqlite3_bind_text(stmt_remove_note_tags_, 1, note_id.c_str(), -1, SQLITE_TRANSIENT);
+  if (sqlite3_step(stmt_remove_note_tags_) != SQLITE_DONE) {
+    return std::unexpected(makeSqliteError("Failed to remove note tags"));
+  }
   
-  for (const auto& result : *results) {
-    ids.push_back(result.id);
+  for (const auto& tag : tags) {
+    if (tag.empty()) {
+      continue;
+    }
+    
+    sqlite3_reset(stmt_add_note_tag_);
+    sqlite3_bind_text(stmt_add_note_tag_, 1, note_id.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt_add_note_tag_, 2, tag.c_str(), -1, SQLITE_TRANSIENT);
+    if (sqlite3_step(stmt_add_note_tag_) != SQLITE_DONE) {
+      return std::unexpected(makeSqliteError("Failed to insert note tag"));
+    }
   }
   
-  return ids;
+  return {};
 }
 
-Result<size_t> SqliteIndex::searchCount(const SearchQuery& query) {
+namespace {
+  // Helper function for safe SQLite text extraction
+  std::string safeGetText(sqlite3_stmt* stmt, int column) {
+    const unsigned char* text = sqlite3_column_text(stmt, column);
+    if (!text) {
+      return "";
+    }
+    // Verify the text length to prevent buffer overruns
+    int length = sqlite3_column_bytes(stmt, column);
+    if (length < 0) {
+      return "";
+    }
+    return std::string(reinterpret_cast<const char*>(text), static_cast<size_t>(length));
+  }
+  
+  // snippet() as the search statements call it; explainSearch() times the statement without it
+  constexpr std::string_view kSnippetCall = "snippet(notes_fts, 2, '<mark>', '</mark>', '...', 32)";
+  
+  int64_t toMillis(std::chrono::system_clock::time_point time) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(time.time_since_epoch()).count();
+  }
+  
+  // FTS5 string: a phrase of the value's tokens, with no operator meaning. A trailing *
+  // stays outside the quotes, where FTS5 reads it as a prefix on the last token.
+  std::string ftsString(std::string_view value) {
+    bool prefix = value.size() > 1 && value.ends_with('*');
+    if (prefix) {
+      value.remove_suffix(1);
+    }
+    std::string out = "\"";
+    for (char c : value) {
+      out += c;
+      if (c == '"') {
+        out += '"';
+      }
+    }
+    return out + (prefix ? "\"*" : "\"");
+  }
+  
+  // MATCH text for a subtree that only tests words; nullopt if it tests anything else
+  std::optional<std::string> ftsExpression(const QueryExpr& expr) {
+    using Kind = QueryExpr::Kind;
+    switch (expr.kind) {
+      case Kind::kText:
+        return ftsString(expr.value);
+      case Kind::kTitle:
+        return "title : " + ftsString(expr.value);
+      case Kind::kOr: {
+        std::string out;
+        for (const auto& child : expr.children) {
+          auto part = ftsExpression(child);
+          if (!part) {
+            return std::nullopt;
+          }
+          out += (out.empty() ? "" : " OR ") + *part;
+        }
+        return "(" + out + ")";
+      }
+      case Kind::kAnd: {
+        // FTS5's NOT is binary: negations need a positive term to subtract from
+        std::string positive;
+        std::string negative;
+        for (const auto& child : expr.children) {
+          bool negated = child.kind == Kind::kNot;
+          auto part = ftsExpression(negated ? child.children[0] : child);
+          if (!part) {
+            return std::nullopt;
+          }
+          if (negated) {
+            negative += " NOT " + *part;
+          } else {
+            positive += (positive.empty() ? "" : " AND ") + *part;
+          }
+        }
+        if (positive.empty()) {
+          return std::nullopt;
+        }
+        return "((" + positive + ")" + negative + ")";
+      }
+      default:
+        return std::nullopt;
+    }
+  }
+}
+
+Result<std::vector<SearchResult>> SqliteIndex::search(const SearchQuery& query) {
+  nx::util::ScopedTimer timer("index.search");
+  timer.arg("query", query.text);
   std::lock_guard<std::mutex> lock(db_mutex_);
   
-  if (!stmt_search_count_) {
+  if (needsQueryPlan(query)) {
+    return runPlanSearch(query);
+  }
+  
+  if (!prepared(stmt_search_)) {
     return std::unexpected(makeError(ErrorCode::kDatabaseError, "Statement not prepared"));
   }
   
+  return runSearch(stmt_search_, query, nullptr);
+}
+
+Result<size_t> SqliteIndex::searchEach(const SearchQuery& query, const SearchVisitor& visit) {
+  nx::util::ScopedTimer timer("index.search");
+  timer.arg("query", query.text);
+  std::lock_guard<std::mutex> lock(db_mutex_);
+  
+  // Each row goes out as SQLite steps to it; nothing past the current row is held
+  size_t visited = 0;
+  auto on_row = [&](sqlite3_stmt* stmt) {
+    auto result = extractSearchResult(stmt, query.highlight);
+    if (!result.has_value()) {
+      return true;
+    }
+    addProviderSnippet(*result, query);
+    ++visited;
+    return visit(*result);
+  };
+  
+  Result<void> run_result;
+  if (needsQueryPlan(query)) {
+    run_result = runPlan(query, PlanOutput::kResults, on_row);
+  } else if (!prepared(stmt_search_)) {
+    return std::unexpected(makeError(ErrorCode::kDatabaseError, "Statement not prepared"));
+  } else {
+    run_result = stepSearch(stmt_search_, query, on_row);
+  }
+  if (!run_result.has_value()) {
+    return std::unexpected(run_result.error());
+  }
+  return visited;
+}
+
+Result<SearchPage> SqliteIndex::searchPage(const SearchQuery& query) {
+  nx::util::ScopedTimer timer("index.search");
+  timer.arg("query", query.text);
+  std::lock_guard<std::mutex> lock(db_mutex_);
+  
+  if (needsQueryPlan(query)) {
+    SearchPage page;
+    auto run_result = runPlan(query, PlanOutput::kPage, [&](sqlite3_stmt* stmt) {
+      page.total = static_cast<size_t>(sqlite3_column_int64(stmt, 8));
+      auto search_result = extractSearchResult(stmt, query.highlight);
+      if (search_result.has_value()) {
+        page.results.push_back(std::move(*search_result));
+      }
+      return true;
+    });
+    if (!run_result.has_value()) {
+      return std::unexpected(run_result.error());
+    }
+    addProviderSnippets(page.results, query);
+    
+    // A page past the end has no rows to carry the window count
+    if (page.results.empty() && query.offset > 0) {
+      auto count_result = runPlan(query, PlanOutput::kCount, [&page](sqlite3_stmt* stmt) {
+        page.total = static_cast<size_t>(sqlite3_column_int64(stmt, 0));
+        return true;
+      });
+      if (!count_result.has_value()) {
+        return std::unexpected(count_result.error());
+      }
+    }
+    return page;
+  }
+  
+  if (!prepared(stmt_search_page_)) {
+    return std::unexpected(makeError(ErrorCode::kDatabaseError, "Statement not prepared"));
+  }
+  
+  SearchPage page;
+  auto results = runSearch(stmt_search_page_, query, &page.total);
+  if (!results.has_value()) {
+    return std::unexpected(results.error());
+  }
+  page.results = std::move(*results);
+  
+  // A page past the end has no rows to carry the window count
+  if (page.results.empty() && query.offset > 0) {
+    auto total = countMatches(buildFtsQuery(query));
+    if (!total.has_value()) {
+      return std::unexpected(total.error());
+    }
+    page.total = *total;
+  }
+  
+  return page;
+}
+
+uint64_t SqliteIndex::changeCounter() {
+  std::lock_guard<std::mutex> lock(db_mutex_);
+  uint64_t version = 0;
+  if (db_ && prepared(stmt_data_version_)) {
+    // A statement left on a row keeps its read snapshot open, and with it a stale version
+    for (auto* stmt = sqlite3_next_stmt(db_, nullptr); stmt; stmt = sqlite3_next_stmt(db_, stmt)) {
+      if (sqlite3_stmt_busy(stmt)) {
+        sqlite3_reset(stmt);
+      }
+    }
+    if (sqlite3_step(stmt_data_version_) == SQLITE_ROW) {
+      version = static_cast<uint64_t>(sqlite3_column_int64(stmt_data_version_, 0));
+    }
+    sqlite3_reset(stmt_data_version_);
+  }
+  // data_version only sees other connections' commits, and restarts when a rebuild
+  // reopens this one
+  return (rebuilds_ << 32) ^ version;
+}
+
+Result<SearchExplain> SqliteIndex::explainSearch(const SearchQuery& query) {
+  using Clock = std::chrono::steady_clock;
+  std::lock_guard<std::mutex> lock(db_mutex_);
+  
+  if (!db_) {
+    return std::unexpected(makeError(ErrorCode::kDatabaseError, "Database not open"));
+  }
+  
+  SearchExplain explain;
+  explain.backend = content_mode_ == ContentMode::kContentless ? "sqlite (contentless)" : "sqlite";
+  
+  // Parse: the statement and parameters searchPage() would use
+  auto started = Clock::now();
+  CompiledQuery compiled;
+  std::optional<CompiledQuery> count_query;
+  if (needsQueryPlan(query)) {
+    compiled = compileQuery(query, PlanOutput::kPage);
+    count_query = compileQuery(query, PlanOutput::kCount);
+  } else {
+    compiled.match = buildFtsQuery(query);
+    if (!compiled.match.empty()) {
+      compiled.sql = statement_sql_.at(&stmt_search_page_);
+      compiled.params = {compiled.match, static_cast<int64_t>(query.limit),
+                         static_cast<int64_t>(query.offset)};
+    }
+  }
+  explain.phases.push_back({"parse", Clock::now() - started, std::nullopt});
+  explain.compiled_query = compiled.match;
+  explain.sql = compiled.sql;
+  if (compiled.sql.empty()) {
+    return explain;  // Nothing to match: searchPage() answers without running SQL
+  }
+  
+  auto plan = prepareCompiled("EXPLAIN QUERY PLAN " + compiled.sql, compiled);
+  if (!plan.has_value()) {
+    return std::unexpected(plan.error());
+  }
+  std::unordered_map<int, size_t> depths;
+  while (sqlite3_step(plan->get()) == SQLITE_ROW) {
+    auto parent = depths.find(sqlite3_column_int(plan->get(), 1));
+    size_t depth = parent == depths.end() ? 0 : parent->second + 1;
+    depths[sqlite3_column_int(plan->get(), 0)] = depth;
+    explain.query_plan.push_back(std::string(depth * 2, ' ') + safeGetText(plan->get(), 3));
+  }
+  
+  // Execute: the same statement without snippet(), so matching and ranking are timed alone
+  std::string bare_sql = compiled.sql;
+  size_t snippet_at = bare_sql.find(kSnippetCall);
+  if (snippet_at != std::string::npos) {
+    bare_sql.replace(snippet_at, kSnippetCall.size(), "''");
+  }
+  
+  auto bare = prepareCompiled(bare_sql, compiled);
+  if (!bare.has_value()) {
+    return std::unexpected(bare.error());
+  }
+  started = Clock::now();
+  size_t total = 0;
+  size_t page_rows = 0;
+  int step = SQLITE_ROW;
+  while ((step = sqlite3_step(bare->get())) == SQLITE_ROW) {
+    if (page_rows++ == 0) {
+      total = static_cast<size_t>(sqlite3_column_int64(bare->get(), 8));
+    }
+  }
+  if (step != SQLITE_DONE) {
+    return std::unexpected(makeSqliteError("Search query failed"));
+  }
+  auto bare_time = Clock::now() - started;
+  explain.phases.push_back({"execute", bare_time,
+                            page_rows > 0 ? std::optional<size_t>(total) : std::nullopt});
+  
+  // A page past the end has no rows to carry the window count, so searchPage() runs a
+  // separate count; it is timed as its own phase
+  if (page_rows == 0) {
+    started = Clock::now();
+    if (count_query.has_value()) {
+      auto count = prepareCompiled(count_query->sql, *count_query);
+      if (!count.has_value()) {
+        return std::unexpected(count.error());
+      }
+      if (sqlite3_step(count->get()) != SQLITE_ROW) {
+        return std::unexpected(makeSqliteError("Count query failed"));
+      }
+      total = static_cast<size_t>(sqlite3_column_int64(count->get(), 0));
+    } else {
+      auto count = countMatches(compiled.match);
+      if (!count.has_value()) {
+        return std::unexpected(count.error());
+      }
+      total = *count;
+    }
+    explain.phases.push_back({"count", Clock::now() - started, total});
+  }
+  
+  // The full statement: SQLite builds snippet() while stepping, so the snippet cost is
+  // its stepping time over the bare statement's. Decoding rows (tags JSON included) is
+  // result construction.
+  auto full = prepareCompiled(compiled.sql, compiled);
+  if (!full.has_value()) {
+    return std::unexpected(full.error());
+  }
+  Clock::duration step_time{0};
+  Clock::duration build_time{0};
+  std::vector<SearchResult> results;
+  while (true) {
+    started = Clock::now();
+    step = sqlite3_step(full->get());
+    auto stepped = Clock::now();
+    step_time += stepped - started;
+    if (step == SQLITE_DONE) {
+      break;
+    } else if (step != SQLITE_ROW) {
+      return std::unexpected(makeSqliteError("Search query failed"));
+    }
+    auto search_result = extractSearchResult(full->get(), query.highlight);
+    if (search_result.has_value()) {
+      results.push_back(std::move(*search_result));
+    }
+    build_time += Clock::now() - stepped;
+  }
+  
+  Clock::duration snippet_time{0};
+  size_t snippet_rows = 0;
+  if (snippet_at != std::string::npos) {
+    snippet_time = std::max(step_time - bare_time, Clock::duration::zero());
+    snippet_rows = results.size();
+  } else if (content_mode_ == ContentMode::kContentless && query.highlight && config_.content_provider) {
+    started = Clock::now();
+    addProviderSnippets(results, query);
+    snippet_time = Clock::now() - started;
+    snippet_rows = results.size();
+  }
+  explain.phases.push_back({"snippet", snippet_time, snippet_rows});
+  explain.phases.push_back({"result construction", build_time, results.size()});
+  
+  explain.page.results = std::move(results);
+  explain.page.total = total;
+  return explain;
+}
+
+Result<std::vector<SearchResult>> SqliteIndex::runSearch(sqlite3_stmt* stmt,
+                                                         const SearchQuery& query,
+                                                         size_t* total) {
+  std::vector<SearchResult> results;
+  auto run_result = stepSearch(stmt, query, [&](sqlite3_stmt* row) {
+    if (total && results.empty()) {
+      *total = static_cast<size_t>(sqlite3_column_int64(row, 8));
+    }
+    
+    auto search_result = extractSearchResult(row, query.highlight);
+    if (search_result.has_value()) {
+      results.push_back(*search_result);
+    }
+    return true;
+  });
+  if (!run_result.has_value()) {
+    return std::unexpected(run_result.error());
+  }
+  
+  addProviderSnippets(results, query);
+  return results;
+}
+
+Result<void> SqliteIndex::stepSearch(sqlite3_stmt* stmt, const SearchQuery& query,
+                                     const std::function<bool(sqlite3_stmt*)>& on_row) {
+  // Build FTS query
   std::string fts_query = buildFtsQuery(query);
+  if (fts_query.empty()) {
+    return {}; // Empty query returns no results
+  }
+  
+  sqlite3_reset(stmt);
+  sqlite3_bind_text(stmt, 1, fts_query.c_str(), -1, SQLITE_TRANSIENT);
+  sqlite3_bind_int(stmt, 2, static_cast<int>(query.limit));
+  sqlite3_bind_int(stmt, 3, static_cast<int>(query.offset));
+  
+  while (true) {
+    int result = sqlite3_step(stmt);
+    if (result == SQLITE_DONE) {
+      break;
+    } else if (result != SQLITE_ROW) {
+      auto error = makeSqliteError("Search query failed");
+      sqlite3_reset(stmt);
+      return std::unexpected(error);
+    }
+    if (!on_row(stmt)) {
+      break;
+    }
+  }
+  // Release the read snapshot now rather than at the next reset
+  sqlite3_reset(stmt);
+  return {};
+}
+
+void SqliteIndex::addProviderSnippets(std::vector<SearchResult>& results, const SearchQuery& query) {
+  for (auto& result : results) {
+    addProviderSnippet(result, query);
+  }
+}
+
+void SqliteIndex::addProviderSnippet(SearchResult& result, const SearchQuery& query) {
+  // Contentless tables have no text for snippet(); build snippets for returned rows only
+  if (content_mode_ == ContentMode::kContentless && query.highlight &&
+      config_.content_provider) {
+    auto content = config_.content_provider(result.id);
+    if (content.has_value()) {
+      result.snippet = generateSnippet(*content, query.text);
+    }
+  }
+}
+
+bool SqliteIndex::needsQueryPlan(const SearchQuery& query) {
+  return query.expr.has_value() || query.since.has_value() || query.until.has_value() ||
+         (query.text.empty() && (!query.tags.empty() || query.notebook.has_value()));
+}
+
+std::string SqliteIndex::ftsIdsSubquery() const {
+  return content_mode_ == ContentMode::kContentless
+      ? "SELECT d.note_id FROM notes_fts JOIN note_docids d ON d.docid = notes_fts.rowid "
+        "WHERE notes_fts MATCH ?"
+      : "SELECT id FROM notes_fts WHERE notes_fts MATCH ?";
+}
+
+std::string SqliteIndex::sqlPredicate(const QueryExpr& expr,
+                                      std::vector<std::variant<std::string, int64_t>>& params) const {
+  using Kind = QueryExpr::Kind;
+  
+  // Word-only subtrees, however deep, are a single FTS lookup
+  if (auto match = ftsExpression(expr)) {
+    params.emplace_back(*match);
+    return "n.id IN (" + ftsIdsSubquery() + ")";
+  }
+  
+  switch (expr.kind) {
+    case Kind::kAnd:
+    case Kind::kOr: {
+      if (expr.children.empty()) {
+        return expr.kind == Kind::kAnd ? "1" : "0";
+      }
+      std::string out;
+      for (const auto& child : expr.children) {
+        if (!out.empty()) {
+          out += expr.kind == Kind::kAnd ? " AND " : " OR ";
+        }
+        out += sqlPredicate(child, params);
+      }
+      return "(" + out + ")";
+    }
+    case Kind::kNot:
+      return "NOT " + sqlPredicate(expr.children[0], params);
+    case Kind::kTag:
+      params.emplace_back(expr.value);
+      return "n.id IN (SELECT note_id FROM note_tags WHERE tag = ?)";
+    case Kind::kNotebook:
+      // IS rather than =, so NOT notebook:x keeps notes without a notebook
+      params.emplace_back(expr.value);
+      return "n.notebook IS ?";
+    case Kind::kCreated:
+    case Kind::kModified: {
+      std::string column = expr.kind == Kind::kCreated ? "n.created" : "n.modified";
+      std::string out = "(1";
+      if (expr.from) {
+        params.emplace_back(toMillis(*expr.from));
+        out += " AND " + column + " >= ?";
+      }
+      if (expr.to) {
+        params.emplace_back(toMillis(*expr.to));
+        out += " AND " + column + " < ?";
+      }
+      return out + ")";
+    }
+    default:
+      // Text leaves were handled above
+      return "1";
+  }
+}
+
+SqliteIndex::CompiledQuery SqliteIndex::compileQuery(const SearchQuery& query, PlanOutput output) {
+  CompiledQuery compiled;
+  std::vector<std::string> match_parts;
+  std::vector<std::string> negated_matches;
+  std::vector<std::string> predicates;
+  std::vector<std::variant<std::string, int64_t>> params;
+  
+  if (!query.text.empty()) {
+    std::string text = query.prefix_last_term ? buildPrefixQuery(query.text) : query.text;
+    if (!text.empty()) {
+      match_parts.push_back("(" + text + ")");
+    }
+  }
+  
+  // Plain fields are exact filters here, not FTS column matches
+  for (const auto& tag : query.tags) {
+    params.emplace_back(tag);
+    predicates.push_back("n.id IN (SELECT note_id FROM note_tags WHERE tag = ?)");
+  }
+  if (query.notebook.has_value()) {
+    params.emplace_back(*query.notebook);
+    predicates.push_back("n.notebook = ?");
+  }
+  if (query.since.has_value()) {
+    params.emplace_back(toMillis(*query.since));
+    predicates.push_back("n.modified >= ?");
+  }
+  if (query.until.has_value()) {
+    params.emplace_back(toMillis(*query.until));
+    predicates.push_back("n.modified <= ?");
+  }
+  
+  // Conjuncts that only test words join the ranked MATCH; the rest filter the joined rows
+  if (query.expr.has_value()) {
+    std::vector<QueryExpr> conjuncts;
+    if (query.expr->kind == QueryExpr::Kind::kAnd) {
+      conjuncts = query.expr->children;
+    } else {
+      conjuncts.push_back(*query.expr);
+    }
+    
+    for (const auto& conjunct : conjuncts) {
+      if (conjunct.kind == QueryExpr::Kind::kNot) {
+        if (auto match = ftsExpression(conjunct.children[0])) {
+          negated_matches.push_back(*match);
+          continue;
+        }
+      } else if (auto match = ftsExpression(conjunct)) {
+        match_parts.push_back(*match);
+        continue;
+      }
+      predicates.push_back(sqlPredicate(conjunct, params));
+    }
+  }
+  
+  std::string match;
+  for (const auto& part : match_parts) {
+    match += (match.empty() ? "" : " AND ") + part;
+  }
+  for (const auto& negated : negated_matches) {
+    if (match.empty()) {
+      params.emplace_back(negated);
+      predicates.push_back("n.id NOT IN (" + ftsIdsSubquery() + ")");
+    } else {
+      match = "(" + match + ") NOT " + negated;
+    }
+  }
+  
+  std::string where;
+  for (const auto& predicate : predicates) {
+    where += (where.empty() ? "" : " AND ") + predicate;
+  }
+  
+  if (!match.empty()) {
+    compiled.match = match;
+    compiled.params.emplace_back(match);
+    std::string from = content_mode_ == ContentMode::kContentless
+        ? " FROM notes_fts JOIN note_docids d ON d.docid = notes_fts.rowid JOIN notes n ON n.id = d.note_id"
+        : " FROM notes_fts JOIN notes n ON n.id = notes_fts.id";
+    std::string condition = " WHERE notes_fts MATCH ?" + (where.empty() ? "" : " AND " + where);
+    std::string snippet = content_mode_ == ContentMode::kContentless ? "''" : std::string(kSnippetCall);
+    switch (output) {
+      case PlanOutput::kResults:
+        compiled.sql = "SELECT n.id, n.title, '', '', n.tags, n.notebook, " + snippet +
+                       ", bm25(notes_fts)" + from + condition + " ORDER BY bm25(notes_fts) LIMIT ? OFFSET ?";
+        break;
+      case PlanOutput::kPage:
+        // The window count covers every match, so snippet() is built outside it for the
+        // page's rows only (?1 is the MATCH text again). The rank column is bm25() in a
+        // form a window query can read
+        compiled.sql = "WITH page AS (SELECT notes_fts.rowid AS fts_rowid, n.id AS note_id, "
+                       "notes_fts.rank AS score, COUNT(*) OVER () AS total" + from + condition +
+                       " ORDER BY notes_fts.rank LIMIT ? OFFSET ?) "
+                       "SELECT n.id, n.title, '', '', n.tags, n.notebook, " + snippet +
+                       ", page.score, page.total FROM page JOIN notes n ON n.id = page.note_id" +
+                       (content_mode_ == ContentMode::kContentless
+                            ? std::string()
+                            : " JOIN notes_fts ON notes_fts.rowid = page.fts_rowid WHERE notes_fts MATCH ?1") +
+                       " ORDER BY page.score";
+        break;
+      case PlanOutput::kIds:
+        compiled.sql = "SELECT n.id" + from + condition + " ORDER BY bm25(notes_fts) LIMIT ? OFFSET ?";
+        break;
+      case PlanOutput::kCount:
+        compiled.sql = "SELECT COUNT(*)" + from + condition;
+        break;
+    }
+  } else {
+    // Nothing to rank by: newest first, as the other backends list
+    std::string condition = " WHERE " + (where.empty() ? std::string("1") : where);
+    switch (output) {
+      case PlanOutput::kResults:
+        compiled.sql = "SELECT n.id, n.title, '', '', n.tags, n.notebook, '', 0 FROM notes n" + condition +
+                       " ORDER BY n.modified DESC LIMIT ? OFFSET ?";
+        break;
+      case PlanOutput::kPage:
+        compiled.sql = "SELECT n.id, n.title, '', '', n.tags, n.notebook, '', 0, COUNT(*) OVER () FROM notes n" +
+                       condition + " ORDER BY n.modified DESC LIMIT ? OFFSET ?";
+        break;
+      case PlanOutput::kIds:
+        compiled.sql = "SELECT n.id FROM notes n" + condition + " ORDER BY n.modified DESC LIMIT ? OFFSET ?";
+        break;
+      case PlanOutput::kCount:
+        compiled.sql = "SELECT COUNT(*) FROM notes n" + condition;
+        break;
+    }
+  }
+  
+  compiled.params.insert(compiled.params.end(), params.begin(), params.end());
+  if (output != PlanOutput::kCount) {
+    compiled.params.emplace_back(static_cast<int64_t>(query.limit));
+    compiled.params.emplace_back(static_cast<int64_t>(query.offset));
+  }
+  return compiled;
+}
+
+Result<SqliteIndex::OwnedStatement> SqliteIndex::prepareCompiled(const std::string& sql,
+                                                                 const CompiledQuery& compiled) {
+  sqlite3_stmt* raw = nullptr;
+  if (sqlite3_prepare_v2(db_, sql.c_str(), -1, &raw, nullptr) != SQLITE_OK) {
+    return std::unexpected(makeSqliteError("Failed to prepare search query"));
+  }
+  OwnedStatement stmt(raw, &sqlite3_finalize);
+  
+  int index = 1;
+  for (const auto& param : compiled.params) {
+    if (const auto* text = std::get_if<std::string>(&param)) {
+      sqlite3_bind_text(raw, index, text->c_str(), -1, SQLITE_TRANSIENT);
+    } else {
+      sqlite3_bind_int64(raw, index, std::get<int64_t>(param));
+    }
+    ++index;
+  }
+  return stmt;
+}
+
+Result<void> SqliteIndex::runPlan(const SearchQuery& query, PlanOutput output,
+                                  const std::function<bool(sqlite3_stmt*)>& on_row) {
+  if (!db_) {
+    return std::unexpected(makeError(ErrorCode::kDatabaseError, "Database not open"));
+  }
+  
+  auto compiled = compileQuery(query, output);
+  auto stmt = prepareCompiled(compiled.sql, compiled);
+  if (!stmt.has_value()) {
+    return std::unexpected(stmt.error());
+  }
+  sqlite3_stmt* raw = stmt->get();
+  
+  while (true) {
+    int result = sqlite3_step(raw);
+    if (result == SQLITE_DONE) {
+      return {};
+    } else if (result != SQLITE_ROW) {
+      return std::unexpected(makeSqliteError("Search query failed"));
+    }
+    if (!on_row(raw)) {
+      return {};
+    }
+  }
+}
+
+Result<std::vector<SearchResult>> SqliteIndex::runPlanSearch(const SearchQuery& query) {
+  std::vector<SearchResult> results;
+  auto run_result = runPlan(query, PlanOutput::kResults, [&](sqlite3_stmt* stmt) {
+    auto search_result = extractSearchResult(stmt, query.highlight);
+    if (search_result.has_value()) {
+      results.push_back(*search_result);
+    }
+    return true;
+  });
+  if (!run_result.has_value()) {
+    return std::unexpected(run_result.error());
+  }
+  
+  addProviderSnippets(results, query);
+  return results;
+}
+
+Result<std::vector<nx::core::NoteId>> SqliteIndex::searchIds(const SearchQuery& query) {
+  nx::util::ScopedTimer timer("index.search");
+  timer.arg("query", query.text);
+  std::lock_guard<std::mutex> lock(db_mutex_);
+  
+  if (needsQueryPlan(query)) {
+    std::vector<nx::core::NoteId> ids;
+    auto run_result = runPlan(query, PlanOutput::kIds, [&ids](sqlite3_stmt* stmt) {
+      auto id = nx::core::NoteId::fromString(safeGetText(stmt, 0));
+      if (id.has_value()) {
+        ids.push_back(*id);
+      }
+      return true;
+    });
+    if (!run_result.has_value()) {
+      return std::unexpected(run_result.error());
+    }
+    return ids;
+  }
+  
+  if (!prepared(stmt_search_ids_)) {
+    return std::unexpected(makeError(ErrorCode::kDatabaseError, "Statement not prepared"));
+  }
+  
+  std::string fts_query = buildFtsQuery(query);
+  if (fts_query.empty()) {
+    return std::vector<nx::core::NoteId>{};
+  }
+  
+  sqlite3_reset(stmt_search_ids_);
+  sqlite3_bind_text(stmt_search_ids_, 1, fts_query.c_str(), -1, SQLITE_TRANSIENT);
+  sqlite3_bind_int(stmt_search_ids_, 2, static_cast<int>(query.limit));
+  sqlite3_bind_int(stmt_search_ids_, 3, static_cast<int>(query.offset));
+  
+  std::vector<nx::core::NoteId> ids;
+  
+  while (true) {
+    int result = sqlite3_step(stmt_search_ids_);
+    if (result == SQLITE_DONE) {
+      break;
+    } else if (result != SQLITE_ROW) {
+      return std::unexpected(makeSqliteError("Search query failed"));
+    }
+    
+    auto id = nx::core::NoteId::fromString(safeGetText(stmt_search_ids_, 0));
+    if (id.has_value()) {
+      ids.push_back(*id);
+    }
+  }
+  
+  return ids;
+}
+
+Result<size_t> SqliteIndex::searchCount(const SearchQuery& query) {
+  nx::util::ScopedTimer timer("index.search");
+  timer.arg("query", query.text);
+  std::lock_guard<std::mutex> lock(db_mutex_);
+  
+  if (needsQueryPlan(query)) {
+    size_t count = 0;
+    auto run_result = runPlan(query, PlanOutput::kCount, [&count](sqlite3_stmt* stmt) {
+      count = static_cast<size_t>(sqlite3_column_int64(stmt, 0));
+      return true;
+    });
+    if (!run_result.has_value()) {
+      return std::unexpected(run_result.error());
+    }
+    return count;
+  }
+  return countMatches(buildFtsQuery(query));
+}
+
+Result<size_t> SqliteIndex::countMatches(const std::string& fts_query) {
+  if (!prepared(stmt_search_count_)) {
+    return std::unexpected(makeError(ErrorCode::kDatabaseError, "Statement not prepared"));
+  }
+  
   if (fts_query.empty()) {
     return 0;
   }
@@ -482,7 +1902,56 @@ Result<size_t> SqliteIndex::searchCount(const SearchQuery& query) {
     return std::unexpected(makeSqliteError("Count query failed"));
   }
   
-  return static_cast<size_t>(sqlite3_column_int64(stmt_search_count_, 0));
+  auto count = static_cast<size_t>(sqlite3_column_int64(stmt_search_count_, 0));
+  sqlite3_reset(stmt_search_count_);
+  return count;
+}
+
+Result<std::vector<nx::core::NoteId>> SqliteIndex::scanCandidates(const std::string& pattern,
+                                                                   bool is_regex) {
+  std::lock_guard<std::mutex> lock(db_mutex_);
+  
+  auto trigram_query = is_regex ? TrigramQuery::forRegex(pattern)
+                                : TrigramQuery::forSubstring(pattern);
+  
+  // Nothing to narrow on (short needle, literal-free regex, no trigram table): every note
+  sqlite3_stmt* stmt = prepared(stmt_all_ids_);
+  std::string match;
+  if (trigram_enabled_ && trigram_query.has_value()) {
+    stmt = prepared(stmt_trigram_candidates_);
+    match = trigram_query->toFtsMatch();
+  }
+  
+  if (!stmt) {
+    return std::unexpected(makeError(ErrorCode::kDatabaseError, "Statement not prepared"));
+  }
+  
+  sqlite3_reset(stmt);
+  if (!match.empty()) {
+    sqlite3_bind_text(stmt, 1, match.c_str(), -1, SQLITE_TRANSIENT);
+  }
+  
+  std::vector<nx::core::NoteId> candidates;
+  
+  while (true) {
+    int result = sqlite3_step(stmt);
+    if (result == SQLITE_DONE) {
+      break;
+    } else if (result != SQLITE_ROW) {
+      return std::unexpected(makeSqliteError("Candidate query failed"));
+    }
+    
+    const unsigned char* text = sqlite3_column_text(stmt, 0);
+    if (!text) {
+      continue;
+    }
+    auto id = nx::core::NoteId::fromString(reinterpret_cast<const char*>(text));
+    if (id.has_value()) {
+      candidates.push_back(*id);
+    }
+  }
+  
+  return candidates;
 }
 
 std::string SqliteIndex::buildFtsQuery(const SearchQuery& query) {
@@ -492,7 +1961,10 @@ std::string SqliteIndex::buildFtsQuery(const SearchQuery& query) {
   
   // Use the query text directly - FTS5 handles basic escaping
   // FTS5 query syntax is well-defined and safe to use directly
-  std::string fts_query = query.text;
+  std::string fts_query = query.prefix_last_term ? buildPrefixQuery(query.text) : query.text;
+  if (fts_query.empty()) {
+    return "";
+  }
   
   // Add column filters if needed
   std::vector<std::string> conditions;
@@ -516,22 +1988,40 @@ std::string SqliteIndex::buildFtsQuery(const SearchQuery& query) {
   }
   
   return fts_query;
-}
-
-namespace {
-  // Helper function for safe SQLite text extraction
-  std::string safeGetText(sqlite3_stmt* stmt, int column) {
-    const unsigned char* text = sqlite3_column_text(stmt, column);
-    if (!text) {
-      return "";
+}
+
+std::string SqliteIndex::buildPrefixQuery(const std::string& text) {
+  // Typed text is plain words, not FTS syntax: quote each word so stray operators
+  // or punctuation can't break the query, and make the word being typed a prefix
+  std::vector<std::string> words;
+  std::string word;
+  for (char c : text) {
+    auto uc = static_cast<unsigned char>(c);
+    if (std::isalnum(uc) || c == '_' || uc >= 0x80) {
+      word += c;
+    } else if (!word.empty()) {
+      words.push_back(std::move(word));
+      word.clear();
     }
-    // Verify the text length to prevent buffer overruns
-    int length = sqlite3_column_bytes(stmt, column);
-    if (length < 0) {
-      return "";
+  }
+  // A trailing separator means the last word is complete
+  bool last_is_partial = !word.empty();
+  if (!word.empty()) {
+    words.push_back(std::move(word));
+  }
+  
+  std::string fts_query;
+  for (size_t i = 0; i < words.size(); ++i) {
+    if (i > 0) {
+      fts_query += ' ';
+    }
+    fts_query += '"' + words[i] + '"';
+    if (i + 1 == words.size() && last_is_partial) {
+      fts_query += '*';
     }
-    return std::string(reinterpret_cast<const char*>(text), static_cast<size_t>(length));
   }
+  
+  return fts_query;
 }
 
 Result<SearchResult> SqliteIndex::extractSearchResult(sqlite3_stmt* stmt, bool highlight) {
@@ -558,15 +2048,16 @@ Result<SearchResult> SqliteIndex::extractSearchResult(sqlite3_stmt* stmt, bool h
   // Extract tags (JSON array) - column 4
   std::string tags_json = safeGetText(stmt, 4);
   if (!tags_json.empty()) {
-    // Parse JSON tags using regex for simplicity and performance
-    std::regex tag_regex("\"([^\"]+)\"");
-    std::sregex_iterator iter(tags_json.begin(), tags_json.end(), tag_regex);
-    std::sregex_iterator end;
-    
-    for (; iter != end; ++iter) {
-      std::string tag = (*iter)[1].str();
-      if (!tag.empty() && tag.length() < 100) { // Bounds check
-        result.tags.push_back(tag);
+    auto tags = nlohmann::json::parse(tags_json, nullptr, false);
+    if (tags.is_array()) {
+      for (const auto& tag : tags) {
+        if (!tag.is_string()) {
+          continue;
+        }
+        auto value = tag.get<std::string>();
+        if (!value.empty() && value.length() < 100) { // Bounds check
+          result.tags.push_back(std::move(value));
+        }
       }
     }
   }
@@ -588,28 +2079,129 @@ Result<SearchResult> SqliteIndex::extractSearchResult(sqlite3_stmt* stmt, bool h
   return result;
 }
 
+std::string SqliteIndex::generateSnippet(const std::string& content, const std::string& query,
+                                         size_t max_length) {
+  auto is_word_char = [](char c) {
+    auto uc = static_cast<unsigned char>(c);
+    return std::isalnum(uc) || c == '_' || uc >= 0x80;
+  };
+  auto to_lower = [](std::string text) {
+    std::transform(text.begin(), text.end(), text.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return text;
+  };
+  
+  // Query terms, skipping FTS operators and column filters ("tags:...")
+  std::vector<std::string> terms;
+  std::string token;
+  auto flush = [&](char next) {
+    if (!token.empty() && next != ':' && token != "AND" && token != "OR" &&
+        token != "NOT" && token != "NEAR") {
+      terms.push_back(to_lower(token));
+    }
+    token.clear();
+  };
+  for (char c : query) {
+    if (is_word_char(c)) {
+      token += c;
+    } else {
+      flush(c);
+    }
+  }
+  flush('\0');
+  
+  std::string haystack = to_lower(content);
+  size_t first_match = std::string::npos;
+  for (const auto& term : terms) {
+    first_match = std::min(first_match, haystack.find(term));
+  }
+  
+  // Window of max_length bytes with the first hit about a third of the way in
+  size_t start = 0;
+  if (first_match != std::string::npos && first_match > max_length / 3) {
+    start = first_match - max_length / 3;
+    size_t space = content.find(' ', start);
+    if (space != std::string::npos && space < first_match) {
+      start = space + 1;
+    }
+  }
+  size_t end = std::min(content.size(), start + max_length);
+  if (end < content.size()) {
+    size_t space = content.rfind(' ', end);
+    if (space != std::string::npos && space > start &&
+        (first_match == std::string::npos || space > first_match)) {
+      end = space;
+    }
+  }
+  
+  // Never split a UTF-8 sequence
+  while (start < content.size() && (static_cast<unsigned char>(content[start]) & 0xC0) == 0x80) {
+    ++start;
+  }
+  while (end > start && end < content.size() &&
+         (static_cast<unsigned char>(content[end]) & 0xC0) == 0x80) {
+    --end;
+  }
+  
+  std::string snippet = start > 0 ? "..." : "";
+  size_t pos = start;
+  while (pos < end) {
+    size_t match_length = 0;
+    if (pos == 0 || !is_word_char(content[pos - 1])) {
+      for (const auto& term : terms) {
+        if (term.size() > match_length && pos + term.size() <= end &&
+            haystack.compare(pos, term.size(), term) == 0) {
+          match_length = term.size();
+        }
+      }
+    }
+    
+    if (match_length > 0) {
+      snippet += "<mark>" + content.substr(pos, match_length) + "</mark>";
+      pos += match_length;
+    } else {
+      snippet += content[pos++];
+    }
+  }
+  if (end < content.size()) {
+    snippet += "...";
+  }
+  
+  return snippet;
+}
+
 Result<std::vector<std::string>> SqliteIndex::suggestTags(const std::string& prefix, size_t limit) {
   std::lock_guard<std::mutex> lock(db_mutex_);
   
-  if (!stmt_suggest_tags_) {
+  // Ordering and the limit run in SQL either way; an empty prefix walks the count index
+  sqlite3_stmt* stmt = prepared(prefix.empty() ? stmt_top_tags_ : stmt_suggest_tags_);
+  if (!stmt) {
     return std::unexpected(makeError(ErrorCode::kDatabaseError, "Statement not prepared"));
   }
   
-  sqlite3_reset(stmt_suggest_tags_);
-  sqlite3_bind_text(stmt_suggest_tags_, 1, prefix.c_str(), -1, SQLITE_STATIC);
-  sqlite3_bind_int(stmt_suggest_tags_, 2, static_cast<int>(limit));
+  // Prefix match as a range scan over tag_stats: [prefix, prefix + U+10FFFF)
+  std::string upper_bound = prefix + "\xF4\x8F\xBF\xBF";
+  
+  sqlite3_reset(stmt);
+  if (prefix.empty()) {
+    sqlite3_bind_int(stmt, 1, static_cast<int>(limit));
+  } else {
+    sqlite3_bind_text(stmt, 1, prefix.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 2, upper_bound.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_int(stmt, 3, static_cast<int>(limit));
+  }
   
   std::vector<std::string> suggestions;
   
   while (true) {
-    int result = sqlite3_step(stmt_suggest_tags_);
+    int result = sqlite3_step(stmt);
     if (result == SQLITE_DONE) {
       break;
     } else if (result != SQLITE_ROW) {
       return std::unexpected(makeSqliteError("Tag suggestion query failed"));
     }
     
-    std::string tag = safeGetText(stmt_suggest_tags_, 0);
+    std::string tag = safeGetText(stmt, 0);
     if (!tag.empty() && tag.length() < 100) { // Bounds check
       suggestions.emplace_back(std::move(tag));
     }
@@ -618,10 +2210,132 @@ Result<std::vector<std::string>> SqliteIndex::suggestTags(const std::string& pre
   return suggestions;
 }
 
+Result<std::vector<TagCount>> SqliteIndex::getTagCounts() {
+  std::lock_guard<std::mutex> lock(db_mutex_);
+  
+  if (!prepared(stmt_tag_counts_)) {
+    return std::unexpected(makeError(ErrorCode::kDatabaseError, "Statement not prepared"));
+  }
+  
+  sqlite3_reset(stmt_tag_counts_);
+  
+  std::vector<TagCount> counts;
+  
+  while (true) {
+    int result = sqlite3_step(stmt_tag_counts_);
+    if (result == SQLITE_DONE) {
+      break;
+    } else if (result != SQLITE_ROW) {
+      return std::unexpected(makeSqliteError("Tag count query failed"));
+    }
+    
+    TagCount tag_count;
+    tag_count.tag = safeGetText(stmt_tag_counts_, 0);
+    tag_count.count = static_cast<size_t>(sqlite3_column_int64(stmt_tag_counts_, 1));
+    if (!tag_count.tag.empty()) {
+      counts.push_back(std::move(tag_count));
+    }
+  }
+  
+  return counts;
+}
+
+Result<IndexAggregates> SqliteIndex::aggregate(const AggregateQuery& query) {
+  std::lock_guard<std::mutex> lock(db_mutex_);
+  
+  if (!prepared(stmt_tag_counts_) || !prepared(stmt_notebook_aggregates_) ||
+      !prepared(stmt_notebook_tag_counts_)) {
+    return std::unexpected(makeError(ErrorCode::kDatabaseError, "Statement not prepared"));
+  }
+  
+  auto fromMillis = [](int64_t millis) {
+    return std::chrono::system_clock::time_point(std::chrono::milliseconds(millis));
+  };
+  auto optionalText = [](sqlite3_stmt* stmt, int column) -> std::optional<std::string> {
+    if (sqlite3_column_type(stmt, column) == SQLITE_NULL) {
+      return std::nullopt;
+    }
+    return safeGetText(stmt, column);
+  };
+  
+  IndexAggregates aggregates;
+  
+  // Global tag counts are maintained by triggers; no grouping needed
+  sqlite3_reset(stmt_tag_counts_);
+  while (true) {
+    int result = sqlite3_step(stmt_tag_counts_);
+    if (result == SQLITE_DONE) {
+      break;
+    } else if (result != SQLITE_ROW) {
+      return std::unexpected(makeSqliteError("Tag count query failed"));
+    }
+    std::string tag = safeGetText(stmt_tag_counts_, 0);
+    if (!tag.empty()) {
+      aggregates.tags.push_back({std::move(tag), static_cast<size_t>(sqlite3_column_int64(stmt_tag_counts_, 1))});
+    }
+  }
+  sqlite3_reset(stmt_tag_counts_);
+  
+  sqlite3_reset(stmt_notebook_aggregates_);
+  sqlite3_bind_int64(stmt_notebook_aggregates_, 1,
+                     std::chrono::duration_cast<std::chrono::milliseconds>(
+                         query.recent_since.time_since_epoch()).count());
+  sqlite3_bind_text(stmt_notebook_aggregates_, 2, query.skip_title_prefix.c_str(), -1, SQLITE_TRANSIENT);
+  while (true) {
+    int result = sqlite3_step(stmt_notebook_aggregates_);
+    if (result == SQLITE_DONE) {
+      break;
+    } else if (result != SQLITE_ROW) {
+      return std::unexpected(makeSqliteError("Notebook aggregate query failed"));
+    }
+    NotebookAggregate notebook;
+    notebook.notebook = optionalText(stmt_notebook_aggregates_, 0);
+    notebook.note_count = static_cast<size_t>(sqlite3_column_int64(stmt_notebook_aggregates_, 1));
+    notebook.skipped_count = static_cast<size_t>(sqlite3_column_int64(stmt_notebook_aggregates_, 2));
+    notebook.first_created = fromMillis(sqlite3_column_int64(stmt_notebook_aggregates_, 3));
+    notebook.last_modified = fromMillis(sqlite3_column_int64(stmt_notebook_aggregates_, 4));
+    notebook.total_size = static_cast<size_t>(sqlite3_column_int64(stmt_notebook_aggregates_, 5));
+    notebook.recent_notes = static_cast<size_t>(sqlite3_column_int64(stmt_notebook_aggregates_, 6));
+    
+    aggregates.total_notes += notebook.note_count;
+    aggregates.total_size += notebook.total_size;
+    aggregates.recent_notes += notebook.recent_notes;
+    aggregates.notebooks.push_back(std::move(notebook));
+  }
+  sqlite3_reset(stmt_notebook_aggregates_);
+  
+  // Both queries order by notebook (NULL first), so tag rows are merged in one walk
+  sqlite3_reset(stmt_notebook_tag_counts_);
+  sqlite3_bind_text(stmt_notebook_tag_counts_, 1, query.skip_title_prefix.c_str(), -1, SQLITE_TRANSIENT);
+  auto target = aggregates.notebooks.begin();
+  while (true) {
+    int result = sqlite3_step(stmt_notebook_tag_counts_);
+    if (result == SQLITE_DONE) {
+      break;
+    } else if (result != SQLITE_ROW) {
+      return std::unexpected(makeSqliteError("Notebook tag count query failed"));
+    }
+    auto notebook = optionalText(stmt_notebook_tag_counts_, 0);
+    while (target != aggregates.notebooks.end() && target->notebook != notebook) {
+      ++target;
+    }
+    if (target == aggregates.notebooks.end()) {
+      break;
+    }
+    std::string tag = safeGetText(stmt_notebook_tag_counts_, 1);
+    if (!tag.empty()) {
+      target->tags.push_back({std::move(tag), static_cast<size_t>(sqlite3_column_int64(stmt_notebook_tag_counts_, 2))});
+    }
+  }
+  sqlite3_reset(stmt_notebook_tag_counts_);
+  
+  return aggregates;
+}
+
 Result<std::vector<std::string>> SqliteIndex::suggestNotebooks(const std::string& prefix, size_t limit) {
   std::lock_guard<std::mutex> lock(db_mutex_);
   
-  if (!stmt_suggest_notebooks_) {
+  if (!prepared(stmt_suggest_notebooks_)) {
     return std::unexpected(makeError(ErrorCode::kDatabaseError, "Statement not prepared"));
   }
   
@@ -651,7 +2365,7 @@ Result<std::vector<std::string>> SqliteIndex::suggestNotebooks(const std::string
 Result<IndexStats> SqliteIndex::getStats() {
   std::lock_guard<std::mutex> lock(db_mutex_);
   
-  if (!stmt_stats_) {
+  if (!prepared(stmt_stats_)) {
     return std::unexpected(makeError(ErrorCode::kDatabaseError, "Statement not prepared"));
   }
   
@@ -732,6 +2446,15 @@ Result<void> SqliteIndex::validateIndex() {
 
 Result<void> SqliteIndex::rebuild() {
   std::lock_guard<std::mutex> lock(db_mutex_);
+  auto flush_result = flushLocked();
+  if (!flush_result.has_value()) {
+    return flush_result;
+  }
+  
+  // FTS5 'rebuild' needs stored text; contentless tables are refilled from the notes
+  if (content_mode_ == ContentMode::kContentless) {
+    return repopulateFts();
+  }
   
   // Rebuild FTS index
   auto result = checkSqliteResult(
@@ -742,11 +2465,194 @@ Result<void> SqliteIndex::rebuild() {
   return result;
 }
 
+Result<SqliteIndex::RebuildReport> SqliteIndex::rebuildInShadow(const std::filesystem::path& notes_dir,
+                                                                size_t threads) {
+  RebuildReport report;
+  
+  // Parse every note file up front and in parallel; the live database is untouched
+  std::vector<std::filesystem::path> files;
+  std::error_code ec;
+  for (const auto& entry : std::filesystem::directory_iterator(notes_dir, ec)) {
+    if (entry.is_regular_file(ec) && entry.path().extension() == ".md") {
+      files.push_back(entry.path());
+    }
+  }
+  if (ec) {
+    return std::unexpected(makeError(ErrorCode::kDirectoryNotFound,
+                                     "Cannot list notes directory: " + ec.message()));
+  }
+  
+  std::vector<std::optional<nx::core::Note>> parsed(files.size());
+  std::atomic<size_t> next_file{0};
+  auto parse = [&]() {
+    std::string content;
+    for (size_t i = next_file++; i < files.size(); i = next_file++) {
+      std::ifstream file(files[i], std::ios::binary);
+      if (!file) {
+        continue;
+      }
+      content.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+      auto note = nx::core::Note::fromFileFormat(content);
+      if (note.has_value()) {
+        parsed[i] = std::move(*note);
+      }
+    }
+  };
+  
+  if (threads == 0) {
+    threads = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), kMaxRebuildThreads);
+  }
+  threads = std::min(threads, std::max<size_t>(files.size() / kFilesPerRebuildThread, 1));
+  if (threads <= 1) {
+    parse();
+  } else {
+    std::vector<std::thread> workers;
+    workers.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) {
+      workers.emplace_back(parse);
+    }
+    for (auto& worker : workers) {
+      worker.join();
+    }
+  }
+  
+  // Build the new database beside the live one
+  auto shadow_path = db_path_;
+  shadow_path += ".shadow";
+  removeDatabaseFiles(shadow_path);  // Leftovers from an interrupted build
+  
+  auto abandon = [&shadow_path](Error error) -> Result<RebuildReport> {
+    removeDatabaseFiles(shadow_path);
+    return std::unexpected(std::move(error));
+  };
+  
+  {
+    SqliteIndex shadow(shadow_path, config_);
+    auto build = [&]() -> Result<void> {
+      auto init_result = shadow.initialize();
+      if (!init_result.has_value()) {
+        return init_result;
+      }
+      auto pragma_result = shadow.checkSqliteResult(
+          sqlite3_exec(shadow.db_, sql::kBulkLoadPragmas, nullptr, nullptr, nullptr),
+          "Configure shadow database");
+      if (!pragma_result.has_value()) {
+        return pragma_result;
+      }
+      
+      auto begin_result = shadow.beginTransaction();
+      if (!begin_result.has_value()) {
+        return begin_result;
+      }
+      for (const auto& note : parsed) {
+        if (!note.has_value()) {
+          ++report.files_skipped;
+          continue;
+        }
+        auto add_result = shadow.addNote(*note);
+        if (!add_result.has_value()) {
+          shadow.rollbackTransaction();
+          return add_result;
+        }
+        ++report.notes_indexed;
+      }
+      auto commit_result = shadow.commitTransaction();
+      if (!commit_result.has_value()) {
+        return commit_result;
+      }
+      
+      // Merge FTS segments now, while the file is still private
+      auto optimize_result = shadow.checkSqliteResult(
+          sqlite3_exec(shadow.db_, "INSERT INTO notes_fts(notes_fts) VALUES('optimize')",
+                       nullptr, nullptr, nullptr),
+          "Optimize shadow FTS index");
+      if (!optimize_result.has_value()) {
+        return optimize_result;
+      }
+      
+      auto validate_result = shadow.validateIndex();
+      if (!validate_result.has_value()) {
+        return validate_result;
+      }
+      auto stats = shadow.getStats();
+      if (!stats.has_value()) {
+        return std::unexpected(stats.error());
+      }
+      if (stats->total_notes != report.notes_indexed) {
+        return std::unexpected(makeError(ErrorCode::kIndexError,
+                                         "Shadow index holds " + std::to_string(stats->total_notes) +
+                                             " notes, expected " + std::to_string(report.notes_indexed)));
+      }
+      
+      // Leave a self-contained file; connections switch it back to WAL when they open it
+      return shadow.checkSqliteResult(
+          sqlite3_exec(shadow.db_, "PRAGMA journal_mode = DELETE", nullptr, nullptr, nullptr),
+          "Finish shadow database");
+    };
+    
+    auto build_result = build();
+    if (!build_result.has_value()) {
+      return abandon(build_result.error());
+    }
+  }
+  
+  // Swap: copy the shadow into the live database in one write transaction. Going
+  // through SQLite rather than renaming the file keeps the WAL consistent for other
+  // connections (a daemon or TUI), which see the new index on their next read.
+  std::lock_guard<std::mutex> lock(db_mutex_);
+  if (!db_) {
+    return abandon(makeError(ErrorCode::kDatabaseError, "Database not open"));
+  }
+  if (in_transaction_) {
+    return abandon(makeError(ErrorCode::kInvalidState, "Cannot swap the index during a transaction"));
+  }
+  // Pending writes are covered by the rebuild, which read the note files
+  (void)flushLocked();
+  finalizeStatements();
+  
+  sqlite3* source = nullptr;
+  int result = sqlite3_open_v2(shadow_path.string().c_str(), &source, SQLITE_OPEN_READONLY, nullptr);
+  if (result == SQLITE_OK) {
+    sqlite3_backup* backup = sqlite3_backup_init(db_, "main", source, "main");
+    if (backup == nullptr) {
+      result = sqlite3_errcode(db_);
+    } else {
+      sqlite3_backup_step(backup, -1);
+      result = sqlite3_backup_finish(backup);
+    }
+  }
+  sqlite3_close(source);
+  if (result != SQLITE_OK) {
+    auto code = result == SQLITE_BUSY || result == SQLITE_LOCKED ? ErrorCode::kInvalidState
+                                                                  : ErrorCode::kDatabaseError;
+    return abandon(makeError(code, std::string("Failed to swap in the rebuilt index: ") +
+                                       sqlite3_errstr(result)));
+  }
+  removeDatabaseFiles(shadow_path);
+  
+  // The copy went through the WAL; fold what no reader still needs back into the file
+  sqlite3_wal_checkpoint_v2(db_, nullptr, SQLITE_CHECKPOINT_PASSIVE, nullptr, nullptr);
+  
+  // Reopen so schema options are resolved against the new contents
+  ++rebuilds_;
+  sqlite3_close(db_);
+  db_ = nullptr;
+  auto open_result = openDatabase();
+  if (!open_result.has_value()) {
+    return std::unexpected(open_result.error());
+  }
+  return report;
+}
+
 Result<void> SqliteIndex::optimize() {
   std::lock_guard<std::mutex> lock(db_mutex_);
+  auto result = flushLocked();
+  if (!result.has_value()) {
+    return result;
+  }
   
   // Optimize FTS index
-  auto result = checkSqliteResult(
+  result = checkSqliteResult(
       sqlite3_exec(db_, "INSERT INTO notes_fts(notes_fts) VALUES('optimize')", 
                    nullptr, nullptr, nullptr),
       "Optimize FTS index");
@@ -764,9 +2670,13 @@ Result<void> SqliteIndex::optimize() {
 
 Result<void> SqliteIndex::vacuum() {
   std::lock_guard<std::mutex> lock(db_mutex_);
+  auto result = flushLocked();
+  if (!result.has_value()) {
+    return result;
+  }
   
   // VACUUM database to reclaim space
-  auto result = checkSqliteResult(
+  result = checkSqliteResult(
       sqlite3_exec(db_, "VACUUM", nullptr, nullptr, nullptr),
       "VACUUM database");
   
@@ -780,7 +2690,13 @@ Result<void> SqliteIndex::beginTransaction() {
     return std::unexpected(makeError(ErrorCode::kDatabaseError, "Transaction already active"));
   }
   
-  auto result = checkSqliteResult(
+  // An explicit transaction takes over from write-behind
+  auto result = flushLocked();
+  if (!result.has_value()) {
+    return result;
+  }
+  
+  result = checkSqliteResult(
       sqlite3_exec(db_, "BEGIN IMMEDIATE", nullptr, nullptr, nullptr),
       "Begin transaction");
   
@@ -821,6 +2737,169 @@ Result<void> SqliteIndex::rollbackTransaction() {
   return result;
 }
 
+Result<void> SqliteIndex::savepoint() {
+  std::lock_guard<std::mutex> lock(db_mutex_);
+  
+  // Outside a transaction SQLite would open one behind in_transaction_'s back
+  if (!in_transaction_) {
+    return std::unexpected(makeError(ErrorCode::kDatabaseError, "No active transaction"));
+  }
+  
+  return checkSqliteResult(
+      sqlite3_exec(db_, "SAVEPOINT nx_savepoint", nullptr, nullptr, nullptr),
+      "Begin savepoint");
+}
+
+Result<void> SqliteIndex::releaseSavepoint() {
+  std::lock_guard<std::mutex> lock(db_mutex_);
+  
+  if (!in_transaction_) {
+    return std::unexpected(makeError(ErrorCode::kDatabaseError, "No active transaction"));
+  }
+  
+  return checkSqliteResult(
+      sqlite3_exec(db_, "RELEASE nx_savepoint", nullptr, nullptr, nullptr),
+      "Release savepoint");
+}
+
+Result<void> SqliteIndex::rollbackToSavepoint() {
+  std::lock_guard<std::mutex> lock(db_mutex_);
+  
+  if (!in_transaction_) {
+    return std::unexpected(makeError(ErrorCode::kDatabaseError, "No active transaction"));
+  }
+  
+  // ROLLBACK TO keeps the savepoint open; release it so the caller's nesting stays balanced
+  auto result = checkSqliteResult(
+      sqlite3_exec(db_, "ROLLBACK TO nx_savepoint", nullptr, nullptr, nullptr),
+      "Rollback to savepoint");
+  if (result.has_value()) {
+    result = checkSqliteResult(
+        sqlite3_exec(db_, "RELEASE nx_savepoint", nullptr, nullptr, nullptr),
+        "Release savepoint");
+  }
+  return result;
+}
+
+Result<void> SqliteIndex::flush() {
+  std::lock_guard<std::mutex> lock(db_mutex_);
+  return flushLocked();
+}
+
+std::vector<nx::core::NoteId> SqliteIndex::pendingWrites() {
+  std::lock_guard<std::mutex> lock(db_mutex_);
+  std::vector<nx::core::NoteId> ids;
+  ids.reserve(pending_ids_.size());
+  for (const auto& id_str : pending_ids_) {
+    auto id = nx::core::NoteId::fromString(id_str);
+    if (id.has_value()) {
+      ids.push_back(*id);
+    }
+  }
+  return ids;
+}
+
+Result<void> SqliteIndex::setWriteBatching(size_t size, std::chrono::milliseconds delay) {
+  std::lock_guard<std::mutex> lock(db_mutex_);
+  auto result = flushLocked();
+  config_.write_batch_size = size;
+  config_.write_batch_delay = delay;
+  return result;
+}
+
+Result<void> SqliteIndex::beginWriteLocked() {
+  if (!db_) {
+    return {};
+  }
+  
+  if (config_.write_batch_size > 0 && !in_transaction_ && !batch_open_) {
+    auto result = checkSqliteResult(
+        sqlite3_exec(db_, "BEGIN IMMEDIATE", nullptr, nullptr, nullptr),
+        "Begin write batch");
+    if (!result.has_value()) {
+      return result;
+    }
+    batch_open_ = true;
+    batch_started_ = std::chrono::steady_clock::now();
+    batch_writes_ = 0;
+    
+    if (!flusher_.joinable()) {
+      flusher_ = std::thread([this]() { flusherLoop(); });
+    }
+    flush_cv_.notify_all();
+  }
+  
+  // A note's statements (FTS delete, notes upsert, tags, ...) apply together or not at
+  // all, whether they run on their own, in a write-behind batch or in a transaction
+  return checkSqliteResult(
+      sqlite3_exec(db_, "SAVEPOINT note_write", nullptr, nullptr, nullptr),
+      "Begin note write");
+}
+
+Result<void> SqliteIndex::endWriteLocked(const std::string& note_id, Result<void> result) {
+  if (!db_) {
+    return result;
+  }
+  
+  if (result.has_value()) {
+    result = checkSqliteResult(
+        sqlite3_exec(db_, "RELEASE note_write", nullptr, nullptr, nullptr),
+        "Commit note write");
+  }
+  if (!result.has_value()) {
+    // Undo the half-applied write so neither the batch nor the caller's transaction commits it
+    sqlite3_exec(db_, "ROLLBACK TO note_write", nullptr, nullptr, nullptr);
+    sqlite3_exec(db_, "RELEASE note_write", nullptr, nullptr, nullptr);
+    return result;
+  }
+  
+  if (!batch_open_) {
+    return {};
+  }
+  pending_ids_.insert(note_id);
+  ++batch_writes_;
+  if (batch_writes_ >= config_.write_batch_size ||
+      std::chrono::steady_clock::now() - batch_started_ >= config_.write_batch_delay) {
+    return flushLocked();
+  }
+  return {};
+}
+
+Result<void> SqliteIndex::flushLocked() {
+  if (!batch_open_) {
+    return {};
+  }
+  
+  auto result = checkSqliteResult(
+      sqlite3_exec(db_, "COMMIT", nullptr, nullptr, nullptr),
+      "Commit write batch");
+  if (!result.has_value()) {
+    // Leave nothing half-open; the batch's notes are reindexed from their files on the next rebuild
+    sqlite3_exec(db_, "ROLLBACK", nullptr, nullptr, nullptr);
+  }
+  
+  batch_open_ = false;
+  batch_writes_ = 0;
+  pending_ids_.clear();
+  return result;
+}
+
+void SqliteIndex::flusherLoop() {
+  std::unique_lock<std::mutex> lock(db_mutex_);
+  while (!stopping_) {
+    if (!batch_open_) {
+      flush_cv_.wait(lock);
+      continue;
+    }
+    
+    auto deadline = batch_started_ + config_.write_batch_delay;
+    flush_cv_.wait_until(lock, deadline);
+    if (batch_open_ && std::chrono::steady_clock::now() >= batch_started_ + config_.write_batch_delay) {
+      (void)flushLocked();
+    }
+  }
+}
+
 Error SqliteIndex::makeSqliteError(const std::string& operation) {
   std::string message = operation;
   if (db_) {
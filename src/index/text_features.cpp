@@ -0,0 +1,80 @@
+#include "nx/index/text_features.hpp"
+
+#include <cctype>
+#include <unordered_set>
+
+namespace nx::index {
+
+namespace {
+
+bool isWordChar(char c) {
+  auto uc = static_cast<unsigned char>(c);
+  return std::isalnum(uc) || c == '_' || uc >= 0x80;
+}
+
+char asciiLower(char c) {
+  return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+bool isStopword(const std::string& token) {
+  static const std::unordered_set<std::string> kStopwords = {
+      "a",    "an",   "and",  "are",   "as",    "at",   "be",   "but",  "by",   "for",
+      "from", "has",  "have", "in",    "into",  "is",   "it",   "its",  "of",   "on",
+      "or",   "our",  "so",   "that",  "the",   "their", "then", "there", "these", "this",
+      "to",   "was",  "we",   "were",  "which", "will", "with", "you",  "your", "not"};
+  return kStopwords.contains(token);
+}
+
+// Folds the commonest plural so "note" and "notes" are the same word
+void stem(std::string& token) {
+  if (token.size() > 3 && token.back() == 's' && token[token.size() - 2] != 's') {
+    token.pop_back();
+  }
+}
+
+}  // namespace
+
+std::vector<std::string> contentWords(std::string_view text) {
+  std::vector<std::string> words;
+  std::string token;
+  auto finish = [&]() {
+    if (token.size() > 1 && !isStopword(token)) {
+      stem(token);
+      words.push_back(token);
+    }
+    token.clear();
+  };
+  for (char c : text) {
+    if (isWordChar(c)) {
+      token += asciiLower(c);
+    } else if (!token.empty()) {
+      finish();
+    }
+  }
+  if (!token.empty()) {
+    finish();
+  }
+  return words;
+}
+
+uint64_t contentHash(std::string_view text) {
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (char c : text) {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+uint64_t featureHash(std::string_view text) {
+  // murmur3's 64-bit finalizer
+  uint64_t hash = contentHash(text);
+  hash ^= hash >> 33;
+  hash *= 0xff51afd7ed558ccdULL;
+  hash ^= hash >> 33;
+  hash *= 0xc4ceb9fe1a85ec53ULL;
+  hash ^= hash >> 33;
+  return hash;
+}
+
+}  // namespace nx::index
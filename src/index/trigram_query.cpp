@@ -0,0 +1,302 @@
+#include "nx/index/trigram_query.hpp"
+
+#include <algorithm>
+#include <cctype>
+
+namespace nx::index {
+
+namespace {
+
+using Groups = std::vector<std::vector<std::string>>;
+
+// Beyond this many alternatives the constraint is not worth its query cost
+constexpr size_t kMaxGroups = 16;
+
+size_t utf8SequenceLength(unsigned char lead) {
+  if (lead >= 0xF0) return 4;
+  if (lead >= 0xE0) return 3;
+  if (lead >= 0xC0) return 2;
+  return 1;
+}
+
+size_t utf8Length(const std::string& text) {
+  size_t count = 0;
+  for (char c : text) {
+    if ((static_cast<unsigned char>(c) & 0xC0) != 0x80) {
+      ++count;
+    }
+  }
+  return count;
+}
+
+// {{}} is "no constraint": one group with nothing required
+bool isUnconstrained(const Groups& groups) {
+  return std::any_of(groups.begin(), groups.end(),
+                     [](const auto& group) { return group.empty(); });
+}
+
+Groups andGroups(const Groups& left, const Groups& right) {
+  if (isUnconstrained(right)) {
+    return left;
+  }
+  if (isUnconstrained(left)) {
+    return right;
+  }
+  if (left.size() * right.size() > kMaxGroups) {
+    // Dropping a constraint only widens the candidate set, which stays correct
+    return left.size() <= right.size() ? left : right;
+  }
+
+  Groups result;
+  for (const auto& a : left) {
+    for (const auto& b : right) {
+      auto merged = a;
+      merged.insert(merged.end(), b.begin(), b.end());
+      result.push_back(std::move(merged));
+    }
+  }
+  return result;
+}
+
+Groups orGroups(Groups left, const Groups& right) {
+  if (isUnconstrained(left) || isUnconstrained(right) ||
+      left.size() + right.size() > kMaxGroups) {
+    return Groups{{}};
+  }
+  left.insert(left.end(), right.begin(), right.end());
+  return left;
+}
+
+// Walks an ECMAScript pattern and collects the literal runs every match must contain
+class LiteralExtractor {
+public:
+  explicit LiteralExtractor(const std::string& pattern) : pattern_(pattern) {}
+
+  Groups extract() {
+    return parseAlternation();
+  }
+
+private:
+  Groups parseAlternation() {
+    Groups result = parseSequence();
+    while (pos_ < pattern_.size() && pattern_[pos_] == '|') {
+      ++pos_;
+      result = orGroups(std::move(result), parseSequence());
+    }
+    return result;
+  }
+
+  Groups parseSequence() {
+    Groups result{{}};
+    std::string run;
+
+    auto flush = [&]() {
+      if (utf8Length(run) >= 3) {
+        result = andGroups(result, Groups{{run}});
+      }
+      run.clear();
+    };
+
+    while (pos_ < pattern_.size() && pattern_[pos_] != '|' && pattern_[pos_] != ')') {
+      char c = pattern_[pos_];
+      std::optional<std::string> literal;
+      std::optional<Groups> group;
+
+      if (c == '(') {
+        ++pos_;
+        bool lookaround = false;
+        if (pos_ < pattern_.size() && pattern_[pos_] == '?') {
+          // (?:...) is a plain group; (?=...) and (?!...) consume nothing
+          lookaround = pos_ + 1 < pattern_.size() && pattern_[pos_ + 1] != ':';
+          pos_ += 2;
+        }
+        Groups inner = parseAlternation();
+        if (pos_ < pattern_.size() && pattern_[pos_] == ')') {
+          ++pos_;
+        }
+        group = lookaround ? Groups{{}} : std::move(inner);
+      } else if (c == '[') {
+        skipCharacterClass();
+      } else if (c == '\\') {
+        ++pos_;
+        if (pos_ < pattern_.size()) {
+          char escaped = pattern_[pos_];
+          ++pos_;
+          // Class escapes, anchors, control and numeric escapes are not literals
+          if (!std::isalnum(static_cast<unsigned char>(escaped))) {
+            literal = std::string(1, escaped);
+          } else if (escaped == 'x' || escaped == 'u' || escaped == 'c') {
+            skipEscapeOperand(escaped);
+          }
+        }
+      } else if (c == '.' || c == '^' || c == '$') {
+        ++pos_;
+      } else {
+        size_t length = std::min(utf8SequenceLength(static_cast<unsigned char>(c)),
+                                 pattern_.size() - pos_);
+        literal = pattern_.substr(pos_, length);
+        pos_ += length;
+      }
+
+      auto [has_quantifier, min_repeat] = parseQuantifier();
+
+      if (literal.has_value()) {
+        if (min_repeat == 0) {
+          flush();
+        } else {
+          run += *literal;
+          if (has_quantifier) {
+            // "ab+c" still requires "ab" but the run cannot continue past the repeat
+            flush();
+          }
+        }
+      } else {
+        flush();
+        if (group.has_value() && min_repeat > 0) {
+          result = andGroups(result, *group);
+        }
+      }
+    }
+
+    flush();
+    return result;
+  }
+
+  // Returns {quantifier present, minimum repetitions}
+  std::pair<bool, size_t> parseQuantifier() {
+    if (pos_ >= pattern_.size()) {
+      return {false, 1};
+    }
+
+    std::pair<bool, size_t> quantifier{false, 1};
+    char c = pattern_[pos_];
+    if (c == '*' || c == '?') {
+      quantifier = {true, 0};
+      ++pos_;
+    } else if (c == '+') {
+      quantifier = {true, 1};
+      ++pos_;
+    } else if (c == '{' && pos_ + 1 < pattern_.size() &&
+               std::isdigit(static_cast<unsigned char>(pattern_[pos_ + 1]))) {
+      size_t close = pattern_.find('}', pos_);
+      if (close == std::string::npos) {
+        return {false, 1};
+      }
+      size_t min_repeat = 0;
+      for (size_t i = pos_ + 1; i < close && std::isdigit(static_cast<unsigned char>(pattern_[i])); ++i) {
+        min_repeat = min_repeat * 10 + static_cast<size_t>(pattern_[i] - '0');
+      }
+      quantifier = {true, min_repeat};
+      pos_ = close + 1;
+    } else {
+      return quantifier;
+    }
+
+    // Lazy modifier
+    if (pos_ < pattern_.size() && pattern_[pos_] == '?') {
+      ++pos_;
+    }
+    return quantifier;
+  }
+
+  void skipCharacterClass() {
+    ++pos_;  // '['
+    if (pos_ < pattern_.size() && pattern_[pos_] == '^') {
+      ++pos_;
+    }
+    if (pos_ < pattern_.size() && pattern_[pos_] == ']') {
+      ++pos_;
+    }
+    while (pos_ < pattern_.size() && pattern_[pos_] != ']') {
+      pos_ += pattern_[pos_] == '\\' ? size_t{2} : size_t{1};
+    }
+    if (pos_ < pattern_.size()) {
+      ++pos_;
+    }
+  }
+
+  void skipEscapeOperand(char escape) {
+    size_t operand = escape == 'x' ? 2 : escape == 'u' ? 4 : 1;
+    pos_ = std::min(pattern_.size(), pos_ + operand);
+  }
+
+  const std::string& pattern_;
+  size_t pos_ = 0;
+};
+
+std::string quoteFtsString(const std::string& text) {
+  std::string quoted = "\"";
+  for (char c : text) {
+    quoted += c;
+    if (c == '"') {
+      quoted += '"';
+    }
+  }
+  return quoted + "\"";
+}
+
+}  // namespace
+
+std::vector<std::string> utf8Trigrams(const std::string& text) {
+  std::vector<size_t> starts;
+  for (size_t i = 0; i < text.size(); ++i) {
+    if ((static_cast<unsigned char>(text[i]) & 0xC0) != 0x80) {
+      starts.push_back(i);
+    }
+  }
+  starts.push_back(text.size());
+
+  std::vector<std::string> trigrams;
+  for (size_t i = 0; i + 3 < starts.size(); ++i) {
+    trigrams.push_back(text.substr(starts[i], starts[i + 3] - starts[i]));
+  }
+  return trigrams;
+}
+
+std::optional<TrigramQuery> TrigramQuery::forSubstring(const std::string& needle) {
+  if (utf8Length(needle) < 3) {
+    return std::nullopt;
+  }
+  return TrigramQuery{{{needle}}};
+}
+
+std::optional<TrigramQuery> TrigramQuery::forRegex(const std::string& pattern) {
+  Groups groups = LiteralExtractor(pattern).extract();
+  if (groups.empty() || isUnconstrained(groups)) {
+    return std::nullopt;
+  }
+  return TrigramQuery{std::move(groups)};
+}
+
+std::string TrigramQuery::toFtsMatch() const {
+  std::string expression;
+  for (const auto& group : groups) {
+    // Lower-case ASCII so duplicate trigrams collapse; the tokenizer folds case anyway
+    std::vector<std::string> trigrams;
+    for (const auto& literal : group) {
+      std::string lowered = literal;
+      std::transform(lowered.begin(), lowered.end(), lowered.begin(),
+                     [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+      auto literal_trigrams = utf8Trigrams(lowered);
+      trigrams.insert(trigrams.end(), literal_trigrams.begin(), literal_trigrams.end());
+    }
+    std::sort(trigrams.begin(), trigrams.end());
+    trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+
+    std::string conjunction;
+    for (const auto& trigram : trigrams) {
+      if (!conjunction.empty()) {
+        conjunction += " AND ";
+      }
+      conjunction += quoteFtsString(trigram);
+    }
+
+    if (!expression.empty()) {
+      expression += " OR ";
+    }
+    expression += "(" + conjunction + ")";
+  }
+  return expression;
+}
+
+}  // namespace nx::index
@@ -0,0 +1,320 @@
+#include "nx/index/vector_index.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <unordered_set>
+
+#include "nx/index/snapshot_io.hpp"
+#include "nx/index/text_features.hpp"
+
+namespace nx::index {
+
+namespace {
+
+constexpr char kIndexMagic[8] = {'N', 'X', 'V', 'E', 'C', '\0', '\0', '\0'};
+constexpr uint32_t kIndexVersion = 1;
+
+}  // namespace
+
+VectorIndex::VectorIndex(std::shared_ptr<Embedder> embedder)
+    : VectorIndex(std::move(embedder), Config{}) {}
+
+VectorIndex::VectorIndex(std::shared_ptr<Embedder> embedder, Config config)
+    : embedder_(std::move(embedder)), config_(std::move(config)) {
+  config_.graph.dimensions = embedder_->dimensions();
+  graph_ = HnswIndex(config_.graph);
+}
+
+VectorIndex::~VectorIndex() {
+  if (dirty_) {
+    (void)save();
+  }
+}
+
+std::string VectorIndex::embeddingText(const nx::core::Note& note) {
+  std::string text;
+  for (const auto& tag : note.tags()) {
+    text += tag;
+    text += ' ';
+  }
+  if (!text.empty()) {
+    text.back() = '\n';
+  }
+  text += note.content();
+  return text;
+}
+
+size_t VectorIndex::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_.size();
+}
+
+void VectorIndex::reset() {
+  graph_ = HnswIndex(config_.graph);
+  entries_.clear();
+  node_ids_.clear();
+}
+
+Result<size_t> VectorIndex::sync(const std::vector<nx::core::Note>& notes) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  std::unordered_set<std::string> present;
+  present.reserve(notes.size());
+  size_t embedded = 0;
+  for (const auto& note : notes) {
+    present.insert(note.id().toString());
+    auto changed = upsertLocked(note);
+    if (!changed.has_value()) {
+      return std::unexpected(changed.error());
+    }
+    embedded += *changed ? size_t{1} : size_t{0};
+  }
+
+  std::vector<std::string> gone;
+  for (const auto& [key, entry] : entries_) {
+    if (!present.contains(key)) {
+      gone.push_back(key);
+    }
+  }
+  for (const auto& key : gone) {
+    removeLocked(key);
+  }
+
+  compactIfNeeded();
+  return embedded;
+}
+
+Result<void> VectorIndex::upsert(const nx::core::Note& note) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto changed = upsertLocked(note);
+  compactIfNeeded();
+  if (!changed.has_value()) {
+    return std::unexpected(changed.error());
+  }
+  return {};
+}
+
+Result<bool> VectorIndex::upsertLocked(const nx::core::Note& note) {
+  auto key = note.id().toString();
+  auto text = embeddingText(note);
+  uint64_t hash = contentHash(text);
+
+  auto it = entries_.find(key);
+  if (it != entries_.end() && it->second.content_hash == hash) {
+    return false;
+  }
+
+  auto vector = embedder_->embed(text);
+  if (!vector.has_value()) {
+    return std::unexpected(vector.error());
+  }
+  if (vector->size() != graph_.config().dimensions) {
+    return std::unexpected(makeError(ErrorCode::kIndexError,
+                                     "Embedder returned " + std::to_string(vector->size()) +
+                                         " dimensions, expected " +
+                                         std::to_string(graph_.config().dimensions)));
+  }
+
+  if (it != entries_.end()) {
+    graph_.markDeleted(it->second.node);
+  }
+  uint32_t node = graph_.insert(*vector);
+  node_ids_.resize(graph_.size());
+  node_ids_[node] = key;
+  entries_[key] = Entry{hash, node};
+  dirty_ = true;
+  return true;
+}
+
+void VectorIndex::remove(const nx::core::NoteId& id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  removeLocked(id.toString());
+  compactIfNeeded();
+}
+
+void VectorIndex::removeLocked(const std::string& key) {
+  auto it = entries_.find(key);
+  if (it == entries_.end()) {
+    return;
+  }
+  graph_.markDeleted(it->second.node);
+  node_ids_[it->second.node].clear();
+  entries_.erase(it);
+  dirty_ = true;
+}
+
+void VectorIndex::compactIfNeeded() {
+  if (graph_.size() == 0 ||
+      static_cast<double>(graph_.deletedCount()) <= config_.max_deleted_ratio * static_cast<double>(graph_.size())) {
+    return;
+  }
+
+  // Re-insert the stored vectors; nothing is embedded again
+  HnswIndex rebuilt(config_.graph);
+  std::vector<std::string> node_ids;
+  for (auto& [key, entry] : entries_) {
+    uint32_t node = rebuilt.insert(graph_.vector(entry.node));
+    node_ids.resize(rebuilt.size());
+    node_ids[node] = key;
+    entry.node = node;
+  }
+  graph_ = std::move(rebuilt);
+  node_ids_ = std::move(node_ids);
+  dirty_ = true;
+}
+
+std::vector<VectorIndex::Hit> VectorIndex::nearest(std::span<const float> query, size_t k,
+                                                   const std::string& exclude) const {
+  std::vector<Hit> hits;
+  for (const auto& neighbor : graph_.search(query, exclude.empty() ? k : k + 1)) {
+    const auto& key = node_ids_[neighbor.node];
+    float score = 1.0f - neighbor.distance;
+    if (key == exclude || score <= 0.0f) {
+      continue;
+    }
+    auto id = nx::core::NoteId::fromString(key);
+    if (id.has_value()) {
+      hits.push_back(Hit{*id, score});
+    }
+    if (hits.size() == k) {
+      break;
+    }
+  }
+  return hits;
+}
+
+Result<std::vector<VectorIndex::Hit>> VectorIndex::search(const std::string& text, size_t k) {
+  auto query = embedder_->embed(text);
+  if (!query.has_value()) {
+    return std::unexpected(query.error());
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (query->size() != graph_.config().dimensions) {
+    return std::unexpected(makeError(ErrorCode::kIndexError, "Query embedding has the wrong dimensions"));
+  }
+  return nearest(*query, k, {});
+}
+
+Result<std::vector<VectorIndex::Hit>> VectorIndex::similar(const nx::core::NoteId& id, size_t k) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto key = id.toString();
+  auto it = entries_.find(key);
+  if (it == entries_.end()) {
+    return std::unexpected(makeError(ErrorCode::kNotFound, "Note is not in the vector index: " + key));
+  }
+  return nearest(graph_.vector(it->second.node), k, key);
+}
+
+Result<void> VectorIndex::load() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  reset();
+  dirty_ = false;
+  if (config_.index_file.empty() || !std::filesystem::exists(config_.index_file)) {
+    return {};
+  }
+
+  std::ifstream in(config_.index_file, std::ios::binary);
+  if (!in) {
+    return std::unexpected(makeError(ErrorCode::kFileReadError,
+                                     "Cannot open vector index: " + config_.index_file.string()));
+  }
+
+  SnapshotReader reader(in);
+  char magic[sizeof(kIndexMagic)];
+  in.read(magic, sizeof(magic));
+  if (!in || !std::equal(std::begin(magic), std::end(magic), std::begin(kIndexMagic)) ||
+      reader.get<uint32_t>() != kIndexVersion) {
+    return std::unexpected(makeError(ErrorCode::kIndexError, "Unrecognized vector index format"));
+  }
+
+  // Vectors from another embedder are not comparable; start over and re-embed
+  if (reader.getString() != embedder_->name()) {
+    dirty_ = true;
+    return {};
+  }
+
+  auto corrupt = [this]() {
+    reset();
+    return std::unexpected(makeError(ErrorCode::kIndexError, "Corrupt vector index"));
+  };
+
+  auto count = reader.get<uint64_t>();
+  std::vector<std::pair<std::string, Entry>> entries;
+  for (uint64_t i = 0; i < count && reader.ok(); ++i) {
+    auto key = reader.getString();
+    auto hash = reader.get<uint64_t>();
+    auto node = reader.get<uint32_t>();
+    entries.emplace_back(std::move(key), Entry{hash, node});
+  }
+  if (!reader.ok()) {
+    return corrupt();
+  }
+
+  auto graph = HnswIndex::load(in);
+  if (!graph.has_value() || graph->config().dimensions != embedder_->dimensions()) {
+    return corrupt();
+  }
+  graph_ = std::move(*graph);
+
+  node_ids_.assign(graph_.size(), std::string());
+  for (auto& [key, entry] : entries) {
+    if (entry.node >= graph_.size() || graph_.isDeleted(entry.node) || !node_ids_[entry.node].empty()) {
+      return corrupt();
+    }
+    node_ids_[entry.node] = key;
+    entries_.emplace(std::move(key), entry);
+  }
+  return {};
+}
+
+Result<void> VectorIndex::save() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (config_.index_file.empty()) {
+    dirty_ = false;
+    return {};
+  }
+
+  std::error_code ec;
+  std::filesystem::create_directories(config_.index_file.parent_path(), ec);
+
+  // Write beside the target and rename, so readers never see a partial file
+  auto temp_path = config_.index_file;
+  temp_path += ".tmp";
+  {
+    std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+      return std::unexpected(makeError(ErrorCode::kFileWriteError,
+                                       "Cannot write vector index: " + temp_path.string()));
+    }
+
+    SnapshotWriter writer(out);
+    out.write(kIndexMagic, sizeof(kIndexMagic));
+    writer.put<uint32_t>(kIndexVersion);
+    writer.putString(embedder_->name());
+
+    writer.put<uint64_t>(entries_.size());
+    for (const auto& [key, entry] : entries_) {
+      writer.putString(key);
+      writer.put<uint64_t>(entry.content_hash);
+      writer.put<uint32_t>(entry.node);
+    }
+    graph_.save(out);
+
+    if (!out.flush()) {
+      return std::unexpected(makeError(ErrorCode::kFileWriteError,
+                                       "Failed writing vector index: " + temp_path.string()));
+    }
+  }
+
+  std::filesystem::rename(temp_path, config_.index_file, ec);
+  if (ec) {
+    return std::unexpected(makeError(ErrorCode::kFileWriteError,
+                                     "Failed to replace vector index: " + ec.message()));
+  }
+
+  dirty_ = false;
+  return {};
+}
+
+}  // namespace nx::index
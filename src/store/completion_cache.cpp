@@ -0,0 +1,663 @@
+#include "nx/store/completion_cache.hpp"
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <set>
+#include <string_view>
+
+#include "nx/util/filesystem.hpp"
+#include "nx/util/xdg.hpp"
+
+namespace nx::store {
+
+namespace {
+
+// Record layout: one record per line, fields separated by kField. Each record
+// starts with its kind, so a kind's records sort together and a prefix lookup
+// is a single range:
+//   i <id> <title> <notebook> <tag kList tag ...>   one per note (full state)
+//   T <lowercased title> <id> <title>              one per note
+//   t <tag> <count>
+//   n <notebook> <count>
+// The journal holds "+ <id> <title> <notebook> <tags>" and "- <id>" lines, and
+// "@ <version>" after each change the store made: the notes directory version
+// the cache is current with, which the header holds for the sorted file.
+constexpr char kField = '\x1f';
+constexpr char kList = '\x1e';
+constexpr std::string_view kHeader = "#nx-completions 2";  // Sorts before every record
+constexpr char kStamp = '@';
+
+constexpr char kIdRecord = 'i';
+constexpr char kTitleRecord = 'T';
+constexpr char kTagRecord = 't';
+constexpr char kNotebookRecord = 'n';
+
+using Entry = CompletionCache::Entry;
+using Candidate = CompletionCache::Candidate;
+
+// Separators and line breaks inside user text would split a record
+std::string clean(std::string_view text) {
+  std::string out(text);
+  for (auto& c : out) {
+    if (c == kField || c == kList || c == '\n' || c == '\r' || c == '\t') {
+      c = ' ';
+    }
+  }
+  return out;
+}
+
+std::string lower(std::string_view text) {
+  std::string out(text);
+  for (auto& c : out) {
+    c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+  }
+  return out;
+}
+
+std::string upper(std::string_view text) {
+  std::string out(text);
+  for (auto& c : out) {
+    c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+  }
+  return out;
+}
+
+std::string key(char kind, std::string_view prefix) {
+  std::string out(1, kind);
+  out += kField;
+  out += prefix;
+  return out;
+}
+
+std::vector<std::string_view> split(std::string_view text, char separator) {
+  std::vector<std::string_view> parts;
+  size_t start = 0;
+  while (true) {
+    size_t end = text.find(separator, start);
+    if (end == std::string_view::npos) {
+      parts.push_back(text.substr(start));
+      return parts;
+    }
+    parts.push_back(text.substr(start, end - start));
+    start = end + 1;
+  }
+}
+
+std::string encodeEntry(const Entry& entry) {
+  std::string out = entry.id.toString();
+  out += kField;
+  out += clean(entry.title);
+  out += kField;
+  out += entry.notebook.has_value() ? clean(*entry.notebook) : "";
+  out += kField;
+  for (size_t i = 0; i < entry.tags.size(); ++i) {
+    if (i > 0) {
+      out += kList;
+    }
+    out += clean(entry.tags[i]);
+  }
+  return out;
+}
+
+std::optional<Entry> decodeEntry(std::string_view payload) {
+  auto fields = split(payload, kField);
+  if (fields.size() != 4) {
+    return std::nullopt;
+  }
+  auto id = nx::core::NoteId::fromString(std::string(fields[0]));
+  if (!id.has_value()) {
+    return std::nullopt;
+  }
+  Entry entry;
+  entry.id = *id;
+  entry.title = std::string(fields[1]);
+  if (!fields[2].empty()) {
+    entry.notebook = std::string(fields[2]);
+  }
+  if (!fields[3].empty()) {
+    for (auto tag : split(fields[3], kList)) {
+      entry.tags.emplace_back(tag);
+    }
+  }
+  return entry;
+}
+
+// Latest state of each note the journal mentions; nullopt for removed notes
+std::map<std::string, std::optional<Entry>> parseJournal(std::string_view journal) {
+  std::map<std::string, std::optional<Entry>> changes;
+  for (auto line : split(journal, '\n')) {
+    if (line.size() < 2 || line[1] != kField) {
+      continue;
+    }
+    if (line[0] == '+') {
+      auto entry = decodeEntry(line.substr(2));
+      if (entry.has_value()) {
+        changes[entry->id.toString()] = std::move(entry);
+      }
+    } else if (line[0] == '-') {
+      changes[std::string(line.substr(2))] = std::nullopt;
+    }
+  }
+  return changes;
+}
+
+// Notes directory version the cache reflects: the last journal stamp, else the header's
+uint64_t currentStamp(std::string_view base, std::string_view journal) {
+  std::string_view stamp;
+  std::string_view header = base.substr(0, base.find('\n'));
+  if (header.size() > kHeader.size() + 1 && header[kHeader.size()] == kField) {
+    stamp = header.substr(kHeader.size() + 1);
+  }
+  for (auto line : split(journal, '\n')) {
+    if (line.size() > 2 && line[0] == kStamp && line[1] == kField) {
+      stamp = line.substr(2);
+    }
+  }
+  return std::strtoull(std::string(stamp).c_str(), nullptr, 10);
+}
+
+std::string buildRecords(const std::map<std::string, Entry>& notes, uint64_t stamp) {
+  std::vector<std::string> records;
+  records.reserve(notes.size() * 2);
+  std::map<std::string, size_t> tags;
+  std::map<std::string, size_t> notebooks;
+
+  for (const auto& [id, entry] : notes) {
+    records.push_back(key(kIdRecord, encodeEntry(entry)));
+    std::string title = clean(entry.title);
+    records.push_back(key(kTitleRecord, lower(title)) + kField + id + kField + title);
+
+    std::set<std::string> distinct;
+    for (const auto& tag : entry.tags) {
+      distinct.insert(clean(tag));
+    }
+    for (const auto& tag : distinct) {
+      ++tags[tag];
+    }
+    if (entry.notebook.has_value()) {
+      ++notebooks[clean(*entry.notebook)];
+    }
+  }
+  for (const auto& [tag, count] : tags) {
+    records.push_back(key(kTagRecord, tag) + kField + std::to_string(count));
+  }
+  for (const auto& [notebook, count] : notebooks) {
+    records.push_back(key(kNotebookRecord, notebook) + kField + std::to_string(count));
+  }
+  std::sort(records.begin(), records.end());
+
+  std::string content(kHeader);
+  content += kField;
+  content += std::to_string(stamp);
+  content += '\n';
+  for (const auto& record : records) {
+    content += record;
+    content += '\n';
+  }
+  return content;
+}
+
+std::string readAll(int fd) {
+  std::string data;
+  char buffer[16 * 1024];
+  off_t offset = 0;
+  while (true) {
+    ssize_t n = ::pread(fd, buffer, sizeof(buffer), offset);
+    if (n <= 0) {
+      return data;
+    }
+    data.append(buffer, static_cast<size_t>(n));
+    offset += n;
+  }
+}
+
+// Read-only mapping of a whole file; invalid when missing or empty
+class MappedFile {
+public:
+  explicit MappedFile(const std::filesystem::path& path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+      return;
+    }
+    struct stat st {};
+    if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+      auto size = static_cast<size_t>(st.st_size);
+      void* data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (data != MAP_FAILED) {
+        data_ = static_cast<const char*>(data);
+        size_ = size;
+      }
+    }
+    ::close(fd);
+  }
+
+  ~MappedFile() {
+    if (data_ != nullptr) {
+      ::munmap(const_cast<char*>(data_), size_);
+    }
+  }
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  bool valid() const { return data_ != nullptr; }
+  std::string_view view() const { return {data_, size_}; }
+
+private:
+  const char* data_ = nullptr;
+  size_t size_ = 0;
+};
+
+// Newline-terminated records in byte order, searched in place
+class SortedRecords {
+public:
+  explicit SortedRecords(std::string_view data) : data_(data) {}
+
+  // Offset of the first record not less than key. Bisects byte offsets and
+  // snaps each probe back to the start of its line.
+  size_t lowerBound(std::string_view key) const {
+    size_t lo = 0;
+    size_t hi = data_.size();
+    while (lo < hi) {
+      size_t start = lineStart(lo + (hi - lo) / 2);
+      std::string_view line = lineAt(start);
+      if (line < key) {
+        lo = start + line.size() + 1;
+      } else {
+        hi = start;
+      }
+    }
+    return lo;
+  }
+
+  // Records starting with prefix, in order, until visit returns false
+  template <typename Visit>
+  void scan(std::string_view prefix, Visit&& visit) const {
+    size_t offset = lowerBound(prefix);
+    while (offset < data_.size()) {
+      std::string_view line = lineAt(offset);
+      if (!line.starts_with(prefix) || !visit(line.substr(prefix.size()))) {
+        return;
+      }
+      offset += line.size() + 1;
+    }
+  }
+
+  std::optional<Entry> findNote(const std::string& id) const {
+    std::optional<Entry> found;
+    std::string prefix = key(kIdRecord, id + kField);
+    size_t offset = lowerBound(prefix);
+    if (offset < data_.size()) {
+      std::string_view line = lineAt(offset);
+      if (line.starts_with(prefix)) {
+        found = decodeEntry(line.substr(2));
+      }
+    }
+    return found;
+  }
+
+private:
+  size_t lineStart(size_t offset) const {
+    while (offset > 0 && data_[offset - 1] != '\n') {
+      --offset;
+    }
+    return offset;
+  }
+
+  std::string_view lineAt(size_t offset) const {
+    size_t end = data_.find('\n', offset);
+    return data_.substr(offset, (end == std::string_view::npos ? data_.size() : end) - offset);
+  }
+
+  std::string_view data_;
+};
+
+// Counted names (tags, notebooks) with the journal's changes applied
+std::vector<Candidate> completeCounted(const SortedRecords& records, char kind, const std::string& prefix,
+                                       const std::map<std::string, std::optional<Entry>>& changes,
+                                       const std::map<std::string, std::optional<Entry>>& before,
+                                       size_t limit) {
+  auto names = [kind](const std::optional<Entry>& entry) {
+    std::set<std::string> out;
+    if (!entry.has_value()) {
+      return out;
+    }
+    if (kind == kTagRecord) {
+      for (const auto& tag : entry->tags) {
+        out.insert(clean(tag));
+      }
+    } else if (entry->notebook.has_value()) {
+      out.insert(clean(*entry->notebook));
+    }
+    return out;
+  };
+
+  // Only names the changes touch can drop out of the scanned range; read that many extra
+  std::set<std::string> touched;
+  for (const auto& [id, after] : changes) {
+    for (const auto& entry : {before.at(id), after}) {
+      for (const auto& name : names(entry)) {
+        if (name.starts_with(prefix)) {
+          touched.insert(name);
+        }
+      }
+    }
+  }
+  size_t wanted = limit + touched.size();
+  std::map<std::string, long> counts;
+  records.scan(key(kind, prefix), [&](std::string_view rest) {
+    auto fields = split(rest, kField);
+    if (fields.size() == 2) {
+      counts[prefix + std::string(fields[0])] = std::strtol(std::string(fields[1]).c_str(), nullptr, 10);
+    }
+    return counts.size() < wanted;
+  });
+
+  for (const auto& [id, after] : changes) {
+    for (const auto& name : names(before.at(id))) {
+      if (name.starts_with(prefix)) {
+        --counts[name];
+      }
+    }
+    for (const auto& name : names(after)) {
+      if (name.starts_with(prefix)) {
+        ++counts[name];
+      }
+    }
+  }
+
+  std::vector<Candidate> candidates;
+  for (const auto& [name, count] : counts) {
+    if (count > 0 && candidates.size() < limit) {
+      candidates.push_back({name, std::to_string(count)});
+    }
+  }
+  return candidates;
+}
+
+}  // namespace
+
+CompletionCache::Entry CompletionCache::Entry::fromNote(const nx::core::Note& note) {
+  Entry entry;
+  entry.id = note.id();
+  entry.title = note.title();
+  entry.notebook = note.notebook();
+  entry.tags = note.metadata().tags();
+  return entry;
+}
+
+CompletionCache::CompletionCache(Config config) : config_(std::move(config)) {
+}
+
+std::filesystem::path CompletionCache::journalPath() const {
+  return config_.file.string() + ".journal";
+}
+
+bool CompletionCache::exists() const {
+  std::error_code ec;
+  return std::filesystem::exists(config_.file, ec);
+}
+
+uint64_t CompletionCache::notesVersion() const {
+  if (config_.notes_dir.empty()) {
+    return 0;
+  }
+  std::error_code ec;
+  auto modified = std::filesystem::last_write_time(config_.notes_dir, ec);
+  return ec ? 0 : static_cast<uint64_t>(modified.time_since_epoch().count());
+}
+
+std::filesystem::path CompletionCache::defaultFile(const std::filesystem::path& notes_dir) {
+  // One cache per vault, named by an FNV-1a hash of the notes directory's canonical path
+  std::error_code ec;
+  auto canonical = std::filesystem::weakly_canonical(notes_dir, ec);
+  uint64_t hash = 14695981039346656037ULL;
+  for (char c : (ec ? notes_dir : canonical).string()) {
+    hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ULL;
+  }
+  char name[32];
+  std::snprintf(name, sizeof(name), "completions-%016llx", static_cast<unsigned long long>(hash));
+  return nx::util::Xdg::cacheHome() / name;
+}
+
+std::optional<CompletionCache::Kind> CompletionCache::parseKind(const std::string& name) {
+  if (name == "ids") return Kind::kIds;
+  if (name == "titles") return Kind::kTitles;
+  if (name == "notes") return Kind::kNotes;
+  if (name == "tags") return Kind::kTags;
+  if (name == "notebooks") return Kind::kNotebooks;
+  return std::nullopt;
+}
+
+Result<void> CompletionCache::rebuild(const std::vector<Entry>& entries, std::optional<uint64_t> notes_version) {
+  std::error_code ec;
+  std::filesystem::create_directories(config_.file.parent_path(), ec);
+
+  // The journal lock also guards the sorted file: nothing appends mid-rebuild
+  int fd = ::open(journalPath().c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    return std::unexpected(makeError(ErrorCode::kFileWriteError,
+                                     "Cannot open completion journal: " + journalPath().string()));
+  }
+  ::flock(fd, LOCK_EX);
+
+  std::map<std::string, Entry> notes;
+  for (const auto& entry : entries) {
+    notes[entry.id.toString()] = entry;
+  }
+  auto written = nx::util::FileSystem::writeFileAtomic(config_.file,
+                                                      buildRecords(notes, notes_version.value_or(notesVersion())));
+  if (written.has_value() && ::ftruncate(fd, 0) != 0) {
+    written = std::unexpected(makeError(ErrorCode::kFileWriteError, "Cannot reset completion journal"));
+  }
+  ::close(fd);
+  return written;
+}
+
+Result<void> CompletionCache::upsert(const Entry& entry, std::optional<uint64_t> notes_version) {
+  return append(std::string("+") + kField + encodeEntry(entry), notes_version);
+}
+
+Result<void> CompletionCache::remove(const nx::core::NoteId& id, std::optional<uint64_t> notes_version) {
+  return append(std::string("-") + kField + id.toString(), notes_version);
+}
+
+Result<void> CompletionCache::append(const std::string& record, std::optional<uint64_t> notes_version) {
+  // Until the first lookup builds the cache there is nothing to keep current
+  if (!exists()) {
+    return {};
+  }
+
+  int fd = ::open(journalPath().c_str(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644);  // Read back by compact()
+  if (fd < 0) {
+    discard();
+    return std::unexpected(makeError(ErrorCode::kFileWriteError,
+                                     "Cannot open completion journal: " + journalPath().string()));
+  }
+  ::flock(fd, LOCK_EX);
+
+  // The new stamp vouches for every change up to now, so only stamp when the cache was
+  // current just before this change; otherwise leave it stale for the next lookup
+  std::string line = record + '\n';
+  if (!config_.notes_dir.empty() && notes_version.has_value()) {
+    MappedFile base(config_.file);
+    if (base.valid() && currentStamp(base.view(), readAll(fd)) == *notes_version) {
+      line += std::string(1, kStamp) + kField + std::to_string(notesVersion()) + '\n';
+    }
+  }
+
+  Result<void> result;
+  struct stat st {};
+  if (::write(fd, line.data(), line.size()) != static_cast<ssize_t>(line.size())) {
+    result = std::unexpected(makeError(ErrorCode::kFileWriteError, "Cannot append to completion journal"));
+  } else if (::fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) > config_.max_journal_bytes) {
+    result = compact(fd);
+  }
+  ::close(fd);
+
+  // A cache that missed a change must not answer again
+  if (!result.has_value()) {
+    discard();
+  }
+  return result;
+}
+
+Result<void> CompletionCache::compact(int journal_fd) {
+  MappedFile base(config_.file);
+  if (!base.valid()) {
+    return std::unexpected(makeError(ErrorCode::kFileReadError, "Cannot read completion cache"));
+  }
+
+  // Every note's full state is in its id record, so no note needs to be read
+  std::map<std::string, Entry> notes;
+  SortedRecords(base.view()).scan(key(kIdRecord, ""), [&](std::string_view rest) {
+    auto entry = decodeEntry(rest);
+    if (entry.has_value()) {
+      notes[entry->id.toString()] = std::move(*entry);
+    }
+    return true;
+  });
+  std::string journal = readAll(journal_fd);
+  uint64_t stamp = currentStamp(base.view(), journal);
+  for (auto& [id, entry] : parseJournal(journal)) {
+    if (entry.has_value()) {
+      notes[id] = std::move(*entry);
+    } else {
+      notes.erase(id);
+    }
+  }
+
+  auto written = nx::util::FileSystem::writeFileAtomic(config_.file, buildRecords(notes, stamp));
+  if (!written.has_value()) {
+    return written;
+  }
+  if (::ftruncate(journal_fd, 0) != 0) {
+    return std::unexpected(makeError(ErrorCode::kFileWriteError, "Cannot reset completion journal"));
+  }
+  return {};
+}
+
+void CompletionCache::discard() {
+  std::error_code ec;
+  std::filesystem::remove(config_.file, ec);
+  std::filesystem::remove(journalPath(), ec);
+}
+
+Result<std::vector<CompletionCache::Candidate>> CompletionCache::complete(Kind kind, const std::string& prefix,
+                                                                          size_t limit) const {
+  // A compaction swaps the file and empties the journal under the exclusive lock;
+  // holding the shared lock while both are opened sees one state or the other.
+  // (Replaying a journal onto a file that already holds it changes nothing.)
+  std::string journal;
+  int journal_fd = ::open(journalPath().c_str(), O_RDONLY | O_CLOEXEC);
+  if (journal_fd >= 0) {
+    ::flock(journal_fd, LOCK_SH);
+    journal = readAll(journal_fd);
+  }
+  MappedFile base(config_.file);
+  if (journal_fd >= 0) {
+    ::close(journal_fd);
+  }
+  if (!base.valid() || !base.view().starts_with(kHeader)) {
+    return std::unexpected(makeError(ErrorCode::kNotFound, "Completion cache has not been built"));
+  }
+  // Notes added, removed or replaced by anything but the store (an editor, git, sync)
+  if (!config_.notes_dir.empty() && currentStamp(base.view(), journal) != notesVersion()) {
+    return std::unexpected(makeError(ErrorCode::kNotFound, "Completion cache is out of date"));
+  }
+
+  SortedRecords records(base.view());
+  auto changes = parseJournal(journal);
+  std::map<std::string, std::optional<Entry>> before;
+  for (const auto& [id, entry] : changes) {
+    before[id] = records.findNote(id);
+  }
+
+  if (kind == Kind::kTags) {
+    return completeCounted(records, kTagRecord, prefix, changes, before, limit);
+  }
+  if (kind == Kind::kNotebooks) {
+    return completeCounted(records, kNotebookRecord, prefix, changes, before, limit);
+  }
+
+  // Notes: (sort key, candidate) so journal additions merge into the sorted order
+  size_t wanted = limit + changes.size();
+  std::vector<std::pair<std::string, Candidate>> by_id;
+  std::vector<std::pair<std::string, Candidate>> by_title;
+
+  if (kind == Kind::kIds || kind == Kind::kNotes) {
+    std::string id_prefix = upper(prefix);
+    records.scan(key(kIdRecord, id_prefix), [&](std::string_view rest) {
+      auto fields = split(rest, kField);
+      if (fields.size() == 4) {
+        std::string id = id_prefix + std::string(fields[0]);
+        if (!changes.contains(id)) {
+          by_id.push_back({id, {id, std::string(fields[1])}});
+        }
+      }
+      return by_id.size() < wanted;
+    });
+    for (const auto& [id, entry] : changes) {
+      if (entry.has_value() && id.starts_with(id_prefix)) {
+        by_id.push_back({id, {id, clean(entry->title)}});
+      }
+    }
+    std::sort(by_id.begin(), by_id.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+  }
+
+  if (kind == Kind::kTitles || kind == Kind::kNotes) {
+    std::string title_prefix = lower(prefix);
+    records.scan(key(kTitleRecord, title_prefix), [&](std::string_view rest) {
+      auto fields = split(rest, kField);
+      if (fields.size() == 3) {
+        std::string id(fields[1]);
+        if (!changes.contains(id)) {
+          by_title.push_back({title_prefix + std::string(fields[0]) + kField + id,
+                              {std::string(fields[2]), id}});
+        }
+      }
+      return by_title.size() < wanted;
+    });
+    for (const auto& [id, entry] : changes) {
+      if (!entry.has_value()) {
+        continue;
+      }
+      std::string title = clean(entry->title);
+      if (lower(title).starts_with(title_prefix)) {
+        by_title.push_back({lower(title) + kField + id, {title, id}});
+      }
+    }
+    std::sort(by_title.begin(), by_title.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+  }
+
+  std::vector<Candidate> candidates;
+  std::set<std::string> seen;
+  for (const auto& [sort_key, candidate] : by_id) {
+    if (candidates.size() < limit && seen.insert(candidate.value).second) {
+      candidates.push_back(candidate);
+    }
+  }
+  for (const auto& [sort_key, candidate] : by_title) {
+    if (candidates.size() >= limit) {
+      break;
+    }
+    if (kind == Kind::kTitles) {
+      candidates.push_back(candidate);
+    } else if (seen.insert(candidate.description).second) {
+      // Notes complete to ids: a title match offers its note's id
+      candidates.push_back({candidate.description, candidate.value});
+    }
+  }
+  return candidates;
+}
+
+}  // namespace nx::store
@@ -5,6 +5,7 @@
 #include <set>
 
 #include "nx/util/filesystem.hpp"
+#include "nx/util/timing.hpp"
 
 namespace nx::store {
 
@@ -26,9 +27,17 @@ FilesystemStore::FilesystemStore(Config config) : config_(std::move(config)) {
   if (config_.auto_create_dirs) {
     ensureDirectories();
   }
+  
+  if (!config_.completion_file.empty()) {
+    CompletionCache::Config completion_config;
+    completion_config.file = config_.completion_file;
+    completion_config.notes_dir = config_.notes_dir;
+    completions_ = std::make_unique<CompletionCache>(completion_config);
+  }
 }
 
 Result<void> FilesystemStore::store(const nx::core::Note& note) {
+  nx::util::ScopedTimer timer("store.store");
   // Validate note
   auto validation_result = note.validate();
   if (!validation_result.has_value()) {
@@ -50,6 +59,7 @@ Result<void> FilesystemStore::store(const nx::core::Note& note) {
   std::string file_content = note.toFileFormat();
   
   // Atomic write
+  auto completions_version = completionsVersion();
   auto write_result = nx::util::FileSystem::writeFileAtomic(note_path, file_content);
   if (!write_result.has_value()) {
     return write_result;
@@ -57,6 +67,7 @@ Result<void> FilesystemStore::store(const nx::core::Note& note) {
   
   // Update cache
   updateMetadataCache(note);
+  updateCompletions(note.id(), &note, completions_version);
   
   // Notify change
   notifyChange(note.id(), "store");
@@ -65,6 +76,7 @@ Result<void> FilesystemStore::store(const nx::core::Note& note) {
 }
 
 Result<nx::core::Note> FilesystemStore::load(const nx::core::NoteId& id) {
+  nx::util::ScopedTimer timer("store.load");
   // Find note file
   auto file_path_result = findNoteFile(id);
   if (!file_path_result.has_value()) {
@@ -129,6 +141,7 @@ Result<std::vector<nx::core::Note>> FilesystemStore::loadBatch(const std::vector
 }
 
 Result<std::vector<nx::core::NoteId>> FilesystemStore::list(const NoteQuery& query) {
+  nx::util::ScopedTimer timer("store.list");
   auto files_result = getAllNoteFiles();
   if (!files_result.has_value()) {
     return std::unexpected(files_result.error());
@@ -212,6 +225,35 @@ Result<std::vector<nx::core::Note>> FilesystemStore::search(const NoteQuery& que
   return loadBatch(*ids_result);
 }
 
+Result<size_t> FilesystemStore::forEach(const NoteQuery& query, const NoteVisitor& visit) {
+  // Ids only: listing without filters reads no note files
+  NoteQuery order;
+  order.sort_order = query.sort_order;
+  auto ids_result = list(order);
+  if (!ids_result.has_value()) {
+    return std::unexpected(ids_result.error());
+  }
+  
+  // Filter and visit in the same pass, so each note is read once
+  size_t skipped = 0;
+  size_t visited = 0;
+  for (const auto& id : *ids_result) {
+    auto note = load(id);
+    if (!note.has_value() || !matchesQuery(*note, query)) {
+      continue;
+    }
+    if (skipped < query.offset) {
+      ++skipped;
+      continue;
+    }
+    ++visited;
+    if (!visit(*note) || (query.limit > 0 && visited >= query.limit)) {
+      break;
+    }
+  }
+  return visited;
+}
+
 Result<size_t> FilesystemStore::count(const NoteQuery& query) {
   auto ids_result = list(query);
   if (!ids_result.has_value()) {
@@ -318,6 +360,7 @@ Result<void> FilesystemStore::restore(const nx::core::NoteId& id) {
 Result<void> FilesystemStore::permanentlyDelete(const nx::core::NoteId& id) {
   // Try to delete from main directory first
   auto note_path = getNotePath(id);
+  auto completions_version = completionsVersion();
   if (std::filesystem::exists(note_path)) {
     auto result = nx::util::FileSystem::removeFile(note_path);
     if (!result.has_value()) {
@@ -336,6 +379,7 @@ Result<void> FilesystemStore::permanentlyDelete(const nx::core::NoteId& id) {
   
   // Remove from cache
   invalidateCache(id);
+  updateCompletions(id, nullptr, completions_version);
   
   // Notify change
   notifyChange(id, "delete");
@@ -685,6 +729,23 @@ void FilesystemStore::notifyChange(const nx::core::NoteId& id, const std::string
   }
 }
 
+uint64_t FilesystemStore::completionsVersion() const {
+  return completions_ ? completions_->notesVersion() : 0;
+}
+
+void FilesystemStore::updateCompletions(const nx::core::NoteId& id, const nx::core::Note* note,
+                                        uint64_t notes_version) {
+  if (!completions_) {
+    return;
+  }
+  // Best effort: a failed update discards the cache, which is rebuilt on the next lookup
+  if (note != nullptr) {
+    (void)completions_->upsert(CompletionCache::Entry::fromNote(*note), notes_version);
+  } else {
+    (void)completions_->remove(id, notes_version);
+  }
+}
+
 Result<void> FilesystemStore::validateNoteFile(const std::filesystem::path& path) const {
   // Read and parse the file to ensure it's valid
   auto content_result = nx::util::FileSystem::readFile(path);
@@ -709,12 +770,14 @@ Result<void> FilesystemStore::moveToTrash(const nx::core::NoteId& id) {
                                      "Note not found: " + id.toString()));
   }
   
+  auto completions_version = completionsVersion();
   auto result = nx::util::FileSystem::moveFile(note_path, trash_path);
   if (!result.has_value()) {
     return result;
   }
   
   // Keep in cache but mark as trashed somehow
+  updateCompletions(id, nullptr, completions_version);
   notifyChange(id, "trash");
   
   return {};
@@ -729,11 +792,19 @@ Result<void> FilesystemStore::restoreFromTrash(const nx::core::NoteId& id) {
                                      "Note not found in trash: " + id.toString()));
   }
   
+  auto completions_version = completionsVersion();
   auto result = nx::util::FileSystem::moveFile(trash_path, note_path);
   if (!result.has_value()) {
     return result;
   }
   
+  if (completions_) {
+    auto restored = load(id);
+    if (restored.has_value()) {
+      updateCompletions(id, &*restored, completions_version);
+    }
+  }
+  
   notifyChange(id, "restore");
   
   return {};
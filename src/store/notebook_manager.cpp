@@ -7,6 +7,7 @@
 #include "nx/store/note_store.hpp"
 #include "nx/core/note.hpp"
 #include "nx/common.hpp"
+#include "nx/index/index.hpp"
 
 namespace nx::store {
 
@@ -24,6 +25,10 @@ NotebookManager::NotebookManager(NoteStore& note_store)
   : note_store_(note_store) {
 }
 
+NotebookManager::NotebookManager(NoteStore& note_store, IndexProvider index_provider)
+  : note_store_(note_store), index_provider_(std::move(index_provider)) {
+}
+
 Result<void> NotebookManager::createNotebook(const std::string& name) {
   // Validate notebook name
   auto validation_result = validateNotebookName(name);
@@ -54,7 +59,7 @@ Result<void> NotebookManager::createNotebook(const std::string& name) {
   placeholder_note.setNotebook(name);
   
   // Store the placeholder note
-  auto store_result = note_store_.store(placeholder_note);
+  auto store_result = storeNote(placeholder_note);
   if (!store_result.has_value()) {
     return std::unexpected(store_result.error());
   }
@@ -103,7 +108,7 @@ Result<void> NotebookManager::deleteNotebook(const std::string& name, bool force
   
   // Delete all notes in the notebook
   for (const auto& id : note_ids) {
-    auto delete_result = note_store_.remove(id, false);  // Hard delete
+    auto delete_result = removeNote(id);  // Hard delete
     if (!delete_result.has_value()) {
       // Note: Failed to delete note during notebook cleanup
       // We continue to avoid partial cleanup state, but this could be improved with proper logging
@@ -167,7 +172,7 @@ Result<void> NotebookManager::renameNotebook(const std::string& old_name, const
       note.setContent("# .notebook_" + new_name + "\n\nNotebook renamed on " + std::ctime(&time_t));
     }
     
-    auto store_result = note_store_.store(note);
+    auto store_result = storeNote(note);
     if (!store_result.has_value()) {
       return std::unexpected(store_result.error());
     }
@@ -177,6 +182,17 @@ Result<void> NotebookManager::renameNotebook(const std::string& old_name, const
 }
 
 Result<std::vector<NotebookInfo>> NotebookManager::listNotebooks(bool include_stats) {
+  // One set of GROUP BY queries answers for every notebook at once
+  if (auto aggregates = indexAggregates()) {
+    std::vector<NotebookInfo> notebook_infos;
+    for (const auto& aggregate : aggregates->notebooks) {
+      if (aggregate.notebook.has_value()) {
+        notebook_infos.push_back(infoFromAggregate(aggregate, include_stats));
+      }
+    }
+    return notebook_infos;  // Already in name order
+  }
+  
   // Get all notebooks from the note store
   auto notebooks_result = note_store_.getAllNotebooks();
   if (!notebooks_result.has_value()) {
@@ -217,6 +233,16 @@ Result<std::vector<NotebookInfo>> NotebookManager::listNotebooks(bool include_st
 }
 
 Result<NotebookInfo> NotebookManager::getNotebookInfo(const std::string& name, bool include_stats) {
+  if (auto aggregates = indexAggregates()) {
+    for (const auto& aggregate : aggregates->notebooks) {
+      if (aggregate.notebook == name) {
+        return infoFromAggregate(aggregate, include_stats);
+      }
+    }
+    return std::unexpected(makeError(ErrorCode::kNotFound, 
+      "Notebook '" + name + "' not found"));
+  }
+  
   // Check if notebook exists
   auto exists_result = notebookExists(name);
   if (!exists_result.has_value()) {
@@ -331,7 +357,7 @@ Result<void> NotebookManager::moveAllNotes(const std::string& from_notebook,
     note.setNotebook(to_notebook);
     note.touch();
     
-    auto store_result = note_store_.store(note);
+    auto store_result = storeNote(note);
     if (!store_result.has_value()) {
       return std::unexpected(store_result.error());
     }
@@ -594,4 +620,72 @@ std::vector<std::string> NotebookManager::getTopTags(const std::map<std::string,
   return top_tags;
 }
 
+nx::index::Index* NotebookManager::index() {
+  return index_provider_ ? index_provider_() : nullptr;
+}
+
+Result<void> NotebookManager::storeNote(const nx::core::Note& note) {
+  auto result = note_store_.store(note);
+  if (!result.has_value()) {
+    return result;
+  }
+  // Listings are answered from the index, so it has to see every notebook change
+  if (auto* search_index = index()) {
+    return search_index->updateNote(note);
+  }
+  return {};
+}
+
+Result<void> NotebookManager::removeNote(const nx::core::NoteId& id) {
+  auto result = note_store_.remove(id, false);
+  if (!result.has_value()) {
+    return result;
+  }
+  if (auto* search_index = index()) {
+    return search_index->removeNote(id);
+  }
+  return {};
+}
+
+std::optional<nx::index::IndexAggregates> NotebookManager::indexAggregates() {
+  auto* search_index = index();
+  if (search_index == nullptr) {
+    return std::nullopt;
+  }
+  
+  // Whole minutes, so repeated listings share a cached answer
+  nx::index::AggregateQuery query;
+  query.recent_since = std::chrono::floor<std::chrono::minutes>(
+      std::chrono::system_clock::now() - std::chrono::hours(24 * 7));
+  query.skip_title_prefix = std::string(PLACEHOLDER_PREFIX);
+  
+  auto aggregates = search_index->aggregate(query);
+  if (!aggregates.has_value()) {
+    return std::nullopt;
+  }
+  return std::move(*aggregates);
+}
+
+NotebookInfo NotebookManager::infoFromAggregate(const nx::index::NotebookAggregate& aggregate,
+                                                bool include_stats) {
+  NotebookInfo info(aggregate.notebook.value_or(""));
+  
+  // Same rules as calculateNotebookStats(): placeholders only count in an otherwise empty notebook
+  if (!include_stats || aggregate.note_count == 0) {
+    info.note_count = aggregate.note_count + aggregate.skipped_count;
+    return info;
+  }
+  
+  info.note_count = aggregate.note_count;
+  info.created = aggregate.first_created;
+  info.last_modified = aggregate.last_modified;
+  info.recent_notes = aggregate.recent_notes;
+  info.total_size = aggregate.total_size;
+  for (const auto& tag_count : aggregate.tags) {
+    info.tag_counts[tag_count.tag] = tag_count.count;
+  }
+  info.tags = getTopTags(info.tag_counts, TOP_TAGS_LIMIT);
+  return info;
+}
+
 }  // namespace nx::store
\ No newline at end of file
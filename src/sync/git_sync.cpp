@@ -9,6 +9,7 @@
 
 // Implementation uses git commands via SafeProcess for reliable cross-platform operation
 #include "nx/util/safe_process.hpp"
+#include "nx/util/trace.hpp"
 
 namespace nx::sync {
 
@@ -215,6 +216,8 @@ Result<SyncInfo> GitSync::getStatus() const {
 }
 
 Result<void> GitSync::commit(const std::string& message, const std::vector<std::string>& files) {
+  nx::util::TraceSpan span("sync.commit");
+  span.arg("files", files.size());
   if (message.empty()) {
     return std::unexpected(makeError(ErrorCode::kInvalidArgument,
                                      "Commit message cannot be empty"));
@@ -256,6 +259,8 @@ Result<void> GitSync::commit(const std::string& message, const std::vector<std::
 }
 
 Result<void> GitSync::pull(const std::string& strategy) {
+  nx::util::TraceSpan span("sync.pull");
+  span.arg("strategy", strategy);
   std::vector<std::string> args = {"pull"};
   
   if (strategy == "rebase") {
@@ -276,6 +281,7 @@ Result<void> GitSync::pull(const std::string& strategy) {
 }
 
 Result<void> GitSync::push(bool force) {
+  nx::util::TraceSpan span("sync.push");
   std::vector<std::string> args = {"push"};
   
   if (force) {
@@ -293,6 +299,7 @@ Result<void> GitSync::push(bool force) {
 }
 
 Result<SyncInfo> GitSync::sync(bool auto_resolve) {
+  nx::util::TraceSpan span("sync.sync");
   // Get current status
   auto status_result = getStatus();
   if (!status_result.has_value()) {
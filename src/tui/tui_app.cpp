@@ -15,6 +15,8 @@
 #include <cctype>
 #include <atomic>
 #include <thread>
+#include <unordered_map>
+#include <unordered_set>
 #ifndef _WIN32
 #include <unistd.h>
 #include <sys/wait.h>
@@ -23,6 +25,9 @@
 
 #include <nlohmann/json.hpp>
 #include "nx/util/http_client.hpp"
+#include "nx/util/timing.hpp"
+#include "nx/util/trace.hpp"
+#include "nx/util/xdg.hpp"
 
 #include <ftxui/component/component.hpp>
 #include <ftxui/component/component_options.hpp>
@@ -47,6 +52,64 @@ static void signalHandler(int signal) {
   std::exit(signal);
 }
 
+namespace {
+
+// OpenAI embeddings for the semantic search index (wrapped in a CachingEmbedder)
+class OpenAiEmbedder : public nx::index::Embedder {
+public:
+  OpenAiEmbedder(std::string api_key, std::string model)
+      : api_key_(std::move(api_key)), model_(std::move(model)) {}
+
+  size_t dimensions() const override {
+    return model_.find("large") != std::string::npos ? 3072 : 1536;
+  }
+
+  std::string name() const override { return "openai-" + model_; }
+
+  Result<std::vector<float>> embed(const std::string& text) override {
+    // Roughly the model's 8k token input limit
+    constexpr size_t kMaxInputBytes = 24000;
+    nlohmann::json request_body = {
+      {"model", model_},
+      {"input", text.empty() ? std::string(" ") : text.substr(0, kMaxInputBytes)}
+    };
+    std::vector<std::string> headers = {
+      "Content-Type: application/json",
+      "User-Agent: nx-cli/1.0.0",
+      "Authorization: Bearer " + api_key_
+    };
+
+    auto response = http_client_.post("https://api.openai.com/v1/embeddings", request_body.dump(), headers);
+    if (!response.has_value()) {
+      return std::unexpected(Error(ErrorCode::kNetworkError, "Embedding request failed: " + response.error().message()));
+    }
+
+    try {
+      auto response_json = nlohmann::json::parse(response->body);
+      if (response_json.contains("error")) {
+        return std::unexpected(Error(ErrorCode::kAiError, "OpenAI API error: " + response_json["error"]["message"].get<std::string>()));
+      }
+      return response_json.at("data").at(0).at("embedding").get<std::vector<float>>();
+    } catch (const std::exception& e) {
+      return std::unexpected(Error(ErrorCode::kParseError, "Unexpected embedding response: " + std::string(e.what())));
+    }
+  }
+
+private:
+  std::string api_key_;
+  std::string model_;
+  nx::util::HttpClient http_client_;
+};
+
+// Search-as-you-type shows at most this many ranked hits, a screenful or two
+constexpr size_t kPrefixSearchLimit = 100;
+
+// Shorter queries keep substring matching: a one- or two-letter word prefix matches
+// most notes, and fragments that short are usually typed to find text mid-word
+constexpr size_t kMinPrefixSearchLength = 3;
+
+}  // namespace
+
 TUIApp::TUIApp(nx::config::Config& config, 
                nx::store::NoteStore& note_store,
                nx::store::NotebookManager& notebook_manager,
@@ -179,6 +242,8 @@ int TUIApp::run() {
 Component TUIApp::createMainComponent() {
   
   return Renderer([this] {
+    nx::util::ScopedTimer timer("tui.render");
+    
     // Calculate layout based on terminal size and smart sizing
     auto terminal_width = screen_.dimx();
     auto sizing = calculatePanelSizing(terminal_width);
@@ -357,6 +422,7 @@ Component TUIApp::createMainComponent() {
     
     return main_view;
   }) | CatchEvent([this](Event event) {
+    nx::util::TraceSpan span("tui.event");
     onKeyPress(event);
     return true;
   });
@@ -413,6 +479,9 @@ Result<void> TUIApp::loadNotes() {
       }
     }
     
+    // Only notes whose content changed are re-parsed for links
+    link_graph_.sync(state_.all_notes);
+    
     // Copy to filtered list and apply current sorting
     state_.notes = state_.all_notes;
     sortNotes();
@@ -425,12 +494,20 @@ Result<void> TUIApp::loadNotes() {
 
 Result<void> TUIApp::loadTags() {
   try {
-    // Extract tags from all loaded notes
+    // Prefer the counts maintained by the search index
     std::map<std::string, int> tag_counts;
     
-    for (const auto& metadata : state_.all_notes) {
-      for (const auto& tag : metadata.tags()) {
-        tag_counts[tag]++;
+    auto index_counts = search_index_.getTagCounts();
+    if (index_counts.has_value() && (!index_counts->empty() || state_.all_notes.empty())) {
+      for (const auto& tag_count : *index_counts) {
+        tag_counts[tag_count.tag] = static_cast<int>(tag_count.count);
+      }
+    } else {
+      // Index unavailable or not yet populated - extract tags from loaded notes
+      for (const auto& metadata : state_.all_notes) {
+        for (const auto& tag : metadata.tags()) {
+          tag_counts[tag]++;
+        }
       }
     }
     
@@ -601,11 +678,10 @@ void TUIApp::applyFilters() {
     search_query.text = state_.search_query;
     search_query.limit = 1000; // Large limit to get all matches
     
-    auto search_result = search_index_.search(search_query);
-    if (search_result) {
-      for (const auto& result : *search_result) {
-        content_matches.insert(result.id);
-      }
+    // Only membership matters here, so skip snippets and result decoding
+    auto ids_result = search_index_.searchIds(search_query);
+    if (ids_result) {
+      content_matches.insert(ids_result->begin(), ids_result->end());
     }
     
     // Filter notes: include if found in title OR in content (via search index)
@@ -2055,9 +2131,13 @@ void TUIApp::performSearch(const std::string& query) {
   }
   
   try {
-    // Use consistent simple filtering for real-time search to avoid 
-    // the jarring transition between different search methods
-    performSimpleFilter(query);
+    // Search-as-you-type: the prefix index answers "word starting with what
+    // was typed" without loading every note. Queries under three characters,
+    // and those it finds nothing for (mid-word fragments, punctuation, stale
+    // index), use the substring scan.
+    if (!performPrefixSearch(query)) {
+      performSimpleFilter(query);
+    }
     
   } catch (const std::exception& e) {
     setStatusMessage("Search error: " + std::string(e.what()));
@@ -2111,7 +2191,27 @@ void TUIApp::performSimpleFilter(const std::string& query) {
   std::string query_lower = query;
   std::transform(query_lower.begin(), query_lower.end(), query_lower.begin(), ::tolower);
   
+  // Trigram candidates from the index; only these need loading and scanning.
+  // Notes the index has never seen (edited outside nx) are always scanned.
+  std::unordered_set<std::string> indexed_ids;
+  std::unordered_set<std::string> candidate_ids;
+  auto indexed_result = search_index_.scanCandidates("");
+  auto candidates_result = search_index_.scanCandidates(query);
+  if (indexed_result.has_value() && candidates_result.has_value()) {
+    for (const auto& id : *indexed_result) {
+      indexed_ids.insert(id.toString());
+    }
+    for (const auto& id : *candidates_result) {
+      candidate_ids.insert(id.toString());
+    }
+  }
+  
   for (const auto& metadata : cache.notes) {
+    std::string id_str = metadata.id().toString();
+    if (indexed_ids.contains(id_str) && !candidate_ids.contains(id_str)) {
+      continue;
+    }
+    
     bool matches = false;
     
     // Check content only
@@ -2140,26 +2240,72 @@ void TUIApp::performSimpleFilter(const std::string& query) {
   loadTags();
 }
 
+bool TUIApp::performPrefixSearch(const std::string& query) {
+  if (query.size() < kMinPrefixSearchLength) {
+    return false;
+  }
+  
+  nx::index::SearchQuery search_query;
+  search_query.text = query;
+  search_query.prefix_last_term = true;
+  search_query.limit = kPrefixSearchLimit;
+  search_query.highlight = false;
+  
+  // Ids and titles only: the notes themselves are already in all_notes
+  auto results = search_index_.search(search_query);
+  if (!results || results->empty()) {
+    return false;
+  }
+  
+  std::unordered_map<std::string, const nx::core::Note*> loaded;
+  loaded.reserve(state_.all_notes.size());
+  for (const auto& note : state_.all_notes) {
+    loaded.emplace(note.id().toString(), &note);
+  }
+  
+  std::vector<nx::core::Note> search_notes;
+  search_notes.reserve(results->size());
+  for (const auto& result : *results) {
+    if (result.title.starts_with(".notebook_")) {
+      continue;
+    }
+    if (auto it = loaded.find(result.id.toString()); it != loaded.end()) {
+      search_notes.push_back(*it->second);
+    } else if (auto note_result = note_store_.load(result.id)) {
+      // Written since the list was last loaded
+      search_notes.push_back(*note_result);
+    }
+  }
+  if (search_notes.empty()) {
+    return false;
+  }
+  
+  state_.notes = search_notes;
+  
+  // Reset selection
+  state_.selected_note_index = 0;
+  state_.selected_notes.clear();
+  
+  // Update tags for the filtered results
+  loadTags();
+  return true;
+}
+
 void TUIApp::performFullTextSearch(const std::string& query) {
   // Use the search index for full-text search functionality
   nx::index::SearchQuery search_query;
   search_query.text = query;
   
-  auto search_result = search_index_.search(search_query);
-  if (!search_result) {
-    setStatusMessage("Search error: " + search_result.error().message());
+  // Ranked ids only; the full notes come from the store below
+  auto ids_result = search_index_.searchIds(search_query);
+  if (!ids_result) {
+    setStatusMessage("Search error: " + ids_result.error().message());
     return;
   }
   
-  // Extract note IDs from search results
-  std::vector<nx::core::NoteId> note_ids;
-  for (const auto& result : *search_result) {
-    note_ids.push_back(result.id);
-  }
-  
   // Load the full notes for these IDs
   std::vector<nx::core::Note> search_notes;
-  for (const auto& note_id : note_ids) {
+  for (const auto& note_id : *ids_result) {
     auto note_result = note_store_.load(note_id);
     if (note_result) {
       search_notes.push_back(*note_result);
@@ -3015,15 +3161,8 @@ void TUIApp::followLinkInPreview() {
   
   const auto& note = state_.notes[static_cast<size_t>(state_.selected_note_index)];
   
-  // Load the current note to get links
-  auto note_result = note_store_.load(note.metadata().id());
-  if (!note_result) {
-    setStatusMessage("Error loading note for link following");
-    return;
-  }
-  
-  // Extract links from the note
-  auto links = note_result->extractContentLinks();
+  // Outgoing ULID and wiki-links, resolved by the link graph
+  auto links = link_graph_.outgoing(note.metadata().id());
   
   if (links.empty()) {
     setStatusMessage("No links found in current note");
@@ -3381,20 +3520,9 @@ Element TUIApp::renderPreviewPane() const {
     // Links info - calculate real backlinks and outlinks
     std::string links_info = "Links: ";
     
-    // Get backlinks
-    auto backlinks_result = note_store_.getBacklinks(note.metadata().id());
-    int backlinks_count = 0;
-    if (backlinks_result) {
-      backlinks_count = static_cast<int>(backlinks_result->size());
-    }
-    
-    // Get outlinks from note content
-    auto note_for_links = note_store_.load(note.metadata().id());
-    int outlinks_count = 0;
-    if (note_for_links) {
-      auto outlinks = note_for_links->extractContentLinks();
-      outlinks_count = static_cast<int>(outlinks.size());
-    }
+    // Both directions come from the link graph, so rendering reads no files
+    auto backlinks_count = link_graph_.backlinks(note.metadata().id()).size();
+    auto outlinks_count = link_graph_.outgoing(note.metadata().id()).size();
     
     links_info += std::to_string(backlinks_count) + " backlinks, " + 
                   std::to_string(outlinks_count) + " outlinks";
@@ -3530,6 +3658,8 @@ Element TUIApp::renderHelpModal() const {
   help_content.push_back(text("SEARCH & FILTERING") | bold | color(Color::Green));
   help_content.push_back(text("  Real-time filtering as you type      Enter: finish search"));
   help_content.push_back(text("  Searches note titles & content       Esc: cancel and show all"));
+  help_content.push_back(text("  3+ chars: words starting with them   (no hits: any substring)"));
+  help_content.push_back(text("  1-2 chars: any substring             Shows the top 100 matches"));
   help_content.push_back(text(""));
   
   help_content.push_back(text("NOTEBOOK MANAGEMENT") | bold | color(Color::Magenta));
@@ -6560,19 +6690,85 @@ void TUIApp::handleSemanticSearch() {
   setStatusMessage("🧠 Semantic Search - describe what you're looking for (Enter to search, Esc to cancel)");
 }
 
+Result<void> TUIApp::syncVectorIndex(const nx::config::Config::AiConfig& ai_config) {
+  if (!vector_index_) {
+    // Provider embeddings when configured (cached per content hash), otherwise offline hashing
+    std::shared_ptr<nx::index::Embedder> embedder;
+    if (ai_config.enable_embeddings && ai_config.provider == "openai" && !ai_config.embedding_model.empty()) {
+      nx::index::CachingEmbedder::Config cache_config;
+      cache_config.cache_file = nx::util::Xdg::cacheHome() / "embeddings.cache";
+      embedder = std::make_shared<nx::index::CachingEmbedder>(
+          std::make_shared<OpenAiEmbedder>(ai_config.api_key, ai_config.embedding_model), cache_config);
+    } else {
+      embedder = std::make_shared<nx::index::HashingEmbedder>();
+    }
+
+    nx::index::VectorIndex::Config index_config;
+    index_config.index_file = nx::util::Xdg::indexFile().parent_path() / "vectors.hnsw";
+    vector_index_ = std::make_unique<nx::index::VectorIndex>(std::move(embedder), index_config);
+    (void)vector_index_->load();  // A missing or damaged file only means embedding again
+  }
+
+  // Only new and edited notes are embedded
+  auto embedded = vector_index_->sync(state_.all_notes);
+  if (!embedded.has_value()) {
+    return std::unexpected(embedded.error());
+  }
+  return *embedded > 0 ? vector_index_->save() : Result<void>{};
+}
+
 Result<std::vector<nx::core::NoteId>> TUIApp::performSemanticSearch(const std::string& query,
                                                                      const nx::config::Config::AiConfig& ai_config) {
+  auto synced = syncVectorIndex(ai_config);
+  if (!synced.has_value()) {
+    return std::unexpected(synced.error());
+  }
+
+  // Candidates are found locally; only they are sent to the AI for re-ranking
+  auto hits = vector_index_->search(query, std::max<size_t>(ai_config.semantic_search.max_notes_per_query, 1));
+  if (!hits.has_value()) {
+    return std::unexpected(hits.error());
+  }
+  std::vector<nx::core::NoteId> candidates;
+  for (const auto& hit : *hits) {
+    candidates.push_back(hit.id);
+  }
+  if (candidates.size() <= 1) {
+    return candidates;
+  }
+
+  // Without a usable AI response the local ranking stands
+  auto reranked = rerankSemanticCandidates(query, candidates, ai_config);
+  if (!reranked.has_value()) {
+    return candidates;
+  }
+  return reranked;
+}
+
+Result<std::vector<nx::core::NoteId>> TUIApp::rerankSemanticCandidates(const std::string& query,
+                                                                        const std::vector<nx::core::NoteId>& candidates,
+                                                                        const nx::config::Config::AiConfig& ai_config) {
   try {
-    // Prepare the prompt for semantic search
+    // Prepare the prompt for re-ranking
     std::string prompt = "You are helping with semantic search of notes. "
-                        "Based on the user's query, identify the most relevant notes from the following collection. "
+                        "Based on the user's query, rank the following candidate notes by relevance. "
                         "Consider the semantic meaning, not just keyword matching. "
-                        "Return only note IDs separated by newlines, no explanations.\n\n"
+                        "Return only the IDs of relevant notes, most relevant first, separated by newlines, no explanations.\n\n"
                         "User query: " + query + "\n\n"
-                        "Available notes:\n";
+                        "Candidate notes:\n";
     
-    // Add all notes to the prompt
+    std::unordered_map<std::string, const nx::core::Note*> notes_by_id;
     for (const auto& note : state_.all_notes) {
+      notes_by_id[note.metadata().id().toString()] = &note;
+    }
+
+    // Add the candidates to the prompt
+    for (const auto& candidate : candidates) {
+      auto found = notes_by_id.find(candidate.toString());
+      if (found == notes_by_id.end()) {
+        continue;
+      }
+      const auto& note = *found->second;
       prompt += "ID: " + note.metadata().id().toString() + "\n";
       prompt += "Title: " + note.title() + "\n";
       prompt += "Content: " + note.content().substr(0, 200) + "...\n"; // First 200 chars
@@ -6687,11 +6883,14 @@ Result<std::vector<nx::core::NoteId>> TUIApp::performSemanticSearch(const std::s
         continue; // Skip empty lines and comments
       }
       
-      auto note_id_result = nx::core::NoteId::fromString(line);
-      if (note_id_result.has_value()) {
-        note_ids.push_back(*note_id_result);
+      // Keep only candidates, once each; anything else is invented
+      auto found = notes_by_id.find(line);
+      if (found == notes_by_id.end() ||
+          std::find(candidates.begin(), candidates.end(), found->second->metadata().id()) == candidates.end() ||
+          std::find(note_ids.begin(), note_ids.end(), found->second->metadata().id()) != note_ids.end()) {
+        continue;
       }
-      // Skip invalid note IDs if fromString fails
+      note_ids.push_back(found->second->metadata().id());
     }
     
     return note_ids;
@@ -7687,14 +7886,32 @@ Result<std::vector<std::pair<nx::core::NoteId, std::string>>> TUIApp::analyzeNot
       headers.push_back("anthropic-version: 2023-06-01");
     }
     
-    // Get a sample of other notes for analysis (limited by config)
-    std::vector<nx::core::Note> sample_notes;
-    size_t max_notes = std::min(ai_config.note_relationships.max_notes_to_analyze, state_.all_notes.size());
+    // Send the most similar notes rather than whichever come first (limited by config)
+    if (!related_index_) {
+      related_index_ = std::make_unique<nx::index::MinHashIndex>();
+    }
+    related_index_->sync(state_.all_notes);
     
-    for (size_t i = 0; i < max_notes && sample_notes.size() < max_notes; ++i) {
-      const auto& note = state_.all_notes[i];
-      if (note.metadata().id() != current_note.metadata().id()) {
-        sample_notes.push_back(note);
+    std::unordered_map<std::string, const nx::core::Note*> notes_by_id;
+    for (const auto& note : state_.all_notes) {
+      notes_by_id[note.metadata().id().toString()] = &note;
+    }
+    
+    // Notes already linked either way are known relationships; don't spend the request on them
+    std::unordered_set<std::string> linked;
+    for (const auto& neighbor : link_graph_.neighborhood(current_note.metadata().id(), 1)) {
+      linked.insert(neighbor.id.toString());
+    }
+    
+    std::vector<nx::core::Note> sample_notes;
+    auto matches = related_index_->similar(current_note.metadata().id(),
+                                           ai_config.note_relationships.max_notes_to_analyze + linked.size());
+    for (const auto& match : matches) {
+      auto key = match.id.toString();
+      auto it = notes_by_id.find(key);
+      if (it != notes_by_id.end() && !linked.contains(key) &&
+          sample_notes.size() < ai_config.note_relationships.max_notes_to_analyze) {
+        sample_notes.push_back(*it->second);
       }
     }
     
@@ -11091,6 +11308,30 @@ Result<std::string> TUIApp::generateKnowledgeGraph(const std::vector<nx::core::N
       prompt += "- " + concept_pair.first + " (" + std::to_string(concept_pair.second) + " occurrences)\n";
     }
     
+    // Explicit links are already known: take hubs and clusters from the link graph
+    std::unordered_map<std::string, std::string> titles_by_id;
+    for (const auto& note : state_.all_notes) {
+      titles_by_id[note.metadata().id().toString()] = note.title();
+    }
+    auto titleOf = [&titles_by_id](const nx::core::NoteId& id) {
+      auto it = titles_by_id.find(id.toString());
+      return it != titles_by_id.end() ? it->second : id.toString();
+    };
+    
+    auto link_stats = link_graph_.stats();
+    auto hubs = link_graph_.centrality(5);
+    auto clusters = link_graph_.components(2);
+    
+    prompt += "\nExisting Link Structure (" + std::to_string(link_stats.links) + " links, " +
+              std::to_string(clusters.size()) + " clusters):\n";
+    for (const auto& hub : hubs) {
+      prompt += "- Hub: " + titleOf(hub.id) + "\n";
+    }
+    for (size_t i = 0; i < std::min(size_t(5), clusters.size()); ++i) {
+      prompt += "- Cluster of " + std::to_string(clusters[i].size()) + " notes around " +
+                titleOf(clusters[i].front()) + "\n";
+    }
+    
     prompt += "\nPlease generate:\n"
               "1. Knowledge graph nodes (key concepts and entities)\n"
               "2. Relationship mappings between concepts\n"
@@ -11102,8 +11343,13 @@ Result<std::string> TUIApp::generateKnowledgeGraph(const std::vector<nx::core::N
     // Implementation follows same HTTP client pattern as other Phase 7 functions
     // [HTTP client code omitted for brevity - follows same pattern as analyzeCollaborativeSession]
     
-    return "Knowledge graph generated with " + std::to_string(concept_frequency.size()) + 
-           " concepts and " + std::to_string(note_summaries.size()) + " notes analyzed.";
+    std::string summary = std::to_string(link_stats.notes) + " notes, " + std::to_string(link_stats.links) +
+                          " links, " + std::to_string(clusters.size()) + " clusters, " +
+                          std::to_string(link_stats.isolated) + " unlinked";
+    if (!hubs.empty()) {
+      summary += "; top hub: " + titleOf(hubs.front().id);
+    }
+    return summary + " (" + std::to_string(concept_frequency.size()) + " concepts)";
     
   } catch (const std::exception& e) {
     return std::unexpected(Error(ErrorCode::kAiError, "Failed to generate knowledge graph: " + std::string(e.what())));
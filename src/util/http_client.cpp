@@ -1,4 +1,5 @@
 #include "nx/util/http_client.hpp"
+#include "nx/util/timing.hpp"
 
 #include <curl/curl.h>
 #include <sstream>
@@ -73,8 +74,13 @@ Result<HttpResponse> HttpClient::post(const std::string& url,
     // Set timeout
     curl_easy_setopt(pImpl->curl, CURLOPT_TIMEOUT, 60L);
     
-    // Perform the request
-    CURLcode res = curl_easy_perform(pImpl->curl);
+    // Perform the request (every caller is an AI provider round trip)
+    CURLcode res;
+    {
+        ScopedTimer timer("ai.request");
+        timer.arg("request_bytes", body.size());
+        res = curl_easy_perform(pImpl->curl);
+    }
     
     // Clean up headers
     if (header_list) {
@@ -20,6 +20,8 @@
 #include <algorithm>
 #include <sstream>
 
+#include "nx/util/trace.hpp"
+
 #ifndef _WIN32
 extern char **environ;
 #endif
@@ -237,6 +239,120 @@ Result<pid_t> SafeProcess::executeAsync(
 #endif
 }
 
+Result<int> SafeProcess::executeStreaming(
+    const std::string& command,
+    const std::vector<std::string>& args,
+    const std::function<bool(std::string_view)>& on_line) {
+  TraceSpan span("process.stream");
+  span.arg("command", command).arg("args", args.size());
+#ifdef _WIN32
+  // Windows stub implementation
+  return std::unexpected(makeError(ErrorCode::kProcessError,
+                                   "Streaming process execution not implemented on Windows"));
+#else
+  
+  // Validate inputs
+  if (!SafeProcess::isValidCommand(command)) {
+    return std::unexpected(makeError(ErrorCode::kInvalidArgument,
+                                     "Invalid command name: " + command));
+  }
+  
+  for (const auto& arg : args) {
+    if (!SafeProcess::isValidArgument(arg)) {
+      return std::unexpected(makeError(ErrorCode::kInvalidArgument,
+                                       "Invalid argument: " + arg.substr(0, 50) + "..."));
+    }
+  }
+  
+  // Find the command in PATH
+  auto command_path = findCommand(command);
+  if (!command_path.has_value()) {
+    return std::unexpected(makeError(ErrorCode::kNotFound, 
+                                     "Command not found: " + command));
+  }
+  
+  int stdout_pipe[2] = {-1, -1};
+  if (pipe(stdout_pipe) == -1) {
+    return std::unexpected(makeError(ErrorCode::kSystemError,
+                                     "Failed to create pipe: " + std::string(strerror(errno))));
+  }
+  
+  std::vector<std::string> full_args;
+  full_args.push_back(command);
+  full_args.insert(full_args.end(), args.begin(), args.end());
+  
+  SafeArgvBuilder argv_builder(full_args);
+  
+  // stdout to our pipe; stderr to /dev/null so an unread stderr pipe can't block the child
+  posix_spawn_file_actions_t file_actions;
+  posix_spawn_file_actions_init(&file_actions);
+  posix_spawn_file_actions_adddup2(&file_actions, stdout_pipe[1], STDOUT_FILENO);
+  posix_spawn_file_actions_addopen(&file_actions, STDERR_FILENO, "/dev/null", O_WRONLY, 0);
+  posix_spawn_file_actions_addclose(&file_actions, stdout_pipe[0]);
+  posix_spawn_file_actions_addclose(&file_actions, stdout_pipe[1]);
+  
+  pid_t pid;
+  int spawn_result = posix_spawn(&pid, command_path->c_str(), &file_actions, nullptr,
+                                argv_builder.data(), environ);
+  posix_spawn_file_actions_destroy(&file_actions);
+  safeClose(stdout_pipe[1]);
+  
+  if (spawn_result != 0) {
+    safeClose(stdout_pipe[0]);
+    return std::unexpected(makeError(ErrorCode::kProcessError,
+                                     "Failed to spawn process: " + std::string(strerror(spawn_result))));
+  }
+  
+  // Split the stream into lines, keeping any partial line for the next read
+  constexpr size_t BUFFER_SIZE = 65536;
+  std::vector<char> buffer(BUFFER_SIZE);
+  std::string pending;
+  bool stopped = false;
+  ssize_t bytes_read;
+  
+  while (!stopped && (bytes_read = read(stdout_pipe[0], buffer.data(), buffer.size())) > 0) {
+    pending.append(buffer.data(), static_cast<size_t>(bytes_read));
+    
+    size_t line_start = 0;
+    size_t newline;
+    while ((newline = pending.find('\n', line_start)) != std::string::npos) {
+      if (!on_line(std::string_view(pending).substr(line_start, newline - line_start))) {
+        stopped = true;
+        break;
+      }
+      line_start = newline + 1;
+    }
+    pending.erase(0, line_start);
+  }
+  
+  if (!stopped && !pending.empty()) {
+    on_line(pending);
+  }
+  
+  if (stopped) {
+    kill(pid, SIGTERM);
+  }
+  safeClose(stdout_pipe[0]);
+  
+  int status;
+  if (waitpid(pid, &status, 0) == -1) {
+    return std::unexpected(makeError(ErrorCode::kSystemError,
+                                     "Failed to wait for process: " + std::string(strerror(errno))));
+  }
+  
+  if (stopped) {
+    return 0;
+  }
+  if (WIFEXITED(status)) {
+    return WEXITSTATUS(status);
+  }
+  if (WIFSIGNALED(status)) {
+    return 128 + WTERMSIG(status);
+  }
+  return -1;
+#endif
+}
+
 bool SafeProcess::isArgumentSafe(const std::string& arg) {
   return isValidArgument(arg);
 }
@@ -306,6 +422,8 @@ Result<SafeProcess::ProcessResult> SafeProcess::executeInternal(
     const std::vector<std::string>& args,
     const std::optional<std::string>& working_dir,
     bool capture_output) {
+  TraceSpan span("process.run");
+  span.arg("command", command).arg("args", args.size());
 #ifdef _WIN32
   // Windows stub implementation
   ProcessResult result;
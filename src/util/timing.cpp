@@ -0,0 +1,254 @@
+#include "nx/util/timing.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <cmath>
+#include <fstream>
+
+#include <nlohmann/json.hpp>
+
+namespace nx::util {
+
+namespace {
+
+bool parseNumber(std::string_view text, uint64_t& out) {
+  auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), out);
+  return ec == std::errc() && end == text.data() + text.size();
+}
+
+}  // namespace
+
+// LatencyHistogram
+
+size_t LatencyHistogram::bucketFor(uint64_t micros) {
+  micros = std::min(micros, kMaxMicros);
+  if (micros < kSubBuckets) {
+    return static_cast<size_t>(micros);
+  }
+  // The top kSubBucketBits + 1 bits pick the step within this power of two
+  auto shift = static_cast<unsigned>(std::bit_width(micros)) - 1 - kSubBucketBits;
+  return static_cast<size_t>(shift * kSubBuckets + (micros >> shift));
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(size_t bucket) {
+  if (bucket < 2 * kSubBuckets) {
+    return bucket;
+  }
+  uint64_t shift = bucket / kSubBuckets - 1;
+  uint64_t top = bucket - shift * kSubBuckets;
+  return ((top + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(std::chrono::nanoseconds elapsed) {
+  auto micros = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+  recordMicros(micros > 0 ? static_cast<uint64_t>(micros) : 0);
+}
+
+void LatencyHistogram::recordMicros(uint64_t micros) {
+  ++counts_[bucketFor(micros)];
+  ++count_;
+  total_micros_ += micros;
+  max_micros_ = std::max(max_micros_, micros);
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+  for (size_t i = 0; i < kBuckets; ++i) {
+    counts_[i] += other.counts_[i];
+  }
+  count_ += other.count_;
+  total_micros_ += other.total_micros_;
+  max_micros_ = std::max(max_micros_, other.max_micros_);
+}
+
+uint64_t LatencyHistogram::percentileMicros(double percentile) const {
+  if (count_ == 0) {
+    return 0;
+  }
+  percentile = std::clamp(percentile, 0.0, 100.0);
+  auto rank = static_cast<uint64_t>(std::ceil(percentile / 100.0 * static_cast<double>(count_)));
+  rank = std::max<uint64_t>(rank, 1);
+
+  uint64_t seen = 0;
+  for (size_t i = 0; i < kBuckets; ++i) {
+    seen += counts_[i];
+    if (seen >= rank) {
+      // No sample exceeds the maximum, however wide its bucket
+      return std::min(bucketUpperBound(i), max_micros_);
+    }
+  }
+  return max_micros_;
+}
+
+std::string LatencyHistogram::encode() const {
+  // Total and max up front: the buckets alone cannot give them back exactly
+  std::string out = std::to_string(total_micros_) + ';' + std::to_string(max_micros_) + ';';
+  bool first = true;
+  for (size_t i = 0; i < kBuckets; ++i) {
+    if (counts_[i] == 0) {
+      continue;
+    }
+    if (!first) {
+      out += ',';
+    }
+    out += std::to_string(i) + ':' + std::to_string(counts_[i]);
+    first = false;
+  }
+  return out;
+}
+
+Result<LatencyHistogram> LatencyHistogram::decode(std::string_view text) {
+  auto invalid = [&text]() {
+    return std::unexpected(makeError(ErrorCode::kParseError, "Invalid histogram: " + std::string(text)));
+  };
+
+  size_t first = text.find(';');
+  size_t second = first == std::string_view::npos ? first : text.find(';', first + 1);
+  if (second == std::string_view::npos) {
+    return invalid();
+  }
+
+  LatencyHistogram histogram;
+  if (!parseNumber(text.substr(0, first), histogram.total_micros_) ||
+      !parseNumber(text.substr(first + 1, second - first - 1), histogram.max_micros_)) {
+    return invalid();
+  }
+
+  std::string_view buckets = text.substr(second + 1);
+  while (!buckets.empty()) {
+    size_t comma = buckets.find(',');
+    std::string_view pair = buckets.substr(0, comma);
+    buckets = comma == std::string_view::npos ? std::string_view{} : buckets.substr(comma + 1);
+
+    size_t colon = pair.find(':');
+    uint64_t bucket = 0;
+    uint64_t count = 0;
+    if (colon == std::string_view::npos || !parseNumber(pair.substr(0, colon), bucket) ||
+        !parseNumber(pair.substr(colon + 1), count) || bucket >= kBuckets) {
+      return invalid();
+    }
+    histogram.counts_[bucket] += count;
+    histogram.count_ += count;
+  }
+  return histogram;
+}
+
+// Timings
+
+Timings& Timings::global() {
+  static Timings timings;
+  return timings;
+}
+
+void Timings::record(std::string_view phase, std::chrono::nanoseconds elapsed) {
+  if (!enabled()) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  // A command touches a handful of phases; a linear scan beats hashing the name
+  for (auto& existing : phases_) {
+    if (existing.name == phase) {
+      existing.histogram.record(elapsed);
+      return;
+    }
+  }
+  phases_.push_back(Phase{std::string(phase), {}});
+  phases_.back().histogram.record(elapsed);
+}
+
+std::vector<Timings::Phase> Timings::phases() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return phases_;
+}
+
+void Timings::reset() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  phases_.clear();
+}
+
+// ScopedTimer
+
+ScopedTimer::ScopedTimer(const char* phase)
+    : span_(phase), phase_(Timings::global().enabled() ? phase : nullptr) {
+  if (phase_ != nullptr) {
+    start_ = std::chrono::steady_clock::now();
+  }
+}
+
+ScopedTimer::~ScopedTimer() {
+  if (phase_ != nullptr) {
+    Timings::global().record(phase_, std::chrono::steady_clock::now() - start_);
+  }
+}
+
+// MetricsFile
+
+Result<void> MetricsFile::append(const Run& run) const {
+  nlohmann::json line;
+  line["command"] = run.command;
+  line["started_ms"] =
+      std::chrono::duration_cast<std::chrono::milliseconds>(run.started.time_since_epoch()).count();
+  line["elapsed_us"] = std::chrono::duration_cast<std::chrono::microseconds>(run.elapsed).count();
+  line["phases"] = nlohmann::json::array();
+  for (const auto& phase : run.phases) {
+    line["phases"].push_back({{"name", phase.name}, {"histogram", phase.histogram.encode()}});
+  }
+  std::string text = line.dump() + '\n';
+
+  std::error_code ec;
+  if (path_.has_parent_path()) {
+    std::filesystem::create_directories(path_.parent_path(), ec);
+  }
+  // One write on an O_APPEND descriptor keeps concurrent runs from interleaving lines
+  int fd = ::open(path_.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    return std::unexpected(makeError(ErrorCode::kFileWriteError, "Cannot open metrics file: " + path_.string()));
+  }
+  ssize_t written = ::write(fd, text.data(), text.size());
+  ::close(fd);
+  if (written != static_cast<ssize_t>(text.size())) {
+    return std::unexpected(makeError(ErrorCode::kFileWriteError, "Cannot append to metrics file: " + path_.string()));
+  }
+  return {};
+}
+
+Result<std::vector<MetricsFile::Run>> MetricsFile::read(std::chrono::system_clock::time_point since) const {
+  std::ifstream file(path_);
+  if (!file) {
+    return std::unexpected(makeError(ErrorCode::kFileNotFound, "Cannot open metrics file: " + path_.string()));
+  }
+
+  std::vector<Run> runs;
+  std::string line;
+  while (std::getline(file, line)) {
+    auto json = nlohmann::json::parse(line, nullptr, false);
+    if (json.is_discarded() || !json.is_object()) {
+      continue;
+    }
+    try {
+      Run run;
+      run.command = json.at("command").get<std::string>();
+      run.started = std::chrono::system_clock::time_point(
+          std::chrono::milliseconds(json.at("started_ms").get<int64_t>()));
+      run.elapsed = std::chrono::microseconds(json.at("elapsed_us").get<int64_t>());
+      if (run.started < since) {
+        continue;
+      }
+      for (const auto& phase : json.value("phases", nlohmann::json::array())) {
+        auto histogram = LatencyHistogram::decode(phase.at("histogram").get<std::string>());
+        if (histogram.has_value()) {
+          run.phases.push_back({phase.at("name").get<std::string>(), std::move(*histogram)});
+        }
+      }
+      runs.push_back(std::move(run));
+    } catch (const nlohmann::json::exception&) {
+      // A line cut short by a crash, or from another version; the rest still count
+    }
+  }
+  return runs;
+}
+
+}  // namespace nx::util
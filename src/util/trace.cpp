@@ -0,0 +1,169 @@
+#include "nx/util/trace.hpp"
+
+#include <unistd.h>
+
+#include <cstdlib>
+
+#include "nx/util/filesystem.hpp"
+
+namespace nx::util {
+
+namespace {
+
+void appendJsonString(std::string& out, std::string_view text) {
+  out += '"';
+  for (char c : text) {
+    switch (c) {
+      case '"': out += "\\\""; break;
+      case '\\': out += "\\\\"; break;
+      case '\n': out += "\\n"; break;
+      case '\r': out += "\\r"; break;
+      case '\t': out += "\\t"; break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          static constexpr char kHex[] = "0123456789abcdef";
+          out += "\\u00";
+          out += kHex[(c >> 4) & 0xf];
+          out += kHex[c & 0xf];
+        } else {
+          out += c;
+        }
+    }
+  }
+  out += '"';
+}
+
+void appendKey(std::string& out, std::string_view key) {
+  if (!out.empty()) {
+    out += ',';
+  }
+  appendJsonString(out, key);
+  out += ':';
+}
+
+int64_t micros(std::chrono::steady_clock::duration duration) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+}
+
+}  // namespace
+
+Tracer& Tracer::global() {
+  static Tracer tracer;
+  return tracer;
+}
+
+uint32_t Tracer::threadId() {
+  // Small sequential ids read better in the viewer than native thread handles
+  static std::atomic<uint32_t> next{1};
+  thread_local uint32_t id = next.fetch_add(1, std::memory_order_relaxed);
+  return id;
+}
+
+void Tracer::startFromEnvironment() {
+  const char* path = std::getenv(kEnvironmentVariable);
+  if (path != nullptr && *path != '\0' && !enabled()) {
+    start(path);
+  }
+}
+
+void Tracer::start(std::filesystem::path path) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    path_ = std::move(path);
+    epoch_ = std::chrono::steady_clock::now();
+    events_.clear();
+    thread_names_.clear();
+    dropped_ = 0;
+  }
+  nameThread("main");
+  enabled_.store(true, std::memory_order_relaxed);
+
+  // Commands that leave through std::exit still get their trace written
+  static std::once_flag at_exit;
+  std::call_once(at_exit, []() { std::atexit([]() { (void)Tracer::global().flush(); }); });
+}
+
+void Tracer::stop() {
+  enabled_.store(false, std::memory_order_relaxed);
+  std::lock_guard<std::mutex> lock(mutex_);
+  events_.clear();
+  thread_names_.clear();
+  dropped_ = 0;
+}
+
+void Tracer::nameThread(std::string name) {
+  uint32_t id = threadId();
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto& [thread, existing] : thread_names_) {
+    if (thread == id) {
+      existing = std::move(name);
+      return;
+    }
+  }
+  thread_names_.emplace_back(id, std::move(name));
+}
+
+void Tracer::complete(const char* name, std::chrono::steady_clock::time_point start,
+                      std::chrono::steady_clock::time_point end, std::string args) {
+  uint32_t thread = threadId();
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (events_.size() >= kMaxEvents) {
+    ++dropped_;
+    return;
+  }
+  events_.push_back(Event{name, micros(start - epoch_), micros(end - start), thread, std::move(args)});
+}
+
+Result<void> Tracer::flush() {
+  if (!enabled()) {
+    return {};
+  }
+
+  std::string pid = std::to_string(::getpid());
+  std::string out = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  for (const auto& [thread, name] : thread_names_) {
+    out += "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":" + pid + ",\"tid\":" + std::to_string(thread) +
+           ",\"args\":{\"name\":";
+    appendJsonString(out, name);
+    out += "}},\n";
+  }
+  for (const auto& event : events_) {
+    std::string_view name(event.name);
+    size_t dot = name.find('.');
+    out += "{\"ph\":\"X\",\"name\":";
+    appendJsonString(out, name);
+    out += ",\"cat\":";
+    appendJsonString(out, dot == std::string_view::npos ? std::string_view("nx") : name.substr(0, dot));
+    out += ",\"ts\":" + std::to_string(event.start_us) + ",\"dur\":" + std::to_string(event.duration_us) +
+           ",\"pid\":" + pid + ",\"tid\":" + std::to_string(event.thread) + ",\"args\":{" + event.args + "}},\n";
+  }
+  // Trailing metadata event: keeps the array well-formed after the last comma
+  out += "{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":" + pid +
+         ",\"args\":{\"name\":\"nx\",\"dropped_events\":" + std::to_string(dropped_) + "}}\n]}\n";
+
+  return FileSystem::writeFileAtomic(path_, out);
+}
+
+#if NX_TRACING
+
+TraceSpan& TraceSpan::arg(std::string_view key, std::string_view value) {
+  if (name_ != nullptr) {
+    appendKey(args_, key);
+    appendJsonString(args_, value);
+  }
+  return *this;
+}
+
+TraceSpan& TraceSpan::arg(std::string_view key, int64_t value) {
+  if (name_ != nullptr) {
+    appendKey(args_, key);
+    args_ += std::to_string(value);
+  }
+  return *this;
+}
+
+#endif
+
+}  // namespace nx::util
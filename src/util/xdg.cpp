@@ -4,6 +4,8 @@
 #include <filesystem>
 #include <iostream>
 
+#include <unistd.h>
+
 namespace nx::util {
 
 std::filesystem::path Xdg::dataHome() {
@@ -60,8 +62,8 @@ std::filesystem::path Xdg::runtimeDir() {
     return std::filesystem::path(xdg_runtime_dir) / "nx";
   }
   
-  // Fallback to temp directory
-  return std::filesystem::temp_directory_path() / "nx";
+  // Fallback to temp directory, one per user so users never share it
+  return std::filesystem::temp_directory_path() / ("nx-" + std::to_string(::geteuid()));
 }
 
 bool Xdg::ensureDirectory(const std::filesystem::path& path, std::filesystem::perms perms) {
@@ -0,0 +1,81 @@
+#include <benchmark/benchmark.h>
+
+#include <thread>
+
+#include "nx/cli/daemon.hpp"
+#include "nx/index/index.hpp"
+#include "nx/store/note_store.hpp"
+#include "cli_services.hpp"
+#include "corpus_generator.hpp"
+#include "temp_directory.hpp"
+
+using namespace nx::cli;
+using namespace nx::test;
+
+namespace {
+
+// A daemon serving a 500-note vault from a background thread, for the lifetime of one benchmark
+class RunningDaemon {
+public:
+  RunningDaemon() {
+    auto container = makeCliServices(dir_.path());
+    auto note_store = container->resolve<nx::store::NoteStore>();
+    auto index = container->resolve<nx::index::Index>();
+    CorpusGenerator generator({.note_count = 500, .min_content_size = 200, .max_content_size = 2000});
+    for (const auto& note : generator.generateCorpus()) {
+      (void)note_store->store(note);
+      (void)index->addNote(note);
+    }
+
+    socket_path_ = dir_.path() / "daemon.sock";
+    daemon_ = std::make_unique<Daemon>(container, Daemon::Config{socket_path_, dir_.path() / "notes", std::chrono::minutes{0}});
+    thread_ = std::thread([this] { (void)daemon_->run(); });
+    while (!Daemon::request(socket_path_, {{"ping", true}})) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+
+  ~RunningDaemon() {
+    (void)Daemon::request(socket_path_, {{"shutdown", true}});
+    thread_.join();
+  }
+
+  const std::filesystem::path& socketPath() const { return socket_path_; }
+
+private:
+  TempDirectory dir_;
+  std::filesystem::path socket_path_;
+  std::unique_ptr<Daemon> daemon_;
+  std::thread thread_;
+};
+
+}  // namespace
+
+// Connection and protocol overhead alone
+static void BM_DaemonPing(benchmark::State& state) {
+  RunningDaemon daemon;
+  for (auto _ : state) {
+    auto reply = Daemon::request(daemon.socketPath(), {{"ping", true}});
+    benchmark::DoNotOptimize(reply);
+  }
+}
+BENCHMARK(BM_DaemonPing)->Unit(benchmark::kMicrosecond);
+
+// A forwarded command end to end: what `nx ls` / `nx grep` pay when a daemon is running
+// (the target is under 5 ms)
+static void BM_DaemonForwardedCommand(benchmark::State& state, std::vector<std::string> argv) {
+  RunningDaemon daemon;
+  nlohmann::json message{{"argv", argv}, {"cwd", std::filesystem::current_path().string()}};
+  for (auto _ : state) {
+    auto reply = Daemon::request(daemon.socketPath(), message);
+    if (!reply || reply->value("exit_code", 1) != 0) {
+      state.SkipWithError("forwarded command failed");
+      break;
+    }
+    benchmark::DoNotOptimize(reply);
+  }
+}
+BENCHMARK_CAPTURE(BM_DaemonForwardedCommand, ls, std::vector<std::string>{"nx", "ls"})
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_DaemonForwardedCommand, grep, std::vector<std::string>{"nx", "grep", "the"})
+    ->Unit(benchmark::kMillisecond);
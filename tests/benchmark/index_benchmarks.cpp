@@ -0,0 +1,382 @@
+#include <benchmark/benchmark.h>
+
+#include <fstream>
+#include <string>
+#include <unordered_map>
+
+#include "nx/index/link_graph.hpp"
+#include "nx/index/memory_index.hpp"
+#include "nx/index/minhash_index.hpp"
+#include "nx/index/native_grep_index.hpp"
+#include "nx/index/sqlite_index.hpp"
+#include "nx/index/vector_index.hpp"
+#include "corpus_generator.hpp"
+#include "temp_directory.hpp"
+
+using namespace nx::core;
+using namespace nx::index;
+using namespace nx::test;
+
+namespace {
+
+// Shared corpus so every variant indexes the same notes
+const std::vector<Note>& indexCorpus() {
+  static const std::vector<Note> corpus = [] {
+    CorpusGenerator generator({
+      .note_count = 2000,
+      .min_content_size = 500,
+      .max_content_size = 4000,
+      .link_probability = 0.0
+    });
+    return generator.generateCorpus();
+  }();
+  return corpus;
+}
+
+// Stands in for the note store: contentless indexes read bodies back from here
+const std::unordered_map<std::string, std::string>& corpusBodies() {
+  static const std::unordered_map<std::string, std::string> bodies = [] {
+    std::unordered_map<std::string, std::string> map;
+    for (const auto& note : indexCorpus()) {
+      map.emplace(note.id().toString(), note.content());
+    }
+    return map;
+  }();
+  return bodies;
+}
+
+SqliteIndex::Config indexConfig(int64_t contentless) {
+  SqliteIndex::Config config;
+  config.content_mode = contentless ? SqliteIndex::ContentMode::kContentless
+                                    : SqliteIndex::ContentMode::kFull;
+  config.content_provider = [](const NoteId& id) -> std::optional<std::string> {
+    auto it = corpusBodies().find(id.toString());
+    if (it == corpusBodies().end()) {
+      return std::nullopt;
+    }
+    return it->second;
+  };
+  return config;
+}
+
+bool buildIndex(SqliteIndex& index) {
+  if (!index.initialize() || !index.beginTransaction()) {
+    return false;
+  }
+  for (const auto& note : indexCorpus()) {
+    if (!index.addNote(note)) {
+      return false;
+    }
+  }
+  return index.commitTransaction().has_value() && index.optimize().has_value();
+}
+
+}  // namespace
+
+// Index build time and on-disk size, full content vs contentless FTS
+static void BM_SqliteIndexBuild(benchmark::State& state) {
+  if (state.range(0) && !SqliteIndex::contentlessSupported()) {
+    state.SkipWithError("SQLite lacks contentless_delete (needs 3.43+)");
+    return;
+  }
+
+  size_t corpus_bytes = 0;
+  for (const auto& note : indexCorpus()) {
+    corpus_bytes += note.content().size();
+  }
+
+  uintmax_t index_bytes = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    TempDirectory dir;
+    auto db_path = dir.path() / "index.db";
+    state.ResumeTiming();
+
+    {
+      SqliteIndex index(db_path, indexConfig(state.range(0)));
+      if (!buildIndex(index)) {
+        state.SkipWithError("Index build failed");
+        return;
+      }
+    }
+
+    // Closing the connection checkpoints the WAL into the main file
+    state.PauseTiming();
+    index_bytes = std::filesystem::file_size(db_path);
+    state.ResumeTiming();
+  }
+
+  state.counters["IndexMB"] = static_cast<double>(index_bytes) / (1024 * 1024);
+  state.counters["CorpusMB"] = static_cast<double>(corpus_bytes) / (1024 * 1024);
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(indexCorpus().size()));
+}
+BENCHMARK(BM_SqliteIndexBuild)
+    ->ArgName("contentless")
+    ->Arg(0)
+    ->Arg(1)
+    ->Unit(benchmark::kMillisecond);
+
+// Single-note updates outside a transaction: autocommit per write vs write-behind batches
+static void BM_SqliteUpdateNote(benchmark::State& state) {
+  TempDirectory dir;
+  SqliteIndex::Config config;
+  config.write_batch_size = static_cast<size_t>(state.range(0));
+  SqliteIndex index(dir.path() / "index.db", config);
+  if (!buildIndex(index)) {
+    state.SkipWithError("Index build failed");
+    return;
+  }
+
+  const auto& notes = indexCorpus();
+  size_t note_index = 0;
+  for (auto _ : state) {
+    if (!index.updateNote(notes[note_index++ % notes.size()])) {
+      state.SkipWithError("Update failed");
+      return;
+    }
+  }
+  if (!index.flush()) {
+    state.SkipWithError("Flush failed");
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SqliteUpdateNote)
+    ->ArgName("batch")
+    ->Arg(0)
+    ->Arg(64)
+    ->Unit(benchmark::kMicrosecond);
+
+// Query latency including snippet generation (snippet() vs provider + generateSnippet)
+static void BM_SqliteIndexQuery(benchmark::State& state) {
+  if (state.range(0) && !SqliteIndex::contentlessSupported()) {
+    state.SkipWithError("SQLite lacks contentless_delete (needs 3.43+)");
+    return;
+  }
+
+  TempDirectory dir;
+  SqliteIndex index(dir.path() / "index.db", indexConfig(state.range(0)));
+  if (!buildIndex(index)) {
+    state.SkipWithError("Index build failed");
+    return;
+  }
+
+  const std::vector<std::string> queries = {
+    "performance", "meeting AND review", "architecture", "implementation plan", "root cause"
+  };
+
+  size_t query_index = 0;
+  for (auto _ : state) {
+    SearchQuery query;
+    query.text = queries[query_index++ % queries.size()];
+    query.limit = 20;
+    auto results = index.search(query);
+    benchmark::DoNotOptimize(results);
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SqliteIndexQuery)
+    ->ArgName("contentless")
+    ->Arg(0)
+    ->Arg(1)
+    ->Unit(benchmark::kMicrosecond);
+
+// Substring filter as the TUI runs it: trigram candidates + exact check vs scanning every note
+static void BM_SqliteSubstringScan(benchmark::State& state) {
+  TempDirectory dir;
+  auto config = indexConfig(0);
+  config.trigram_index = state.range(0) != 0;
+  SqliteIndex index(dir.path() / "index.db", config);
+  if (!buildIndex(index)) {
+    state.SkipWithError("Index build failed");
+    return;
+  }
+
+  const std::vector<std::string> needles = {"root cause", "ment requ", "Phase 3", "blockers"};
+
+  size_t needle_index = 0;
+  for (auto _ : state) {
+    const auto& needle = needles[needle_index++ % needles.size()];
+    auto candidates = index.scanCandidates(needle);
+    size_t matches = 0;
+    for (const auto& id : *candidates) {
+      if (corpusBodies().at(id.toString()).find(needle) != std::string::npos) {
+        ++matches;
+      }
+    }
+    benchmark::DoNotOptimize(matches);
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SqliteSubstringScan)
+    ->ArgName("trigram")
+    ->Arg(0)
+    ->Arg(1)
+    ->Unit(benchmark::kMicrosecond);
+
+// Built-in grep backend over the same corpus written out as note files, by worker count
+static void BM_NativeGrepSearch(benchmark::State& state) {
+  TempDirectory dir;
+  for (const auto& note : indexCorpus()) {
+    std::ofstream file(dir.path() / note.filename());
+    file << note.toFileFormat();
+  }
+
+  NativeGrepIndex::Config config;
+  config.threads = static_cast<size_t>(state.range(0));
+  config.parallel_threshold = 0;
+  NativeGrepIndex index(dir.path(), config);
+  if (!index.initialize()) {
+    state.SkipWithError("Index initialization failed");
+    return;
+  }
+
+  const std::vector<std::string> queries = {
+    "performance", "architecture", "implementation plan", "root cause"
+  };
+
+  size_t query_index = 0;
+  for (auto _ : state) {
+    SearchQuery query;
+    query.text = queries[query_index++ % queries.size()];
+    // Count every match so the whole corpus is scanned each iteration
+    auto count = index.searchCount(query);
+    benchmark::DoNotOptimize(count);
+  }
+
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(indexCorpus().size()));
+}
+BENCHMARK(BM_NativeGrepSearch)
+    ->ArgName("threads")
+    ->Arg(1)
+    ->Arg(4)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+// In-memory BM25: AND queries (block intersection) and OR queries (block-max WAND top-k)
+static void BM_MemoryIndexQuery(benchmark::State& state) {
+  MemoryIndex index;
+  if (!index.initialize()) {
+    state.SkipWithError("Index initialization failed");
+    return;
+  }
+  for (const auto& note : indexCorpus()) {
+    if (!index.addNote(note)) {
+      state.SkipWithError("Index build failed");
+      return;
+    }
+  }
+
+  const std::vector<std::string> queries = state.range(0)
+      ? std::vector<std::string>{"performance OR architecture", "meeting OR review OR plan",
+                                 "root OR cause OR analysis"}
+      : std::vector<std::string>{"performance architecture", "meeting review", "root cause"};
+
+  size_t query_index = 0;
+  for (auto _ : state) {
+    SearchQuery query;
+    query.text = queries[query_index++ % queries.size()];
+    query.limit = 20;
+    query.highlight = false;
+    auto results = index.searchIds(query);
+    benchmark::DoNotOptimize(results);
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_MemoryIndexQuery)
+    ->ArgName("disjunctive")
+    ->Arg(0)
+    ->Arg(1)
+    ->Unit(benchmark::kMicrosecond);
+
+// Local semantic search: hashing embedder plus HNSW nearest neighbours
+static void BM_VectorIndexSearch(benchmark::State& state) {
+  VectorIndex index(std::make_shared<HashingEmbedder>());
+  if (!index.sync(indexCorpus())) {
+    state.SkipWithError("Vector index build failed");
+    return;
+  }
+
+  const std::vector<std::string> queries = {"performance architecture", "meeting review notes",
+                                            "root cause analysis of the outage"};
+  size_t query_index = 0;
+  for (auto _ : state) {
+    auto hits = index.search(queries[query_index++ % queries.size()], 50);
+    benchmark::DoNotOptimize(hits);
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_VectorIndexSearch)->Unit(benchmark::kMicrosecond);
+
+// Related notes for one note via MinHash/LSH buckets (suggest-links candidates)
+static void BM_MinHashSimilar(benchmark::State& state) {
+  MinHashIndex index;
+  const auto& notes = indexCorpus();
+  index.sync(notes);
+
+  size_t note_index = 0;
+  for (auto _ : state) {
+    auto related = index.similar(notes[note_index++ % notes.size()].id(), 10);
+    benchmark::DoNotOptimize(related);
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_MinHashSimilar)->Unit(benchmark::kMicrosecond);
+
+const std::vector<Note>& linkedCorpus() {
+  static const std::vector<Note> corpus = [] {
+    CorpusGenerator generator({
+      .note_count = 5000,
+      .min_content_size = 200,
+      .max_content_size = 800,
+      .link_probability = 0.8,
+      .max_links_per_note = 8
+    });
+    return generator.generateCorpus();
+  }();
+  return corpus;
+}
+
+// Backlinks the way FilesystemStore finds them: a pass over every note's links
+static void BM_BacklinksScan(benchmark::State& state) {
+  const auto& notes = linkedCorpus();
+  size_t note_index = 0;
+  for (auto _ : state) {
+    const auto& target = notes[note_index++ % notes.size()].id();
+    std::vector<NoteId> backlinks;
+    for (const auto& note : notes) {
+      if (note.metadata().hasLink(target)) {
+        backlinks.push_back(note.id());
+      }
+    }
+    benchmark::DoNotOptimize(backlinks);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_BacklinksScan)->Unit(benchmark::kMicrosecond);
+
+// Backlinks and two-hop neighbourhoods from the CSR link graph
+static void BM_LinkGraphQuery(benchmark::State& state) {
+  LinkGraph graph;
+  const auto& notes = linkedCorpus();
+  graph.sync(notes);
+
+  size_t note_index = 0;
+  for (auto _ : state) {
+    const auto& id = notes[note_index++ % notes.size()].id();
+    if (state.range(0) == 0) {
+      benchmark::DoNotOptimize(graph.backlinks(id));
+    } else {
+      benchmark::DoNotOptimize(graph.neighborhood(id, 2));
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LinkGraphQuery)
+    ->Arg(0)
+    ->Arg(1)
+    ->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <filesystem>
+#include <memory>
+
+#include "nx/config/config.hpp"
+#include "nx/di/service_container.hpp"
+#include "nx/index/sqlite_index.hpp"
+#include "nx/store/filesystem_attachment_store.hpp"
+#include "nx/store/filesystem_store.hpp"
+#include "nx/store/notebook_manager.hpp"
+#include "nx/template/template_manager.hpp"
+
+namespace nx::test {
+
+// Services for running nx commands in-process (CommandRunner, Daemon::handle) against a
+// notes directory, SQLite index and templates under root
+inline std::shared_ptr<nx::di::IServiceContainer> makeCliServices(const std::filesystem::path& root) {
+  auto container = std::make_shared<nx::di::ServiceContainer>();
+
+  auto config = std::make_shared<nx::config::Config>();
+  config->notes_dir = root / "notes";
+  config->data_dir = root / "data";
+  std::filesystem::create_directories(config->notes_dir);
+  std::filesystem::create_directories(config->data_dir);
+  container->registerInstance<nx::config::Config>(config);
+
+  nx::store::FilesystemStore::Config store_config;
+  store_config.notes_dir = config->notes_dir;
+  store_config.attachments_dir = root / "attachments";
+  store_config.trash_dir = root / "trash";
+  store_config.auto_create_dirs = true;
+  auto note_store = std::make_shared<nx::store::FilesystemStore>(store_config);
+  container->registerInstance<nx::store::NoteStore>(note_store);
+  container->registerInstance<nx::store::NotebookManager>(
+      std::make_shared<nx::store::NotebookManager>(*note_store));
+
+  nx::store::FilesystemAttachmentStore::Config attachment_config;
+  attachment_config.attachments_dir = root / "attachments";
+  attachment_config.metadata_file = root / "attachments" / "metadata.json";
+  attachment_config.auto_create_dirs = true;
+  container->registerInstance<nx::store::AttachmentStore>(
+      std::make_shared<nx::store::FilesystemAttachmentStore>(attachment_config));
+
+  auto index = std::make_shared<nx::index::SqliteIndex>(root / "index.db");
+  (void)index->initialize();
+  container->registerInstance<nx::index::Index>(index);
+
+  nx::template_system::TemplateManager::Config template_config;
+  template_config.templates_dir = root / "templates";
+  template_config.metadata_file = root / "templates" / "metadata.json";
+  std::filesystem::create_directories(template_config.templates_dir);
+  container->registerInstance<nx::template_system::TemplateManager>(
+      std::make_shared<nx::template_system::TemplateManager>(template_config));
+
+  return container;
+}
+
+}  // namespace nx::test
@@ -18,12 +18,16 @@ void TempDirTest::TearDown() {
 }
 
 nx::core::Note createTestNote(const std::string& title, const std::string& content,
-                              const std::vector<std::string>& tags) {
-  auto note = nx::core::Note::create(title, content);
+                              const std::vector<std::string>& tags,
+                              const std::optional<std::string>& notebook) {
+  nx::core::Metadata metadata(nx::core::NoteId::generate(), title);
   if (!tags.empty()) {
-    note.setTags(tags);
+    metadata.setTags(tags);
   }
-  return note;
+  if (notebook.has_value()) {
+    metadata.setNotebook(*notebook);
+  }
+  return nx::core::Note(std::move(metadata), title.empty() ? content : "# " + title + "\n\n" + content);
 }
 
 std::vector<nx::core::Note> createTestCorpus(size_t count) {
@@ -3,6 +3,7 @@
 #include <gtest/gtest.h>
 
 #include <filesystem>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -20,9 +21,11 @@ class TempDirTest : public ::testing::Test {
   std::filesystem::path temp_dir_;
 };
 
-// Create a test note with specified content
+// Create a test note. Titles come from the first line of the content, so a non-empty
+// title is written as a "# title" heading above it.
 nx::core::Note createTestNote(const std::string& title, const std::string& content = "",
-                              const std::vector<std::string>& tags = {});
+                              const std::vector<std::string>& tags = {},
+                              const std::optional<std::string>& notebook = std::nullopt);
 
 // Create multiple test notes for corpus testing
 std::vector<nx::core::Note> createTestCorpus(size_t count);
@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+
+#include <nlohmann/json.hpp>
+
+#include "nx/cli/command_runner.hpp"
+#include "nx/cli/commands/batch_command.hpp"
+#include "nx/store/note_store.hpp"
+
+#include "cli_services.hpp"
+#include "test_helpers.hpp"
+
+using namespace nx::cli;
+
+TEST(BatchParseTest, AcceptsArrayForm) {
+  auto op = BatchCommand::parseOperation(R"(["new", "First", "--tags", "a,b"])");
+  ASSERT_OK(op);
+  EXPECT_EQ(op->args, (std::vector<std::string>{"new", "First", "--tags", "a,b"}));
+  EXPECT_TRUE(op->input.empty());
+  EXPECT_TRUE(op->id.is_null());
+}
+
+TEST(BatchParseTest, AcceptsObjectForm) {
+  auto op = BatchCommand::parseOperation(R"({"args": ["new", "Report"], "stdin": "Body text", "id": 7})");
+  ASSERT_OK(op);
+  EXPECT_EQ(op->args, (std::vector<std::string>{"new", "Report"}));
+  EXPECT_EQ(op->input, "Body text");
+  EXPECT_EQ(op->id, 7);
+}
+
+TEST(BatchParseTest, RejectsMalformedLines) {
+  EXPECT_ERROR(BatchCommand::parseOperation("not json"), nx::ErrorCode::kParseError);
+  EXPECT_ERROR(BatchCommand::parseOperation("[]"), nx::ErrorCode::kInvalidArgument);
+  EXPECT_ERROR(BatchCommand::parseOperation(R"(["new", 3])"), nx::ErrorCode::kInvalidArgument);
+  EXPECT_ERROR(BatchCommand::parseOperation(R"({"stdin": "x"})"), nx::ErrorCode::kInvalidArgument);
+}
+
+TEST(BatchParseTest, RefusesCommandsThatCannotShareTheBatch) {
+  for (const char* command : {"batch", "daemon", "edit", "gc", "open", "reindex", "ui"}) {
+    auto line = nlohmann::json::array({command}).dump();
+    EXPECT_ERROR(BatchCommand::parseOperation(line), nx::ErrorCode::kInvalidArgument);
+  }
+  EXPECT_ERROR(BatchCommand::parseOperation(R"(["--notes-dir", "/tmp", "ls"])"), nx::ErrorCode::kInvalidArgument);
+  EXPECT_ERROR(BatchCommand::parseOperation(R"(["--config=other.toml", "ls"])"), nx::ErrorCode::kInvalidArgument);
+}
+
+class BatchCommandTest : public nx::test::TempDirTest {
+ protected:
+  void SetUp() override {
+    TempDirTest::SetUp();
+    container_ = nx::test::makeCliServices(temp_dir_);
+  }
+
+  std::vector<nlohmann::json> runBatch(std::vector<std::string> args, const std::string& input) {
+    args.insert(args.begin(), {"nx", "batch"});
+    output_ = CommandRunner(container_).run(std::move(args), input);
+    std::vector<nlohmann::json> records;
+    std::istringstream lines(output_.out);
+    std::string line;
+    while (std::getline(lines, line)) {
+      records.push_back(nlohmann::json::parse(line));
+    }
+    return records;
+  }
+
+  size_t noteCount() {
+    auto notes = container_->resolve<nx::store::NoteStore>()->list();
+    return notes.has_value() ? notes->size() : 0;
+  }
+
+  std::shared_ptr<nx::di::IServiceContainer> container_;
+  CommandRunner::Output output_;
+};
+
+TEST_F(BatchCommandTest, WritesOneResultPerOperation) {
+  auto records = runBatch({}, R"(["new", "First"])" "\n\n" R"({"args": ["new", "Second"], "id": "b"})" "\n");
+
+  ASSERT_EQ(records.size(), 2u);
+  EXPECT_EQ(output_.exit_code, 0);
+  EXPECT_TRUE(records[0]["ok"].get<bool>());
+  EXPECT_EQ(records[0]["line"], 1);
+  EXPECT_TRUE(records[1]["ok"].get<bool>());
+  EXPECT_EQ(records[1]["line"], 3);
+  EXPECT_EQ(records[1]["id"], "b");
+  EXPECT_EQ(noteCount(), 2u);
+}
+
+TEST_F(BatchCommandTest, StopsAtTheFirstFailure) {
+  auto records = runBatch({}, R"(["new", "First"])" "\n" R"(["reindex"])" "\n" R"(["new", "Third"])" "\n");
+
+  ASSERT_EQ(records.size(), 2u);
+  EXPECT_EQ(output_.exit_code, 1);
+  EXPECT_FALSE(records[1]["ok"].get<bool>());
+  EXPECT_NE(records[1]["error"].get<std::string>().find("cannot run inside a batch"), std::string::npos);
+  EXPECT_EQ(noteCount(), 1u);
+}
+
+TEST_F(BatchCommandTest, ContinuesOnErrorWhenAsked) {
+  auto records = runBatch({"--continue-on-error", "--commit-every", "1"},
+                          R"(["new", "First"])" "\n" R"(["view", "01J0000000000000000000000"])" "\n" R"(["new", "Third"])" "\n");
+
+  ASSERT_EQ(records.size(), 3u);
+  EXPECT_EQ(output_.exit_code, 1);
+  EXPECT_TRUE(records[0]["ok"].get<bool>());
+  EXPECT_FALSE(records[1]["ok"].get<bool>());
+  EXPECT_TRUE(records[2]["ok"].get<bool>());
+  EXPECT_EQ(noteCount(), 2u);
+}
@@ -0,0 +1,130 @@
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include "nx/cli/daemon.hpp"
+#include "nx/store/note_store.hpp"
+
+#include "cli_services.hpp"
+#include "test_helpers.hpp"
+
+using namespace nx::cli;
+
+class DaemonTest : public nx::test::TempDirTest {
+ protected:
+  void SetUp() override {
+    TempDirTest::SetUp();
+    container_ = nx::test::makeCliServices(temp_dir_);
+  }
+
+  Daemon makeDaemon() {
+    return Daemon(container_, Daemon::Config{temp_dir_ / "daemon.sock", temp_dir_ / "notes", std::chrono::minutes{0},
+                                             temp_dir_ / "config.toml"});
+  }
+
+  // A request from a caller that resolved the same notes directory and config as the daemon
+  nlohmann::json commandRequest(const std::vector<std::string>& argv) {
+    return {{"argv", argv},
+            {"cwd", temp_dir_.string()},
+            {"notes_dir", (temp_dir_ / "notes").string()},
+            {"config", (temp_dir_ / "config.toml").string()}};
+  }
+
+  std::shared_ptr<nx::di::IServiceContainer> container_;
+};
+
+TEST(DaemonForwardTest, ForwardsReadOnlyCommands) {
+  EXPECT_TRUE(Daemon::isForwardable({"nx", "ls"}));
+  EXPECT_TRUE(Daemon::isForwardable({"nx", "--json", "grep", "todo"}));
+  EXPECT_TRUE(Daemon::isForwardable({"nx", "view", "01J0000000000000000000000"}));
+}
+
+TEST(DaemonForwardTest, ForwardsOnlyReadSubcommands) {
+  EXPECT_TRUE(Daemon::isForwardable({"nx", "tags"}));
+  EXPECT_TRUE(Daemon::isForwardable({"nx", "tags", "--count"}));
+  EXPECT_FALSE(Daemon::isForwardable({"nx", "tags", "add", "01J0000000000000000000000", "work"}));
+
+  EXPECT_TRUE(Daemon::isForwardable({"nx", "meta", "get", "01J0000000000000000000000"}));
+  EXPECT_FALSE(Daemon::isForwardable({"nx", "meta", "set", "01J0000000000000000000000", "k", "v"}));
+
+  EXPECT_TRUE(Daemon::isForwardable({"nx", "notebook", "list"}));
+  EXPECT_FALSE(Daemon::isForwardable({"nx", "notebook", "delete", "work"}));
+  EXPECT_FALSE(Daemon::isForwardable({"nx", "notebook"}));
+}
+
+TEST(DaemonForwardTest, KeepsOtherCommandsInProcess) {
+  EXPECT_FALSE(Daemon::isForwardable({"nx"}));
+  EXPECT_FALSE(Daemon::isForwardable({"nx", "--json"}));
+  EXPECT_FALSE(Daemon::isForwardable({"nx", "new", "Title"}));
+  EXPECT_FALSE(Daemon::isForwardable({"nx", "edit", "01J0000000000000000000000"}));
+  EXPECT_FALSE(Daemon::isForwardable({"nx", "--notes-dir", "/tmp/notes", "ls"}));
+  EXPECT_FALSE(Daemon::isForwardable({"nx", "--notes-dir=/tmp/notes", "ls"}));
+  EXPECT_FALSE(Daemon::isForwardable({"nx", "--config", "other.toml", "ls"}));
+}
+
+TEST_F(DaemonTest, AnswersPing) {
+  auto daemon = makeDaemon();
+  auto reply = daemon.handle({{"ping", true}});
+
+  EXPECT_EQ(reply["pid"].get<int>(), ::getpid());
+  EXPECT_EQ(reply["requests"].get<uint64_t>(), 0u);
+  EXPECT_EQ(reply["socket"].get<std::string>(), (temp_dir_ / "daemon.sock").string());
+}
+
+TEST_F(DaemonTest, AcknowledgesShutdown) {
+  auto daemon = makeDaemon();
+  EXPECT_TRUE(daemon.handle({{"shutdown", true}})["ok"].get<bool>());
+}
+
+TEST_F(DaemonTest, RefusesCommandsThatMustRunInProcess) {
+  auto daemon = makeDaemon();
+  auto reply = daemon.handle({{"argv", nlohmann::json::array({"nx", "tags", "add", "01J0000000000000000000000", "work"})}});
+
+  EXPECT_EQ(reply["exit_code"].get<int>(), 1);
+  EXPECT_NE(reply["stderr"].get<std::string>().find("runs in the calling process"), std::string::npos);
+  EXPECT_EQ(daemon.handle({{"ping", true}})["requests"].get<uint64_t>(), 0u);
+}
+
+TEST_F(DaemonTest, RunsForwardedCommands) {
+  auto note_store = container_->resolve<nx::store::NoteStore>();
+  ASSERT_OK(note_store->store(nx::test::createTestNote("Daemon Note", "Served warm")));
+
+  auto daemon = makeDaemon();
+  auto reply = daemon.handle(commandRequest({"nx", "ls"}));
+
+  EXPECT_EQ(reply["exit_code"].get<int>(), 0);
+  EXPECT_NE(reply["stdout"].get<std::string>().find("Daemon Note"), std::string::npos);
+  EXPECT_EQ(daemon.handle({{"ping", true}})["requests"].get<uint64_t>(), 1u);
+}
+
+TEST_F(DaemonTest, SendsCallersWithOtherNotesBackInProcess) {
+  auto daemon = makeDaemon();
+
+  auto other_notes = commandRequest({"nx", "ls"});
+  other_notes["notes_dir"] = (temp_dir_ / "elsewhere").string();
+  auto reply = daemon.handle(other_notes);
+  EXPECT_TRUE(reply.value("mismatch", false));
+
+  auto other_config = commandRequest({"nx", "ls"});
+  other_config["config"] = (temp_dir_ / "other.toml").string();
+  EXPECT_TRUE(daemon.handle(other_config).value("mismatch", false));
+
+  // Nothing was said about either: an older client is not served blind
+  EXPECT_TRUE(daemon.handle({{"argv", nlohmann::json::array({"nx", "ls"})}}).value("mismatch", false));
+  EXPECT_EQ(daemon.handle({{"ping", true}})["requests"].get<uint64_t>(), 0u);
+}
+
+TEST_F(DaemonTest, RefusesSocketDirectoriesOthersCanReach) {
+  auto shared_dir = temp_dir_ / "shared";
+  std::filesystem::create_directories(shared_dir);
+  std::filesystem::permissions(shared_dir, std::filesystem::perms::owner_all | std::filesystem::perms::group_read |
+                                               std::filesystem::perms::group_exec | std::filesystem::perms::others_read |
+                                               std::filesystem::perms::others_exec);
+
+  auto reply = Daemon::request(shared_dir / "daemon.sock", {{"ping", true}});
+  EXPECT_ERROR(reply, nx::ErrorCode::kSecurityError);
+
+  Daemon daemon(container_, Daemon::Config{shared_dir / "daemon.sock", temp_dir_ / "notes", std::chrono::minutes{0},
+                                           temp_dir_ / "config.toml"});
+  EXPECT_ERROR(daemon.run(), nx::ErrorCode::kSecurityError);
+}
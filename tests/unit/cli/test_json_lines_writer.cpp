@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <streambuf>
+
+#include "nx/cli/json_lines_writer.hpp"
+
+using namespace nx::cli;
+
+namespace {
+
+// Accepts this many bytes, then fails every write, like a pipe whose reader exited
+class ClosingBuffer : public std::streambuf {
+ public:
+  explicit ClosingBuffer(size_t capacity) : capacity_(capacity) {}
+
+  std::string data;
+
+ protected:
+  int_type overflow(int_type c) override {
+    if (traits_type::eq_int_type(c, traits_type::eof()) || data.size() >= capacity_) {
+      return traits_type::eof();
+    }
+    data.push_back(traits_type::to_char_type(c));
+    return c;
+  }
+
+ private:
+  size_t capacity_;
+};
+
+}  // namespace
+
+TEST(JsonLinesWriterTest, WritesOneCompactRecordPerLine) {
+  std::ostringstream out;
+  JsonLinesWriter writer(out);
+
+  EXPECT_TRUE(writer.write({{"id", 1}, {"title", "First"}}));
+  EXPECT_TRUE(writer.write({{"id", 2}, {"title", "Second"}}));
+
+  EXPECT_EQ(out.str(), "{\"id\":1,\"title\":\"First\"}\n{\"id\":2,\"title\":\"Second\"}\n");
+  EXPECT_EQ(writer.written(), 2u);
+}
+
+TEST(JsonLinesWriterTest, ReplacesInvalidUtf8InsteadOfStopping) {
+  std::ostringstream out;
+  JsonLinesWriter writer(out);
+
+  EXPECT_TRUE(writer.write({{"title", std::string("bad \xff byte")}}));
+  EXPECT_TRUE(writer.write({{"title", "next"}}));
+
+  EXPECT_EQ(out.str(), "{\"title\":\"bad \xEF\xBF\xBD byte\"}\n{\"title\":\"next\"}\n");
+  EXPECT_EQ(writer.written(), 2u);
+}
+
+TEST(JsonLinesWriterTest, StopsOnceTheReaderGoesAway) {
+  ClosingBuffer buffer(20);
+  std::ostream out(&buffer);
+  JsonLinesWriter writer(out);
+
+  EXPECT_TRUE(writer.write({{"n", 1}}));
+  EXPECT_FALSE(writer.write({{"title", "too long for what is left"}}));
+  EXPECT_FALSE(writer.write({{"n", 3}}));
+  EXPECT_EQ(writer.written(), 1u);
+  EXPECT_EQ(buffer.data.substr(0, 8), "{\"n\":1}\n");
+}
@@ -0,0 +1,159 @@
+#include <gtest/gtest.h>
+
+#include "nx/index/caching_index.hpp"
+#include "nx/index/memory_index.hpp"
+#include "nx/index/sqlite_index.hpp"
+#include "test_helpers.hpp"
+
+using namespace nx::index;
+using namespace nx::core;
+using namespace nx::test;
+
+class CachingIndexTest : public TempDirTest {
+protected:
+  void SetUp() override {
+    TempDirTest::SetUp();
+    backend_ = std::make_shared<MemoryIndex>();
+    CachingIndex::Config config;
+    config.capacity = 2;
+    index_ = std::make_unique<CachingIndex>(backend_, config);
+    ASSERT_OK(index_->initialize());
+  }
+
+  std::pair<size_t, size_t> hitsAndMisses() {
+    auto stats = index_->getStats();
+    EXPECT_TRUE(stats.has_value());
+    return {stats->cache_hits, stats->cache_misses};
+  }
+
+  std::shared_ptr<MemoryIndex> backend_;
+  std::unique_ptr<CachingIndex> index_;
+};
+
+TEST_F(CachingIndexTest, RepeatQueriesHitUntilAWrite) {
+  ASSERT_OK(index_->addNote(createTestNote("Alpha", "wombat burrows")));
+
+  SearchQuery query;
+  query.text = "wombat";
+  auto first = index_->search(query);
+  ASSERT_OK(first);
+  ASSERT_EQ(first->size(), 1);
+
+  // Extra whitespace does not make a new query
+  SearchQuery respelled;
+  respelled.text = "  wombat ";
+  auto second = index_->search(respelled);
+  ASSERT_OK(second);
+  EXPECT_EQ(second->size(), 1);
+  EXPECT_EQ(hitsAndMisses(), (std::pair<size_t, size_t>{1, 1}));
+
+  // A write bumps the generation: the next answer comes from the index again
+  auto generation = index_->generation();
+  ASSERT_OK(index_->addNote(createTestNote("Beta", "wombat tracks")));
+  EXPECT_GT(index_->generation(), generation);
+  auto after_write = index_->search(query);
+  ASSERT_OK(after_write);
+  EXPECT_EQ(after_write->size(), 2);
+  EXPECT_EQ(hitsAndMisses(), (std::pair<size_t, size_t>{1, 2}));
+
+  // Counts ignore paging, so another page shares the entry
+  auto count = index_->searchCount(query);
+  ASSERT_OK(count);
+  EXPECT_EQ(*count, 2);
+  query.offset = 1;
+  ASSERT_OK(index_->searchCount(query));
+  EXPECT_EQ(hitsAndMisses(), (std::pair<size_t, size_t>{2, 3}));
+}
+
+TEST_F(CachingIndexTest, EvictsLeastRecentlyUsedAndInvalidates) {
+  ASSERT_OK(index_->addNote(createTestNote("Alpha", "one two three")));
+
+  auto search = [&](const std::string& text) {
+    SearchQuery query;
+    query.text = text;
+    ASSERT_OK(index_->search(query));
+  };
+
+  search("one");
+  search("two");
+  search("one");    // Hit; "two" is now the oldest
+  search("three");  // Evicts "two"
+  search("one");    // Still cached
+  search("two");    // Miss again
+  EXPECT_EQ(hitsAndMisses(), (std::pair<size_t, size_t>{2, 4}));
+
+  // Writes that go around the wrapper need an explicit invalidate()
+  ASSERT_OK(backend_->addNote(createTestNote("Beta", "one more")));
+  SearchQuery query;
+  query.text = "one";
+  EXPECT_EQ(index_->search(query)->size(), 1);
+  index_->invalidate();
+  EXPECT_EQ(index_->search(query)->size(), 2);
+}
+
+TEST_F(CachingIndexTest, SeesWritesFromOtherConnections) {
+  auto db_path = temp_dir_ / "index.db";
+  auto backend = std::make_shared<SqliteIndex>(db_path);
+  CachingIndex cached(backend);
+  ASSERT_OK(cached.initialize());
+  ASSERT_OK(cached.addNote(createTestNote("Alpha", "wombat burrows")));
+
+  SearchQuery query;
+  query.text = "wombat";
+  ASSERT_EQ(cached.search(query)->size(), 1);
+  ASSERT_EQ(cached.search(query)->size(), 1);
+
+  // Another process commits to the same file: the change counter moves and the entry misses
+  SqliteIndex other(db_path);
+  ASSERT_OK(other.initialize());
+  auto counter = cached.changeCounter();
+  ASSERT_OK(other.addNote(createTestNote("Beta", "wombat tracks")));
+  EXPECT_NE(cached.changeCounter(), counter);
+  EXPECT_EQ(cached.search(query)->size(), 2);
+
+  auto stats = cached.getStats();
+  ASSERT_OK(stats);
+  EXPECT_EQ(stats->cache_hits, 1);
+  EXPECT_EQ(stats->cache_misses, 2);
+}
+
+TEST_F(CachingIndexTest, KeysExpressionsExactly) {
+  // Same day, different hours: printing the expression would round both to the date
+  auto morning = std::chrono::sys_days{std::chrono::year{2024} / 3 / 1} + std::chrono::hours(9);
+  SearchQuery early;
+  early.expr = QueryExpr::modified(morning, std::nullopt);
+  SearchQuery late;
+  late.expr = QueryExpr::modified(morning + std::chrono::hours(6), std::nullopt);
+  EXPECT_NE(CachingIndex::normalize(early), CachingIndex::normalize(late));
+
+  // One phrase is not the two words it contains
+  SearchQuery phrase;
+  phrase.expr = QueryExpr::text("to do");
+  SearchQuery words;
+  words.expr = QueryExpr::allOf({QueryExpr::text("to"), QueryExpr::text("do")});
+  EXPECT_NE(CachingIndex::normalize(phrase), CachingIndex::normalize(words));
+
+  SearchQuery same;
+  same.expr = QueryExpr::text("to do");
+  EXPECT_EQ(CachingIndex::normalize(phrase), CachingIndex::normalize(same));
+}
+
+TEST_F(CachingIndexTest, KeepsSpacingForLiteralBackends) {
+  SearchQuery spaced;
+  spaced.text = "a  b";
+  SearchQuery single;
+  single.text = "a b";
+  EXPECT_EQ(CachingIndex::normalize(spaced), CachingIndex::normalize(single));
+  EXPECT_NE(CachingIndex::normalize(spaced, false), CachingIndex::normalize(single, false));
+
+  CachingIndex::Config config;
+  config.collapse_whitespace = false;
+  CachingIndex literal(backend_, config);
+  ASSERT_OK(literal.addNote(createTestNote("Alpha", "a  b")));
+  ASSERT_OK(literal.search(spaced));
+  ASSERT_OK(literal.search(single));
+  auto stats = literal.getStats();
+  ASSERT_OK(stats);
+  EXPECT_EQ(stats->cache_hits, 0);
+  EXPECT_EQ(stats->cache_misses, 2);
+}
@@ -0,0 +1,147 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <sstream>
+
+#include "nx/index/hnsw_index.hpp"
+#include "test_helpers.hpp"
+
+using namespace nx::index;
+
+namespace {
+
+std::vector<std::vector<float>> randomUnitVectors(size_t count, size_t dimensions, uint32_t seed) {
+  std::mt19937 rng(seed);
+  std::normal_distribution<float> normal;
+  std::vector<std::vector<float>> vectors(count, std::vector<float>(dimensions));
+  for (auto& vector : vectors) {
+    float norm = 0.0f;
+    for (float& value : vector) {
+      value = normal(rng);
+      norm += value * value;
+    }
+    for (float& value : vector) {
+      value /= std::sqrt(norm);
+    }
+  }
+  return vectors;
+}
+
+std::vector<uint32_t> bruteForce(const std::vector<std::vector<float>>& vectors,
+                                 const std::vector<float>& query, size_t k,
+                                 const std::vector<bool>& deleted = {}) {
+  std::vector<std::pair<float, uint32_t>> scored;
+  for (uint32_t i = 0; i < vectors.size(); ++i) {
+    if (!deleted.empty() && deleted[i]) {
+      continue;
+    }
+    float dot = 0.0f;
+    for (size_t d = 0; d < query.size(); ++d) {
+      dot += query[d] * vectors[i][d];
+    }
+    scored.emplace_back(-dot, i);
+  }
+  std::partial_sort(scored.begin(), scored.begin() + static_cast<std::ptrdiff_t>(k), scored.end());
+  std::vector<uint32_t> nearest;
+  for (size_t i = 0; i < k; ++i) {
+    nearest.push_back(scored[i].second);
+  }
+  return nearest;
+}
+
+double recall(const HnswIndex& index, const std::vector<std::vector<float>>& vectors,
+              const std::vector<std::vector<float>>& queries, size_t k,
+              const std::vector<bool>& deleted = {}) {
+  size_t found = 0;
+  for (const auto& query : queries) {
+    auto expected = bruteForce(vectors, query, k, deleted);
+    for (const auto& neighbor : index.search(query, k)) {
+      found += static_cast<size_t>(std::count(expected.begin(), expected.end(), neighbor.node));
+    }
+  }
+  return static_cast<double>(found) / static_cast<double>(queries.size() * k);
+}
+
+}  // namespace
+
+TEST(HnswIndexTest, RecallMatchesBruteForce) {
+  HnswIndex::Config config;
+  config.dimensions = 32;
+  HnswIndex index(config);
+
+  auto vectors = randomUnitVectors(2000, config.dimensions, 1);
+  for (uint32_t i = 0; i < vectors.size(); ++i) {
+    ASSERT_EQ(index.insert(vectors[i]), i);
+  }
+  auto queries = randomUnitVectors(50, config.dimensions, 2);
+
+  EXPECT_GT(recall(index, vectors, queries, 10), 0.9);
+
+  // An indexed vector is its own nearest neighbour
+  auto self = index.search(vectors[123], 1);
+  ASSERT_EQ(self.size(), 1);
+  EXPECT_EQ(self[0].node, 123);
+  EXPECT_NEAR(self[0].distance, 0.0f, 1e-5);
+}
+
+TEST(HnswIndexTest, DeletedNodesAreNeverReturned) {
+  HnswIndex::Config config;
+  config.dimensions = 16;
+  HnswIndex index(config);
+
+  auto vectors = randomUnitVectors(500, config.dimensions, 3);
+  for (const auto& vector : vectors) {
+    index.insert(vector);
+  }
+
+  std::vector<bool> deleted(vectors.size(), false);
+  for (uint32_t i = 0; i < vectors.size(); i += 2) {
+    index.markDeleted(i);
+    deleted[i] = true;
+  }
+  EXPECT_EQ(index.deletedCount(), 250);
+
+  auto queries = randomUnitVectors(20, config.dimensions, 4);
+  for (const auto& query : queries) {
+    auto results = index.search(query, 10);
+    ASSERT_EQ(results.size(), 10);
+    for (const auto& neighbor : results) {
+      EXPECT_FALSE(index.isDeleted(neighbor.node));
+    }
+  }
+  EXPECT_GT(recall(index, vectors, queries, 10, deleted), 0.9);
+}
+
+TEST(HnswIndexTest, SaveAndLoadRoundTrip) {
+  HnswIndex::Config config;
+  config.dimensions = 8;
+  HnswIndex index(config);
+  auto vectors = randomUnitVectors(300, config.dimensions, 5);
+  for (const auto& vector : vectors) {
+    index.insert(vector);
+  }
+  index.markDeleted(7);
+
+  std::stringstream stream;
+  index.save(stream);
+  auto loaded = HnswIndex::load(stream);
+  ASSERT_OK(loaded);
+  EXPECT_EQ(loaded->size(), index.size());
+  EXPECT_TRUE(loaded->isDeleted(7));
+
+  for (const auto& query : randomUnitVectors(10, config.dimensions, 6)) {
+    auto expected = index.search(query, 5);
+    auto actual = loaded->search(query, 5);
+    ASSERT_EQ(actual.size(), expected.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+      EXPECT_EQ(actual[i].node, expected[i].node);
+    }
+  }
+
+  // Truncated input is rejected rather than trusted
+  std::string bytes = stream.str();
+  std::stringstream truncated(bytes.substr(0, bytes.size() / 2));
+  EXPECT_FALSE(HnswIndex::load(truncated).has_value());
+}
@@ -0,0 +1,181 @@
+#include <gtest/gtest.h>
+
+#include <fstream>
+
+#include "nx/index/link_graph.hpp"
+#include "test_helpers.hpp"
+
+using namespace nx::index;
+using namespace nx::core;
+using namespace nx::test;
+
+class LinkGraphTest : public TempDirTest {
+protected:
+  static std::string link(const Note& note) {
+    return "[" + note.title() + "](" + note.id().toString() + ")";
+  }
+
+  // hub <- a, hub <- b (wiki-link), a -> b, c -> d, e isolated
+  std::vector<Note> vault() {
+    auto hub = createTestNote("Hub", "Index of everything");
+    auto b = createTestNote("Beta", "See [[hub]] and [[Missing page]]");
+    auto a = createTestNote("Alpha", "Links to " + link(hub) + " and " + link(b));
+    auto d = createTestNote("Delta", "Leaf");
+    auto c = createTestNote("Gamma", "Points at [[" + d.id().toString() + "|delta]]");
+    auto e = createTestNote("Epsilon", "No links");
+    return {hub, a, b, c, d, e};
+  }
+};
+
+TEST_F(LinkGraphTest, ResolvesUlidAndWikiLinks) {
+  LinkGraph graph;
+  auto notes = vault();
+  EXPECT_EQ(graph.sync(notes), 6);
+
+  const auto& hub = notes[0];
+  const auto& a = notes[1];
+  const auto& b = notes[2];
+
+  auto backlinks = graph.backlinks(hub.id());
+  std::vector<NoteId> expected = {a.id(), b.id()};
+  std::sort(expected.begin(), expected.end());
+  EXPECT_EQ(backlinks, expected);
+
+  auto outgoing = graph.outgoing(a.id());
+  expected = {hub.id(), b.id()};
+  std::sort(expected.begin(), expected.end());
+  EXPECT_EQ(outgoing, expected);
+
+  EXPECT_EQ(graph.backlinks(notes[4].id()), std::vector<NoteId>{notes[3].id()});
+
+  auto stats = graph.stats();
+  EXPECT_EQ(stats.notes, 6);
+  EXPECT_EQ(stats.links, 4);
+  EXPECT_EQ(stats.unresolved_links, 1);
+  EXPECT_EQ(stats.components, 3);
+  EXPECT_EQ(stats.isolated, 1);
+}
+
+TEST_F(LinkGraphTest, NeighborhoodAndShortestPath) {
+  LinkGraph graph;
+  auto notes = vault();
+  graph.sync(notes);
+  const auto& hub = notes[0];
+  const auto& a = notes[1];
+  const auto& b = notes[2];
+
+  auto one_hop = graph.neighborhood(b.id(), 1);
+  ASSERT_EQ(one_hop.size(), 2);
+  for (const auto& neighbor : one_hop) {
+    EXPECT_EQ(neighbor.distance, 1);
+  }
+
+  auto outgoing_only = graph.neighborhood(a.id(), 3, LinkGraph::Direction::kOutgoing);
+  ASSERT_EQ(outgoing_only.size(), 2);
+
+  auto incoming = graph.neighborhood(hub.id(), 2, LinkGraph::Direction::kIncoming);
+  ASSERT_EQ(incoming.size(), 2);
+  EXPECT_EQ(incoming[0].distance, 1);
+  EXPECT_EQ(incoming[1].distance, 1);
+
+  auto path = graph.shortestPath(a.id(), hub.id());
+  EXPECT_EQ(path, (std::vector<NoteId>{a.id(), hub.id()}));
+
+  // Links only run towards the hub
+  EXPECT_TRUE(graph.shortestPath(hub.id(), a.id()).empty());
+  EXPECT_EQ(graph.shortestPath(hub.id(), a.id(), LinkGraph::Direction::kBoth).size(), 2);
+  EXPECT_TRUE(graph.shortestPath(a.id(), notes[4].id(), LinkGraph::Direction::kBoth).empty());
+  EXPECT_EQ(graph.shortestPath(a.id(), a.id()), std::vector<NoteId>{a.id()});
+}
+
+TEST_F(LinkGraphTest, ComponentsAndCentrality) {
+  LinkGraph graph;
+  auto notes = vault();
+  graph.sync(notes);
+
+  auto groups = graph.components();
+  ASSERT_EQ(groups.size(), 3);
+  EXPECT_EQ(groups[0].size(), 3);
+  EXPECT_EQ(groups[1].size(), 2);
+  EXPECT_EQ(groups[2], std::vector<NoteId>{notes[5].id()});
+  EXPECT_EQ(graph.components(2).size(), 2);
+
+  auto ranked = graph.centrality(6);
+  ASSERT_EQ(ranked.size(), 6);
+  EXPECT_EQ(ranked.front().id, notes[0].id());
+  double total = 0.0;
+  for (const auto& entry : ranked) {
+    total += entry.score;
+  }
+  EXPECT_NEAR(total, 1.0, 1e-6);
+}
+
+TEST_F(LinkGraphTest, UpdatesIncrementally) {
+  LinkGraph graph;
+  auto notes = vault();
+  graph.sync(notes);
+  EXPECT_EQ(graph.sync(notes), 0);
+
+  // Epsilon starts linking to the hub; Gamma is deleted
+  notes[5].setContent("# Epsilon\n\nNow part of [[Hub]]");
+  notes.erase(notes.begin() + 3);
+  EXPECT_EQ(graph.sync(notes), 1);
+  EXPECT_EQ(graph.backlinks(notes[0].id()).size(), 3);
+  EXPECT_TRUE(graph.backlinks(notes[3].id()).empty());
+
+  // Renaming the hub breaks wiki-links by title but not ULID links
+  notes[0].setContent("# Central\n\nRenamed");
+  graph.upsert(notes[0]);
+  EXPECT_EQ(graph.backlinks(notes[0].id()), std::vector<NoteId>{notes[1].id()});
+
+  graph.remove(notes[1].id());
+  EXPECT_TRUE(graph.backlinks(notes[0].id()).empty());
+  EXPECT_FALSE(graph.contains(notes[1].id()));
+}
+
+TEST_F(LinkGraphTest, OpensForNotesAndPersistsAdjacency) {
+  auto notes_dir = temp_dir_ / "notes";
+  auto cache_dir = temp_dir_ / "cache";
+  std::filesystem::create_directories(notes_dir);
+
+  auto notes = vault();
+  for (const auto& note : notes) {
+    std::ofstream(notes_dir / note.filename()) << note.toFileFormat();
+  }
+
+  std::vector<size_t> loaded_batches;
+  auto loader = [&](const std::vector<NoteId>& ids) -> nx::Result<std::vector<Note>> {
+    loaded_batches.push_back(ids.size());
+    std::vector<Note> found;
+    for (const auto& note : notes) {
+      if (std::find(ids.begin(), ids.end(), note.id()) != ids.end()) {
+        found.push_back(note);
+      }
+    }
+    return found;
+  };
+
+  {
+    auto graph = LinkGraph::openForNotes(notes_dir, cache_dir, loader);
+    ASSERT_OK(graph);
+    EXPECT_EQ((*graph)->backlinks(notes[0].id()).size(), 2);
+  }
+  ASSERT_EQ(loaded_batches, std::vector<size_t>{6});
+
+  // Nothing changed: the saved adjacency answers without loading a note
+  {
+    auto graph = LinkGraph::openForNotes(notes_dir, cache_dir, loader);
+    ASSERT_OK(graph);
+    EXPECT_EQ((*graph)->backlinks(notes[0].id()).size(), 2);
+    EXPECT_EQ((*graph)->stats().links, 4);
+  }
+  EXPECT_EQ(loaded_batches.size(), 1);
+
+  std::filesystem::remove(notes_dir / notes[1].filename());
+  {
+    auto graph = LinkGraph::openForNotes(notes_dir, cache_dir, loader);
+    ASSERT_OK(graph);
+    EXPECT_EQ((*graph)->backlinks(notes[0].id()), std::vector<NoteId>{notes[2].id()});
+  }
+  EXPECT_EQ(loaded_batches.size(), 1);
+}
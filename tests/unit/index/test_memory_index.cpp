@@ -0,0 +1,287 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+
+#include "nx/index/memory_index.hpp"
+#include "nx/index/query_parser.hpp"
+#include "test_helpers.hpp"
+
+using namespace nx::index;
+using namespace nx::core;
+using namespace nx::test;
+
+class MemoryIndexTest : public TempDirTest {
+protected:
+  void SetUp() override {
+    TempDirTest::SetUp();
+    index_ = std::make_unique<MemoryIndex>();
+    ASSERT_OK(index_->initialize());
+  }
+
+  Note addNote(const std::string& title, const std::string& content,
+               const std::vector<std::string>& tags = {},
+               const std::optional<std::string>& notebook = std::nullopt) {
+    auto note = createTestNote(title, content, tags, notebook);
+    EXPECT_OK(index_->addNote(note));
+    return note;
+  }
+
+  std::vector<std::string> titles(const std::string& text, size_t limit = 50) {
+    SearchQuery query;
+    query.text = text;
+    query.limit = limit;
+    auto results = index_->search(query);
+    EXPECT_TRUE(results.has_value());
+    std::vector<std::string> found;
+    for (const auto& result : *results) {
+      found.push_back(result.title);
+    }
+    return found;
+  }
+
+  std::vector<std::string> sortedTitles(const std::string& text) {
+    auto found = titles(text);
+    std::sort(found.begin(), found.end());
+    return found;
+  }
+
+  std::unique_ptr<MemoryIndex> index_;
+};
+
+TEST_F(MemoryIndexTest, BooleanQueries) {
+  addNote("Alpha", "The quick brown fox jumps over the lazy dog");
+  addNote("Beta", "A quick summary of the meeting");
+  addNote("Gamma", "Brown bears and brown foxes");
+
+  EXPECT_EQ(sortedTitles("quick"), (std::vector<std::string>{"Alpha", "Beta"}));
+  EXPECT_EQ(sortedTitles("quick brown"), std::vector<std::string>{"Alpha"});
+  EXPECT_EQ(sortedTitles("quick AND brown"), std::vector<std::string>{"Alpha"});
+  EXPECT_EQ(sortedTitles("meeting OR bears"), (std::vector<std::string>{"Beta", "Gamma"}));
+  EXPECT_EQ(sortedTitles("quick NOT fox"), std::vector<std::string>{"Beta"});
+  EXPECT_EQ(sortedTitles("brown -quick"), std::vector<std::string>{"Gamma"});
+  EXPECT_EQ(sortedTitles("fox*"), (std::vector<std::string>{"Alpha", "Gamma"}));
+  EXPECT_EQ(sortedTitles("\"brown fox\""), std::vector<std::string>{"Alpha"});
+  EXPECT_EQ(sortedTitles("\"fox brown\""), std::vector<std::string>{});
+  EXPECT_EQ(sortedTitles("missing"), std::vector<std::string>{});
+
+  // Title words count too, and matching is case-insensitive
+  EXPECT_EQ(sortedTitles("GAMMA"), std::vector<std::string>{"Gamma"});
+}
+
+TEST_F(MemoryIndexTest, RanksByBm25AndMarksSnippets) {
+  addNote("Once", "deadline mentioned once among many other words in a long note body");
+  addNote("Often", "deadline deadline deadline");
+  addNote("Unrelated", "nothing to see");
+
+  SearchQuery query;
+  query.text = "deadline";
+  auto results = index_->search(query);
+  ASSERT_OK(results);
+  ASSERT_EQ(results->size(), 2);
+  EXPECT_EQ((*results)[0].title, "Often");
+  EXPECT_GT((*results)[0].score, (*results)[1].score);
+  EXPECT_NE((*results)[1].snippet.find("<mark>deadline</mark> mentioned"), std::string::npos);
+}
+
+TEST_F(MemoryIndexTest, FiltersPagesAndCounts) {
+  for (int i = 0; i < 30; ++i) {
+    addNote("Note " + std::to_string(i), "shared term " + std::string(static_cast<size_t>(i % 7 + 1), 'x'),
+            {i % 2 == 0 ? "even" : "odd"}, i % 3 == 0 ? std::optional<std::string>("third") : std::nullopt);
+  }
+
+  SearchQuery query;
+  query.text = "shared";
+  query.limit = 10;
+  query.offset = 5;
+
+  auto page = index_->searchPage(query);
+  ASSERT_OK(page);
+  EXPECT_EQ(page->total, 30);
+  ASSERT_EQ(page->results.size(), 10);
+
+  auto ids = index_->searchIds(query);
+  ASSERT_OK(ids);
+  ASSERT_EQ(ids->size(), 10);
+  for (size_t i = 0; i < ids->size(); ++i) {
+    EXPECT_EQ((*ids)[i], page->results[i].id);
+  }
+
+  query.tags = {"even"};
+  query.notebook = "third";
+  auto count = index_->searchCount(query);
+  ASSERT_OK(count);
+  EXPECT_EQ(*count, 5);  // 0, 6, 12, 18, 24
+
+  // No text lists notes by metadata alone
+  SearchQuery metadata_only;
+  metadata_only.tags = {"odd"};
+  metadata_only.limit = 100;
+  auto listed = index_->search(metadata_only);
+  ASSERT_OK(listed);
+  EXPECT_EQ(listed->size(), 15);
+}
+
+TEST_F(MemoryIndexTest, FiltersByParsedExpressions) {
+  addNote("Rust ownership", "Borrowing in rust", {"lang", "draft"}, "work");
+  addNote("Go channels", "Concurrency in go", {"lang"}, "work");
+  addNote("Bread", "Sourdough starter", {"food"});
+
+  auto parsed = [&](const std::string& text) {
+    auto query = QueryParser::parse(text);
+    EXPECT_TRUE(query.has_value());
+    auto results = index_->search(*query);
+    EXPECT_TRUE(results.has_value());
+    std::vector<std::string> found;
+    for (const auto& result : *results) {
+      found.push_back(result.title);
+    }
+    return found;
+  };
+
+  EXPECT_EQ(parsed("(rust OR go) -tag:draft"), std::vector<std::string>{"Go channels"});
+  EXPECT_EQ(parsed("-notebook:work"), std::vector<std::string>{"Bread"});
+  EXPECT_EQ(parsed("tag:lang -(borrowing OR sourdough)"), std::vector<std::string>{"Go channels"});
+  EXPECT_EQ(parsed("title:bread OR title:\"go channels\"").size(), 2);
+  EXPECT_TRUE(parsed("title:chan").empty());
+  EXPECT_EQ(parsed("title:chan*"), std::vector<std::string>{"Go channels"});
+  EXPECT_TRUE(parsed("tag:lang created:2000-01-01..2000-12-31").empty());
+
+  // Words inside the expression rank ahead of notes let in by metadata alone
+  EXPECT_EQ(parsed("sourdough OR tag:lang").front(), "Bread");
+
+  auto query = QueryParser::parse("concurrency OR tag:food OR -tag:lang");
+  ASSERT_OK(query);
+  auto count = index_->searchCount(*query);
+  ASSERT_OK(count);
+  EXPECT_EQ(*count, 2);
+}
+
+TEST_F(MemoryIndexTest, BlockMaxWandMatchesExhaustiveRanking) {
+  // Enough notes that the posting lists span many blocks
+  const std::vector<std::string> vocabulary = {"alpha", "beta", "gamma", "delta", "omega", "sigma"};
+  std::mt19937 rng(42);
+  for (int i = 0; i < 1500; ++i) {
+    std::string body;
+    size_t words = 5 + rng() % 40;
+    for (size_t w = 0; w < words; ++w) {
+      body += (rng() % 4 == 0 ? vocabulary[rng() % vocabulary.size()] : "filler") + std::string(" ");
+    }
+    addNote("N" + std::to_string(i), body);
+  }
+
+  for (const std::string text : {"alpha OR omega", "beta OR gamma OR sigma", "delta OR alpha OR missing"}) {
+    SearchQuery query;
+    query.text = text;
+    query.limit = 10;
+    query.highlight = false;
+
+    auto top = index_->search(query);           // WAND with block-max skipping
+    auto exhaustive = index_->searchPage(query);  // Scores every match
+    ASSERT_OK(top);
+    ASSERT_OK(exhaustive);
+    ASSERT_EQ(top->size(), exhaustive->results.size()) << text;
+    for (size_t i = 0; i < top->size(); ++i) {
+      EXPECT_EQ((*top)[i].id, exhaustive->results[i].id) << text << " rank " << i;
+    }
+  }
+}
+
+TEST_F(MemoryIndexTest, UpdatesRemovalsAndCompaction) {
+  auto note = addNote("Draft", "original wording");
+  addNote("Other", "original text elsewhere");
+
+  note.setContent("# Draft\n\nrevised wording");
+  ASSERT_OK(index_->updateNote(note));
+  EXPECT_EQ(sortedTitles("original"), std::vector<std::string>{"Other"});
+  EXPECT_EQ(sortedTitles("revised"), std::vector<std::string>{"Draft"});
+
+  ASSERT_OK(index_->removeNote(note.id()));
+  EXPECT_EQ(sortedTitles("revised"), std::vector<std::string>{});
+  EXPECT_OK(index_->validateIndex());
+
+  ASSERT_OK(index_->optimize());
+  EXPECT_EQ(sortedTitles("original"), std::vector<std::string>{"Other"});
+  auto stats = index_->getStats();
+  ASSERT_OK(stats);
+  EXPECT_EQ(stats->total_notes, 1);
+  EXPECT_OK(index_->validateIndex());
+}
+
+TEST_F(MemoryIndexTest, ScanCandidatesUseWholeWordsAndWordStarts) {
+  addNote("One", "The root cause was a race");
+  addNote("Two", "taproot causes trouble");
+  addNote("Three", "unrelated");
+
+  auto ids_of = [&](const std::string& pattern, bool regex) {
+    auto candidates = index_->scanCandidates(pattern, regex);
+    EXPECT_TRUE(candidates.has_value());
+    return candidates->size();
+  };
+
+  // "root" may end a longer word and "cause" may continue, so only a word boundary narrows
+  EXPECT_EQ(ids_of("root cause", false), 2);
+  EXPECT_EQ(ids_of(" cause was ", false), 1);
+  EXPECT_EQ(ids_of("", false), 3);
+  EXPECT_EQ(ids_of("x.y", true), 3);
+  EXPECT_EQ(ids_of("(the root|unrelated)", true), 3);
+}
+
+TEST_F(MemoryIndexTest, SnapshotRoundTrip) {
+  MemoryIndex::Config config;
+  config.snapshot_file = temp_dir_ / "index" / "bm25.snapshot";
+
+  auto note = createTestNote("Persisted", "snapshot body text", {"kept"}, "books");
+  {
+    MemoryIndex index(config);
+    ASSERT_OK(index.initialize());
+    ASSERT_OK(index.beginTransaction());
+    ASSERT_OK(index.addNote(note));
+    ASSERT_OK(index.commitTransaction());
+  }
+  ASSERT_TRUE(std::filesystem::exists(config.snapshot_file));
+
+  // Loading must not call back into the note source
+  config.note_source = []() -> nx::Result<std::vector<Note>> {
+    ADD_FAILURE() << "snapshot should have been used";
+    return std::vector<Note>{};
+  };
+  MemoryIndex loaded(config);
+  ASSERT_OK(loaded.initialize());
+
+  SearchQuery query;
+  query.text = "snapshot";
+  auto results = loaded.search(query);
+  ASSERT_OK(results);
+  ASSERT_EQ(results->size(), 1);
+  EXPECT_EQ(results->front().id, note.id());
+  EXPECT_EQ(results->front().notebook, std::optional<std::string>("books"));
+  EXPECT_NE(results->front().snippet.find("<mark>snapshot</mark>"), std::string::npos);
+
+  auto tags = loaded.suggestTags("ke", 5);
+  ASSERT_OK(tags);
+  EXPECT_EQ(*tags, std::vector<std::string>{"kept"});
+}
+
+TEST_F(MemoryIndexTest, BuildsFromNoteSourceWhenSnapshotIsMissing) {
+  MemoryIndex::Config config;
+  config.snapshot_file = temp_dir_ / "bm25.snapshot";
+  auto note = createTestNote("Sourced", "from the note store");
+  config.note_source = [note]() -> nx::Result<std::vector<Note>> {
+    return std::vector<Note>{note};
+  };
+  config.content_provider = [note](const NoteId& id) -> std::optional<std::string> {
+    return id == note.id() ? std::optional<std::string>(note.content()) : std::nullopt;
+  };
+
+  MemoryIndex index(config);
+  ASSERT_OK(index.initialize());
+  EXPECT_TRUE(std::filesystem::exists(config.snapshot_file));
+
+  SearchQuery query;
+  query.text = "\"note store\"";
+  auto results = index.search(query);
+  ASSERT_OK(results);
+  ASSERT_EQ(results->size(), 1);
+  EXPECT_NE(results->front().snippet.find("<mark>note</mark> <mark>store</mark>"), std::string::npos);
+}
@@ -0,0 +1,161 @@
+#include <gtest/gtest.h>
+
+#include <fstream>
+
+#include "nx/index/minhash_index.hpp"
+#include "test_helpers.hpp"
+
+using namespace nx::index;
+using namespace nx::core;
+using namespace nx::test;
+
+class MinHashIndexTest : public TempDirTest {
+protected:
+  // Words w<from>..w<to - 1>, for sets with a known overlap
+  static std::string words(int from, int to) {
+    std::string text;
+    for (int i = from; i < to; ++i) {
+      text += "w" + std::to_string(i) + " ";
+    }
+    return text;
+  }
+
+  std::vector<Note> vault() {
+    return {
+        createTestNote("Sourdough", "Feed the starter with flour and water, proof the dough overnight, "
+                                    "then bake the bread in a hot oven"),
+        createTestNote("Focaccia", "Bread dough with flour, water and olive oil; proof overnight and "
+                                   "bake in a hot oven"),
+        createTestNote("Marathon", "Long runs on Sunday, tempo runs midweek, taper before the race"),
+        createTestNote("Kubernetes", "Deploy the service to the cluster; pods restart when a container crashes"),
+    };
+  }
+};
+
+TEST_F(MinHashIndexTest, SimilarNotesRankFirst) {
+  MinHashIndex index;
+  auto notes = vault();
+  EXPECT_EQ(index.sync(notes), 4);
+
+  auto related = index.similar(notes[0].id(), 3);
+  ASSERT_FALSE(related.empty());
+  EXPECT_EQ(related.front().id, notes[1].id());
+  for (const auto& match : related) {
+    EXPECT_NE(match.id, notes[0].id());
+    EXPECT_NE(match.id, notes[3].id());
+  }
+
+  auto by_text = index.similarToText("kubernetes pods crash and restart in the cluster", 1);
+  ASSERT_EQ(by_text.size(), 1);
+  EXPECT_EQ(by_text.front().id, notes[3].id());
+
+  EXPECT_TRUE(index.similar(NoteId::generate(), 3).empty());
+}
+
+TEST_F(MinHashIndexTest, EstimatesJaccardSimilarity) {
+  MinHashIndex::Config config;
+  config.num_hashes = 256;
+  config.bands = 128;
+  MinHashIndex index(config);
+
+  auto base = createTestNote("Base", words(0, 200));
+  auto half = createTestNote("Half", words(100, 300));       // 100 shared of 300: 1/3
+  auto most = createTestNote("Most", words(20, 200));        // 180 shared of 200: 0.9
+  auto none = createTestNote("None", words(1000, 1200));
+  index.sync({base, half, most, none});
+
+  auto matches = index.similar(base.id(), 10);
+  ASSERT_EQ(matches.size(), 2);
+  EXPECT_EQ(matches[0].id, most.id());
+  EXPECT_NEAR(matches[0].similarity, 0.9, 0.08);
+  EXPECT_EQ(matches[1].id, half.id());
+  EXPECT_NEAR(matches[1].similarity, 1.0 / 3.0, 0.1);
+
+  EXPECT_EQ(index.similar(base.id(), 10, 0.5).size(), 1);
+}
+
+TEST_F(MinHashIndexTest, FindsNearDuplicates) {
+  MinHashIndex index;
+  auto original = createTestNote("Meeting notes", words(0, 150));
+  auto copy = createTestNote("Meeting notes (copy)", words(0, 150) + " w9999");
+  auto other = createTestNote("Other", words(500, 650));
+  index.sync({original, copy, other});
+
+  auto pairs = index.duplicates(0.8);
+  ASSERT_EQ(pairs.size(), 1);
+  EXPECT_TRUE((pairs[0].first == original.id() && pairs[0].second == copy.id()) ||
+              (pairs[0].first == copy.id() && pairs[0].second == original.id()));
+  EXPECT_GE(pairs[0].similarity, 0.8);
+}
+
+TEST_F(MinHashIndexTest, SyncIsIncremental) {
+  MinHashIndex index;
+  auto notes = vault();
+  EXPECT_EQ(index.sync(notes), 4);
+  EXPECT_EQ(index.sync(notes), 0);
+
+  notes[2].setContent("# Marathon\n\nIntervals on the track");
+  notes.erase(notes.begin() + 3);
+  EXPECT_EQ(index.sync(notes), 1);
+  EXPECT_EQ(index.size(), 3);
+  EXPECT_TRUE(index.similarToText("kubernetes cluster pods", 3).empty());
+
+  // A note whose text is unchanged is not re-hashed
+  index.upsert(notes[0]);
+  index.remove(notes[1].id());
+  EXPECT_FALSE(index.contains(notes[1].id()));
+  EXPECT_TRUE(index.similar(notes[0].id(), 3).empty());
+}
+
+TEST_F(MinHashIndexTest, OpensForNotesAndLoadsOnlyChangedFiles) {
+  auto notes_dir = temp_dir_ / "notes";
+  auto cache_dir = temp_dir_ / "cache";
+  std::filesystem::create_directories(notes_dir);
+
+  auto notes = vault();
+  for (const auto& note : notes) {
+    std::ofstream(notes_dir / note.filename()) << note.toFileFormat();
+  }
+
+  std::vector<size_t> loaded_batches;
+  auto loader = [&](const std::vector<NoteId>& ids) -> nx::Result<std::vector<Note>> {
+    loaded_batches.push_back(ids.size());
+    std::vector<Note> found;
+    for (const auto& note : notes) {
+      if (std::find(ids.begin(), ids.end(), note.id()) != ids.end()) {
+        found.push_back(note);
+      }
+    }
+    return found;
+  };
+
+  {
+    auto index = MinHashIndex::openForNotes(notes_dir, cache_dir, loader);
+    ASSERT_OK(index);
+    EXPECT_EQ((*index)->size(), 4);
+    auto related = (*index)->similar(notes[0].id(), 1);
+    ASSERT_EQ(related.size(), 1);
+    EXPECT_EQ(related.front().id, notes[1].id());
+  }
+  ASSERT_EQ(loaded_batches, std::vector<size_t>{4});
+
+  // Nothing changed: the snapshot answers without loading any note
+  {
+    auto index = MinHashIndex::openForNotes(notes_dir, cache_dir, loader);
+    ASSERT_OK(index);
+    EXPECT_EQ((*index)->size(), 4);
+  }
+  EXPECT_EQ(loaded_batches.size(), 1);
+
+  // One file removed, one rewritten
+  std::filesystem::remove(notes_dir / notes[3].filename());
+  notes[2].setContent("# Marathon\n\nA much longer description of the training block and races");
+  std::ofstream(notes_dir / notes[2].filename()) << notes[2].toFileFormat();
+  {
+    auto index = MinHashIndex::openForNotes(notes_dir, cache_dir, loader);
+    ASSERT_OK(index);
+    EXPECT_EQ((*index)->size(), 3);
+    EXPECT_FALSE((*index)->contains(notes[3].id()));
+  }
+  EXPECT_EQ(loaded_batches, (std::vector<size_t>{4, 1}));
+}
@@ -0,0 +1,278 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <fstream>
+
+#include "nx/index/native_grep_index.hpp"
+#include "nx/index/query_parser.hpp"
+#include "test_helpers.hpp"
+
+using namespace nx::index;
+using namespace nx::core;
+using namespace nx::test;
+using nx::ErrorCode;
+
+class NativeGrepIndexTest : public TempDirTest {
+protected:
+  void SetUp() override {
+    TempDirTest::SetUp();
+    notes_dir_ = temp_dir_ / "notes";
+    std::filesystem::create_directories(notes_dir_);
+    index_ = std::make_unique<NativeGrepIndex>(notes_dir_);
+  }
+
+  void TearDown() override {
+    index_.reset();
+    TempDirTest::TearDown();
+  }
+
+  void createNoteFile(const std::string& filename, const std::string& title,
+                      const std::string& content, const std::vector<std::string>& tags = {},
+                      const std::optional<std::string>& notebook = std::nullopt) {
+    std::ofstream file(notes_dir_ / filename);
+
+    file << "---\n";
+    file << "title: " << title << "\n";
+    if (!tags.empty()) {
+      file << "tags: [";
+      for (size_t i = 0; i < tags.size(); ++i) {
+        if (i > 0) file << ", ";
+        file << tags[i];
+      }
+      file << "]\n";
+    }
+    if (notebook.has_value()) {
+      file << "notebook: " << *notebook << "\n";
+    }
+    file << "---\n\n";
+    file << content << "\n";
+  }
+
+  std::vector<std::string> titlesOf(const std::vector<NoteId>& ids) {
+    auto results = index_->search(SearchQuery{});
+    std::vector<std::string> titles;
+    for (const auto& result : *results) {
+      if (std::find(ids.begin(), ids.end(), result.id) != ids.end()) {
+        titles.push_back(result.title);
+      }
+    }
+    std::sort(titles.begin(), titles.end());
+    return titles;
+  }
+
+  std::filesystem::path notes_dir_;
+  std::unique_ptr<NativeGrepIndex> index_;
+};
+
+TEST_F(NativeGrepIndexTest, InitializeRequiresNotesDirectory) {
+  EXPECT_OK(index_->initialize());
+
+  NativeGrepIndex missing(temp_dir_ / "missing");
+  auto result = missing.initialize();
+  ASSERT_FALSE(result.has_value());
+  EXPECT_EQ(result.error().code(), ErrorCode::kDirectoryNotFound);
+}
+
+TEST_F(NativeGrepIndexTest, TextSearchIsCaseInsensitiveWithMarkedSnippets) {
+  createNoteFile("note1.md", "First Note", "Notes on the deadline for the release", {"work"});
+  createNoteFile("note2.md", "Second Note", "DEADLINE moved; deadline again", {"home"});
+  createNoteFile("note3.md", "Third Note", "Nothing relevant here");
+  ASSERT_OK(index_->initialize());
+
+  SearchQuery query;
+  query.text = "Deadline";
+
+  auto page = index_->searchPage(query);
+  ASSERT_OK(page);
+  EXPECT_EQ(page->total, 2);
+  ASSERT_EQ(page->results.size(), 2);
+
+  // More matches rank higher; every match on the line is marked in its original case
+  EXPECT_EQ(page->results[0].title, "Second Note");
+  EXPECT_NE(page->results[0].snippet.find("<mark>DEADLINE</mark> moved; <mark>deadline</mark>"),
+            std::string::npos);
+
+  query.tags = {"work"};
+  auto filtered = index_->search(query);
+  ASSERT_OK(filtered);
+  ASSERT_EQ(filtered->size(), 1);
+  EXPECT_EQ(filtered->front().title, "First Note");
+
+  // A one-hit page is still the best-ranked note, not the first file scanned
+  query.tags.clear();
+  query.limit = 1;
+  auto limited = index_->search(query);
+  ASSERT_OK(limited);
+  ASSERT_EQ(limited->size(), 1);
+  EXPECT_EQ(limited->front().title, "Second Note");
+
+  query.offset = 1;
+  auto next = index_->search(query);
+  ASSERT_OK(next);
+  ASSERT_EQ(next->size(), 1);
+  EXPECT_EQ(next->front().title, "First Note");
+  query.offset = 0;
+
+  auto count = index_->searchCount(query);
+  ASSERT_OK(count);
+  EXPECT_EQ(*count, 2);
+}
+
+TEST_F(NativeGrepIndexTest, MetadataOnlyQueriesReadNoFiles) {
+  createNoteFile("note1.md", "Work Note", "alpha", {"work"}, "projects");
+  createNoteFile("note2.md", "Home Note", "beta", {"home"});
+  ASSERT_OK(index_->initialize());
+
+  SearchQuery query;
+  query.notebook = "projects";
+  auto results = index_->search(query);
+  ASSERT_OK(results);
+  ASSERT_EQ(results->size(), 1);
+  EXPECT_EQ(results->front().title, "Work Note");
+
+  auto tags = index_->suggestTags("wo", 10);
+  ASSERT_OK(tags);
+  ASSERT_EQ(tags->size(), 1);
+  EXPECT_EQ(tags->front(), "work");
+
+  auto stats = index_->getStats();
+  ASSERT_OK(stats);
+  EXPECT_EQ(stats->total_notes, 2);
+}
+
+TEST_F(NativeGrepIndexTest, EvaluatesBooleanExpressionsPerNote) {
+  createNoteFile("note1.md", "Rust Note", "Borrowing in rust", {"lang", "draft"}, "work");
+  createNoteFile("note2.md", "Go Note", "Concurrency in go", {"lang"}, "work");
+  createNoteFile("note3.md", "Bread Note", "Sourdough starter", {"food"});
+  ASSERT_OK(index_->initialize());
+
+  auto titles = [&](const std::string& text) {
+    auto query = QueryParser::parse(text);
+    EXPECT_TRUE(query.has_value());
+    auto results = index_->search(*query);
+    EXPECT_TRUE(results.has_value());
+    std::vector<std::string> found;
+    for (const auto& result : *results) {
+      found.push_back(result.title);
+    }
+    std::sort(found.begin(), found.end());
+    return found;
+  };
+
+  EXPECT_EQ(titles("(borrowing OR concurrency) -tag:draft"), std::vector<std::string>{"Go Note"});
+  EXPECT_EQ(titles("sourdough OR notebook:work"),
+            (std::vector<std::string>{"Bread Note", "Go Note", "Rust Note"}));
+  EXPECT_EQ(titles("tag:lang -concurrency"), std::vector<std::string>{"Rust Note"});
+}
+
+TEST_F(NativeGrepIndexTest, ScanCandidatesForSubstringAndRegex) {
+  createNoteFile("note1.md", "One", "The root cause was a race");
+  createNoteFile("note2.md", "Two", "Root-cause analysis pending");
+  createNoteFile("note3.md", "Three", "Error code 404 returned");
+  ASSERT_OK(index_->initialize());
+
+  auto all = index_->scanCandidates("");
+  ASSERT_OK(all);
+  EXPECT_EQ(all->size(), 3);
+
+  auto substring = index_->scanCandidates("ROOT CAUSE");
+  ASSERT_OK(substring);
+  EXPECT_EQ(titlesOf(*substring), std::vector<std::string>{"One"});
+
+  auto regex = index_->scanCandidates("root.cause", true);
+  ASSERT_OK(regex);
+  EXPECT_EQ(titlesOf(*regex), (std::vector<std::string>{"One", "Two"}));
+
+  // No literal to prefilter on; the regex alone decides
+  auto digits = index_->scanCandidates("\\d{3}", true);
+  ASSERT_OK(digits);
+  EXPECT_EQ(titlesOf(*digits), std::vector<std::string>{"Three"});
+
+  // An invalid pattern rules nothing out
+  auto invalid = index_->scanCandidates("(unclosed", true);
+  ASSERT_OK(invalid);
+  EXPECT_EQ(invalid->size(), 3);
+}
+
+TEST_F(NativeGrepIndexTest, ParallelScanMatchesSerialScan) {
+  for (int i = 0; i < 40; ++i) {
+    std::string body = (i % 3 == 0) ? "contains the needle word" : "plain text only";
+    createNoteFile("note" + std::to_string(i) + ".md", "Note " + std::to_string(i), body);
+  }
+
+  NativeGrepIndex::Config config;
+  config.threads = 4;
+  config.parallel_threshold = 0;
+  NativeGrepIndex parallel(notes_dir_, config);
+  ASSERT_OK(parallel.initialize());
+  ASSERT_OK(index_->initialize());
+
+  SearchQuery query;
+  query.text = "needle";
+  query.limit = 100;
+
+  auto serial_results = index_->search(query);
+  auto parallel_results = parallel.search(query);
+  ASSERT_OK(serial_results);
+  ASSERT_OK(parallel_results);
+  ASSERT_EQ(serial_results->size(), 14);
+  ASSERT_EQ(parallel_results->size(), serial_results->size());
+
+  // Each index generates its own IDs for these files, so compare by title
+  auto sortedTitles = [](const std::vector<SearchResult>& results) {
+    std::vector<std::string> titles;
+    for (const auto& result : results) {
+      titles.push_back(result.title);
+    }
+    std::sort(titles.begin(), titles.end());
+    return titles;
+  };
+  EXPECT_EQ(sortedTitles(*parallel_results), sortedTitles(*serial_results));
+
+  auto candidates = parallel.scanCandidates("needle");
+  ASSERT_OK(candidates);
+  EXPECT_EQ(candidates->size(), 14);
+}
+
+TEST_F(NativeGrepIndexTest, ReusesPersistedManifest) {
+  createNoteFile("note1.md", "Cached Title", "Body text", {"alpha"});
+
+  NativeGrepIndex::Config config;
+  config.cache_file = temp_dir_ / "cache" / "manifest.json";
+
+  {
+    NativeGrepIndex index(notes_dir_, config);
+    ASSERT_OK(index.initialize());
+  }
+  ASSERT_TRUE(std::filesystem::exists(config.cache_file));
+
+  NativeGrepIndex index(notes_dir_, config);
+  ASSERT_OK(index.initialize());
+
+  SearchQuery query;
+  query.text = "body";
+  auto results = index.search(query);
+  ASSERT_OK(results);
+  ASSERT_EQ(results->size(), 1);
+  EXPECT_EQ(results->front().title, "Cached Title");
+}
+
+TEST_F(NativeGrepIndexTest, ChangeCounterFollowsTheNoteFiles) {
+  auto before = index_->changeCounter();
+  EXPECT_EQ(index_->changeCounter(), before);
+
+  // A note file written by another process
+  createNoteFile("01HZZZZZZZZZZZZZZZZZZZZZZZ.md", "Outside", "written elsewhere");
+  EXPECT_NE(index_->changeCounter(), before);
+
+  // Rewritten in place at the same size: the directory itself is untouched
+  auto path = notes_dir_ / "01HZZZZZZZZZZZZZZZZZZZZZZZ.md";
+  std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now() - std::chrono::hours(1));
+  before = index_->changeCounter();
+  createNoteFile("01HZZZZZZZZZZZZZZZZZZZZZZZ.md", "Outside", "WRITTEN ELSEWHERE");
+  EXPECT_NE(index_->changeCounter(), before);
+
+  before = index_->changeCounter();
+  std::filesystem::remove(path);
+  EXPECT_NE(index_->changeCounter(), before);
+}
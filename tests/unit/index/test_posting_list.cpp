@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+
+#include "nx/index/posting_list.hpp"
+
+using namespace nx::index;
+
+namespace {
+
+std::vector<uint32_t> randomDocs(std::mt19937& rng, size_t count, uint32_t max_gap) {
+  std::uniform_int_distribution<uint32_t> gap(1, max_gap);
+  std::vector<uint32_t> docs;
+  uint32_t doc = 0;
+  for (size_t i = 0; i < count; ++i) {
+    doc += gap(rng);
+    docs.push_back(doc);
+  }
+  return docs;
+}
+
+}  // namespace
+
+TEST(PostingListTest, BlocksRoundTripWithSkipEntries) {
+  std::mt19937 rng(7);
+  auto docs = randomDocs(rng, 1000, 300);
+
+  PostingList list;
+  for (size_t i = 0; i < docs.size(); ++i) {
+    list.append(docs[i], static_cast<uint32_t>(i % 5 + 1), static_cast<uint32_t>(100 + i % 50));
+  }
+
+  EXPECT_EQ(list.size(), 1000);
+  ASSERT_EQ(list.blocks().size(), (1000 + PostingList::kBlockSize - 1) / PostingList::kBlockSize);
+  EXPECT_EQ(list.maxTf(), 5);
+  EXPECT_EQ(list.minLength(), 100);
+
+  std::vector<uint32_t> block_docs(PostingList::kBlockSize);
+  std::vector<uint32_t> block_tfs(PostingList::kBlockSize);
+  size_t seen = 0;
+  for (size_t block = 0; block < list.blocks().size(); ++block) {
+    size_t n = list.decodeBlock(block, block_docs.data(), block_tfs.data());
+    for (size_t i = 0; i < n; ++i, ++seen) {
+      EXPECT_EQ(block_docs[i], docs[seen]);
+      EXPECT_EQ(block_tfs[i], seen % 5 + 1);
+    }
+    EXPECT_EQ(list.blocks()[block].last_doc, docs[seen - 1]);
+  }
+  EXPECT_EQ(seen, docs.size());
+}
+
+TEST(PostingListTest, CursorSeeksAcrossBlocks) {
+  std::mt19937 rng(11);
+  auto docs = randomDocs(rng, 700, 40);
+
+  PostingList list;
+  for (uint32_t doc : docs) {
+    list.append(doc, 1, 10);
+  }
+
+  PostingCursor cursor(list);
+  ASSERT_EQ(cursor.doc(), docs[0]);
+
+  // Increasing targets, including ones that skip several blocks at once
+  for (uint32_t target : {docs[3], docs[3] + 1, docs[300] - 1, docs[450], docs[699]}) {
+    cursor.seek(target);
+    auto expected = *std::lower_bound(docs.begin(), docs.end(), target);
+    EXPECT_EQ(cursor.doc(), expected) << "target " << target;
+  }
+
+  cursor.next();
+  EXPECT_TRUE(cursor.atEnd());
+
+  PostingCursor shallow(list);
+  shallow.shallowSeek(docs[500]);
+  EXPECT_EQ(shallow.blockLast(), list.blocks()[500 / PostingList::kBlockSize].last_doc);
+  EXPECT_EQ(shallow.doc(), docs[0]);  // Nothing decoded yet
+}
+
+TEST(PostingListTest, IntersectMatchesScalarMerge) {
+  std::mt19937 rng(3);
+  for (int round = 0; round < 50; ++round) {
+    auto a = randomDocs(rng, 1 + rng() % 60, 20);
+    auto b = randomDocs(rng, 1 + rng() % 128, 4);
+
+    std::vector<uint32_t> expected;
+    std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(expected));
+
+    std::vector<uint32_t> a_index(std::min(a.size(), b.size()));
+    std::vector<uint32_t> b_index(a_index.size());
+    size_t found = intersectSorted(a.data(), a.size(), b.data(), b.size(),
+                                   a_index.data(), b_index.data());
+
+    ASSERT_EQ(found, expected.size());
+    for (size_t i = 0; i < found; ++i) {
+      EXPECT_EQ(a[a_index[i]], expected[i]);
+      EXPECT_EQ(b[b_index[i]], expected[i]);
+    }
+  }
+}
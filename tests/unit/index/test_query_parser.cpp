@@ -66,9 +66,11 @@ TEST_F(QueryParserTest, ParseQuotedValues) {
   ASSERT_TRUE(result.has_value());
   
   const auto& query = *result;
-  EXPECT_EQ(query.text, R"(title:"My Note")");
+  EXPECT_TRUE(query.text.empty());
   ASSERT_EQ(query.tags.size(), 1);
   EXPECT_EQ(query.tags[0], "complex tag");
+  ASSERT_TRUE(query.expr.has_value());
+  EXPECT_EQ(*query.expr, QueryExpr::title("My Note"));
 }
 
 TEST_F(QueryParserTest, ParseQuotedText) {
@@ -76,7 +78,8 @@ TEST_F(QueryParserTest, ParseQuotedText) {
   ASSERT_TRUE(result.has_value());
   
   const auto& query = *result;
-  EXPECT_EQ(query.text, "exact phrase other words");
+  EXPECT_EQ(query.text, R"("exact phrase" other words)");
+  EXPECT_FALSE(query.expr.has_value());
 }
 
 TEST_F(QueryParserTest, ParseNegatedTag) {
@@ -84,8 +87,10 @@ TEST_F(QueryParserTest, ParseNegatedTag) {
   ASSERT_TRUE(result.has_value());
   
   const auto& query = *result;
-  EXPECT_EQ(query.text, R"(content -tags:"draft")");
+  EXPECT_EQ(query.text, "content");
   EXPECT_TRUE(query.tags.empty()); // Negated tags don't go in tags field
+  ASSERT_TRUE(query.expr.has_value());
+  EXPECT_EQ(*query.expr, QueryExpr::negate(QueryExpr::tag("draft")));
 }
 
 TEST_F(QueryParserTest, ParseDateRange) {
@@ -96,6 +101,8 @@ TEST_F(QueryParserTest, ParseDateRange) {
   EXPECT_EQ(query.text, "content");
   EXPECT_TRUE(query.since.has_value());
   EXPECT_TRUE(query.until.has_value());
+  // The end day is included
+  EXPECT_EQ(*query.until - *query.since, std::chrono::hours(24 * 366));
 }
 
 TEST_F(QueryParserTest, ParseComplexQuery) {
@@ -103,7 +110,9 @@ TEST_F(QueryParserTest, ParseComplexQuery) {
   ASSERT_TRUE(result.has_value());
   
   const auto& query = *result;
-  EXPECT_EQ(query.text, R"(data structures algorithms -tags:"draft")");
+  EXPECT_EQ(query.text, R"("data structures" algorithms)");
+  ASSERT_TRUE(query.expr.has_value());
+  EXPECT_EQ(query.expr->toString(), "-tag:draft");
   ASSERT_EQ(query.tags.size(), 2);
   EXPECT_EQ(query.tags[0], "programming");
   EXPECT_EQ(query.tags[1], "tutorial");
@@ -111,6 +120,96 @@ TEST_F(QueryParserTest, ParseComplexQuery) {
   EXPECT_EQ(*query.notebook, "learning");
 }
 
+TEST_F(QueryParserTest, ParseBooleanExpression) {
+  auto expr = QueryParser::parseExpr(R"(notebook:work (rust OR "systems programming") -(tag:draft OR tag:old) NOT meeting)");
+  ASSERT_TRUE(expr.has_value());
+  
+  ASSERT_EQ(expr->kind, QueryExpr::Kind::kAnd);
+  ASSERT_EQ(expr->children.size(), 4);
+  EXPECT_EQ(expr->children[0], QueryExpr::notebook("work"));
+  EXPECT_EQ(expr->children[1], QueryExpr::anyOf({QueryExpr::text("rust"),
+                                                 QueryExpr::text("systems programming")}));
+  EXPECT_EQ(expr->children[2], QueryExpr::negate(QueryExpr::anyOf({QueryExpr::tag("draft"),
+                                                                   QueryExpr::tag("old")})));
+  EXPECT_EQ(expr->children[3], QueryExpr::negate(QueryExpr::text("meeting")));
+  
+  // The canonical form parses back to the same tree
+  EXPECT_EQ(expr->toString(), R"(notebook:work (rust OR "systems programming") -(tag:draft OR tag:old) -meeting)");
+  auto reparsed = QueryParser::parseExpr(expr->toString());
+  ASSERT_TRUE(reparsed.has_value());
+  EXPECT_EQ(*reparsed, *expr);
+  
+  // OR binds looser than AND
+  auto precedence = QueryParser::parseExpr("a b OR c");
+  ASSERT_TRUE(precedence.has_value());
+  EXPECT_EQ(precedence->toString(), "a b OR c");
+  ASSERT_EQ(precedence->kind, QueryExpr::Kind::kOr);
+  EXPECT_EQ(precedence->children[0].kind, QueryExpr::Kind::kAnd);
+}
+
+TEST_F(QueryParserTest, ParseHoistsOnlyWhatEveryMatchNeeds) {
+  auto result = QueryParser::parse("tag:a (tag:b OR tag:c) created:2024-03-01..2024-03-31 modified:2024-01-01.. kiwi");
+  ASSERT_TRUE(result.has_value());
+  
+  const auto& query = *result;
+  EXPECT_EQ(query.text, "kiwi");
+  EXPECT_EQ(query.tags, std::vector<std::string>{"a"});
+  EXPECT_TRUE(query.since.has_value());
+  EXPECT_FALSE(query.until.has_value());
+  ASSERT_TRUE(query.expr.has_value());
+  EXPECT_EQ(query.expr->toString(), "(tag:b OR tag:c) created:2024-03-01..2024-03-31");
+  
+  // A top-level OR leaves everything in the expression
+  auto either = QueryParser::parse("kiwi OR tag:fruit");
+  ASSERT_TRUE(either.has_value());
+  EXPECT_TRUE(either->text.empty());
+  EXPECT_TRUE(either->tags.empty());
+  ASSERT_TRUE(either->expr.has_value());
+  EXPECT_EQ(either->expr->kind, QueryExpr::Kind::kOr);
+  
+  EXPECT_FALSE(QueryParser::parse("created:yesterday").has_value());
+}
+
+TEST_F(QueryParserTest, ExpressionMatchesNoteFacts) {
+  auto expr = QueryParser::parseExpr(R"(title:plan (tag:work OR notebook:home) -tag:done created:2024-01-01..2024-01-31 budget)");
+  ASSERT_TRUE(expr.has_value());
+  
+  std::vector<std::string> tags = {"work"};
+  std::optional<std::string> notebook;
+  auto created = std::chrono::system_clock::now();
+  auto january = QueryParser::parseExpr("created:2024-01-15");
+  ASSERT_TRUE(january.has_value());
+  created = *january->from + std::chrono::hours(12);
+  
+  QueryExpr::Facts facts{"Project Plan", tags, notebook, created, created};
+  bool body_has_budget = true;
+  auto text_test = [&](const QueryExpr& leaf) { return leaf.value == "budget" && body_has_budget; };
+  
+  EXPECT_TRUE(expr->matches(facts, text_test));
+  body_has_budget = false;
+  EXPECT_FALSE(expr->matches(facts, text_test));
+  body_has_budget = true;
+  
+  tags.push_back("done");
+  EXPECT_FALSE(expr->matches(facts, text_test));
+  tags = {"personal"};
+  EXPECT_FALSE(expr->matches(facts, text_test));
+  notebook = "home";
+  EXPECT_TRUE(expr->matches(facts, text_test));
+  
+  QueryExpr::Facts february{"Project Plan", tags, notebook, created + std::chrono::hours(24 * 20), created};
+  EXPECT_FALSE(expr->matches(february, text_test));
+}
+
+TEST_F(QueryParserTest, TitlesMatchWholeWords) {
+  EXPECT_TRUE(QueryExpr::titleMatches("Project Plan", "plan"));
+  EXPECT_TRUE(QueryExpr::titleMatches("Project Plan", "project plan"));
+  EXPECT_FALSE(QueryExpr::titleMatches("Project Plan", "plan project"));
+  EXPECT_FALSE(QueryExpr::titleMatches("Planning notes", "plan"));
+  EXPECT_TRUE(QueryExpr::titleMatches("Planning notes", "plan*"));
+  EXPECT_FALSE(QueryExpr::titleMatches("Project Plan", ""));
+}
+
 // QueryBuilder tests
 
 TEST_F(QueryParserTest, QueryBuilderBasic) {
@@ -144,10 +243,11 @@ TEST_F(QueryParserTest, QueryBuilderWithDates) {
     .build();
   
   EXPECT_EQ(query.text, "content");
-  ASSERT_TRUE(query.since.has_value());
+  EXPECT_FALSE(query.since.has_value());
   ASSERT_TRUE(query.until.has_value());
-  EXPECT_EQ(*query.since, yesterday);
   EXPECT_EQ(*query.until, now);
+  ASSERT_TRUE(query.expr.has_value());
+  EXPECT_EQ(*query.expr, QueryExpr::created(yesterday, std::nullopt));
 }
 
 TEST_F(QueryParserTest, QueryBuilderExcludeTags) {
@@ -158,7 +258,9 @@ TEST_F(QueryParserTest, QueryBuilderExcludeTags) {
     .excludeTag("incomplete")
     .build();
   
-  EXPECT_EQ(query.text, R"(content -tags:"draft" -tags:"incomplete")");
+  EXPECT_EQ(query.text, "content");
+  ASSERT_TRUE(query.expr.has_value());
+  EXPECT_EQ(query.expr->toString(), "-tag:draft -tag:incomplete");
   ASSERT_EQ(query.tags.size(), 1);
   EXPECT_EQ(query.tags[0], "programming");
 }
@@ -262,4 +262,91 @@ TEST_F(RipgrepIndexTest, SearchIds) {
   
   EXPECT_TRUE(std::find(ids_result->begin(), ids_result->end(), note1.id()) != ids_result->end());
   EXPECT_TRUE(std::find(ids_result->begin(), ids_result->end(), note2.id()) != ids_result->end());
-}
\ No newline at end of file
+}
+TEST_F(RipgrepIndexTest, TextSearchBuildsSnippetsFromMatchEvents) {
+  createNoteFile("note1.md", "First Note", "Notes on the deadline for the release", {"work"});
+  createNoteFile("note2.md", "Second Note", "Deadline moved; deadline again", {"home"});
+  createNoteFile("note3.md", "Third Note", "Nothing relevant here");
+  
+  auto init_result = index_->initialize();
+  if (!init_result.has_value()) {
+    GTEST_SKIP() << "ripgrep not available";
+  }
+  
+  SearchQuery query;
+  query.text = "deadline";
+  
+  auto page = index_->searchPage(query);
+  ASSERT_OK(page);
+  EXPECT_EQ(page->total, 2);
+  ASSERT_EQ(page->results.size(), 2);
+  
+  // More matches rank higher; submatches are marked in the snippet
+  EXPECT_EQ(page->results[0].title, "Second Note");
+  EXPECT_NE(page->results[0].snippet.find("<mark>Deadline</mark> moved; <mark>deadline</mark>"),
+            std::string::npos);
+  
+  query.tags = {"work"};
+  auto filtered = index_->search(query);
+  ASSERT_OK(filtered);
+  ASSERT_EQ(filtered->size(), 1);
+  EXPECT_EQ(filtered->front().title, "First Note");
+  
+  // A limit of one still ranks every hit, so it gets the page's first result
+  query.tags.clear();
+  query.limit = 1;
+  auto limited = index_->search(query);
+  ASSERT_OK(limited);
+  ASSERT_EQ(limited->size(), 1);
+  EXPECT_EQ(limited->front().title, "Second Note");
+  
+  query.offset = 1;
+  auto next = index_->search(query);
+  ASSERT_OK(next);
+  ASSERT_EQ(next->size(), 1);
+  EXPECT_EQ(next->front().title, "First Note");
+}
+
+TEST_F(RipgrepIndexTest, PersistsMetadataCacheBetweenRuns) {
+  createNoteFile("note1.md", "Cached Title", "Body text", {"alpha"});
+  
+  RipgrepIndex::Config config;
+  config.cache_file = temp_dir_ / "cache" / "metadata.json";
+  
+  {
+    RipgrepIndex index(notes_dir_, config);
+    if (!index.initialize().has_value()) {
+      GTEST_SKIP() << "ripgrep not available";
+    }
+  }
+  ASSERT_TRUE(std::filesystem::exists(config.cache_file));
+  
+  // Unchanged files are served from the cache file rather than re-parsed
+  std::string cache_text;
+  {
+    std::ifstream in(config.cache_file);
+    cache_text.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+  }
+  auto pos = cache_text.find("Cached Title");
+  ASSERT_NE(pos, std::string::npos);
+  cache_text.replace(pos, 12, "Served Title");
+  {
+    std::ofstream out(config.cache_file, std::ios::trunc);
+    out << cache_text;
+  }
+  
+  RipgrepIndex index(notes_dir_, config);
+  ASSERT_OK(index.initialize());
+  auto results = index.search(SearchQuery{});
+  ASSERT_OK(results);
+  ASSERT_EQ(results->size(), 1);
+  EXPECT_EQ(results->front().title, "Served Title");
+  
+  // A modified file is parsed again
+  createNoteFile("note1.md", "New Title", "Longer body text than before", {"alpha"});
+  ASSERT_OK(index.rebuild());
+  results = index.search(SearchQuery{});
+  ASSERT_OK(results);
+  ASSERT_EQ(results->size(), 1);
+  EXPECT_EQ(results->front().title, "New Title");
+}
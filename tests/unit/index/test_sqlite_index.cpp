@@ -1,8 +1,13 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <chrono>
+#include <fstream>
+#include <map>
+#include <set>
 #include <thread>
 
+#include "nx/index/query_parser.hpp"
 #include "nx/index/sqlite_index.hpp"
 #include "test_helpers.hpp"
 
@@ -256,6 +261,93 @@ TEST_F(SqliteIndexTest, TagSuggestions) {
   EXPECT_TRUE(std::find(suggestions_result->begin(), suggestions_result->end(), "project") != suggestions_result->end());
 }
 
+TEST_F(SqliteIndexTest, TagSuggestionsOrderedByFrequency) {
+  ASSERT_OK(index_->addNote(createTestNote("Note 1", "Content", {"project", "programming"})));
+  ASSERT_OK(index_->addNote(createTestNote("Note 2", "Content", {"programming"})));
+  ASSERT_OK(index_->addNote(createTestNote("Note 3", "Content", {"programming", "other"})));
+  
+  auto suggestions_result = index_->suggestTags("PRO", 10);
+  ASSERT_OK(suggestions_result);
+  ASSERT_EQ(suggestions_result->size(), 2);
+  EXPECT_EQ((*suggestions_result)[0], "programming");
+  EXPECT_EQ((*suggestions_result)[1], "project");
+  
+  suggestions_result = index_->suggestTags("pro", 1);
+  ASSERT_OK(suggestions_result);
+  ASSERT_EQ(suggestions_result->size(), 1);
+  
+  // No prefix: the most used tags overall, ties by name
+  suggestions_result = index_->suggestTags("", 2);
+  ASSERT_OK(suggestions_result);
+  EXPECT_EQ(*suggestions_result, (std::vector<std::string>{"programming", "other"}));
+}
+
+TEST_F(SqliteIndexTest, TagCountsMaintainedOnUpdateAndRemove) {
+  auto note1 = createTestNote("Note 1", "Content", {"alpha", "beta"});
+  auto note2 = createTestNote("Note 2", "Content", {"alpha"});
+  
+  ASSERT_OK(index_->addNote(note1));
+  ASSERT_OK(index_->addNote(note2));
+  
+  auto counts_result = index_->getTagCounts();
+  ASSERT_OK(counts_result);
+  ASSERT_EQ(counts_result->size(), 2);
+  EXPECT_EQ((*counts_result)[0].tag, "alpha");
+  EXPECT_EQ((*counts_result)[0].count, 2);
+  EXPECT_EQ((*counts_result)[1].tag, "beta");
+  EXPECT_EQ((*counts_result)[1].count, 1);
+  
+  // Drop "beta" and add "gamma" on note1
+  note1.metadata().setTags({"alpha", "gamma"});
+  ASSERT_OK(index_->updateNote(note1));
+  
+  counts_result = index_->getTagCounts();
+  ASSERT_OK(counts_result);
+  ASSERT_EQ(counts_result->size(), 2);
+  EXPECT_EQ((*counts_result)[0].tag, "alpha");
+  EXPECT_EQ((*counts_result)[1].tag, "gamma");
+  
+  ASSERT_OK(index_->removeNote(note2.id()));
+  
+  counts_result = index_->getTagCounts();
+  ASSERT_OK(counts_result);
+  ASSERT_EQ(counts_result->size(), 2);
+  EXPECT_EQ((*counts_result)[0].count, 1);
+  
+  auto suggestions_result = index_->suggestTags("be", 10);
+  ASSERT_OK(suggestions_result);
+  EXPECT_TRUE(suggestions_result->empty());
+}
+
+TEST_F(SqliteIndexTest, TagsWithQuotesAndBackslashesRoundTrip) {
+  const std::vector<std::string> tags = {"back\\slash", "say \"hi\""};
+  auto note = createTestNote("Quoted", "quoted tags here", tags);
+  ASSERT_OK(index_->addNote(note));
+  
+  SearchQuery query;
+  query.text = "quoted";
+  auto results = index_->search(query);
+  ASSERT_OK(results);
+  ASSERT_EQ(results->size(), 1);
+  EXPECT_EQ(results->front().tags, tags);
+  
+  auto counts = index_->getTagCounts();
+  ASSERT_OK(counts);
+  ASSERT_EQ(counts->size(), 2);
+  EXPECT_EQ((*counts)[1].tag, "say \"hi\"");
+  
+  // The stored column stays valid JSON, so the json_each() backfill reads it back
+  sqlite3* db = nullptr;
+  ASSERT_EQ(sqlite3_open(db_path_.string().c_str(), &db), SQLITE_OK);
+  sqlite3_stmt* stmt = nullptr;
+  ASSERT_EQ(sqlite3_prepare_v2(db, "SELECT COUNT(*) FROM notes, json_each(notes.tags) WHERE json_valid(notes.tags)",
+                               -1, &stmt, nullptr), SQLITE_OK);
+  ASSERT_EQ(sqlite3_step(stmt), SQLITE_ROW);
+  EXPECT_EQ(sqlite3_column_int(stmt, 0), 2);
+  sqlite3_finalize(stmt);
+  sqlite3_close(db);
+}
+
 TEST_F(SqliteIndexTest, NotebookSuggestions) {
   auto note1 = createTestNote("Note 1", "Content", {}, "work-project");
   auto note2 = createTestNote("Note 2", "Content", {}, "work-notes");
@@ -311,6 +403,49 @@ TEST_F(SqliteIndexTest, PaginationAndLimits) {
   ASSERT_EQ(search_result->size(), 5);
 }
 
+TEST_F(SqliteIndexTest, SearchPageCarriesTotalAndIdsMatchRanking) {
+  for (int i = 0; i < 8; ++i) {
+    // Distinct term frequencies give a definite bm25 order
+    std::string content = "filler text";
+    for (int j = 0; j <= i; ++j) {
+      content += " ranked";
+    }
+    ASSERT_OK(index_->addNote(createTestNote("Note " + std::to_string(i), content)));
+    ASSERT_OK(index_->addNote(createTestNote("Other " + std::to_string(i), "unrelated words")));
+  }
+  
+  SearchQuery query;
+  query.text = "ranked";
+  query.limit = 3;
+  query.offset = 2;
+  
+  auto page = index_->searchPage(query);
+  ASSERT_OK(page);
+  EXPECT_EQ(page->total, 8);
+  ASSERT_EQ(page->results.size(), 3);
+  EXPECT_NE(page->results.front().snippet.find("<mark>ranked</mark>"), std::string::npos);
+  
+  auto plain = index_->search(query);
+  ASSERT_OK(plain);
+  ASSERT_EQ(plain->size(), 3);
+  
+  // The id-only path returns the same page in the same order
+  auto ids = index_->searchIds(query);
+  ASSERT_OK(ids);
+  ASSERT_EQ(ids->size(), page->results.size());
+  for (size_t i = 0; i < ids->size(); ++i) {
+    EXPECT_EQ((*ids)[i], page->results[i].id);
+    EXPECT_EQ((*plain)[i].id, page->results[i].id);
+  }
+  
+  // Past the last page there are no rows to carry the count
+  query.offset = 20;
+  page = index_->searchPage(query);
+  ASSERT_OK(page);
+  EXPECT_TRUE(page->results.empty());
+  EXPECT_EQ(page->total, 8);
+}
+
 TEST_F(SqliteIndexTest, TransactionHandling) {
   ASSERT_OK(index_->beginTransaction());
   
@@ -368,4 +503,683 @@ TEST_F(SqliteIndexTest, OptimizeAndRebuild) {
   auto search_result = index_->search(query);
   ASSERT_OK(search_result);
   EXPECT_EQ(search_result->size(), 1);
-}
\ No newline at end of file
+}
+TEST_F(SqliteIndexTest, ContentlessModeUsesProviderForSnippets) {
+  if (!SqliteIndex::contentlessSupported()) {
+    GTEST_SKIP() << "SQLite " << sqlite3_libversion() << " lacks contentless_delete";
+  }
+  
+  std::map<std::string, std::string> bodies;
+  SqliteIndex::Config config;
+  config.content_mode = SqliteIndex::ContentMode::kContentless;
+  config.content_provider = [&bodies](const NoteId& id) -> std::optional<std::string> {
+    auto it = bodies.find(id.toString());
+    if (it == bodies.end()) {
+      return std::nullopt;
+    }
+    return it->second;
+  };
+  
+  SqliteIndex index(temp_dir_ / "contentless.db", config);
+  ASSERT_OK(index.initialize());
+  EXPECT_EQ(index.contentMode(), SqliteIndex::ContentMode::kContentless);
+  
+  auto note = createTestNote("Note", "Some text before the keywords and some after", {"alpha"});
+  bodies[note.id().toString()] = note.content();
+  ASSERT_OK(index.addNote(note));
+  
+  SearchQuery query;
+  query.text = "keywords";
+  auto results = index.search(query);
+  ASSERT_OK(results);
+  ASSERT_EQ(results->size(), 1);
+  EXPECT_EQ(results->front().id, note.id());
+  EXPECT_NE(results->front().snippet.find("<mark>keywords</mark>"), std::string::npos);
+  
+  auto page = index.searchPage(query);
+  ASSERT_OK(page);
+  EXPECT_EQ(page->total, 1);
+  auto ids = index.searchIds(query);
+  ASSERT_OK(ids);
+  ASSERT_EQ(ids->size(), 1);
+  EXPECT_EQ(ids->front(), note.id());
+  
+  // Updates replace the postings rather than adding to them
+  note.setContent("Entirely different wording now");
+  bodies[note.id().toString()] = note.content();
+  ASSERT_OK(index.updateNote(note));
+  auto old_count = index.searchCount(query);
+  ASSERT_OK(old_count);
+  EXPECT_EQ(*old_count, 0);
+  
+  query.text = "wording";
+  ASSERT_OK(index.rebuild());
+  auto new_count = index.searchCount(query);
+  ASSERT_OK(new_count);
+  EXPECT_EQ(*new_count, 1);
+  
+  ASSERT_OK(index.removeNote(note.id()));
+  new_count = index.searchCount(query);
+  ASSERT_OK(new_count);
+  EXPECT_EQ(*new_count, 0);
+}
+
+TEST_F(SqliteIndexTest, MigratesBetweenContentModes) {
+  if (!SqliteIndex::contentlessSupported()) {
+    GTEST_SKIP() << "SQLite " << sqlite3_libversion() << " lacks contentless_delete";
+  }
+  
+  auto note1 = createTestNote("First", "Quarterly planning notes", {"work"});
+  auto note2 = createTestNote("Second", "Grocery list for the weekend", {"home"});
+  ASSERT_OK(index_->addNote(note1));
+  ASSERT_OK(index_->addNote(note2));
+  index_.reset();
+  
+  std::map<std::string, std::string> bodies = {
+    {note1.id().toString(), note1.content()},
+    {note2.id().toString(), note2.content()}
+  };
+  SqliteIndex::Config config;
+  config.content_provider = [&bodies](const NoteId& id) -> std::optional<std::string> {
+    return bodies.at(id.toString());
+  };
+  
+  SearchQuery query;
+  query.text = "planning";
+  
+  // Full -> contentless copies the existing postings
+  config.content_mode = SqliteIndex::ContentMode::kContentless;
+  {
+    SqliteIndex index(db_path_, config);
+    ASSERT_OK(index.initialize());
+    EXPECT_EQ(index.contentMode(), SqliteIndex::ContentMode::kContentless);
+    auto results = index.search(query);
+    ASSERT_OK(results);
+    ASSERT_EQ(results->size(), 1);
+    EXPECT_EQ(results->front().id, note1.id());
+  }
+  
+  // Contentless -> full re-reads note text through the provider
+  config.content_mode = SqliteIndex::ContentMode::kFull;
+  {
+    SqliteIndex index(db_path_, config);
+    ASSERT_OK(index.initialize());
+    EXPECT_EQ(index.contentMode(), SqliteIndex::ContentMode::kFull);
+    auto results = index.search(query);
+    ASSERT_OK(results);
+    ASSERT_EQ(results->size(), 1);
+    EXPECT_EQ(results->front().id, note1.id());
+    EXPECT_FALSE(results->front().snippet.empty());
+    
+    auto tag_counts = index.getTagCounts();
+    ASSERT_OK(tag_counts);
+    EXPECT_EQ(tag_counts->size(), 2);
+  }
+}
+
+TEST_F(SqliteIndexTest, ScanCandidatesNarrowsSubstringAndRegex) {
+  auto note1 = createTestNote("One", "Refactor the parser_config loader");
+  auto note2 = createTestNote("Two", "TODO: ship it, this is URGENT");
+  auto note3 = createTestNote("Three", "Grocery list");
+  ASSERT_OK(index_->addNote(note1));
+  ASSERT_OK(index_->addNote(note2));
+  ASSERT_OK(index_->addNote(note3));
+  
+  auto ids = [](const std::vector<NoteId>& candidates) {
+    std::set<std::string> result;
+    for (const auto& id : candidates) {
+      result.insert(id.toString());
+    }
+    return result;
+  };
+  
+  // Substrings inside tokens, case-insensitive
+  auto candidates = index_->scanCandidates("ser_conf");
+  ASSERT_OK(candidates);
+  EXPECT_EQ(ids(*candidates), std::set<std::string>{note1.id().toString()});
+  
+  candidates = index_->scanCandidates("todo.*urgent", true);
+  ASSERT_OK(candidates);
+  EXPECT_EQ(ids(*candidates), std::set<std::string>{note2.id().toString()});
+  
+  // Too short to narrow: every note is a candidate
+  candidates = index_->scanCandidates("li");
+  ASSERT_OK(candidates);
+  EXPECT_EQ(candidates->size(), 3);
+  
+  // Updates and removals keep the trigram table in step
+  note3.setContent("Grocery list with parser notes");
+  ASSERT_OK(index_->updateNote(note3));
+  ASSERT_OK(index_->removeNote(note1.id()));
+  candidates = index_->scanCandidates("parser");
+  ASSERT_OK(candidates);
+  EXPECT_EQ(ids(*candidates), std::set<std::string>{note3.id().toString()});
+}
+
+TEST_F(SqliteIndexTest, PrefixSearchAsYouType) {
+  auto note1 = createTestNote("One", "Programming in modern C++");
+  auto note2 = createTestNote("Two", "Project plans for the quarter");
+  ASSERT_OK(index_->addNote(note1));
+  ASSERT_OK(index_->addNote(note2));
+  
+  SearchQuery query;
+  query.prefix_last_term = true;
+  
+  query.text = "pro";
+  auto count = index_->searchCount(query);
+  ASSERT_OK(count);
+  EXPECT_EQ(*count, 2);
+  
+  query.text = "progr";
+  auto results = index_->search(query);
+  ASSERT_OK(results);
+  ASSERT_EQ(results->size(), 1);
+  EXPECT_EQ(results->front().id, note1.id());
+  
+  // Earlier words must match whole; a trailing space completes the last word
+  query.text = "modern prog";
+  count = index_->searchCount(query);
+  ASSERT_OK(count);
+  EXPECT_EQ(*count, 1);
+  query.text = "pro ";
+  count = index_->searchCount(query);
+  ASSERT_OK(count);
+  EXPECT_EQ(*count, 0);
+  
+  // Half-typed FTS syntax is treated as plain words
+  query.text = "\"plans -(qua";
+  count = index_->searchCount(query);
+  ASSERT_OK(count);
+  EXPECT_EQ(*count, 1);
+}
+
+TEST_F(SqliteIndexTest, RebuildsFtsTableWhenPrefixLengthsChange) {
+  auto note = createTestNote("Note", "Searchable content");
+  ASSERT_OK(index_->addNote(note));
+  index_.reset();
+  
+  auto fts_schema = [this]() {
+    sqlite3* db = nullptr;
+    sqlite3_open(db_path_.string().c_str(), &db);
+    sqlite3_stmt* stmt = nullptr;
+    sqlite3_prepare_v2(db, "SELECT sql FROM sqlite_master WHERE name = 'notes_fts'", -1, &stmt, nullptr);
+    std::string schema;
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+      schema = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+    }
+    sqlite3_finalize(stmt);
+    sqlite3_close(db);
+    return schema;
+  };
+  EXPECT_NE(fts_schema().find("prefix='2 3'"), std::string::npos);
+  
+  SqliteIndex::Config config;
+  config.prefix_lengths = {4};
+  {
+    SqliteIndex index(db_path_, config);
+    ASSERT_OK(index.initialize());
+    
+    SearchQuery query;
+    query.text = "Search";
+    query.prefix_last_term = true;
+    auto count = index.searchCount(query);
+    ASSERT_OK(count);
+    EXPECT_EQ(*count, 1);
+  }
+  EXPECT_NE(fts_schema().find("prefix='4'"), std::string::npos);
+}
+
+TEST_F(SqliteIndexTest, StampedSchemaSkipsSetupOnReopen) {
+  ASSERT_OK(index_->addNote(createTestNote("Note", "Stamped content")));
+  index_.reset();
+  
+  auto exec = [this](const std::string& sql) {
+    sqlite3* db = nullptr;
+    sqlite3_open(db_path_.string().c_str(), &db);
+    int64_t value = -1;
+    sqlite3_stmt* stmt = nullptr;
+    sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr);
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+      value = sqlite3_column_int64(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+    sqlite3_close(db);
+    return value;
+  };
+  auto has_created_index = [&]() {
+    return exec("SELECT COUNT(*) FROM sqlite_master WHERE name = 'idx_notes_created'") == 1;
+  };
+  EXPECT_NE(exec("PRAGMA user_version"), 0);
+  
+  // Current stamp: no DDL runs, so a dropped index stays dropped
+  exec("DROP INDEX idx_notes_created");
+  {
+    SqliteIndex index(db_path_);
+    ASSERT_OK(index.initialize());
+    SearchQuery query;
+    query.text = "Stamped";
+    auto count = index.searchCount(query);
+    ASSERT_OK(count);
+    EXPECT_EQ(*count, 1);
+  }
+  EXPECT_FALSE(has_created_index());
+  
+  // Unknown stamp: the schema is checked and recreated
+  exec("PRAGMA user_version = 0");
+  {
+    SqliteIndex index(db_path_);
+    ASSERT_OK(index.initialize());
+  }
+  EXPECT_TRUE(has_created_index());
+  EXPECT_NE(exec("PRAGMA user_version"), 0);
+}
+
+TEST_F(SqliteIndexTest, RebuildInShadowSwapsInNotesFromFiles) {
+  // The live index has a note whose file is gone and lacks the ones on disk
+  ASSERT_OK(index_->addNote(createTestNote("Stale", "Stale orphaned entry")));
+
+  auto notes_dir = temp_dir_ / "notes";
+  std::filesystem::create_directories(notes_dir);
+  for (int i = 0; i < 150; ++i) {
+    auto note = createTestNote("Note", "Rebuilt quokka note " + std::to_string(i), {"rebuilt"});
+    std::ofstream(notes_dir / note.filename()) << note.toFileFormat();
+  }
+  std::ofstream(notes_dir / "broken.md") << "---\nid: [not a ulid\n---\n";
+
+  // A second connection, as a running daemon or TUI would hold, stays open across the swap
+  SearchQuery query;
+  query.text = "quokka";
+  query.limit = 500;
+  SqliteIndex other(db_path_);
+  ASSERT_OK(other.initialize());
+  auto before = other.searchCount(query);
+  ASSERT_OK(before);
+  EXPECT_EQ(*before, 0);
+  auto other_counter = other.changeCounter();
+  auto own_counter = index_->changeCounter();
+
+  auto report = index_->rebuildInShadow(notes_dir, 4);
+  ASSERT_OK(report);
+  EXPECT_EQ(report->notes_indexed, 150);
+  EXPECT_EQ(report->files_skipped, 1);
+  EXPECT_NE(index_->changeCounter(), own_counter);
+  EXPECT_NE(other.changeCounter(), other_counter);
+
+  // The open connection reads the new index without reopening
+  auto seen = other.searchCount(query);
+  ASSERT_OK(seen);
+  EXPECT_EQ(*seen, 150);
+
+  auto shadow_path = db_path_;
+  shadow_path += ".shadow";
+  EXPECT_FALSE(std::filesystem::exists(shadow_path));
+
+  auto count = index_->searchCount(query);
+  ASSERT_OK(count);
+  EXPECT_EQ(*count, 150);
+  SearchQuery stale;
+  stale.text = "orphaned";
+  auto stale_count = index_->searchCount(stale);
+  ASSERT_OK(stale_count);
+  EXPECT_EQ(*stale_count, 0);
+
+  // Both connections keep writing to the same database
+  ASSERT_OK(other.addNote(createTestNote("After", "Added after the quokka swap")));
+  count = index_->searchCount(query);
+  ASSERT_OK(count);
+  EXPECT_EQ(*count, 151);
+}
+
+TEST_F(SqliteIndexTest, WriteBehindBatchesUntilSizeDelayOrFlush) {
+  SqliteIndex::Config config;
+  config.write_batch_size = 3;
+  config.write_batch_delay = std::chrono::milliseconds(100);
+  auto batched = std::make_unique<SqliteIndex>(temp_dir_ / "batched.db", config);
+  ASSERT_OK(batched->initialize());
+  SqliteIndex reader(temp_dir_ / "batched.db");
+  ASSERT_OK(reader.initialize());
+
+  SearchQuery query;
+  query.text = "wombat";
+  auto count = [&](SqliteIndex& index) {
+    auto result = index.searchCount(query);
+    EXPECT_TRUE(result.has_value());
+    return result.has_value() ? *result : 0;
+  };
+
+  // Pending writes are visible to their own index only
+  auto first = createTestNote("First", "A wombat note");
+  ASSERT_OK(batched->addNote(first));
+  ASSERT_OK(batched->addNote(createTestNote("Second", "Another wombat note")));
+  EXPECT_EQ(count(*batched), 2);
+  EXPECT_EQ(count(reader), 0);
+  EXPECT_EQ(batched->pendingWrites().size(), 2);
+
+  // The third write fills the batch
+  ASSERT_OK(batched->removeNote(first.id()));
+  EXPECT_TRUE(batched->pendingWrites().empty());
+  EXPECT_EQ(count(reader), 1);
+
+  // An explicit barrier
+  ASSERT_OK(batched->addNote(createTestNote("Third", "Third wombat")));
+  ASSERT_OK(batched->flush());
+  EXPECT_EQ(count(reader), 2);
+
+  // The delay commits a batch nobody flushes
+  ASSERT_OK(batched->addNote(createTestNote("Fourth", "Fourth wombat")));
+  for (int i = 0; i < 50 && !batched->pendingWrites().empty(); ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  }
+  EXPECT_TRUE(batched->pendingWrites().empty());
+  EXPECT_EQ(count(reader), 3);
+
+  // Explicit transactions take over, and closing commits what is left
+  ASSERT_OK(batched->addNote(createTestNote("Fifth", "Fifth wombat")));
+  ASSERT_OK(batched->beginTransaction());
+  EXPECT_EQ(count(reader), 4);
+  ASSERT_OK(batched->addNote(createTestNote("Sixth", "Sixth wombat")));
+  EXPECT_TRUE(batched->pendingWrites().empty());
+  ASSERT_OK(batched->commitTransaction());
+  ASSERT_OK(batched->addNote(createTestNote("Seventh", "Seventh wombat")));
+  batched.reset();
+  EXPECT_EQ(count(reader), 6);
+}
+
+TEST_F(SqliteIndexTest, FailedWriteInsideABatchIsRolledBack) {
+  SqliteIndex::Config config;
+  config.write_batch_size = 10;
+  config.write_batch_delay = std::chrono::seconds(60);
+  auto batched = std::make_unique<SqliteIndex>(temp_dir_ / "batched.db", config);
+  ASSERT_OK(batched->initialize());
+  auto note = createTestNote("Original", "A platypus note");
+  ASSERT_OK(batched->addNote(note));
+  ASSERT_OK(batched->flush());
+
+  // Make the notes upsert fail after updateNote() has already dropped the FTS row
+  sqlite3* db = nullptr;
+  ASSERT_EQ(sqlite3_open((temp_dir_ / "batched.db").string().c_str(), &db), SQLITE_OK);
+  ASSERT_EQ(sqlite3_exec(db,
+                         "CREATE TRIGGER reject_broken BEFORE INSERT ON notes WHEN NEW.title = 'Broken' "
+                         "BEGIN SELECT RAISE(ABORT, 'rejected'); END",
+                         nullptr, nullptr, nullptr), SQLITE_OK);
+  sqlite3_close(db);
+
+  ASSERT_OK(batched->addNote(createTestNote("Other", "Another platypus")));
+  auto broken = note;
+  broken.setContent("# Broken\n\nReplaced text");
+  EXPECT_FALSE(batched->updateNote(broken).has_value());
+  EXPECT_EQ(batched->pendingWrites().size(), 1);
+  ASSERT_OK(batched->flush());
+
+  // The successful write is committed and the failed one left the old note intact
+  SqliteIndex reader(temp_dir_ / "batched.db");
+  ASSERT_OK(reader.initialize());
+  SearchQuery query;
+  query.text = "platypus";
+  auto ids = reader.searchIds(query);
+  ASSERT_OK(ids);
+  EXPECT_EQ(ids->size(), 2);
+  EXPECT_NE(std::find(ids->begin(), ids->end(), note.id()), ids->end());
+}
+
+TEST_F(SqliteIndexTest, WritesCommitOneByOneByDefault) {
+  SqliteIndex reader(db_path_);
+  ASSERT_OK(reader.initialize());
+  ASSERT_OK(index_->addNote(createTestNote("Solo", "An echidna note")));
+  EXPECT_TRUE(index_->pendingWrites().empty());
+
+  SearchQuery query;
+  query.text = "echidna";
+  auto count = reader.searchCount(query);
+  ASSERT_OK(count);
+  EXPECT_EQ(*count, 1);
+}
+
+TEST_F(SqliteIndexTest, RollingBackToASavepointKeepsEarlierWrites) {
+  EXPECT_FALSE(index_->savepoint().has_value());
+
+  ASSERT_OK(index_->beginTransaction());
+  ASSERT_OK(index_->savepoint());
+  ASSERT_OK(index_->addNote(createTestNote("Kept", "# Kept\n\nA wombat note")));
+  ASSERT_OK(index_->releaseSavepoint());
+  ASSERT_OK(index_->savepoint());
+  ASSERT_OK(index_->addNote(createTestNote("Dropped", "# Dropped\n\nAnother wombat note")));
+  ASSERT_OK(index_->rollbackToSavepoint());
+  ASSERT_OK(index_->commitTransaction());
+
+  SearchQuery query;
+  query.text = "wombat";
+  auto results = index_->search(query);
+  ASSERT_OK(results);
+  ASSERT_EQ(results->size(), 1u);
+  EXPECT_EQ((*results)[0].title, "Kept");
+}
+
+TEST_F(SqliteIndexTest, RunsBooleanQueriesInsideTheIndex) {
+  auto rust = createTestNote("Rust ownership", "# Rust ownership\n\nBorrowing in rust", {"lang", "draft"}, "work");
+  auto go = createTestNote("Go channels", "# Go channels\n\nConcurrency in go", {"lang"}, "work");
+  auto recipe = createTestNote("Bread", "# Bread\n\nSourdough starter", {"food"});
+  for (const auto* note : {&rust, &go, &recipe}) {
+    ASSERT_OK(index_->addNote(*note));
+  }
+
+  auto ids = [&](const std::string& text) {
+    auto query = QueryParser::parse(text);
+    EXPECT_TRUE(query.has_value());
+    auto found = index_->searchIds(*query);
+    EXPECT_TRUE(found.has_value());
+    auto sorted = found.value_or(std::vector<NoteId>{});
+    std::sort(sorted.begin(), sorted.end());
+    return sorted;
+  };
+  auto expect = [](std::vector<NoteId> expected) {
+    std::sort(expected.begin(), expected.end());
+    return expected;
+  };
+
+  EXPECT_EQ(ids("(rust OR go) -tag:draft"), expect({go.id()}));
+  EXPECT_EQ(ids("tag:lang -rust"), expect({go.id()}));
+  EXPECT_EQ(ids("concurrency OR tag:food"), expect({go.id(), recipe.id()}));
+  EXPECT_EQ(ids("-notebook:work"), expect({recipe.id()}));
+  EXPECT_EQ(ids("title:bread OR title:\"go channels\""), expect({go.id(), recipe.id()}));
+  EXPECT_EQ(ids("tag:lang"), expect({rust.id(), go.id()}));
+  // Titles match whole words unless the last one ends in *, as prefixes do in the body
+  EXPECT_TRUE(ids("title:chan").empty());
+  EXPECT_EQ(ids("title:chan*"), expect({go.id()}));
+  EXPECT_EQ(ids("concurr* OR tag:food"), expect({go.id(), recipe.id()}));
+
+  auto created = rust.metadata().created();
+  auto day = [](auto time) {
+    std::time_t seconds = std::chrono::system_clock::to_time_t(time);
+    std::tm tm{};
+    localtime_r(&seconds, &tm);
+    char buffer[16];
+    std::strftime(buffer, sizeof(buffer), "%Y-%m-%d", &tm);
+    return std::string(buffer);
+  };
+  EXPECT_EQ(ids("tag:lang created:" + day(created)), expect({rust.id(), go.id()}));
+  EXPECT_TRUE(ids("tag:lang created:2000-01-01..2000-12-31").empty());
+
+  // Ranked pages and counts come from the same plan
+  auto query = QueryParser::parse("(borrowing OR concurrency OR sourdough) -tag:food");
+  ASSERT_OK(query);
+  query->limit = 1;
+  auto page = index_->searchPage(*query);
+  ASSERT_OK(page);
+  EXPECT_EQ(page->total, 2);
+  ASSERT_EQ(page->results.size(), 1);
+  EXPECT_NE(page->results[0].snippet.find("<mark>"), std::string::npos);
+  auto count = index_->searchCount(*query);
+  ASSERT_OK(count);
+  EXPECT_EQ(*count, 2);
+
+  // Past the last row, and with nothing to rank by
+  query->offset = 5;
+  page = index_->searchPage(*query);
+  ASSERT_OK(page);
+  EXPECT_TRUE(page->results.empty());
+  EXPECT_EQ(page->total, 2);
+  auto filtered = QueryParser::parse("tag:lang");
+  ASSERT_OK(filtered);
+  filtered->limit = 1;
+  page = index_->searchPage(*filtered);
+  ASSERT_OK(page);
+  EXPECT_EQ(page->results.size(), 1);
+  EXPECT_EQ(page->total, 2);
+}
+
+TEST_F(SqliteIndexTest, SearchEachStreamsUntilTheVisitorStops) {
+  for (int i = 0; i < 5; ++i) {
+    ASSERT_OK(index_->addNote(createTestNote("Pangolin " + std::to_string(i), "pangolin scales")));
+  }
+
+  SearchQuery query;
+  query.text = "pangolin";
+  query.limit = 10;
+  auto expected = index_->search(query);
+  ASSERT_OK(expected);
+  ASSERT_EQ(expected->size(), 5);
+
+  // Same rows in the same order as search()
+  std::vector<NoteId> seen;
+  auto visited = index_->searchEach(query, [&](const SearchResult& result) {
+    seen.push_back(result.id);
+    return true;
+  });
+  ASSERT_OK(visited);
+  EXPECT_EQ(*visited, 5);
+  ASSERT_EQ(seen.size(), 5);
+  for (size_t i = 0; i < seen.size(); ++i) {
+    EXPECT_EQ(seen[i], (*expected)[i].id);
+  }
+
+  // Returning false stops the scan, on both the FTS and the query-plan paths
+  auto stopped = index_->searchEach(query, [](const SearchResult&) { return false; });
+  ASSERT_OK(stopped);
+  EXPECT_EQ(*stopped, 1);
+
+  auto planned = QueryParser::parse("pangolin OR scales");
+  ASSERT_OK(planned);
+  size_t calls = 0;
+  auto plan_stopped = index_->searchEach(*planned, [&](const SearchResult&) { return ++calls < 2; });
+  ASSERT_OK(plan_stopped);
+  EXPECT_EQ(*plan_stopped, 2);
+
+  // The statement was reset: the index still answers afterwards
+  auto again = index_->search(query);
+  ASSERT_OK(again);
+  EXPECT_EQ(again->size(), 5);
+}
+
+TEST_F(SqliteIndexTest, AggregatesByNotebookAndTag) {
+  const std::string plan = "# Plan\n\nabcd";
+  const std::string review = "# Review\n\nabcdef";
+  const std::string loose = "# Loose\n\nxy";
+  ASSERT_OK(index_->addNote(createTestNote("Plan", plan, {"work", "q3"}, "projects")));
+  ASSERT_OK(index_->addNote(createTestNote("Review", review, {"work"}, "projects")));
+  ASSERT_OK(index_->addNote(createTestNote("", "# .notebook_projects\n\nplaceholder", {}, "projects")));
+  ASSERT_OK(index_->addNote(createTestNote("", "# .notebook_empty\n\nplaceholder", {}, "empty")));
+  ASSERT_OK(index_->addNote(createTestNote("Loose", loose, {"misc"})));
+
+  AggregateQuery query;
+  query.skip_title_prefix = ".notebook_";
+  auto aggregates = index_->aggregate(query);
+  ASSERT_OK(aggregates);
+
+  EXPECT_EQ(aggregates->total_notes, 3);
+  EXPECT_EQ(aggregates->total_size, plan.size() + review.size() + loose.size());
+  EXPECT_EQ(aggregates->recent_notes, 3);  // Cutoff at the epoch
+  ASSERT_EQ(aggregates->tags.size(), 3);
+  EXPECT_EQ(aggregates->tags[2].tag, "work");
+  EXPECT_EQ(aggregates->tags[2].count, 2);
+
+  // Notes outside any notebook first, then by name
+  ASSERT_EQ(aggregates->notebooks.size(), 3);
+  EXPECT_FALSE(aggregates->notebooks[0].notebook.has_value());
+  EXPECT_EQ(aggregates->notebooks[0].note_count, 1);
+
+  const auto& empty = aggregates->notebooks[1];
+  EXPECT_EQ(empty.notebook, "empty");
+  EXPECT_EQ(empty.note_count, 0);
+  EXPECT_EQ(empty.skipped_count, 1);
+  EXPECT_TRUE(empty.tags.empty());
+
+  const auto& projects = aggregates->notebooks[2];
+  EXPECT_EQ(projects.notebook, "projects");
+  EXPECT_EQ(projects.note_count, 2);
+  EXPECT_EQ(projects.skipped_count, 1);
+  EXPECT_EQ(projects.total_size, plan.size() + review.size());
+  ASSERT_EQ(projects.tags.size(), 2);
+  EXPECT_EQ(projects.tags[0].tag, "q3");
+  EXPECT_EQ(projects.tags[1].tag, "work");
+  EXPECT_EQ(projects.tags[1].count, 2);
+
+  // A cutoff in the future leaves nothing recent
+  query.recent_since = std::chrono::system_clock::now() + std::chrono::hours(1);
+  aggregates = index_->aggregate(query);
+  ASSERT_OK(aggregates);
+  EXPECT_EQ(aggregates->recent_notes, 0);
+}
+
+TEST_F(SqliteIndexTest, ExplainsSearchesWithPlanAndPhases) {
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_OK(index_->addNote(createTestNote("Okapi " + std::to_string(i), "okapi stripes",
+                                             i == 0 ? std::vector<std::string>{"zoo"} : std::vector<std::string>{})));
+  }
+
+  auto phase = [](const SearchExplain& explain, const std::string& name) -> const ExplainPhase* {
+    for (const auto& candidate : explain.phases) {
+      if (candidate.name == name) {
+        return &candidate;
+      }
+    }
+    return nullptr;
+  };
+
+  SearchQuery query;
+  query.text = "okapi";
+  query.limit = 3;
+  auto explain = index_->explainSearch(query);
+  ASSERT_OK(explain);
+  EXPECT_EQ(explain->compiled_query, "okapi");
+  EXPECT_NE(explain->sql.find("notes_fts MATCH"), std::string::npos);
+  EXPECT_FALSE(explain->query_plan.empty());
+  EXPECT_EQ(explain->page.total, 4);
+  EXPECT_EQ(explain->page.results.size(), 3);
+  ASSERT_NE(phase(*explain, "parse"), nullptr);
+  ASSERT_NE(phase(*explain, "execute"), nullptr);
+  EXPECT_EQ(phase(*explain, "execute")->rows, 4u);
+  ASSERT_NE(phase(*explain, "snippet"), nullptr);
+  ASSERT_NE(phase(*explain, "result construction"), nullptr);
+  EXPECT_EQ(phase(*explain, "result construction")->rows, 3u);
+  EXPECT_EQ(phase(*explain, "count"), nullptr);  // The window count rode along
+
+  // Past the last match the count runs on its own and is timed on its own
+  query.offset = 10;
+  auto past_end = index_->explainSearch(query);
+  ASSERT_OK(past_end);
+  EXPECT_EQ(past_end->page.total, 4);
+  EXPECT_TRUE(past_end->page.results.empty());
+  ASSERT_NE(phase(*past_end, "execute"), nullptr);
+  EXPECT_FALSE(phase(*past_end, "execute")->rows.has_value());
+  ASSERT_NE(phase(*past_end, "count"), nullptr);
+  EXPECT_EQ(phase(*past_end, "count")->rows, 4u);
+  query.offset = 0;
+
+  // The page matches what searchPage() returns, on the query-plan path too
+  auto planned = QueryParser::parse("okapi -tag:zoo");
+  ASSERT_OK(planned);
+  auto planned_explain = index_->explainSearch(*planned);
+  ASSERT_OK(planned_explain);
+  auto page = index_->searchPage(*planned);
+  ASSERT_OK(page);
+  EXPECT_EQ(planned_explain->page.total, page->total);
+  EXPECT_EQ(planned_explain->page.total, 3);
+  ASSERT_EQ(planned_explain->page.results.size(), page->results.size());
+  EXPECT_NE(planned_explain->sql.find("note_tags"), std::string::npos);
+  EXPECT_FALSE(planned_explain->query_plan.empty());
+
+  // Malformed FTS syntax fails as the search itself would
+  query.text = "\"unterminated";
+  EXPECT_FALSE(index_->explainSearch(query).has_value());
+}
@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+
+#include "nx/index/trigram_query.hpp"
+
+using namespace nx::index;
+
+using Groups = std::vector<std::vector<std::string>>;
+
+TEST(TrigramQueryTest, SubstringNeedsThreeCharacters) {
+  EXPECT_FALSE(TrigramQuery::forSubstring("ab").has_value());
+  
+  auto query = TrigramQuery::forSubstring("abc");
+  ASSERT_TRUE(query.has_value());
+  EXPECT_EQ(query->groups, (Groups{{"abc"}}));
+  
+  // Length counts codepoints, not bytes
+  EXPECT_FALSE(TrigramQuery::forSubstring("\xC3\xA9\xC3\xA9").has_value());
+  EXPECT_TRUE(TrigramQuery::forSubstring("\xC3\xA9\xC3\xA9\xC3\xA9").has_value());
+}
+
+TEST(TrigramQueryTest, RegexLiteralRuns) {
+  auto query = TrigramQuery::forRegex("todo.*urgent");
+  ASSERT_TRUE(query.has_value());
+  EXPECT_EQ(query->groups, (Groups{{"todo", "urgent"}}));
+  
+  // Optional atoms split runs; escaped punctuation is literal
+  query = TrigramQuery::forRegex(R"(colou?r\.json)");
+  ASSERT_TRUE(query.has_value());
+  EXPECT_EQ(query->groups, (Groups{{"colo", "r.json"}}));
+  
+  // Character classes and class escapes break runs
+  query = TrigramQuery::forRegex(R"(error\s+code[0-9]+)");
+  ASSERT_TRUE(query.has_value());
+  EXPECT_EQ(query->groups, (Groups{{"error", "code"}}));
+}
+
+TEST(TrigramQueryTest, RegexAlternation) {
+  auto query = TrigramQuery::forRegex("TODO|FIXME");
+  ASSERT_TRUE(query.has_value());
+  EXPECT_EQ(query->groups, (Groups{{"TODO"}, {"FIXME"}}));
+  
+  query = TrigramQuery::forRegex("(error|warn)ing");
+  ASSERT_TRUE(query.has_value());
+  EXPECT_EQ(query->groups, (Groups{{"error", "ing"}, {"warn", "ing"}}));
+  
+  // An optional group constrains nothing
+  query = TrigramQuery::forRegex("(draft)?report");
+  ASSERT_TRUE(query.has_value());
+  EXPECT_EQ(query->groups, (Groups{{"report"}}));
+}
+
+TEST(TrigramQueryTest, UnconstrainedRegex) {
+  EXPECT_FALSE(TrigramQuery::forRegex("^# ").has_value());
+  EXPECT_FALSE(TrigramQuery::forRegex(R"(\d+)").has_value());
+  EXPECT_FALSE(TrigramQuery::forRegex("a.c").has_value());
+  // One branch without a literal makes the whole pattern unconstrained
+  EXPECT_FALSE(TrigramQuery::forRegex("meeting|x").has_value());
+  EXPECT_FALSE(TrigramQuery::forRegex("(?!draft)").has_value());
+}
+
+TEST(TrigramQueryTest, FtsMatchExpression) {
+  auto query = TrigramQuery::forRegex("Todo|abcd");
+  ASSERT_TRUE(query.has_value());
+  EXPECT_EQ(query->toFtsMatch(), R"(("odo" AND "tod") OR ("abc" AND "bcd"))");
+  
+  query = TrigramQuery::forSubstring(R"(say "hi")");
+  ASSERT_TRUE(query.has_value());
+  EXPECT_NE(query->toFtsMatch().find(R"("y """)"), std::string::npos);
+}
+
+TEST(TrigramQueryTest, Utf8Trigrams) {
+  EXPECT_TRUE(utf8Trigrams("ab").empty());
+  EXPECT_EQ(utf8Trigrams("abcd"), (std::vector<std::string>{"abc", "bcd"}));
+  EXPECT_EQ(utf8Trigrams("caf\xC3\xA9"), (std::vector<std::string>{"caf", "af\xC3\xA9"}));
+}
@@ -0,0 +1,179 @@
+#include <gtest/gtest.h>
+
+#include "nx/index/vector_index.hpp"
+#include "test_helpers.hpp"
+
+using namespace nx::index;
+using namespace nx::core;
+using namespace nx::test;
+
+namespace {
+
+// Counts calls so tests can see what gets embedded
+class CountingEmbedder : public Embedder {
+public:
+  size_t dimensions() const override { return inner_.dimensions(); }
+  std::string name() const override { return inner_.name(); }
+  nx::Result<std::vector<float>> embed(const std::string& text) override {
+    ++calls;
+    return inner_.embed(text);
+  }
+
+  size_t calls = 0;
+
+private:
+  HashingEmbedder inner_;
+};
+
+float cosine(const std::vector<float>& a, const std::vector<float>& b) {
+  float dot = 0.0f;
+  for (size_t i = 0; i < a.size(); ++i) {
+    dot += a[i] * b[i];
+  }
+  return dot;
+}
+
+}  // namespace
+
+class VectorIndexTest : public TempDirTest {
+protected:
+  std::vector<Note> vault() {
+    return {
+        createTestNote("Sourdough", "Feed the starter flour and water, then bake the bread loaf in a hot oven"),
+        createTestNote("Kubernetes", "Deploy the service to the cluster; pods restart when the container crashes",
+                       {"devops"}),
+        createTestNote("Marathon", "Long runs on Sunday, tempo runs midweek, taper before the race"),
+        createTestNote("Focaccia", "Bread dough with olive oil and a long proof; bake in a hot oven"),
+    };
+  }
+};
+
+TEST_F(VectorIndexTest, HashingEmbedderGroupsRelatedText) {
+  HashingEmbedder embedder;
+  auto bread = embedder.embed("baking bread with a sourdough starter");
+  auto loaf = embedder.embed("my sourdough loaf and the bread oven");
+  auto cluster = embedder.embed("kubernetes cluster deployment");
+  ASSERT_OK(bread);
+  ASSERT_OK(loaf);
+  ASSERT_OK(cluster);
+
+  EXPECT_EQ(bread->size(), embedder.dimensions());
+  EXPECT_NEAR(cosine(*bread, *bread), 1.0f, 1e-5);
+  EXPECT_GT(cosine(*bread, *loaf), cosine(*bread, *cluster) + 0.2f);
+
+  // Stopwords alone carry no signal
+  auto empty = embedder.embed("the and of");
+  ASSERT_OK(empty);
+  EXPECT_EQ(cosine(*empty, *empty), 0.0f);
+}
+
+TEST_F(VectorIndexTest, SearchFindsNotesByTopic) {
+  VectorIndex index(std::make_shared<HashingEmbedder>());
+  auto notes = vault();
+  auto embedded = index.sync(notes);
+  ASSERT_OK(embedded);
+  EXPECT_EQ(*embedded, 4);
+
+  auto hits = index.search("bread baking", 2);
+  ASSERT_OK(hits);
+  ASSERT_EQ(hits->size(), 2);
+  std::vector<NoteId> ids = {(*hits)[0].id, (*hits)[1].id};
+  EXPECT_NE(std::find(ids.begin(), ids.end(), notes[0].id()), ids.end());
+  EXPECT_NE(std::find(ids.begin(), ids.end(), notes[3].id()), ids.end());
+  EXPECT_GE((*hits)[0].score, (*hits)[1].score);
+
+  // Tags are part of the embedded text
+  auto devops = index.search("devops", 1);
+  ASSERT_OK(devops);
+  ASSERT_EQ(devops->size(), 1);
+  EXPECT_EQ(devops->front().id, notes[1].id());
+
+  auto related = index.similar(notes[0].id(), 1);
+  ASSERT_OK(related);
+  ASSERT_EQ(related->size(), 1);
+  EXPECT_EQ(related->front().id, notes[3].id());
+
+  // Nothing in common means no hits rather than arbitrary ones
+  auto unrelated = index.search("zebra xylophone", 3);
+  ASSERT_OK(unrelated);
+  EXPECT_TRUE(unrelated->empty());
+}
+
+TEST_F(VectorIndexTest, SyncOnlyEmbedsChanges) {
+  auto embedder = std::make_shared<CountingEmbedder>();
+  VectorIndex index(embedder);
+  auto notes = vault();
+  ASSERT_OK(index.sync(notes));
+  EXPECT_EQ(embedder->calls, 4);
+
+  auto unchanged = index.sync(notes);
+  ASSERT_OK(unchanged);
+  EXPECT_EQ(*unchanged, 0);
+  EXPECT_EQ(embedder->calls, 4);
+
+  notes[2].setContent("# Marathon\n\nIntervals on the track and a long run on Sunday");
+  notes.erase(notes.begin() + 1);
+  auto changed = index.sync(notes);
+  ASSERT_OK(changed);
+  EXPECT_EQ(*changed, 1);
+  EXPECT_EQ(index.size(), 3);
+
+  auto hits = index.search("kubernetes cluster", 3);
+  ASSERT_OK(hits);
+  EXPECT_TRUE(hits->empty());
+
+  auto intervals = index.search("track intervals", 1);
+  ASSERT_OK(intervals);
+  ASSERT_EQ(intervals->size(), 1);
+  EXPECT_EQ(intervals->front().id, notes[1].id());
+}
+
+TEST_F(VectorIndexTest, PersistsAndDiscardsOtherEmbedders) {
+  VectorIndex::Config config;
+  config.index_file = temp_dir_ / "index" / "vectors.hnsw";
+  auto notes = vault();
+  {
+    VectorIndex index(std::make_shared<HashingEmbedder>(), config);
+    ASSERT_OK(index.load());
+    ASSERT_OK(index.sync(notes));
+    ASSERT_OK(index.save());
+  }
+  ASSERT_TRUE(std::filesystem::exists(config.index_file));
+
+  auto embedder = std::make_shared<CountingEmbedder>();
+  VectorIndex reloaded(embedder, config);
+  ASSERT_OK(reloaded.load());
+  EXPECT_EQ(reloaded.size(), 4);
+  auto embedded = reloaded.sync(notes);
+  ASSERT_OK(embedded);
+  EXPECT_EQ(*embedded, 0);
+
+  // A different model's vectors cannot be compared, so everything is re-embedded
+  VectorIndex other(std::make_shared<HashingEmbedder>(HashingEmbedder::Config{128, true}), config);
+  ASSERT_OK(other.load());
+  EXPECT_EQ(other.size(), 0);
+  auto reembedded = other.sync(notes);
+  ASSERT_OK(reembedded);
+  EXPECT_EQ(*reembedded, 4);
+}
+
+TEST_F(VectorIndexTest, CachingEmbedderReusesVectorsAcrossRuns) {
+  auto counting = std::make_shared<CountingEmbedder>();
+  CachingEmbedder::Config config;
+  config.cache_file = temp_dir_ / "embeddings.cache";
+  {
+    CachingEmbedder cache(counting, config);
+    ASSERT_OK(cache.embed("first text"));
+    ASSERT_OK(cache.embed("second text"));
+    ASSERT_OK(cache.embed("first text"));
+    EXPECT_EQ(counting->calls, 2);
+    EXPECT_EQ(cache.cachedCount(), 2);
+  }
+
+  CachingEmbedder reopened(counting, config);
+  EXPECT_EQ(reopened.cachedCount(), 2);
+  auto vector = reopened.embed("second text");
+  ASSERT_OK(vector);
+  EXPECT_EQ(counting->calls, 2);
+  EXPECT_EQ(vector->size(), counting->dimensions());
+}
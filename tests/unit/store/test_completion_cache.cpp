@@ -0,0 +1,219 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "nx/store/completion_cache.hpp"
+#include "nx/store/filesystem_store.hpp"
+#include "nx/core/note.hpp"
+#include "nx/core/note_id.hpp"
+#include "temp_directory.hpp"
+
+namespace nx::store {
+
+class CompletionCacheTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        temp_dir_ = std::make_unique<nx::test::TempDirectory>();
+        config_.file = temp_dir_->path() / "cache" / "completions";
+    }
+
+    CompletionCache::Entry entry(const std::string& title, const std::string& notebook = "",
+                                 std::vector<std::string> tags = {}) {
+        CompletionCache::Entry e;
+        e.id = nx::core::NoteId::generate();
+        e.title = title;
+        if (!notebook.empty()) {
+            e.notebook = notebook;
+        }
+        e.tags = std::move(tags);
+        return e;
+    }
+
+    static std::vector<std::string> values(const Result<std::vector<CompletionCache::Candidate>>& result) {
+        std::vector<std::string> out;
+        if (result.has_value()) {
+            for (const auto& candidate : *result) {
+                out.push_back(candidate.value);
+            }
+        }
+        return out;
+    }
+
+    std::unique_ptr<nx::test::TempDirectory> temp_dir_;
+    CompletionCache::Config config_;
+};
+
+TEST_F(CompletionCacheTest, LookupBeforeBuildReportsNotFound) {
+    CompletionCache cache(config_);
+    EXPECT_FALSE(cache.exists());
+
+    auto result = cache.complete(CompletionCache::Kind::kTags, "", 10);
+    ASSERT_FALSE(result.has_value());
+    EXPECT_EQ(result.error().code(), ErrorCode::kNotFound);
+
+    // Updates have nothing to keep current yet
+    EXPECT_TRUE(cache.upsert(entry("Ignored")).has_value());
+    EXPECT_FALSE(cache.exists());
+}
+
+TEST_F(CompletionCacheTest, CompletesPrefixesFromTheSortedFile) {
+    CompletionCache cache(config_);
+    auto alpha = entry("Alpha notes", "work", {"rust", "ruby"});
+    auto beta = entry("beta plan", "work", {"rust"});
+    auto gamma = entry("Gamma", "home", {"go"});
+    ASSERT_TRUE(cache.rebuild({gamma, alpha, beta}).has_value());
+
+    // Titles match case-insensitively and keep their case
+    EXPECT_EQ(values(cache.complete(CompletionCache::Kind::kTitles, "al", 10)),
+              std::vector<std::string>{"Alpha notes"});
+    EXPECT_EQ(values(cache.complete(CompletionCache::Kind::kTitles, "", 10)),
+              (std::vector<std::string>{"Alpha notes", "beta plan", "Gamma"}));
+
+    auto tags = cache.complete(CompletionCache::Kind::kTags, "ru", 10);
+    ASSERT_TRUE(tags.has_value());
+    ASSERT_EQ(tags->size(), 2u);
+    EXPECT_EQ((*tags)[0].value, "ruby");
+    EXPECT_EQ((*tags)[0].description, "1");
+    EXPECT_EQ((*tags)[1].value, "rust");
+    EXPECT_EQ((*tags)[1].description, "2");
+
+    EXPECT_EQ(values(cache.complete(CompletionCache::Kind::kNotebooks, "", 10)),
+              (std::vector<std::string>{"home", "work"}));
+
+    // Ids complete from their prefix, described by title
+    std::string id = beta.id.toString();
+    auto ids = cache.complete(CompletionCache::Kind::kIds, id.substr(0, 26), 10);
+    ASSERT_TRUE(ids.has_value());
+    ASSERT_EQ(ids->size(), 1u);
+    EXPECT_EQ((*ids)[0].value, id);
+    EXPECT_EQ((*ids)[0].description, "beta plan");
+
+    // Notes complete to ids from either an id or a title prefix
+    EXPECT_EQ(values(cache.complete(CompletionCache::Kind::kNotes, "gam", 10)),
+              std::vector<std::string>{gamma.id.toString()});
+
+    EXPECT_EQ(cache.complete(CompletionCache::Kind::kTitles, "", 2)->size(), 2u);
+    EXPECT_TRUE(cache.complete(CompletionCache::Kind::kTitles, "zzz", 10)->empty());
+}
+
+TEST_F(CompletionCacheTest, JournalChangesApplyBeforeAndAfterCompaction) {
+    config_.max_journal_bytes = 1024 * 1024;
+    CompletionCache cache(config_);
+    auto kept = entry("Kept", "work", {"rust"});
+    auto removed = entry("Removed", "work", {"rust", "old"});
+    ASSERT_TRUE(cache.rebuild({kept, removed}).has_value());
+
+    auto added = entry("Added", "home", {"new"});
+    auto renamed = kept;
+    renamed.title = "Renamed";
+    renamed.tags = {"rust", "new"};
+    ASSERT_TRUE(cache.upsert(added).has_value());
+    ASSERT_TRUE(cache.upsert(renamed).has_value());
+    ASSERT_TRUE(cache.remove(removed.id).has_value());
+
+    auto check = [&]() {
+        EXPECT_EQ(values(cache.complete(CompletionCache::Kind::kTitles, "", 10)),
+                  (std::vector<std::string>{"Added", "Renamed"}));
+        auto tags = cache.complete(CompletionCache::Kind::kTags, "", 10);
+        ASSERT_TRUE(tags.has_value());
+        ASSERT_EQ(tags->size(), 2u);
+        EXPECT_EQ((*tags)[0].value, "new");
+        EXPECT_EQ((*tags)[0].description, "2");
+        EXPECT_EQ((*tags)[1].value, "rust");
+        EXPECT_EQ((*tags)[1].description, "1");
+        EXPECT_EQ(values(cache.complete(CompletionCache::Kind::kNotebooks, "", 10)),
+                  (std::vector<std::string>{"home", "work"}));
+    };
+    check();
+
+    // A tiny journal limit folds everything into the sorted file on the next write
+    CompletionCache::Config small = config_;
+    small.max_journal_bytes = 1;
+    CompletionCache compacting(small);
+    ASSERT_TRUE(compacting.upsert(added).has_value());
+    EXPECT_EQ(std::filesystem::file_size(compacting.config().file.string() + ".journal"), 0u);
+    check();
+}
+
+TEST_F(CompletionCacheTest, StoreKeepsTheCacheCurrent) {
+    FilesystemStore::Config store_config;
+    store_config.notes_dir = temp_dir_->path() / "notes";
+    store_config.attachments_dir = temp_dir_->path() / "attachments";
+    store_config.trash_dir = temp_dir_->path() / "trash";
+    store_config.completion_file = config_.file;
+    FilesystemStore store(store_config);
+
+    // Checked against the notes directory, which the store's own writes also touch
+    config_.notes_dir = store_config.notes_dir;
+    CompletionCache cache(config_);
+    ASSERT_TRUE(cache.rebuild({}).has_value());
+
+    auto note = nx::core::Note::create("Meeting notes", "# Meeting notes\n\nAgenda");
+    note.setNotebook("work");
+    ASSERT_TRUE(store.store(note).has_value());
+    EXPECT_EQ(values(cache.complete(CompletionCache::Kind::kNotes, "meet", 10)),
+              std::vector<std::string>{note.id().toString()});
+    EXPECT_EQ(values(cache.complete(CompletionCache::Kind::kNotebooks, "w", 10)),
+              std::vector<std::string>{"work"});
+
+    ASSERT_TRUE(store.remove(note.id(), false).has_value());
+    EXPECT_TRUE(cache.complete(CompletionCache::Kind::kNotes, "meet", 10)->empty());
+    EXPECT_TRUE(cache.complete(CompletionCache::Kind::kNotebooks, "", 10)->empty());
+}
+
+TEST_F(CompletionCacheTest, CountsStayRightWhenOneChangeTouchesManyNames) {
+    CompletionCache cache(config_);
+    auto crowded = entry("Crowded", "", {"a1", "a2", "a3", "a4", "a5"});
+    auto other = entry("Other", "", {"b"});
+    ASSERT_TRUE(cache.rebuild({crowded, other}).has_value());
+    ASSERT_TRUE(cache.remove(crowded.id).has_value());
+
+    EXPECT_EQ(values(cache.complete(CompletionCache::Kind::kTags, "", 1)), std::vector<std::string>{"b"});
+}
+
+TEST_F(CompletionCacheTest, ChangesOutsideTheStoreInvalidateTheCache) {
+    config_.notes_dir = temp_dir_->path() / "notes";
+    std::filesystem::create_directories(config_.notes_dir);
+    CompletionCache cache(config_);
+    ASSERT_TRUE(cache.rebuild({entry("Existing")}).has_value());
+    ASSERT_TRUE(cache.complete(CompletionCache::Kind::kTitles, "", 10).has_value());
+
+    // A note dropped in by an editor or sync; mtimes are pinned forward so each change shows
+    auto touch = [&]() {
+        std::filesystem::last_write_time(config_.notes_dir,
+                                         std::filesystem::last_write_time(config_.notes_dir) + std::chrono::seconds(1));
+    };
+    auto note = nx::core::Note::create("Synced", "# Synced");
+    std::ofstream(config_.notes_dir / (note.id().toString() + ".md")) << note.toFileFormat();
+    touch();
+
+    auto result = cache.complete(CompletionCache::Kind::kTitles, "", 10);
+    ASSERT_FALSE(result.has_value());
+    EXPECT_EQ(result.error().code(), ErrorCode::kNotFound);
+
+    // A store write that follows an outside change must not vouch for the cache
+    auto before = cache.notesVersion();
+    touch();
+    ASSERT_TRUE(cache.upsert(entry("Added"), before).has_value());
+    EXPECT_FALSE(cache.complete(CompletionCache::Kind::kTitles, "", 10).has_value());
+
+    // ...while one made on a current cache keeps it answering
+    ASSERT_TRUE(cache.rebuild({entry("Existing")}).has_value());
+    before = cache.notesVersion();
+    touch();
+    ASSERT_TRUE(cache.upsert(entry("Added"), before).has_value());
+    EXPECT_EQ(values(cache.complete(CompletionCache::Kind::kTitles, "", 10)),
+              (std::vector<std::string>{"Added", "Existing"}));
+}
+
+TEST(CompletionCacheFileTest, EachVaultGetsItsOwnFile) {
+    EXPECT_EQ(CompletionCache::defaultFile("/tmp/vault-a"), CompletionCache::defaultFile("/tmp/vault-a"));
+    EXPECT_NE(CompletionCache::defaultFile("/tmp/vault-a"), CompletionCache::defaultFile("/tmp/vault-b"));
+    EXPECT_EQ(CompletionCache::defaultFile("/tmp/vault-a").parent_path(),
+              CompletionCache::defaultFile("/tmp/vault-b").parent_path());
+}
+
+}  // namespace nx::store
@@ -0,0 +1,81 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "nx/store/filesystem_store.hpp"
+#include "nx/core/note.hpp"
+#include "nx/core/note_id.hpp"
+#include "temp_directory.hpp"
+
+namespace nx::store {
+
+class FilesystemStoreTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        temp_dir_ = std::make_unique<nx::test::TempDirectory>();
+
+        FilesystemStore::Config config;
+        config.notes_dir = temp_dir_->path() / "notes";
+        config.attachments_dir = temp_dir_->path() / "attachments";
+        config.trash_dir = temp_dir_->path() / "trash";
+        store_ = std::make_unique<FilesystemStore>(config);
+
+        // Six notes, every other one tagged "keep"
+        for (int i = 0; i < 6; ++i) {
+            auto title = "Note " + std::to_string(i);
+            auto note = nx::core::Note::create(title, "# " + title + "\n\nBody");
+            if (i % 2 == 0) {
+                note.addTag("keep");
+            }
+            ASSERT_TRUE(store_->store(note).has_value());
+        }
+    }
+
+    std::vector<std::string> visit(const NoteQuery& query, size_t stop_after = 0) {
+        std::vector<std::string> ids;
+        auto visited = store_->forEach(query, [&](const nx::core::Note& note) {
+            ids.push_back(note.id().toString());
+            return stop_after == 0 || ids.size() < stop_after;
+        });
+        EXPECT_TRUE(visited.has_value());
+        EXPECT_EQ(visited.value_or(0), ids.size());
+        return ids;
+    }
+
+    std::unique_ptr<nx::test::TempDirectory> temp_dir_;
+    std::unique_ptr<FilesystemStore> store_;
+};
+
+TEST_F(FilesystemStoreTest, ForEachVisitsMatchingNotes) {
+    EXPECT_EQ(visit({}).size(), 6u);
+
+    NoteQuery tagged;
+    tagged.tags = {"keep"};
+    EXPECT_EQ(visit(tagged).size(), 3u);
+}
+
+TEST_F(FilesystemStoreTest, ForEachAppliesOffsetAndLimitAfterFiltering) {
+    NoteQuery tagged;
+    tagged.tags = {"keep"};
+    auto all = visit(tagged);
+    ASSERT_EQ(all.size(), 3u);
+
+    NoteQuery page = tagged;
+    page.offset = 1;
+    page.limit = 1;
+    EXPECT_EQ(visit(page), std::vector<std::string>{all[1]});
+
+    page.limit = 0;
+    EXPECT_EQ(visit(page), (std::vector<std::string>{all[1], all[2]}));
+
+    page.offset = 3;
+    EXPECT_TRUE(visit(page).empty());
+}
+
+TEST_F(FilesystemStoreTest, ForEachStopsWhenTheVisitorDeclines) {
+    auto all = visit({});
+    EXPECT_EQ(visit({}, 2), (std::vector<std::string>{all[0], all[1]}));
+}
+
+}  // namespace nx::store
@@ -5,6 +5,7 @@
 
 #include "nx/store/notebook_manager.hpp"
 #include "nx/store/filesystem_store.hpp"
+#include "nx/index/sqlite_index.hpp"
 #include "nx/core/note.hpp"
 #include "nx/core/note_id.hpp"
 #include "temp_directory.hpp"
@@ -287,4 +288,85 @@ TEST_F(NotebookManagerTest, NotebookNameValidation) {
     EXPECT_TRUE(notebook_manager_->createNotebook("ValidName123").has_value());
 }
 
-} // namespace nx::store
\ No newline at end of file
+// Index aggregates give the same listing as loading every note
+TEST_F(NotebookManagerTest, IndexBackedListingMatchesStore) {
+    ASSERT_TRUE(notebook_manager_->createNotebook("research").has_value());
+    ASSERT_TRUE(notebook_manager_->createNotebook("empty").has_value());
+    
+    auto note1 = createTestNote("Paper", "Reading list", "research");
+    note1.setTags({"ml", "reading"});
+    ASSERT_TRUE(store_->store(note1).has_value());
+    auto note2 = createTestNote("Draft", "Outline", "research");
+    note2.setTags({"ml"});
+    ASSERT_TRUE(store_->store(note2).has_value());
+    
+    auto index = std::make_unique<nx::index::SqliteIndex>(temp_dir_->path() / "index.db");
+    ASSERT_TRUE(index->initialize().has_value());
+    auto notes = store_->search({});
+    ASSERT_TRUE(notes.has_value());
+    for (const auto& note : *notes) {
+        ASSERT_TRUE(index->addNote(note).has_value());
+    }
+    
+    size_t index_calls = 0;
+    NotebookManager indexed(*store_, [&]() -> nx::index::Index* {
+        ++index_calls;
+        return index.get();
+    });
+    
+    for (bool include_stats : {true, false}) {
+        auto expected = notebook_manager_->listNotebooks(include_stats);
+        auto actual = indexed.listNotebooks(include_stats);
+        ASSERT_TRUE(expected.has_value());
+        ASSERT_TRUE(actual.has_value());
+        ASSERT_EQ(actual->size(), expected->size());
+        for (size_t i = 0; i < actual->size(); ++i) {
+            const auto& a = (*actual)[i];
+            const auto& e = (*expected)[i];
+            EXPECT_EQ(a.name, e.name);
+            EXPECT_EQ(a.note_count, e.note_count) << a.name;
+            EXPECT_EQ(a.total_size, e.total_size) << a.name;
+            EXPECT_EQ(a.recent_notes, e.recent_notes) << a.name;
+            EXPECT_EQ(a.tag_counts, e.tag_counts) << a.name;
+            EXPECT_EQ(a.tags, e.tags) << a.name;
+        }
+    }
+    EXPECT_EQ(index_calls, 2);
+    
+    auto info = indexed.getNotebookInfo("research");
+    ASSERT_TRUE(info.has_value());
+    EXPECT_EQ(info->note_count, 2);
+    EXPECT_EQ(info->tag_counts.at("ml"), 2);
+    EXPECT_EQ(indexed.getNotebookInfo("missing").error().code(), ErrorCode::kNotFound);
+}
+
+TEST_F(NotebookManagerTest, IndexedListingsFollowNotebookChanges) {
+    auto index = std::make_unique<nx::index::SqliteIndex>(temp_dir_->path() / "index.db");
+    ASSERT_TRUE(index->initialize().has_value());
+    NotebookManager indexed(*store_, [&]() -> nx::index::Index* { return index.get(); });
+    
+    auto names = [&]() {
+        std::vector<std::string> out;
+        auto notebooks = indexed.listNotebooks(false);
+        EXPECT_TRUE(notebooks.has_value());
+        for (const auto& info : notebooks.value_or(std::vector<NotebookInfo>{})) {
+            out.push_back(info.name);
+        }
+        return out;
+    };
+    
+    ASSERT_TRUE(indexed.createNotebook("projects").has_value());
+    EXPECT_EQ(names(), std::vector<std::string>{"projects"});
+    auto info = indexed.getNotebookInfo("projects", false);
+    ASSERT_TRUE(info.has_value());
+    EXPECT_EQ(info->note_count, 1);  // The placeholder, as in the store-backed listing
+    
+    ASSERT_TRUE(indexed.renameNotebook("projects", "archive").has_value());
+    EXPECT_EQ(names(), std::vector<std::string>{"archive"});
+    EXPECT_EQ(indexed.getNotebookInfo("projects").error().code(), ErrorCode::kNotFound);
+    
+    ASSERT_TRUE(indexed.deleteNotebook("archive").has_value());
+    EXPECT_TRUE(names().empty());
+}
+
+} // namespace nx::store
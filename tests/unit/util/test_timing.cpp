@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <filesystem>
+
+#include "nx/util/timing.hpp"
+#include "temp_directory.hpp"
+
+namespace nx::util {
+
+TEST(LatencyHistogramTest, BucketsKeepRelativeErrorSmall) {
+    for (uint64_t value : {0ull, 1ull, 31ull, 32ull, 63ull, 64ull, 1000ull, 49999ull, 123456789ull}) {
+        auto bucket = LatencyHistogram::bucketFor(value);
+        ASSERT_LT(bucket, LatencyHistogram::kBuckets);
+        uint64_t upper = LatencyHistogram::bucketUpperBound(bucket);
+        EXPECT_GE(upper, value);
+        EXPECT_LE(static_cast<double>(upper - value), static_cast<double>(value) / 32.0 + 1.0) << value;
+        // The bound itself belongs to the same bucket
+        EXPECT_EQ(LatencyHistogram::bucketFor(upper), bucket);
+    }
+    EXPECT_EQ(LatencyHistogram::bucketFor(LatencyHistogram::kMaxMicros * 4), LatencyHistogram::kBuckets - 1);
+}
+
+TEST(LatencyHistogramTest, ReportsPercentiles) {
+    LatencyHistogram histogram;
+    EXPECT_EQ(histogram.percentileMicros(50), 0u);
+
+    // 1..1000 ms, one sample each
+    for (uint64_t ms = 1; ms <= 1000; ++ms) {
+        histogram.record(std::chrono::milliseconds(ms));
+    }
+    EXPECT_EQ(histogram.count(), 1000u);
+    EXPECT_EQ(histogram.maxMicros(), 1000000u);
+
+    auto near = [](uint64_t actual, uint64_t expected) {
+        return actual >= expected && static_cast<double>(actual) <= static_cast<double>(expected) * 1.04;
+    };
+    EXPECT_TRUE(near(histogram.percentileMicros(50), 500000)) << histogram.percentileMicros(50);
+    EXPECT_TRUE(near(histogram.percentileMicros(95), 950000)) << histogram.percentileMicros(95);
+    EXPECT_TRUE(near(histogram.percentileMicros(99), 990000)) << histogram.percentileMicros(99);
+    EXPECT_EQ(histogram.percentileMicros(100), 1000000u);
+}
+
+TEST(LatencyHistogramTest, EncodeRoundTripsAndMerges) {
+    LatencyHistogram a;
+    a.recordMicros(10);
+    a.recordMicros(5000);
+    LatencyHistogram b;
+    b.recordMicros(70000);
+
+    auto decoded = LatencyHistogram::decode(a.encode());
+    ASSERT_TRUE(decoded.has_value());
+    EXPECT_EQ(decoded->encode(), a.encode());
+    EXPECT_EQ(decoded->count(), 2u);
+    EXPECT_EQ(decoded->totalMicros(), 5010u);
+
+    decoded->merge(b);
+    EXPECT_EQ(decoded->count(), 3u);
+    EXPECT_EQ(decoded->maxMicros(), 70000u);
+    EXPECT_EQ(decoded->percentileMicros(100), 70000u);
+
+    EXPECT_FALSE(LatencyHistogram::decode("garbage").has_value());
+    EXPECT_FALSE(LatencyHistogram::decode("1;1;99999:1").has_value());
+}
+
+TEST(TimingsTest, ScopedTimersRecordOnlyWhileEnabled) {
+    auto& timings = Timings::global();
+    timings.reset();
+    timings.setEnabled(false);
+    { ScopedTimer timer("test.off"); }
+    EXPECT_TRUE(timings.phases().empty());
+
+    timings.setEnabled(true);
+    { ScopedTimer timer("test.phase"); }
+    { ScopedTimer timer("test.phase"); }
+    timings.setEnabled(false);
+
+    auto phases = timings.phases();
+    ASSERT_EQ(phases.size(), 1u);
+    EXPECT_EQ(phases[0].name, "test.phase");
+    EXPECT_EQ(phases[0].histogram.count(), 2u);
+    timings.reset();
+}
+
+TEST(MetricsFileTest, AppendsAndReadsRuns) {
+    nx::test::TempDirectory temp_dir;
+    MetricsFile metrics(temp_dir.path() / "metrics" / "timings.jsonl");
+
+    auto now = std::chrono::system_clock::now();
+    MetricsFile::Run run;
+    run.command = "ls";
+    run.started = now - std::chrono::hours(48);
+    run.elapsed = std::chrono::milliseconds(12);
+    LatencyHistogram loads;
+    loads.recordMicros(300);
+    loads.recordMicros(400);
+    run.phases.push_back({"store.load", loads});
+    ASSERT_TRUE(metrics.append(run).has_value());
+
+    run.command = "grep";
+    run.started = now;
+    run.phases.clear();
+    ASSERT_TRUE(metrics.append(run).has_value());
+
+    auto all = metrics.read();
+    ASSERT_TRUE(all.has_value());
+    ASSERT_EQ(all->size(), 2u);
+    EXPECT_EQ((*all)[0].command, "ls");
+    EXPECT_EQ((*all)[0].elapsed, std::chrono::milliseconds(12));
+    ASSERT_EQ((*all)[0].phases.size(), 1u);
+    EXPECT_EQ((*all)[0].phases[0].name, "store.load");
+    EXPECT_EQ((*all)[0].phases[0].histogram.count(), 2u);
+
+    auto recent = metrics.read(now - std::chrono::hours(1));
+    ASSERT_TRUE(recent.has_value());
+    ASSERT_EQ(recent->size(), 1u);
+    EXPECT_EQ((*recent)[0].command, "grep");
+}
+
+}  // namespace nx::util
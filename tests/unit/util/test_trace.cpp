@@ -0,0 +1,89 @@
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <set>
+#include <thread>
+
+#include <nlohmann/json.hpp>
+
+#include "nx/util/timing.hpp"
+#include "nx/util/trace.hpp"
+#include "temp_directory.hpp"
+
+namespace nx::util {
+
+class TracerTest : public ::testing::Test {
+protected:
+    void TearDown() override {
+        Tracer::global().stop();
+    }
+
+    nlohmann::json readTrace(const std::filesystem::path& path) {
+        std::ifstream file(path);
+        return nlohmann::json::parse(file);
+    }
+
+    nx::test::TempDirectory temp_dir_;
+};
+
+TEST_F(TracerTest, SpansAreIgnoredWhileOff) {
+    auto path = temp_dir_.path() / "trace.json";
+    {
+        TraceSpan span("test.off");
+        EXPECT_FALSE(span.active());
+        span.arg("ignored", "value");
+    }
+    ASSERT_TRUE(Tracer::global().flush().has_value());
+    EXPECT_FALSE(std::filesystem::exists(path));
+}
+
+TEST_F(TracerTest, WritesNestedSpansPerThread) {
+    auto path = temp_dir_.path() / "trace.json";
+    auto& tracer = Tracer::global();
+    tracer.start(path);
+
+    {
+        TraceSpan outer("test.outer");
+        outer.arg("query", "say \"hi\"").arg("rows", 3);
+        {
+            ScopedTimer inner("store.inner");
+        }
+        std::thread worker([&tracer]() {
+            tracer.nameThread("worker");
+            TraceSpan span("test.worker");
+        });
+        worker.join();
+    }
+    ASSERT_TRUE(tracer.flush().has_value());
+
+    auto trace = readTrace(path);
+    ASSERT_TRUE(trace.contains("traceEvents"));
+
+    std::map<std::string, nlohmann::json> slices;
+    std::set<std::string> thread_names;
+    for (const auto& event : trace["traceEvents"]) {
+        if (event["ph"] == "X") {
+            slices[event["name"].get<std::string>()] = event;
+        } else if (event["name"] == "thread_name") {
+            thread_names.insert(event["args"]["name"].get<std::string>());
+        }
+    }
+    ASSERT_EQ(slices.size(), 3u);
+    EXPECT_EQ(thread_names, (std::set<std::string>{"main", "worker"}));
+
+    const auto& outer = slices["test.outer"];
+    const auto& inner = slices["store.inner"];
+    EXPECT_EQ(outer["cat"], "test");
+    EXPECT_EQ(inner["cat"], "store");
+    EXPECT_EQ(outer["args"]["query"], "say \"hi\"");
+    EXPECT_EQ(outer["args"]["rows"], 3);
+
+    // Nesting is by time on the same thread
+    EXPECT_EQ(inner["tid"], outer["tid"]);
+    EXPECT_GE(inner["ts"].get<int64_t>(), outer["ts"].get<int64_t>());
+    EXPECT_LE(inner["ts"].get<int64_t>() + inner["dur"].get<int64_t>(),
+              outer["ts"].get<int64_t>() + outer["dur"].get<int64_t>());
+    EXPECT_NE(slices["test.worker"]["tid"], outer["tid"]);
+}
+
+}  // namespace nx::util